@@ -25,6 +25,24 @@
 
 #include "Eth/Phy_Pef7071/IfxEth_Phy_Pef7071.h"
 #include "Interrupts_Cfg.h"
+#include "Ifx_Lwip.h"
+
+/** \brief Number of RX descriptors and buffers */
+#ifndef ETH_CFG_RX_DESCRIPTORS
+#define ETH_CFG_RX_DESCRIPTORS (IFXETH_MAX_RX_BUFFERS)
+#endif
+
+/** \brief Number of TX descriptors and buffers */
+#ifndef ETH_CFG_TX_DESCRIPTORS
+#define ETH_CFG_TX_DESCRIPTORS (IFXETH_MAX_TX_BUFFERS)
+#endif
+
+/** \brief 1 places the rings into the LMU, 0 into the DSPR of CPU0
+ * IfxEth_init() accesses LMU rings through the non-cached segment.
+ */
+#ifndef ETH_CFG_RINGS_IN_LMU
+#define ETH_CFG_RINGS_IN_LMU   (0)
+#endif
 
 /** \brief ETH pin mapping for this application */
 const IfxEth_RmiiPins cfg_Eth_pins = {
@@ -53,6 +71,17 @@ const IfxEth_Config cfg_Eth_old = {
 };
 #endif
 
+#if ETH_CFG_RINGS_IN_LMU
+#pragma section ".lmubss" awc0
+#else
+#pragma section ".bss_cpu0" awc0
+#endif
+IfxEth_RxDescr      cfg_Eth_rxDescr[ETH_CFG_RX_DESCRIPTORS];
+IfxEth_TxDescr      cfg_Eth_txDescr[ETH_CFG_TX_DESCRIPTORS];
+uint8               cfg_Eth_rxBuffer[ETH_CFG_RX_DESCRIPTORS][IFXETH_RTX_BUFFER_SIZE];
+uint8               cfg_Eth_txBuffer[ETH_CFG_TX_DESCRIPTORS][IFXETH_RTX_BUFFER_SIZE];
+#pragma section
+
 const IfxEth_Config cfg_Eth = {
 	.macAddress  = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55},
 	.phyInit = &IfxEth_Phy_Pef7071_init,
@@ -63,8 +92,12 @@ const IfxEth_Config cfg_Eth = {
 	.isrPriority = ISR_PRIORITY_ETH,
 	.isrProvider = ISR_PROVIDER_ETH,
 	.ethSfr = NULL_PTR,
-	.rxDescr = &IfxEth_rxDescr,
-	.txDescr = &IfxEth_txDescr,
+	.rxDescr = cfg_Eth_rxDescr,
+	.txDescr = cfg_Eth_txDescr,
+	.rxBuffer = &cfg_Eth_rxBuffer[0][0],
+	.txBuffer = &cfg_Eth_txBuffer[0][0],
+	.rxDescrCount = ETH_CFG_RX_DESCRIPTORS,
+	.txDescrCount = ETH_CFG_TX_DESCRIPTORS,
 };
 
 #pragma section ".bss_cpu0" awc0
@@ -90,34 +123,47 @@ IFX_INTERRUPT(ISR_Eth, ISR_PROVIDER_ETH, ISR_PRIORITY_ETH);
  */
 void ISR_Eth(void)
 {
-    IfxEth *eth = IfxEth_get();
+    IfxEth *eth    = IfxEth_get();
+    uint32  events = 0;
     IfxSrc_clearRequest(&SRC_ETH);
 
     while (IfxEth_isTxInterrupt(eth) != FALSE)
     {
         IfxEth_clearTxInterrupt(eth);
         eth->isrTxCount++;
+        events |= IFX_LWIP_EVENT_TX;
     }
 
     while (IfxEth_isRxInterrupt(eth) != FALSE)
     {
         IfxEth_clearRxInterrupt(eth);
         eth->isrRxCount++;
+        events |= IFX_LWIP_EVENT_RX;
     }
 
     while (IfxEth_isTxInterrupt(eth) != FALSE)
     {
         IfxEth_clearTxInterrupt(eth);
         eth->isrTxCount++;
+        events |= IFX_LWIP_EVENT_TX;
     }
 
     while (IfxEth_isRxInterrupt(eth) != FALSE)
     {
         IfxEth_clearRxInterrupt(eth);
         eth->isrRxCount++;
+        events |= IFX_LWIP_EVENT_RX;
+    }
+
+    if (IfxEth_isEarlyRxInterrupt(eth) != FALSE)
+    {
+        IfxEth_clearEarlyRxInterrupt(eth);
+        events |= IFX_LWIP_EVENT_RX_EARLY;
     }
 
     eth->txDiff = eth->txCount - eth->isrTxCount;
     eth->rxDiff = eth->rxCount - eth->isrRxCount;
+
+    Ifx_Lwip_onEthInterrupt(events);
     //eth->isrCount = eth->isrCount + 1;
 }
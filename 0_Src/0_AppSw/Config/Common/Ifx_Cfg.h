@@ -47,6 +47,30 @@
 
 /** \} */
 
+/*______________________________________________________________________________
+** Configuration for IfxEth.h
+**____________________________________________________________________________*/
+
+/**
+ * \name Descriptor rings
+ * \{ */
+
+#define IFXETH_DEFAULT_RINGS       (0)                              /**< \brief the rings are defined in Eth_Cfg.c */
+
+/** \} */
+
+/*______________________________________________________________________________
+** Configuration for Ifx_Lwip.h
+**____________________________________________________________________________*/
+
+/**
+ * \name Core assignment
+ * \{ */
+
+#define IFX_LWIP_MULTICORE         (0)                              /**< \brief 1 runs lwIP on CPU1, CPU0 and CPU2 reach it through Ifx_LwipMc.h */
+
+/** \} */
+
 /** \} */
 
 #endif /* IFX_CFG_H */
@@ -35,6 +35,9 @@
 
 #ifndef CFG_INTERRUPTS_H
 #define CFG_INTERRUPTS_H
+
+#include "Ifx_Cfg.h"
+
 //------------------------------------------------------------------------------
 /**
  * \addtogroup configuration_interrupts
@@ -57,6 +60,7 @@
 #define ISR_PRIORITY_ASC_0_ERR 14      /**< \brief Define priority of the ASC0 error interrupt request.  */
 
 #define ISR_PRIORITY_ETH       32      /**< \brief Define priority of the ETHERNET interrupt request.  */
+#define ISR_PRIORITY_STM_0_ETH 33      /**< \brief Define priority of the STM0 comparator 1 interrupt request (ETH RX coalescing timeout).  */
 
 #define ISR_PRIORITY_CIF_VIS   52      /**< \brief Define priority of the vision processing interrupt request. */
 #define ISR_PRIORITY_CIF_ISP   54      /**< \brief Define priority of the CIF on-frame-end interrupt request. */
@@ -70,7 +74,13 @@
  */
 
 #define ISR_PROVIDER_ASC_0     0      /**< \brief Define CPU number which handles the ASC0 interrupt request.  */
+#if IFX_LWIP_MULTICORE
+#define ISR_PROVIDER_ETH       1      /**< \brief Define CPU number which handles the ETHERNET interrupt request.  */
+#define ISR_PROVIDER_STM_0     1      /**< \brief Define CPU number which handles the STM0 interrupt requests (lwIP timeouts, ETH RX coalescing).  */
+#else
 #define ISR_PROVIDER_ETH       0      /**< \brief Define CPU number which handles the ETHERNET interrupt request.  */
+#define ISR_PROVIDER_STM_0     0      /**< \brief Define CPU number which handles the STM0 interrupt requests (lwIP timeouts, ETH RX coalescing).  */
+#endif
 #define ISR_PROVIDER_CIF_VIS   1      /**< \brief Define CPU number which handles the vision processing interrupt request. */
 #define ISR_PROVIDER_CIF_ISP   0      /**< \brief Define CPU number which handles the CIF on-frame-end interrupt request.  */
 
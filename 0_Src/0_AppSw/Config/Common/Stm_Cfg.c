@@ -25,10 +25,10 @@
 
 #include "Interrupts_Cfg.h"
 #include "Stm/Std/IfxStm.h"
+#include "Ifx_Lwip.h"
 //#include "CifServer/CifServer.h"
 
 
-volatile uint32 Core0_Stm_1ms = 0;
 volatile uint32 Core1_Stm_1ms = 0;
 volatile uint32 Core2_Stm_1ms = 0;
 
@@ -45,36 +45,59 @@ void initStm0(void)
 
     //Call the constructor of configuration
     IfxStm_initCompareConfig(&stmCompareConfig);
-    //Modify only the number of ticks and enable the trigger output
+    //Comparator 0 times the lwIP timeouts, Ifx_Lwip_pollTimerFlags() updates the compare value
+    stmCompareConfig.comparator              = IFX_LWIP_TIMER_COMPARATOR;
     stmCompareConfig.ticks                   = 100; /*Interrupt after 100 ticks from now */
     stmCompareConfig.triggerInterruptEnabled = ISR_PRIORITY_STM_0;
-    stmCompareConfig.servProvider            = IfxSrc_Tos_cpu0;
+    stmCompareConfig.servProvider            = (IfxSrc_Tos)ISR_PROVIDER_STM_0;
 
     //Now Compare functionality is initialized
     IfxStm_initCompare(stm, &stmCompareConfig);
+
+    //Comparator 1 times the ETH RX coalescing, Ifx_Lwip_onEthInterrupt() updates the compare value
+    IfxStm_initCompareConfig(&stmCompareConfig);
+    stmCompareConfig.comparator              = IFX_LWIP_COALESCE_COMPARATOR;
+    stmCompareConfig.comparatorInterrupt     = IfxStm_ComparatorInterrupt_ir1;
+    stmCompareConfig.triggerInterruptEnabled = ISR_PRIORITY_STM_0_ETH;
+    stmCompareConfig.servProvider            = (IfxSrc_Tos)ISR_PROVIDER_STM_0;
+    IfxStm_initCompare(stm, &stmCompareConfig);
 }
 
 
 
 
-IFX_INTERRUPT(ISR_Stm0, 0, ISR_PRIORITY_STM_0);
+IFX_INTERRUPT(ISR_Stm0, ISR_PROVIDER_STM_0, ISR_PRIORITY_STM_0);
 
 /**
  * \ingroup interrupts
  *
- * This interrupt is raised by the STM0. The initialisation is done by initStm0().
+ * This interrupt is raised by the comparator 0 of STM0 at the next lwIP timeout. The
+ * initialisation is done by initStm0().
  *
- * \isrProvider 0
+ * \isrProvider \ref ISR_PROVIDER_STM_0
  * \isrPriority \ref ISR_PRIORITY_STM_0;
  */
 void ISR_Stm0(void)
 {
-    Ifx_STM *stm = &MODULE_STM0;
-    //IfxStm_updateCompare(stm, IfxStm_Comparator_0, IfxStm_getLower(stm) + IFX_CFG_STM_TICKS_PER_MS);
-    Core0_Stm_1ms++;
-#if CIFSERV_USE_LWIP
+    IfxStm_clearCompareFlag(&MODULE_STM0, IFX_LWIP_TIMER_COMPARATOR);
     Ifx_Lwip_onTimerTick();
-#endif
+}
+
+
+IFX_INTERRUPT(ISR_Stm0_Eth, ISR_PROVIDER_STM_0, ISR_PRIORITY_STM_0_ETH);
+
+/**
+ * \ingroup interrupts
+ *
+ * This interrupt is raised by the comparator 1 of STM0. The initialisation is done by initStm0().
+ *
+ * \isrProvider \ref ISR_PROVIDER_STM_0
+ * \isrPriority \ref ISR_PRIORITY_STM_0_ETH
+ */
+void ISR_Stm0_Eth(void)
+{
+    IfxStm_clearCompareFlag(&MODULE_STM0, IFX_LWIP_COALESCE_COMPARATOR);
+    Ifx_Lwip_onRxCoalesceTimeout();
 }
 
 
@@ -0,0 +1,94 @@
+/**
+ * \file Eth_Cfg.c
+ * \brief Configuration data for the ETH module of the host (Linux) build.
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * \defgroup configuration_host_eth Ethernet (host)
+ * \ingroup configuration_comm
+ */
+
+#include "Eth/Std/IfxEth.h"
+#include "Ifx_Lwip.h"
+
+void ISR_Eth(void);
+
+/** \brief ETH configuration for the host build
+ * \ingroup configuration_host_eth
+ *
+ * The model calls \ref ISR_Eth synchronously whenever an enabled DMA status bit is set.
+ */
+const IfxEth_Config cfg_Eth = {
+    .macAddress       = {0x00, 0x11, 0x22, 0x33, 0x44, 0x55},
+    .phyInit          = NULL_PTR,
+    .phyLink          = NULL_PTR,
+    .phyInterfaceMode = IfxEth_PhyInterfaceMode_rmii,
+    .rmiiPins         = NULL_PTR,
+    .miiPins          = NULL_PTR,
+    .isrPriority      = 1,
+    .isrProvider      = 0,
+    .ethSfr           = NULL_PTR,
+    .rxDescr          = IfxEth_rxDescr.items,
+    .txDescr          = IfxEth_txDescr.items,
+    .rxBuffer         = &IfxEth_rxBuffer[0][0],
+    .txBuffer         = &IfxEth_txBuffer[0][0],
+    .rxDescrCount     = IFXETH_MAX_RX_BUFFERS,
+    .txDescrCount     = IFXETH_MAX_TX_BUFFERS,
+    .isrHandler       = &ISR_Eth,
+};
+
+IfxEth Ifx_g_Eth;
+
+IfxEth *IfxEth_get(void)
+{
+    return &Ifx_g_Eth;
+}
+
+
+/**
+ * \ingroup interrupts
+ *
+ * Host counterpart of the target ISR_Eth. Called by the IfxEth model.
+ * Passes the cleared status flags to Ifx_Lwip_onEthInterrupt().
+ */
+void ISR_Eth(void)
+{
+    IfxEth *eth    = IfxEth_get();
+    uint32  events = 0;
+
+    while (IfxEth_isTxInterrupt(eth) != FALSE)
+    {
+        IfxEth_clearTxInterrupt(eth);
+        eth->isrTxCount++;
+        events |= IFX_LWIP_EVENT_TX;
+    }
+
+    while (IfxEth_isRxInterrupt(eth) != FALSE)
+    {
+        IfxEth_clearRxInterrupt(eth);
+        eth->isrRxCount++;
+        events |= IFX_LWIP_EVENT_RX;
+    }
+
+    if (IfxEth_isEarlyRxInterrupt(eth) != FALSE)
+    {
+        IfxEth_clearEarlyRxInterrupt(eth);
+        events |= IFX_LWIP_EVENT_RX_EARLY;
+    }
+
+    eth->txDiff = eth->txCount - eth->isrTxCount;
+    eth->rxDiff = eth->rxCount - eth->isrRxCount;
+
+    Ifx_Lwip_onEthInterrupt(events);
+}
@@ -0,0 +1,64 @@
+/**
+ * \file Stm_Cfg.c
+ * \brief STM configuration of the host (Linux) build.
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * There is no compare interrupt on the host: the main loop calls pollStm0(), which runs
+ * ISR_Stm0() when the compare value of the lwIP timer comparator is reached and
+ * ISR_Stm0_Eth() when the compare value of the ETH RX coalescing comparator is reached.
+ */
+
+#include "Stm/Std/IfxStm.h"
+#include "Ifx_Lwip.h"
+
+void ISR_Stm0(void);
+void ISR_Stm0_Eth(void);
+
+void initStm0(void)
+{}
+
+
+/** \brief Emulates the STM0 compare interrupts, returns the number of ISR_Stm0() calls */
+uint32 pollStm0(void)
+{
+    uint32 count = 0;
+
+    if (IfxStm_Host_pollCompare(&MODULE_STM0, IFX_LWIP_TIMER_COMPARATOR))
+    {
+        ISR_Stm0();
+        count++;
+    }
+
+    if (IfxStm_Host_pollCompare(&MODULE_STM0, IFX_LWIP_COALESCE_COMPARATOR))
+    {
+        ISR_Stm0_Eth();
+    }
+
+    return count;
+}
+
+
+void ISR_Stm0(void)
+{
+    IfxStm_clearCompareFlag(&MODULE_STM0, IFX_LWIP_TIMER_COMPARATOR);
+    Ifx_Lwip_onTimerTick();
+}
+
+
+void ISR_Stm0_Eth(void)
+{
+    IfxStm_clearCompareFlag(&MODULE_STM0, IFX_LWIP_COALESCE_COMPARATOR);
+    Ifx_Lwip_onRxCoalesceTimeout();
+}
@@ -0,0 +1,349 @@
+/**
+ * \file Bench_Arp.c
+ * \brief Host benchmark: ARP table lookups with the hash table against the table scan
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The same operations run through etharp.c of the library (ETHARP_TABLE_HASH 1) and through
+ * etharp.c built once more with ETHARP_TABLE_HASH 0 and its functions renamed to
+ * etharp_list_* (see Host.mk), both with ARP_TABLE_SIZE entries. Every run resolves "hosts"
+ * neighbours with ARP replies through ethernet_input() and then, round robin over all of them:
+ * - find:   etharp_find_addr(), as the UDP header caches do
+ * - output: etharp_output() without hint, a netif shared by many destinations
+ * - hinted: etharp_output() with one address hint per destination, as every pcb has its own
+ *
+ * The churn line resolves twice as many neighbours as the table holds, every ARP reply
+ * recycles the oldest entry. The link output checks the destination MAC address of every
+ * frame. Usage: Bench_Arp [operations], default 1000000 per column. The insert column
+ * includes allocating and building the ARP reply.
+ */
+
+#include "HostSim.h"
+#include "lwip/pbuf.h"
+#include "netif/etharp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_OPERATIONS_DEFAULT (1000000U)
+#define BENCH_CHURN_HOSTS        (2U * ARP_TABLE_SIZE)
+
+static const uint32 Bench_hostCounts[] = {16, 64, ARP_TABLE_SIZE};
+
+#define BENCH_RUNS (sizeof(Bench_hostCounts) / sizeof(Bench_hostCounts[0]))
+
+/** \brief Implementation under test */
+typedef struct
+{
+    const char   *name;
+    err_t         (*input)(struct pbuf *p, struct netif *netif);
+    err_t         (*output)(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr);
+    etharp_idx_t  (*find)(struct netif *netif, const ip_addr_t *ipaddr, struct eth_addr **eth_ret,
+                          ip_addr_t **ip_ret);
+    void          (*cleanup)(struct netif *netif);
+} Bench_Impl;
+
+/* table scan, etharp.c built with ETHARP_TABLE_HASH 0 */
+err_t        etharp_list_ethernet_input(struct pbuf *p, struct netif *netif);
+err_t        etharp_list_output(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr);
+etharp_idx_t etharp_list_find_addr(struct netif *netif, const ip_addr_t *ipaddr, struct eth_addr **eth_ret,
+                                   ip_addr_t **ip_ret);
+void         etharp_list_cleanup_netif(struct netif *netif);
+
+static struct netif     Bench_netif;
+static netif_addr_idx_t Bench_hints[BENCH_CHURN_HOSTS];
+static uint32           Bench_expected;     /**< \brief Host the current frame is sent to */
+static uint32           Bench_frames;
+static uint32           Bench_misdirected;
+static Bench_Impl       Bench_hash;
+static Bench_Impl       Bench_list;
+
+static void Bench_hostIp(ip_addr_t *ipaddr, uint32 host)
+{
+    IP4_ADDR(ipaddr, 10, 1, 1 + (host >> 8), host & 0xFF);
+}
+
+
+static void Bench_hostMac(struct eth_addr *ethaddr, uint32 host)
+{
+    static const uint8 oui[3] = {0x02, 0x00, 0x5E};
+
+    memcpy(ethaddr->addr, oui, sizeof(oui));
+    ethaddr->addr[3] = 0;
+    ethaddr->addr[4] = (uint8)(host >> 8);
+    ethaddr->addr[5] = (uint8)host;
+}
+
+
+/** \brief Checks the destination MAC address instead of sending the frame */
+static err_t Bench_linkOutput(struct netif *netif, struct pbuf *p)
+{
+    struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+    struct eth_addr expected;
+
+    (void)netif;
+
+    Bench_hostMac(&expected, Bench_expected);
+    Bench_misdirected += (memcmp(&ethhdr->dest, &expected, sizeof(expected)) != 0);
+    Bench_frames++;
+
+    return ERR_OK;
+}
+
+
+/** \brief Passes an ARP reply of a host to us to ethernet_input() */
+static void Bench_resolve(Bench_Impl *impl, uint32 host)
+{
+    struct pbuf       *p = pbuf_alloc(PBUF_RAW, SIZEOF_ETHARP_PACKET, PBUF_RAM);
+    struct eth_hdr    *ethhdr;
+    struct etharp_hdr *hdr;
+    struct eth_addr    mac;
+    ip_addr_t          ipaddr;
+
+    if (p == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    Bench_hostMac(&mac, host);
+    Bench_hostIp(&ipaddr, host);
+    ethhdr = (struct eth_hdr *)p->payload;
+    hdr    = (struct etharp_hdr *)((uint8 *)ethhdr + SIZEOF_ETH_HDR);
+
+    memcpy(&ethhdr->dest, Bench_netif.hwaddr, ETHARP_HWADDR_LEN);
+    memcpy(&ethhdr->src, &mac, ETHARP_HWADDR_LEN);
+    ethhdr->type   = PP_HTONS(ETHTYPE_ARP);
+    hdr->hwtype    = PP_HTONS(1);
+    hdr->proto     = PP_HTONS(ETHTYPE_IP);
+    hdr->hwlen     = ETHARP_HWADDR_LEN;
+    hdr->protolen  = sizeof(ip_addr_t);
+    hdr->opcode    = PP_HTONS(ARP_REPLY);
+    memcpy(&hdr->shwaddr, &mac, ETHARP_HWADDR_LEN);
+    IPADDR2_COPY(&hdr->sipaddr, &ipaddr);
+    memcpy(&hdr->dhwaddr, Bench_netif.hwaddr, ETHARP_HWADDR_LEN);
+    IPADDR2_COPY(&hdr->dipaddr, &Bench_netif.ip_addr);
+
+    impl->input(p, &Bench_netif);
+}
+
+
+static boolean Bench_check(Bench_Impl *impl, uint32 host)
+{
+    struct eth_addr *ethRet;
+    ip_addr_t       *ipRet;
+    struct eth_addr  mac;
+    ip_addr_t        ipaddr;
+
+    Bench_hostMac(&mac, host);
+    Bench_hostIp(&ipaddr, host);
+
+    return (impl->find(&Bench_netif, &ipaddr, &ethRet, &ipRet) >= 0) && (memcmp(ethRet, &mac, sizeof(mac)) == 0);
+}
+
+
+/** \brief Mean time of "operations" calls of etharp_output() round robin to "hosts", in ns */
+static double Bench_output(Bench_Impl *impl, struct pbuf *q, const ip_addr_t *addrs, uint32 hosts,
+                           uint32 operations, boolean hinted)
+{
+    uint64 start = HostSim_nowNs();
+    uint32 host  = 0;
+    uint32 n;
+
+    for (n = 0; n < operations; n++)
+    {
+        Bench_expected        = host;
+        Bench_netif.addr_hint = hinted ? &Bench_hints[host] : NULL;
+        impl->output(&Bench_netif, q, &addrs[host]);
+        pbuf_header(q, -(s16_t)SIZEOF_ETH_HDR);
+
+        if (++host == hosts)
+        {
+            host = 0;
+        }
+    }
+
+    Bench_netif.addr_hint = NULL;
+
+    return (double)(HostSim_nowNs() - start) / operations;
+}
+
+
+/** \brief One line of the table: insert, find, output and hinted output with "hosts" neighbours */
+static boolean Bench_run(Bench_Impl *impl, struct pbuf *q, uint32 hosts, uint32 operations)
+{
+    static ip_addr_t addrs[ARP_TABLE_SIZE];
+    struct eth_addr *ethRet;
+    ip_addr_t       *ipRet;
+    uint64           start;
+    double           insert, find, output, hinted;
+    uint32           host, n;
+    uint32           found = 0;
+    uint32           lost  = 0;
+
+    for (host = 0; host < hosts; host++)
+    {
+        Bench_hostIp(&addrs[host], host);
+    }
+
+    start = HostSim_nowNs();
+
+    for (host = 0; host < hosts; host++)
+    {
+        Bench_resolve(impl, host);
+    }
+
+    insert = (double)(HostSim_nowNs() - start) / hosts;
+    host   = 0;
+    start  = HostSim_nowNs();
+
+    for (n = 0; n < operations; n++)
+    {
+        found += (impl->find(&Bench_netif, &addrs[host], &ethRet, &ipRet) >= 0);
+
+        if (++host == hosts)
+        {
+            host = 0;
+        }
+    }
+
+    find = (double)(HostSim_nowNs() - start) / operations;
+    memset(Bench_hints, 0, sizeof(Bench_hints));
+    Bench_frames      = 0;
+    Bench_misdirected = 0;
+    output            = Bench_output(impl, q, addrs, hosts, operations, FALSE);
+    hinted            = Bench_output(impl, q, addrs, hosts, operations, TRUE);
+
+    for (host = 0; host < hosts; host++)
+    {
+        lost += (Bench_check(impl, host) == FALSE) ? 1 : 0;
+    }
+
+    impl->cleanup(&Bench_netif);
+
+    if ((found != operations) || (lost != 0) || (Bench_frames != 2 * operations) || (Bench_misdirected != 0))
+    {
+        printf("bench_arp: FAILED, %s with %u hosts, %u found, %u lost, %u frames, %u misdirected\n", impl->name,
+            hosts, found, lost, Bench_frames, Bench_misdirected);
+        return FALSE;
+    }
+
+    printf("%6u %-5s %8.1f %8.1f %8.1f %8.1f\n", hosts, impl->name, insert, find, output, hinted);
+
+    return TRUE;
+}
+
+
+/** \brief Resolves twice as many neighbours as the table holds, every reply recycles an entry */
+static boolean Bench_churn(Bench_Impl *impl)
+{
+    uint64 start;
+    uint32 host;
+    uint32 lost = 0;
+
+    for (host = 0; host < ARP_TABLE_SIZE; host++)
+    {
+        Bench_resolve(impl, host);
+    }
+
+    start = HostSim_nowNs();
+
+    for (host = ARP_TABLE_SIZE; host < BENCH_CHURN_HOSTS; host++)
+    {
+        Bench_resolve(impl, host);
+    }
+
+    start = HostSim_nowNs() - start;
+
+    /* all entries have the same age, only the last reply is sure to be in the table */
+    for (host = 0; host < BENCH_CHURN_HOSTS; host++)
+    {
+        Bench_resolve(impl, host);
+        lost += (Bench_check(impl, host) == FALSE) ? 1 : 0;
+    }
+
+    impl->cleanup(&Bench_netif);
+
+    if (lost != 0)
+    {
+        printf("bench_arp: FAILED, %s churn, %u of %u hosts not in the table after their reply\n", impl->name,
+            lost, BENCH_CHURN_HOSTS);
+        return FALSE;
+    }
+
+    printf("%6s %-5s %8.1f\n", "churn", impl->name, (double)start / (BENCH_CHURN_HOSTS - ARP_TABLE_SIZE));
+
+    return TRUE;
+}
+
+
+int main(int argc, char **argv)
+{
+    static const uint8 hwaddr[ETHARP_HWADDR_LEN] = {0x00, 0x03, 0x19, 0x45, 0x00, 0x01};
+    uint32             operations                = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_OPERATIONS_DEFAULT;
+    boolean            ok                        = TRUE;
+    struct pbuf       *q;
+    uint32             r;
+
+    if (operations == 0)
+    {
+        printf("usage: Bench_Arp [operations]\n");
+        return EXIT_FAILURE;
+    }
+
+    memp_init();
+    pbuf_init();
+    IP4_ADDR(&Bench_netif.ip_addr, 10, 1, 0, 1);
+    IP4_ADDR(&Bench_netif.netmask, 255, 255, 0, 0);
+    memcpy(Bench_netif.hwaddr, hwaddr, sizeof(hwaddr));
+    Bench_netif.hwaddr_len = ETHARP_HWADDR_LEN;
+    Bench_netif.mtu        = 1500;
+    Bench_netif.flags      = NETIF_FLAG_UP | NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+    Bench_netif.linkoutput = &Bench_linkOutput;
+    q                      = pbuf_alloc(PBUF_IP, IP_HLEN, PBUF_RAM);
+
+    if (q == NULL)
+    {
+        return EXIT_FAILURE;
+    }
+
+    memset(q->payload, 0, IP_HLEN);
+
+    Bench_hash.name    = "hash";
+    Bench_hash.input   = &ethernet_input;
+    Bench_hash.output  = &etharp_output;
+    Bench_hash.find    = &etharp_find_addr;
+    Bench_hash.cleanup = &etharp_cleanup_netif;
+    Bench_list.name    = "list";
+    Bench_list.input   = &etharp_list_ethernet_input;
+    Bench_list.output  = &etharp_list_output;
+    Bench_list.find    = &etharp_list_find_addr;
+    Bench_list.cleanup = &etharp_list_cleanup_netif;
+
+    printf("bench_arp: %u operations per column, ns per operation, %u entries, %u buckets\n", operations,
+        ARP_TABLE_SIZE, ETHARP_TABLE_HASH_SIZE);
+    printf("%6s %-5s %8s %8s %8s %8s\n", "hosts", "impl", "insert", "find", "output", "hinted");
+
+    for (r = 0; (r < BENCH_RUNS) && (Bench_hostCounts[r] <= ARP_TABLE_SIZE); r++)
+    {
+        ok = Bench_run(&Bench_hash, q, Bench_hostCounts[r], operations) && ok;
+        ok = Bench_run(&Bench_list, q, Bench_hostCounts[r], operations) && ok;
+    }
+
+    ok = Bench_churn(&Bench_hash) && ok;
+    ok = Bench_churn(&Bench_list) && ok;
+    pbuf_free(q);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,197 @@
+/**
+ * \file Bench_Chksum.c
+ * \brief Host benchmark of the inet_chksum.c algorithms per payload size and alignment
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * Needs the library built with LWIP_CHKSUM_ALGORITHM_ALL (see Host.mk). All algorithms
+ * are first checked against version #1 for every length up to one frame and every
+ * start alignment, then timed. The copy variants are timed with source and
+ * destination at the same and at a different alignment.
+ */
+
+#include "HostSim.h"
+#include "lwip/inet_chksum.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_BUFFER_SIZE (IFXETH_RTX_BUFFER_SIZE + 8)
+#define BENCH_BYTES       (256U * 1024U * 1024U)   /**< \brief bytes summed per measurement */
+
+typedef u16_t (*Bench_Chksum)(void *dataptr, int len);
+typedef u16_t (*Bench_ChksumCopy)(void *dst, const void *src, u16_t len);
+
+static u16_t Bench_alg1(void *dataptr, int len)
+{
+    return lwip_chksum_alg1(dataptr, (u16_t)len);
+}
+
+
+static const struct
+{
+    const char  *name;
+    Bench_Chksum chksum;
+} Bench_algorithms[] = {
+    {"alg1 bytes", &Bench_alg1},
+    {"alg2 16bit", &lwip_chksum_alg2},
+    {"alg3 32bit", &lwip_chksum_alg3},
+    {"alg4 64acc", &lwip_chksum_alg4},
+};
+
+static const struct
+{
+    const char      *name;
+    Bench_ChksumCopy copy;
+} Bench_copyAlgorithms[] = {
+    {"copy1 memcpy+sum", &lwip_chksum_copy_alg1},
+    {"copy2 fused", &lwip_chksum_copy_alg2},
+};
+
+static const uint16 Bench_sizes[] = {20, 64, 256, 576, 1024, 1500};
+
+static uint8 Bench_source[BENCH_BUFFER_SIZE] __attribute__((aligned(8)));
+static uint8 Bench_destination[BENCH_BUFFER_SIZE] __attribute__((aligned(8)));
+
+/** \brief Checks all algorithms against version #1 */
+static boolean Bench_verify(void)
+{
+    uint32 size, align, i;
+    u16_t  expected, result;
+
+    for (size = 0; size <= 1514; size++)
+    {
+        for (align = 0; align < 4; align++)
+        {
+            expected = lwip_chksum_alg1(&Bench_source[align], (u16_t)size);
+
+            for (i = 1; i < sizeof(Bench_algorithms) / sizeof(Bench_algorithms[0]); i++)
+            {
+                result = Bench_algorithms[i].chksum(&Bench_source[align], (int)size);
+
+                if (result != expected)
+                {
+                    printf("bench_chksum: FAILED, %s size %u align %u: 0x%04x instead of 0x%04x\n",
+                        Bench_algorithms[i].name, size, align, result, expected);
+                    return FALSE;
+                }
+            }
+
+            for (i = 0; i < sizeof(Bench_copyAlgorithms) / sizeof(Bench_copyAlgorithms[0]); i++)
+            {
+                uint32 dstAlign;
+
+                for (dstAlign = 0; dstAlign < 4; dstAlign++)
+                {
+                    memset(Bench_destination, 0, sizeof(Bench_destination));
+                    result = Bench_copyAlgorithms[i].copy(&Bench_destination[dstAlign], &Bench_source[align], (u16_t)size);
+
+                    if ((memcmp(&Bench_destination[dstAlign], &Bench_source[align], size) != 0)
+                        || (lwip_chksum_alg1(&Bench_destination[dstAlign], (u16_t)size) != result))
+                    {
+                        printf("bench_chksum: FAILED, %s size %u align %u/%u\n", Bench_copyAlgorithms[i].name,
+                            size, align, dstAlign);
+                        return FALSE;
+                    }
+                }
+            }
+        }
+    }
+
+    return TRUE;
+}
+
+
+int main(void)
+{
+    uint32          i, a, s, n, count;
+    uint64          start, elapsed;
+    volatile u16_t  sink = 0;
+
+    srand(1);
+
+    for (i = 0; i < sizeof(Bench_source); i++)
+    {
+        Bench_source[i] = (uint8)rand();
+    }
+
+    if (Bench_verify() == FALSE)
+    {
+        return EXIT_FAILURE;
+    }
+
+    printf("bench_chksum: all algorithms match version #1, selected LWIP_CHKSUM_ALGORITHM %u\n", LWIP_CHKSUM_ALGORITHM);
+    printf("%-18s %5s", "algorithm", "align");
+
+    for (s = 0; s < sizeof(Bench_sizes) / sizeof(Bench_sizes[0]); s++)
+    {
+        printf(" %7u B", Bench_sizes[s]);
+    }
+
+    printf("   (GB/s)\n");
+
+    for (i = 0; i < sizeof(Bench_algorithms) / sizeof(Bench_algorithms[0]); i++)
+    {
+        for (a = 0; a < 4; a++)
+        {
+            printf("%-18s %5u", Bench_algorithms[i].name, a);
+
+            for (s = 0; s < sizeof(Bench_sizes) / sizeof(Bench_sizes[0]); s++)
+            {
+                count = BENCH_BYTES / Bench_sizes[s];
+                start = HostSim_nowNs();
+
+                for (n = 0; n < count; n++)
+                {
+                    sink += Bench_algorithms[i].chksum(&Bench_source[a], Bench_sizes[s]);
+                }
+
+                elapsed = HostSim_nowNs() - start;
+                printf(" %9.2f", (double)count * Bench_sizes[s] / (double)(elapsed ? elapsed : 1));
+            }
+
+            printf("\n");
+        }
+    }
+
+    for (i = 0; i < sizeof(Bench_copyAlgorithms) / sizeof(Bench_copyAlgorithms[0]); i++)
+    {
+        for (a = 0; a < 2; a++)
+        {
+            /* a == 0: same alignment, a == 1: destination shifted by one byte */
+            printf("%-18s %5s", Bench_copyAlgorithms[i].name, a ? "2/3" : "2/2");
+
+            for (s = 0; s < sizeof(Bench_sizes) / sizeof(Bench_sizes[0]); s++)
+            {
+                count = BENCH_BYTES / Bench_sizes[s];
+                start = HostSim_nowNs();
+
+                for (n = 0; n < count; n++)
+                {
+                    sink += Bench_copyAlgorithms[i].copy(&Bench_destination[2 + a], &Bench_source[2], Bench_sizes[s]);
+                }
+
+                elapsed = HostSim_nowNs() - start;
+                printf(" %9.2f", (double)count * Bench_sizes[s] / (double)(elapsed ? elapsed : 1));
+            }
+
+            printf("\n");
+        }
+    }
+
+    (void)sink;
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,262 @@
+/**
+ * \file Bench_Frag.c
+ * \brief Host benchmark: IP fragmentation into PBUF_REF slices against the static buffer
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The same UDP datagram is passed to ip_frag() of the library (IP_FRAG_USES_STATIC_BUF 0:
+ * every fragment is a header pbuf followed by PBUF_REF slices of the datagram, queued on two
+ * TX descriptors without copying) and to ip_frag.c built once more with
+ * IP_FRAG_USES_STATIC_BUF 1 and renamed to ip_frag_static (see Host.mk): every fragment is
+ * copied into the static buffer and then into the buffer of its TX descriptor. The
+ * datagram is a custom pbuf of the bench, as if owned by the application.
+ *
+ * The fragments of every datagram size are checked against the datagram in an untimed run
+ * before. "ns" is the time per datagram, the DMA and the MAC are modelled without timing.
+ * "copied" and "zcopy" count the frames per datagram copied into a TX buffer and sent in
+ * place: the host copies 1480 bytes in a few ten ns, so "ns" mostly shows the cost of the
+ * pbuf and descriptor handling. Usage: Bench_Frag [megabytes], default 256 per line.
+ */
+
+#include "HostSim.h"
+#include "lwip/ip_frag.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MEGABYTES_DEFAULT (256U)
+#define BENCH_VERIFY_DATAGRAMS  (16U)
+#define BENCH_MAX_SIZE          (65000U)  /**< \brief UDP payload, within the 64 KB IP limit */
+#define BENCH_LOCAL_PORT        (5003U)
+#define BENCH_ETH_HDR_LEN       (14U)     /**< \brief on the wire, without ETH_PAD_SIZE */
+
+static const uint32 Bench_sizes[] = {2048, 4096, 8192, 16384, 32768, BENCH_MAX_SIZE};
+
+#define BENCH_SIZES (sizeof(Bench_sizes) / sizeof(Bench_sizes[0]))
+
+/** \brief Implementation under test */
+typedef struct
+{
+    const char *name;
+    err_t       (*frag)(struct pbuf *p, struct netif *netif, const ip_addr_t *dest);
+} Bench_Impl;
+
+/** \brief Result of one run */
+typedef struct
+{
+    double nsPerDatagram;
+    double copied;          /**< \brief Frames copied into a TX buffer per datagram */
+    double zeroCopy;        /**< \brief Frames sent from the pbuf memory per datagram */
+    uint32 failed;          /**< \brief Datagrams ip_frag() did not send completely */
+} Bench_Result;
+
+/** \brief Fragment check of the verify run */
+typedef struct
+{
+    uint32 frames;
+    uint32 bytes;
+    uint32 errors;
+} Bench_Check;
+
+/* static buffer, ip_frag.c built with IP_FRAG_USES_STATIC_BUF 1 */
+err_t ip_frag_static(struct pbuf *p, struct netif *netif, const ip_addr_t *dest);
+
+static uint8              Bench_datagram[IP_HLEN + UDP_HLEN + BENCH_MAX_SIZE];
+static struct pbuf_custom Bench_pbuf;
+static ip_addr_t          Bench_dest;
+
+static void Bench_freeDatagram(struct pbuf *p)
+{
+    (void)p;
+}
+
+
+/** \brief Builds the datagram of "size" UDP payload bytes into the custom pbuf of the bench */
+static struct pbuf *Bench_build(uint32 size)
+{
+    struct netif   *netif = Ifx_Lwip_getNetIf();
+    struct ip_hdr  *iphdr = (struct ip_hdr *)Bench_datagram;
+    struct udp_hdr *udphdr;
+    uint16          total = (uint16)(IP_HLEN + UDP_HLEN + size);
+    uint32          i;
+
+    for (i = IP_HLEN + UDP_HLEN; i < total; i++)
+    {
+        Bench_datagram[i] = (uint8)((i * 7U) + (i >> 8));
+    }
+
+    IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+    IPH_TOS_SET(iphdr, 0);
+    IPH_LEN_SET(iphdr, htons(total));
+    IPH_ID_SET(iphdr, htons(1));
+    IPH_OFFSET_SET(iphdr, 0);
+    IPH_TTL_SET(iphdr, UDP_TTL);
+    IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+    IPH_CHKSUM_SET(iphdr, 0);
+    ip_addr_copy(iphdr->src, netif->ip_addr);
+    ip_addr_copy(iphdr->dest, Bench_dest);
+
+    udphdr         = (struct udp_hdr *)&Bench_datagram[IP_HLEN];
+    udphdr->src    = htons(BENCH_LOCAL_PORT);
+    udphdr->dest   = htons(HOSTSIM_PEER_UDP_PORT);
+    udphdr->len    = htons((uint16)(UDP_HLEN + size));
+    udphdr->chksum = 0;
+
+    Bench_pbuf.custom_free_function = &Bench_freeDatagram;
+
+    return pbuf_alloced_custom(PBUF_RAW, total, PBUF_RAM, &Bench_pbuf, Bench_datagram, total);
+}
+
+
+/** \brief Frame hook of the verify run: compares every fragment with the datagram */
+static void Bench_check(void *context, const uint8 *frame, uint16 length)
+{
+    Bench_Check *check = context;
+    const uint8 *ip    = &frame[BENCH_ETH_HDR_LEN];
+    uint16       total = (uint16)((ip[2] << 8) | ip[3]);
+    uint16       data  = (uint16)(total - IP_HLEN);
+    uint32       start = (uint32)(((ip[6] & 0x1FU) << 8) | ip[7]) * 8U;
+
+    check->frames++;
+    check->bytes += data;
+
+    if ((length < BENCH_ETH_HDR_LEN + total) || (start + data > sizeof(Bench_datagram) - IP_HLEN)
+        || (memcmp(&ip[IP_HLEN], &Bench_datagram[IP_HLEN + start], data) != 0))
+    {
+        check->errors++;
+    }
+}
+
+
+static boolean Bench_verify(const Bench_Impl *impl, struct pbuf *p, uint32 size)
+{
+    Bench_Check        check;
+    HostSim_PeerStats *stats = HostSim_getPeerStats();
+    uint32             i;
+    err_t              err   = ERR_OK;
+
+    memset(&check, 0, sizeof(check));
+    HostSim_resetPeerStats();
+    HostSim_setFrameHook(&Bench_check, &check);
+
+    for (i = 0; (i < BENCH_VERIFY_DATAGRAMS) && (err == ERR_OK); i++)
+    {
+        err = impl->frag(p, Ifx_Lwip_getNetIf(), &Bench_dest);
+    }
+
+    HostSim_setFrameHook(NULL_PTR, NULL_PTR);
+    ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());    /* releases the fragments of the last datagram */
+
+    if ((err != ERR_OK) || (check.errors != 0) || (stats->badChecksum != 0)
+        || (check.bytes != BENCH_VERIFY_DATAGRAMS * (UDP_HLEN + size)) || (p->ref != 1)
+        || (p->payload != Bench_datagram) || (p->len != IP_HLEN + UDP_HLEN + size))
+    {
+        printf("bench_frag: FAILED, %s %u bytes: err %d, %u frames, %u bytes, %u wrong, %u bad checksums\n",
+            impl->name, size, err, check.frames, check.bytes, check.errors, stats->badChecksum);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+static void Bench_run(const Bench_Impl *impl, struct pbuf *p, uint32 datagrams, Bench_Result *result)
+{
+    struct ethernetif_tc2x_txstats *txstats = ethernetif_tc2x_getTxStats();
+    struct ethernetif_tc2x_txstats  before  = *txstats;
+    uint64                          start;
+    uint32                          i;
+
+    result->failed = 0;
+    start          = HostSim_nowNs();
+
+    for (i = 0; i < datagrams; i++)
+    {
+        result->failed += (impl->frag(p, Ifx_Lwip_getNetIf(), &Bench_dest) != ERR_OK);
+    }
+
+    result->nsPerDatagram = (double)(HostSim_nowNs() - start) / datagrams;
+    result->copied        = (double)(txstats->copied - before.copied) / datagrams;
+    result->zeroCopy      = (double)(txstats->zero_copy - before.zero_copy) / datagrams;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32       megabytes = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_MEGABYTES_DEFAULT;
+    boolean      ok        = TRUE;
+    Bench_Impl   ref, copy;
+    Bench_Result rr, rc;
+    uint32       s;
+
+    if (megabytes == 0)
+    {
+        printf("usage: Bench_Frag [megabytes]\n");
+        return EXIT_FAILURE;
+    }
+
+    HostSim_init();
+    HOSTSIM_PEER_IP(&Bench_dest);
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("bench_frag: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    ref.name   = "ref";
+    ref.frag   = &ip_frag;
+    copy.name  = "static";
+    copy.frag  = &ip_frag_static;
+
+    printf("bench_frag: %u MB of UDP payload per line, MTU %u, %u TX descriptors\n", megabytes,
+        Ifx_Lwip_getNetIf()->mtu, IfxEth_getTxDescriptorCount(Ifx_Lwip_getNetIf()->state));
+    printf("%6s %5s | %9s %8s %6s %6s | %9s %8s %6s %6s | %7s\n", "size", "frags", "ref ns", "MB/s", "copied",
+        "zcopy", "static ns", "MB/s", "copied", "zcopy", "speedup");
+
+    for (s = 0; s < BENCH_SIZES; s++)
+    {
+        uint32       size      = Bench_sizes[s];
+        uint32       datagrams = (uint32)(((uint64)megabytes << 20) / size);
+        struct pbuf *p         = Bench_build(size);
+
+        if ((Bench_verify(&ref, p, size) == FALSE) || (Bench_verify(&copy, p, size) == FALSE))
+        {
+            ok = FALSE;
+            pbuf_free(p);
+            continue;
+        }
+
+        Bench_run(&ref, p, datagrams, &rr);
+        Bench_run(&copy, p, datagrams, &rc);
+        pbuf_free(p);
+
+        printf("%6u %5u | %9.0f %8.1f %6.1f %6.1f | %9.0f %8.1f %6.1f %6.1f | %6.2fx\n", size,
+            (UDP_HLEN + size + (Ifx_Lwip_getNetIf()->mtu - IP_HLEN) - 1) / (Ifx_Lwip_getNetIf()->mtu - IP_HLEN),
+            rr.nsPerDatagram, size * 1e3 / rr.nsPerDatagram, rr.copied, rr.zeroCopy,
+            rc.nsPerDatagram, size * 1e3 / rc.nsPerDatagram, rc.copied, rc.zeroCopy,
+            rc.nsPerDatagram / rr.nsPerDatagram);
+
+        if ((rr.failed != 0) || (rc.failed != 0))
+        {
+            printf("bench_frag: FAILED, %u + %u datagrams not sent completely\n", rr.failed, rc.failed);
+            ok = FALSE;
+        }
+    }
+
+    printf("bench_frag: %s\n", ok ? "PASSED" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,763 @@
+/**
+ * \file Bench_MemTrace.c
+ * \brief Host benchmark: mem_malloc() traces replayed against the size classes and the heap
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The trace is the sequence of mem_malloc() and mem_free() calls of the stack. Without a
+ * trace file it is recorded from a workload of the main loop: datagrams of mixed sizes,
+ * sent while the DMA lags behind by a few frames, UDP echo replies and ARP entries that
+ * expire. The calls are caught with the linker option --wrap, see Host.mk.
+ *
+ * The trace is replayed "passes" times, each in a fresh process, against the size classes
+ * of lwippools.h (mem_malloc() of the library) and against the first-fit heap of
+ * MEM_SIZE bytes (mem_heap_malloc(), mem.c built with MEM_USE_POOLS 0). Allocations still
+ * live at the end of a pass are freed before the next one. The tables show the failed
+ * requests, the requests that failed although the heap had enough free bytes, the time
+ * per call, the fragmentation of the heap and the telemetry of every size class.
+ *
+ * Usage: Bench_MemTrace [-w file] [trace file], "-w" writes the trace that is replayed.
+ * A trace file has one call per line: "m <slot> <size>" or "f <slot>", a slot is the
+ * index of a live allocation and is reused once freed.
+ */
+
+#include "HostSim.h"
+#include "Ifx_UdpStream.h"
+#include "lwip/mem.h"
+#include "lwip/memp.h"
+#include "netif/etharp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_LOOPS       (20000U)   /**< \brief Main loop iterations of the recorded workload */
+#define BENCH_PASSES      (20U)      /**< \brief Replays of the trace per allocator */
+#define BENCH_SLOTS       (256U)     /**< \brief Live allocations of a trace */
+#define BENCH_CLASSES     (8U)
+#define BENCH_ECHO_PORT   (5005U)
+#define BENCH_LOCAL_PORT  (5006U)
+#define BENCH_ARP_EXPIRY  (300U)     /**< \brief etharp_tmr() calls, more than ARP_MAXAGE */
+#define BENCH_FREE        (0U)       /**< \brief Size of a Bench_Op that frees its slot */
+#define BENCH_BUCKET_NS   (4U)       /**< \brief Resolution of the latency histograms */
+#define BENCH_BUCKETS     (1024U)    /**< \brief The last bucket takes all calls of 4 us and more */
+
+/** \brief One call of a trace */
+typedef struct
+{
+    uint16 slot;
+    uint16 size;   /**< \brief Requested bytes, BENCH_FREE for mem_free() */
+} Bench_Op;
+
+/** \brief Allocator under test */
+typedef struct
+{
+    const char *name;
+    void        (*init)(void);
+    void       *(*malloc)(mem_size_t size);
+    void        (*free)(void *mem);
+    boolean     heap;
+} Bench_Allocator;
+
+/** \brief Result of one allocator, sent from the child process to the parent */
+typedef struct
+{
+    uint32                 mallocs;
+    uint32                 failed;
+    uint32                 fragmented;       /**< \brief Failed with enough free bytes in the heap */
+    uint64                 mallocNs;
+    uint64                 freeNs;
+    uint32                 mallocMaxNs;
+    uint32                 freeMaxNs;
+    uint32                 mallocHistogram[BENCH_BUCKETS];
+    uint32                 freeHistogram[BENCH_BUCKETS];
+    uint32                 footprint;        /**< \brief Bytes of the heap or of all size classes */
+    uint32                 worstFragment;    /**< \brief Heap: 1/1000 of the free bytes out of the largest block */
+    uint32                 worstWaste;       /**< \brief Size classes: bytes lost to rounding up, at most */
+    struct mem_heap_report heap;             /**< \brief Heap at the end of the last pass */
+    struct mem_class       classes[BENCH_CLASSES];
+    uint32                 classCount;
+} Bench_Result;
+
+/* mem_malloc() and mem_free() of the library, reached through --wrap */
+void *__real_mem_malloc(mem_size_t size);
+void  __real_mem_free(void *mem);
+
+/* first-fit heap, mem.c built with MEM_USE_POOLS 0 */
+void  mem_heap_init(void);
+void *mem_heap_malloc(mem_size_t size);
+void  mem_heap_free(void *mem);
+void  mem_heap_get(struct mem_heap_report *report);
+
+static Bench_Op *Bench_ops;
+static uint32    Bench_opCount;
+static uint32    Bench_opCapacity;
+static boolean   Bench_recording;
+static void     *Bench_live[BENCH_SLOTS];
+static uint32    Bench_seed = 1;
+static udp_pcb_t *Bench_echo;
+
+/* payload sizes of the workload, one draw per datagram: mostly the 100 byte process data */
+static const uint16 Bench_payloadSizes[] = {8, 32, 64, 100, 100, 100, 100, 100, 100, 100, 100, 200, 256, 512, 1024, 1472};
+
+#define BENCH_PAYLOAD_SIZES (sizeof(Bench_payloadSizes) / sizeof(Bench_payloadSizes[0]))
+
+static uint32 Bench_random(uint32 range)
+{
+    Bench_seed = (Bench_seed * 1103515245U) + 12345U;
+    return (Bench_seed >> 16) % range;
+}
+
+
+static void Bench_append(uint16 slot, uint16 size)
+{
+    if (Bench_opCount == Bench_opCapacity)
+    {
+        Bench_opCapacity = (Bench_opCapacity != 0) ? (2 * Bench_opCapacity) : 4096U;
+        Bench_ops        = realloc(Bench_ops, Bench_opCapacity * sizeof(Bench_Op));
+
+        if (Bench_ops == NULL)
+        {
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    Bench_ops[Bench_opCount].slot = slot;
+    Bench_ops[Bench_opCount].size = size;
+    Bench_opCount++;
+}
+
+
+void *__wrap_mem_malloc(mem_size_t size)
+{
+    void  *mem = __real_mem_malloc(size);
+    uint16 slot;
+
+    if (Bench_recording != FALSE)
+    {
+        for (slot = 0; (slot < BENCH_SLOTS) && (Bench_live[slot] != NULL); slot++)
+        {}
+
+        if (slot < BENCH_SLOTS)
+        {
+            /* a failed request is kept as a request freed at once */
+            Bench_live[slot] = mem;
+            Bench_append(slot, (uint16)__max(size, 1));
+
+            if (mem == NULL)
+            {
+                Bench_append(slot, BENCH_FREE);
+            }
+        }
+    }
+
+    return mem;
+}
+
+
+void __wrap_mem_free(void *mem)
+{
+    uint16 slot;
+
+    if (Bench_recording != FALSE)
+    {
+        for (slot = 0; (slot < BENCH_SLOTS) && (Bench_live[slot] != mem); slot++)
+        {}
+
+        if ((mem != NULL) && (slot < BENCH_SLOTS))
+        {
+            Bench_live[slot] = NULL;
+            Bench_append(slot, BENCH_FREE);
+        }
+    }
+
+    __real_mem_free(mem);
+}
+
+
+static void Bench_onEcho(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    pbuf_t *q = pbuf_alloc(PBUF_TRANSPORT, p->tot_len, PBUF_RAM);
+
+    (void)arg;
+
+    if (q != NULL)
+    {
+        pbuf_copy(q, p);
+        udp_sendto(pcb, q, addr, port);
+        pbuf_free(q);
+    }
+
+    pbuf_free(p);
+}
+
+
+static void Bench_send(udp_pcb_t *udp, ip_addr_t *addr, uint16 length)
+{
+    pbuf_t *p = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
+
+    if (p != NULL)
+    {
+        memset(p->payload, 0x5A, length);
+        udp_sendto_if(udp, p, addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+        pbuf_free(p);
+    }
+}
+
+
+/** \brief Runs the workload and records its trace, runs in a child process */
+static void Bench_record(void)
+{
+    uint8      frame[IFXETH_RTX_BUFFER_SIZE];
+    uint8      payload[IFX_UDPSTREAM_MAX_PAYLOAD];
+    ip_addr_t  addr;
+    udp_pcb_t *udp;
+    IfxEth    *eth;
+    uint32     loop, i;
+
+    memset(Bench_live, 0, sizeof(Bench_live));
+    memset(payload, 0xA5, sizeof(payload));
+    Bench_recording = TRUE;
+
+    HostSim_init();
+    HOSTSIM_PEER_IP(&addr);
+    eth = Ifx_Lwip_getEth();
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    udp = udp_new();
+    udp_bind(udp, IP_ADDR_ANY, BENCH_LOCAL_PORT);
+    Bench_echo = udp_new();
+    udp_bind(Bench_echo, IP_ADDR_ANY, BENCH_ECHO_PORT);
+    udp_recv(Bench_echo, &Bench_onEcho, NULL);
+
+    /* the DMA sends the frames of the ring later, a few at a time */
+    IfxEth_Host_setTxAutoProcess(eth, FALSE);
+
+    for (loop = 0; loop < BENCH_LOOPS; loop++)
+    {
+        uint32 count = 1 + Bench_random(3);
+
+        for (i = 0; i < count; i++)
+        {
+            Bench_send(udp, &addr, Bench_payloadSizes[Bench_random(BENCH_PAYLOAD_SIZES)]);
+        }
+
+        count = Bench_random(3);
+
+        for (i = 0; i < count; i++)
+        {
+            uint16 length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, BENCH_ECHO_PORT, payload,
+                Bench_payloadSizes[Bench_random(BENCH_PAYLOAD_SIZES)]);
+            HostSim_inject(frame, length);
+        }
+
+        if ((loop % 5000U) == 4999U)
+        {
+            /* the ARP entry expires, the next datagram is queued until the peer answers */
+            for (i = 0; i < BENCH_ARP_EXPIRY; i++)
+            {
+                etharp_tmr();
+            }
+        }
+
+        IfxEth_Host_processTransmit(eth, 2 + Bench_random(4));
+        HostSim_poll();
+    }
+
+    IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+    HostSim_poll();
+    Bench_recording = FALSE;
+}
+
+
+static boolean Bench_writeAll(int fd, const void *data, size_t length)
+{
+    const uint8 *bytes = data;
+
+    while (length > 0)
+    {
+        ssize_t done = write(fd, bytes, length);
+
+        if (done <= 0)
+        {
+            return FALSE;
+        }
+
+        bytes  += done;
+        length -= (size_t)done;
+    }
+
+    return TRUE;
+}
+
+
+static boolean Bench_readAll(int fd, void *data, size_t length)
+{
+    uint8 *bytes = data;
+
+    while (length > 0)
+    {
+        ssize_t done = read(fd, bytes, length);
+
+        if (done <= 0)
+        {
+            return FALSE;
+        }
+
+        bytes  += done;
+        length -= (size_t)done;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief Records the workload in a child process, the trace comes back through a pipe */
+static boolean Bench_recordTrace(void)
+{
+    int     channel[2];
+    int     status;
+    pid_t   child;
+    boolean ok;
+
+    fflush(stdout);
+
+    if (pipe(channel) != 0)
+    {
+        return FALSE;
+    }
+
+    child = fork();
+
+    if (child == 0)
+    {
+        close(channel[0]);
+        Bench_record();
+        ok = Bench_writeAll(channel[1], &Bench_opCount, sizeof(Bench_opCount))
+             && Bench_writeAll(channel[1], Bench_ops, Bench_opCount * sizeof(Bench_Op));
+        _exit(ok ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    close(channel[1]);
+    ok = (child > 0) && Bench_readAll(channel[0], &Bench_opCount, sizeof(Bench_opCount));
+
+    if (ok)
+    {
+        Bench_opCapacity = Bench_opCount;
+        Bench_ops        = malloc((Bench_opCount + 1) * sizeof(Bench_Op));
+        ok               = (Bench_ops != NULL) && Bench_readAll(channel[0], Bench_ops, Bench_opCount * sizeof(Bench_Op));
+    }
+
+    close(channel[0]);
+
+    if (child > 0)
+    {
+        waitpid(child, &status, 0);
+    }
+
+    return ok;
+}
+
+
+static boolean Bench_loadTrace(const char *name)
+{
+    FILE        *file = fopen(name, "r");
+    char         op;
+    unsigned int slot, size;
+    boolean      ok   = (file != NULL);
+
+    while (ok && (fscanf(file, " %c %u", &op, &slot) == 2))
+    {
+        if ((op == 'm') && (fscanf(file, "%u", &size) == 1) && (slot < BENCH_SLOTS) && (size > 0) && (size <= 0xFFFFU))
+        {
+            Bench_append((uint16)slot, (uint16)size);
+        }
+        else if ((op == 'f') && (slot < BENCH_SLOTS))
+        {
+            Bench_append((uint16)slot, BENCH_FREE);
+        }
+        else
+        {
+            ok = FALSE;
+        }
+    }
+
+    if (file != NULL)
+    {
+        ok = ok && feof(file);
+        fclose(file);
+    }
+
+    return ok;
+}
+
+
+static boolean Bench_writeTrace(const char *name)
+{
+    FILE  *file = fopen(name, "w");
+    uint32 i;
+
+    if (file == NULL)
+    {
+        return FALSE;
+    }
+
+    for (i = 0; i < Bench_opCount; i++)
+    {
+        if (Bench_ops[i].size != BENCH_FREE)
+        {
+            fprintf(file, "m %u %u\n", Bench_ops[i].slot, Bench_ops[i].size);
+        }
+        else
+        {
+            fprintf(file, "f %u\n", Bench_ops[i].slot);
+        }
+    }
+
+    return fclose(file) == 0;
+}
+
+
+/** \brief Time of one call after the timer overhead, added to the histogram */
+static uint32 Bench_elapsed(uint64 start, uint32 overhead, uint32 *histogram)
+{
+    uint64 elapsed = HostSim_nowNs() - start;
+
+    elapsed = (elapsed > overhead) ? (elapsed - overhead) : 0;
+    histogram[__min(elapsed / BENCH_BUCKET_NS, BENCH_BUCKETS - 1)]++;
+    return (uint32)elapsed;
+}
+
+
+/** \brief Upper bound of the 99.9th percentile of a histogram */
+static uint32 Bench_percentile(const uint32 *histogram)
+{
+    uint32 total = 0, count = 0;
+    uint32 b;
+
+    for (b = 0; b < BENCH_BUCKETS; b++)
+    {
+        total += histogram[b];
+    }
+
+    for (b = 0; (b < (BENCH_BUCKETS - 1)) && ((uint64)(count + histogram[b]) * 1000U < (uint64)total * 999U); b++)
+    {
+        count += histogram[b];
+    }
+
+    return (b + 1) * BENCH_BUCKET_NS;
+}
+
+
+static uint32 Bench_timerOverhead(void)
+{
+    uint64 best = ~0ULL;
+    uint32 i;
+
+    for (i = 0; i < 1000; i++)
+    {
+        uint64 start   = HostSim_nowNs();
+        uint64 elapsed = HostSim_nowNs() - start;
+        best = __min(best, elapsed);
+    }
+
+    return (uint32)best;
+}
+
+
+/** \brief Bytes lost to rounding up in the size classes */
+static uint32 Bench_classWaste(void)
+{
+    const struct mem_class *memClass;
+    uint32                  waste = 0;
+    uint8                   c;
+
+    for (c = 0; (memClass = mem_class_get(c)) != NULL; c++)
+    {
+        waste += ((uint32)memClass->used * memClass->size) - memClass->requested;
+    }
+
+    return waste;
+}
+
+
+/** \brief Replays the trace "passes" times, runs in the child process */
+static void Bench_replay(const Bench_Allocator *allocator, uint32 passes, Bench_Result *result)
+{
+    uint32                  overhead = Bench_timerOverhead();
+    struct mem_heap_report  heap;
+    const struct mem_class *memClass;
+    uint32                  pass, i;
+    uint16                  slot;
+
+    allocator->init();
+    memset(Bench_live, 0, sizeof(Bench_live));
+
+    for (pass = 0; pass < passes; pass++)
+    {
+        for (i = 0; i < Bench_opCount; i++)
+        {
+            const Bench_Op *op = &Bench_ops[i];
+            uint64          start;
+            uint32          elapsed;
+
+            if (op->size != BENCH_FREE)
+            {
+                if (Bench_live[op->slot] != NULL)
+                {
+                    continue;
+                }
+
+                start                = HostSim_nowNs();
+                Bench_live[op->slot] = allocator->malloc(op->size);
+                elapsed              = Bench_elapsed(start, overhead, result->mallocHistogram);
+                result->mallocs++;
+                result->mallocNs    += elapsed;
+                result->mallocMaxNs  = __max(result->mallocMaxNs, elapsed);
+
+                if (Bench_live[op->slot] == NULL)
+                {
+                    result->failed++;
+
+                    if (allocator->heap)
+                    {
+                        mem_heap_get(&heap);
+                        result->fragmented += (heap.free > op->size) ? 1 : 0;
+                    }
+                }
+            }
+            else if (Bench_live[op->slot] != NULL)
+            {
+                start                = HostSim_nowNs();
+                allocator->free(Bench_live[op->slot]);
+                elapsed              = Bench_elapsed(start, overhead, result->freeHistogram);
+                Bench_live[op->slot] = NULL;
+                result->freeNs      += elapsed;
+                result->freeMaxNs    = __max(result->freeMaxNs, elapsed);
+            }
+
+            if (allocator->heap)
+            {
+                mem_heap_get(&heap);
+
+                if (heap.free != 0)
+                {
+                    result->worstFragment = __max(result->worstFragment, 1000U - ((1000U * heap.largest) / heap.free));
+                }
+            }
+            else
+            {
+                result->worstWaste = __max(result->worstWaste, Bench_classWaste());
+            }
+        }
+
+        if (allocator->heap && (pass == (passes - 1)))
+        {
+            mem_heap_get(&result->heap);
+        }
+
+        for (slot = 0; slot < BENCH_SLOTS; slot++)
+        {
+            if (Bench_live[slot] != NULL)
+            {
+                allocator->free(Bench_live[slot]);
+                Bench_live[slot] = NULL;
+            }
+        }
+    }
+
+    if (allocator->heap)
+    {
+        result->footprint = result->heap.size;
+    }
+    else
+    {
+        for (i = 0; (i < BENCH_CLASSES) && ((memClass = mem_class_get((u8_t)i)) != NULL); i++)
+        {
+            result->classes[i]  = *memClass;
+            result->footprint  += (uint32)memp_sizes[MEMP_POOL_FIRST + i] * memClass->num;
+        }
+
+        result->classCount = i;
+    }
+}
+
+
+static void Bench_initPools(void)
+{
+    memp_init();
+}
+
+
+static const Bench_Allocator Bench_allocators[] = {
+    {"heap",  &mem_heap_init,   &mem_heap_malloc,   &mem_heap_free,   TRUE },
+    {"pools", &Bench_initPools, &__real_mem_malloc, &__real_mem_free, FALSE},
+};
+
+#define BENCH_ALLOCATORS (sizeof(Bench_allocators) / sizeof(Bench_allocators[0]))
+
+int main(int argc, char **argv)
+{
+    const char  *output = NULL;
+    const char  *input  = NULL;
+    Bench_Result results[BENCH_ALLOCATORS];
+    uint32       mallocs = 0, peak = 0, live = 0, largest = 0;
+    uint32       a, i;
+    int          result  = EXIT_SUCCESS;
+
+    for (i = 1; i < (uint32)argc; i++)
+    {
+        if ((strcmp(argv[i], "-w") == 0) && ((i + 1) < (uint32)argc))
+        {
+            output = argv[++i];
+        }
+        else if (input == NULL)
+        {
+            input = argv[i];
+        }
+        else
+        {
+            input = NULL;
+            break;
+        }
+    }
+
+    if ((input == NULL) && (argc > ((output != NULL) ? 3 : 1)))
+    {
+        printf("usage: Bench_MemTrace [-w file] [trace file]\n");
+        return EXIT_FAILURE;
+    }
+
+    if ((input != NULL) ? (Bench_loadTrace(input) == FALSE) : (Bench_recordTrace() == FALSE))
+    {
+        printf("bench_memtrace: FAILED, no trace from %s\n", (input != NULL) ? input : "the workload");
+        return EXIT_FAILURE;
+    }
+
+    if ((output != NULL) && (Bench_writeTrace(output) == FALSE))
+    {
+        printf("bench_memtrace: FAILED, cannot write %s\n", output);
+        return EXIT_FAILURE;
+    }
+
+    memset(Bench_live, 0, sizeof(Bench_live));
+
+    for (i = 0; i < Bench_opCount; i++)
+    {
+        if (Bench_ops[i].size != BENCH_FREE)
+        {
+            mallocs++;
+            largest = __max(largest, Bench_ops[i].size);
+            live   += (Bench_live[Bench_ops[i].slot] == NULL) ? 1 : 0;
+            Bench_live[Bench_ops[i].slot] = &Bench_live[Bench_ops[i].slot];
+        }
+        else
+        {
+            live -= (Bench_live[Bench_ops[i].slot] != NULL) ? 1 : 0;
+            Bench_live[Bench_ops[i].slot] = NULL;
+        }
+
+        peak = __max(peak, live);
+    }
+
+    printf("bench_memtrace: %u calls, %u mem_malloc() up to %u bytes, at most %u live, %u passes\n",
+        Bench_opCount, mallocs, largest, peak, BENCH_PASSES);
+
+    for (a = 0; a < BENCH_ALLOCATORS; a++)
+    {
+        int   channel[2];
+        int   status;
+        pid_t child;
+
+        fflush(stdout);
+
+        if (pipe(channel) != 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        child = fork();
+
+        if (child == 0)
+        {
+            Bench_Result own;
+
+            close(channel[0]);
+            memset(&own, 0, sizeof(own));
+            Bench_replay(&Bench_allocators[a], BENCH_PASSES, &own);
+            _exit(Bench_writeAll(channel[1], &own, sizeof(own)) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+
+        close(channel[1]);
+
+        if ((child < 0) || (Bench_readAll(channel[0], &results[a], sizeof(results[a])) == FALSE))
+        {
+            printf("bench_memtrace: FAILED, no result for the %s\n", Bench_allocators[a].name);
+            memset(&results[a], 0, sizeof(results[a]));
+            result = EXIT_FAILURE;
+        }
+
+        close(channel[0]);
+
+        if (child > 0)
+        {
+            waitpid(child, &status, 0);
+        }
+    }
+
+    printf("%-9s %9s %8s %10s %10s %8s %8s %8s %8s %8s\n", "allocator", "footprint", "failed", "fragmented",
+        "malloc ns", "p99.9", "max", "free ns", "p99.9", "max");
+
+    for (a = 0; a < BENCH_ALLOCATORS; a++)
+    {
+        Bench_Result *r = &results[a];
+
+        printf("%-9s %9u %8u %10u %10.1f %8u %8u %8.1f %8u %8u\n", Bench_allocators[a].name, r->footprint,
+            r->failed, r->fragmented, (double)r->mallocNs / (double)__max(r->mallocs, 1),
+            Bench_percentile(r->mallocHistogram), r->mallocMaxNs,
+            (double)r->freeNs / (double)__max(r->mallocs - r->failed, 1), Bench_percentile(r->freeHistogram),
+            r->freeMaxNs);
+    }
+
+    for (a = 0; a < BENCH_ALLOCATORS; a++)
+    {
+        Bench_Result *r = &results[a];
+
+        if (Bench_allocators[a].heap)
+        {
+            printf("heap: high-water mark %u of %u bytes, worst fragmentation %.1f%% "
+                   "(free bytes outside the largest block), %u free blocks at the end\n",
+                r->heap.max, r->heap.size, (double)r->worstFragment / 10.0, r->heap.blocks);
+        }
+        else
+        {
+            printf("pools: at most %u bytes lost to rounding up\n", r->worstWaste);
+            printf("%8s %6s %6s %10s %8s %8s\n", "class", "num", "max", "allocs", "spills", "failed");
+
+            for (i = 0; i < r->classCount; i++)
+            {
+                const struct mem_class *c = &r->classes[i];
+                printf("%8u %6u %6u %10u %8u %8u\n", c->size, c->num, c->max, c->allocs, c->spills, c->err);
+            }
+        }
+    }
+
+    return result;
+}
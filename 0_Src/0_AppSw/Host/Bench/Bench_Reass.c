@@ -0,0 +1,404 @@
+/**
+ * \file Bench_Reass.c
+ * \brief Host benchmark: IP reassembly with hole descriptors against the sorted fragment list
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The same fragment streams run through ip_frag.c built twice more (see Host.mk): with
+ * IP_REASS_HOLES 1 and its functions renamed to ip_reass_holes_*, and with IP_REASS_HOLES 0
+ * renamed to ip_reass_list_*. Both queue up to 96 pbufs, so 4 datagrams of 32 KB fit, the
+ * library itself keeps IP_REASS_MAX_PBUFS of lwipopts.h. Every datagram is cut into
+ * fragments of 1480 bytes, as with an MTU of 1500, and passed to ip_reass() in one of these
+ * orders:
+ * - inorder:    fragments in order, one datagram after the other
+ * - reverse:    last fragment first
+ * - shuffle:    random order within the datagram
+ * - duplicate:  random order, every fragment but the last one twice in a row
+ * - loss:       random order, every 4th datagram misses one fragment
+ * - interleave: 4 datagrams at a time, their fragments round robin in order
+ *
+ * The fragments are custom pbufs from a pool of the bench: "peak" is the highest number of
+ * fragment buffers held at a time by the reassembly and the datagram being delivered, in
+ * KB. ip_reass_tmr() runs every BENCH_TMR_PERIOD datagrams. The payload of every datagram
+ * is checked in an untimed run before. Usage: Bench_Reass [datagrams], default 20000 per
+ * line.
+ */
+
+#include "HostSim.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/ip_frag.h"
+#include "lwip/memp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DATAGRAMS_DEFAULT (20000U)
+#define BENCH_VERIFY_DATAGRAMS  (64U)
+#define BENCH_FRAG_DATA         (1480U)   /**< \brief IP payload per fragment, MTU 1500 */
+#define BENCH_MAX_SIZE          (32768U)
+#define BENCH_MAX_FRAGS         ((BENCH_MAX_SIZE + BENCH_FRAG_DATA - 1) / BENCH_FRAG_DATA)
+#define BENCH_INTERLEAVE        (4U)
+#define BENCH_LOSS_PERIOD       (4U)
+#define BENCH_TMR_PERIOD        (256U)
+#define BENCH_BUFFERS           (256U)    /**< \brief Fragment buffers, more than IP_REASS_MAX_PBUFS of Host.mk */
+
+static const uint32 Bench_sizes[] = {8192, 16384, BENCH_MAX_SIZE};
+
+#define BENCH_SIZES (sizeof(Bench_sizes) / sizeof(Bench_sizes[0]))
+
+typedef enum
+{
+    Bench_Order_inorder = 0,
+    Bench_Order_reverse,
+    Bench_Order_shuffle,
+    Bench_Order_duplicate,
+    Bench_Order_loss,
+    Bench_Order_interleave,
+    Bench_Order_count
+} Bench_Order;
+
+static const char *const Bench_orderNames[Bench_Order_count] = {
+    "inorder", "reverse", "shuffle", "duplicate", "loss", "interleave"
+};
+
+/** \brief Implementation under test */
+typedef struct
+{
+    const char            *name;
+    struct pbuf          *(*reass)(struct pbuf *p);
+    void                   (*tmr)(void);
+    struct ip_reass_stats *stats;
+} Bench_Impl;
+
+/** \brief Fragment buffer, a custom pbuf returned to Bench_free by pbuf_free() */
+typedef struct Bench_Buffer_
+{
+    struct pbuf_custom     pc;
+    struct Bench_Buffer_ *next;
+    uint32                 data[(IP_HLEN + BENCH_FRAG_DATA + 3) / 4];
+} Bench_Buffer;
+
+/** \brief Result of one run */
+typedef struct
+{
+    double nsPerFrag;
+    uint32 complete;
+    uint32 peak;            /**< \brief Fragment buffers held at a time */
+    uint32 evicted;
+} Bench_Result;
+
+/* hole descriptors, ip_frag.c built with IP_REASS_HOLES 1 */
+struct pbuf *ip_reass_holes(struct pbuf *p);
+void         ip_reass_holes_tmr(void);
+extern struct ip_reass_stats ip_reass_holes_stats;
+
+/* sorted fragment list, ip_frag.c built with IP_REASS_HOLES 0 */
+struct pbuf *ip_reass_list(struct pbuf *p);
+void         ip_reass_list_tmr(void);
+extern struct ip_reass_stats ip_reass_list_stats;
+
+static Bench_Buffer  Bench_buffers[BENCH_BUFFERS];
+static Bench_Buffer *Bench_free;
+static uint32        Bench_inUse;
+static uint32        Bench_inUseMax;
+static uint32        Bench_random = 12345;
+
+static void Bench_freeBuffer(struct pbuf *p)
+{
+    Bench_Buffer *buffer = (Bench_Buffer *)p;
+
+    buffer->next = Bench_free;
+    Bench_free   = buffer;
+    Bench_inUse--;
+}
+
+
+static uint32 Bench_rand(uint32 range)
+{
+    Bench_random = (Bench_random * 1103515245U) + 12345U;
+
+    return (Bench_random >> 8) % range;
+}
+
+
+/** \brief Payload byte "offset" of datagram "id" */
+static uint8 Bench_pattern(uint16 id, uint32 offset)
+{
+    return (uint8)((id * 7U) + offset + (offset >> 8));
+}
+
+
+/** \brief Builds fragment "frag" of datagram "id" of "size" bytes, the payload only if "fill" */
+static struct pbuf *Bench_fragment(uint16 id, uint32 size, uint32 frag, boolean fill)
+{
+    Bench_Buffer  *buffer = Bench_free;
+    struct ip_hdr *iphdr;
+    ip_addr_t      src, dest;
+    uint32         offset = frag * BENCH_FRAG_DATA;
+    uint32         length = ((size - offset) < BENCH_FRAG_DATA) ? (size - offset) : BENCH_FRAG_DATA;
+    boolean        more   = (offset + length) < size;
+    uint8         *data;
+    uint32         i;
+
+    if (buffer == NULL)
+    {
+        printf("bench_reass: FAILED, out of fragment buffers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    Bench_free = buffer->next;
+
+    if (++Bench_inUse > Bench_inUseMax)
+    {
+        Bench_inUseMax = Bench_inUse;
+    }
+
+    HOSTSIM_PEER_IP(&src);
+    HOSTSIM_LOCAL_IP(&dest);
+    iphdr = (struct ip_hdr *)buffer->data;
+    IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+    IPH_TOS_SET(iphdr, 0);
+    IPH_LEN_SET(iphdr, htons((u16_t)(IP_HLEN + length)));
+    IPH_ID_SET(iphdr, htons(id));
+    IPH_OFFSET_SET(iphdr, htons((u16_t)((offset / 8) | (more ? IP_MF : 0))));
+    IPH_TTL_SET(iphdr, 64);
+    IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+    IPH_CHKSUM_SET(iphdr, 0);
+    ip_addr_copy(iphdr->src, src);
+    ip_addr_copy(iphdr->dest, dest);
+
+    if (fill != FALSE)
+    {
+        data = (uint8 *)buffer->data + IP_HLEN;
+
+        for (i = 0; i < length; i++)
+        {
+            data[i] = Bench_pattern(id, offset + i);
+        }
+    }
+
+    buffer->pc.custom_free_function = &Bench_freeBuffer;
+
+    return pbuf_alloced_custom(PBUF_RAW, (u16_t)(IP_HLEN + length), PBUF_REF, &buffer->pc, buffer->data,
+        sizeof(buffer->data));
+}
+
+
+/** \brief Checks and frees a reassembled datagram */
+static boolean Bench_deliver(struct pbuf *p, uint32 size, boolean verify)
+{
+    static uint8   datagram[IP_HLEN + BENCH_MAX_SIZE];
+    struct ip_hdr *iphdr = (struct ip_hdr *)p->payload;
+    uint16         id    = ntohs(IPH_ID(iphdr));
+    boolean        ok    = (p->tot_len == IP_HLEN + size) && (ntohs(IPH_LEN(iphdr)) == IP_HLEN + size);
+    uint32         i;
+
+    if (ok && (verify != FALSE))
+    {
+        ok = (pbuf_copy_partial(p, datagram, p->tot_len, 0) == p->tot_len) &&
+             (inet_chksum(datagram, IP_HLEN) == 0) && ((ntohs(IPH_OFFSET(iphdr)) & (IP_MF | IP_OFFMASK)) == 0);
+
+        for (i = 0; ok && (i < size); i++)
+        {
+            ok = (datagram[IP_HLEN + i] == Bench_pattern(id, i));
+        }
+    }
+
+    pbuf_free(p);
+
+    return ok;
+}
+
+
+/** \brief Fragment order of one datagram of "frags" fragments, returns the number of entries */
+static uint32 Bench_order(Bench_Order order, uint32 datagram, uint32 frags, uint8 *entries)
+{
+    uint32 count = frags;
+    uint32 i, j;
+    uint8  tmp;
+
+    for (i = 0; i < frags; i++)
+    {
+        entries[i] = (uint8)((order == Bench_Order_reverse) ? (frags - 1 - i) : i);
+    }
+
+    if ((order == Bench_Order_shuffle) || (order == Bench_Order_duplicate) || (order == Bench_Order_loss))
+    {
+        for (i = frags - 1; i > 0; i--)
+        {
+            j          = Bench_rand(i + 1);
+            tmp        = entries[i];
+            entries[i] = entries[j];
+            entries[j] = tmp;
+        }
+    }
+
+    if (order == Bench_Order_duplicate)
+    {
+        /* a duplicate of the last fragment would start the datagram again */
+        entries[2 * frags - 2] = entries[frags - 1];
+        count                  = 2 * frags - 1;
+
+        for (i = frags - 1; i-- > 0;)
+        {
+            entries[2 * i]     = entries[i];
+            entries[2 * i + 1] = entries[i];
+        }
+    }
+
+    if ((order == Bench_Order_loss) && ((datagram % BENCH_LOSS_PERIOD) == 0))
+    {
+        count--;
+    }
+
+    return count;
+}
+
+
+/** \brief Passes "datagrams" datagrams of "size" bytes to the implementation in the given order */
+static boolean Bench_run(Bench_Impl *impl, Bench_Order order, uint32 size, uint32 datagrams, boolean verify,
+                         Bench_Result *result)
+{
+    static uint8 entries[BENCH_INTERLEAVE][2 * BENCH_MAX_FRAGS];
+    uint32       counts[BENCH_INTERLEAVE];
+    uint32       frags    = (size + BENCH_FRAG_DATA - 1) / BENCH_FRAG_DATA;
+    uint32       group    = (order == Bench_Order_interleave) ? BENCH_INTERLEAVE : 1;
+    uint32       expected = datagrams;
+    uint32       sent     = 0;
+    uint32       evicted  = impl->stats->evicted;
+    uint32       d, g, n, i;
+    uint64       start;
+    boolean      ok       = TRUE;
+    struct pbuf *p;
+
+    Bench_inUseMax   = 0;
+    result->complete = 0;
+    start            = HostSim_nowNs();
+
+    for (d = 0; d < datagrams; d += group)
+    {
+        for (g = 0; (g < group) && ((d + g) < datagrams); g++)
+        {
+            counts[g]  = Bench_order(order, d + g, frags, entries[g]);
+            expected  -= ((order == Bench_Order_loss) && (counts[g] < frags));
+        }
+
+        for (n = 0; n < 2 * frags; n++)
+        {
+            for (i = 0; i < g; i++)
+            {
+                if (n < counts[i])
+                {
+                    p = impl->reass(Bench_fragment((uint16)(d + i), size, entries[i][n], verify));
+                    sent++;
+
+                    if (p != NULL)
+                    {
+                        ok = ok && Bench_deliver(p, size, verify);
+                        result->complete++;
+                    }
+                }
+            }
+        }
+
+        if (((d / group) % (BENCH_TMR_PERIOD / group)) == 0)
+        {
+            impl->tmr();
+        }
+    }
+
+    result->nsPerFrag = (double)(HostSim_nowNs() - start) / sent;
+    result->peak      = Bench_inUseMax;
+    result->evicted   = impl->stats->evicted - evicted;
+
+    /* everything left times out */
+    for (i = 0; i <= IP_REASS_MAXAGE; i++)
+    {
+        impl->tmr();
+    }
+
+    if ((ok == FALSE) || (result->complete != expected) || (Bench_inUse != 0))
+    {
+        printf("bench_reass: FAILED, %s %s %u bytes, %u of %u datagrams complete, payload %s, %u buffers held\n",
+            impl->name, Bench_orderNames[order], size, result->complete, expected, ok ? "ok" : "wrong", Bench_inUse);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32       datagrams = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_DATAGRAMS_DEFAULT;
+    boolean      ok        = TRUE;
+    Bench_Impl   holes, list;
+    Bench_Result rh, rl;
+    uint32       o, s;
+
+    if (datagrams == 0)
+    {
+        printf("usage: Bench_Reass [datagrams]\n");
+        return EXIT_FAILURE;
+    }
+
+    memp_init();
+    pbuf_init();
+
+    for (s = 0; s < BENCH_BUFFERS; s++)
+    {
+        Bench_buffers[s].next = Bench_free;
+        Bench_free            = &Bench_buffers[s];
+    }
+
+    holes.name  = "holes";
+    holes.reass = &ip_reass_holes;
+    holes.tmr   = &ip_reass_holes_tmr;
+    holes.stats = &ip_reass_holes_stats;
+    list.name   = "list";
+    list.reass  = &ip_reass_list;
+    list.tmr    = &ip_reass_list_tmr;
+    list.stats  = &ip_reass_list_stats;
+
+    printf("bench_reass: %u datagrams per line, fragments of %u bytes, %u fragment buffers of %u bytes\n",
+        datagrams, BENCH_FRAG_DATA, BENCH_BUFFERS, (uint32)sizeof(Bench_Buffer));
+    printf("%-10s %6s %5s | %8s %8s %7s | %8s %8s %7s\n", "order", "size", "frags", "holes ns", "peak KB", "evicted",
+        "list ns", "peak KB", "evicted");
+
+    for (o = 0; o < Bench_Order_count; o++)
+    {
+        for (s = 0; s < BENCH_SIZES; s++)
+        {
+            if (!Bench_run(&holes, (Bench_Order)o, Bench_sizes[s], BENCH_VERIFY_DATAGRAMS, TRUE, &rh) ||
+                !Bench_run(&list, (Bench_Order)o, Bench_sizes[s], BENCH_VERIFY_DATAGRAMS, TRUE, &rl) ||
+                !Bench_run(&holes, (Bench_Order)o, Bench_sizes[s], datagrams, FALSE, &rh) ||
+                !Bench_run(&list, (Bench_Order)o, Bench_sizes[s], datagrams, FALSE, &rl))
+            {
+                ok = FALSE;
+                continue;
+            }
+
+            printf("%-10s %6u %5u | %8.1f %8.1f %7u | %8.1f %8.1f %7u\n", Bench_orderNames[o], Bench_sizes[s],
+                (Bench_sizes[s] + BENCH_FRAG_DATA - 1) / BENCH_FRAG_DATA, rh.nsPerFrag,
+                rh.peak * (IP_HLEN + BENCH_FRAG_DATA) / 1024.0, rh.evicted, rl.nsPerFrag,
+                rl.peak * (IP_HLEN + BENCH_FRAG_DATA) / 1024.0, rl.evicted);
+        }
+    }
+
+    printf("holes: %u duplicates, %u timeouts; list: %u duplicates, %u timeouts\n", ip_reass_holes_stats.duplicates,
+        ip_reass_holes_stats.timeouts, ip_reass_list_stats.duplicates, ip_reass_list_stats.timeouts);
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,234 @@
+/**
+ * \file Bench_RingSweep.c
+ * \brief Host benchmark: RX descriptor ring depth against burst size
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * Every RX ring depth is run in its own process, the stack is initialised once per process
+ * with rings provided through ethernetif_tc2x_setConfig(). Bursts of UDP frames are
+ * written into the RX ring, the main loop is modelled by one Ifx_Lwip_pollReceive() of
+ * "budget" frames after every "arrivals" frames. The ring absorbs a burst when it holds
+ * the backlog built up meanwhile; the table shows the frames dropped by the MAC and the
+ * smallest depth without drops (the knee) per burst size.
+ *
+ * Usage: Bench_RingSweep [arrivals per poll] [frames per poll], default 4 and 2. The
+ * ratio stands for the wire rate against the rate of the main loop on the target, the
+ * host itself adds no timing.
+ */
+
+#include "HostSim.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_LOCAL_PORT (5003U)
+#define BENCH_PAYLOAD    (64U)
+
+/* Reference to the global low-level driver configuration */
+extern const IfxEth_Config cfg_Eth;
+
+static const uint16 Bench_depths[] = {4, 8, 16, 32, 64, 128, 256};
+static const uint16 Bench_bursts[] = {8, 16, 32, 64, 128, 256, 512};
+
+#define BENCH_DEPTHS (sizeof(Bench_depths) / sizeof(Bench_depths[0]))
+#define BENCH_BURSTS (sizeof(Bench_bursts) / sizeof(Bench_bursts[0]))
+
+/** \brief Result of one depth, sent from the child process to the parent */
+typedef struct
+{
+    uint32 dropped[BENCH_BURSTS];     /**< \brief Frames rejected by the RX ring per burst */
+    uint32 lost[BENCH_BURSTS];        /**< \brief Frames neither received nor counted as dropped */
+} Bench_Result;
+
+static uint32 Bench_received;
+
+static void Bench_onReceive(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    (void)arg;
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    Bench_received++;
+    pbuf_free(p);
+}
+
+
+/** \brief Sweeps the bursts on one ring depth, runs in the child process */
+static void Bench_runDepth(uint16 depth, uint32 arrivals, uint32 budget, Bench_Result *result)
+{
+    IfxEth_Config      config = cfg_Eth;
+    HostSim_PeerStats *stats  = HostSim_getPeerStats();
+    uint8              payload[BENCH_PAYLOAD];
+    uint8              frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16             length;
+    udp_pcb_t         *udp;
+    uint32             b, i;
+
+    config.rxDescr      = calloc(depth, sizeof(IfxEth_RxDescr));
+    config.rxBuffer     = calloc(depth, IFXETH_RTX_BUFFER_SIZE);
+    config.rxDescrCount = depth;
+
+    if ((config.rxDescr == NULL) || (config.rxBuffer == NULL))
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    ethernetif_tc2x_setConfig(&config);
+    HostSim_init();
+
+    udp = udp_new();
+    udp_bind(udp, IP_ADDR_ANY, BENCH_LOCAL_PORT);
+    udp_recv(udp, &Bench_onReceive, NULL);
+
+    memset(payload, 0x5A, sizeof(payload));
+    length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, BENCH_LOCAL_PORT, payload, sizeof(payload));
+
+    for (b = 0; b < BENCH_BURSTS; b++)
+    {
+        boolean pending;
+
+        HostSim_resetPeerStats();
+        Bench_received = 0;
+
+        for (i = 1; i <= Bench_bursts[b]; i++)
+        {
+            HostSim_inject(frame, length);
+
+            if ((i % arrivals) == 0)
+            {
+                Ifx_Lwip_pollReceive(budget, &pending);
+            }
+        }
+
+        do
+        {
+            Ifx_Lwip_pollReceive(budget, &pending);
+        } while (pending != FALSE);
+
+        result->dropped[b] = stats->injectDropped;
+        result->lost[b]    = Bench_bursts[b] - Bench_received - stats->injectDropped;
+    }
+
+    udp_remove(udp);
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32       arrivals = (argc > 1) ? (uint32)atoi(argv[1]) : 4U;
+    uint32       budget   = (argc > 2) ? (uint32)atoi(argv[2]) : 2U;
+    Bench_Result results[BENCH_DEPTHS];
+    uint32       d, b;
+    int          result   = EXIT_SUCCESS;
+
+    if ((arrivals == 0) || (budget == 0))
+    {
+        printf("usage: Bench_RingSweep [arrivals per poll] [frames per poll]\n");
+        return EXIT_FAILURE;
+    }
+
+    for (d = 0; d < BENCH_DEPTHS; d++)
+    {
+        int   channel[2];
+        int   status;
+        pid_t child;
+
+        fflush(stdout);
+
+        if (pipe(channel) != 0)
+        {
+            return EXIT_FAILURE;
+        }
+
+        child = fork();
+
+        if (child == 0)
+        {
+            Bench_Result own;
+
+            close(channel[0]);
+            memset(&own, 0, sizeof(own));
+            Bench_runDepth(Bench_depths[d], arrivals, budget, &own);
+            _exit((write(channel[1], &own, sizeof(own)) == (ssize_t)sizeof(own)) ? EXIT_SUCCESS : EXIT_FAILURE);
+        }
+
+        close(channel[1]);
+
+        if ((child < 0) || (read(channel[0], &results[d], sizeof(results[d])) != (ssize_t)sizeof(results[d])))
+        {
+            printf("bench_ringsweep: FAILED, no result for a ring of %u descriptors\n", Bench_depths[d]);
+            memset(&results[d], 0xFF, sizeof(results[d]));
+            result = EXIT_FAILURE;
+        }
+
+        close(channel[0]);
+
+        if (child > 0)
+        {
+            waitpid(child, &status, 0);
+        }
+    }
+
+    printf("bench_ringsweep: %u arrivals per poll, %u frames per poll, frames dropped per burst and RX ring depth\n",
+        arrivals, budget);
+    printf("%8s", "burst");
+
+    for (d = 0; d < BENCH_DEPTHS; d++)
+    {
+        printf(" %7u", Bench_depths[d]);
+    }
+
+    printf(" %7s\n", "knee");
+
+    for (b = 0; b < BENCH_BURSTS; b++)
+    {
+        uint32 knee = 0;
+
+        printf("%8u", Bench_bursts[b]);
+
+        for (d = 0; d < BENCH_DEPTHS; d++)
+        {
+            printf(" %7u", results[d].dropped[b]);
+
+            if ((results[d].dropped[b] == 0) && (knee == 0))
+            {
+                knee = Bench_depths[d];
+            }
+
+            if (results[d].lost[b] != 0)
+            {
+                result = EXIT_FAILURE;
+            }
+        }
+
+        if (knee != 0)
+        {
+            printf(" %7u\n", knee);
+        }
+        else
+        {
+            printf(" %7s\n", "-");
+        }
+    }
+
+    if (result != EXIT_SUCCESS)
+    {
+        printf("bench_ringsweep: FAILED, frames lost between the ring and the stack\n");
+    }
+
+    return result;
+}
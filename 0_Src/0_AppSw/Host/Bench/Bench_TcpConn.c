@@ -0,0 +1,281 @@
+/**
+ * \file Bench_TcpConn.c
+ * \brief Host benchmark: TCP connection setup and segment rate against the number of connections
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The simulated peer opens "conns" connections to a listening pcb, each from its own source
+ * port, and then sends data segments round robin over all of them. Every segment is written
+ * into the RX ring and HostSim_poll() runs the stack as the target main loop does, so the
+ * rates include the driver, ip_input(), the TCP lookup and the ACKs sent back. The pcbs come
+ * from malloc() through --wrap, the pool is too small for the bench.
+ *
+ * tcp_input() looks up the pcb in hash tables with TCP_PCB_HASH 1 (lwipopts.h). The lists are
+ * measured with a second build: make host HOST_EXTRA_CFLAGS=-DTCP_PCB_HASH=0
+ * HOST_OUT_DIR=2_Out/HostList. Every number of connections is run in its own process.
+ * Usage: Bench_TcpConn [segments], default 200000 per run.
+ */
+
+#include "HostSim.h"
+#include "lwip/memp.h"
+#include "lwip/tcp_impl.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_SEGMENTS_DEFAULT (200000U)
+#define BENCH_LOCAL_PORT       (7000U)
+#define BENCH_PEER_PORT        (30000U)  /**< \brief Source port of the first connection */
+#define BENCH_PEER_ISN         (0x10000000U)
+#define BENCH_PAYLOAD          (64U)
+#define BENCH_MAX_CONNS        (256U)
+#define BENCH_FRAME_SIZE       (1536U)
+
+static const uint32 Bench_connCounts[] = {1, 16, 64, BENCH_MAX_CONNS};
+
+#define BENCH_RUNS (sizeof(Bench_connCounts) / sizeof(Bench_connCounts[0]))
+
+/** \brief One connection, seen from the peer */
+typedef struct
+{
+    uint32  seqno;          /**< \brief Next sequence number of the peer */
+    uint32  ackno;          /**< \brief Next sequence number of the stack, from its SYN-ACK */
+    boolean synAcked;
+    uint32  received;       /**< \brief Payload bytes passed to the recv callback */
+} Bench_Conn;
+
+/* memp_malloc() and memp_free() of the library, reached through --wrap */
+void *__real_memp_malloc(memp_t type);
+void  __real_memp_free(memp_t type, void *mem);
+
+static Bench_Conn Bench_conns[BENCH_MAX_CONNS];
+static uint32     Bench_accepted;
+
+void *__wrap_memp_malloc(memp_t type)
+{
+    return (type == MEMP_TCP_PCB) ? malloc(sizeof(struct tcp_pcb)) : __real_memp_malloc(type);
+}
+
+
+void __wrap_memp_free(memp_t type, void *mem)
+{
+    if (type == MEMP_TCP_PCB)
+    {
+        free(mem);
+    }
+    else
+    {
+        __real_memp_free(type, mem);
+    }
+}
+
+
+/** \brief Takes the initial sequence number of the stack from the SYN-ACK of a connection */
+static void Bench_onFrame(void *context, const uint8 *frame, uint16 length)
+{
+    const uint8 *tcp = &frame[14 + 20];
+    uint32       idx;
+
+    (void)context;
+
+    if ((length < (14 + 20 + 20)) || (frame[14 + 9] != IP_PROTO_TCP) || ((tcp[13] & (TCP_SYN | TCP_ACK)) != (TCP_SYN | TCP_ACK)))
+    {
+        return;
+    }
+
+    idx = (uint32)((tcp[2] << 8) | tcp[3]) - BENCH_PEER_PORT;
+
+    if (idx < BENCH_MAX_CONNS)
+    {
+        Bench_conns[idx].ackno    = (((uint32)tcp[4] << 24) | ((uint32)tcp[5] << 16) | ((uint32)tcp[6] << 8) | tcp[7]) + 1;
+        Bench_conns[idx].synAcked = TRUE;
+    }
+}
+
+
+static err_t Bench_onReceive(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    Bench_Conn *conn = (Bench_Conn *)arg;
+
+    (void)err;
+
+    if (p == NULL)
+    {
+        return ERR_OK;
+    }
+
+    conn->received += p->tot_len;
+    tcp_recved(pcb, p->tot_len);
+    pbuf_free(p);
+
+    return ERR_OK;
+}
+
+
+static err_t Bench_onAccept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    struct tcp_pcb *lpcb = (struct tcp_pcb *)arg;
+    uint32          idx  = (uint32)pcb->remote_port - BENCH_PEER_PORT;
+
+    (void)err;
+
+    tcp_accepted(lpcb);
+
+    if (idx >= BENCH_MAX_CONNS)
+    {
+        tcp_abort(pcb);
+        return ERR_ABRT;
+    }
+
+    tcp_arg(pcb, &Bench_conns[idx]);
+    tcp_recv(pcb, &Bench_onReceive);
+    Bench_accepted++;
+
+    return ERR_OK;
+}
+
+
+/** \brief Sends one segment of the peer and runs the stack once */
+static void Bench_send(uint8 *frame, uint32 idx, uint8 flags, const uint8 *payload, uint16 length)
+{
+    HostSim_TcpSegment segment;
+
+    segment.srcPort = (uint16)(BENCH_PEER_PORT + idx);
+    segment.dstPort = BENCH_LOCAL_PORT;
+    segment.seqno   = Bench_conns[idx].seqno;
+    segment.ackno   = Bench_conns[idx].ackno;
+    segment.flags   = flags;
+    segment.window  = 0xFFFF;
+    segment.mss     = 0;
+
+    HostSim_inject(frame, HostSim_buildTcpFrame(frame, &segment, payload, length));
+    HostSim_poll();
+    Bench_conns[idx].seqno += length + (((flags & TCP_SYN) != 0) ? 1 : 0);
+}
+
+
+/** \brief Opens "count" connections and sends "segments" round robin over them */
+static int Bench_run(uint32 count, uint32 segments)
+{
+    static uint8    frame[BENCH_FRAME_SIZE];
+    static uint8    payload[BENCH_PAYLOAD];
+    struct tcp_pcb *lpcb = tcp_new();
+    uint64          setup, data;
+    uint32          idx, n;
+
+    if ((lpcb == NULL) || (tcp_bind(lpcb, IP_ADDR_ANY, BENCH_LOCAL_PORT) != ERR_OK) ||
+        ((lpcb = tcp_listen(lpcb)) == NULL))
+    {
+        return EXIT_FAILURE;
+    }
+
+    tcp_arg(lpcb, lpcb);
+    tcp_accept(lpcb, &Bench_onAccept);
+    HostSim_setFrameHook(&Bench_onFrame, NULL);
+    memset(Bench_conns, 0, sizeof(Bench_conns));
+    Bench_accepted = 0;
+
+    setup = HostSim_nowNs();
+
+    for (idx = 0; idx < count; idx++)
+    {
+        Bench_conns[idx].seqno = BENCH_PEER_ISN + (idx << 20);
+        Bench_send(frame, idx, TCP_SYN, payload, 0);
+        Bench_send(frame, idx, TCP_ACK, payload, 0);
+    }
+
+    setup = HostSim_nowNs() - setup;
+    idx   = 0;
+    data  = HostSim_nowNs();
+
+    for (n = 0; n < segments; n++)
+    {
+        Bench_send(frame, idx, TCP_ACK | TCP_PSH, payload, BENCH_PAYLOAD);
+
+        if (++idx == count)
+        {
+            idx = 0;
+        }
+    }
+
+    data = HostSim_nowNs() - data;
+
+    for (idx = 0; idx < count; idx++)
+    {
+        if ((Bench_conns[idx].synAcked == FALSE) ||
+            (Bench_conns[idx].received != BENCH_PAYLOAD * ((segments / count) + (idx < (segments % count)))))
+        {
+            printf("bench_tcpconn: FAILED, connection %u of %u received %u bytes\n", idx, count,
+                Bench_conns[idx].received);
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (Bench_accepted != count)
+    {
+        printf("bench_tcpconn: FAILED, %u of %u connections accepted\n", Bench_accepted, count);
+        return EXIT_FAILURE;
+    }
+
+    printf("%6u %12.0f %12.0f %10.1f\n", count, count * 1e9 / setup, segments * 1e9 / data, (double)data / segments);
+
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32 segments = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_SEGMENTS_DEFAULT;
+    int    result   = EXIT_SUCCESS;
+    uint32 r;
+
+    if (segments == 0)
+    {
+        printf("usage: Bench_TcpConn [segments]\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("bench_tcpconn: %u segments of %u bytes per run, TCP_PCB_HASH %u\n", segments, BENCH_PAYLOAD, TCP_PCB_HASH);
+    printf("%6s %12s %12s %10s\n", "conns", "setups/s", "segments/s", "ns/seg");
+
+    for (r = 0; r < BENCH_RUNS; r++)
+    {
+        int   status;
+        pid_t child;
+
+        fflush(stdout);
+        child = fork();
+
+        if (child == 0)
+        {
+            HostSim_init();
+            status = (HostSim_resolvePeer(1000) != FALSE) ? Bench_run(Bench_connCounts[r], segments) : EXIT_FAILURE;
+            fflush(stdout);
+            _exit(status);
+        }
+
+        if ((child < 0) || (waitpid(child, &status, 0) != child) || !WIFEXITED(status) ||
+            (WEXITSTATUS(status) != EXIT_SUCCESS))
+        {
+            printf("bench_tcpconn: FAILED, %u connections\n", Bench_connCounts[r]);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
@@ -0,0 +1,690 @@
+/**
+ * \file Bench_TcpLoss.c
+ * \brief Host benchmark: TCP loss recovery of an upload over a lossy link
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The stack connects to the simulated peer and uploads "kbytes" as fast as tcp_write()
+ * takes them. Both directions share the properties of a virtual link of 100 Mbit/s
+ * (preamble, FCS and inter-frame gap included) with a round trip time of "rtt" us; the
+ * loss model of HostSim (HostSim_setLoss()) drops IPv4 frames in both directions once the
+ * connection is established, single ones or in bursts of three, always the same frames for
+ * the same seed. sys_now() runs on
+ * the virtual clock (--wrap, see Host.mk), so do all timeouts of the stack, including the
+ * retransmission timer.
+ *
+ * The peer checks the data, ACKs every segment at once and, if the SYN of the stack offered
+ * it and the scenario allows it, negotiates SACK and reports up to four SACK blocks. Every
+ * scenario uploads eight times with other seeds. "ms" is the mean virtual time from the
+ * connection until the peer has all data, "stall" the longest time in which the peer did not
+ * get a single new in-order byte (mostly retransmission time-outs), "lost" the frames dropped
+ * on the link and "dup" the segments the peer had received before, both of all uploads.
+ *
+ * The library runs NewReno or CUBIC (LWIP_TCP_CC), SACK and the RFC 6298 retransmission
+ * timer; the built-in Reno with the retransmission timer of tcp_slowtmr() is measured with
+ * a second build: HOST_EXTRA_CFLAGS="-DLWIP_TCP_CC=0 -DLWIP_TCP_SACK=0 -DTCP_RTO_RFC6298=0".
+ *
+ * Usage: Bench_TcpLoss [kbytes] [rtt], default 2048 KB per scenario and 1000 us.
+ */
+
+#include "HostSim.h"
+#include "lwip/tcp_impl.h"
+#include "lwip/timers.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_KBYTES_DEFAULT    (2048U)
+#define BENCH_RTT_DEFAULT       (1000U)     /**< \brief us */
+#define BENCH_LIMIT_MS          (120000U)   /**< \brief A scenario which takes longer fails */
+#define BENCH_LINK_BPS          (100000000.0)
+#define BENCH_WIRE_OVERHEAD     (4U + 8U + 12U)  /**< \brief FCS, preamble and inter-frame gap */
+#define BENCH_ETH_HDR_LEN       (14U)       /**< \brief on the wire, without ETH_PAD_SIZE */
+#define BENCH_PEER_PORT         (41000U)    /**< \brief of the first upload */
+#define BENCH_PEER_ISN          (0x50000000U)
+#define BENCH_WIRE              (256U)      /**< \brief Frames on the virtual link, per direction */
+#define BENCH_FRAME_SIZE        (1536U)
+#define BENCH_RANGES            (64U)       /**< \brief Out-of-order ranges of the peer */
+#define BENCH_SACK_BLOCKS       (4U)        /**< \brief Without timestamps 4 blocks fit into 40 bytes */
+#define BENCH_SEEDS             (8U)        /**< \brief Uploads of a scenario, each with other losses */
+#define BENCH_SEED              (0x1234567U)
+#define BENCH_SEED_STEP         (7919U)
+#define BENCH_MS_NS             (1000000ULL)
+
+/** \brief Loss of a scenario, in both directions */
+typedef struct
+{
+    const char *name;
+    uint32      ppm;
+    uint8       burst;
+} Bench_LossModel;
+
+/** \brief Frame on one direction of the virtual link */
+typedef struct
+{
+    uint64 time;            /**< \brief Arrival on the virtual clock, ns */
+    uint16 length;
+    uint8  data[BENCH_FRAME_SIZE];
+} Bench_Frame;
+
+/** \brief One direction of the virtual link */
+typedef struct
+{
+    Bench_Frame frames[BENCH_WIRE];
+    uint32      head, tail;
+    uint64      free;           /**< \brief End of the last frame on the link */
+} Bench_Wire;
+
+/** \brief Range of stream offsets the peer received above its next expected byte */
+typedef struct
+{
+    uint32 left, right;
+} Bench_Range;
+
+/** \brief Results of the runs of a scenario */
+typedef struct
+{
+    uint64 ns;              /**< \brief Sum of the upload times */
+    uint64 maxStall;
+    uint32 lost;
+    uint32 dup;
+    uint32 sackOk;          /**< \brief Runs which negotiated SACK */
+} Bench_Result;
+
+/** \brief State of a scenario */
+typedef struct
+{
+    uint16          peerPort;
+    boolean         sack;           /**< \brief The peer may negotiate SACK */
+    uint32          total;          /**< \brief Bytes to upload */
+    uint64          delay;          /**< \brief One way delay, ns */
+    uint64          start;          /**< \brief tcp_connect() on the virtual clock */
+    HostSim_Loss    loss;           /**< \brief Set once the connection is established */
+    Bench_Wire      toPeer, toStack;
+    /* the peer */
+    boolean         established;
+    boolean         sackOk;
+    uint16          stackPort;
+    uint32          irs;            /**< \brief Initial sequence number of the stack */
+    uint32          rcvNxt;         /**< \brief Stream offset of the next in-order byte */
+    Bench_Range     ranges[BENCH_RANGES];
+    uint32          rangeCount;
+    uint32          latest;         /**< \brief Range which got the latest segment, BENCH_RANGES for none */
+    uint64          lastAdvance;
+    uint64          maxStall;
+    uint32          dup;
+    /* the stack */
+    struct tcp_pcb *pcb;
+    uint32          written;
+    boolean         connected;
+    boolean         aborted;
+    uint32          errors;
+} Bench_Run;
+
+static const Bench_LossModel Bench_losses[] = {
+    {"0", 0, 1},
+    {"0.5%", 5000, 1},
+    {"2%", 20000, 1},
+    {"2% x3", 20000, 3},
+};
+
+#define BENCH_LOSSES (sizeof(Bench_losses) / sizeof(Bench_losses[0]))
+
+static uint64    Bench_now;         /**< \brief Virtual clock, ns */
+static Bench_Run Bench_run;
+static uint8    *Bench_data;        /**< \brief The stream */
+
+u32_t __wrap_sys_now(void)
+{
+    return (u32_t)(Bench_now / BENCH_MS_NS);
+}
+
+
+static uint32 Bench_get32(const uint8 *p)
+{
+    return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+
+static void Bench_put32(uint8 *p, uint32 value)
+{
+    p[0] = (uint8)(value >> 24);
+    p[1] = (uint8)(value >> 16);
+    p[2] = (uint8)(value >> 8);
+    p[3] = (uint8)value;
+}
+
+
+/** \brief Puts a frame on a direction of the link, it arrives one delay after its end */
+static void Bench_wireSend(Bench_Run *run, Bench_Wire *wire, const uint8 *frame, uint16 length)
+{
+    Bench_Frame *f;
+
+    if ((wire->tail - wire->head) >= BENCH_WIRE)
+    {
+        run->errors++;
+        return;
+    }
+
+    f          = &wire->frames[wire->tail++ % BENCH_WIRE];
+    wire->free = ((wire->free > Bench_now) ? wire->free : Bench_now) +
+                 (uint64)((length + BENCH_WIRE_OVERHEAD) * 8.0 * 1e9 / BENCH_LINK_BPS);
+    f->time    = wire->free + run->delay;
+    f->length  = length;
+    memcpy(f->data, frame, length);
+}
+
+
+/** \brief Sends a segment of the peer: the SYN/ACK or an ACK with the SACK blocks */
+static void Bench_peerSend(Bench_Run *run, uint8 flags)
+{
+    static uint8       frame[BENCH_FRAME_SIZE];
+    uint8              options[4 + (8 * BENCH_SACK_BLOCKS)];
+    uint8              optionsLength = 0;
+    HostSim_TcpSegment segment;
+    uint32             blocks = 0;
+    uint32             r;
+
+    segment.srcPort = run->peerPort;
+    segment.dstPort = run->stackPort;
+    segment.seqno   = BENCH_PEER_ISN + (((flags & TCP_SYN) != 0) ? 0U : 1U);
+    segment.ackno   = run->irs + 1U + run->rcvNxt;
+    segment.flags   = flags;
+    segment.window  = 0xFFFFU;
+    segment.mss     = ((flags & TCP_SYN) != 0) ? TCP_MSS : 0U;
+
+    if (((flags & TCP_SYN) != 0) && run->sackOk)
+    {
+        options[0]    = 1;      /* NOP, NOP, SACK permitted */
+        options[1]    = 1;
+        options[2]    = 4;
+        options[3]    = 2;
+        optionsLength = 4;
+    }
+    else if (run->sackOk && (run->rangeCount > 0))
+    {
+        /* the block with the latest segment first (RFC 2018), then the highest ones */
+        if (run->latest < run->rangeCount)
+        {
+            Bench_put32(&options[4], run->irs + 1U + run->ranges[run->latest].left);
+            Bench_put32(&options[8], run->irs + 1U + run->ranges[run->latest].right);
+            blocks++;
+        }
+
+        for (r = run->rangeCount; (r > 0) && (blocks < BENCH_SACK_BLOCKS); r--)
+        {
+            if ((r - 1U) != run->latest)
+            {
+                Bench_put32(&options[4 + (8 * blocks)], run->irs + 1U + run->ranges[r - 1U].left);
+                Bench_put32(&options[8 + (8 * blocks)], run->irs + 1U + run->ranges[r - 1U].right);
+                blocks++;
+            }
+        }
+
+        options[0]    = 1;      /* NOP, NOP, SACK */
+        options[1]    = 1;
+        options[2]    = 5;
+        options[3]    = (uint8)(2U + (8U * blocks));
+        optionsLength = (uint8)(4U + (8U * blocks));
+    }
+
+    Bench_wireSend(run, &run->toStack, frame,
+        HostSim_buildTcpFrameWithOptions(frame, &segment, options, optionsLength, NULL_PTR, 0));
+}
+
+
+/** \brief The peer receives stream bytes [left, right): out-of-order ranges and rcvNxt */
+static void Bench_peerReceive(Bench_Run *run, uint32 left, uint32 right)
+{
+    uint32 r, i;
+
+    run->latest = BENCH_RANGES;
+
+    if (right <= run->rcvNxt)
+    {
+        run->dup++;
+        return;
+    }
+
+    left = (left > run->rcvNxt) ? left : run->rcvNxt;
+
+    /* the ranges are sorted and disjoint, merge [left, right) into them */
+    for (r = 0; (r < run->rangeCount) && (run->ranges[r].right < left); r++)
+    {
+    }
+
+    if ((r < run->rangeCount) && (run->ranges[r].left <= left) && (run->ranges[r].right >= right))
+    {
+        run->dup++;
+        run->latest = r;
+        return;
+    }
+
+    if ((r == run->rangeCount) || (run->ranges[r].left > right))
+    {
+        if (run->rangeCount == BENCH_RANGES)
+        {
+            run->errors++;
+            return;
+        }
+
+        memmove(&run->ranges[r + 1U], &run->ranges[r], (run->rangeCount - r) * sizeof(Bench_Range));
+        run->rangeCount++;
+        run->ranges[r].left  = left;
+        run->ranges[r].right = right;
+    }
+    else
+    {
+        run->ranges[r].left  = (run->ranges[r].left < left) ? run->ranges[r].left : left;
+        run->ranges[r].right = (run->ranges[r].right > right) ? run->ranges[r].right : right;
+
+        /* swallow the following ranges the new one reaches */
+        for (i = r + 1U; (i < run->rangeCount) && (run->ranges[i].left <= run->ranges[r].right); i++)
+        {
+            run->ranges[r].right = (run->ranges[i].right > run->ranges[r].right) ? run->ranges[i].right : run->ranges[r].right;
+        }
+
+        memmove(&run->ranges[r + 1U], &run->ranges[i], (run->rangeCount - i) * sizeof(Bench_Range));
+        run->rangeCount -= i - (r + 1U);
+    }
+
+    run->latest = r;
+
+    if (run->ranges[0].left == run->rcvNxt)
+    {
+        run->maxStall    = LWIP_MAX(run->maxStall, Bench_now - run->lastAdvance);
+        run->lastAdvance = Bench_now;
+        run->rcvNxt      = run->ranges[0].right;
+        memmove(&run->ranges[0], &run->ranges[1], (run->rangeCount - 1U) * sizeof(Bench_Range));
+        run->rangeCount--;
+        run->latest = (run->latest > 0) ? (run->latest - 1U) : BENCH_RANGES;
+    }
+}
+
+
+/** \brief A frame of the stack reaches the peer */
+static void Bench_peerInput(Bench_Run *run, const uint8 *frame, uint16 length)
+{
+    const uint8 *ip    = &frame[BENCH_ETH_HDR_LEN];
+    uint16       ihl   = (uint16)((ip[0] & 0x0FU) * 4U);
+    const uint8 *tcp   = &ip[ihl];
+    uint16       hlen  = (uint16)((tcp[12] >> 4) * 4U);
+    uint16       len   = (uint16)(((ip[2] << 8) | ip[3]) - ihl - hlen);
+    uint8        flags = tcp[13];
+    uint32       offset, i;
+
+    (void)length;
+
+    if ((flags & TCP_SYN) != 0)
+    {
+        run->stackPort = (uint16)((tcp[0] << 8) | tcp[1]);
+        run->irs       = Bench_get32(&tcp[4]);
+        run->sackOk    = FALSE;
+
+        for (i = TCP_HLEN; (i < hlen) && (tcp[i] != 0); i += (tcp[i] == 1) ? 1U : tcp[i + 1])
+        {
+            if ((tcp[i] == 4) && run->sack)
+            {
+                run->sackOk = TRUE;
+            }
+
+            if ((tcp[i] != 1) && (tcp[i + 1] == 0))
+            {
+                break;
+            }
+        }
+
+        run->established = TRUE;
+        Bench_peerSend(run, TCP_SYN | TCP_ACK);
+        return;
+    }
+
+    if (!run->established || (len == 0))
+    {
+        return;
+    }
+
+    offset = Bench_get32(&tcp[4]) - (run->irs + 1U);
+
+    if ((offset + len) > run->total)
+    {
+        run->errors++;
+        return;
+    }
+
+    if (memcmp(&tcp[hlen], &Bench_data[offset], len) != 0)
+    {
+        run->errors++;
+    }
+
+    Bench_peerReceive(run, offset, offset + len);
+    Bench_peerSend(run, TCP_ACK);
+}
+
+
+/** \brief Frame hook: queues the segments of the stack on the link to the peer */
+static void Bench_onFrame(void *context, const uint8 *frame, uint16 length)
+{
+    Bench_Run   *run = (Bench_Run *)context;
+    const uint8 *ip  = &frame[BENCH_ETH_HDR_LEN];
+    const uint8 *tcp;
+
+    if ((length < BENCH_ETH_HDR_LEN + IP_HLEN + TCP_HLEN) || (ip[9] != IP_PROTO_TCP))
+    {
+        return;
+    }
+
+    tcp = &ip[(ip[0] & 0x0FU) * 4U];
+
+    if ((((tcp[2] << 8) | tcp[3]) != run->peerPort) || ((tcp[13] & TCP_RST) != 0))
+    {
+        return;
+    }
+
+    Bench_wireSend(run, &run->toPeer, frame, length);
+}
+
+
+/** \brief The application of the stack: writes as much of the stream as the stack takes */
+static void Bench_write(Bench_Run *run)
+{
+    while ((run->pcb != NULL) && (run->written < run->total))
+    {
+        uint32 len = LWIP_MIN(run->total - run->written, tcp_sndbuf(run->pcb));
+
+        if ((len == 0) || (tcp_write(run->pcb, &Bench_data[run->written], (u16_t)len, TCP_WRITE_FLAG_COPY) != ERR_OK))
+        {
+            break;
+        }
+
+        run->written += len;
+    }
+
+    if (run->pcb != NULL)
+    {
+        tcp_output(run->pcb);
+    }
+}
+
+
+static err_t Bench_onSent(void *arg, struct tcp_pcb *pcb, u16_t len)
+{
+    (void)pcb;
+    (void)len;
+    Bench_write((Bench_Run *)arg);
+
+    return ERR_OK;
+}
+
+
+static void Bench_onError(void *arg, err_t err)
+{
+    Bench_Run *run = (Bench_Run *)arg;
+
+    (void)err;
+    run->pcb     = NULL;
+    run->aborted = TRUE;
+}
+
+
+static err_t Bench_onConnected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    Bench_Run *run = (Bench_Run *)arg;
+
+    (void)pcb;
+    (void)err;
+    run->connected   = TRUE;
+    run->lastAdvance = Bench_now;
+    HostSim_setLoss(&run->loss);
+    Bench_write(run);
+
+    return ERR_OK;
+}
+
+
+/** \brief Next event on the virtual clock: a frame arriving or a timeout of the stack */
+static uint64 Bench_nextEvent(const Bench_Run *run, uint64 end)
+{
+    uint64 next  = end;
+    uint32 sleep = sys_timeouts_sleeptime();
+
+    next = (run->toPeer.head != run->toPeer.tail) ? LWIP_MIN(next, run->toPeer.frames[run->toPeer.head % BENCH_WIRE].time) : next;
+    next = (run->toStack.head != run->toStack.tail) ? LWIP_MIN(next, run->toStack.frames[run->toStack.head % BENCH_WIRE].time) : next;
+
+    if (sleep != SYS_TIMEOUTS_SLEEPTIME_INFINITE)
+    {
+        next = LWIP_MIN(next, ((Bench_now / BENCH_MS_NS) + LWIP_MAX(sleep, 1U)) * BENCH_MS_NS);
+    }
+
+    return LWIP_MAX(next, Bench_now);
+}
+
+
+/** \brief Runs the events due at Bench_now */
+static void Bench_step(Bench_Run *run)
+{
+    while ((run->toPeer.head != run->toPeer.tail) && (run->toPeer.frames[run->toPeer.head % BENCH_WIRE].time <= Bench_now))
+    {
+        Bench_Frame *f = &run->toPeer.frames[run->toPeer.head++ % BENCH_WIRE];
+
+        Bench_peerInput(run, f->data, f->length);
+    }
+
+    sys_check_timeouts();
+
+    /* the stack takes the frames one by one, as they arrive */
+    while ((run->toStack.head != run->toStack.tail) && (run->toStack.frames[run->toStack.head % BENCH_WIRE].time <= Bench_now))
+    {
+        Bench_Frame *f = &run->toStack.frames[run->toStack.head++ % BENCH_WIRE];
+
+        if (HostSim_inject(f->data, f->length) == FALSE)
+        {
+            run->errors++;
+        }
+
+        HostSim_poll();
+    }
+}
+
+
+/** \brief Runs one upload of a scenario and adds it to "result", returns FALSE on a failure */
+static boolean Bench_upload(uint32 index, const char *cc, boolean sack, const Bench_LossModel *lossModel,
+                            uint32 seed, uint32 total, uint32 rttUs, Bench_Result *result)
+{
+    Bench_Run         *run   = &Bench_run;
+    HostSim_PeerStats *stats = HostSim_getPeerStats();
+    ip_addr_t          peerIp;
+    uint64             end;
+    boolean            ok;
+    uint32             i;
+
+    memset(run, 0, sizeof(*run));
+    run->peerPort    = (uint16)(BENCH_PEER_PORT + index);
+    run->sack        = sack;
+    run->total       = total;
+    run->delay       = (uint64)rttUs * 1000U / 2U;
+    run->latest      = BENCH_RANGES;
+    end              = Bench_now + ((uint64)BENCH_LIMIT_MS * BENCH_MS_NS);
+
+    run->loss.txPpm  = lossModel->ppm;
+    run->loss.rxPpm  = lossModel->ppm;
+    run->loss.burst  = lossModel->burst;
+    run->loss.seed   = seed;
+    HostSim_resetPeerStats();
+    HostSim_setFrameHook(&Bench_onFrame, run);
+
+    HOSTSIM_PEER_IP(&peerIp);
+    run->pcb = tcp_new();
+
+    if (run->pcb == NULL)
+    {
+        printf("bench_tcploss: FAILED, no pcb\n");
+        return FALSE;
+    }
+
+#if LWIP_TCP_CC
+    tcp_set_cc(run->pcb, (strcmp(cc, "cubic") == 0) ? &tcp_cc_cubic : &tcp_cc_newreno);
+#else /* LWIP_TCP_CC */
+    (void)cc;
+#endif /* LWIP_TCP_CC */
+    tcp_arg(run->pcb, run);
+    tcp_err(run->pcb, &Bench_onError);
+    tcp_sent(run->pcb, &Bench_onSent);
+
+    if (tcp_connect(run->pcb, &peerIp, run->peerPort, &Bench_onConnected) != ERR_OK)
+    {
+        printf("bench_tcploss: FAILED, tcp_connect\n");
+        return FALSE;
+    }
+
+    while (!run->connected && (Bench_now < end) && (run->errors == 0) && !run->aborted)
+    {
+        Bench_now = Bench_nextEvent(run, end);
+        Bench_step(run);
+    }
+
+    run->start = Bench_now;
+
+    while ((run->rcvNxt < run->total) && (Bench_now < end) && (run->errors == 0) && !run->aborted)
+    {
+        Bench_now = Bench_nextEvent(run, end);
+        Bench_step(run);
+    }
+
+    ok = (run->rcvNxt == run->total) && (run->errors == 0) && !run->aborted;
+#if LWIP_TCP_SACK
+    ok = ok && (run->sackOk == ((run->pcb != NULL) && ((run->pcb->flags2 & TF2_SACK) != 0)));
+#endif /* LWIP_TCP_SACK */
+
+    result->ns      += Bench_now - run->start;
+    result->maxStall = LWIP_MAX(result->maxStall, run->maxStall);
+    result->lost    += stats->txLost + stats->rxLost;
+    result->dup     += run->dup;
+    result->sackOk  += run->sackOk;
+
+    HostSim_setLoss(NULL_PTR);
+    HostSim_setFrameHook(NULL_PTR, NULL_PTR);
+
+    if (run->pcb != NULL)
+    {
+        tcp_arg(run->pcb, NULL);
+        tcp_err(run->pcb, NULL);
+        tcp_abort(run->pcb);
+        run->pcb = NULL;
+    }
+
+    /* frames left in the ring find the pcb gone */
+    for (i = 0; i < 16; i++)
+    {
+        HostSim_poll();
+    }
+
+    if (ok == FALSE)
+    {
+        printf("bench_tcploss: FAILED, %u of %u bytes, %u errors%s\n", run->rcvNxt, run->total, run->errors,
+            run->aborted ? ", connection aborted" : "");
+    }
+
+    return ok;
+}
+
+
+/** \brief Runs the uploads of a scenario and prints its line, returns FALSE on a failure */
+static boolean Bench_scenario(uint32 *index, const char *cc, boolean sack, const Bench_LossModel *lossModel,
+                              uint32 total, uint32 rttUs)
+{
+    Bench_Result result;
+    uint32       r;
+
+    memset(&result, 0, sizeof(result));
+
+    for (r = 0; r < BENCH_SEEDS; r++)
+    {
+        if (Bench_upload((*index)++, cc, sack, lossModel, BENCH_SEED + (r * BENCH_SEED_STEP), total, rttUs, &result) == FALSE)
+        {
+            return FALSE;
+        }
+    }
+
+    printf("%7s %4s %6s | %8.1f %7.1f %7.1f %6u %6u\n", cc, ((result.sackOk != 0) ? "on" : "off"), lossModel->name,
+        (double)result.ns / BENCH_SEEDS / BENCH_MS_NS, (double)total * BENCH_SEEDS * 8.0 * 1e3 / (double)result.ns,
+        (double)result.maxStall / BENCH_MS_NS, result.lost, result.dup);
+
+    return TRUE;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32  kbytes = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_KBYTES_DEFAULT;
+    uint32  rttUs  = (argc > 2) ? (uint32)atoi(argv[2]) : BENCH_RTT_DEFAULT;
+#if LWIP_TCP_CC
+    static const char *ccs[] = {"newreno", "cubic"};
+#else /* LWIP_TCP_CC */
+    static const char *ccs[] = {"reno"};
+#endif /* LWIP_TCP_CC */
+    uint32  sacks  = LWIP_TCP_SACK ? 2U : 1U;
+    uint32  index  = 0;
+    boolean ok     = TRUE;
+    uint32  c, s, l, i;
+
+    if ((kbytes == 0) || (kbytes > 65536) || (rttUs == 0) || (rttUs > 1000000))
+    {
+        printf("usage: Bench_TcpLoss [kbytes] [rtt]\n");
+        return EXIT_FAILURE;
+    }
+
+    Bench_data = (uint8 *)malloc(kbytes * 1024U);
+
+    if (Bench_data == NULL)
+    {
+        printf("bench_tcploss: out of memory\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < (kbytes * 1024U); i++)
+    {
+        Bench_data[i] = (uint8)((i * 7U) + (i >> 8));
+    }
+
+    HostSim_init();
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("bench_tcploss: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("bench_tcploss: %u KB per scenario, link 100 Mbit/s, RTT %u us, LWIP_TCP_CC %u, LWIP_TCP_SACK %u, "
+           "TCP_RTO_RFC6298 %u, TCP_SND_BUF %u\n", kbytes, rttUs, LWIP_TCP_CC, LWIP_TCP_SACK, TCP_RTO_RFC6298,
+        TCP_SND_BUF);
+    printf("%7s %4s %6s | %8s %7s %7s %6s %6s\n", "cc", "sack", "loss", "ms", "Mbit/s", "stall", "lost", "dup");
+
+    for (c = 0; (c < (sizeof(ccs) / sizeof(ccs[0]))) && ok; c++)
+    {
+        for (s = 0; (s < sacks) && ok; s++)
+        {
+            for (l = 0; (l < BENCH_LOSSES) && ok; l++)
+            {
+                ok = Bench_scenario(&index, ccs[c], (boolean)(s != 0), &Bench_losses[l], kbytes * 1024U, rttUs);
+            }
+        }
+    }
+
+    free(Bench_data);
+    printf("bench_tcploss: %s\n", ok ? "PASSED" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,697 @@
+/**
+ * \file Bench_TcpRecv.c
+ * \brief Host benchmark: TCP receive windows and out-of-sequence queues against the PBUF_POOL
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The simulated peer opens connections to the stack and sends a stream on each of them as
+ * fast as the announced window allows, next to a UDP stream of 20 Mbit/s. The frames share
+ * a virtual link of 100 Mbit/s (preamble, FCS and inter-frame gap included) with a round
+ * trip time of "rtt" us and are written into the RX ring of the IfxEth model when they
+ * arrive on the virtual clock. A frame the ring cannot take is lost, as is a frame which
+ * finds no PBUF_POOL buffer until the ring fills up behind it. The peer retransmits after
+ * three duplicate ACKs and after 200 ms without an ACK (go-back-N); the timers of the
+ * stack run on the virtual clock as well.
+ *
+ * The applications of the stack check the data. A "fast" reader takes every pbuf at once,
+ * a "slow" one queues it and reads 8 Mbit/s, a "lossy" one reads at once but the peer drops
+ * every 64th new segment of its stream on the way, which fills the ooseq queue.
+ * "Mbit/s" is the data read by the application on the virtual clock, "ooseq" the largest
+ * ooseq queue of the connection in bytes. "ring lost" counts the frames lost before the
+ * stack, "pool empty" the polls which found no PBUF_POOL buffer for a frame and "min free"
+ * the fewest free PBUF_POOL buffers seen.
+ *
+ * The library announces windows after the free PBUF_POOL buffers (TCP_RCV_AUTOTUNE), the
+ * static windows are measured with a second build (HOST_EXTRA_CFLAGS=-DTCP_RCV_AUTOTUNE=0,
+ * TCP_WND of lwipopts.h to every connection) and a third one which also adds -DTCP_WND=5840.
+ *
+ * Usage: Bench_TcpRecv [seconds] [rtt], default 2 s per scenario and 1000 us.
+ */
+
+#include "HostSim.h"
+#include "lwip/tcp_impl.h"
+#include "lwip/udp.h"
+#include "lwip/memp.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_SECONDS_DEFAULT   (2U)
+#define BENCH_RTT_DEFAULT       (1000U)     /**< \brief us */
+#define BENCH_LINK_BPS          (100000000.0)
+#define BENCH_WIRE_OVERHEAD     (4U + 8U + 12U)  /**< \brief FCS, preamble and inter-frame gap */
+#define BENCH_ETH_HDR_LEN       (14U)       /**< \brief on the wire, without ETH_PAD_SIZE */
+#define BENCH_LOCAL_PORT        (5202U)
+#define BENCH_UDP_PORT          (5004U)
+#define BENCH_PEER_PORT         (40000U)    /**< \brief of the first connection of the first scenario */
+#define BENCH_PEER_ISN          (0x30000000U)
+#define BENCH_CONNS             (3U)        /**< \brief Connections of a scenario, at most */
+#define BENCH_WIRE              (256U)      /**< \brief Frames on the virtual link to the stack */
+#define BENCH_ACKS              (1024U)     /**< \brief Segments on the virtual link to the peer */
+#define BENCH_HELD              (64U)       /**< \brief pbufs queued by the slow reader */
+#define BENCH_FRAME_SIZE        (1536U)
+#define BENCH_RTO_NS            (200000000ULL)
+#define BENCH_DUPACKS           (3U)
+#define BENCH_LOSS_EVERY        (64U)       /**< \brief New segments per drop of the lossy stream */
+#define BENCH_SLOW_BYTES_PER_MS (1000U)     /**< \brief 8 Mbit/s */
+#define BENCH_UDP_PAYLOAD       (1000U)
+#define BENCH_UDP_INTERVAL_NS   (400000ULL) /**< \brief 20 Mbit/s */
+#define BENCH_MS_NS             (1000000ULL)
+
+/** \brief Application of a connection on the stack */
+typedef enum
+{
+    Bench_Reader_fast,      /**< \brief reads every pbuf at once */
+    Bench_Reader_slow,      /**< \brief queues the pbufs and reads BENCH_SLOW_BYTES_PER_MS */
+    Bench_Reader_lossy      /**< \brief reads at once, the peer drops every BENCH_LOSS_EVERY-th segment */
+} Bench_Reader;
+
+/** \brief Scenario: readers of the connections and the UDP stream */
+typedef struct
+{
+    const char  *name;
+    uint32       conns;
+    Bench_Reader readers[BENCH_CONNS];
+    boolean      udp;
+} Bench_Scenario;
+
+/** \brief Frame on the virtual link from the peer to the stack */
+typedef struct
+{
+    uint64 time;            /**< \brief Arrival at the RX ring on the virtual clock, ns */
+    uint16 length;
+    uint8  data[BENCH_FRAME_SIZE];
+} Bench_Frame;
+
+/** \brief Segment of the stack on its way to the peer */
+typedef struct
+{
+    uint64 time;            /**< \brief Arrival at the peer on the virtual clock, ns */
+    uint32 conn;
+    uint32 seqno;
+    uint32 ackno;
+    uint16 window;
+    uint8  flags;
+} Bench_Ack;
+
+/** \brief A connection: sender on the peer, pcb and application on the stack */
+typedef struct
+{
+    Bench_Reader    reader;
+    uint16          peerPort;
+    boolean         established;
+    uint32          irs;            /**< \brief Initial sequence number of the stack */
+    uint32          una;            /**< \brief Stream offsets of the peer: oldest unACKed byte */
+    uint32          nxt;            /**< \brief next byte to send */
+    uint32          high;           /**< \brief first byte never sent */
+    uint32          edge;           /**< \brief right edge of the window of the stack */
+    uint16          window;         /**< \brief last window of the stack */
+    uint32          dupAcks;
+    uint64          rtoAt;          /**< \brief Retransmission timeout, 0 while nothing is in flight */
+    uint32          newSegments;
+    uint32          lost;           /**< \brief Segments dropped by the peer */
+    uint32          rexmit;         /**< \brief Segments retransmitted by the peer */
+    struct tcp_pcb *pcb;            /**< \brief Connection of the stack */
+    struct pbuf    *held[BENCH_HELD];
+    uint32          heldHead, heldTail;
+    uint32          consumed;       /**< \brief Bytes read by the application */
+    uint32          ooseqMax;
+    uint32          errors;
+} Bench_Conn;
+
+/** \brief State of a scenario */
+typedef struct
+{
+    Bench_Conn  conns[BENCH_CONNS];
+    uint32      connCount;
+    boolean     udp;
+    uint64      now;                /**< \brief Virtual clock, ns */
+    uint64      linkFree;           /**< \brief End of the last frame on the link to the stack */
+    uint64      delay;              /**< \brief One way delay, ns */
+    Bench_Frame wire[BENCH_WIRE];
+    uint32      wireHead, wireTail;
+    Bench_Ack   acks[BENCH_ACKS];
+    uint32      ackHead, ackTail;
+    uint64      nextUdp, nextRead, nextTimer;
+    uint32      timerTicks;
+    uint32      readBudget;
+    uint32      udpSent, udpReceived;
+    uint32      ringLost;
+    uint16      minFree;
+    uint32      errors;
+} Bench_Run;
+
+static const Bench_Scenario Bench_scenarios[] = {
+    {"single", 1, {Bench_Reader_fast}, FALSE},
+    {"mixed", 3, {Bench_Reader_slow, Bench_Reader_fast, Bench_Reader_lossy}, TRUE},
+};
+
+#define BENCH_SCENARIOS (sizeof(Bench_scenarios) / sizeof(Bench_scenarios[0]))
+
+static Bench_Run Bench_run;
+
+static uint32 Bench_get32(const uint8 *p)
+{
+    return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+
+/** \brief Byte at "offset" of the stream of connection "index" */
+static uint8 Bench_byte(uint32 index, uint32 offset)
+{
+    return (uint8)((offset * 7U) + (offset >> 8) + index);
+}
+
+
+/** \brief Puts a frame of the peer on the link, it reaches the RX ring one delay after its end */
+static void Bench_wireSend(Bench_Run *run, const uint8 *frame, uint16 length)
+{
+    Bench_Frame *f;
+
+    if ((run->wireTail - run->wireHead) >= BENCH_WIRE)
+    {
+        run->errors++;
+        return;
+    }
+
+    f             = &run->wire[run->wireTail++ % BENCH_WIRE];
+    run->linkFree = ((run->linkFree > run->now) ? run->linkFree : run->now) +
+                    (uint64)((length + BENCH_WIRE_OVERHEAD) * 8.0 * 1e9 / BENCH_LINK_BPS);
+    f->time       = run->linkFree + run->delay;
+    f->length     = length;
+    memcpy(f->data, frame, length);
+}
+
+
+/** \brief Sends "length" bytes of the stream at "offset", or a SYN */
+static void Bench_sendSegment(Bench_Run *run, Bench_Conn *conn, uint32 offset, uint16 length, uint8 flags)
+{
+    static uint8       payload[TCP_MSS];
+    static uint8       frame[BENCH_FRAME_SIZE];
+    HostSim_TcpSegment segment;
+    uint32             index = (uint32)(conn - run->conns);
+    uint32             i;
+
+    for (i = 0; i < length; i++)
+    {
+        payload[i] = Bench_byte(index, offset + i);
+    }
+
+    segment.srcPort = conn->peerPort;
+    segment.dstPort = BENCH_LOCAL_PORT;
+    segment.seqno   = BENCH_PEER_ISN + (((flags & TCP_SYN) != 0) ? 0U : (1U + offset));
+    segment.ackno   = ((flags & TCP_SYN) != 0) ? 0U : (conn->irs + 1U);
+    segment.flags   = flags;
+    segment.window  = 0xFFFFU;
+    segment.mss     = ((flags & TCP_SYN) != 0) ? TCP_MSS : 0U;
+
+    Bench_wireSend(run, frame, HostSim_buildTcpFrame(frame, &segment, payload, length));
+}
+
+
+/** \brief The sender of the peer: full segments as long as the window of the stack allows */
+static void Bench_peerOutput(Bench_Run *run, Bench_Conn *conn)
+{
+    while (conn->established && ((sint32)(conn->edge - conn->nxt) > 0) &&
+           ((run->wireTail - run->wireHead) < BENCH_WIRE))
+    {
+        uint32 room = conn->edge - conn->nxt;
+        uint16 len  = (uint16)((room < TCP_MSS) ? room : TCP_MSS);
+
+        if ((len < TCP_MSS) && (conn->nxt != conn->una))
+        {
+            break;      /* no small segment while data is in flight */
+        }
+
+        if (conn->una == conn->nxt)
+        {
+            conn->rtoAt = run->now + BENCH_RTO_NS;
+        }
+
+        if (conn->nxt != conn->high)
+        {
+            conn->rexmit++;
+            Bench_sendSegment(run, conn, conn->nxt, len, TCP_ACK);
+        }
+        else if ((conn->reader == Bench_Reader_lossy) && ((++conn->newSegments % BENCH_LOSS_EVERY) == 0))
+        {
+            conn->lost++;
+        }
+        else
+        {
+            Bench_sendSegment(run, conn, conn->nxt, len, TCP_ACK);
+        }
+
+        conn->nxt += len;
+
+        if ((sint32)(conn->nxt - conn->high) > 0)
+        {
+            conn->high = conn->nxt;
+        }
+    }
+}
+
+
+/** \brief A segment of the stack reaches the peer */
+static void Bench_peerInput(Bench_Run *run, const Bench_Ack *ack)
+{
+    Bench_Conn *conn = &run->conns[ack->conn];
+    uint32      offset;
+
+    if ((ack->flags & TCP_SYN) != 0)
+    {
+        conn->irs         = ack->seqno;
+        conn->established = TRUE;
+        conn->edge        = ack->window;
+        conn->window      = ack->window;
+        Bench_sendSegment(run, conn, 0, 0, TCP_ACK);
+        Bench_peerOutput(run, conn);
+        return;
+    }
+
+    offset = ack->ackno - (BENCH_PEER_ISN + 1U);
+
+    if ((sint32)(offset - conn->una) > 0)
+    {
+        conn->una     = offset;
+        conn->dupAcks = 0;
+
+        if ((sint32)(conn->una - conn->nxt) > 0)
+        {
+            conn->nxt = conn->una;      /* the stack had the rest on its ooseq queue */
+        }
+
+        conn->rtoAt = (conn->una != conn->nxt) ? (run->now + BENCH_RTO_NS) : 0;
+    }
+    else if ((offset == conn->una) && (conn->una != conn->high) && (ack->window == conn->window) &&
+             (++conn->dupAcks == BENCH_DUPACKS))
+    {
+        uint32 left = conn->high - conn->una;
+
+        conn->rexmit++;
+        Bench_sendSegment(run, conn, conn->una, (uint16)((left < TCP_MSS) ? left : TCP_MSS), TCP_ACK);
+    }
+
+    conn->window = ack->window;
+
+    if ((sint32)(offset + ack->window - conn->edge) > 0)
+    {
+        conn->edge = offset + ack->window;
+    }
+
+    Bench_peerOutput(run, conn);
+}
+
+
+/** \brief Frame hook: queues the segments of the stack for the peer */
+static void Bench_onFrame(void *context, const uint8 *frame, uint16 length)
+{
+    Bench_Run   *run = (Bench_Run *)context;
+    const uint8 *ip  = &frame[BENCH_ETH_HDR_LEN];
+    const uint8 *tcp;
+    uint32       index;
+    Bench_Ack   *ack;
+
+    if ((length < BENCH_ETH_HDR_LEN + IP_HLEN + TCP_HLEN) || (ip[9] != IP_PROTO_TCP))
+    {
+        return;
+    }
+
+    tcp   = &ip[(ip[0] & 0x0FU) * 4U];
+    index = (uint32)((tcp[2] << 8) | tcp[3]) - run->conns[0].peerPort;
+
+    if ((((tcp[0] << 8) | tcp[1]) != BENCH_LOCAL_PORT) || (index >= run->connCount) || ((tcp[13] & TCP_RST) != 0))
+    {
+        return;
+    }
+
+    if ((run->ackTail - run->ackHead) >= BENCH_ACKS)
+    {
+        run->errors++;
+        return;
+    }
+
+    ack         = &run->acks[run->ackTail++ % BENCH_ACKS];
+    ack->time   = run->now + run->delay;
+    ack->conn   = index;
+    ack->seqno  = Bench_get32(&tcp[4]);
+    ack->ackno  = Bench_get32(&tcp[8]);
+    ack->window = (uint16)((tcp[14] << 8) | tcp[15]);
+    ack->flags  = tcp[13];
+}
+
+
+/** \brief The application reads a pbuf chain: checks the data and opens the window again */
+static void Bench_read(Bench_Conn *conn, struct pbuf *p)
+{
+    uint32       index = (uint32)(conn - Bench_run.conns);
+    struct pbuf *q;
+    uint32       i;
+
+    for (q = p; q != NULL; q = q->next)
+    {
+        const uint8 *data = (const uint8 *)q->payload;
+
+        for (i = 0; i < q->len; i++)
+        {
+            if (data[i] != Bench_byte(index, conn->consumed + i))
+            {
+                conn->errors++;
+                break;
+            }
+        }
+
+        conn->consumed += q->len;
+    }
+
+    tcp_recved(conn->pcb, p->tot_len);
+    pbuf_free(p);
+}
+
+
+static err_t Bench_onRecv(void *arg, struct tcp_pcb *pcb, struct pbuf *p, err_t err)
+{
+    Bench_Conn *conn = (Bench_Conn *)arg;
+
+    (void)pcb;
+    (void)err;
+
+    if (p == NULL)
+    {
+        return ERR_OK;
+    }
+
+    if (conn->reader != Bench_Reader_slow)
+    {
+        Bench_read(conn, p);
+    }
+    else if ((conn->heldTail - conn->heldHead) < BENCH_HELD)
+    {
+        conn->held[conn->heldTail++ % BENCH_HELD] = p;
+    }
+    else
+    {
+        return ERR_MEM;     /* the stack keeps it as refused data */
+    }
+
+    return ERR_OK;
+}
+
+
+/** \brief The slow reader: BENCH_SLOW_BYTES_PER_MS, whole pbuf chains */
+static void Bench_readSlow(Bench_Run *run)
+{
+    uint32 c;
+
+    run->readBudget += BENCH_SLOW_BYTES_PER_MS;
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        Bench_Conn *conn = &run->conns[c];
+
+        while ((conn->reader == Bench_Reader_slow) && (conn->heldHead != conn->heldTail) &&
+               (conn->held[conn->heldHead % BENCH_HELD]->tot_len <= run->readBudget))
+        {
+            struct pbuf *p = conn->held[conn->heldHead++ % BENCH_HELD];
+
+            run->readBudget -= p->tot_len;
+            Bench_read(conn, p);
+        }
+
+        if ((conn->reader == Bench_Reader_slow) && (conn->heldHead == conn->heldTail))
+        {
+            run->readBudget = 0;    /* no credit while idle */
+        }
+    }
+}
+
+
+static err_t Bench_onAccept(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    Bench_Run *run = (Bench_Run *)arg;
+    uint32     c;
+
+    (void)err;
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        if (run->conns[c].peerPort == pcb->remote_port)
+        {
+            run->conns[c].pcb = pcb;
+            tcp_arg(pcb, &run->conns[c]);
+            tcp_recv(pcb, &Bench_onRecv);
+
+            return ERR_OK;
+        }
+    }
+
+    return ERR_VAL;
+}
+
+
+static void Bench_onUdp(void *arg, struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    ((Bench_Run *)arg)->udpReceived++;
+    pbuf_free(p);
+}
+
+
+/** \brief Next event on the virtual clock */
+static uint64 Bench_nextEvent(const Bench_Run *run, uint64 end)
+{
+    uint64 next = end;
+    uint32 c;
+
+    next = (run->wireHead != run->wireTail) ? LWIP_MIN(next, run->wire[run->wireHead % BENCH_WIRE].time) : next;
+    next = (run->ackHead != run->ackTail) ? LWIP_MIN(next, run->acks[run->ackHead % BENCH_ACKS].time) : next;
+    next = run->udp ? LWIP_MIN(next, run->nextUdp) : next;
+    next = LWIP_MIN(next, run->nextRead);
+    next = LWIP_MIN(next, run->nextTimer);
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        next = (run->conns[c].rtoAt != 0) ? LWIP_MIN(next, run->conns[c].rtoAt) : next;
+    }
+
+    return next;
+}
+
+
+/** \brief Runs the events due at run->now */
+static void Bench_step(Bench_Run *run)
+{
+    static uint8 frame[BENCH_FRAME_SIZE];
+    static uint8 payload[BENCH_UDP_PAYLOAD];
+    uint32       c;
+
+    while ((run->ackHead != run->ackTail) && (run->acks[run->ackHead % BENCH_ACKS].time <= run->now))
+    {
+        Bench_peerInput(run, &run->acks[run->ackHead++ % BENCH_ACKS]);
+    }
+
+    if (run->udp && (run->nextUdp <= run->now))
+    {
+        run->nextUdp += BENCH_UDP_INTERVAL_NS;
+        run->udpSent++;
+        Bench_wireSend(run, frame, HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, BENCH_UDP_PORT, payload,
+                BENCH_UDP_PAYLOAD));
+    }
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        Bench_Conn *conn = &run->conns[c];
+
+        if ((conn->rtoAt != 0) && (conn->rtoAt <= run->now))
+        {
+            conn->nxt     = conn->una;  /* go back N */
+            conn->dupAcks = 0;
+            conn->rtoAt   = 0;
+            Bench_peerOutput(run, conn);
+        }
+    }
+
+    if (run->nextRead <= run->now)
+    {
+        run->nextRead += BENCH_MS_NS;
+        Bench_readSlow(run);
+    }
+
+    if (run->nextTimer <= run->now)
+    {
+        run->nextTimer += TCP_TMR_INTERVAL * BENCH_MS_NS;
+        tcp_fasttmr();
+
+        if ((++run->timerTicks & 1U) == 0)
+        {
+            tcp_slowtmr();
+        }
+    }
+
+    /* the stack takes the frames one by one, as they arrive */
+    while ((run->wireHead != run->wireTail) && (run->wire[run->wireHead % BENCH_WIRE].time <= run->now))
+    {
+        Bench_Frame *f = &run->wire[run->wireHead++ % BENCH_WIRE];
+
+        run->ringLost += (HostSim_inject(f->data, f->length) == FALSE);
+        HostSim_poll();
+    }
+
+    HostSim_poll();
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        if (run->conns[c].pcb != NULL)
+        {
+            run->conns[c].ooseqMax = LWIP_MAX(run->conns[c].ooseqMax, run->conns[c].pcb->ooseq_len);
+        }
+    }
+
+    run->minFree = LWIP_MIN(run->minFree, memp_num_free(MEMP_PBUF_POOL));
+}
+
+
+/** \brief Runs "scenario" for "seconds" and prints its lines, returns FALSE on a failure */
+static boolean Bench_scenario(uint32 s, uint32 seconds, uint32 rttUs)
+{
+    const Bench_Scenario           *scenario = &Bench_scenarios[s];
+    Bench_Run                      *run      = &Bench_run;
+    struct ethernetif_tc2x_rxstats *rxstats  = ethernetif_tc2x_getRxStats();
+    uint32                          poolEmpty = rxstats->pool_empty;
+    uint64                          end       = (uint64)seconds * 1000U * BENCH_MS_NS;
+    struct tcp_pcb                 *listener;
+    struct udp_pcb                 *udp;
+    boolean                         ok        = TRUE;
+    uint32                          c, i;
+
+    memset(run, 0, sizeof(*run));
+    run->connCount = scenario->conns;
+    run->udp       = scenario->udp;
+    run->delay     = (uint64)rttUs * 1000U / 2U;
+    run->minFree   = 0xFFFFU;
+    run->nextRead  = BENCH_MS_NS;
+    run->nextTimer = TCP_TMR_INTERVAL * BENCH_MS_NS;
+
+    listener = tcp_new();
+    udp      = udp_new();
+
+    if ((listener == NULL) || (tcp_bind(listener, IP_ADDR_ANY, BENCH_LOCAL_PORT) != ERR_OK) ||
+        ((listener = tcp_listen(listener)) == NULL) || (udp == NULL) ||
+        (udp_bind(udp, IP_ADDR_ANY, BENCH_UDP_PORT) != ERR_OK))
+    {
+        printf("bench_tcprecv: FAILED, no listener\n");
+        return FALSE;
+    }
+
+    tcp_arg(listener, run);
+    tcp_accept(listener, &Bench_onAccept);
+    udp_recv(udp, &Bench_onUdp, run);
+    HostSim_setFrameHook(&Bench_onFrame, run);
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        run->conns[c].reader   = scenario->readers[c];
+        run->conns[c].peerPort = (uint16)(BENCH_PEER_PORT + (s * BENCH_CONNS) + c);
+        Bench_sendSegment(run, &run->conns[c], 0, 0, TCP_SYN);
+    }
+
+    while ((run->now < end) && (run->errors == 0))
+    {
+        run->now = Bench_nextEvent(run, end);
+        Bench_step(run);
+    }
+
+    HostSim_setFrameHook(NULL_PTR, NULL_PTR);
+
+    for (c = 0; c < run->connCount; c++)
+    {
+        Bench_Conn *conn = &run->conns[c];
+        static const char *readers[] = {"fast", "slow", "lossy"};
+
+        printf("%7s %4u %6s | %7.1f %8u %6u %6u\n", scenario->name, c, readers[conn->reader],
+            conn->consumed * 8.0 * 1e3 / (double)end, conn->ooseqMax, conn->lost, conn->rexmit);
+
+        ok = ok && conn->established && (conn->pcb != NULL) && (conn->errors == 0);
+
+        while (conn->heldHead != conn->heldTail)
+        {
+            pbuf_free(conn->held[conn->heldHead++ % BENCH_HELD]);
+        }
+
+        if (conn->pcb != NULL)
+        {
+            tcp_abort(conn->pcb);
+        }
+    }
+
+    printf("%7s udp %5u of %5u datagrams | ring lost %5u, pool empty %6u, min free %2u of %u\n", scenario->name,
+        run->udpReceived, run->udpSent, run->ringLost, rxstats->pool_empty - poolEmpty, run->minFree, PBUF_POOL_SIZE);
+
+    tcp_close(listener);
+    udp_remove(udp);
+
+    /* frames left in the ring find the pcbs gone */
+    for (i = 0; i < 16; i++)
+    {
+        HostSim_poll();
+    }
+
+    if ((ok == FALSE) || (run->errors != 0))
+    {
+        printf("bench_tcprecv: FAILED, scenario %s: %u errors\n", scenario->name, run->errors);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32  seconds = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_SECONDS_DEFAULT;
+    uint32  rttUs   = (argc > 2) ? (uint32)atoi(argv[2]) : BENCH_RTT_DEFAULT;
+    boolean ok      = TRUE;
+    uint32  s;
+
+    if ((seconds == 0) || (seconds > 1000) || (rttUs == 0))
+    {
+        printf("usage: Bench_TcpRecv [seconds] [rtt]\n");
+        return EXIT_FAILURE;
+    }
+
+    HostSim_init();
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("bench_tcprecv: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("bench_tcprecv: %u s per scenario, link 100 Mbit/s, RTT %u us, TCP_RCV_AUTOTUNE %u, TCP_WND %u, "
+           "PBUF_POOL_SIZE %u, TCP_OOSEQ_MAX_BYTES %u\n", seconds, rttUs, TCP_RCV_AUTOTUNE, TCP_WND, PBUF_POOL_SIZE,
+        TCP_OOSEQ_MAX_BYTES);
+    printf("%7s %4s %6s | %7s %8s %6s %6s\n", "", "conn", "reader", "Mbit/s", "ooseq", "lost", "rexmit");
+
+    for (s = 0; (s < BENCH_SCENARIOS) && ok; s++)
+    {
+        ok = Bench_scenario(s, seconds, rttUs);
+    }
+
+    printf("bench_tcprecv: %s\n", ok ? "PASSED" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
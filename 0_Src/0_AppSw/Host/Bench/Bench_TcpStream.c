@@ -0,0 +1,547 @@
+/**
+ * \file Bench_TcpStream.c
+ * \brief Host benchmark: TCP send goodput against the window of the receiver, iperf style
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The stack connects to the simulated peer and sends "megabytes" of a stream, as the
+ * diagnostics upload does. The segments leave through the driver and the IfxEth model and
+ * are put on a virtual link of 100 Mbit/s (preamble, FCS and inter-frame gap included) with
+ * a round trip time of "rtt" us. The peer checks the data, ACKs every segment with a fixed
+ * window and the ACK is written into the RX ring when it arrives on the virtual clock.
+ * "Mbit/s" is the goodput on that clock, "bound" the limit of the link and of
+ * min(window, TCP_SND_BUF) per round trip. "ns/KB" is the host time per KB sent, the checks
+ * of the peer included.
+ *
+ * The first table writes the stream with tcp_write() copying 16 KB at a time and with
+ * tcp_writev() over records of 1 KB, which stay referenced until their completion callback.
+ * Copied segments take a 1600 byte class of lwippools.h each, and the driver keeps the last
+ * one until its next frame: with 8 of them the copy falls short of TCP_SND_BUF in flight,
+ * while tcp_writev() only takes 128 byte classes for the headers.
+ * The second table writes records of 128 bytes with tcp_write() and tcp_output() after each
+ * one: without Nagle, with Nagle and corked (tcp_cork(), Nagle off, tcp_flush() at the end).
+ * With LWIP_TCP_GSO the full segments leave tcp_output() as super-segments, which the driver
+ * cuts into frames; the line after the first table counts them. LWIP_TCP_GSO is off by default,
+ * build with HOST_EXTRA_CFLAGS=-DLWIP_TCP_GSO=1 to compare ns/KB with one ip_output() per segment.
+ *
+ * Usage: Bench_TcpStream [megabytes] [rtt], default 16 MB per run and 1000 us.
+ */
+
+#include "HostSim.h"
+#include "lwip/tcp_impl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_MEGABYTES_DEFAULT (16U)
+#define BENCH_RTT_DEFAULT       (1000U)     /**< \brief us */
+#define BENCH_LINK_BPS          (100000000.0)
+#define BENCH_WIRE_OVERHEAD     (4U + 8U + 12U)  /**< \brief FCS, preamble and inter-frame gap */
+#define BENCH_ETH_HDR_LEN       (14U)       /**< \brief on the wire, without ETH_PAD_SIZE */
+#define BENCH_PEER_PORT         (5201U)
+#define BENCH_PEER_ISN          (0x20000000U)
+#define BENCH_RING              (65536U)    /**< \brief Application data, repeated over the stream */
+#define BENCH_COPY_WRITE        (16384U)    /**< \brief Bytes per tcp_write() of the copy mode */
+#define BENCH_RECORD            (1024U)     /**< \brief Record of the tcp_writev() mode */
+#define BENCH_IOV               (16U)
+#define BENCH_REQS              (16U)       /**< \brief tcp_writev() calls tracked, more than MEMP_NUM_TCP_WRITEV */
+#define BENCH_SMALL             (128U)      /**< \brief Record of the small write modes */
+#define BENCH_ACKS              (1024U)
+#define BENCH_FRAME_SIZE        (1536U)
+#define BENCH_SMALL_WINDOW      (TCP_SND_BUF)
+
+static const uint32 Bench_windows[] = {2 * TCP_MSS, 4 * TCP_MSS, 6 * TCP_MSS, 8 * TCP_MSS, 16384, 32768, 65535};
+
+#define BENCH_WINDOWS (sizeof(Bench_windows) / sizeof(Bench_windows[0]))
+
+/** \brief How the application writes the stream */
+typedef enum
+{
+    Bench_Mode_copy,        /**< \brief tcp_write() with TCP_WRITE_FLAG_COPY, 16 KB at a time */
+    Bench_Mode_writev,      /**< \brief tcp_writev() over records of 1 KB */
+    Bench_Mode_nodelay,     /**< \brief 128 byte tcp_write() + tcp_output(), Nagle off */
+    Bench_Mode_nagle,       /**< \brief 128 byte tcp_write() + tcp_output(), Nagle on */
+    Bench_Mode_cork         /**< \brief 128 byte tcp_write() + tcp_output(), corked */
+} Bench_Mode;
+
+/** \brief ACK of the peer on its way back */
+typedef struct
+{
+    uint64 time;            /**< \brief Arrival at the stack on the virtual clock, ns */
+    uint32 ackno;
+} Bench_Ack;
+
+/** \brief Result of one run */
+typedef struct
+{
+    double mbps;
+    double nsPerKb;
+    uint32 segments;
+} Bench_Result;
+
+/** \brief State of a run: application, virtual link and peer */
+typedef struct
+{
+    struct tcp_pcb *pcb;
+    Bench_Mode      mode;
+    uint32          window;
+    uint32          total;          /**< \brief Stream length */
+    uint32          written;        /**< \brief Bytes accepted by the stack */
+    boolean         flushed;
+    boolean         connected;
+    uint32          reqEnd[BENCH_REQS];     /**< \brief Stream offset after each tcp_writev() call */
+    uint32          reqHead, reqTail;
+    uint32          released;       /**< \brief Stream bytes whose tcp_writev() completed */
+    uint32          early;          /**< \brief Completions before the ACK of their data */
+    uint64          now;            /**< \brief Virtual clock, ns */
+    uint64          linkFree;       /**< \brief End of the frame on the link */
+    uint64          delay;          /**< \brief One way delay, ns */
+    uint64          start;          /**< \brief First data frame on the virtual clock */
+    Bench_Ack       acks[BENCH_ACKS];
+    uint32          ackHead, ackTail;
+    uint32          isn;            /**< \brief Initial sequence number of the stack */
+    uint16          localPort;
+    uint32          received;       /**< \brief In-order bytes at the peer */
+    uint32          segments;
+    uint32          duplicates;
+    uint32          errors;
+} Bench_Run;
+
+static uint8     Bench_ring[BENCH_RING];
+static Bench_Run Bench_run;
+
+static uint32 Bench_get32(const uint8 *p)
+{
+    return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+
+/** \brief Checks a segment of the stack against the stream and schedules the ACK of the peer */
+static void Bench_onFrame(void *context, const uint8 *frame, uint16 length)
+{
+    Bench_Run   *run = &Bench_run;
+    const uint8 *ip  = &frame[BENCH_ETH_HDR_LEN];
+    const uint8 *tcp;
+    uint32       seqno, offset, i;
+    uint16       total, dataLen;
+
+    (void)context;
+
+    if ((length < BENCH_ETH_HDR_LEN + IP_HLEN + TCP_HLEN) || (ip[9] != IP_PROTO_TCP))
+    {
+        return;
+    }
+
+    tcp   = &ip[(ip[0] & 0x0FU) * 4U];
+    total = (uint16)((ip[2] << 8) | ip[3]);
+    seqno = Bench_get32(&tcp[4]);
+
+    if ((((tcp[2] << 8) | tcp[3]) != BENCH_PEER_PORT) || ((tcp[13] & TCP_RST) != 0))
+    {
+        return;
+    }
+
+    if ((tcp[13] & TCP_SYN) != 0)
+    {
+        run->isn       = seqno;
+        run->localPort = (uint16)((tcp[0] << 8) | tcp[1]);
+        return;
+    }
+
+    dataLen = (uint16)(total - (uint16)(tcp - ip) - ((tcp[12] >> 4) * 4U));
+
+    if (dataLen == 0)
+    {
+        return;
+    }
+
+    /* the frame leaves the MAC when the link is free, the peer gets it one delay later */
+    if (run->segments == 0)
+    {
+        run->start = run->now;
+    }
+
+    run->segments++;
+    run->linkFree  = ((run->linkFree > run->now) ? run->linkFree : run->now) +
+                     (uint64)((length + BENCH_WIRE_OVERHEAD) * 8.0 * 1e9 / BENCH_LINK_BPS);
+    offset         = seqno - (run->isn + 1U);
+
+    if (offset == run->received)
+    {
+        const uint8 *data = &tcp[(tcp[12] >> 4) * 4U];
+
+        for (i = 0; i < dataLen; i++)
+        {
+            if (data[i] != Bench_ring[(offset + i) % BENCH_RING])
+            {
+                run->errors++;
+                break;
+            }
+        }
+
+        run->received += dataLen;
+    }
+    else if ((sint32)(offset - run->received) < 0)
+    {
+        run->duplicates++;
+    }
+    else
+    {
+        run->errors++;      /* the link does not reorder or lose segments */
+    }
+
+    if ((run->ackTail - run->ackHead) < BENCH_ACKS)
+    {
+        Bench_Ack *ack = &run->acks[run->ackTail++ % BENCH_ACKS];
+
+        ack->time  = run->linkFree + (2U * run->delay);
+        ack->ackno = run->isn + 1U + run->received;
+    }
+    else
+    {
+        run->errors++;
+    }
+}
+
+
+/** \brief Writes a segment of the peer into the RX ring and runs the stack once */
+static void Bench_send(uint8 flags, uint32 ackno, uint16 mss)
+{
+    static uint8       frame[BENCH_FRAME_SIZE];
+    HostSim_TcpSegment segment;
+
+    segment.srcPort = BENCH_PEER_PORT;
+    segment.dstPort = Bench_run.localPort;
+    segment.seqno   = BENCH_PEER_ISN + (((flags & TCP_SYN) != 0) ? 0U : 1U);
+    segment.ackno   = ackno;
+    segment.flags   = flags;
+    segment.window  = (uint16)Bench_run.window;
+    segment.mss     = mss;
+
+    HostSim_inject(frame, HostSim_buildTcpFrame(frame, &segment, NULL_PTR, 0));
+    HostSim_poll();
+}
+
+
+/** \brief Completion of tcp_writev(): the data of the call must have been ACKed */
+static void Bench_onWritten(void *arg)
+{
+    Bench_Run *run = (Bench_Run *)arg;
+    uint32     end = run->reqEnd[run->reqHead++ % BENCH_REQS];
+
+    if ((sint32)((run->isn + 1U + end) - run->pcb->lastack) > 0)
+    {
+        run->early++;
+    }
+
+    run->released = end;
+}
+
+
+static err_t Bench_onConnected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    (void)pcb;
+    (void)err;
+    ((Bench_Run *)arg)->connected = TRUE;
+
+    return ERR_OK;
+}
+
+
+/** \brief Queues the tcp_writev() call of up to "budget" bytes, records of BENCH_RECORD bytes */
+static err_t Bench_writev(Bench_Run *run, uint32 budget)
+{
+    struct tcp_iovec iov[BENCH_IOV];
+    uint32           offset = run->written;
+    u16_t            n      = 0;
+    err_t            err;
+
+    if ((run->reqTail - run->reqHead) >= BENCH_REQS)
+    {
+        return ERR_MEM;
+    }
+
+    while ((budget > 0) && (n < BENCH_IOV))
+    {
+        uint32 pos = offset % BENCH_RING;
+        uint32 len = BENCH_RECORD - (offset % BENCH_RECORD);
+
+        len          = (len < budget) ? len : budget;
+        iov[n].base  = &Bench_ring[pos];
+        iov[n].len   = (u16_t)len;
+        offset      += len;
+        budget      -= len;
+        n++;
+    }
+
+    run->reqEnd[run->reqTail % BENCH_REQS] = offset;
+    err                                    = tcp_writev(run->pcb, iov, n, &Bench_onWritten, run, 0);
+
+    if (err == ERR_OK)
+    {
+        run->reqTail++;
+        run->written = offset;
+    }
+
+    return err;
+}
+
+
+/** \brief The application: writes as much of the stream as the stack takes */
+static void Bench_write(Bench_Run *run)
+{
+    err_t err = ERR_OK;
+
+    while ((err == ERR_OK) && (run->written < run->total))
+    {
+        uint32 left  = run->total - run->written;
+        uint32 space = tcp_sndbuf(run->pcb);
+        uint32 pos   = run->written % BENCH_RING;
+        uint32 len;
+
+        if (run->mode == Bench_Mode_writev)
+        {
+            /* no call for less than a record, unless it ends the stream */
+            len = (left < space) ? left : space;
+            err = ((len >= BENCH_RECORD) || (len == left)) ? Bench_writev(run, len) : ERR_MEM;
+            continue;
+        }
+
+        len = (run->mode == Bench_Mode_copy) ? BENCH_COPY_WRITE : BENCH_SMALL;
+        len = (len < left) ? len : left;
+        len = (len < (BENCH_RING - pos)) ? len : (BENCH_RING - pos);
+
+        if (run->mode == Bench_Mode_copy)
+        {
+            len = (len < space) ? len : space;
+        }
+
+        if ((len == 0) || (len > space))
+        {
+            break;
+        }
+
+        err = tcp_write(run->pcb, &Bench_ring[pos], (u16_t)len, TCP_WRITE_FLAG_COPY);
+
+        if (err == ERR_OK)
+        {
+            run->written += len;
+
+            if (run->mode != Bench_Mode_copy)
+            {
+                tcp_output(run->pcb);
+            }
+        }
+    }
+
+    if ((err != ERR_OK) && (err != ERR_MEM))
+    {
+        run->errors++;
+    }
+
+    if ((run->written == run->total) && (run->flushed == FALSE))
+    {
+        run->flushed = TRUE;
+        tcp_flush(run->pcb);
+    }
+    else
+    {
+        tcp_output(run->pcb);
+    }
+}
+
+
+/** \brief Sends "total" bytes in "mode" against "window" and returns FALSE on a failure */
+static boolean Bench_stream(Bench_Mode mode, uint32 window, uint32 total, uint32 rttUs, Bench_Result *result)
+{
+    Bench_Run *run = &Bench_run;
+    ip_addr_t  peer;
+    uint64     wall;
+
+    memset(run, 0, sizeof(*run));
+    run->mode   = mode;
+    run->window = window;
+    run->total  = total;
+    run->delay  = (uint64)rttUs * 1000U / 2U;
+    run->pcb    = tcp_new();
+    HOSTSIM_PEER_IP(&peer);
+
+    if (run->pcb == NULL)
+    {
+        printf("bench_tcpstream: FAILED, no pcb\n");
+        return FALSE;
+    }
+
+    tcp_arg(run->pcb, run);
+
+    if (mode != Bench_Mode_nagle)
+    {
+        tcp_nagle_disable(run->pcb);
+    }
+
+    if (mode == Bench_Mode_cork)
+    {
+        tcp_cork(run->pcb);
+    }
+
+    HostSim_setFrameHook(&Bench_onFrame, NULL_PTR);
+
+    /* handshake, outside of the virtual clock */
+    if (tcp_connect(run->pcb, &peer, BENCH_PEER_PORT, &Bench_onConnected) == ERR_OK)
+    {
+        Bench_send(TCP_SYN | TCP_ACK, run->isn + 1U, TCP_MSS);
+    }
+
+    if ((run->connected == FALSE) || (run->pcb->mss != TCP_MSS))
+    {
+        printf("bench_tcpstream: FAILED, connection not established\n");
+        HostSim_setFrameHook(NULL_PTR, NULL_PTR);
+        return FALSE;
+    }
+
+    wall = HostSim_nowNs();
+    Bench_write(run);
+
+    while ((run->errors == 0) && (run->ackHead != run->ackTail))
+    {
+        Bench_Ack *ack = &run->acks[run->ackHead++ % BENCH_ACKS];
+
+        run->now = ack->time;
+        Bench_send(TCP_ACK, ack->ackno, 0);
+        Bench_write(run);
+    }
+
+    wall = HostSim_nowNs() - wall;
+
+    /* release the frames of the last segments, which completes the last tcp_writev() */
+    ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    HostSim_setFrameHook(NULL_PTR, NULL_PTR);
+
+    result->mbps     = (run->now > run->start) ? (total * 8.0 * 1e3 / (double)(run->now - run->start)) : 0.0;
+    result->nsPerKb  = (double)wall * 1024.0 / total;
+    result->segments = run->segments;
+
+    if ((run->errors != 0) || (run->received != total) || (run->duplicates != 0) || (run->pcb->unacked != NULL) ||
+        (run->pcb->unsent != NULL) || ((mode == Bench_Mode_writev) && ((run->released != total) || (run->early != 0))))
+    {
+        printf("bench_tcpstream: FAILED, mode %u window %u: %u of %u bytes received, %u errors, %u duplicates, "
+               "%u released, %u early\n", mode, window, run->received, total, run->errors, run->duplicates,
+            run->released, run->early);
+        tcp_abort(run->pcb);
+        return FALSE;
+    }
+
+    tcp_abort(run->pcb);
+
+    return TRUE;
+}
+
+
+/** \brief Limit of the link and of the bytes in flight per round trip, Mbit/s */
+static double Bench_bound(uint32 window, uint32 rttUs)
+{
+    double frame    = BENCH_ETH_HDR_LEN + IP_HLEN + TCP_HLEN + TCP_MSS + BENCH_WIRE_OVERHEAD;
+    double link     = BENCH_LINK_BPS * TCP_MSS / frame / 1e6;
+    double inFlight = (window < TCP_SND_BUF) ? window : TCP_SND_BUF;
+    double round    = rttUs * 1e-6 + (frame * 8.0 / BENCH_LINK_BPS);
+    double limit    = inFlight * 8.0 / round / 1e6;
+
+    return (limit < link) ? limit : link;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32       megabytes = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_MEGABYTES_DEFAULT;
+    uint32       rttUs     = (argc > 2) ? (uint32)atoi(argv[2]) : BENCH_RTT_DEFAULT;
+    uint32       total;
+    boolean      ok        = TRUE;
+    Bench_Result rc, rv;
+    uint32       i;
+#if LWIP_TCP_GSO
+    uint32       frames, gso;
+#endif
+
+    if ((megabytes == 0) || (megabytes > 4000) || (rttUs == 0))
+    {
+        printf("usage: Bench_TcpStream [megabytes] [rtt]\n");
+        return EXIT_FAILURE;
+    }
+
+    total = megabytes << 20;
+
+    for (i = 0; i < BENCH_RING; i++)
+    {
+        Bench_ring[i] = (uint8)((i * 7U) + (i >> 8));
+    }
+
+    HostSim_init();
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("bench_tcpstream: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    printf("bench_tcpstream: %u MB per run, link 100 Mbit/s, RTT %u us, TCP_MSS %u, TCP_SND_BUF %u\n", megabytes,
+        rttUs, TCP_MSS, TCP_SND_BUF);
+    printf("%6s %7s | %8s %7s | %8s %7s\n", "window", "bound", "copy", "ns/KB", "writev", "ns/KB");
+#if LWIP_TCP_GSO
+    frames = HostSim_getPeerStats()->tcpFrames;
+    gso    = ethernetif_tc2x_getTxStats()->gso;
+#endif
+
+    for (i = 0; (i < BENCH_WINDOWS) && ok; i++)
+    {
+        ok = Bench_stream(Bench_Mode_copy, Bench_windows[i], total, rttUs, &rc) &&
+             Bench_stream(Bench_Mode_writev, Bench_windows[i], total, rttUs, &rv);
+
+        if (ok)
+        {
+            printf("%6u %7.1f | %8.1f %7.0f | %8.1f %7.0f\n", Bench_windows[i], Bench_bound(Bench_windows[i], rttUs),
+                rc.mbps, rc.nsPerKb, rv.mbps, rv.nsPerKb);
+        }
+    }
+
+#if LWIP_TCP_GSO
+    printf("%u of %u TCP frames cut from super-segments by the driver\n", ethernetif_tc2x_getTxStats()->gso - gso,
+        HostSim_getPeerStats()->tcpFrames - frames);
+#endif
+    printf("%u byte writes, window %u:\n", BENCH_SMALL, BENCH_SMALL_WINDOW);
+    printf("%8s %8s %9s %7s\n", "mode", "Mbit/s", "segments", "B/seg");
+
+    for (i = Bench_Mode_nodelay; (i <= Bench_Mode_cork) && ok; i++)
+    {
+        static const char *names[] = {"nodelay", "nagle", "cork"};
+
+        ok = Bench_stream((Bench_Mode)i, BENCH_SMALL_WINDOW, total, rttUs, &rc);
+
+        if (ok)
+        {
+            printf("%8s %8.1f %9u %7.0f\n", names[i - Bench_Mode_nodelay], rc.mbps, rc.segments,
+                (double)total / rc.segments);
+        }
+    }
+
+    if (HostSim_getPeerStats()->badChecksum != 0)
+    {
+        printf("bench_tcpstream: FAILED, %u bad checksums\n", HostSim_getPeerStats()->badChecksum);
+        ok = FALSE;
+    }
+
+    printf("bench_tcpstream: %s\n", ok ? "PASSED" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,425 @@
+/**
+ * \file Bench_Timers.c
+ * \brief Host benchmark: lwIP timeouts in the timing wheel against the sorted list
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * Both implementations run side by side on a virtual clock, sys_now() is caught with the
+ * linker option --wrap (see Host.mk): the wheel of the library (LWIP_TIMER_WHEEL 1,
+ * sys_timeout_start() and sys_timeout_stop() on caller-owned entries) and timers.c built
+ * once more with LWIP_TIMER_WHEEL 0 and its functions renamed to sys_list_* (sys_timeout()
+ * and sys_untimeout(), the MEMP_SYS_TIMEOUT elements come from malloc()).
+ *
+ * "pending" timeouts are kept armed: mostly ARP/TCP-like delays below 1 s, some up to a
+ * minute and a few up to 70 minutes. The clock advances 1 ms per step from just below the
+ * 32 bit wrap around, every step checks the timeouts, re-arms the expired ones and
+ * restarts one random timeout. Every timeout of the wheel has to expire in exactly its
+ * millisecond, none before the time returned by sys_timeouts_sleeptime(). The list of
+ * lwIP 1.4.1 counts a new timeout from the last expiry instead of sys_now(), its "off"
+ * column shows the timeouts expiring early.
+ *
+ * Every number of pending timeouts is run in its own process. Usage: Bench_Timers [steps],
+ * default 100000. The times include reading the clock.
+ */
+
+#include "HostSim.h"
+#include "lwip/memp.h"
+#include "lwip/timers.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define BENCH_STEPS_DEFAULT (100000U)
+#define BENCH_START_TIME    (0xFFFFFFFFU - 50000U)  /**< \brief Virtual clock at the start, wraps around after 50 s */
+
+static const uint32 Bench_pendings[] = {16, 64, 256, 1024, 4096};
+
+#define BENCH_PENDINGS (sizeof(Bench_pendings) / sizeof(Bench_pendings[0]))
+
+/** \brief Mean time of one operation */
+typedef struct
+{
+    uint64 ns;
+    uint32 count;
+} Bench_Stat;
+
+/** \brief Implementation under test */
+typedef struct
+{
+    const char *name;
+    void        (*start)(uint32 idx, uint32 delay);
+    void        (*stop)(uint32 idx);
+    void        (*check)(void);
+    uint32      (*sleeptime)(void);
+    uint32     *expiry;     /**< \brief Expected expiry per timeout */
+    boolean    *pending;
+    uint32     *arms;       /**< \brief Starts per timeout, selects its next delay */
+    uint32     *fired;      /**< \brief Timeouts expired by the last check */
+    uint32      firedCount;
+    uint32      off;        /**< \brief Timeouts not expiring in their millisecond */
+    uint32      quiet;      /**< \brief No timeout may expire before, from sys_timeouts_sleeptime() */
+    uint32      early;      /**< \brief Timeouts expiring before "quiet" */
+    uint32      expired;
+    Bench_Stat  insert;
+    Bench_Stat  cancel;
+    Bench_Stat  poll;
+    Bench_Stat  query;
+} Bench_Impl;
+
+/* memp_malloc() and memp_free() of the library, reached through --wrap */
+void *__real_memp_malloc(memp_t type);
+void  __real_memp_free(memp_t type, void *mem);
+
+/* sorted list, timers.c built with LWIP_TIMER_WHEEL 0 */
+void  sys_list_timeouts_init(void);
+void  sys_list_timeout(u32_t msecs, sys_timeout_handler handler, void *arg);
+void  sys_list_untimeout(sys_timeout_handler handler, void *arg);
+void  sys_list_check_timeouts(void);
+u32_t sys_list_timeouts_sleeptime(void);
+
+static uint32            Bench_now;
+static uint32            Bench_seed = 1;
+static struct sys_timeo *Bench_entries;  /**< \brief Caller-owned entries of the wheel */
+static Bench_Impl        Bench_wheel;
+static Bench_Impl        Bench_list;
+
+u32_t __wrap_sys_now(void)
+{
+    return Bench_now;
+}
+
+
+/* the list allocates its entries with memp_malloc(), the pool is too small for the bench */
+void *__wrap_memp_malloc(memp_t type)
+{
+    return (type == MEMP_SYS_TIMEOUT) ? malloc(sizeof(struct sys_timeo)) : __real_memp_malloc(type);
+}
+
+
+void __wrap_memp_free(memp_t type, void *mem)
+{
+    if (type == MEMP_SYS_TIMEOUT)
+    {
+        free(mem);
+    }
+    else
+    {
+        __real_memp_free(type, mem);
+    }
+}
+
+
+static uint32 Bench_random(uint32 range)
+{
+    Bench_seed = (Bench_seed * 1103515245U) + 12345U;
+    return (Bench_seed >> 16) % range;
+}
+
+
+/** \brief Delay of the n-th start of a timeout, the same sequence for both implementations */
+static uint32 Bench_delay(uint32 idx, uint32 n)
+{
+    uint32 h = (idx * 0x9E3779B9U) ^ (n * 0x85EBCA6BU);
+    uint32 r;
+
+    h ^= h >> 15;
+    h *= 0x2C1B3C6DU;
+    h ^= h >> 12;
+    r  = h % 100U;
+    h  = h >> 8;
+
+    if (r < 70U)
+    {
+        return 1U + (h % 1000U);
+    }
+    else if (r < 95U)
+    {
+        return 1000U + (h % 59000U);
+    }
+    else
+    {
+        return 60000U + (h % (1U << 22));
+    }
+}
+
+
+static void Bench_onExpired(Bench_Impl *impl, uint32 idx)
+{
+    if ((impl->pending[idx] == FALSE) || (impl->expiry[idx] != Bench_now))
+    {
+        impl->off++;
+    }
+
+    if ((sint32)(Bench_now - impl->quiet) < 0)
+    {
+        impl->early++;
+    }
+
+    impl->pending[idx]                = FALSE;
+    impl->fired[impl->firedCount++]   = idx;
+    impl->expired++;
+}
+
+
+static void Bench_onWheel(void *arg)
+{
+    Bench_onExpired(&Bench_wheel, (uint32)(uintptr_t)arg);
+}
+
+
+static void Bench_onList(void *arg)
+{
+    Bench_onExpired(&Bench_list, (uint32)(uintptr_t)arg);
+}
+
+
+static void Bench_wheelStart(uint32 idx, uint32 delay)
+{
+    sys_timeout_start(&Bench_entries[idx], delay, 0, &Bench_onWheel, (void *)(uintptr_t)idx);
+}
+
+
+static void Bench_wheelStop(uint32 idx)
+{
+    sys_timeout_stop(&Bench_entries[idx]);
+}
+
+
+static void Bench_listStart(uint32 idx, uint32 delay)
+{
+    sys_list_timeout(delay, &Bench_onList, (void *)(uintptr_t)idx);
+}
+
+
+static void Bench_listStop(uint32 idx)
+{
+    sys_list_untimeout(&Bench_onList, (void *)(uintptr_t)idx);
+}
+
+
+static void Bench_start(Bench_Impl *impl, uint32 idx, uint32 delay)
+{
+    uint64 start = HostSim_nowNs();
+
+    impl->start(idx, delay);
+    impl->insert.ns += HostSim_nowNs() - start;
+    impl->insert.count++;
+    impl->expiry[idx]  = Bench_now + delay;
+    impl->pending[idx] = TRUE;
+}
+
+
+static void Bench_stop(Bench_Impl *impl, uint32 idx)
+{
+    uint64 start = HostSim_nowNs();
+
+    impl->stop(idx);
+    impl->cancel.ns += HostSim_nowNs() - start;
+    impl->cancel.count++;
+    impl->pending[idx] = FALSE;
+}
+
+
+static void Bench_check(Bench_Impl *impl)
+{
+    uint64 start = HostSim_nowNs();
+    uint32 i;
+
+    impl->firedCount = 0;
+    impl->check();
+    impl->poll.ns   += HostSim_nowNs() - start;
+    impl->poll.count++;
+
+    for (i = 0; i < impl->firedCount; i++)
+    {
+        uint32 idx = impl->fired[i];
+
+        Bench_start(impl, idx, Bench_delay(idx, ++impl->arms[idx]));
+    }
+}
+
+
+static uint32 Bench_sleeptime(Bench_Impl *impl)
+{
+    uint64 start = HostSim_nowNs();
+    uint32 sleep = impl->sleeptime();
+
+    impl->query.ns += HostSim_nowNs() - start;
+    impl->query.count++;
+    impl->quiet     = Bench_now + sleep;
+
+    return sleep;
+}
+
+
+static void Bench_reset(Bench_Impl *impl, uint32 pending)
+{
+    impl->expiry     = calloc(pending, sizeof(uint32));
+    impl->pending    = calloc(pending, sizeof(boolean));
+    impl->arms       = calloc(pending, sizeof(uint32));
+    impl->fired      = calloc(pending, sizeof(uint32));
+    impl->firedCount = 0;
+    impl->off        = 0;
+    impl->quiet      = Bench_now;
+    impl->early      = 0;
+    impl->expired    = 0;
+    memset(&impl->insert, 0, sizeof(impl->insert));
+    memset(&impl->cancel, 0, sizeof(impl->cancel));
+    memset(&impl->poll, 0, sizeof(impl->poll));
+    memset(&impl->query, 0, sizeof(impl->query));
+
+    if ((impl->expiry == NULL) || (impl->pending == NULL) || (impl->arms == NULL) || (impl->fired == NULL))
+    {
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+static double Bench_mean(const Bench_Stat *stat)
+{
+    return (stat->count != 0) ? ((double)stat->ns / stat->count) : 0.0;
+}
+
+
+static void Bench_print(uint32 pending, const Bench_Impl *impl)
+{
+    printf("%8u %-6s %8.1f %8.1f %8.1f %8.1f %8u %6u\n", pending, impl->name, Bench_mean(&impl->insert),
+        Bench_mean(&impl->cancel), Bench_mean(&impl->poll), Bench_mean(&impl->query), impl->expired, impl->off);
+}
+
+
+/** \brief Runs both implementations with "pending" timeouts, runs in the child process */
+static int Bench_run(uint32 pending, uint32 steps)
+{
+    uint32 tooLong = 0;
+    uint32 i, step;
+
+    Bench_now     = BENCH_START_TIME;
+    Bench_entries = calloc(pending, sizeof(struct sys_timeo));
+
+    if (Bench_entries == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    Bench_reset(&Bench_wheel, pending);
+    Bench_reset(&Bench_list, pending);
+    sys_timeouts_init();
+    sys_list_timeouts_init();
+
+    for (i = 0; i < pending; i++)
+    {
+        Bench_start(&Bench_wheel, i, Bench_delay(i, 0));
+        Bench_start(&Bench_list, i, Bench_delay(i, 0));
+    }
+
+    for (step = 0; step < steps; step++)
+    {
+        uint32 idx = Bench_random(pending);
+
+        Bench_now++;
+        Bench_check(&Bench_wheel);
+        Bench_check(&Bench_list);
+
+        Bench_stop(&Bench_wheel, idx);
+        Bench_stop(&Bench_list, idx);
+        Bench_start(&Bench_wheel, idx, Bench_delay(idx, ++Bench_wheel.arms[idx]));
+        Bench_start(&Bench_list, idx, Bench_delay(idx, ++Bench_list.arms[idx]));
+
+        Bench_sleeptime(&Bench_list);
+
+        /* every 64 steps: not beyond the earliest timeout of the bench */
+        if ((Bench_sleeptime(&Bench_wheel) > 0) && ((step % 64U) == 0))
+        {
+            for (i = 0; i < pending; i++)
+            {
+                if (Bench_wheel.expiry[i] - Bench_now < Bench_wheel.quiet - Bench_now)
+                {
+                    tooLong++;
+                    break;
+                }
+            }
+        }
+    }
+
+    Bench_print(pending, &Bench_wheel);
+    Bench_print(pending, &Bench_list);
+
+    if ((Bench_wheel.off != 0) || (Bench_wheel.early != 0) || (tooLong != 0))
+    {
+        printf("bench_timers: FAILED, wheel %u timeouts off their millisecond, sleeptime %u too short %u too long\n",
+            Bench_wheel.off, Bench_wheel.early, tooLong);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32 steps  = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_STEPS_DEFAULT;
+    int    result = EXIT_SUCCESS;
+    uint32 p;
+
+    if (steps == 0)
+    {
+        printf("usage: Bench_Timers [steps]\n");
+        return EXIT_FAILURE;
+    }
+
+    Bench_wheel.name      = "wheel";
+    Bench_wheel.start     = &Bench_wheelStart;
+    Bench_wheel.stop      = &Bench_wheelStop;
+    Bench_wheel.check     = &sys_check_timeouts;
+    Bench_wheel.sleeptime = &sys_timeouts_sleeptime;
+    Bench_list.name       = "list";
+    Bench_list.start      = &Bench_listStart;
+    Bench_list.stop       = &Bench_listStop;
+    Bench_list.check      = &sys_list_check_timeouts;
+    Bench_list.sleeptime  = &sys_list_timeouts_sleeptime;
+
+    printf("bench_timers: %u steps of 1 ms, ns per call\n", steps);
+    printf("%8s %-6s %8s %8s %8s %8s %8s %6s\n", "pending", "impl", "start", "stop", "check", "sleep", "expired", "off");
+
+    for (p = 0; p < BENCH_PENDINGS; p++)
+    {
+        int   status;
+        pid_t child;
+
+        fflush(stdout);
+        child = fork();
+
+        if (child == 0)
+        {
+            memp_init();
+            status = Bench_run(Bench_pendings[p], steps);
+            fflush(stdout);
+            _exit(status);
+        }
+
+        if ((child < 0) || (waitpid(child, &status, 0) != child) || !WIFEXITED(status) ||
+            (WEXITSTATUS(status) != EXIT_SUCCESS))
+        {
+            printf("bench_timers: FAILED, %u pending timeouts\n", Bench_pendings[p]);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    return result;
+}
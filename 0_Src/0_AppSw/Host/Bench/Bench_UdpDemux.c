@@ -0,0 +1,278 @@
+/**
+ * \file Bench_UdpDemux.c
+ * \brief Host benchmark: udp_input() demultiplexing with hash tables against the pcb list
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The same datagrams are passed to udp_input() of the library (UDP_PCB_HASH 1) and of udp.c
+ * built once more with UDP_PCB_HASH 0 and its functions renamed to udp_list_* (see Host.mk).
+ * Every run binds "pcbs" pcbs to consecutive ports, every second one is connected to its
+ * own peer port, as per-sensor endpoints would be. The datagrams go round robin to all
+ * pcbs, those of the unconnected pcbs from a source port no pcb is connected to. The pcbs
+ * come from malloc() through --wrap, the pool is too small for the bench.
+ *
+ * One pbuf with the IP and UDP headers is reused, the receive callback counts the datagram
+ * per pcb and restores the payload pointer instead of freeing it. The times are per
+ * datagram and include writing the ports into the header. Usage: Bench_UdpDemux [datagrams],
+ * default 1000000 per run.
+ */
+
+#include "HostSim.h"
+#include "lwip/ip.h"
+#include "lwip/memp.h"
+#include "lwip/udp.h"
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DATAGRAMS_DEFAULT (1000000U)
+#define BENCH_LOCAL_PORT        (20000U)
+#define BENCH_PEER_PORT         (30000U)
+#define BENCH_OTHER_PORT        (40000U)  /**< \brief Source port of the datagrams to the unconnected pcbs */
+#define BENCH_PAYLOAD           (16U)
+#define BENCH_MAX_PCBS          (256U)
+
+static const uint32 Bench_pcbCounts[] = {1, 16, 64, BENCH_MAX_PCBS};
+
+#define BENCH_RUNS (sizeof(Bench_pcbCounts) / sizeof(Bench_pcbCounts[0]))
+
+/** \brief Implementation under test */
+typedef struct
+{
+    const char      *name;
+    struct udp_pcb *(*create)(void);
+    void             (*remove)(struct udp_pcb *pcb);
+    err_t            (*bind)(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port);
+    err_t            (*connect)(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port);
+    void             (*recv)(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg);
+    void             (*input)(struct pbuf *p, struct netif *inp);
+    struct udp_pcb  *pcbs[BENCH_MAX_PCBS];
+    double           ns[BENCH_RUNS];
+} Bench_Impl;
+
+/* memp_malloc() and memp_free() of the library, reached through --wrap */
+void *__real_memp_malloc(memp_t type);
+void  __real_memp_free(memp_t type, void *mem);
+
+/* pcb list, udp.c built with UDP_PCB_HASH 0 */
+struct udp_pcb *udp_list_new(void);
+void            udp_list_remove(struct udp_pcb *pcb);
+err_t           udp_list_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port);
+err_t           udp_list_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port);
+void            udp_list_recv(struct udp_pcb *pcb, udp_recv_fn recv, void *recv_arg);
+void            udp_list_input(struct pbuf *p, struct netif *inp);
+
+static struct netif Bench_netif;
+static uint32       Bench_received[BENCH_MAX_PCBS];
+static uint32       Bench_misrouted;
+static uint32       Bench_expected;     /**< \brief Index of the pcb the current datagram is sent to */
+static Bench_Impl   Bench_hash;
+static Bench_Impl   Bench_list;
+
+void *__wrap_memp_malloc(memp_t type)
+{
+    return (type == MEMP_UDP_PCB) ? malloc(sizeof(struct udp_pcb)) : __real_memp_malloc(type);
+}
+
+
+void __wrap_memp_free(memp_t type, void *mem)
+{
+    if (type == MEMP_UDP_PCB)
+    {
+        free(mem);
+    }
+    else
+    {
+        __real_memp_free(type, mem);
+    }
+}
+
+
+/** \brief Counts the datagram and moves the payload back to the IP header for the next one */
+static void Bench_onReceive(void *arg, struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *addr, u16_t port)
+{
+    uint32 idx = (uint32)(uintptr_t)arg;
+
+    (void)pcb;
+    (void)addr;
+    (void)port;
+
+    Bench_received[idx]++;
+    Bench_misrouted += (idx != Bench_expected);
+    pbuf_header(p, IP_HLEN + UDP_HLEN);
+}
+
+
+static struct pbuf *Bench_buildDatagram(void)
+{
+    struct pbuf    *p = pbuf_alloc(PBUF_RAW, IP_HLEN + UDP_HLEN + BENCH_PAYLOAD, PBUF_RAM);
+    struct ip_hdr  *iphdr;
+    struct udp_hdr *udphdr;
+
+    if (p == NULL)
+    {
+        exit(EXIT_FAILURE);
+    }
+
+    memset(p->payload, 0, p->len);
+    iphdr  = (struct ip_hdr *)p->payload;
+    udphdr = (struct udp_hdr *)((uint8 *)p->payload + IP_HLEN);
+    IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+    IPH_LEN_SET(iphdr, htons(p->tot_len));
+    IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+    HOSTSIM_PEER_IP(&iphdr->src);
+    HOSTSIM_LOCAL_IP(&iphdr->dest);
+    udphdr->len = htons(UDP_HLEN + BENCH_PAYLOAD);
+
+    /* udp_input() takes the addresses from ip_input() */
+    ip_addr_copy(current_iphdr_src, iphdr->src);
+    ip_addr_copy(current_iphdr_dest, iphdr->dest);
+
+    return p;
+}
+
+
+static void Bench_open(Bench_Impl *impl, uint32 count)
+{
+    ip_addr_t peer;
+    uint32    i;
+
+    HOSTSIM_PEER_IP(&peer);
+
+    for (i = 0; i < count; i++)
+    {
+        struct udp_pcb *pcb = impl->create();
+
+        if ((pcb == NULL) || (impl->bind(pcb, IP_ADDR_ANY, (u16_t)(BENCH_LOCAL_PORT + i)) != ERR_OK) ||
+            (((i & 1U) != 0) && (impl->connect(pcb, &peer, (u16_t)(BENCH_PEER_PORT + i)) != ERR_OK)))
+        {
+            exit(EXIT_FAILURE);
+        }
+
+        impl->recv(pcb, &Bench_onReceive, (void *)(uintptr_t)i);
+        impl->pcbs[i] = pcb;
+    }
+}
+
+
+static void Bench_close(Bench_Impl *impl, uint32 count)
+{
+    uint32 i;
+
+    for (i = 0; i < count; i++)
+    {
+        impl->remove(impl->pcbs[i]);
+    }
+}
+
+
+/** \brief Sends "datagrams" round robin to "count" pcbs, returns the time per datagram */
+static double Bench_run(Bench_Impl *impl, struct pbuf *p, uint32 count, uint32 datagrams)
+{
+    struct udp_hdr *udphdr = (struct udp_hdr *)((uint8 *)p->payload + IP_HLEN);
+    uint32          idx    = 0;
+    uint64          start;
+    uint32          n;
+
+    Bench_open(impl, count);
+    memset(Bench_received, 0, sizeof(Bench_received));
+    Bench_misrouted = 0;
+    start           = HostSim_nowNs();
+
+    for (n = 0; n < datagrams; n++)
+    {
+        Bench_expected = idx;
+        udphdr->src    = htons((u16_t)(((idx & 1U) != 0) ? (BENCH_PEER_PORT + idx) : BENCH_OTHER_PORT));
+        udphdr->dest   = htons((u16_t)(BENCH_LOCAL_PORT + idx));
+        impl->input(p, &Bench_netif);
+
+        if (++idx == count)
+        {
+            idx = 0;
+        }
+    }
+
+    start = HostSim_nowNs() - start;
+    Bench_close(impl, count);
+
+    for (n = 0; n < count; n++)
+    {
+        if (Bench_received[n] != (datagrams / count) + (n < (datagrams % count)))
+        {
+            Bench_misrouted++;
+        }
+    }
+
+    if (Bench_misrouted != 0)
+    {
+        printf("bench_udpdemux: FAILED, %s with %u pcbs, %u datagrams misrouted\n", impl->name, count,
+            Bench_misrouted);
+        exit(EXIT_FAILURE);
+    }
+
+    return (double)start / datagrams;
+}
+
+
+int main(int argc, char **argv)
+{
+    uint32       datagrams = (argc > 1) ? (uint32)atoi(argv[1]) : BENCH_DATAGRAMS_DEFAULT;
+    struct pbuf *p;
+    uint32       r;
+
+    if (datagrams == 0)
+    {
+        printf("usage: Bench_UdpDemux [datagrams]\n");
+        return EXIT_FAILURE;
+    }
+
+    memp_init();
+    pbuf_init();
+    HOSTSIM_LOCAL_IP(&Bench_netif.ip_addr);
+    HOSTSIM_NETMASK(&Bench_netif.netmask);
+    Bench_netif.flags = NETIF_FLAG_UP | NETIF_FLAG_BROADCAST;
+    p                 = Bench_buildDatagram();
+
+    Bench_hash.name    = "hash";
+    Bench_hash.create  = &udp_new;
+    Bench_hash.remove  = &udp_remove;
+    Bench_hash.bind    = &udp_bind;
+    Bench_hash.connect = &udp_connect;
+    Bench_hash.recv    = &udp_recv;
+    Bench_hash.input   = &udp_input;
+    Bench_list.name    = "list";
+    Bench_list.create  = &udp_list_new;
+    Bench_list.remove  = &udp_list_remove;
+    Bench_list.bind    = &udp_list_bind;
+    Bench_list.connect = &udp_list_connect;
+    Bench_list.recv    = &udp_list_recv;
+    Bench_list.input   = &udp_list_input;
+
+    printf("bench_udpdemux: %u datagrams per run, ns per datagram, %u buckets\n", datagrams, UDP_PCB_HASH_SIZE);
+    printf("%6s %8s %8s %8s\n", "pcbs", "hash", "list", "speedup");
+
+    for (r = 0; r < BENCH_RUNS; r++)
+    {
+        Bench_hash.ns[r] = Bench_run(&Bench_hash, p, Bench_pcbCounts[r], datagrams);
+        Bench_list.ns[r] = Bench_run(&Bench_list, p, Bench_pcbCounts[r], datagrams);
+        printf("%6u %8.1f %8.1f %7.1fx\n", Bench_pcbCounts[r], Bench_hash.ns[r], Bench_list.ns[r],
+            Bench_list.ns[r] / Bench_hash.ns[r]);
+    }
+
+    pbuf_free(p);
+
+    return EXIT_SUCCESS;
+}
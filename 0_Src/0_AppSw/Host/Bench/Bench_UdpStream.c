@@ -0,0 +1,162 @@
+/**
+ * \file Bench_UdpStream.c
+ * \brief Host benchmark: Ifx_UdpStream against udp_sendto_if() per payload size
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * For each payload size the same number of datagrams is sent once through the stack
+ * (pbuf_alloc, udp_sendto_if, copy into the TX buffer) and once with Ifx_UdpStream. The
+ * rates are printed next to the 100 Mbit/s line rate, which counts preamble, SFD, FCS
+ * and inter frame gap. The host numbers show the software cost per datagram only; the
+ * DMA and the MAC are modelled without timing.
+ */
+
+#include "HostSim.h"
+#include "Ifx_UdpStream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_DATAGRAMS     (200000U)
+#define BENCH_LOCAL_PORT    (5002U)
+#define BENCH_LINK_BPS      (100000000.0)
+#define BENCH_WIRE_OVERHEAD (8U + 4U + 12U)   /**< \brief preamble + SFD, FCS, inter frame gap */
+#define BENCH_MIN_FRAME     (60U)             /**< \brief without FCS */
+
+static const uint16 Bench_payloadSizes[] = {18, 64, 100, 256, 512, 1024, IFX_UDPSTREAM_MAX_PAYLOAD};
+
+static void Bench_fill(void *arg, uint8 *payload, uint16 length, uint32 sequence)
+{
+    (void)arg;
+    (void)length;
+    memcpy(payload, &sequence, sizeof(sequence));
+}
+
+
+static double Bench_lineRate(uint16 payloadSize)
+{
+    uint32 frame = __max(IFX_UDPSTREAM_HEADER_SIZE + payloadSize, BENCH_MIN_FRAME);
+    return BENCH_LINK_BPS / (8.0 * (frame + BENCH_WIRE_OVERHEAD));
+}
+
+
+static double Bench_rate(uint32 count, uint64 elapsed)
+{
+    return (double)count * 1e9 / (double)(elapsed ? elapsed : 1);
+}
+
+
+static uint64 Bench_sendto(udp_pcb_t *udp, ip_addr_t *addr, uint16 payloadSize)
+{
+    uint8  payload[IFX_UDPSTREAM_MAX_PAYLOAD];
+    uint64 start = HostSim_nowNs();
+    uint32 i;
+
+    memset(payload, 0x5A, sizeof(payload));
+
+    for (i = 0; i < BENCH_DATAGRAMS; i++)
+    {
+        pbuf_t *p = pbuf_alloc(PBUF_TRANSPORT, payloadSize, PBUF_RAM);
+
+        if (p != NULL)
+        {
+            Bench_fill(NULL, p->payload, payloadSize, i);
+            memcpy((uint8 *)p->payload + sizeof(i), payload, payloadSize - sizeof(i));
+            udp_sendto_if(udp, p, addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+            pbuf_free(p);
+        }
+    }
+
+    return HostSim_nowNs() - start;
+}
+
+
+static uint64 Bench_stream(ip_addr_t *addr, uint16 payloadSize)
+{
+    Ifx_UdpStream        stream;
+    Ifx_UdpStream_Config config;
+    uint32               sent = 0;
+    uint64               start;
+
+    Ifx_UdpStream_initConfig(&config, Ifx_Lwip_getNetIf());
+    config.remoteIp    = *addr;
+    config.remotePort  = HOSTSIM_PEER_UDP_PORT;
+    config.localPort   = BENCH_LOCAL_PORT + 1;
+    config.payloadSize = payloadSize;
+    config.fill        = &Bench_fill;
+    Ifx_UdpStream_init(&stream, &config);
+
+    start = HostSim_nowNs();
+
+    while (sent < BENCH_DATAGRAMS)
+    {
+        sent += Ifx_UdpStream_send(&stream, __min(BENCH_DATAGRAMS - sent, config.burstMax));
+    }
+
+    start = HostSim_nowNs() - start;
+    Ifx_UdpStream_deinit(&stream);
+
+    return start;
+}
+
+
+int main(void)
+{
+    udp_pcb_t         *udp;
+    ip_addr_t          addr;
+    HostSim_PeerStats *stats = HostSim_getPeerStats();
+    uint32             i;
+    int                result = EXIT_SUCCESS;
+
+    HostSim_init();
+    HOSTSIM_PEER_IP(&addr);
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("bench_udpstream: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    udp = udp_new();
+    udp_bind(udp, IP_ADDR_ANY, BENCH_LOCAL_PORT);
+
+    printf("bench_udpstream: %u datagrams per run, 100 Mbit/s line rate\n", BENCH_DATAGRAMS);
+    printf("%8s %12s %12s %12s %12s %9s %12s\n", "payload", "sendto/s", "sendto Mb/s", "stream/s", "stream Mb/s",
+        "speedup", "line rate/s");
+
+    for (i = 0; i < sizeof(Bench_payloadSizes) / sizeof(Bench_payloadSizes[0]); i++)
+    {
+        uint16 size = Bench_payloadSizes[i];
+        double sendto, stream;
+
+        HostSim_resetPeerStats();
+        sendto = Bench_rate(BENCH_DATAGRAMS, Bench_sendto(udp, &addr, size));
+        stream = Bench_rate(BENCH_DATAGRAMS, Bench_stream(&addr, size));
+
+        printf("%8u %12.0f %12.1f %12.0f %12.1f %8.2fx %12.0f\n", size,
+            sendto, sendto * size * 8 / 1e6, stream, stream * size * 8 / 1e6, stream / sendto, Bench_lineRate(size));
+
+        if ((stats->udpFrames != 2 * BENCH_DATAGRAMS) || (stats->badChecksum != 0))
+        {
+            printf("bench_udpstream: FAILED, peer received %u of %u datagrams, %u with a bad checksum\n",
+                stats->udpFrames, 2 * BENCH_DATAGRAMS, stats->badChecksum);
+            result = EXIT_FAILURE;
+        }
+    }
+
+    udp_remove(udp);
+
+    return result;
+}
@@ -0,0 +1,2260 @@
+/**
+ * \file Host_Main.c
+ * \brief Host (Linux) counterpart of core0_main: smoke and throughput run
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * Runs the same sequence as core0_main on the simulated descriptor ring: ARP resolution
+ * of 192.168.7.6, 100 byte UDP datagrams to port 5001 and UDP datagrams received from
+ * the peer. Returns non zero if one of the steps fails.
+ */
+
+#include "HostSim.h"
+#include "Ifx_UdpStream.h"
+#include "Ifx_LwipMc.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/ip_frag.h"
+#include "lwip/memp.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HOST_MAIN_TX_COUNT   (100000U)
+#define HOST_MAIN_RX_COUNT   (100000U)
+#define HOST_MAIN_LOCAL_PORT (5000U)
+#define HOST_MAIN_OVERRUN    (4U)
+#define HOST_MAIN_STREAM     (10000U)
+#define HOST_MAIN_FLOW       (100000U)
+#define HOST_MAIN_ARP_EXPIRY (600U)       /**< \brief etharp_tmr() calls, more than twice ARP_MAXAGE */
+#define HOST_MAIN_ARP_USE    (12U)        /**< \brief etharp_tmr() calls between two datagrams of a used entry */
+#define HOST_MAIN_STATIC_IP(addr) IP4_ADDR(addr, 192, 168, 7, 20)   /**< \brief Neighbour of a static ARP entry */
+#define HOST_MAIN_SW_PORT    (7U)
+#define HOST_MAIN_COALESCE   (4U)         /**< \brief Frames per RX interrupt, divides the RX descriptor count */
+#define HOST_MAIN_COALESCE_US (100U)
+#define HOST_MAIN_HOLD_PORT  (5004U)
+#define HOST_MAIN_HOLD       (PBUF_POOL_SIZE + 8U)  /**< \brief Small datagrams kept by the application, more than PBUF_POOL */
+#define HOST_MAIN_HOLD_LENGTH (32U)
+#define HOST_MAIN_CORE_ALLOCS (200000U)   /**< \brief pbuf_alloc/pbuf_free pairs per producer core */
+#define HOST_MAIN_CORE_RX    (10000U)     /**< \brief Frames received by CPU0 meanwhile */
+#define HOST_MAIN_FRAGS      (4U)         /**< \brief Fragments of a reassembled datagram */
+#define HOST_MAIN_FRAG_DATA  (1000U)      /**< \brief IP payload per fragment, a multiple of 8 */
+#define HOST_MAIN_FRAG_SEND  (4000U)      /**< \brief UDP payload of a sent datagram, three fragments */
+#define HOST_MAIN_FRAG_LARGE (16000U)     /**< \brief UDP payload of 11 fragments, 23 descriptors in place */
+#define HOST_MAIN_TCP_PORT   (5201U)
+#define HOST_MAIN_TCP_ISN    (0x20000000U)  /**< \brief Initial sequence number of the peer */
+#define HOST_MAIN_TCP_RECORD (300U)       /**< \brief Bytes per buffer of tcp_writev(), three below TCP_MSS */
+#define HOST_MAIN_TCP_SLICES (20U)        /**< \brief 1 byte buffers of the segment tcp_writev() appends to */
+#define HOST_MAIN_TCP_SMALL  (28U)        /**< \brief 100 byte segments of the SACK loss check: a duplicate ACK per hole + 2 */
+#define HOST_MAIN_TCP_LOST   (13U)        /**< \brief First segments of them lost, more than TCP_MAXRTX */
+#define HOST_MAIN_TIMER_MS   (5U)         /**< \brief Period of the periodic test timeout */
+#define HOST_MAIN_ONESHOT_MS (22U)        /**< \brief Delay of the one-shot test timeout */
+#define HOST_MAIN_MC_PORT    (5010U)      /**< \brief Channel port of CPU0, CPU2 uses the next one */
+#define HOST_MAIN_MC_COUNT   (2000U)      /**< \brief Datagrams echoed per application core */
+#define HOST_MAIN_MC_WINDOW  (4U)         /**< \brief Datagrams in flight per application core */
+#define HOST_MAIN_MC_LENGTH  (32U)        /**< \brief Payload, below IFX_LWIP_RX_COPYBREAK */
+#define HOST_MAIN_MC_ECHOES  (2U * HOST_MAIN_MC_WINDOW)
+
+static uint32 Host_Main_rxCount = 0;
+static uint64 Host_Main_rxBytes = 0;
+
+static uint32 Host_Main_lastSrcIp   = 0;
+static uint32 Host_Main_arpRequests = 0;    /**< \brief ARP requests on the wire, to any address */
+
+static void Host_Main_onFrame(void *context, const uint8 *frame, uint16 length)
+{
+    (void)context;
+
+    if ((length >= 34) && (frame[12] == 0x08) && (frame[13] == 0x00))
+    {
+        memcpy(&Host_Main_lastSrcIp, &frame[26], sizeof(Host_Main_lastSrcIp));
+    }
+    else if ((length >= 42) && (frame[12] == 0x08) && (frame[13] == 0x06) && (frame[21] == 1))
+    {
+        Host_Main_arpRequests++;
+    }
+}
+
+
+/** \brief Sends one datagram on a connected pcb and polls, as the main loop would */
+static err_t Host_Main_sendConnected(udp_pcb_t *pcb, const uint8 *payload, uint16 length)
+{
+    err_t   err = ERR_MEM;
+    pbuf_t *p   = pbuf_alloc(PBUF_TRANSPORT, length, PBUF_RAM);
+
+    if (p != NULL)
+    {
+        memcpy(p->payload, payload, length);
+        err = udp_send(pcb, p);
+        pbuf_free(p);
+    }
+
+    HostSim_poll();
+
+    return err;
+}
+
+
+static uint8  Host_Main_captured[IFXETH_RTX_BUFFER_SIZE];
+static uint16 Host_Main_capturedLength = 0;
+
+/** \brief Output of a netif without checksum offload: keeps a copy of the last IP packet */
+static err_t Host_Main_captureOutput(netif_t *netif, pbuf_t *p, const ip_addr_t *ipaddr)
+{
+    (void)netif;
+    (void)ipaddr;
+    Host_Main_capturedLength = pbuf_copy_partial(p, Host_Main_captured, sizeof(Host_Main_captured), 0);
+    return ERR_OK;
+}
+
+
+static err_t Host_Main_captureInit(netif_t *netif)
+{
+    netif->name[0] = 's';
+    netif->name[1] = 'w';
+    netif->output  = Host_Main_captureOutput;
+    netif->mtu     = 1500;
+    return ERR_OK;
+}
+
+
+/** \brief Passes a copy of the captured packet, source and destination swapped, to the netif */
+static void Host_Main_captureLoop(netif_t *netif, uint8 corrupt)
+{
+    uint8   swap[4];
+    pbuf_t *p = pbuf_alloc(PBUF_RAW, Host_Main_capturedLength, PBUF_RAM);
+
+    if (p != NULL)
+    {
+        /* swapping addresses and ports keeps both checksums valid */
+        memcpy(p->payload, Host_Main_captured, Host_Main_capturedLength);
+        memcpy(swap, (uint8 *)p->payload + 12, 4);
+        memcpy((uint8 *)p->payload + 12, (uint8 *)p->payload + 16, 4);
+        memcpy((uint8 *)p->payload + 16, swap, 4);
+        memcpy(swap, (uint8 *)p->payload + IP_HLEN, 2);
+        memcpy((uint8 *)p->payload + IP_HLEN, (uint8 *)p->payload + IP_HLEN + 2, 2);
+        memcpy((uint8 *)p->payload + IP_HLEN + 2, swap, 2);
+        ((uint8 *)p->payload)[Host_Main_capturedLength - 1] ^= corrupt;
+        netif->input(p, netif);
+    }
+}
+
+
+static uint32 Host_Main_timeouts[2];
+
+static void Host_Main_onTimeout(void *arg)
+{
+    Host_Main_timeouts[(uint32)(uintptr_t)arg]++;
+}
+
+
+static void Host_Main_onReceive(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    (void)arg;
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    Host_Main_rxCount++;
+    Host_Main_rxBytes += p->tot_len;
+    pbuf_free(p);
+}
+
+
+static uint32 Host_Main_demuxed = 0;
+
+static void Host_Main_onDemux(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    (void)arg;
+    (void)pcb;
+    (void)addr;
+    (void)port;
+    Host_Main_demuxed++;
+    pbuf_free(p);
+}
+
+
+static pbuf_t *Host_Main_held[HOST_MAIN_HOLD];
+static uint32  Host_Main_heldCount = 0;
+
+/** \brief Keeps the received pbufs, as an application queueing requests would */
+static void Host_Main_onHold(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    (void)arg;
+    (void)pcb;
+    (void)addr;
+    (void)port;
+
+    if (Host_Main_heldCount < HOST_MAIN_HOLD)
+    {
+        Host_Main_held[Host_Main_heldCount++] = p;
+    }
+    else
+    {
+        pbuf_free(p);
+    }
+}
+
+
+/** \brief Data segments of the stack seen by the peer */
+typedef struct
+{
+    uint32  isn;            /**< \brief Initial sequence number of the stack, from its SYN */
+    uint16  localPort;
+    uint32  segments;
+    uint32  bytes;
+    uint8   lastFlags;
+    uint32  lastSeqno;      /**< \brief of the last data segment */
+    uint16  lastLength;     /**< \brief of the last data segment */
+    uint32  holes;          /**< \brief Data segments which don't follow the one before */
+    uint16  synWindow;      /**< \brief Window announced in the SYN */
+    uint16  window;         /**< \brief Last window announced by the stack */
+    boolean sackPermitted;  /**< \brief The SYN offered SACK */
+} Host_Main_TcpPeer;
+
+/** \brief TCP connection of a check, see Host_Main_tcpOpen() */
+typedef struct
+{
+    struct tcp_pcb   *pcb;
+    boolean           connected;    /**< \brief Set by the connected callback */
+    Host_Main_TcpPeer peer;
+    uint8             frame[IFXETH_RTX_BUFFER_SIZE];    /**< \brief Segment of the peer */
+} Host_Main_Tcp;
+
+/** \brief State shared by the checks of main() */
+typedef struct
+{
+    udp_pcb_t         *udp;         /**< \brief Bound to HOST_MAIN_LOCAL_PORT, counts the datagrams received */
+    udp_pcb_t         *flow;        /**< \brief Connected pcb of the UDP flow checks */
+    ip_addr_t          addr;        /**< \brief Address of the peer */
+    ip_addr_t          staticIp;    /**< \brief Neighbour of the static ARP entry */
+    HostSim_PeerStats *stats;
+    uint8              payload[100];
+    uint8              frame[IFXETH_RTX_BUFFER_SIZE];   /**< \brief Datagram of the peer to HOST_MAIN_LOCAL_PORT */
+    uint16             length;
+} Host_Main_Context;
+
+static void Host_Main_onTcpFrame(void *context, const uint8 *frame, uint16 length)
+{
+    Host_Main_TcpPeer *peer = context;
+    const uint8       *ip   = &frame[14];
+    const uint8       *tcp  = &ip[(ip[0] & 0x0FU) * 4U];
+    uint16             data;
+    uint16             i;
+
+    if ((length < (14 + 20 + 20)) || (ip[9] != IP_PROTO_TCP))
+    {
+        return;
+    }
+
+    peer->window = (uint16)((tcp[14] << 8) | tcp[15]);
+
+    if ((tcp[13] & TCP_SYN) != 0)
+    {
+        peer->isn       = ((uint32)tcp[4] << 24) | ((uint32)tcp[5] << 16) | ((uint32)tcp[6] << 8) | tcp[7];
+        peer->localPort = (uint16)((tcp[0] << 8) | tcp[1]);
+        peer->synWindow = peer->window;
+
+        for (i = 20; (i < ((tcp[12] >> 4) * 4U)) && (tcp[i] != 0); i += (tcp[i] == 1) ? 1U : __max(tcp[i + 1], 2U))
+        {
+            peer->sackPermitted = peer->sackPermitted || (tcp[i] == 4);
+        }
+
+        return;
+    }
+
+    data = (uint16)(((ip[2] << 8) | ip[3]) - (uint16)(tcp - ip) - ((tcp[12] >> 4) * 4U));
+
+    if (data > 0)
+    {
+        uint32 seqno = ((uint32)tcp[4] << 24) | ((uint32)tcp[5] << 16) | ((uint32)tcp[6] << 8) | tcp[7];
+
+        if ((peer->segments > 0) && (seqno != peer->lastSeqno + peer->lastLength))
+        {
+            peer->holes++;
+        }
+
+        peer->segments++;
+        peer->bytes     += data;
+        peer->lastFlags  = tcp[13];
+        peer->lastSeqno  = seqno;
+        peer->lastLength = data;
+    }
+}
+
+
+#if LWIP_TCP_WRITEV && LWIP_TCP_CORK
+static void Host_Main_onWritten(void *arg)
+{
+    (*(uint32 *)arg)++;
+}
+
+
+#endif
+
+static err_t Host_Main_onConnected(void *arg, struct tcp_pcb *pcb, err_t err)
+{
+    (void)pcb;
+    (void)err;
+    *(boolean *)arg = TRUE;
+
+    return ERR_OK;
+}
+
+
+#if LWIP_TCP_SACK && TCP_RTO_RFC6298
+/** \brief The stack freed the pcb */
+static void Host_Main_onTcpError(void *arg, err_t err)
+{
+    (void)err;
+    *(boolean *)arg = FALSE;
+}
+
+
+#endif
+
+/** \brief Writes a segment of the peer with TCP options after the MSS into the RX ring and polls */
+static void Host_Main_sendTcpOptions(Host_Main_Tcp *tcp, uint8 flags, uint32 ackno, const uint8 *options,
+                                     uint8 optionsLength)
+{
+    HostSim_TcpSegment segment;
+
+    segment.srcPort = HOST_MAIN_TCP_PORT;
+    segment.dstPort = tcp->peer.localPort;
+    segment.seqno   = HOST_MAIN_TCP_ISN + (((flags & TCP_SYN) != 0) ? 0U : 1U);
+    segment.ackno   = ackno;
+    segment.flags   = flags;
+    segment.window  = 4U * TCP_MSS;
+    segment.mss     = ((flags & TCP_SYN) != 0) ? TCP_MSS : 0U;
+
+    HostSim_inject(tcp->frame, HostSim_buildTcpFrameWithOptions(tcp->frame, &segment, options, optionsLength, NULL, 0));
+    HostSim_poll();
+}
+
+
+/** \brief Writes a segment of the peer into the RX ring and polls */
+static void Host_Main_sendTcp(Host_Main_Tcp *tcp, uint8 flags, uint32 ackno)
+{
+    Host_Main_sendTcpOptions(tcp, flags, ackno, NULL, 0);
+}
+
+
+/** \brief Connects a new pcb, Nagle disabled, to the peer, which answers the SYN with a SYN-ACK
+ * carrying the options after the MSS; the frame hook records the segments of the stack
+ * \return ERR_OK once the pcb is connected
+ */
+static err_t Host_Main_tcpOpen(Host_Main_Tcp *tcp, const uint8 *options, uint8 optionsLength)
+{
+    ip_addr_t addr;
+    err_t     err = ERR_MEM;
+
+    HOSTSIM_PEER_IP(&addr);
+    memset(&tcp->peer, 0, sizeof(tcp->peer));
+    tcp->connected = FALSE;
+    tcp->pcb       = tcp_new();
+    HostSim_setFrameHook(&Host_Main_onTcpFrame, &tcp->peer);
+
+    if (tcp->pcb != NULL)
+    {
+        tcp_arg(tcp->pcb, &tcp->connected);
+        tcp_nagle_disable(tcp->pcb);
+        err = tcp_connect(tcp->pcb, &addr, HOST_MAIN_TCP_PORT, &Host_Main_onConnected);
+    }
+
+    if (err == ERR_OK)
+    {
+        Host_Main_sendTcpOptions(tcp, TCP_SYN | TCP_ACK, tcp->peer.isn + 1U, options, optionsLength);
+        err = (tcp->connected != FALSE) ? ERR_OK : ERR_CONN;
+    }
+
+    return err;
+}
+
+
+/** \brief Aborts the connection of Host_Main_tcpOpen(), or closes the pcb which did not connect */
+static void Host_Main_tcpClose(Host_Main_Tcp *tcp)
+{
+    if (tcp->pcb != NULL)
+    {
+        if (tcp->connected != FALSE)
+        {
+            tcp_abort(tcp->pcb);
+        }
+        else
+        {
+            tcp_close(tcp->pcb);
+        }
+
+        tcp->pcb = NULL;
+    }
+
+    HostSim_setFrameHook(NULL, NULL);
+}
+
+
+/** \brief Sends the payload of the checks to addr through the UDP pcb of the checks */
+static err_t Host_Main_sendPayload(Host_Main_Context *ctx, ip_addr_t *addr)
+{
+    err_t   err = ERR_MEM;
+    pbuf_t *p   = pbuf_alloc(PBUF_TRANSPORT, sizeof(ctx->payload), PBUF_RAM);
+
+    if (p != NULL)
+    {
+        memcpy(p->payload, ctx->payload, sizeof(ctx->payload));
+        err = udp_sendto_if(ctx->udp, p, addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+        pbuf_free(p);
+    }
+
+    return err;
+}
+
+
+/** \brief Producer on CPU1 or CPU2: allocates and frees PBUF_POOL pbufs through its memp cache */
+static void *Host_Main_producer(void *arg)
+{
+    uint32 *failed = arg;
+    uint32  i;
+
+    IfxCpu_Host_setCoreId((failed[0] == 1) ? IfxCpu_Id_1 : IfxCpu_Id_2);
+    failed[1] = 0;
+
+    for (i = 0; i < HOST_MAIN_CORE_ALLOCS; i++)
+    {
+        pbuf_t *p = pbuf_alloc(PBUF_RAW, 64, PBUF_POOL);
+
+        if (p == NULL)
+        {
+            failed[1]++;
+        }
+        else
+        {
+            memset(p->payload, (int)i, 64);
+            pbuf_free(p);
+        }
+    }
+
+    memp_cache_flush();
+
+    return NULL;
+}
+
+
+/** \brief Application core of the multi-core check */
+typedef struct
+{
+    IfxCpu_Id           core;
+    uint16              port;
+    pbuf_type           type;           /**< \brief PBUF_POOL or PBUF_RAM, the pbufs of the datagrams sent */
+    Ifx_LwipMc_Channel *channel;
+    uint32              sent;
+    uint32              received;
+    uint32              misordered;     /**< \brief Echoes with an unexpected sequence number, port or length */
+    uint32              refused;        /**< \brief TX ring full or no pbuf, retried */
+    uint32              errors;
+} Host_Main_McApp;
+
+static volatile boolean Host_Main_mcRun = FALSE;
+static uint8            Host_Main_mcEcho[HOST_MAIN_MC_ECHOES][HOST_MAIN_MC_LENGTH];
+static uint16           Host_Main_mcEchoPort[HOST_MAIN_MC_ECHOES];
+static uint32           Host_Main_mcEchoCount = 0;
+static uint32           Host_Main_mcEchoLost  = 0;
+
+/** \brief Peer side of the multi-core check, keeps the datagrams of the channels to echo them */
+static void Host_Main_onMcFrame(void *context, const uint8 *frame, uint16 length)
+{
+    const uint8 *ip  = &frame[14];
+    const uint8 *udp = &ip[(ip[0] & 0x0FU) * 4U];
+    uint16       src;
+
+    (void)context;
+
+    if ((length < (14 + 20 + 8 + HOST_MAIN_MC_LENGTH)) || (frame[12] != 0x08) || (frame[13] != 0x00)
+        || (ip[9] != IP_PROTO_UDP))
+    {
+        return;
+    }
+
+    src = (uint16)((udp[0] << 8) | udp[1]);
+
+    if ((src != HOST_MAIN_MC_PORT) && (src != HOST_MAIN_MC_PORT + 1))
+    {
+        return;
+    }
+
+    if (Host_Main_mcEchoCount < HOST_MAIN_MC_ECHOES)
+    {
+        memcpy(Host_Main_mcEcho[Host_Main_mcEchoCount], &udp[8], HOST_MAIN_MC_LENGTH);
+        Host_Main_mcEchoPort[Host_Main_mcEchoCount] = src;
+        Host_Main_mcEchoCount++;
+    }
+    else
+    {
+        Host_Main_mcEchoLost++;
+    }
+}
+
+
+/** \brief CPU1: runs lwIP and the channels, the peer echoes the datagrams it received */
+static void *Host_Main_mcStack(void *arg)
+{
+    uint8  frame[IFXETH_RTX_BUFFER_SIZE];
+    uint32 i;
+
+    (void)arg;
+    IfxCpu_Host_setCoreId(IfxCpu_Id_1);
+
+    while (Host_Main_mcRun)
+    {
+        HostSim_poll();
+        Ifx_LwipMc_poll();
+
+        for (i = 0; i < Host_Main_mcEchoCount; i++)
+        {
+            uint16 length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, Host_Main_mcEchoPort[i],
+                Host_Main_mcEcho[i], HOST_MAIN_MC_LENGTH);
+
+            if (HostSim_inject(frame, length) == FALSE)
+            {
+                break;
+            }
+        }
+
+        /* the echoes which didn't fit into the RX ring are injected after the next poll */
+        memmove(Host_Main_mcEcho, Host_Main_mcEcho[i], (Host_Main_mcEchoCount - i) * HOST_MAIN_MC_LENGTH);
+        memmove(Host_Main_mcEchoPort, &Host_Main_mcEchoPort[i], (Host_Main_mcEchoCount - i) * sizeof(uint16));
+        Host_Main_mcEchoCount -= i;
+
+        if (Host_Main_mcEchoCount == 0)
+        {
+            sched_yield();
+        }
+    }
+
+    memp_cache_flush();
+
+    return NULL;
+}
+
+
+/** \brief CPU0 or CPU2: sends sequenced datagrams through its channel and checks their echoes */
+static void *Host_Main_mcApp(void *arg)
+{
+    Host_Main_McApp *app      = arg;
+    uint64           deadline = HostSim_nowNs() + 10000000000ULL;
+    ip_addr_t        peer;
+    uint16           port;
+    pbuf_t          *p;
+
+    IfxCpu_Host_setCoreId(app->core);
+    HOSTSIM_PEER_IP(&peer);
+
+    while ((Ifx_LwipMc_getState(app->channel) == Ifx_LwipMc_State_opening) && (HostSim_nowNs() < deadline))
+    {
+        sched_yield();
+    }
+
+    while ((app->received < HOST_MAIN_MC_COUNT) && (HostSim_nowNs() < deadline))
+    {
+        if ((app->sent < HOST_MAIN_MC_COUNT) && ((app->sent - app->received) < HOST_MAIN_MC_WINDOW))
+        {
+            p = pbuf_alloc(PBUF_TRANSPORT, HOST_MAIN_MC_LENGTH, app->type);
+
+            if (p == NULL)
+            {
+                app->refused++;
+            }
+            else
+            {
+                err_t err;
+
+                memset(p->payload, (int)app->core, HOST_MAIN_MC_LENGTH);
+                memcpy(p->payload, &app->sent, sizeof(app->sent));
+                err = Ifx_LwipMc_send(app->channel, p, &peer, HOSTSIM_PEER_UDP_PORT);
+
+                if (err == ERR_OK)
+                {
+                    app->sent++;
+                }
+                else
+                {
+                    if (err == ERR_MEM)
+                    {
+                        app->refused++;
+                    }
+                    else
+                    {
+                        app->errors++;
+                    }
+
+                    pbuf_free(p);
+                }
+            }
+        }
+
+        while ((p = Ifx_LwipMc_receive(app->channel, NULL_PTR, &port)) != NULL)
+        {
+            uint32 sequence;
+
+            memcpy(&sequence, p->payload, sizeof(sequence));
+
+            if ((sequence != app->received) || (port != HOSTSIM_PEER_UDP_PORT) || (p->tot_len != HOST_MAIN_MC_LENGTH))
+            {
+                app->misordered++;
+            }
+
+            app->received++;
+            pbuf_free(p);
+        }
+
+        sched_yield();
+    }
+
+    Ifx_LwipMc_close(app->channel);
+    memp_cache_flush();
+
+    return NULL;
+}
+
+
+/** \brief ARP entries of the configuration: the static entry is in the table, the peer was
+ * requested at init and the multicast entry was refused */
+static boolean Host_Main_testArpEntries(Host_Main_Context *ctx, const Ifx_Lwip_ArpEntry *entries)
+{
+    struct eth_addr *ethRet;
+    ip_addr_t       *ipRet;
+
+    if ((ctx->stats->arpRequests != 1) || (etharp_find_addr(Ifx_Lwip_getNetIf(), &ctx->staticIp, &ethRet, &ipRet) < 0)
+        || (eth_addr_cmp(ethRet, &entries[0].ethAddr) == 0) || (Ifx_Lwip_get()->arpFailed != 1))
+    {
+        printf("host_main: FAILED, ARP entries of the configuration, %u requests at init, %u refused\n",
+            ctx->stats->arpRequests, Ifx_Lwip_get()->arpFailed);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief Transmit, the peer checks the checksums */
+static boolean Host_Main_testTransmit(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats = ctx->stats;
+    uint64             start, elapsed;
+    uint32             i;
+
+    HostSim_resetPeerStats();
+    start = HostSim_nowNs();
+
+    for (i = 0; i < HOST_MAIN_TX_COUNT; i++)
+    {
+        Host_Main_sendPayload(ctx, &ctx->addr);
+        HostSim_poll();
+    }
+
+    elapsed = HostSim_nowNs() - start;
+    printf("host_main: tx %u datagrams, %llu payload bytes, %.0f frames/s\n",
+        stats->udpFrames, (unsigned long long)stats->udpBytes,
+        (double)stats->udpFrames * 1e9 / (double)(elapsed ? elapsed : 1));
+
+    if ((stats->udpFrames != HOST_MAIN_TX_COUNT) || (stats->badChecksum != 0))
+    {
+        printf("host_main: FAILED, peer received %u of %u datagrams, %u with a bad checksum\n",
+            stats->udpFrames, HOST_MAIN_TX_COUNT, stats->badChecksum);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief TX ring full: the DMA is stopped, the driver must not wait for it */
+static boolean Host_Main_testRingFull(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats    = ctx->stats;
+    IfxEth            *eth      = Ifx_Lwip_getNetIf()->state;
+    uint32             ring     = IfxEth_getTxDescriptorCount(eth);
+    uint32             accepted = 0;
+    uint32             blocked  = 0;
+    uint32             i;
+
+    IfxEth_Host_setTxAutoProcess(eth, FALSE);
+    HostSim_resetPeerStats();
+
+    for (i = 0; i < ring + HOST_MAIN_OVERRUN; i++)
+    {
+        if (Host_Main_sendPayload(ctx, &ctx->addr) == ERR_OK)
+        {
+            accepted++;
+        }
+        else
+        {
+            blocked++;
+        }
+    }
+
+    IfxEth_Host_setTxAutoProcess(eth, TRUE);
+    IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+    HostSim_poll();
+    printf("host_main: ring full, %u queued, %u rejected, %u on the wire\n", accepted, blocked, stats->udpFrames);
+
+    if ((accepted != ring) || (blocked != HOST_MAIN_OVERRUN) || (stats->udpFrames != accepted)
+        || (stats->badChecksum != 0))
+    {
+        printf("host_main: FAILED, TX ring full handling\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief Streaming into the TX buffers, the peer checks the checksums */
+static boolean Host_Main_testStream(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats   *stats = ctx->stats;
+    Ifx_UdpStream        stream;
+    Ifx_UdpStream_Config config;
+    uint32               sent  = 0;
+    uint64               start, elapsed;
+    boolean              ok    = TRUE;
+
+    Ifx_UdpStream_initConfig(&config, Ifx_Lwip_getNetIf());
+    config.remoteIp    = ctx->addr;
+    config.remotePort  = HOSTSIM_PEER_UDP_PORT;
+    config.localPort   = HOST_MAIN_LOCAL_PORT + 1;
+    config.payloadSize = sizeof(ctx->payload);
+    HostSim_resetPeerStats();
+
+    if (Ifx_UdpStream_init(&stream, &config) != ERR_OK)
+    {
+        printf("host_main: FAILED, Ifx_UdpStream_init\n");
+        return FALSE;
+    }
+
+    start = HostSim_nowNs();
+
+    while (sent < HOST_MAIN_STREAM)
+    {
+        sent += Ifx_UdpStream_send(&stream, __min(HOST_MAIN_STREAM - sent, config.burstMax));
+    }
+
+    elapsed = HostSim_nowNs() - start;
+    HostSim_poll();
+    printf("host_main: stream %u datagrams, %.0f frames/s\n", stats->udpFrames,
+        (double)stats->udpFrames * 1e9 / (double)(elapsed ? elapsed : 1));
+
+    if ((stats->udpFrames != HOST_MAIN_STREAM) || (stats->badChecksum != 0) || (stream.stats.unresolved != 0))
+    {
+        printf("host_main: FAILED, stream %u of %u datagrams, %u with a bad checksum\n",
+            stats->udpFrames, HOST_MAIN_STREAM, stats->badChecksum);
+        ok = FALSE;
+    }
+
+    Ifx_UdpStream_deinit(&stream);
+
+    return ok;
+}
+
+
+/** \brief Connected pcb: the headers are cached */
+static boolean Host_Main_testConnected(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats = ctx->stats;
+    udp_pcb_t         *flow  = ctx->flow;
+    uint32             lost  = 0;
+    uint64             start, elapsed;
+    uint32             i;
+
+    HostSim_resetPeerStats();
+    start = HostSim_nowNs();
+
+    for (i = 0; i < HOST_MAIN_FLOW; i++)
+    {
+        lost += (Host_Main_sendConnected(flow, ctx->payload, sizeof(ctx->payload)) != ERR_OK);
+    }
+
+    elapsed = HostSim_nowNs() - start;
+    printf("host_main: connected %u datagrams, %.0f frames/s, headers %s\n", stats->udpFrames,
+        (double)stats->udpFrames * 1e9 / (double)(elapsed ? elapsed : 1),
+        (flow->flow.netif != NULL) ? "cached" : "not cached");
+
+    if ((flow->flow.netif == NULL) || (stats->udpFrames != HOST_MAIN_FLOW) || (stats->badChecksum != 0) || (lost != 0))
+    {
+        printf("host_main: FAILED, connected pcb fast path\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief A used ARP entry is refreshed before it expires, unicast to the peer: a datagram
+ * every minute never waits for the address resolution */
+static boolean Host_Main_testArpRefresh(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats = ctx->stats;
+    uint32             lost  = 0;
+    uint32             i;
+
+    HostSim_resetPeerStats();
+    memset(&etharp_resolve_stats, 0, sizeof(etharp_resolve_stats));
+
+    for (i = 0; i < HOST_MAIN_ARP_EXPIRY; i++)
+    {
+        etharp_tmr();
+        HostSim_poll();
+
+        if ((i % HOST_MAIN_ARP_USE) == 0)
+        {
+            lost += (Host_Main_sendConnected(ctx->flow, ctx->payload, sizeof(ctx->payload)) != ERR_OK);
+        }
+    }
+
+    printf("host_main: ARP refresh, %u requests (%u unicast), %u delayed, %u dropped\n", stats->arpRequests,
+        stats->arpUnicast, etharp_resolve_stats.delayed, etharp_resolve_stats.dropped);
+
+    if ((etharp_resolve_stats.refreshes < 2) || (stats->arpUnicast != etharp_resolve_stats.refreshes) ||
+        (etharp_resolve_stats.delayed != 0) || (etharp_resolve_stats.dropped != 0) ||
+        (stats->udpFrames != (HOST_MAIN_ARP_EXPIRY + HOST_MAIN_ARP_USE - 1) / HOST_MAIN_ARP_USE) || (lost != 0))
+    {
+        printf("host_main: FAILED, ARP refresh of a used entry\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief The ARP entry expires without traffic, after one last refresh for the datagrams of
+ * Host_Main_testArpRefresh(): the next datagram waits for the resolution */
+static boolean Host_Main_testArpExpiry(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats = ctx->stats;
+    uint32             i;
+
+    for (i = 0; i < HOST_MAIN_ARP_EXPIRY; i++)
+    {
+        etharp_tmr();
+        HostSim_poll();
+    }
+
+    HostSim_resetPeerStats();
+    memset(&etharp_resolve_stats, 0, sizeof(etharp_resolve_stats));
+    Host_Main_sendConnected(ctx->flow, ctx->payload, sizeof(ctx->payload));
+    Host_Main_sendConnected(ctx->flow, ctx->payload, sizeof(ctx->payload));
+
+    if ((stats->arpRequests != 1) || (stats->udpFrames != 2) || (ctx->flow->flow.netif == NULL) ||
+        (etharp_resolve_stats.delayed != 1))
+    {
+        printf("host_main: FAILED, ARP expiry, %u requests, %u datagrams, %u delayed\n", stats->arpRequests,
+            stats->udpFrames, etharp_resolve_stats.delayed);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief The static entry did not age meanwhile: a datagram to it is sent without a request */
+static boolean Host_Main_testStaticArp(Host_Main_Context *ctx)
+{
+    HostSim_PeerStats *stats = ctx->stats;
+    struct eth_addr   *ethRet;
+    ip_addr_t         *ipRet;
+
+    HostSim_resetPeerStats();
+    Host_Main_arpRequests = 0;
+    Host_Main_sendPayload(ctx, &ctx->staticIp);
+    HostSim_poll();
+
+    if ((Host_Main_arpRequests != 0) || (stats->udpFrames != 1) ||
+        (etharp_find_addr(Ifx_Lwip_getNetIf(), &ctx->staticIp, &ethRet, &ipRet) < 0))
+    {
+        printf("host_main: FAILED, static ARP entry, %u requests, %u datagrams\n", Host_Main_arpRequests,
+            stats->udpFrames);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief The source address of the cached header follows the interface address */
+static boolean Host_Main_testAddressChange(Host_Main_Context *ctx)
+{
+    ip_addr_t localIp, otherIp;
+    boolean   ok;
+
+    localIp = Ifx_Lwip_getNetIf()->ip_addr;
+    IP4_ADDR(&otherIp, 192, 168, 7, 124);
+    netif_set_ipaddr(Ifx_Lwip_getNetIf(), &otherIp);
+    Host_Main_sendConnected(ctx->flow, ctx->payload, sizeof(ctx->payload));
+    ok = (Host_Main_lastSrcIp == ip4_addr_get_u32(&otherIp));
+    netif_set_ipaddr(Ifx_Lwip_getNetIf(), &localIp);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, address change not applied to the cached header\n");
+    }
+
+    return ok;
+}
+
+
+/** \brief Receive demultiplexing: the connected pcb only takes the datagrams of its peer,
+ * after udp_disconnect() those of any source port */
+static boolean Host_Main_testUdpDemux(Host_Main_Context *ctx)
+{
+    uint8  frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16 length;
+
+    udp_recv(ctx->flow, &Host_Main_onDemux, NULL);
+    length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_LOCAL_PORT + 2, ctx->payload,
+        sizeof(ctx->payload));
+    HostSim_inject(frame, length);
+    HostSim_poll();
+    length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT + 1, HOST_MAIN_LOCAL_PORT + 2, ctx->payload,
+        sizeof(ctx->payload));
+    HostSim_inject(frame, length);
+    HostSim_poll();
+    udp_disconnect(ctx->flow);
+    HostSim_inject(frame, length);
+    HostSim_poll();
+
+    if (Host_Main_demuxed != 2)
+    {
+        printf("host_main: FAILED, udp demultiplexing, %u of 2 datagrams\n", Host_Main_demuxed);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief Receive */
+static boolean Host_Main_testReceive(Host_Main_Context *ctx)
+{
+    uint64 start, elapsed;
+    uint32 i;
+
+    start = HostSim_nowNs();
+
+    for (i = 0; i < HOST_MAIN_RX_COUNT; i++)
+    {
+        HostSim_inject(ctx->frame, ctx->length);
+        HostSim_poll();
+    }
+
+    elapsed = HostSim_nowNs() - start;
+    printf("host_main: rx %u datagrams, %llu payload bytes, %.0f frames/s, %u dropped by the ring\n",
+        Host_Main_rxCount, (unsigned long long)Host_Main_rxBytes,
+        (double)Host_Main_rxCount * 1e9 / (double)(elapsed ? elapsed : 1), ctx->stats->injectDropped);
+
+    if (Host_Main_rxCount != HOST_MAIN_RX_COUNT)
+    {
+        printf("host_main: FAILED, received %u of %u datagrams\n", Host_Main_rxCount, HOST_MAIN_RX_COUNT);
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief Burst larger than the RX ring: one poll drains the ring, the excess is an overrun */
+static boolean Host_Main_testBurstDrain(Host_Main_Context *ctx)
+{
+    Ifx_Lwip *lwip     = Ifx_Lwip_get();
+    uint32    received = Host_Main_rxCount;
+    uint32    missed   = lwip->rx.missed;
+    uint32    ring     = IfxEth_getRxDescriptorCount(Ifx_Lwip_getEth());
+    uint32    drained;
+    boolean   pending;
+    uint32    i;
+
+    for (i = 0; i < ring + HOST_MAIN_OVERRUN; i++)
+    {
+        HostSim_inject(ctx->frame, ctx->length);
+    }
+
+    drained = Ifx_Lwip_pollReceive(IFX_LWIP_RX_BUDGET, &pending);
+    printf("host_main: burst of %u frames, %u drained in one poll, %u overruns, pending=%u\n",
+        ring + HOST_MAIN_OVERRUN, drained, lwip->rx.missed - missed, pending);
+
+    if ((Host_Main_rxCount - received != ring) || (lwip->rx.missed - missed != HOST_MAIN_OVERRUN)
+        || (pending != FALSE))
+    {
+        printf("host_main: FAILED, burst drain\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#if IFX_LWIP_RX_COPYBREAK
+/** \brief A frame the driver drops does not end the poll: with PBUF_POOL used up, the frame of
+ * full size is dropped and the small frames behind it are delivered through the copy-break */
+static boolean Host_Main_testDropDrain(Host_Main_Context *ctx)
+{
+    static pbuf_t                  *pool[PBUF_POOL_SIZE];
+    Ifx_Lwip                       *lwip      = Ifx_Lwip_get();
+    struct ethernetif_tc2x_rxstats *rxstats   = ethernetif_tc2x_getRxStats();
+    uint32                          poolEmpty = rxstats->pool_empty;
+    uint32                          dropped   = lwip->rx.dropped;
+    uint32                          received  = Host_Main_rxCount;
+    uint32                          count     = 0;
+    uint8                           frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16                          length;
+    uint32                          drained;
+    boolean                         pending;
+    uint32                          i;
+
+    while ((count < PBUF_POOL_SIZE) && ((pool[count] = pbuf_alloc(PBUF_RAW, PBUF_POOL_BUFSIZE, PBUF_POOL)) != NULL))
+    {
+        count++;
+    }
+
+    length = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_LOCAL_PORT, ctx->payload,
+        HOST_MAIN_HOLD_LENGTH);
+    HostSim_inject(ctx->frame, ctx->length);
+
+    for (i = 0; i < HOST_MAIN_OVERRUN; i++)
+    {
+        HostSim_inject(frame, length);
+    }
+
+    drained = Ifx_Lwip_pollReceive(IFX_LWIP_RX_BUDGET, &pending);
+
+    while (count > 0)
+    {
+        pbuf_free(pool[--count]);
+    }
+
+    printf("host_main: %u frames with PBUF_POOL used up, %u drained in one poll, %u dropped, pending=%u\n",
+        HOST_MAIN_OVERRUN + 1, drained, lwip->rx.dropped - dropped, pending);
+
+    if ((IFX_LWIP_RX_COPYBREAK >= length) && ((drained != HOST_MAIN_OVERRUN)
+        || (Host_Main_rxCount - received != HOST_MAIN_OVERRUN) || (lwip->rx.dropped - dropped != 1)
+        || (rxstats->pool_empty - poolEmpty != 1) || (pending != FALSE)))
+    {
+        printf("host_main: FAILED, RX drain past a dropped frame\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+#if IP_REASSEMBLY
+/** \brief Fragmented datagrams: one arrives in reverse order with a duplicate, the next one
+ * misses a fragment and times out with an ICMP time exceeded to the peer */
+static boolean Host_Main_testReassembly(Host_Main_Context *ctx)
+{
+    static uint8          datagram[14U + IP_HLEN + HOST_MAIN_FRAGS * HOST_MAIN_FRAG_DATA];
+    static uint8          data[HOST_MAIN_FRAGS * HOST_MAIN_FRAG_DATA];
+    HostSim_PeerStats    *stats      = ctx->stats;
+    uint8                 frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16                length;
+    uint16                dataLength = HOST_MAIN_FRAGS * HOST_MAIN_FRAG_DATA - UDP_HLEN;
+    uint32                received   = Host_Main_rxCount;
+    uint64                bytes      = Host_Main_rxBytes;
+    struct ip_reass_stats before     = ip_reass_stats;
+    uint32                i;
+
+    memset(data, 0x3C, sizeof(data));
+    HostSim_resetPeerStats();
+    HostSim_buildUdpFrame(datagram, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_LOCAL_PORT, data, dataLength);
+
+    for (i = HOST_MAIN_FRAGS; i-- > 0;)
+    {
+        length = HostSim_buildFragment(frame, datagram, (uint16)(i * HOST_MAIN_FRAG_DATA), HOST_MAIN_FRAG_DATA,
+            (i + 1) < HOST_MAIN_FRAGS);
+        HostSim_inject(frame, length);
+
+        if (i == 2)
+        {
+            HostSim_inject(frame, length);
+        }
+
+        HostSim_poll();
+    }
+
+    HostSim_buildUdpFrame(datagram, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_LOCAL_PORT, data, dataLength);
+
+    for (i = 0; i < HOST_MAIN_FRAGS; i++)
+    {
+        length = HostSim_buildFragment(frame, datagram, (uint16)(i * HOST_MAIN_FRAG_DATA), HOST_MAIN_FRAG_DATA,
+            (i + 1) < HOST_MAIN_FRAGS);
+        if (i != 1)
+        {
+            HostSim_inject(frame, length);
+            HostSim_poll();
+        }
+    }
+
+    for (i = 0; i <= IP_REASS_MAXAGE; i++)
+    {
+        ip_reass_tmr();
+    }
+
+    HostSim_poll();
+    printf("host_main: reassembled %u of 2 datagrams, %u duplicate fragment, %u timed out, %u ICMP\n",
+        Host_Main_rxCount - received, ip_reass_stats.duplicates - before.duplicates,
+        ip_reass_stats.timeouts - before.timeouts, stats->icmpFrames);
+
+    if ((Host_Main_rxCount - received != 1) || (Host_Main_rxBytes - bytes != dataLength) ||
+        (ip_reass_stats.duplicates - before.duplicates != 1) || (ip_reass_stats.timeouts - before.timeouts != 1) ||
+        (stats->icmpFrames != 1) || (stats->badChecksum != 0))
+    {
+        printf("host_main: FAILED, IP reassembly\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+#if IP_FRAG
+/** \brief Fragmentation: the fragments of a RAM + ROM chain reference it and are sent in place,
+ * the chain is left intact; PBUF_REF data is copied into the fragments */
+static boolean Host_Main_testFragmentation(Host_Main_Context *ctx)
+{
+    static uint8                    data[HOST_MAIN_FRAG_SEND];
+    HostSim_PeerStats              *stats   = ctx->stats;
+    struct ethernetif_tc2x_txstats *txstats = ethernetif_tc2x_getTxStats();
+    struct ethernetif_tc2x_txstats  before  = *txstats;
+    uint16                          piece   = HOST_MAIN_FRAG_SEND / 4U;
+    pbuf_t                         *chain   = pbuf_alloc(PBUF_TRANSPORT, piece, PBUF_RAM);
+    pbuf_t                         *rom     = pbuf_alloc(PBUF_RAW, 3U * piece / 2U, PBUF_ROM);
+    pbuf_t                         *rom2    = pbuf_alloc(PBUF_RAW, 3U * piece / 2U, PBUF_ROM);
+    pbuf_t                         *q;
+    uint32                          chained = 0;
+    err_t                           err     = ERR_MEM;
+
+    memset(data, 0xA5, sizeof(data));
+    HostSim_resetPeerStats();
+
+    if ((chain != NULL) && (rom != NULL) && (rom2 != NULL))
+    {
+        memcpy(chain->payload, data, piece);
+        rom->payload  = &data[piece];
+        rom2->payload = &data[piece + rom->len];
+        pbuf_cat(chain, rom);
+        pbuf_cat(chain, rom2);
+        rom  = NULL;
+        rom2 = NULL;
+        err  = udp_sendto_if(ctx->udp, chain, &ctx->addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+
+        for (q = chain; q != NULL; q = q->next)
+        {
+            chained += q->len;
+        }
+
+        chained = (chained == chain->tot_len) && (chain->tot_len == sizeof(data) + UDP_HLEN + IP_HLEN);
+    }
+
+    if (chain != NULL)
+    {
+        pbuf_free(chain);
+    }
+
+    if (rom != NULL)
+    {
+        pbuf_free(rom);
+    }
+
+    if (rom2 != NULL)
+    {
+        pbuf_free(rom2);
+    }
+
+    q = pbuf_alloc(PBUF_TRANSPORT, sizeof(data), PBUF_REF);
+
+    if ((err == ERR_OK) && (q != NULL))
+    {
+        q->payload = data;
+        err        = udp_sendto_if(ctx->udp, q, &ctx->addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+        pbuf_free(q);
+    }
+
+    HostSim_poll();
+    printf("host_main: fragmented 2 datagrams into %u frames, %u sent in place, %u copied\n",
+        stats->udpFrames, txstats->zero_copy - before.zero_copy, txstats->copied - before.copied);
+
+    if ((err != ERR_OK) || (chained == 0) || (stats->udpFrames != 6) || (stats->badChecksum != 0) ||
+        (txstats->zero_copy - before.zero_copy != 6) || (txstats->copied != before.copied))
+    {
+        printf("host_main: FAILED, IP fragmentation\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief A datagram of more fragments than the TX ring takes in place: the first fragments are
+ * sent in place, the others are copied into the buffer of one descriptor each, so all of them
+ * are queued while the DMA is stalled */
+static boolean Host_Main_testFragmentsBeyondRing(Host_Main_Context *ctx)
+{
+    static uint8                    data[HOST_MAIN_FRAG_LARGE];
+    HostSim_PeerStats              *stats   = ctx->stats;
+    IfxEth                         *eth     = Ifx_Lwip_getNetIf()->state;
+    struct ethernetif_tc2x_txstats *txstats = ethernetif_tc2x_getTxStats();
+    struct ethernetif_tc2x_txstats  before  = *txstats;
+    pbuf_t                         *rom     = pbuf_alloc(PBUF_RAW, sizeof(data), PBUF_ROM);
+    err_t                           err     = ERR_MEM;
+
+    memset(data, 0x3C, sizeof(data));
+    HostSim_resetPeerStats();
+    IfxEth_Host_setTxAutoProcess(eth, FALSE);
+
+    if (rom != NULL)
+    {
+        rom->payload = data;
+        err          = udp_sendto_if(ctx->udp, rom, &ctx->addr, HOSTSIM_PEER_UDP_PORT, Ifx_Lwip_getNetIf());
+        pbuf_free(rom);
+    }
+
+    IfxEth_Host_setTxAutoProcess(eth, TRUE);
+    IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+    HostSim_poll();
+    printf("host_main: fragmented %u byte datagram into %u frames, %u sent in place, %u copied, %u ring full\n",
+        HOST_MAIN_FRAG_LARGE, stats->udpFrames, txstats->zero_copy - before.zero_copy,
+        txstats->copied - before.copied, txstats->ring_full - before.ring_full);
+
+    /* the 7 copies take one descriptor each, the 4 fragments in place share the rest of the ring */
+    if ((err != ERR_OK) || (stats->udpFrames != 11) || (stats->badChecksum != 0) ||
+        (txstats->zero_copy - before.zero_copy != 4) || (txstats->copied - before.copied != 7) ||
+        (txstats->ring_full != before.ring_full))
+    {
+        printf("host_main: FAILED, fragments beyond the TX ring\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+#if LWIP_TCP_WRITEV && LWIP_TCP_CORK
+/** \brief tcp_writev() on a corked pcb: three buffers below the MSS are held back, tcp_flush()
+ * sends them in one segment without copying and the callback follows the ACK */
+static boolean Host_Main_testTcpWritev(Host_Main_Context *ctx)
+{
+    static uint8     data[3][HOST_MAIN_TCP_RECORD];
+    struct tcp_iovec iov[3];
+    Host_Main_Tcp    tcp;
+    uint32           done      = 0;
+    uint32           held      = 0;
+    uint32           beforeAck = 0;
+    err_t            err;
+    uint32           i;
+
+    HostSim_resetPeerStats();
+    err = Host_Main_tcpOpen(&tcp, NULL, 0);
+
+    if (err == ERR_OK)
+    {
+        tcp_cork(tcp.pcb);
+
+        for (i = 0; i < 3; i++)
+        {
+            memset(data[i], (int)(0x30 + i), sizeof(data[i]));
+            iov[i].base = data[i];
+            iov[i].len  = sizeof(data[i]);
+        }
+
+        err  = tcp_writev(tcp.pcb, iov, 3, &Host_Main_onWritten, &done, 0);
+        HostSim_poll();
+        held = tcp.peer.segments;
+    }
+
+    if (err == ERR_OK)
+    {
+        err = tcp_flush(tcp.pcb);
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+        beforeAck = done;
+        Host_Main_sendTcp(&tcp, TCP_ACK, tcp.peer.isn + 1U + sizeof(data));
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+
+    Host_Main_tcpClose(&tcp);
+    printf("host_main: tcp_writev of 3 buffers corked, %u segments before and %u after tcp_flush, "
+           "%u completions before and %u after the ACK\n", held, tcp.peer.segments, beforeAck, done);
+
+    if ((err != ERR_OK) || (held != 0) || (tcp.peer.segments != 1) || (tcp.peer.bytes != sizeof(data)) ||
+        ((tcp.peer.lastFlags & TCP_PSH) == 0) || (beforeAck != 0) || (done != 1) || (ctx->stats->badChecksum != 0))
+    {
+        printf("host_main: FAILED, tcp_writev\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief tcp_writev() which only fills the last unsent segment: its pbufs are counted against
+ * TCP_SND_QUEUELEN as those of a new segment, the call fails without queueing anything */
+static boolean Host_Main_testTcpWritevQueueLength(void)
+{
+    static uint8     data[TCP_SND_QUEUELEN];
+    struct tcp_iovec iov[TCP_SND_QUEUELEN];
+    Host_Main_Tcp    tcp;
+    uint16           queued    = 0;
+    uint16           slices    = 0;
+    uint32           done      = 0;
+    err_t            err;
+    err_t            writevErr = ERR_OK;
+    boolean          ok;
+    uint32           i;
+
+    for (i = 0; i < TCP_SND_QUEUELEN; i++)
+    {
+        iov[i].base = &data[i];
+        iov[i].len  = 1;
+    }
+
+    err = Host_Main_tcpOpen(&tcp, NULL, 0);
+
+    if (err == ERR_OK)
+    {
+        /* one segment of a header and HOST_MAIN_TCP_SLICES data pbufs */
+        tcp_cork(tcp.pcb);
+        err    = tcp_writev(tcp.pcb, iov, HOST_MAIN_TCP_SLICES, NULL, NULL, 0);
+        queued = tcp.pcb->snd_queuelen;
+        slices = memp_num_free(MEMP_TCP_WRITEV_PBUF);
+    }
+
+    if (err == ERR_OK)
+    {
+        writevErr = tcp_writev(tcp.pcb, &iov[HOST_MAIN_TCP_SLICES], TCP_SND_QUEUELEN - HOST_MAIN_TCP_SLICES,
+            &Host_Main_onWritten, &done, 0);
+    }
+
+    printf("host_main: tcp_writev of %u buffers into a segment of %u pbufs %s, %u pbufs queued after it\n",
+        TCP_SND_QUEUELEN - HOST_MAIN_TCP_SLICES, queued, (writevErr == ERR_MEM) ? "refused" : "accepted",
+        (tcp.pcb != NULL) ? tcp.pcb->snd_queuelen : 0U);
+
+    ok = (err == ERR_OK) && (queued == HOST_MAIN_TCP_SLICES + 1) && (writevErr == ERR_MEM)
+         && (tcp.pcb->snd_queuelen == queued) && (tcp.pcb->unsent->len == HOST_MAIN_TCP_SLICES)
+         && (tcp.pcb->unsent->next == NULL) && (done == 0) && (memp_num_free(MEMP_TCP_WRITEV_PBUF) == slices);
+    Host_Main_tcpClose(&tcp);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, TCP_SND_QUEUELEN of tcp_writev()\n");
+    }
+
+    return ok;
+}
+
+
+#endif
+
+#if TCP_RCV_AUTOTUNE
+/** \brief Receive window after the PBUF_POOL: a SYN sent while the application holds all but
+ * TCP_RCV_POOL_RESERVE + 1 buffers offers one segment (536 bytes before the SYN-ACK),
+ * tcp_fasttmr() opens the window once they are back */
+static boolean Host_Main_testReceiveWindow(void)
+{
+    static pbuf_t *pool[PBUF_POOL_SIZE];
+    Host_Main_Tcp  tcp;
+    uint32         count     = 0;
+    uint16         lowWindow = 0;
+    err_t          err;
+
+    while ((memp_num_free(MEMP_PBUF_POOL) > TCP_RCV_POOL_RESERVE + 1) && (count < PBUF_POOL_SIZE))
+    {
+        pool[count++] = pbuf_alloc(PBUF_RAW, PBUF_POOL_BUFSIZE, PBUF_POOL);
+    }
+
+    err       = Host_Main_tcpOpen(&tcp, NULL, 0);
+    lowWindow = tcp.peer.window;
+
+    while (count > 0)
+    {
+        pbuf_free(pool[--count]);
+    }
+
+    tcp_fasttmr();
+    ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    Host_Main_tcpClose(&tcp);
+    printf("host_main: receive window %u in the SYN and %u in the ACK with %u free PBUF_POOL buffers, "
+           "%u after tcp_fasttmr()\n", tcp.peer.synWindow, lowWindow, TCP_RCV_POOL_RESERVE + 1, tcp.peer.window);
+
+    if ((err != ERR_OK) || (tcp.peer.synWindow == 0) || (tcp.peer.synWindow > TCP_MSS) ||
+        (lowWindow != tcp.peer.synWindow) || (tcp.peer.window != TCP_WND))
+    {
+        printf("host_main: FAILED, receive window after the PBUF_POOL\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+#if LWIP_TCP_SACK && TCP_RTO_RFC6298
+/** \brief SACK: both SYNs carry SACK-permitted; with 4 segments in flight one duplicate ACK
+ * which SACKs the last 3 marks the first lost and retransmits it at once, the ACK of all ends
+ * the recovery and stops the retransmission timer of the pcb */
+static boolean Host_Main_testSack(void)
+{
+    static uint8       data[4 * TCP_MSS];
+    static const uint8 sackPermitted[4] = {1, 1, 4, 2};     /* NOP, NOP, SACK permitted */
+    uint8              sack[12]         = {1, 1, 5, 10};    /* NOP, NOP, SACK with one block */
+    Host_Main_Tcp      tcp;
+    struct tcp_pcb    *pcb;
+    boolean            negotiated       = FALSE;
+    boolean            armed            = FALSE;
+    boolean            recovery         = FALSE;
+    boolean            ok;
+    uint32             sent             = 0;
+    err_t              err;
+    uint32             i;
+
+    err = Host_Main_tcpOpen(&tcp, sackPermitted, 4);
+    pcb = tcp.pcb;
+
+    if (err == ERR_OK)
+    {
+        negotiated = (pcb->flags2 & TF2_SACK) != 0;
+        pcb->cwnd  = 4 * pcb->mss;     /* as after slow start */
+        err        = tcp_write(pcb, data, sizeof(data), TCP_WRITE_FLAG_COPY);
+    }
+
+    if (err == ERR_OK)
+    {
+        err   = tcp_output(pcb);
+        sent  = tcp.peer.segments;
+        armed = sys_timeout_pending(&pcb->rto_timeo);
+
+        for (i = 0; i < 4; i++)
+        {
+            sack[4 + i] = (uint8)((tcp.peer.isn + 1U + pcb->mss) >> (24 - (8 * i)));
+            sack[8 + i] = (uint8)((tcp.peer.isn + 1U + (4U * pcb->mss)) >> (24 - (8 * i)));
+        }
+
+        Host_Main_sendTcpOptions(&tcp, TCP_ACK, tcp.peer.isn + 1U, sack, sizeof(sack));
+        recovery = (pcb->flags & TF_INFR) != 0;
+        Host_Main_sendTcp(&tcp, TCP_ACK, tcp.peer.isn + 1U + (4U * pcb->mss));
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+
+    printf("host_main: SACK %s, %u segments, %u after a duplicate ACK SACKing 3 (seqno +%u), "
+           "retransmission timer %s and %s after the ACK\n", negotiated ? "negotiated" : "not negotiated", sent,
+        tcp.peer.segments, tcp.peer.lastSeqno - tcp.peer.isn - 1U, armed ? "armed" : "idle",
+        ((pcb != NULL) && sys_timeout_pending(&pcb->rto_timeo)) ? "armed" : "idle");
+
+    ok = (err == ERR_OK) && tcp.peer.sackPermitted && negotiated && (sent == 4) && armed && recovery
+         && (tcp.peer.segments == 5) && (tcp.peer.lastSeqno == tcp.peer.isn + 1U) && ((pcb->flags & TF_INFR) == 0)
+         && !sys_timeout_pending(&pcb->rto_timeo);
+    Host_Main_tcpClose(&tcp);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, SACK fast retransmit\n");
+    }
+
+    return ok;
+}
+
+
+/** \brief SACK loss of more than TCP_MAXRTX segments: the duplicate ACKs of the segments after
+ * them retransmit every hole, yet nrtx only counts time-outs, so tcp_slowtmr() keeps the pcb
+ * until the ACK of all */
+static boolean Host_Main_testSackLoss(void)
+{
+    static uint8       data[100];
+    static const uint8 sackPermitted[4] = {1, 1, 4, 2};     /* NOP, NOP, SACK permitted */
+    uint8              sack[12]         = {1, 1, 5, 10};    /* NOP, NOP, SACK with one block */
+    Host_Main_Tcp      tcp;
+    struct tcp_pcb    *pcb;
+    boolean            ok;
+    uint32             sent             = 0;
+    uint8              nrtx             = 0;
+    err_t              err;
+    uint32             i;
+    uint32             k;
+
+    err = Host_Main_tcpOpen(&tcp, sackPermitted, 4);
+    pcb = tcp.pcb;
+
+    if (err == ERR_OK)
+    {
+        tcp_err(pcb, &Host_Main_onTcpError);
+        pcb->cwnd = 4 * pcb->mss;     /* as after slow start */
+    }
+
+    for (i = 0; (i < HOST_MAIN_TCP_SMALL) && (err == ERR_OK); i++)
+    {
+        err = tcp_write(pcb, data, sizeof(data), TCP_WRITE_FLAG_COPY);
+
+        if (err == ERR_OK)
+        {
+            err = tcp_output(pcb);
+        }
+
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+
+    if (err == ERR_OK)
+    {
+        sent = tcp.peer.segments;
+
+        /* a duplicate ACK per segment after the lost ones, SACKing all received so far */
+        for (i = HOST_MAIN_TCP_LOST; i < HOST_MAIN_TCP_SMALL; i++)
+        {
+            for (k = 0; k < 4; k++)
+            {
+                sack[4 + k] = (uint8)((tcp.peer.isn + 1U + (HOST_MAIN_TCP_LOST * sizeof(data))) >> (24 - (8 * k)));
+                sack[8 + k] = (uint8)((tcp.peer.isn + 1U + ((i + 1U) * sizeof(data))) >> (24 - (8 * k)));
+            }
+
+            Host_Main_sendTcpOptions(&tcp, TCP_ACK, tcp.peer.isn + 1U, sack, sizeof(sack));
+            ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+        }
+
+        nrtx = pcb->nrtx;
+        tcp_slowtmr();
+        tcp_slowtmr();
+    }
+
+    if (tcp.connected != FALSE)
+    {
+        Host_Main_sendTcp(&tcp, TCP_ACK, tcp.peer.isn + 1U + (HOST_MAIN_TCP_SMALL * sizeof(data)));
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+    else
+    {
+        pcb     = NULL;
+        tcp.pcb = NULL;
+    }
+
+    printf("host_main: SACK loss of %u of %u segments, %u retransmitted, nrtx %u, pcb %s after tcp_slowtmr()\n",
+        HOST_MAIN_TCP_LOST, sent, tcp.peer.segments - sent, nrtx, (pcb != NULL) ? "kept" : "removed");
+
+    ok = (err == ERR_OK) && (pcb != NULL) && (sent == HOST_MAIN_TCP_SMALL) && (nrtx == 0)
+         && (tcp.peer.segments - sent == HOST_MAIN_TCP_LOST) && (pcb->unacked == NULL) && (pcb->unsent == NULL);
+    Host_Main_tcpClose(&tcp);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, SACK loss beyond TCP_MAXRTX\n");
+    }
+
+    return ok;
+}
+
+
+#endif
+
+/** \brief Zero-copy TX: while the DMA owns the frame of a segment, a retransmission must not
+ * rewrite its headers; the segment is sent again once the ring released it */
+static boolean Host_Main_testBusySegment(Host_Main_Context *ctx)
+{
+    static uint8    data[TCP_MSS];
+    Host_Main_Tcp   tcp;
+    IfxEth         *eth         = Ifx_Lwip_getNetIf()->state;
+    struct tcp_seg *seg         = NULL;
+    uint32          badChecksum = ctx->stats->badChecksum;
+    uint8           headers[IP_HLEN + TCP_HLEN];
+    boolean         busy        = FALSE;
+    boolean         unchanged   = FALSE;
+    boolean         requeued    = TRUE;
+    boolean         ok;
+    uint32          stalled     = 0;
+    uint32          released    = 0;
+    err_t           err;
+
+    err = Host_Main_tcpOpen(&tcp, NULL, 0);
+
+    if (err == ERR_OK)
+    {
+        err = tcp_write(tcp.pcb, data, sizeof(data), TCP_WRITE_FLAG_COPY);
+    }
+
+    if (err == ERR_OK)
+    {
+        IfxEth_Host_setTxAutoProcess(eth, FALSE);
+        err = tcp_output(tcp.pcb);
+        seg = tcp.pcb->unacked;
+    }
+
+    if ((err == ERR_OK) && (seg != NULL))
+    {
+        busy = seg->p->ref > 1;
+        memcpy(headers, (uint8 *)seg->tcphdr - IP_HLEN, sizeof(headers));
+
+        /* time-out, then fast retransmit, both while the frame is still in the ring */
+        tcp_rexmit_rto(tcp.pcb);
+        requeued  = (tcp.pcb->unsent != NULL) || (tcp_rexmit(tcp.pcb) == ERR_OK);
+        unchanged = memcmp(headers, (uint8 *)seg->tcphdr - IP_HLEN, sizeof(headers)) == 0;
+
+        IfxEth_Host_setTxAutoProcess(eth, TRUE);
+        IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+        stalled = tcp.peer.segments;
+
+        /* the ring released the frame: the next time-out retransmits it */
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+        tcp_rexmit_rto(tcp.pcb);
+        released = tcp.peer.segments - stalled;
+    }
+
+    IfxEth_Host_setTxAutoProcess(eth, TRUE);
+    printf("host_main: zero-copy TCP segment %s while the DMA owns it, headers %s, %u frame sent, "
+           "%u retransmitted after the release\n", requeued ? "requeued" : "not requeued",
+        unchanged ? "unchanged" : "rewritten", stalled, released);
+
+    ok = (err == ERR_OK) && busy && !requeued && unchanged && (stalled == 1) && (released == 1)
+         && (tcp.peer.lastSeqno == tcp.peer.isn + 1U) && (ctx->stats->badChecksum == badChecksum);
+    Host_Main_tcpClose(&tcp);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, retransmission of a busy segment\n");
+    }
+
+    return ok;
+}
+
+
+#if LWIP_TCP_GSO
+/** \brief TCP segmentation offload: one tcp_output() of 4 full segments passes IP as a single
+ * super-segment, the driver cuts it into 4 frames with consecutive sequence numbers, PSH on
+ * the last one only and checksums of each frame */
+static boolean Host_Main_testTso(Host_Main_Context *ctx)
+{
+    static uint8                    data[4 * TCP_MSS];
+    struct ethernetif_tc2x_txstats *txstats = ethernetif_tc2x_getTxStats();
+    uint32                          gso     = txstats->gso;
+    uint32                          bad     = ctx->stats->badChecksum;
+    Host_Main_Tcp                   tcp;
+    err_t                           err;
+    uint32                          i;
+
+    err = Host_Main_tcpOpen(&tcp, NULL, 0);
+
+    if (err == ERR_OK)
+    {
+        tcp.pcb->cwnd = 4 * tcp.pcb->mss;     /* as after slow start */
+
+        for (i = 0; i < sizeof(data); i++)
+        {
+            data[i] = (uint8)i;
+        }
+
+        err = tcp_write(tcp.pcb, data, sizeof(data), 0);
+    }
+
+    if (err == ERR_OK)
+    {
+        err = tcp_output(tcp.pcb);
+        Host_Main_sendTcp(&tcp, TCP_ACK, tcp.peer.isn + 1U + sizeof(data));
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+
+    Host_Main_tcpClose(&tcp);
+    printf("host_main: TSO %u segments of %u bytes in %u frames cut by the driver, %u out of sequence, "
+           "%u bad checksums\n", tcp.peer.segments, tcp.peer.lastLength, txstats->gso - gso, tcp.peer.holes,
+        ctx->stats->badChecksum - bad);
+
+    if ((err != ERR_OK) || (tcp.peer.segments != 4) || (tcp.peer.bytes != sizeof(data)) || (tcp.peer.holes != 0)
+        || (tcp.peer.lastSeqno != tcp.peer.isn + 1U + (3U * TCP_MSS)) || ((tcp.peer.lastFlags & TCP_PSH) == 0)
+        || (txstats->gso - gso != 4) || (ctx->stats->badChecksum != bad))
+    {
+        printf("host_main: FAILED, TCP segmentation offload\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief TSO on a stalled ring which holds 10 frames: 4 segments of 2 descriptors don't fit in
+ * place, the driver copies the frames the ring is short of instead of rejecting them */
+static boolean Host_Main_testTsoBusyRing(Host_Main_Context *ctx)
+{
+    static uint8                    data[4 * TCP_MSS];
+    IfxEth                         *eth      = Ifx_Lwip_getNetIf()->state;
+    struct ethernetif_tc2x_txstats *txstats  = ethernetif_tc2x_getTxStats();
+    uint32                          gso      = txstats->gso;
+    uint32                          copied   = txstats->copied;
+    uint32                          ringFull = txstats->ring_full;
+    uint32                          bad      = ctx->stats->badChecksum;
+    Host_Main_Tcp                   tcp;
+    err_t                           err;
+    uint32                          i;
+
+    err = Host_Main_tcpOpen(&tcp, NULL, 0);
+
+    if (err == ERR_OK)
+    {
+        tcp.pcb->cwnd = 4 * tcp.pcb->mss;
+
+        for (i = 0; i < sizeof(data); i++)
+        {
+            data[i] = (uint8)i;
+        }
+
+        err = tcp_write(tcp.pcb, data, sizeof(data), 0);
+    }
+
+    if (err == ERR_OK)
+    {
+        IfxEth_Host_setTxAutoProcess(eth, FALSE);
+
+        for (i = 0; i < 10; i++)
+        {
+            Host_Main_sendPayload(ctx, &ctx->addr);
+        }
+
+        copied = txstats->copied;
+        err    = tcp_output(tcp.pcb);
+        IfxEth_Host_setTxAutoProcess(eth, TRUE);
+        IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+        Host_Main_sendTcp(&tcp, TCP_ACK, tcp.peer.isn + 1U + sizeof(data));
+        ethernetif_tc2x_reclaim(Ifx_Lwip_getNetIf());
+    }
+
+    IfxEth_Host_setTxAutoProcess(eth, TRUE);
+    Host_Main_tcpClose(&tcp);
+    printf("host_main: TSO on a ring holding 10 frames, %u segments in %u frames, %u copied, %u ring full, "
+           "%u out of sequence\n", tcp.peer.segments, txstats->gso - gso, txstats->copied - copied,
+        txstats->ring_full - ringFull, tcp.peer.holes);
+
+    if ((err != ERR_OK) || (tcp.peer.segments != 4) || (tcp.peer.bytes != sizeof(data)) || (tcp.peer.holes != 0)
+        || (txstats->gso - gso != 4) || (txstats->copied - copied != 2) || (txstats->ring_full != ringFull)
+        || (ctx->stats->badChecksum != bad))
+    {
+        printf("host_main: FAILED, TCP segmentation offload on a busy ring\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+#if IFX_LWIP_RX_COPYBREAK
+/** \brief RX copy-break: small frames held by the application don't use up PBUF_POOL */
+static boolean Host_Main_testCopyBreak(void)
+{
+    struct ethernetif_tc2x_rxstats *rxstats = ethernetif_tc2x_getRxStats();
+    struct ethernetif_tc2x_rxstats  before  = *rxstats;
+    udp_pcb_t                      *hold    = udp_new();
+    uint8                           small[HOST_MAIN_HOLD_LENGTH];
+    uint8                           frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16                          smallLength;
+    boolean                         ok      = TRUE;
+    uint32                          i;
+
+    memset(small, 0xA5, sizeof(small));
+    smallLength = HostSim_buildUdpFrame(frame, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_HOLD_PORT, small, sizeof(small));
+    udp_bind(hold, IP_ADDR_ANY, HOST_MAIN_HOLD_PORT);
+    udp_recv(hold, &Host_Main_onHold, NULL);
+
+    for (i = 0; i < HOST_MAIN_HOLD; i++)
+    {
+        HostSim_inject(frame, smallLength);
+        HostSim_poll();
+    }
+
+    printf("host_main: copy-break %u of %u small frames held, %u copied, %u small pool empty, %u pool empty\n",
+        Host_Main_heldCount, HOST_MAIN_HOLD, rxstats->copybreak - before.copybreak,
+        rxstats->small_empty - before.small_empty, rxstats->pool_empty - before.pool_empty);
+    printf("host_main: rx frame sizes");
+
+    for (i = 0; i < ETHERNETIF_TC2X_RX_SIZE_CLASSES; i++)
+    {
+        printf(" %u", rxstats->sizes[i]);
+    }
+
+    printf("\n");
+
+    if ((IFX_LWIP_RX_COPYBREAK >= smallLength) && ((Host_Main_heldCount != HOST_MAIN_HOLD)
+        || (rxstats->copybreak - before.copybreak != HOST_MAIN_HOLD) || (rxstats->pool_empty != before.pool_empty)))
+    {
+        printf("host_main: FAILED, RX copy-break\n");
+        ok = FALSE;
+    }
+
+    while (Host_Main_heldCount > 0)
+    {
+        pbuf_free(Host_Main_held[--Host_Main_heldCount]);
+    }
+
+    udp_remove(hold);
+
+    return ok;
+}
+
+
+#endif
+
+/** \brief Per-core memp caches: CPU1 and CPU2 allocate pbufs while CPU0 receives */
+static boolean Host_Main_testCoreCaches(Host_Main_Context *ctx)
+{
+    pthread_t producer[2];
+    uint32    state[2][2] = {{1, 0}, {2, 0}};
+    uint32    received    = Host_Main_rxCount;
+    uint32    batches     = 0;
+    uint32    available   = 0;
+    pbuf_t   *chain       = NULL;
+    uint32    i;
+
+    for (i = 0; i < 2; i++)
+    {
+        pthread_create(&producer[i], NULL, &Host_Main_producer, state[i]);
+    }
+
+    for (i = 0; i < HOST_MAIN_CORE_RX; i++)
+    {
+        HostSim_inject(ctx->frame, ctx->length);
+        HostSim_poll();
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        pthread_join(producer[i], NULL);
+        batches += memp_cache_get((u8_t)(i + 1), MEMP_PBUF_POOL)->refills
+                   + memp_cache_get((u8_t)(i + 1), MEMP_PBUF_POOL)->drains;
+    }
+
+    /* every element is back in the shared pool: the whole pool can be allocated */
+    memp_cache_flush();
+
+    for (;;)
+    {
+        pbuf_t *p = pbuf_alloc(PBUF_RAW, 64, PBUF_POOL);
+
+        if (p == NULL)
+        {
+            break;
+        }
+
+        available++;
+        p->next = chain;
+        chain   = p;
+    }
+
+    while (chain != NULL)
+    {
+        pbuf_t *p = chain;
+        chain   = p->next;
+        p->next = NULL;
+        pbuf_free(p);
+    }
+
+    printf("host_main: memp caches, %u pbufs per producer core, %u shared pool batches, %u failed, %u of %u pool pbufs back\n",
+        HOST_MAIN_CORE_ALLOCS, batches, state[0][1] + state[1][1], available, PBUF_POOL_SIZE);
+
+    if ((Host_Main_rxCount - received != HOST_MAIN_CORE_RX) || (available != PBUF_POOL_SIZE)
+        || (batches > HOST_MAIN_CORE_ALLOCS / 100))
+    {
+        printf("host_main: FAILED, per-core memp caches\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+/** \brief RX interrupt moderation: one RI per batch, the STM timeout delivers a partial batch */
+static boolean Host_Main_testRxCoalescing(Host_Main_Context *ctx)
+{
+    Ifx_Lwip *lwip = Ifx_Lwip_get();
+    IfxEth   *eth  = Ifx_Lwip_getNetIf()->state;
+    uint32    received, idlePolls, rxEvents, timeouts;
+    uint64    deadline;
+    boolean   ok;
+    uint32    i;
+
+    /* consume the event of the burst and align the DMA with the first descriptor of a batch */
+    Ifx_Lwip_pollReceiveFlags();
+
+    while ((IfxEth_getDmaRxIndex(eth) % HOST_MAIN_COALESCE) != 0)
+    {
+        HostSim_inject(ctx->frame, ctx->length);
+        Ifx_Lwip_pollReceiveFlags();
+    }
+
+    Ifx_Lwip_setRxCoalescing(HOST_MAIN_COALESCE, HOST_MAIN_COALESCE_US);
+    received  = Host_Main_rxCount;
+    idlePolls = lwip->rx.idlePolls;
+    rxEvents  = lwip->isr.rxEvents;
+    timeouts  = lwip->isr.timeouts;
+
+    Ifx_Lwip_pollReceiveFlags();
+    ok = (lwip->rx.idlePolls == idlePolls + 1) && Ifx_Lwip_isIdle();
+
+    for (i = 0; i < HOST_MAIN_COALESCE; i++)
+    {
+        HostSim_inject(ctx->frame, ctx->length);
+    }
+
+    ok = ok && (lwip->isr.rxEvents == rxEvents + 1);
+    Ifx_Lwip_pollReceiveFlags();
+    ok = ok && (Host_Main_rxCount == received + HOST_MAIN_COALESCE);
+
+    HostSim_inject(ctx->frame, ctx->length);
+    Ifx_Lwip_pollReceiveFlags();
+    ok       = ok && (Host_Main_rxCount == received + HOST_MAIN_COALESCE) && lwip->isr.armed;
+    deadline = HostSim_nowNs() + 10ULL * HOST_MAIN_COALESCE_US * 1000U;
+
+    while ((Host_Main_rxCount == received + HOST_MAIN_COALESCE) && (HostSim_nowNs() < deadline))
+    {
+        HostSim_poll();
+    }
+
+    ok = ok && (Host_Main_rxCount == received + HOST_MAIN_COALESCE + 1) && (lwip->isr.timeouts == timeouts + 1)
+         && (lwip->isr.rxEvents == rxEvents + 1);
+    printf("host_main: rx coalescing %u frames or %u us, %u timeouts, max latency %u ticks, max %u ready\n",
+        HOST_MAIN_COALESCE, HOST_MAIN_COALESCE_US, lwip->isr.timeouts - timeouts, lwip->rx.maxLatency, lwip->rx.maxReady);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, RX interrupt moderation\n");
+    }
+
+    Ifx_Lwip_setRxCoalescing(IFX_LWIP_RX_COALESCE_FRAMES, IFX_LWIP_RX_COALESCE_US);
+
+    return ok;
+}
+
+
+/** \brief A netif without checksum offload next to the offloading ETH netif */
+static boolean Host_Main_testSoftwareChecksum(Host_Main_Context *ctx)
+{
+    netif_t   capture;
+    ip_addr_t ip, mask, gw, remote;
+    pbuf_t   *p;
+    uint32    received;
+    boolean   ok;
+
+    IP4_ADDR(&ip, 10, 0, 0, 1);
+    IP4_ADDR(&mask, 255, 255, 255, 0);
+    IP4_ADDR(&gw, 0, 0, 0, 0);
+    IP4_ADDR(&remote, 10, 0, 0, 2);
+    netif_add(&capture, &ip, &mask, &gw, NULL, Host_Main_captureInit, ip_input);
+    netif_set_up(&capture);
+
+    p = pbuf_alloc(PBUF_TRANSPORT, sizeof(ctx->payload), PBUF_RAM);
+    memcpy(p->payload, ctx->payload, sizeof(ctx->payload));
+    udp_sendto(ctx->udp, p, &remote, HOST_MAIN_SW_PORT);
+    pbuf_free(p);
+
+    ok = (Host_Main_capturedLength == IP_HLEN + UDP_HLEN + sizeof(ctx->payload))
+         && (inet_chksum(Host_Main_captured, IP_HLEN) == 0)
+         && ((Host_Main_captured[IP_HLEN + 6] | Host_Main_captured[IP_HLEN + 7]) != 0);
+
+    /* software check on input: the valid datagram is delivered, the corrupted one is not */
+    received = Host_Main_rxCount;
+    Host_Main_captureLoop(&capture, 0);
+    ok       = ok && (Host_Main_rxCount == received + 1);
+    Host_Main_captureLoop(&capture, 0x5A);
+    ok       = ok && (Host_Main_rxCount == received + 1);
+
+#if LWIP_USE_HW_CHECKSUM_ENGINE
+    ok = ok && (Ifx_Lwip_getNetIf()->chksum_flags == NETIF_CHECKSUM_DISABLE_ALL);
+#endif
+    printf("host_main: software checksums on a second netif %s\n", ok ? "valid" : "wrong");
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, per-netif checksum control\n");
+    }
+
+    netif_remove(&capture);
+
+    return ok;
+}
+
+
+/** \brief Multi-core: lwIP on CPU1, CPU0 and CPU2 exchange datagrams with it through channels */
+static boolean Host_Main_testMultiCore(Host_Main_Context *ctx)
+{
+    Ifx_LwipMc     *mc          = Ifx_LwipMc_get();
+    Host_Main_McApp app[2]      = {{IfxCpu_Id_0, HOST_MAIN_MC_PORT, PBUF_POOL},
+                                   {IfxCpu_Id_2, HOST_MAIN_MC_PORT + 1, PBUF_RAM}};
+    uint32          badChecksum = ctx->stats->badChecksum;
+    uint32          rxDropped   = 0;
+    uint32          sendErrors  = 0;
+    uint32          echoed      = 0;
+    pthread_t       stack, cpu2;
+    uint64          start, elapsed;
+    uint64          deadline;
+    boolean         closed;
+    boolean         ok;
+    uint32          i;
+
+    for (i = 0; i < 2; i++)
+    {
+        app[i].channel = Ifx_LwipMc_open(app[i].port);
+    }
+
+    ok = (app[0].channel != NULL_PTR) && (app[1].channel != NULL_PTR);
+
+    HostSim_setFrameHook(&Host_Main_onMcFrame, NULL);
+    Host_Main_mcRun = TRUE;
+    start           = HostSim_nowNs();
+    pthread_create(&stack, NULL, &Host_Main_mcStack, NULL);
+    pthread_create(&cpu2, NULL, &Host_Main_mcApp, &app[1]);
+    Host_Main_mcApp(&app[0]);
+    pthread_join(cpu2, NULL);
+    elapsed = HostSim_nowNs() - start;
+
+    /* the stack core removes the pcbs of the closed channels */
+    deadline = HostSim_nowNs() + 1000000000ULL;
+
+    do
+    {
+        sched_yield();
+        closed = (Ifx_LwipMc_getState(app[0].channel) == Ifx_LwipMc_State_closed)
+                 && (Ifx_LwipMc_getState(app[1].channel) == Ifx_LwipMc_State_closed);
+    } while ((closed == FALSE) && (HostSim_nowNs() < deadline));
+
+    Host_Main_mcRun = FALSE;
+    pthread_join(stack, NULL);
+    HostSim_setFrameHook(NULL, NULL);
+    memp_cache_flush();
+
+    for (i = 0; i < 2; i++)
+    {
+        echoed     += app[i].received;
+        rxDropped  += app[i].channel->stats.rxDropped;
+        sendErrors += app[i].channel->stats.sendErrors;
+        ok          = ok && (app[i].received == HOST_MAIN_MC_COUNT) && (app[i].misordered == 0) && (app[i].errors == 0);
+    }
+
+    ok = ok && closed && (mc->requests == mc->served) && (rxDropped == 0) && (sendErrors == 0)
+         && (Host_Main_mcEchoLost == 0) && (ctx->stats->badChecksum == badChecksum);
+    printf("host_main: multi-core %u of %u datagrams echoed to CPU0 and CPU2 through CPU1, %.0f round trips/s, %u + %u retried, %u misordered, %u dropped\n",
+        echoed, 2U * HOST_MAIN_MC_COUNT, (double)echoed * 1e9 / (double)(elapsed ? elapsed : 1),
+        app[0].refused, app[1].refused, app[0].misordered + app[1].misordered, rxDropped + Host_Main_mcEchoLost);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, multi-core channels\n");
+    }
+
+    return ok;
+}
+
+
+#if LWIP_TIMER_WHEEL
+/** \brief Timing wheel: a periodic and a one-shot timeout, the STM compare only interrupts when
+ * one is due */
+static boolean Host_Main_testTimerWheel(void)
+{
+    static struct sys_timeo periodic, oneshot;
+    Ifx_Lwip               *lwip    = Ifx_Lwip_get();
+    uint32                  ticks   = lwip->timer.ticks;
+    uint32                  wakeups = lwip->timer.wakeups;
+    uint32                  start   = sys_now();
+    uint32                  sleep;
+    uint64                  deadline;
+    boolean                 ok;
+    uint32                  i;
+
+    sys_timeout_start(&periodic, HOST_MAIN_TIMER_MS, HOST_MAIN_TIMER_MS, &Host_Main_onTimeout, (void *)0);
+    sys_timeout_start(&oneshot, HOST_MAIN_ONESHOT_MS, 0, &Host_Main_onTimeout, (void *)1);
+    sleep    = sys_timeouts_sleeptime();
+    deadline = HostSim_nowNs() + 1000000000ULL;
+
+    while (sys_timeout_pending(&oneshot) && (HostSim_nowNs() < deadline))
+    {
+        HostSim_poll();
+    }
+
+    ticks   = lwip->timer.ticks - ticks;
+    wakeups = lwip->timer.wakeups - wakeups;
+    ok      = (sleep <= HOST_MAIN_TIMER_MS) && (Host_Main_timeouts[1] == 1)
+              && (Host_Main_timeouts[0] >= (HOST_MAIN_ONESHOT_MS / HOST_MAIN_TIMER_MS) - 1)
+              && sys_timeout_pending(&periodic) && (wakeups != 0) && (ticks < (sys_now() - start));
+    sys_timeout_stop(&periodic);
+    printf("host_main: timer wheel %u periodic and %u one-shot timeouts, %u interrupts in %u ms, %u wakeups\n",
+        Host_Main_timeouts[0], Host_Main_timeouts[1], ticks, sys_now() - start, wakeups);
+    printf("host_main: timer interrupt lateness (us, log2 buckets)");
+
+    for (i = 0; i < IFX_LWIP_TIMER_JITTER_BUCKETS; i++)
+    {
+        printf(" %u", lwip->timer.jitter[i]);
+    }
+
+    printf(", max %u us, %u spurious, %u immediate\n",
+        (uint32)(((uint64)lwip->timer.maxLate * 1000U) / lwip->clock.ticksPerMs), lwip->timer.spurious,
+        lwip->timer.immediate);
+
+    if (ok == FALSE)
+    {
+        printf("host_main: FAILED, timing wheel\n");
+    }
+
+    return ok;
+}
+
+
+#endif
+
+#if MEM_USE_POOLS && MEM_TELEMETRY
+/** \brief mem_malloc() size classes: nothing failed, only the TX descriptor table is left */
+static boolean Host_Main_testMemClasses(void)
+{
+    const struct mem_class *memClass;
+    uint32                  used = 0;
+    uint32                  err  = 0;
+    uint8                   c;
+
+    printf("host_main: mem classes");
+
+    for (c = 0; (memClass = mem_class_get(c)) != NULL; c++)
+    {
+        printf(" %u:%u/%u", memClass->size, memClass->max, memClass->num);
+        used += memClass->used;
+        err  += memClass->err;
+    }
+
+    printf(" (size:max/num), %u in use, %u failed\n", used, err);
+
+    if ((used != 1) || (err != 0))
+    {
+        printf("host_main: FAILED, mem_malloc() size classes\n");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+#endif
+
+int main(void)
+{
+    static Host_Main_Context ctx;
+    Ifx_Lwip_ArpEntry        arpEntries[3];
+    boolean                  ok;
+
+    /* neighbours of the configuration: a static entry, the peer requested at init and a
+     * multicast address the ARP table refuses */
+    HOST_MAIN_STATIC_IP(&arpEntries[0].ipAddr);
+    MAC_ADDR(&arpEntries[0].ethAddr, 0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0x20);
+    HOSTSIM_PEER_IP(&arpEntries[1].ipAddr);
+    MAC_ADDR(&arpEntries[1].ethAddr, 0, 0, 0, 0, 0, 0);
+    IP4_ADDR(&arpEntries[2].ipAddr, 224, 0, 0, 1);
+    MAC_ADDR(&arpEntries[2].ethAddr, 0x01, 0x00, 0x5E, 0x00, 0x00, 0x01);
+    HostSim_setArpEntries(arpEntries, 3);
+
+    HostSim_init();
+    HOSTSIM_PEER_IP(&ctx.addr);
+    HOST_MAIN_STATIC_IP(&ctx.staticIp);
+    ctx.stats = HostSim_getPeerStats();
+    ok        = Host_Main_testArpEntries(&ctx, arpEntries);
+
+    if (HostSim_resolvePeer(1000) == FALSE)
+    {
+        printf("host_main: ARP resolution of the peer failed\n");
+        return EXIT_FAILURE;
+    }
+
+    ctx.udp = udp_new();
+    udp_bind(ctx.udp, IP_ADDR_ANY, HOST_MAIN_LOCAL_PORT);
+    udp_recv(ctx.udp, &Host_Main_onReceive, NULL);
+    memset(ctx.payload, 0x5A, sizeof(ctx.payload));
+    ctx.length = HostSim_buildUdpFrame(ctx.frame, HOSTSIM_PEER_UDP_PORT, HOST_MAIN_LOCAL_PORT, ctx.payload,
+        sizeof(ctx.payload));
+
+    ok = Host_Main_testTransmit(&ctx) && ok;
+    ok = Host_Main_testRingFull(&ctx) && ok;
+    ok = Host_Main_testStream(&ctx) && ok;
+
+    /* connected pcb: cached headers, invalidated by ARP expiry and address change */
+    ctx.flow = udp_new();
+    udp_bind(ctx.flow, IP_ADDR_ANY, HOST_MAIN_LOCAL_PORT + 2);
+    udp_connect(ctx.flow, &ctx.addr, HOSTSIM_PEER_UDP_PORT);
+    HostSim_setFrameHook(&Host_Main_onFrame, NULL);
+    ok = Host_Main_testConnected(&ctx) && ok;
+    ok = Host_Main_testArpRefresh(&ctx) && ok;
+    ok = Host_Main_testArpExpiry(&ctx) && ok;
+    ok = Host_Main_testStaticArp(&ctx) && ok;
+    ok = Host_Main_testAddressChange(&ctx) && ok;
+    HostSim_setFrameHook(NULL, NULL);
+    printf("host_main: connected pcb, ARP expiry and address change handled\n");
+    ok = Host_Main_testUdpDemux(&ctx) && ok;
+    udp_remove(ctx.flow);
+
+    ok = Host_Main_testReceive(&ctx) && ok;
+    ok = Host_Main_testBurstDrain(&ctx) && ok;
+#if IFX_LWIP_RX_COPYBREAK
+    ok = Host_Main_testDropDrain(&ctx) && ok;
+#endif
+#if IP_REASSEMBLY
+    ok = Host_Main_testReassembly(&ctx) && ok;
+#endif
+#if IP_FRAG
+    ok = Host_Main_testFragmentation(&ctx) && ok;
+    ok = Host_Main_testFragmentsBeyondRing(&ctx) && ok;
+#endif
+#if LWIP_TCP_WRITEV && LWIP_TCP_CORK
+    ok = Host_Main_testTcpWritev(&ctx) && ok;
+    ok = Host_Main_testTcpWritevQueueLength() && ok;
+#endif
+#if TCP_RCV_AUTOTUNE
+    ok = Host_Main_testReceiveWindow() && ok;
+#endif
+#if LWIP_TCP_SACK && TCP_RTO_RFC6298
+    ok = Host_Main_testSack() && ok;
+    ok = Host_Main_testSackLoss() && ok;
+#endif
+    ok = Host_Main_testBusySegment(&ctx) && ok;
+#if LWIP_TCP_GSO
+    ok = Host_Main_testTso(&ctx) && ok;
+    ok = Host_Main_testTsoBusyRing(&ctx) && ok;
+#endif
+#if IFX_LWIP_RX_COPYBREAK
+    ok = Host_Main_testCopyBreak() && ok;
+#endif
+    ok = Host_Main_testCoreCaches(&ctx) && ok;
+    ok = Host_Main_testRxCoalescing(&ctx) && ok;
+    ok = Host_Main_testSoftwareChecksum(&ctx) && ok;
+    ok = Host_Main_testMultiCore(&ctx) && ok;
+#if LWIP_TIMER_WHEEL
+    ok = Host_Main_testTimerWheel() && ok;
+#endif
+#if MEM_USE_POOLS && MEM_TELEMETRY
+    ok = Host_Main_testMemClasses() && ok;
+#endif
+
+    if (IfxCpu_Host_getDebugCount() != 0)
+    {
+        printf("host_main: FAILED, __debug() hit %u times\n", IfxCpu_Host_getDebugCount());
+        ok = FALSE;
+    }
+
+    udp_remove(ctx.udp);
+
+    printf("host_main: %s\n", ok ? "PASSED" : "FAILED");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,546 @@
+/**
+ * \file HostSim.c
+ * \brief Simulated network peer and main loop helpers of the host (Linux) build
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ */
+
+#include "HostSim.h"
+#include "Stm/Std/IfxStm.h"
+#include "lwip/inet_chksum.h"
+#include "Comm/Ifx_Console.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//________________________________________________________________________________________
+// PRIVATE DEFINITIONS
+
+#define HOSTSIM_ETH_HDR_LEN (14U)
+#define HOSTSIM_IP_HDR_LEN  (20U)
+#define HOSTSIM_UDP_HDR_LEN (8U)
+#define HOSTSIM_TCP_HDR_LEN (20U)
+
+IfxEth *IfxEth_get(void);
+void    initStm0(void);
+uint32  pollStm0(void);
+
+static const uint8 HostSim_peerMac[6] = {0x00, 0xAA, 0xBB, 0xCC, 0xDD, 0x06};
+
+static struct
+{
+    HostSim_PeerStats stats;
+    HostSim_FrameHook hook;
+    void             *hookContext;
+    uint16            ipId;
+    HostSim_Loss      loss;
+    uint32            lossState;
+    uint8             txBurstLeft;
+    uint8             rxBurstLeft;
+} HostSim_peer;
+
+static IfxStdIf_DPipe HostSim_console;
+
+static const Ifx_Lwip_ArpEntry *HostSim_arpEntries    = NULL_PTR;   /**< \brief See HostSim_setArpEntries() */
+static uint32                   HostSim_arpEntryCount = 0;
+
+//________________________________________________________________________________________
+// PRIVATE FUNCTIONS
+
+/** \brief Console write function: Ifx_Console_print() output goes to stdout */
+static boolean HostSim_consoleWrite(IfxStdIf_InterfaceDriver driver, void *data, Ifx_SizeT *count, Ifx_TickTime timeout)
+{
+    (void)driver;
+    (void)timeout;
+    fwrite(data, 1, (size_t)*count, stdout);
+    return TRUE;
+}
+
+
+static uint16 HostSim_get16(const uint8 *data)
+{
+    return (uint16)((data[0] << 8) | data[1]);
+}
+
+
+static void HostSim_put16(uint8 *data, uint16 value)
+{
+    data[0] = (uint8)(value >> 8);
+    data[1] = (uint8)value;
+}
+
+
+static void HostSim_answerArp(const uint8 *frame)
+{
+    const uint8 *arp = &frame[HOSTSIM_ETH_HDR_LEN];
+    ip_addr_t    peerIp;
+    uint8        reply[60];
+
+    HOSTSIM_PEER_IP(&peerIp);
+
+    if ((HostSim_get16(&arp[6]) == 1) && (memcmp(&arp[24], &peerIp.addr, 4) == 0))
+    {
+        memset(reply, 0, sizeof(reply));
+        memcpy(&reply[0], &arp[8], 6);             /* destination: sender hardware address */
+        memcpy(&reply[6], HostSim_peerMac, 6);
+        HostSim_put16(&reply[12], ETHTYPE_ARP);
+
+        uint8 *rarp = &reply[HOSTSIM_ETH_HDR_LEN];
+        HostSim_put16(&rarp[0], 1);                /* hardware type: ethernet */
+        HostSim_put16(&rarp[2], ETHTYPE_IP);
+        rarp[4] = 6;
+        rarp[5] = 4;
+        HostSim_put16(&rarp[6], 2);                /* opcode: reply */
+        memcpy(&rarp[8], HostSim_peerMac, 6);
+        memcpy(&rarp[14], &peerIp.addr, 4);
+        memcpy(&rarp[18], &arp[8], 6);
+        memcpy(&rarp[24], &arp[14], 4);
+
+        HostSim_peer.stats.arpRequests++;
+        HostSim_peer.stats.arpUnicast += (memcmp(&frame[0], HostSim_peerMac, 6) == 0);
+        HostSim_inject(reply, sizeof(reply));
+    }
+    else if (HostSim_get16(&arp[6]) == 2)
+    {
+        HostSim_peer.stats.arpReplies++;
+    }
+}
+
+
+static uint32 HostSim_sum(const uint8 *data, uint32 length, uint32 sum)
+{
+    uint32 i;
+
+    for (i = 0; (i + 1) < length; i += 2)
+    {
+        sum += ((uint32)data[i] << 8) | data[i + 1];
+    }
+
+    if (length & 1U)
+    {
+        sum += (uint32)data[length - 1] << 8;
+    }
+
+    while (sum >> 16)
+    {
+        sum = (sum >> 16) + (sum & 0xFFFFU);
+    }
+
+    return sum;
+}
+
+
+/** \brief Checks the IP header checksum and the checksum of unfragmented ICMP, UDP and TCP */
+static boolean HostSim_isChecksumValid(const uint8 *ip, uint16 length)
+{
+    uint16  ihl   = (uint16)((ip[0] & 0x0FU) * 4U);
+    uint16  total = HostSim_get16(&ip[2]);
+    boolean valid = (HostSim_sum(ip, ihl, 0) == 0xFFFFU) && (total <= length) && (total >= ihl);
+
+    if (valid && ((HostSim_get16(&ip[6]) & 0x3FFFU) == 0))
+    {
+        const uint8 *l4       = &ip[ihl];
+        uint16       l4Length = (uint16)(total - ihl);
+        uint32       pseudo   = HostSim_sum(&ip[12], 8, 0) + ip[9] + l4Length;
+
+        switch (ip[9])
+        {
+        case IP_PROTO_ICMP:
+            valid = (HostSim_sum(l4, l4Length, 0) == 0xFFFFU);
+            break;
+        case IP_PROTO_UDP:
+            valid = (HostSim_get16(&l4[6]) == 0) || (HostSim_sum(l4, l4Length, pseudo) == 0xFFFFU);
+            break;
+        case IP_PROTO_TCP:
+            valid = (HostSim_sum(l4, l4Length, pseudo) == 0xFFFFU);
+            break;
+        default:
+            break;
+        }
+    }
+
+    return valid;
+}
+
+
+/** \brief Decides if an IPv4 frame is lost on the wire, see HostSim_setLoss()
+ * \param ppm loss rate of the direction
+ * \param burstLeft frames still to lose of the current burst of the direction
+ */
+static boolean HostSim_isLost(const uint8 *frame, uint16 length, uint32 ppm, uint8 *burstLeft)
+{
+    uint8 burst = (HostSim_peer.loss.burst > 1U) ? HostSim_peer.loss.burst : 1U;
+
+    if ((ppm == 0) || (length < HOSTSIM_ETH_HDR_LEN) || (HostSim_get16(&frame[12]) != ETHTYPE_IP))
+    {
+        return FALSE;
+    }
+
+    if (*burstLeft > 0)
+    {
+        (*burstLeft)--;
+        return TRUE;
+    }
+
+    /* linear congruential generator, the upper bits are the random ones */
+    HostSim_peer.lossState = (HostSim_peer.lossState * 1664525UL) + 1013904223UL;
+
+    if (((HostSim_peer.lossState >> 8) % 1000000UL) < (ppm / burst))
+    {
+        *burstLeft = (uint8)(burst - 1U);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+/** \brief Wire hook of the IfxEth model: everything the stack transmits ends up here */
+static void HostSim_onTransmit(void *context, const uint8 *frame, uint16 length)
+{
+    HostSim_PeerStats *stats = &HostSim_peer.stats;
+
+    (void)context;
+
+    if (HostSim_isLost(frame, length, HostSim_peer.loss.txPpm, &HostSim_peer.txBurstLeft) != FALSE)
+    {
+        stats->txLost++;
+        return;
+    }
+
+    stats->frames++;
+
+    if (length < HOSTSIM_ETH_HDR_LEN)
+    {
+        stats->otherFrames++;
+    }
+    else if (HostSim_get16(&frame[12]) == ETHTYPE_ARP)
+    {
+        HostSim_answerArp(frame);
+    }
+    else if (HostSim_get16(&frame[12]) == ETHTYPE_IP)
+    {
+        const uint8 *ip    = &frame[HOSTSIM_ETH_HDR_LEN];
+        uint16       ihl   = (uint16)((ip[0] & 0x0FU) * 4U);
+        uint16       total = HostSim_get16(&ip[2]);
+
+        if (HostSim_isChecksumValid(ip, (uint16)(length - HOSTSIM_ETH_HDR_LEN)) == FALSE)
+        {
+            stats->badChecksum++;
+        }
+
+        switch (ip[9])
+        {
+        case IP_PROTO_UDP:
+            stats->udpFrames++;
+
+            if ((HostSim_get16(&ip[6]) & 0x1FFFU) == 0)
+            {
+                stats->udpBytes += HostSim_get16(&ip[ihl + 4]) - HOSTSIM_UDP_HDR_LEN;
+            }
+            else
+            {
+                stats->udpBytes += total - ihl;
+            }
+
+            break;
+        case IP_PROTO_ICMP:
+            stats->icmpFrames++;
+            break;
+        case IP_PROTO_TCP:
+            stats->tcpFrames++;
+            break;
+        default:
+            stats->otherFrames++;
+            break;
+        }
+    }
+    else
+    {
+        stats->otherFrames++;
+    }
+
+    if (HostSim_peer.hook != NULL_PTR)
+    {
+        HostSim_peer.hook(HostSim_peer.hookContext, frame, length);
+    }
+}
+
+
+//________________________________________________________________________________________
+// PUBLIC FUNCTIONS
+
+void HostSim_init(void)
+{
+    Ifx_Lwip_Config config;
+    uint8           frame[IFXETH_RTX_BUFFER_SIZE];
+    uint16          length;
+
+    memset(&HostSim_peer, 0, sizeof(HostSim_peer));
+    memset(&HostSim_console, 0, sizeof(HostSim_console));
+    HostSim_console.write = &HostSim_consoleWrite;
+    Ifx_Console_init(&HostSim_console);
+
+    HOSTSIM_LOCAL_IP(&config.ipAddr);
+    HOSTSIM_NETMASK(&config.netMask);
+    HOSTSIM_GATEWAY(&config.gateway);
+    MAC_ADDR(&config.ethAddr, 0x00, 0x20, 0x30, 0x40, 0x50, 0x60);
+    config.arpEntries    = HostSim_arpEntries;    /* else HostSim_resolvePeer() */
+    config.arpEntryCount = HostSim_arpEntryCount;
+
+    initStm0();
+    Ifx_Lwip_init(&config);
+
+    IfxEth_Host_setTxHook(IfxEth_get(), &HostSim_onTransmit, NULL_PTR);
+
+    /* the frames sent by Ifx_Lwip_init(), e.g. the ARP requests of config.arpEntries, were
+     * queued by the IfxEth model before the hook was installed */
+    while ((length = IfxEth_Host_readTransmittedFrame(IfxEth_get(), frame)) != 0)
+    {
+        HostSim_onTransmit(NULL_PTR, frame, length);
+    }
+}
+
+
+/** \brief Sets the ARP entries HostSim_init() passes to Ifx_Lwip_init(), call it before */
+void HostSim_setArpEntries(const Ifx_Lwip_ArpEntry *entries, uint32 count)
+{
+    HostSim_arpEntries    = entries;
+    HostSim_arpEntryCount = count;
+}
+
+
+void HostSim_poll(void)
+{
+    pollStm0();
+    Ifx_Lwip_pollTimerFlags();
+    Ifx_Lwip_pollReceiveFlags();
+}
+
+
+boolean HostSim_resolvePeer(uint32 timeoutMs)
+{
+    ip_addr_t        peerIp;
+    struct eth_addr *ethRet;
+    ip_addr_t       *ipRet;
+    uint64           deadline = HostSim_nowNs() + ((uint64)timeoutMs * 1000000ULL);
+    boolean          queried  = FALSE;
+
+    HOSTSIM_PEER_IP(&peerIp);
+
+    while (etharp_find_addr(Ifx_Lwip_getNetIf(), &peerIp, &ethRet, &ipRet) < 0)
+    {
+        if (HostSim_nowNs() > deadline)
+        {
+            return FALSE;
+        }
+
+        if (queried == FALSE)
+        {
+            etharp_query(Ifx_Lwip_getNetIf(), &peerIp, NULL);
+            queried = TRUE;
+        }
+
+        HostSim_poll();
+    }
+
+    return TRUE;
+}
+
+
+HostSim_PeerStats *HostSim_getPeerStats(void)
+{
+    return &HostSim_peer.stats;
+}
+
+
+void HostSim_resetPeerStats(void)
+{
+    memset(&HostSim_peer.stats, 0, sizeof(HostSim_peer.stats));
+}
+
+
+void HostSim_setFrameHook(HostSim_FrameHook hook, void *context)
+{
+    HostSim_peer.hook        = hook;
+    HostSim_peer.hookContext = context;
+}
+
+
+void HostSim_setLoss(const HostSim_Loss *loss)
+{
+    if (loss != NULL_PTR)
+    {
+        HostSim_peer.loss = *loss;
+    }
+    else
+    {
+        memset(&HostSim_peer.loss, 0, sizeof(HostSim_peer.loss));
+    }
+
+    HostSim_peer.lossState   = HostSim_peer.loss.seed;
+    HostSim_peer.txBurstLeft = 0;
+    HostSim_peer.rxBurstLeft = 0;
+}
+
+
+/** \brief Writes the Ethernet and IP headers of a frame from the peer, returns the IP header */
+static uint8 *HostSim_buildIpHeader(uint8 *frame, uint8 proto, uint16 l4Length)
+{
+    uint8    *ip = &frame[HOSTSIM_ETH_HDR_LEN];
+    ip_addr_t src, dst;
+    uint16    chksum;
+
+    HOSTSIM_PEER_IP(&src);
+    HOSTSIM_LOCAL_IP(&dst);
+
+    memcpy(&frame[0], Ifx_Lwip_getHwAddrPtr(), 6);
+    memcpy(&frame[6], HostSim_peerMac, 6);
+    HostSim_put16(&frame[12], ETHTYPE_IP);
+
+    ip[0] = 0x45;
+    ip[1] = 0;
+    HostSim_put16(&ip[2], (uint16)(HOSTSIM_IP_HDR_LEN + l4Length));
+    HostSim_put16(&ip[4], HostSim_peer.ipId++);
+    HostSim_put16(&ip[6], 0);
+    ip[8] = 64;
+    ip[9] = proto;
+    HostSim_put16(&ip[10], 0);
+    memcpy(&ip[12], &src.addr, 4);
+    memcpy(&ip[16], &dst.addr, 4);
+    chksum = inet_chksum(ip, HOSTSIM_IP_HDR_LEN);
+    memcpy(&ip[10], &chksum, 2);
+
+    return ip;
+}
+
+
+uint16 HostSim_buildUdpFrame(uint8 *frame, uint16 srcPort, uint16 dstPort, const void *payload, uint16 length)
+{
+    uint8 *ip  = HostSim_buildIpHeader(frame, IP_PROTO_UDP, (uint16)(HOSTSIM_UDP_HDR_LEN + length));
+    uint8 *udp = &ip[HOSTSIM_IP_HDR_LEN];
+
+    HostSim_put16(&udp[0], srcPort);
+    HostSim_put16(&udp[2], dstPort);
+    HostSim_put16(&udp[4], (uint16)(HOSTSIM_UDP_HDR_LEN + length));
+    HostSim_put16(&udp[6], 0);                     /* no UDP checksum */
+    memcpy(&udp[HOSTSIM_UDP_HDR_LEN], payload, length);
+
+    return (uint16)(HOSTSIM_ETH_HDR_LEN + HOSTSIM_IP_HDR_LEN + HOSTSIM_UDP_HDR_LEN + length);
+}
+
+
+uint16 HostSim_buildTcpFrame(uint8 *frame, const HostSim_TcpSegment *segment, const void *payload, uint16 length)
+{
+    return HostSim_buildTcpFrameWithOptions(frame, segment, NULL_PTR, 0, payload, length);
+}
+
+
+uint16 HostSim_buildTcpFrameWithOptions(uint8 *frame, const HostSim_TcpSegment *segment, const uint8 *options, uint8 optionsLength, const void *payload, uint16 length)
+{
+    uint16 mssLength = (uint16)((segment->mss != 0) ? 4U : 0U);
+    uint16 hdrLength = (uint16)(HOSTSIM_TCP_HDR_LEN + mssLength + optionsLength);
+    uint16 l4Length  = (uint16)(hdrLength + length);
+    uint8 *ip        = HostSim_buildIpHeader(frame, IP_PROTO_TCP, l4Length);
+    uint8 *tcp       = &ip[HOSTSIM_IP_HDR_LEN];
+    uint32 pseudo;
+
+    HostSim_put16(&tcp[0], segment->srcPort);
+    HostSim_put16(&tcp[2], segment->dstPort);
+    HostSim_put16(&tcp[4], (uint16)(segment->seqno >> 16));
+    HostSim_put16(&tcp[6], (uint16)segment->seqno);
+    HostSim_put16(&tcp[8], (uint16)(segment->ackno >> 16));
+    HostSim_put16(&tcp[10], (uint16)segment->ackno);
+    tcp[12] = (uint8)((hdrLength / 4U) << 4);
+    tcp[13] = segment->flags;
+    HostSim_put16(&tcp[14], segment->window);
+    HostSim_put16(&tcp[16], 0);
+    HostSim_put16(&tcp[18], 0);
+
+    if (segment->mss != 0)
+    {
+        tcp[20] = 2;    /* kind MSS */
+        tcp[21] = 4;
+        HostSim_put16(&tcp[22], segment->mss);
+    }
+
+    if (optionsLength != 0)
+    {
+        memcpy(&tcp[HOSTSIM_TCP_HDR_LEN + mssLength], options, optionsLength);
+    }
+
+    memcpy(&tcp[hdrLength], payload, length);
+
+    pseudo = HostSim_sum(&ip[12], 8, 0) + IP_PROTO_TCP + l4Length;
+    HostSim_put16(&tcp[16], (uint16)~HostSim_sum(tcp, l4Length, pseudo));
+
+    return (uint16)(HOSTSIM_ETH_HDR_LEN + HOSTSIM_IP_HDR_LEN + l4Length);
+}
+
+
+uint16 HostSim_buildFragment(uint8 *frame, const uint8 *datagram, uint16 offset, uint16 length, boolean more)
+{
+    uint8 *ip = &frame[HOSTSIM_ETH_HDR_LEN];
+    uint16 chksum;
+
+    memcpy(frame, datagram, HOSTSIM_ETH_HDR_LEN + HOSTSIM_IP_HDR_LEN);
+    HostSim_put16(&ip[2], (uint16)(HOSTSIM_IP_HDR_LEN + length));
+    HostSim_put16(&ip[6], (uint16)((offset / 8U) | ((more != FALSE) ? IP_MF : 0)));
+    HostSim_put16(&ip[10], 0);
+    chksum = inet_chksum(ip, HOSTSIM_IP_HDR_LEN);
+    memcpy(&ip[10], &chksum, 2);
+    memcpy(&ip[HOSTSIM_IP_HDR_LEN], &datagram[HOSTSIM_ETH_HDR_LEN + HOSTSIM_IP_HDR_LEN + offset], length);
+
+    return (uint16)(HOSTSIM_ETH_HDR_LEN + HOSTSIM_IP_HDR_LEN + length);
+}
+
+
+boolean HostSim_inject(const uint8 *frame, uint16 length)
+{
+    boolean stored;
+
+    if (HostSim_isLost(frame, length, HostSim_peer.loss.rxPpm, &HostSim_peer.rxBurstLeft) != FALSE)
+    {
+        HostSim_peer.stats.rxLost++;
+        return TRUE;
+    }
+
+    stored = IfxEth_Host_receiveFrame(IfxEth_get(), frame, length);
+
+    if (stored != FALSE)
+    {
+        HostSim_peer.stats.injected++;
+    }
+    else
+    {
+        HostSim_peer.stats.injectDropped++;
+    }
+
+    return stored;
+}
+
+
+uint64 HostSim_nowNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return ((uint64)now.tv_sec * 1000000000ULL) + (uint64)now.tv_nsec;
+}
+
+
+const uint8 *HostSim_getPeerMac(void)
+{
+    return HostSim_peerMac;
+}
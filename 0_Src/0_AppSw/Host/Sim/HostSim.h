@@ -0,0 +1,147 @@
+/**
+ * \file HostSim.h
+ * \brief Simulated network peer and main loop helpers of the host (Linux) build
+ *
+ * \license
+ * You can use this file under the terms of the IFX License.
+ *
+ * This file is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the IFX License for more details (IFX_License.txt).
+ *
+ * This file may be used, copied, and distributed, with or without modification, provided
+ * that all copyright notices are retained; that all modifications to this file are
+ * prominently noted in the modified file; and that this paragraph is not modified.
+ *
+ * \copyright Copyright (C) 2013 Infineon Technologies AG
+ *
+ * The peer sits on the other side of the simulated wire. It answers ARP requests for
+ * its own address, counts what the stack transmits and builds frames to inject into
+ * the RX ring of the IfxEth model.
+ */
+
+#ifndef HOSTSIM_H
+#define HOSTSIM_H
+
+//________________________________________________________________________________________
+// INCLUDES
+
+#include "Ifx_Lwip.h"
+
+//________________________________________________________________________________________
+// CONFIGURATION
+
+#define HOSTSIM_LOCAL_IP(addr)  IP4_ADDR(addr, 192, 168, 7, 123)
+#define HOSTSIM_PEER_IP(addr)   IP4_ADDR(addr, 192, 168, 7, 6)
+#define HOSTSIM_NETMASK(addr)   IP4_ADDR(addr, 255, 255, 255, 0)
+#define HOSTSIM_GATEWAY(addr)   IP4_ADDR(addr, 192, 168, 7, 1)
+
+#define HOSTSIM_PEER_UDP_PORT   (5001U)
+
+//________________________________________________________________________________________
+// DATA STRUCTURES
+
+/** \brief Statistics of the simulated peer */
+typedef struct
+{
+    uint32 frames;          /**< \brief All frames seen on the wire */
+    uint32 arpRequests;     /**< \brief ARP requests answered */
+    uint32 arpUnicast;      /**< \brief ARP requests answered which were sent to the peer MAC, not broadcast */
+    uint32 arpReplies;      /**< \brief ARP replies received */
+    uint32 udpFrames;       /**< \brief UDP datagrams received */
+    uint64 udpBytes;        /**< \brief UDP payload bytes received */
+    uint32 icmpFrames;      /**< \brief ICMP messages received */
+    uint32 tcpFrames;       /**< \brief TCP segments received */
+    uint32 otherFrames;     /**< \brief Frames not classified above */
+    uint32 badChecksum;     /**< \brief IPv4 frames with a wrong IP, ICMP, UDP or TCP checksum */
+    uint32 injected;        /**< \brief Frames written into the RX ring */
+    uint32 injectDropped;   /**< \brief Frames rejected by the RX ring */
+    uint32 txLost;          /**< \brief IPv4 frames of the stack lost on the wire, see HostSim_setLoss() */
+    uint32 rxLost;          /**< \brief IPv4 frames of the peer lost on the wire */
+} HostSim_PeerStats;
+
+/** \brief Loss model of the simulated wire, see HostSim_setLoss() */
+typedef struct
+{
+    uint32 txPpm;           /**< \brief Fraction of the IPv4 frames of the stack which are lost, in parts per million */
+    uint32 rxPpm;           /**< \brief Fraction of the IPv4 frames injected by the peer which are lost */
+    uint8  burst;           /**< \brief Frames lost in a row per loss event, 0 or 1 for single losses */
+    uint32 seed;            /**< \brief Seed of the pseudo random sequence, the same seed loses the same frames */
+} HostSim_Loss;
+
+/** \brief TCP header fields of a segment from the peer, see HostSim_buildTcpFrame() */
+typedef struct
+{
+    uint16 srcPort;
+    uint16 dstPort;
+    uint32 seqno;
+    uint32 ackno;
+    uint8  flags;           /**< \brief TCP_SYN, TCP_ACK, ... */
+    uint16 window;
+    uint16 mss;             /**< \brief MSS option of a SYN, 0 for none */
+} HostSim_TcpSegment;
+
+/** \brief Hook called for every frame seen by the peer, after classification */
+typedef void (*HostSim_FrameHook)(void *context, const uint8 *frame, uint16 length);
+
+//________________________________________________________________________________________
+// FUNCTION PROTOTYPES
+
+/** \brief Initialises STM, Ifx_Lwip and the simulated peer */
+IFX_EXTERN void HostSim_init(void);
+
+IFX_EXTERN void HostSim_setArpEntries(const Ifx_Lwip_ArpEntry *entries, uint32 count);
+
+/** \brief One iteration of the target main loop: timer tick emulation, timers and RX */
+IFX_EXTERN void HostSim_poll(void);
+
+/** \brief Polls until the peer MAC address is in the ARP cache or the timeout elapses */
+IFX_EXTERN boolean HostSim_resolvePeer(uint32 timeoutMs);
+
+/** \brief Returns the peer statistics */
+IFX_EXTERN HostSim_PeerStats *HostSim_getPeerStats(void);
+
+/** \brief Clears the peer statistics */
+IFX_EXTERN void HostSim_resetPeerStats(void);
+
+/** \brief Installs an additional frame hook on the peer */
+IFX_EXTERN void HostSim_setFrameHook(HostSim_FrameHook hook, void *context);
+
+/** \brief Builds a UDP datagram from the peer to the local address
+ * \return frame length in bytes
+ */
+IFX_EXTERN uint16 HostSim_buildUdpFrame(uint8 *frame, uint16 srcPort, uint16 dstPort, const void *payload, uint16 length);
+
+/** \brief Builds a TCP segment from the peer to the local address, the only option is the MSS
+ * \return frame length in bytes
+ */
+IFX_EXTERN uint16 HostSim_buildTcpFrame(uint8 *frame, const HostSim_TcpSegment *segment, const void *payload, uint16 length);
+
+/** \brief Builds a TCP segment like HostSim_buildTcpFrame() with further options after the MSS
+ * \param options option bytes, padded with NOPs to a multiple of 4 bytes
+ * \return frame length in bytes
+ */
+IFX_EXTERN uint16 HostSim_buildTcpFrameWithOptions(uint8 *frame, const HostSim_TcpSegment *segment, const uint8 *options, uint8 optionsLength, const void *payload, uint16 length);
+
+/** \brief Builds the IP fragment of "length" bytes at "offset" of a datagram built by
+ * HostSim_buildUdpFrame() or HostSim_buildTcpFrame(), which may exceed the MTU
+ * \param more TRUE for all fragments but the last one
+ * \return frame length in bytes
+ */
+IFX_EXTERN uint16 HostSim_buildFragment(uint8 *frame, const uint8 *datagram, uint16 offset, uint16 length, boolean more);
+
+/** \brief Writes a frame into the RX ring, as if received from the wire
+ * \return FALSE if the RX ring is full, TRUE if stored or lost on the wire (HostSim_setLoss())
+ */
+IFX_EXTERN boolean HostSim_inject(const uint8 *frame, uint16 length);
+
+/** \brief Sets the loss model of the wire, NULL_PTR for a lossless wire. ARP is never lost. */
+IFX_EXTERN void HostSim_setLoss(const HostSim_Loss *loss);
+
+/** \brief Returns a monotonic time stamp in nanoseconds */
+IFX_EXTERN uint64 HostSim_nowNs(void);
+
+/** \brief Returns the MAC address of the peer */
+IFX_EXTERN const uint8 *HostSim_getPeerMac(void);
+
+#endif /* HOSTSIM_H */
@@ -70,6 +70,33 @@
 #if (!LWIP_UDP && LWIP_UDPLITE)
   #error "If you want to use UDP Lite, you have to define LWIP_UDP=1 in your lwipopts.h"
 #endif
+#if ((!LWIP_UDP || !LWIP_ARP) && UDP_FLOW_CACHE)
+  #error "If you want to use UDP_FLOW_CACHE, you have to define LWIP_UDP=1 and LWIP_ARP=1 in your lwipopts.h"
+#endif
+#if (LWIP_ARP && ETHARP_TABLE_HASH && (ETHARP_TABLE_HASH_SIZE & (ETHARP_TABLE_HASH_SIZE - 1)))
+  #error "ETHARP_TABLE_HASH_SIZE must be a power of 2 in your lwipopts.h"
+#endif
+#if (UDP_PCB_HASH && (UDP_PCB_HASH_SIZE & (UDP_PCB_HASH_SIZE - 1)))
+  #error "UDP_PCB_HASH_SIZE must be a power of 2 in your lwipopts.h"
+#endif
+#if (TCP_PCB_HASH && (TCP_PCB_HASH_SIZE & (TCP_PCB_HASH_SIZE - 1)))
+  #error "TCP_PCB_HASH_SIZE must be a power of 2 in your lwipopts.h"
+#endif
+#if (LWIP_TCP && TCP_RCV_AUTOTUNE && (MEMP_MEM_MALLOC || (TCP_RCV_POOL_RESERVE >= PBUF_POOL_SIZE)))
+  #error "TCP_RCV_AUTOTUNE needs the pool allocator and TCP_RCV_POOL_RESERVE < PBUF_POOL_SIZE in your lwipopts.h"
+#endif
+#if (LWIP_TCP && LWIP_TCP_SACK && !LWIP_TCP_CC)
+  #error "LWIP_TCP_SACK requires LWIP_TCP_CC in your lwipopts.h"
+#endif
+#if (LWIP_TCP && TCP_RTO_RFC6298 && !LWIP_TIMER_WHEEL)
+  #error "TCP_RTO_RFC6298 requires LWIP_TIMER_WHEEL in your lwipopts.h"
+#endif
+#if (LWIP_TCP && TCP_RTO_RFC6298 && ((TCP_RTO_MIN < 1) || (TCP_RTO_MIN > TCP_RTO_MAX)))
+  #error "TCP_RTO_MIN must be between 1 and TCP_RTO_MAX in your lwipopts.h"
+#endif
+#if (LWIP_TCP && LWIP_TCP_GSO && !LWIP_SUPPORT_CUSTOM_PBUF)
+  #error "LWIP_TCP_GSO requires LWIP_SUPPORT_CUSTOM_PBUF in your lwipopts.h"
+#endif
 #if (!LWIP_UDP && LWIP_SNMP)
   #error "If you want to use SNMP, you have to define LWIP_UDP=1 in your lwipopts.h"
 #endif
@@ -111,6 +138,12 @@
 #if (IP_REASSEMBLY && (MEMP_NUM_REASSDATA > IP_REASS_MAX_PBUFS))
   #error "MEMP_NUM_REASSDATA > IP_REASS_MAX_PBUFS doesn't make sense since each struct ip_reassdata must hold 2 pbufs at least!"
 #endif
+#if (IP_REASSEMBLY && IP_REASS_HOLES && ((IP_REASS_MAX_HOLES < 1) || (IP_REASS_MAX_HOLES > 0xff)))
+  #error "IP_REASS_MAX_HOLES must be in the range 1..255"
+#endif
+#if (IP_REASSEMBLY && IP_REASS_HOLES && (IP_REASS_MAX_PBUFS_SRC > IP_REASS_MAX_PBUFS))
+  #error "IP_REASS_MAX_PBUFS_SRC > IP_REASS_MAX_PBUFS doesn't make sense"
+#endif
 #endif /* !MEMP_MEM_MALLOC */
 #if (LWIP_TCP && (TCP_WND > 0xffff))
   #error "If you want to use TCP, TCP_WND must fit in an u16_t, so, you have to reduce it in your lwipopts.h"
@@ -157,6 +190,12 @@
 #if (MEM_LIBC_MALLOC && MEM_USE_POOLS)
   #error "MEM_LIBC_MALLOC and MEM_USE_POOLS may not both be simultaneously enabled in your lwipopts.h"
 #endif
+#if (MEMP_NUM_CORE_CACHES && (MEMP_OVERFLOW_CHECK || MEMP_MEM_MALLOC))
+  #error "MEMP_NUM_CORE_CACHES can't be used with MEMP_OVERFLOW_CHECK or MEMP_MEM_MALLOC in your lwipopts.h"
+#endif
+#if (LWIP_TIMER_WHEEL && (!NO_SYS || NO_SYS_NO_TIMERS))
+  #error "LWIP_TIMER_WHEEL requires NO_SYS==1 and NO_SYS_NO_TIMERS==0 in your lwipopts.h"
+#endif
 #if (MEM_USE_POOLS && !MEMP_USE_CUSTOM_POOLS)
   #error "MEM_USE_POOLS requires custom pools (MEMP_USE_CUSTOM_POOLS) to be enabled in your lwipopts.h"
 #endif
@@ -134,13 +134,16 @@ icmp_input(struct pbuf *p, struct netif *inp)
       LWIP_DEBUGF(ICMP_DEBUG, ("icmp_input: bad ICMP echo received\n"));
       goto lenerr;
     }
-    if (inet_chksum_pbuf(p) != 0) {
+#if CHECKSUM_CHECK_ICMP
+    if (IP_CHECKSUM_CHECK_ENABLED(inp, NETIF_CHECKSUM_CHECK_ICMP) &&
+        (inet_chksum_pbuf(p) != 0)) {
       LWIP_DEBUGF(ICMP_DEBUG, ("icmp_input: checksum failed for received ICMP echo\n"));
       pbuf_free(p);
       ICMP_STATS_INC(icmp.chkerr);
       snmp_inc_icmpinerrors();
       return;
     }
+#endif /* CHECKSUM_CHECK_ICMP */
 #if LWIP_ICMP_ECHO_CHECK_INPUT_PBUF_LEN
     if (pbuf_header(p, (PBUF_IP_HLEN + PBUF_LINK_HLEN))) {
       /* p is not big enough to contain link headers
@@ -205,7 +208,9 @@ icmp_input(struct pbuf *p, struct netif *inp)
     IPH_TTL_SET(iphdr, ICMP_TTL);
     IPH_CHKSUM_SET(iphdr, 0);
 #if CHECKSUM_GEN_IP
-    IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+    if (NETIF_CHECKSUM_ENABLED(inp, NETIF_CHECKSUM_GEN_IP)) {
+      IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+    }
 #endif /* CHECKSUM_GEN_IP */
 
     ICMP_STATS_INC(icmp.xmit);
@@ -295,6 +300,7 @@ icmp_send_response(struct pbuf *p, u8_t type, u8_t code)
   /* we can use the echo header here */
   struct icmp_echo_hdr *icmphdr;
   ip_addr_t iphdr_src;
+  struct netif *netif;
 
   /* ICMP header + IP header + 8 bytes of data */
   q = pbuf_alloc(PBUF_IP, sizeof(struct icmp_echo_hdr) + IP_HLEN + ICMP_DEST_UNREACH_DATASIZE,
@@ -323,16 +329,28 @@ icmp_send_response(struct pbuf *p, u8_t type, u8_t code)
   SMEMCPY((u8_t *)q->payload + sizeof(struct icmp_echo_hdr), (u8_t *)p->payload,
           IP_HLEN + ICMP_DEST_UNREACH_DATASIZE);
 
+  ip_addr_copy(iphdr_src, iphdr->src);
+  /* route first: the checksum depends on the capabilities of the output netif */
+  netif = ip_route(&iphdr_src);
+  if (netif == NULL) {
+    LWIP_DEBUGF(ICMP_DEBUG, ("icmp_send_response: no route to the sender.\n"));
+    pbuf_free(q);
+    return;
+  }
+
   /* calculate checksum */
   icmphdr->chksum = 0;
-  icmphdr->chksum = inet_chksum(icmphdr, q->len);
+#if CHECKSUM_GEN_ICMP
+  if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_ICMP)) {
+    icmphdr->chksum = inet_chksum(icmphdr, q->len);
+  }
+#endif /* CHECKSUM_GEN_ICMP */
   ICMP_STATS_INC(icmp.xmit);
   /* increase number of messages attempted to send */
   snmp_inc_icmpoutmsgs();
   /* increase number of destination unreachable messages attempted to send */
   snmp_inc_icmpouttimeexcds();
-  ip_addr_copy(iphdr_src, iphdr->src);
-  ip_output(q, NULL, &iphdr_src, ICMP_TTL, 0, IP_PROTO_ICMP);
+  ip_output_if(q, NULL, &iphdr_src, ICMP_TTL, 0, IP_PROTO_ICMP, netif);
   pbuf_free(q);
 }
 
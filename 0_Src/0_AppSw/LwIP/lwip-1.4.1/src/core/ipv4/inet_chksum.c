@@ -52,7 +52,12 @@
  * #define LWIP_CHKSUM <your_checksum_routine> 
  *
  * Or you can select from the implementations below by defining
- * LWIP_CHKSUM_ALGORITHM to 1, 2 or 3.
+ * LWIP_CHKSUM_ALGORITHM to 1, 2, 3 or 4.
+ *
+ * With LWIP_CHKSUM_ALGORITHM_ALL, all implementations are compiled and
+ * exported as lwip_chksum_alg1() .. lwip_chksum_alg4() (and the copy
+ * variants as lwip_chksum_copy_alg1(), lwip_chksum_copy_alg2()) so that
+ * they can be compared on the target.
  */
 
 #ifndef LWIP_CHKSUM
@@ -66,7 +71,31 @@
 # define LWIP_CHKSUM_ALGORITHM 0
 #endif
 
-#if (LWIP_CHKSUM_ALGORITHM == 1) /* Version #1 */
+#if LWIP_CHKSUM_ALGORITHM_ALL
+# define LWIP_CHKSUM_ALG_STATIC
+#else
+# define LWIP_CHKSUM_ALG_STATIC static
+#endif
+
+/** Fold a 64-bit accumulator of 32-bit words to a 16-bit Internet sum */
+#define LWIP_CHKSUM_FOLD_U64T(sum, res) do { \
+  (sum) = ((sum) >> 32) + ((sum) & 0xffffffffULL); \
+  (sum) = ((sum) >> 32) + ((sum) & 0xffffffffULL); \
+  (res) = (u32_t)(sum); \
+  (res) = FOLD_U32T(res); \
+  (res) = FOLD_U32T(res); } while(0)
+
+#if (LWIP_CHKSUM_ALGORITHM == 1)
+# define lwip_standard_chksum lwip_chksum_alg1
+#elif (LWIP_CHKSUM_ALGORITHM == 2)
+# define lwip_standard_chksum lwip_chksum_alg2
+#elif (LWIP_CHKSUM_ALGORITHM == 3)
+# define lwip_standard_chksum lwip_chksum_alg3
+#elif (LWIP_CHKSUM_ALGORITHM == 4)
+# define lwip_standard_chksum lwip_chksum_alg4
+#endif
+
+#if (LWIP_CHKSUM_ALGORITHM == 1) || LWIP_CHKSUM_ALGORITHM_ALL /* Version #1 */
 /**
  * lwip checksum
  *
@@ -77,8 +106,8 @@
  * @note accumulator size limits summable length to 64k
  * @note host endianess is irrelevant (p3 RFC1071)
  */
-static u16_t
-lwip_standard_chksum(void *dataptr, u16_t len)
+LWIP_CHKSUM_ALG_STATIC u16_t
+lwip_chksum_alg1(void *dataptr, u16_t len)
 {
   u32_t acc;
   u16_t src;
@@ -115,7 +144,7 @@ lwip_standard_chksum(void *dataptr, u16_t len)
 }
 #endif
 
-#if (LWIP_CHKSUM_ALGORITHM == 2) /* Alternative version #2 */
+#if (LWIP_CHKSUM_ALGORITHM == 2) || LWIP_CHKSUM_ALGORITHM_ALL /* Alternative version #2 */
 /*
  * Curt McDowell
  * Broadcom Corp.
@@ -131,8 +160,8 @@ lwip_standard_chksum(void *dataptr, u16_t len)
  * @return host order (!) lwip checksum (non-inverted Internet sum) 
  */
 
-static u16_t
-lwip_standard_chksum(void *dataptr, int len)
+LWIP_CHKSUM_ALG_STATIC u16_t
+lwip_chksum_alg2(void *dataptr, int len)
 {
   u8_t *pb = (u8_t *)dataptr;
   u16_t *ps, t = 0;
@@ -174,7 +203,7 @@ lwip_standard_chksum(void *dataptr, int len)
 }
 #endif
 
-#if (LWIP_CHKSUM_ALGORITHM == 3) /* Alternative version #3 */
+#if (LWIP_CHKSUM_ALGORITHM == 3) || LWIP_CHKSUM_ALGORITHM_ALL /* Alternative version #3 */
 /**
  * An optimized checksum routine. Basically, it uses loop-unrolling on
  * the checksum loop, treating the head and tail bytes specially, whereas
@@ -187,8 +216,8 @@ lwip_standard_chksum(void *dataptr, int len)
  * by Curt McDowell, Broadcom Corp. December 8th, 2005
  */
 
-static u16_t
-lwip_standard_chksum(void *dataptr, int len)
+LWIP_CHKSUM_ALG_STATIC u16_t
+lwip_chksum_alg3(void *dataptr, int len)
 {
   u8_t *pb = (u8_t *)dataptr;
   u16_t *ps, t = 0;
@@ -256,6 +285,82 @@ lwip_standard_chksum(void *dataptr, int len)
 }
 #endif
 
+#if (LWIP_CHKSUM_ALGORITHM == 4) || LWIP_CHKSUM_ALGORITHM_ALL /* Alternative version #4 */
+/**
+ * Word-at-a-time version of #3: the aligned part of the buffer is read as
+ * 32-bit words into a 64-bit accumulator, so no carry has to be handled
+ * in the loop, which is unrolled to 16 bytes per iteration. The
+ * accumulator can't overflow for any length lwIP passes.
+ * Requires u64_t to be defined in cc.h.
+ *
+ * @param dataptr start of buffer to be checksummed. May be an odd byte address.
+ * @param len number of bytes in the buffer to be checksummed.
+ * @return host order (!) lwip checksum (non-inverted Internet sum)
+ */
+LWIP_CHKSUM_ALG_STATIC u16_t
+lwip_chksum_alg4(void *dataptr, int len)
+{
+  u8_t *pb = (u8_t *)dataptr;
+  u16_t *ps, t = 0;
+  u32_t *pl;
+  u64_t sum = 0;
+  u32_t res;
+  /* starts at odd byte address? */
+  int odd = ((mem_ptr_t)pb & 1);
+
+  if (odd && len > 0) {
+    ((u8_t *)&t)[1] = *pb++;
+    len--;
+  }
+
+  ps = (u16_t *)(void *)pb;
+
+  if (((mem_ptr_t)ps & 3) && len > 1) {
+    sum += *ps++;
+    len -= 2;
+  }
+
+  pl = (u32_t *)(void *)ps;
+
+  while (len > 15) {
+    sum += pl[0];
+    sum += pl[1];
+    sum += pl[2];
+    sum += pl[3];
+    pl += 4;
+    len -= 16;
+  }
+
+  while (len > 3) {
+    sum += *pl++;
+    len -= 4;
+  }
+
+  ps = (u16_t *)(void *)pl;
+
+  /* 16-bit aligned word remaining? */
+  if (len > 1) {
+    sum += *ps++;
+    len -= 2;
+  }
+
+  /* dangling tail byte remaining? */
+  if (len > 0) {
+    ((u8_t *)&t)[0] = *(u8_t *)ps;
+  }
+
+  sum += t;
+
+  LWIP_CHKSUM_FOLD_U64T(sum, res);
+
+  if (odd) {
+    res = SWAP_BYTES_IN_WORD(res);
+  }
+
+  return (u16_t)res;
+}
+#endif
+
 /* inet_chksum_pseudo:
  *
  * Calculates the pseudo Internet checksum used by TCP and UDP for a pbuf chain.
@@ -270,7 +375,7 @@ lwip_standard_chksum(void *dataptr, int len)
  */
 u16_t
 inet_chksum_pseudo(struct pbuf *p,
-       ip_addr_t *src, ip_addr_t *dest,
+       const ip_addr_t *src, const ip_addr_t *dest,
        u8_t proto, u16_t proto_len)
 {
   u32_t acc;
@@ -330,7 +435,7 @@ inet_chksum_pseudo(struct pbuf *p,
  */
 u16_t
 inet_chksum_pseudo_partial(struct pbuf *p,
-       ip_addr_t *src, ip_addr_t *dest,
+       const ip_addr_t *src, const ip_addr_t *dest,
        u8_t proto, u16_t proto_len, u16_t chksum_len)
 {
   u32_t acc;
@@ -429,6 +534,28 @@ inet_chksum_pbuf(struct pbuf *p)
   return (u16_t)~(acc & 0xffffUL);
 }
 
+/**
+ * Updates a checksum for one changed 16 bit word without summing the data
+ * again (RFC 1624, eqn. 3: HC' = ~(~HC + ~m + m')).
+ *
+ * @param chksum checksum as stored in the header (HC)
+ * @param old_word previous value of the word (m), in network byte order
+ * @param new_word new value of the word (m'), in network byte order
+ * @return the new checksum (HC')
+ */
+u16_t
+inet_chksum_adjust(u16_t chksum, u16_t old_word, u16_t new_word)
+{
+  u32_t acc;
+
+  acc = (u16_t)~chksum;
+  acc += (u16_t)~old_word;
+  acc += new_word;
+  acc = FOLD_U32T(acc);
+  acc = FOLD_U32T(acc);
+  return (u16_t)~(acc & 0xffffUL);
+}
+
 /* These are some implementations for LWIP_CHKSUM_COPY, which copies data
  * like MEMCPY but generates a checksum at the same time. Since this is a
  * performance-sensitive function, you might want to create your own version
@@ -436,15 +563,114 @@ inet_chksum_pbuf(struct pbuf *p)
  *   #define LWIP_CHKSUM_COPY(dst, src, len) your_chksum_copy(dst, src, len)
  */
 
-#if (LWIP_CHKSUM_COPY_ALGORITHM == 1) /* Version #1 */
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 1) || LWIP_CHKSUM_ALGORITHM_ALL /* Version #1 */
 /** Safe but slow: first call MEMCPY, then call LWIP_CHKSUM.
  * For architectures with big caches, data might still be in cache when
  * generating the checksum after copying.
  */
 u16_t
-lwip_chksum_copy(void *dst, const void *src, u16_t len)
+lwip_chksum_copy_alg1(void *dst, const void *src, u16_t len)
 {
   MEMCPY(dst, src, len);
   return LWIP_CHKSUM(dst, len);
 }
 #endif /* (LWIP_CHKSUM_COPY_ALGORITHM == 1) */
+
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 2) || LWIP_CHKSUM_ALGORITHM_ALL /* Version #2 */
+/** Single pass: the data is summed while it is copied, 32-bit words into a
+ * 64-bit accumulator as in LWIP_CHKSUM_ALGORITHM 4. Source and destination
+ * must have the same alignment modulo 4 for the word loop; otherwise this
+ * falls back to version #1. Requires u64_t to be defined in cc.h.
+ */
+u16_t
+lwip_chksum_copy_alg2(void *dst, const void *src, u16_t len)
+{
+  const u8_t *sb = (const u8_t *)src;
+  u8_t *db = (u8_t *)dst;
+  const u32_t *sl;
+  u32_t *dl;
+  u16_t t = 0;
+  u64_t sum = 0;
+  u32_t res, w0, w1, w2, w3;
+  int odd;
+
+  if (((mem_ptr_t)sb ^ (mem_ptr_t)db) & 3) {
+    MEMCPY(dst, src, len);
+    return LWIP_CHKSUM(dst, len);
+  }
+
+  /* starts at odd byte address? */
+  odd = ((mem_ptr_t)sb & 1);
+  if (odd && len > 0) {
+    ((u8_t *)&t)[1] = *sb;
+    *db++ = *sb++;
+    len--;
+  }
+
+  if (((mem_ptr_t)sb & 3) && len > 1) {
+    w0 = *(const u16_t *)(const void *)sb;
+    *(u16_t *)(void *)db = (u16_t)w0;
+    sum += w0;
+    sb += 2;
+    db += 2;
+    len -= 2;
+  }
+
+  sl = (const u32_t *)(const void *)sb;
+  dl = (u32_t *)(void *)db;
+
+  while (len > 15) {
+    w0 = sl[0];
+    w1 = sl[1];
+    w2 = sl[2];
+    w3 = sl[3];
+    dl[0] = w0;
+    dl[1] = w1;
+    dl[2] = w2;
+    dl[3] = w3;
+    sum += w0;
+    sum += w1;
+    sum += w2;
+    sum += w3;
+    sl += 4;
+    dl += 4;
+    len -= 16;
+  }
+
+  while (len > 3) {
+    w0 = *sl++;
+    *dl++ = w0;
+    sum += w0;
+    len -= 4;
+  }
+
+  sb = (const u8_t *)sl;
+  db = (u8_t *)dl;
+
+  /* 16-bit aligned word remaining? */
+  if (len > 1) {
+    w0 = *(const u16_t *)(const void *)sb;
+    *(u16_t *)(void *)db = (u16_t)w0;
+    sum += w0;
+    sb += 2;
+    db += 2;
+    len -= 2;
+  }
+
+  /* dangling tail byte remaining? */
+  if (len > 0) {
+    ((u8_t *)&t)[0] = *sb;
+    *db = *sb;
+  }
+
+  sum += t;
+
+  LWIP_CHKSUM_FOLD_U64T(sum, res);
+
+  if (odd) {
+    res = SWAP_BYTES_IN_WORD(res);
+  }
+
+  return (u16_t)res;
+}
+#endif /* (LWIP_CHKSUM_COPY_ALGORITHM == 2) */
@@ -107,10 +107,28 @@ const struct ip_hdr *current_header;
 ip_addr_t current_iphdr_src;
 /** Destination IP address of current_header */
 ip_addr_t current_iphdr_dest;
+#if IP_CHECKSUM_CHECK_REASSEMBLED
+/** current_header belongs to a datagram reassembled from fragments */
+u8_t current_iphdr_reassembled;
+#endif /* IP_CHECKSUM_CHECK_REASSEMBLED */
 
 /** The IP header ID of the next outgoing IP packet */
 static u16_t ip_id;
 
+#if UDP_FLOW_CACHE
+/**
+ * Returns the IP header ID for an outgoing packet whose header is not built
+ * by ip_output_if(), sharing the sequence of ip_output_if().
+ *
+ * @return the ID in host byte order
+ */
+u16_t
+ip_next_id(void)
+{
+  return ip_id++;
+}
+#endif /* UDP_FLOW_CACHE */
+
 /**
  * Finds the appropriate network interface for a given IP address. It
  * searches the list of network interfaces linearly. A match is found
@@ -363,7 +381,8 @@ ip_input(struct pbuf *p, struct netif *inp)
 
   /* verify checksum */
 #if CHECKSUM_CHECK_IP
-  if (inet_chksum(iphdr, iphdr_hlen) != 0) {
+  if (NETIF_CHECKSUM_ENABLED(inp, NETIF_CHECKSUM_CHECK_IP) &&
+      (inet_chksum(iphdr, iphdr_hlen) != 0)) {
 
     LWIP_DEBUGF(IP_DEBUG | LWIP_DBG_LEVEL_SERIOUS,
       ("Checksum (0x%"X16_F") failed, IP packet dropped.\n", inet_chksum(iphdr, iphdr_hlen)));
@@ -515,6 +534,11 @@ ip_input(struct pbuf *p, struct netif *inp)
       return ERR_OK;
     }
     iphdr = (struct ip_hdr *)p->payload;
+#if IP_CHECKSUM_CHECK_REASSEMBLED
+    /* checksum offload engines only verify the transport header of
+       unfragmented datagrams: check this one in software */
+    current_iphdr_reassembled = 1;
+#endif /* IP_CHECKSUM_CHECK_REASSEMBLED */
 #else /* IP_REASSEMBLY == 0, no packet fragment reassembly code present */
     pbuf_free(p);
     LWIP_DEBUGF(IP_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("IP packet dropped since it was fragmented (0x%"X16_F") (while IP_REASSEMBLY == 0).\n",
@@ -608,6 +632,9 @@ ip_input(struct pbuf *p, struct netif *inp)
   current_header = NULL;
   ip_addr_set_any(&current_iphdr_src);
   ip_addr_set_any(&current_iphdr_dest);
+#if IP_CHECKSUM_CHECK_REASSEMBLED
+  current_iphdr_reassembled = 0;
+#endif /* IP_CHECKSUM_CHECK_REASSEMBLED */
 
   return ERR_OK;
 }
@@ -740,7 +767,15 @@ err_t ip_output_if_opt(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
 #if CHECKSUM_GEN_IP_INLINE
     chk_sum += iphdr->_id;
 #endif /* CHECKSUM_GEN_IP_INLINE */
-    ++ip_id;
+#if LWIP_TCP_GSO
+    if (p->flags & PBUF_FLAG_GSO) {
+      /* the segments the netif cuts from a super-segment take the following IDs */
+      ip_id += ((struct pbuf_gso *)p)->gso_segs;
+    } else
+#endif /* LWIP_TCP_GSO */
+    {
+      ++ip_id;
+    }
 
     if (ip_addr_isany(src)) {
       ip_addr_copy(iphdr->src, netif->ip_addr);
@@ -755,11 +790,17 @@ err_t ip_output_if_opt(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
     chk_sum = (chk_sum >> 16) + (chk_sum & 0xFFFF);
     chk_sum = (chk_sum >> 16) + chk_sum;
     chk_sum = ~chk_sum;
-    iphdr->_chksum = (u16_t) chk_sum; /* network order */
+    if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_IP)) {
+      iphdr->_chksum = (u16_t) chk_sum; /* network order */
+    } else {
+      IPH_CHKSUM_SET(iphdr, 0);
+    }
 #else /* CHECKSUM_GEN_IP_INLINE */
     IPH_CHKSUM_SET(iphdr, 0);
 #if CHECKSUM_GEN_IP
-    IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, ip_hlen));
+    if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_IP)) {
+      IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, ip_hlen));
+    }
 #endif
 #endif /* CHECKSUM_GEN_IP_INLINE */
   } else {
@@ -787,8 +828,8 @@ err_t ip_output_if_opt(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
 #endif /* LWIP_IGMP */
 #endif /* ENABLE_LOOPBACK */
 #if IP_FRAG
-  /* don't fragment if interface has mtu set to 0 [loopif] */
-  if (netif->mtu && (p->tot_len > netif->mtu)) {
+  /* don't fragment if interface has mtu set to 0 [loopif], nor a super-segment */
+  if (netif->mtu && (p->tot_len > netif->mtu) && ((p->flags & PBUF_FLAG_GSO) == 0)) {
     return ip_frag(p, netif, dest);
   }
 #endif /* IP_FRAG */
@@ -855,7 +896,7 @@ ip_output(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
  */
 err_t
 ip_output_hinted(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
-          u8_t ttl, u8_t tos, u8_t proto, u8_t *addr_hint)
+          u8_t ttl, u8_t tos, u8_t proto, netif_addr_idx_t *addr_hint)
 {
   struct netif *netif;
   err_t err;
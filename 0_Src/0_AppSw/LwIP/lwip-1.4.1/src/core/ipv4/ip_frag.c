@@ -70,13 +70,19 @@
 /** Set to 0 to prevent freeing the oldest datagram when the reassembly buffer is
  * full (IP_REASS_MAX_PBUFS pbufs are enqueued). The code gets a little smaller.
  * Datagrams will be freed by timeout only. Especially useful when MEMP_NUM_REASSDATA
- * is set to 1, so one datagram can be reassembled at a time, only. */
+ * is set to 1, so one datagram can be reassembled at a time, only.
+ * IP_REASS_HOLES always frees the datagram which waited longest for a fragment. */
 #ifndef IP_REASS_FREE_OLDEST
 #define IP_REASS_FREE_OLDEST 1
 #endif /* IP_REASS_FREE_OLDEST */
 
 #define IP_REASS_FLAG_LASTFRAG 0x01
 
+#if IP_REASS_HOLES
+/** ip_reass_hole.last of the hole behind the data until the last fragment arrived */
+#define IP_REASS_HOLE_OPEN 0xffff
+#endif /* IP_REASS_HOLES */
+
 /** This is a helper struct which holds the starting
  * offset and the ending offset of this fragment to
  * easily chain the fragments.
@@ -107,6 +113,12 @@ PACK_STRUCT_END
 /* global variables */
 static struct ip_reassdata *reassdatagrams;
 static u16_t ip_reass_pbufcount;
+#if IP_REASS_HOLES
+/** Number of fragments queued so far, wraps around */
+static u16_t ip_reass_inputs;
+#endif /* IP_REASS_HOLES */
+
+struct ip_reass_stats ip_reass_stats;
 
 /* function prototypes */
 static void ip_reass_dequeue_datagram(struct ip_reassdata *ipr, struct ip_reassdata *prev);
@@ -139,6 +151,7 @@ ip_reass_tmr(void)
       tmp = r;
       /* get the next pointer before freeing */
       r = r->next;
+      ip_reass_stats.timeouts++;
       /* free the helper struct and all enqueued pbufs */
       ip_reass_free_complete_datagram(tmp, prev);
      }
@@ -207,7 +220,7 @@ ip_reass_free_complete_datagram(struct ip_reassdata *ipr, struct ip_reassdata *p
   return pbufs_freed;
 }
 
-#if IP_REASS_FREE_OLDEST
+#if IP_REASS_FREE_OLDEST && !IP_REASS_HOLES
 /**
  * Free the oldest datagram to make room for enqueueing new fragments.
  * The datagram 'fraghdr' belongs to is not freed!
@@ -251,13 +264,133 @@ ip_reass_remove_oldest_datagram(struct ip_hdr *fraghdr, int pbufs_needed)
       r = r->next;
     }
     if (oldest != NULL) {
+      ip_reass_stats.evicted++;
       pbufs_freed_current = ip_reass_free_complete_datagram(oldest, prev);
       pbufs_freed += pbufs_freed_current;
     }
   } while ((pbufs_freed < pbufs_needed) && (other_datagrams > 1));
   return pbufs_freed;
 }
-#endif /* IP_REASS_FREE_OLDEST */
+#endif /* IP_REASS_FREE_OLDEST && !IP_REASS_HOLES */
+
+#if IP_REASS_HOLES
+/**
+ * Free the datagram which waited longest for its next fragment. The datagram
+ * 'fraghdr' belongs to is not freed!
+ *
+ * @param fraghdr IP header of the current fragment
+ * @param same_src only free a datagram from the source of 'fraghdr'
+ * @return 1 if a datagram was freed, 0 if there was none to free
+ */
+static int
+ip_reass_evict(struct ip_hdr *fraghdr, u8_t same_src)
+{
+  struct ip_reassdata *r, *prev = NULL, *victim = NULL, *victim_prev = NULL;
+  u16_t idle, victim_idle = 0;
+
+  for (r = reassdatagrams; r != NULL; prev = r, r = r->next) {
+    if ((IP_ADDRESSES_AND_ID_MATCH(&r->iphdr, fraghdr)) ||
+        (same_src && !ip_addr_cmp(&r->iphdr.src, &fraghdr->src))) {
+      continue;
+    }
+    idle = (u16_t)(ip_reass_inputs - r->input);
+    if ((victim == NULL) || (idle >= victim_idle)) {
+      victim = r;
+      victim_prev = prev;
+      victim_idle = idle;
+    }
+  }
+  if (victim == NULL) {
+    return 0;
+  }
+  LWIP_DEBUGF(IP_REASS_DEBUG, ("ip_reass_evict: datagram idle for %"U16_F" fragments\n", victim_idle));
+  ip_reass_stats.evicted++;
+  ip_reass_free_complete_datagram(victim, victim_prev);
+  return 1;
+}
+
+#if IP_REASS_EVICT_IDLE
+/**
+ * Free the datagrams from the source of 'fraghdr' which did not get any of
+ * the last IP_REASS_EVICT_IDLE fragments queued. Called for the first fragment
+ * of a new datagram: the source went on, so a fragment of the idle datagrams
+ * was most likely lost.
+ *
+ * @param fraghdr IP header of the first fragment of a new datagram
+ */
+static void
+ip_reass_evict_idle(struct ip_hdr *fraghdr)
+{
+  struct ip_reassdata *r = reassdatagrams, *prev = NULL, *next;
+
+  while (r != NULL) {
+    next = r->next;
+    if (ip_addr_cmp(&r->iphdr.src, &fraghdr->src) &&
+        ((u16_t)(ip_reass_inputs - r->input) >= IP_REASS_EVICT_IDLE)) {
+      ip_reass_stats.evicted++;
+      ip_reass_free_complete_datagram(r, prev);
+    } else {
+      prev = r;
+    }
+    r = next;
+  }
+}
+#endif /* IP_REASS_EVICT_IDLE */
+
+/**
+ * Free datagrams until 'clen' more pbufs fit into IP_REASS_MAX_PBUFS_SRC for
+ * the source of 'fraghdr' and into IP_REASS_MAX_PBUFS. The datagram 'fraghdr'
+ * belongs to is not freed!
+ *
+ * @param fraghdr IP header of the current fragment
+ * @param clen number of pbufs needed to enqueue
+ * @return 1 if the pbufs fit, 0 if the fragment has to be dropped
+ */
+static int
+ip_reass_make_room(struct ip_hdr *fraghdr, u16_t clen)
+{
+  struct ip_reassdata *r;
+  u16_t src_pbufs;
+
+  /* the source can only exceed its share if all sources together do */
+  if ((ip_reass_pbufcount + clen) > IP_REASS_MAX_PBUFS_SRC) {
+    do {
+      src_pbufs = 0;
+      for (r = reassdatagrams; r != NULL; r = r->next) {
+        if (ip_addr_cmp(&r->iphdr.src, &fraghdr->src)) {
+          src_pbufs += r->pbufs;
+        }
+      }
+    } while (((src_pbufs + clen) > IP_REASS_MAX_PBUFS_SRC) && ip_reass_evict(fraghdr, 1));
+    if ((src_pbufs + clen) > IP_REASS_MAX_PBUFS_SRC) {
+      return 0;
+    }
+  }
+  while ((ip_reass_pbufcount + clen) > IP_REASS_MAX_PBUFS) {
+    if (!ip_reass_evict(fraghdr, 0)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/**
+ * Return the datagram in front of 'ipr' in reassdatagrams, NULL for the first.
+ */
+static struct ip_reassdata *
+ip_reass_prev_datagram(struct ip_reassdata *ipr)
+{
+  struct ip_reassdata *prev;
+
+  if (reassdatagrams == ipr) {
+    return NULL;
+  }
+  for (prev = reassdatagrams; prev->next != ipr; prev = prev->next) {
+    LWIP_ASSERT("ipr is queued", prev->next != NULL);
+  }
+  return prev;
+}
+#endif /* IP_REASS_HOLES */
 
 /**
  * Enqueues a new fragment into the fragment queue
@@ -272,7 +405,12 @@ ip_reass_enqueue_new_datagram(struct ip_hdr *fraghdr, int clen)
   /* No matching previous fragment found, allocate a new reassdata struct */
   ipr = (struct ip_reassdata *)memp_malloc(MEMP_REASSDATA);
   if (ipr == NULL) {
-#if IP_REASS_FREE_OLDEST
+#if IP_REASS_HOLES
+    if (ip_reass_evict(fraghdr, 0)) {
+      ipr = (struct ip_reassdata *)memp_malloc(MEMP_REASSDATA);
+    }
+    if (ipr == NULL)
+#elif IP_REASS_FREE_OLDEST
     if (ip_reass_remove_oldest_datagram(fraghdr, clen) >= clen) {
       ipr = (struct ip_reassdata *)memp_malloc(MEMP_REASSDATA);
     }
@@ -286,6 +424,11 @@ ip_reass_enqueue_new_datagram(struct ip_hdr *fraghdr, int clen)
   }
   memset(ipr, 0, sizeof(struct ip_reassdata));
   ipr->timer = IP_REASS_MAXAGE;
+#if IP_REASS_HOLES
+  /* the whole datagram is missing */
+  ipr->hole_count = 1;
+  ipr->holes[0].last = IP_REASS_HOLE_OPEN;
+#endif /* IP_REASS_HOLES */
 
   /* enqueue the new structure to the front of the list */
   ipr->next = reassdatagrams;
@@ -318,6 +461,7 @@ ip_reass_dequeue_datagram(struct ip_reassdata *ipr, struct ip_reassdata *prev)
   memp_free(MEMP_REASSDATA, ipr);
 }
 
+#if !IP_REASS_HOLES
 /**
  * Chain a new pbuf into the pbuf list that composes the datagram.  The pbuf list
  * will grow over time as  new pbufs are rx.
@@ -367,6 +511,11 @@ ip_reass_chain_frag_into_datagram_and_validate(struct ip_reassdata *ipr, struct
         }
 #endif /* IP_REASS_CHECK_OVERLAP */
         iprh_prev->next_pbuf = new_p;
+        if (iprh_prev->end != iprh->start) {
+          /* There is a fragment missing between the previous
+           * and the current fragment */
+          valid = 0;
+        }
       } else {
         /* fragment with the lowest offset */
         ipr->p = new_p;
@@ -460,11 +609,171 @@ ip_reass_chain_frag_into_datagram_and_validate(struct ip_reassdata *ipr, struct
   return 0; /* not yet valid! */
 #if IP_REASS_CHECK_OVERLAP
 freepbuf:
+  ip_reass_stats.duplicates++;
   ip_reass_pbufcount -= pbuf_clen(new_p);
   pbuf_free(new_p);
   return 0;
 #endif /* IP_REASS_CHECK_OVERLAP */
 }
+#else /* !IP_REASS_HOLES */
+/**
+ * Find the hole of a datagram a new fragment falls into. The hole the previous
+ * fragment fell into is tried first: in order and reverse order streams
+ * always find it there.
+ *
+ * @param ipr datagram the fragment belongs to
+ * @param start offset of the fragment data in the datagram
+ * @param end offset behind the fragment data
+ * @param last nonzero if IP_MF is not set
+ * @return index of the hole or -1 if the fragment must not be queued: it was
+ *         received already, overlaps data received or would open too many holes
+ */
+static int
+ip_reass_find_hole(struct ip_reassdata *ipr, u16_t start, u16_t end, u8_t last)
+{
+  struct ip_reass_hole *hole;
+  int i = ipr->hole_hint;
+
+  if ((i >= ipr->hole_count) || (start < ipr->holes[i].first) || (start >= ipr->holes[i].last)) {
+    for (i = 0; i < ipr->hole_count; i++) {
+      if ((start >= ipr->holes[i].first) && (start < ipr->holes[i].last)) {
+        break;
+      }
+    }
+    if (i == ipr->hole_count) {
+      /* received already */
+      return -1;
+    }
+  }
+  hole = &ipr->holes[i];
+  if ((end <= start) || (end > hole->last) || (last && (hole->last != IP_REASS_HOLE_OPEN))) {
+    /* empty, overlapping the data behind the hole or data behind the last fragment */
+    return -1;
+  }
+  if ((start > hole->first) && !last && (end < hole->last) && (ipr->hole_count == IP_REASS_MAX_HOLES)) {
+    /* in the middle of the hole, which would be split in two */
+    return -1;
+  }
+  return i;
+}
+
+/**
+ * Chain a new fragment into the datagram behind the fragment in front of its
+ * hole and shrink, split or close the hole (RFC 815). The pbuf list stays
+ * sorted by offset without walking it.
+ *
+ * @param ipr datagram the fragment belongs to
+ * @param i index of the hole, from ip_reass_find_hole()
+ * @param new_p points to the pbuf for the current fragment
+ * @param start offset of the fragment data in the datagram
+ * @param end offset behind the fragment data
+ * @param last nonzero if IP_MF is not set
+ * @return 1 if all fragments are received, 0 otherwise
+ */
+static int
+ip_reass_fill_hole(struct ip_reassdata *ipr, int i, struct pbuf *new_p, u16_t start, u16_t end, u8_t last)
+{
+  struct ip_reass_hole *hole = &ipr->holes[i];
+  struct ip_reass_helper *iprh, *iprh_prev;
+  u8_t left = (start > hole->first);
+  u8_t right = (!last && (end < hole->last));
+
+  /* overwrite the fragment's ip header with our helper struct */
+  LWIP_ASSERT("sizeof(struct ip_reass_helper) <= IP_HLEN",
+              sizeof(struct ip_reass_helper) <= IP_HLEN);
+  iprh = (struct ip_reass_helper*)new_p->payload;
+  iprh->start = start;
+  iprh->end = end;
+  if (hole->prev == NULL) {
+    iprh->next_pbuf = ipr->p;
+    ipr->p = new_p;
+  } else {
+    iprh_prev = (struct ip_reass_helper*)hole->prev->payload;
+    iprh->next_pbuf = iprh_prev->next_pbuf;
+    iprh_prev->next_pbuf = new_p;
+  }
+
+  if (left && right) {
+    /* the part behind the fragment becomes a new hole */
+    i = ipr->hole_count++;
+    ipr->holes[i].prev = new_p;
+    ipr->holes[i].first = end;
+    ipr->holes[i].last = hole->last;
+    hole->last = start;
+  } else if (left) {
+    hole->last = start;
+  } else if (right) {
+    hole->first = end;
+    hole->prev = new_p;
+  } else {
+    /* the hole is filled */
+    *hole = ipr->holes[--ipr->hole_count];
+    i = 0;
+  }
+  ipr->hole_hint = (u8_t)i;
+
+  if (last) {
+    ipr->flags |= IP_REASS_FLAG_LASTFRAG;
+    ipr->datagram_len = end;
+    LWIP_DEBUGF(IP_REASS_DEBUG,
+     ("ip_reass: last fragment seen, total len %"S16_F"\n",
+      ipr->datagram_len));
+  }
+  return (ipr->hole_count == 0);
+}
+#endif /* !IP_REASS_HOLES */
+
+/**
+ * Chain together the fragments of a complete datagram, copy the IP header of
+ * the first fragment back and release the reassembly data.
+ *
+ * @param ipr the complete datagram
+ * @param prev the previous datagram in the linked list
+ * @return the pbuf chain of the datagram
+ */
+static struct pbuf *
+ip_reass_complete_datagram(struct ip_reassdata *ipr, struct ip_reassdata *prev)
+{
+  struct pbuf *p, *r;
+  struct ip_hdr *fraghdr;
+  struct ip_reass_helper *iprh;
+
+  /* the totally last fragment (flag more fragments = 0) was received at least
+   * once AND all fragments are received */
+  ipr->datagram_len += IP_HLEN;
+
+  /* save the second pbuf before copying the header over the pointer */
+  r = ((struct ip_reass_helper*)ipr->p->payload)->next_pbuf;
+
+  /* copy the original ip header back to the first pbuf */
+  fraghdr = (struct ip_hdr*)(ipr->p->payload);
+  SMEMCPY(fraghdr, &ipr->iphdr, IP_HLEN);
+  IPH_LEN_SET(fraghdr, htons(ipr->datagram_len));
+  IPH_OFFSET_SET(fraghdr, 0);
+  IPH_CHKSUM_SET(fraghdr, 0);
+  /* @todo: do we need to set calculate the correct checksum? */
+  IPH_CHKSUM_SET(fraghdr, inet_chksum(fraghdr, IP_HLEN));
+
+  p = ipr->p;
+
+  /* chain together the pbufs contained within the reass_data list. */
+  while(r != NULL) {
+    iprh = (struct ip_reass_helper*)r->payload;
+
+    /* hide the ip header for every succeding fragment */
+    pbuf_header(r, -IP_HLEN);
+    pbuf_cat(p, r);
+    r = iprh->next_pbuf;
+  }
+  /* release the sources allocate for the fragment queue entry */
+  ip_reass_dequeue_datagram(ipr, prev);
+
+  /* and adjust the number of pbufs currently queued for reassembly. */
+  ip_reass_pbufcount -= pbuf_clen(p);
+
+  /* Return the pbuf chain */
+  return p;
+}
 
 /**
  * Reassembles incoming IP fragments into an IP datagram.
@@ -475,13 +784,16 @@ freepbuf:
 struct pbuf *
 ip_reass(struct pbuf *p)
 {
-  struct pbuf *r;
   struct ip_hdr *fraghdr;
   struct ip_reassdata *ipr;
-  struct ip_reass_helper *iprh;
   u16_t offset, len;
   u8_t clen;
+#if IP_REASS_HOLES
+  u8_t last;
+  int hole = 0;
+#else /* IP_REASS_HOLES */
   struct ip_reassdata *ipr_prev = NULL;
+#endif /* IP_REASS_HOLES */
 
   IPFRAG_STATS_INC(ip_frag.recv);
   snmp_inc_ipreasmreqds();
@@ -497,8 +809,82 @@ ip_reass(struct pbuf *p)
   offset = (ntohs(IPH_OFFSET(fraghdr)) & IP_OFFMASK) * 8;
   len = ntohs(IPH_LEN(fraghdr)) - IPH_HL(fraghdr) * 4;
 
-  /* Check if we are allowed to enqueue more datagrams. */
+  if (((u32_t)offset + len) > (0xffffUL - IP_HLEN)) {
+    /* the datagram length would not fit into the IP header */
+    LWIP_DEBUGF(IP_REASS_DEBUG,("ip_reass: fragment beyond the maximum datagram length\n"));
+    IPFRAG_STATS_INC(ip_frag.lenerr);
+    goto nullreturn;
+  }
+
   clen = pbuf_clen(p);
+#if IP_REASS_HOLES
+  last = ((IPH_OFFSET(fraghdr) & PP_NTOHS(IP_MF)) == 0);
+
+  /* Look for the datagram the fragment belongs to and drop duplicates before
+   * making room for them */
+  for (ipr = reassdatagrams; ipr != NULL; ipr = ipr->next) {
+    if (IP_ADDRESSES_AND_ID_MATCH(&ipr->iphdr, fraghdr)) {
+      LWIP_DEBUGF(IP_REASS_DEBUG, ("ip_reass: matching previous fragment ID=%"X16_F"\n",
+        ntohs(IPH_ID(fraghdr))));
+      IPFRAG_STATS_INC(ip_frag.cachehit);
+      hole = ip_reass_find_hole(ipr, offset, offset + len, last);
+      if (hole < 0) {
+        ip_reass_stats.duplicates++;
+        goto nullreturn;
+      }
+      break;
+    }
+  }
+
+#if IP_REASS_EVICT_IDLE
+  if (ipr == NULL) {
+    ip_reass_evict_idle(fraghdr);
+  }
+#endif /* IP_REASS_EVICT_IDLE */
+
+  /* This never frees the datagram of the fragment */
+  if (!ip_reass_make_room(fraghdr, clen)) {
+    LWIP_DEBUGF(IP_REASS_DEBUG,("ip_reass: Overflow condition: pbufct=%d, clen=%d, MAX=%d\n",
+      ip_reass_pbufcount, clen, IP_REASS_MAX_PBUFS));
+    IPFRAG_STATS_INC(ip_frag.memerr);
+    goto nullreturn;
+  }
+
+  if (ipr == NULL) {
+    /* Enqueue a new datagram into the datagram queue */
+    ipr = ip_reass_enqueue_new_datagram(fraghdr, clen);
+    /* Bail if unable to enqueue */
+    if ((ipr == NULL) || ((hole = ip_reass_find_hole(ipr, offset, offset + len, last)) < 0)) {
+      /* a new datagram only rejects empty fragments */
+      if (ipr != NULL) {
+        ip_reass_dequeue_datagram(ipr, NULL);
+      }
+      goto nullreturn;
+    }
+  } else if (offset == 0) {
+    /* keep the header of the first fragment (for ICMP time exceeded) */
+    SMEMCPY(&ipr->iphdr, fraghdr, IP_HLEN);
+  }
+
+  ipr->pbufs += clen;
+  ipr->input = ++ip_reass_inputs;
+  ip_reass_pbufcount += clen;
+  if (ip_reass_pbufcount > ip_reass_stats.pbufs_max) {
+    ip_reass_stats.pbufs_max = ip_reass_pbufcount;
+  }
+
+  if (ip_reass_fill_hole(ipr, hole, p, offset, offset + len, last)) {
+    return ip_reass_complete_datagram(ipr, ip_reass_prev_datagram(ipr));
+  }
+  if ((ipr->pbufs + ipr->hole_count) > IP_REASS_MAX_PBUFS_SRC) {
+    /* every hole needs one more pbuf at least: the datagram will never fit */
+    LWIP_DEBUGF(IP_REASS_DEBUG,("ip_reass: datagram needs more than %d pbufs\n", IP_REASS_MAX_PBUFS_SRC));
+    ip_reass_stats.evicted++;
+    ip_reass_free_complete_datagram(ipr, ip_reass_prev_datagram(ipr));
+    return NULL;
+  }
+#else /* IP_REASS_HOLES */
+  /* Check if we are allowed to enqueue more datagrams. */
   if ((ip_reass_pbufcount + clen) > IP_REASS_MAX_PBUFS) {
 #if IP_REASS_FREE_OLDEST
     if (!ip_reass_remove_oldest_datagram(fraghdr, clen) ||
@@ -550,6 +936,9 @@ ip_reass(struct pbuf *p)
   /* Track the current number of pbufs current 'in-flight', in order to limit 
   the number of fragments that may be enqueued at any one time */
   ip_reass_pbufcount += clen;
+  if (ip_reass_pbufcount > ip_reass_stats.pbufs_max) {
+    ip_reass_stats.pbufs_max = ip_reass_pbufcount;
+  }
 
   /* At this point, we have either created a new entry or pointing 
    * to an existing one */
@@ -565,42 +954,9 @@ ip_reass(struct pbuf *p)
   /* find the right place to insert this pbuf */
   /* @todo: trim pbufs if fragments are overlapping */
   if (ip_reass_chain_frag_into_datagram_and_validate(ipr, p)) {
-    /* the totally last fragment (flag more fragments = 0) was received at least
-     * once AND all fragments are received */
-    ipr->datagram_len += IP_HLEN;
-
-    /* save the second pbuf before copying the header over the pointer */
-    r = ((struct ip_reass_helper*)ipr->p->payload)->next_pbuf;
-
-    /* copy the original ip header back to the first pbuf */
-    fraghdr = (struct ip_hdr*)(ipr->p->payload);
-    SMEMCPY(fraghdr, &ipr->iphdr, IP_HLEN);
-    IPH_LEN_SET(fraghdr, htons(ipr->datagram_len));
-    IPH_OFFSET_SET(fraghdr, 0);
-    IPH_CHKSUM_SET(fraghdr, 0);
-    /* @todo: do we need to set calculate the correct checksum? */
-    IPH_CHKSUM_SET(fraghdr, inet_chksum(fraghdr, IP_HLEN));
-
-    p = ipr->p;
-
-    /* chain together the pbufs contained within the reass_data list. */
-    while(r != NULL) {
-      iprh = (struct ip_reass_helper*)r->payload;
-
-      /* hide the ip header for every succeding fragment */
-      pbuf_header(r, -IP_HLEN);
-      pbuf_cat(p, r);
-      r = iprh->next_pbuf;
-    }
-    /* release the sources allocate for the fragment queue entry */
-    ip_reass_dequeue_datagram(ipr, ipr_prev);
-
-    /* and adjust the number of pbufs currently queued for reassembly. */
-    ip_reass_pbufcount -= pbuf_clen(p);
-
-    /* Return the pbuf chain */
-    return p;
+    return ip_reass_complete_datagram(ipr, ipr_prev);
   }
+#endif /* IP_REASS_HOLES */
   /* the datagram is not (yet?) reassembled completely */
   LWIP_DEBUGF(IP_REASS_DEBUG,("ip_reass_pbufcount: %d out\n", ip_reass_pbufcount));
   return NULL;
@@ -656,12 +1012,14 @@ ipfrag_free_pbuf_custom(struct pbuf *p)
  * Chop the datagram in MTU sized chunks and send them in order
  * by using a fixed size static memory buffer (PBUF_REF) or
  * point PBUF_REFs into p (depending on IP_FRAG_USES_STATIC_BUF).
+ * p itself is not modified, the caller may send it again.
  *
  * @param p ip packet to send
  * @param netif the netif on which to send
  * @param dest destination ip address to which to send
  *
- * @return ERR_OK if sent successfully, err_t otherwise
+ * @return ERR_OK if sent successfully, err_t otherwise: the fragments
+ *         following the first one netif->output() failed for are not sent
  */
 err_t 
 ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
@@ -683,9 +1041,12 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
   u16_t last;
   u16_t poff = IP_HLEN;
   u16_t tmp;
+  err_t err;
 #if !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF
   u16_t newpbuflen = 0;
   u16_t left_to_copy;
+  u16_t nfrags;
+  u16_t txdescs = 0;
 #endif
 
   /* Get a RAM based MTU sized pbuf */
@@ -719,6 +1080,11 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
 
   nfb = (mtu - IP_HLEN) / 8;
 
+#if !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF
+  /* fragments not sent yet, see the TX descriptors below */
+  nfrags = (u16_t)((left + (nfb * 8) - 1) / (nfb * 8));
+#endif /* !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF */
+
   while (left) {
     last = (left <= mtu - IP_HLEN);
 
@@ -765,34 +1131,45 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
     SMEMCPY(rambuf->payload, original_iphdr, IP_HLEN);
     iphdr = (struct ip_hdr *)rambuf->payload;
 
-    /* Can just adjust p directly for needed offset. */
-    p->payload = (u8_t *)p->payload + poff;
-    p->len -= poff;
-
+    /* poff is the offset of the next data in p, p itself is left untouched */
     left_to_copy = cop;
     while (left_to_copy) {
       struct pbuf_custom_ref *pcr;
-      newpbuflen = (left_to_copy < p->len) ? left_to_copy : p->len;
+      u16_t plen = p->len - poff;
+      newpbuflen = (left_to_copy < plen) ? left_to_copy : plen;
       /* Is this pbuf already empty? */
       if (!newpbuflen) {
+        poff = 0;
         p = p->next;
         continue;
       }
-      pcr = ip_frag_alloc_pbuf_custom_ref();
-      if (pcr == NULL) {
-        pbuf_free(rambuf);
-        return ERR_MEM;
-      }
-      /* Mirror this pbuf, although we might not need all of it. */
-      newpbuf = pbuf_alloced_custom(PBUF_RAW, newpbuflen, PBUF_REF, &pcr->pc, p->payload, newpbuflen);
-      if (newpbuf == NULL) {
-        ip_frag_free_pbuf_custom_ref(pcr);
-        pbuf_free(rambuf);
-        return ERR_MEM;
+      if (p->type == PBUF_REF) {
+        /* The data of a PBUF_REF may change once the caller returns (see
+         * etharp_query()), a DMA-enabled MAC may read the fragment later. */
+        newpbuf = pbuf_alloc(PBUF_RAW, newpbuflen, PBUF_RAM);
+        if (newpbuf == NULL) {
+          pbuf_free(rambuf);
+          return ERR_MEM;
+        }
+        MEMCPY(newpbuf->payload, (u8_t *)p->payload + poff, newpbuflen);
+      } else {
+        pcr = ip_frag_alloc_pbuf_custom_ref();
+        if (pcr == NULL) {
+          pbuf_free(rambuf);
+          return ERR_MEM;
+        }
+        /* Mirror this pbuf, although we might not need all of it. */
+        newpbuf = pbuf_alloced_custom(PBUF_RAW, newpbuflen, PBUF_REF, &pcr->pc,
+                                      (u8_t *)p->payload + poff, newpbuflen);
+        if (newpbuf == NULL) {
+          ip_frag_free_pbuf_custom_ref(pcr);
+          pbuf_free(rambuf);
+          return ERR_MEM;
+        }
+        pbuf_ref(p);
+        pcr->original = p;
+        pcr->pc.custom_free_function = ipfrag_free_pbuf_custom;
       }
-      pbuf_ref(p);
-      pcr->original = p;
-      pcr->pc.custom_free_function = ipfrag_free_pbuf_custom;
 
       /* Add it to end of rambuf's chain, but using pbuf_cat, not pbuf_chain
        * so that it is removed when pbuf_dechain is later called on rambuf.
@@ -800,10 +1177,23 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
       pbuf_cat(rambuf, newpbuf);
       left_to_copy -= newpbuflen;
       if (left_to_copy) {
+        poff = 0;
         p = p->next;
       }
     }
-    poff = newpbuflen;
+    poff += newpbuflen;
+
+    /* sent in place, the fragment takes a TX descriptor per pbuf, copied it takes one:
+       it is sent in place if the copies of the fragments after it still fit the ring */
+    if (netif->tx_descs != 0) {
+      u16_t n = pbuf_clen(rambuf);
+      if ((u32_t)txdescs + n + nfrags - 1 > netif->tx_descs) {
+        rambuf->flags |= PBUF_FLAG_TX_COPY;
+        n = 1;
+      }
+      txdescs += n;
+      nfrags--;
+    }
 #endif /* LWIP_NETIF_TX_SINGLE_PBUF */
 #endif /* IP_FRAG_USES_STATIC_BUF */
 
@@ -811,7 +1201,11 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
     IPH_OFFSET_SET(iphdr, htons(tmp));
     IPH_LEN_SET(iphdr, htons(cop + IP_HLEN));
     IPH_CHKSUM_SET(iphdr, 0);
-    IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+#if CHECKSUM_GEN_IP
+    if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_IP)) {
+      IPH_CHKSUM_SET(iphdr, inet_chksum(iphdr, IP_HLEN));
+    }
+#endif /* CHECKSUM_GEN_IP */
 
 #if IP_FRAG_USES_STATIC_BUF
     if (last) {
@@ -826,10 +1220,16 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
     header = pbuf_alloc(PBUF_LINK, 0, PBUF_RAM);
     if (header != NULL) {
       pbuf_chain(header, rambuf);
-      netif->output(netif, header, dest);
+      err = netif->output(netif, header, dest);
+      pbuf_free(header);
+      if (err != ERR_OK) {
+        LWIP_DEBUGF(IP_REASS_DEBUG, ("ip_frag: netif->output() failed: %d\n", err));
+        IPFRAG_STATS_INC(ip_frag.err);
+        pbuf_free(rambuf);
+        return err;
+      }
       IPFRAG_STATS_INC(ip_frag.xmit);
       snmp_inc_ipfragcreates();
-      pbuf_free(header);
     } else {
       LWIP_DEBUGF(IP_REASS_DEBUG, ("ip_frag: pbuf_alloc() for header failed\n"));
       pbuf_free(rambuf);
@@ -839,8 +1239,7 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
     /* No need for separate header pbuf - we allowed room for it in rambuf
      * when allocated.
      */
-    netif->output(netif, rambuf, dest);
-    IPFRAG_STATS_INC(ip_frag.xmit);
+    err = netif->output(netif, rambuf, dest);
 
     /* Unfortunately we can't reuse rambuf - the hardware may still be
      * using the buffer. Instead we free it (and the ensuing chain) and
@@ -850,6 +1249,14 @@ ip_frag(struct pbuf *p, struct netif *netif, const ip_addr_t *dest)
      */
     
     pbuf_free(rambuf);
+    if (err != ERR_OK) {
+      /* the receiver can't reassemble the datagram without this fragment */
+      LWIP_DEBUGF(IP_REASS_DEBUG, ("ip_frag: netif->output() failed: %d\n", err));
+      IPFRAG_STATS_INC(ip_frag.err);
+      return err;
+    }
+    IPFRAG_STATS_INC(ip_frag.xmit);
+    snmp_inc_ipfragcreates();
 #endif /* IP_FRAG_USES_STATIC_BUF */
     left -= cop;
     ofo += nfb;
@@ -68,6 +68,47 @@
 #if MEM_USE_POOLS
 /* lwIP head implemented with different sized pools */
 
+#if MEM_TELEMETRY
+/** One entry per LWIP_MALLOC_MEMPOOL, index 0 is MEMP_POOL_FIRST */
+static struct mem_class mem_classes[] = {
+#define LWIP_MEMPOOL(name,num,size,desc)
+#define LWIP_MALLOC_MEMPOOL_START
+#define LWIP_MALLOC_MEMPOOL(num, size) {(size), (num), 0, 0, 0, 0, 0, 0},
+#define LWIP_MALLOC_MEMPOOL_END
+#include "lwip/memp_std.h"
+};
+
+#define MEM_CLASS(poolnr) (&mem_classes[(poolnr) - MEMP_POOL_FIRST])
+
+#if MEMP_NUM_CORE_CACHES
+/** Spin lock of mem_classes, mem_malloc() and mem_free() may run on any core */
+static sys_spinlock_t mem_class_lock;
+
+#define MEM_CLASS_DECL_PROTECT(lev) sys_spin_prot_t lev
+#define MEM_CLASS_PROTECT(lev)      SYS_ARCH_SPIN_PROTECT(&mem_class_lock, lev)
+#define MEM_CLASS_UNPROTECT(lev)    SYS_ARCH_SPIN_UNPROTECT(&mem_class_lock, lev)
+#else /* MEMP_NUM_CORE_CACHES */
+#define MEM_CLASS_DECL_PROTECT(lev) SYS_ARCH_DECL_PROTECT(lev)
+#define MEM_CLASS_PROTECT(lev)      SYS_ARCH_PROTECT(lev)
+#define MEM_CLASS_UNPROTECT(lev)    SYS_ARCH_UNPROTECT(lev)
+#endif /* MEMP_NUM_CORE_CACHES */
+
+/**
+ * Get the telemetry of one size class, the smallest class has index 0.
+ *
+ * @param idx index of the class
+ * @return the class or NULL if idx is past the biggest class
+ */
+const struct mem_class *
+mem_class_get(u8_t idx)
+{
+  if (idx >= sizeof(mem_classes) / sizeof(mem_classes[0])) {
+    return NULL;
+  }
+  return &mem_classes[idx];
+}
+#endif /* MEM_TELEMETRY */
+
 /**
  * Allocate memory: determine the smallest pool that is big enough
  * to contain an element of 'size' and get an element from that pool.
@@ -82,11 +123,12 @@ mem_malloc(mem_size_t size)
   struct memp_malloc_helper *element;
   memp_t poolnr;
   mem_size_t required_size = size + LWIP_MEM_ALIGN_SIZE(sizeof(struct memp_malloc_helper));
+#if MEM_TELEMETRY
+  memp_t first;
+  MEM_CLASS_DECL_PROTECT(old_level);
+#endif /* MEM_TELEMETRY */
 
   for (poolnr = MEMP_POOL_FIRST; poolnr <= MEMP_POOL_LAST; poolnr = (memp_t)(poolnr + 1)) {
-#if MEM_USE_POOLS_TRY_BIGGER_POOL
-again:
-#endif /* MEM_USE_POOLS_TRY_BIGGER_POOL */
     /* is this pool big enough to hold an element of the required size
        plus a struct memp_malloc_helper that saves the pool this element came from? */
     if (required_size <= memp_sizes[poolnr]) {
@@ -97,6 +139,12 @@ again:
     LWIP_ASSERT("mem_malloc(): no pool is that big!", 0);
     return NULL;
   }
+#if MEM_TELEMETRY
+  first = poolnr;
+#endif /* MEM_TELEMETRY */
+#if MEM_USE_POOLS_TRY_BIGGER_POOL
+again:
+#endif /* MEM_USE_POOLS_TRY_BIGGER_POOL */
   element = (struct memp_malloc_helper*)memp_malloc(poolnr);
   if (element == NULL) {
     /* No need to DEBUGF or ASSERT: This error is already
@@ -104,15 +152,33 @@ again:
 #if MEM_USE_POOLS_TRY_BIGGER_POOL
     /** Try a bigger pool if this one is empty! */
     if (poolnr < MEMP_POOL_LAST) {
-      poolnr++;
+      poolnr = (memp_t)(poolnr + 1);
       goto again;
     }
 #endif /* MEM_USE_POOLS_TRY_BIGGER_POOL */
+#if MEM_TELEMETRY
+    MEM_CLASS_PROTECT(old_level);
+    MEM_CLASS(first)->err++;
+    MEM_CLASS_UNPROTECT(old_level);
+#endif /* MEM_TELEMETRY */
     return NULL;
   }
 
   /* save the pool number this element came from */
-  element->poolnr = poolnr;
+  element->poolnr = (u16_t)poolnr;
+#if MEM_TELEMETRY
+  element->size = size;
+  MEM_CLASS_PROTECT(old_level);
+  if (poolnr != first) {
+    MEM_CLASS(first)->spills++;
+  }
+  MEM_CLASS(poolnr)->allocs++;
+  MEM_CLASS(poolnr)->requested += size;
+  if (++MEM_CLASS(poolnr)->used > MEM_CLASS(poolnr)->max) {
+    MEM_CLASS(poolnr)->max = MEM_CLASS(poolnr)->used;
+  }
+  MEM_CLASS_UNPROTECT(old_level);
+#endif /* MEM_TELEMETRY */
   /* and return a pointer to the memory directly after the struct memp_malloc_helper */
   ret = (u8_t*)element + LWIP_MEM_ALIGN_SIZE(sizeof(struct memp_malloc_helper));
 
@@ -130,6 +196,9 @@ void
 mem_free(void *rmem)
 {
   struct memp_malloc_helper *hmem;
+#if MEM_TELEMETRY
+  MEM_CLASS_DECL_PROTECT(old_level);
+#endif /* MEM_TELEMETRY */
 
   LWIP_ASSERT("rmem != NULL", (rmem != NULL));
   LWIP_ASSERT("rmem == MEM_ALIGN(rmem)", (rmem == LWIP_MEM_ALIGN(rmem)));
@@ -141,8 +210,14 @@ mem_free(void *rmem)
   LWIP_ASSERT("hmem == MEM_ALIGN(hmem)", (hmem == LWIP_MEM_ALIGN(hmem)));
   LWIP_ASSERT("hmem->poolnr < MEMP_MAX", (hmem->poolnr < MEMP_MAX));
 
+#if MEM_TELEMETRY
+  MEM_CLASS_PROTECT(old_level);
+  MEM_CLASS(hmem->poolnr)->used--;
+  MEM_CLASS(hmem->poolnr)->requested -= hmem->size;
+  MEM_CLASS_UNPROTECT(old_level);
+#endif /* MEM_TELEMETRY */
   /* and put it in the pool we saved earlier */
-  memp_free(hmem->poolnr, hmem);
+  memp_free((memp_t)hmem->poolnr, hmem);
 }
 
 #else /* MEM_USE_POOLS */
@@ -195,6 +270,26 @@ static struct mem *lfree;
 static sys_mutex_t mem_mutex;
 #endif
 
+#if MEM_TELEMETRY
+/** bytes allocated, including the struct mem of every block */
+static mem_size_t mem_heap_used;
+/** high-water mark of mem_heap_used */
+static mem_size_t mem_heap_max;
+/** failed requests */
+static u32_t mem_heap_err;
+
+#define MEM_HEAP_INC_USED(amount) do { mem_heap_used += (amount); \
+                                       if (mem_heap_used > mem_heap_max) { \
+                                         mem_heap_max = mem_heap_used; \
+                                       } } while(0)
+#define MEM_HEAP_DEC_USED(amount) mem_heap_used -= (amount)
+#define MEM_HEAP_INC_ERR()        mem_heap_err++
+#else /* MEM_TELEMETRY */
+#define MEM_HEAP_INC_USED(amount)
+#define MEM_HEAP_DEC_USED(amount)
+#define MEM_HEAP_INC_ERR()
+#endif /* MEM_TELEMETRY */
+
 #if LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT
 
 static volatile u8_t mem_free_count;
@@ -295,12 +390,54 @@ mem_init(void)
   lfree = (struct mem *)(void *)ram;
 
   MEM_STATS_AVAIL(avail, MEM_SIZE_ALIGNED);
+#if MEM_TELEMETRY
+  mem_heap_used = 0;
+  mem_heap_max = 0;
+  mem_heap_err = 0;
+#endif /* MEM_TELEMETRY */
 
   if(sys_mutex_new(&mem_mutex) != ERR_OK) {
     LWIP_ASSERT("failed to create mem_mutex", 0);
   }
 }
 
+#if MEM_TELEMETRY
+/**
+ * Walk the heap and report its usage and fragmentation: the free bytes are
+ * spread over report->blocks blocks, report->largest is the biggest request
+ * that would succeed now.
+ *
+ * @param report filled with the state of the heap
+ */
+void
+mem_heap_get(struct mem_heap_report *report)
+{
+  struct mem *mem;
+  mem_size_t block;
+  LWIP_MEM_FREE_DECL_PROTECT();
+
+  LWIP_MEM_FREE_PROTECT();
+  report->size = MEM_SIZE_ALIGNED;
+  report->used = mem_heap_used;
+  report->max = mem_heap_max;
+  report->free = 0;
+  report->largest = 0;
+  report->blocks = 0;
+  report->err = mem_heap_err;
+  for (mem = (struct mem *)(void *)ram; mem != ram_end; mem = (struct mem *)(void *)&ram[mem->next]) {
+    if (!mem->used) {
+      block = mem->next - (mem_size_t)((u8_t *)mem - ram);
+      report->free += block;
+      report->blocks++;
+      if (block - SIZEOF_STRUCT_MEM > report->largest) {
+        report->largest = block - SIZEOF_STRUCT_MEM;
+      }
+    }
+  }
+  LWIP_MEM_FREE_UNPROTECT();
+}
+#endif /* MEM_TELEMETRY */
+
 /**
  * Put a struct mem back on the heap
  *
@@ -346,6 +483,7 @@ mem_free(void *rmem)
   }
 
   MEM_STATS_DEC_USED(used, mem->next - (mem_size_t)(((u8_t *)mem - ram)));
+  MEM_HEAP_DEC_USED(mem->next - (mem_size_t)((u8_t *)mem - ram));
 
   /* finally, see if prev or next are free also */
   plug_holes(mem);
@@ -444,6 +582,7 @@ mem_trim(void *rmem, mem_size_t newsize)
       ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
     }
     MEM_STATS_DEC_USED(used, (size - newsize));
+    MEM_HEAP_DEC_USED(size - newsize);
     /* no need to plug holes, we've already done that */
   } else if (newsize + SIZEOF_STRUCT_MEM + MIN_SIZE_ALIGNED <= size) {
     /* Next struct is used but there's room for another struct mem with
@@ -466,6 +605,7 @@ mem_trim(void *rmem, mem_size_t newsize)
       ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
     }
     MEM_STATS_DEC_USED(used, (size - newsize));
+    MEM_HEAP_DEC_USED(size - newsize);
     /* the original mem->next is used, so no need to plug holes! */
   }
   /* else {
@@ -575,6 +715,7 @@ mem_malloc(mem_size_t size)
             ((struct mem *)(void *)&ram[mem2->next])->prev = ptr2;
           }
           MEM_STATS_INC_USED(used, (size + SIZEOF_STRUCT_MEM));
+          MEM_HEAP_INC_USED(size + SIZEOF_STRUCT_MEM);
         } else {
           /* (a mem2 struct does no fit into the user data space of mem and mem->next will always
            * be used at this point: if not we have 2 unused structs in a row, plug_holes should have
@@ -585,6 +726,7 @@ mem_malloc(mem_size_t size)
            */
           mem->used = 1;
           MEM_STATS_INC_USED(used, mem->next - (mem_size_t)((u8_t *)mem - ram));
+          MEM_HEAP_INC_USED(mem->next - (mem_size_t)((u8_t *)mem - ram));
         }
 #if LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT
 mem_malloc_adjust_lfree:
@@ -627,6 +769,7 @@ mem_malloc_adjust_lfree:
 #endif /* LWIP_ALLOW_MEM_FREE_FROM_OTHER_CONTEXT */
   LWIP_DEBUGF(MEM_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("mem_malloc: could not allocate %"S16_F" bytes\n", (s16_t)size));
   MEM_STATS_INC(err);
+  MEM_HEAP_INC_ERR();
   LWIP_MEM_ALLOC_UNPROTECT();
   sys_mutex_unlock(&mem_mutex);
   return NULL;
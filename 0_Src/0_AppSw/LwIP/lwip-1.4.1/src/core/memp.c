@@ -116,6 +116,9 @@ struct memp {
  *  Elements form a linked list. */
 static struct memp *memp_tab[MEMP_MAX];
 
+/** Number of elements on each memp_tab list, see memp_num_free() */
+static u16_t memp_tab_num[MEMP_MAX];
+
 #else /* MEMP_MEM_MALLOC */
 
 #define MEMP_ALIGN_SIZE(x) (LWIP_MEM_ALIGN_SIZE(x))
@@ -174,6 +177,22 @@ static u8_t memp_memory[MEM_ALIGNMENT - 1
 
 #endif /* MEMP_SEPARATE_POOLS */
 
+#if MEMP_NUM_CORE_CACHES
+/** Per-core caches of free elements, see MEMP_NUM_CORE_CACHES */
+static struct memp_cache memp_caches[MEMP_NUM_CORE_CACHES][MEMP_MAX];
+
+/** Spin lock of memp_tab, shared by all cores */
+static sys_spinlock_t memp_lock;
+
+#define MEMP_SHARED_DECL_PROTECT(lev) sys_spin_prot_t lev
+#define MEMP_SHARED_PROTECT(lev)      SYS_ARCH_SPIN_PROTECT(&memp_lock, lev)
+#define MEMP_SHARED_UNPROTECT(lev)    SYS_ARCH_SPIN_UNPROTECT(&memp_lock, lev)
+#else /* MEMP_NUM_CORE_CACHES */
+#define MEMP_SHARED_DECL_PROTECT(lev) SYS_ARCH_DECL_PROTECT(lev)
+#define MEMP_SHARED_PROTECT(lev)      SYS_ARCH_PROTECT(lev)
+#define MEMP_SHARED_UNPROTECT(lev)    SYS_ARCH_UNPROTECT(lev)
+#endif /* MEMP_NUM_CORE_CACHES */
+
 #if MEMP_SANITY_CHECK
 /**
  * Check that memp-lists don't form a circle, using "Floyd's cycle-finding algorithm".
@@ -340,6 +359,10 @@ memp_init(void)
   struct memp *memp;
   u16_t i, j;
 
+#if MEMP_NUM_CORE_CACHES
+  memset(memp_caches, 0, sizeof(memp_caches));
+#endif /* MEMP_NUM_CORE_CACHES */
+
   for (i = 0; i < MEMP_MAX; ++i) {
     MEMP_STATS_AVAIL(used, i, 0);
     MEMP_STATS_AVAIL(max, i, 0);
@@ -353,6 +376,7 @@ memp_init(void)
   /* for every pool: */
   for (i = 0; i < MEMP_MAX; ++i) {
     memp_tab[i] = NULL;
+    memp_tab_num[i] = memp_num[i];
 #if MEMP_SEPARATE_POOLS
     memp = (struct memp*)memp_bases[i];
 #endif /* MEMP_SEPARATE_POOLS */
@@ -374,6 +398,163 @@ memp_init(void)
 #endif /* MEMP_OVERFLOW_CHECK */
 }
 
+#if MEMP_NUM_CORE_CACHES
+/**
+ * Moves up to MEMP_CORE_CACHE_SIZE elements from the shared pool into the
+ * cache of the calling core.
+ *
+ * @param cache the cache of the calling core
+ * @param type the pool the cache belongs to
+ */
+static void
+memp_cache_refill(struct memp_cache *cache, memp_t type)
+{
+  struct memp *memp;
+  u16_t i;
+  MEMP_SHARED_DECL_PROTECT(old_level);
+
+  MEMP_SHARED_PROTECT(old_level);
+  for (i = 0; (i < MEMP_CORE_CACHE_SIZE) && (memp_tab[type] != NULL); i++) {
+    memp = memp_tab[type];
+    memp_tab[type] = memp->next;
+    memp->next = cache->tab;
+    cache->tab = memp;
+  }
+  memp_tab_num[type] -= i;
+  MEMP_SHARED_UNPROTECT(old_level);
+
+  if (i > 0) {
+    cache->count += i;
+    cache->refills++;
+  }
+}
+
+/**
+ * Returns elements of the cache of the calling core to the shared pool.
+ *
+ * @param cache the cache of the calling core
+ * @param type the pool the cache belongs to
+ * @param count number of elements to return, at most cache->count
+ */
+static void
+memp_cache_drain(struct memp_cache *cache, memp_t type, u16_t count)
+{
+  struct memp *memp;
+  u16_t i;
+  MEMP_SHARED_DECL_PROTECT(old_level);
+
+  MEMP_SHARED_PROTECT(old_level);
+  for (i = 0; i < count; i++) {
+    memp = cache->tab;
+    cache->tab = memp->next;
+    memp->next = memp_tab[type];
+    memp_tab[type] = memp;
+  }
+  memp_tab_num[type] += count;
+  MEMP_SHARED_UNPROTECT(old_level);
+
+  cache->count -= count;
+  cache->drains++;
+}
+
+/**
+ * Get an element from the cache of the calling core, refilled from the shared
+ * pool when empty.
+ */
+static void *
+memp_cache_malloc(memp_t type)
+{
+  struct memp_cache *cache;
+  struct memp *memp;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  cache = &memp_caches[SYS_ARCH_CORE_ID()][type];
+
+  if (cache->tab == NULL) {
+    memp_cache_refill(cache, type);
+  }
+
+  memp = cache->tab;
+
+  if (memp != NULL) {
+    cache->tab = memp->next;
+    cache->count--;
+    MEMP_STATS_INC_USED(used, type);
+    LWIP_DEBUGF(MEMP_DEBUG, ("memp_malloc: Ok %s at %08x\n", memp_desc[type], memp));
+  } else {
+    LWIP_DEBUGF(MEMP_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("memp_malloc: out of memory in pool %s\n", memp_desc[type]));
+    MEMP_STATS_INC(err, type);
+  }
+
+  SYS_ARCH_UNPROTECT(old_level);
+
+  return memp;
+}
+
+/**
+ * Put an element into the cache of the calling core. A full cache returns
+ * MEMP_CORE_CACHE_SIZE elements to the shared pool first.
+ */
+static void
+memp_cache_free(memp_t type, struct memp *memp)
+{
+  struct memp_cache *cache;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  cache = &memp_caches[SYS_ARCH_CORE_ID()][type];
+
+  if (cache->count >= (2 * MEMP_CORE_CACHE_SIZE)) {
+    memp_cache_drain(cache, type, MEMP_CORE_CACHE_SIZE);
+  }
+
+  MEMP_STATS_DEC(used, type);
+  memp->next = cache->tab;
+  cache->tab = memp;
+  cache->count++;
+
+  SYS_ARCH_UNPROTECT(old_level);
+}
+
+/**
+ * Returns the cache of one pool on one core, for statistics.
+ *
+ * @param core the core index, 0 .. MEMP_NUM_CORE_CACHES-1
+ * @param type the pool
+ * @return the cache or NULL if core or type are out of range
+ */
+const struct memp_cache *
+memp_cache_get(u8_t core, memp_t type)
+{
+  if ((core >= MEMP_NUM_CORE_CACHES) || (type >= MEMP_MAX)) {
+    return NULL;
+  }
+  return &memp_caches[core][type];
+}
+
+/**
+ * Returns all elements cached by the calling core to the shared pools, for
+ * example before the core stops using the stack.
+ */
+void
+memp_cache_flush(void)
+{
+  struct memp_cache *cache;
+  u16_t i;
+  SYS_ARCH_DECL_PROTECT(old_level);
+
+  SYS_ARCH_PROTECT(old_level);
+  for (i = 0; i < MEMP_MAX; ++i) {
+    cache = &memp_caches[SYS_ARCH_CORE_ID()][i];
+    if (cache->count > 0) {
+      memp_cache_drain(cache, (memp_t)i, cache->count);
+    }
+  }
+  SYS_ARCH_UNPROTECT(old_level);
+}
+#endif /* MEMP_NUM_CORE_CACHES */
+
 /**
  * Get an element from a specific pool.
  *
@@ -393,11 +574,17 @@ memp_malloc_fn(memp_t type, const char* file, const int line)
 #endif
 {
   struct memp *memp;
-  SYS_ARCH_DECL_PROTECT(old_level);
+  MEMP_SHARED_DECL_PROTECT(old_level);
  
   LWIP_ERROR("memp_malloc: type < MEMP_MAX", (type < MEMP_MAX), return NULL;);
 
-  SYS_ARCH_PROTECT(old_level);
+#if MEMP_NUM_CORE_CACHES
+  if (MEMP_CORE_CACHE_POOL(type)) {
+    return memp_cache_malloc(type);
+  }
+#endif /* MEMP_NUM_CORE_CACHES */
+
+  MEMP_SHARED_PROTECT(old_level);
 #if MEMP_OVERFLOW_CHECK >= 2
   memp_overflow_check_all();
 #endif /* MEMP_OVERFLOW_CHECK >= 2 */
@@ -406,6 +593,7 @@ memp_malloc_fn(memp_t type, const char* file, const int line)
   
   if (memp != NULL) {
     memp_tab[type] = memp->next;
+    memp_tab_num[type]--;
 #if MEMP_OVERFLOW_CHECK
     memp->next = NULL;
     memp->file = file;
@@ -421,7 +609,7 @@ memp_malloc_fn(memp_t type, const char* file, const int line)
     MEMP_STATS_INC(err, type);
   }
 
-  SYS_ARCH_UNPROTECT(old_level);
+  MEMP_SHARED_UNPROTECT(old_level);
 
   return memp;
 }
@@ -436,7 +624,7 @@ void
 memp_free(memp_t type, void *mem)
 {
   struct memp *memp;
-  SYS_ARCH_DECL_PROTECT(old_level);
+  MEMP_SHARED_DECL_PROTECT(old_level);
   LWIP_DEBUGF(MEMP_DEBUG, ("memp_free: Ok %s at %08x\n", memp_desc[type], mem));
   if (mem == NULL) {
     return;
@@ -446,7 +634,14 @@ memp_free(memp_t type, void *mem)
 
   memp = (struct memp *)(void *)((u8_t*)mem - MEMP_SIZE);
 
-  SYS_ARCH_PROTECT(old_level);
+#if MEMP_NUM_CORE_CACHES
+  if (MEMP_CORE_CACHE_POOL(type)) {
+    memp_cache_free(type, memp);
+    return;
+  }
+#endif /* MEMP_NUM_CORE_CACHES */
+
+  MEMP_SHARED_PROTECT(old_level);
 #if MEMP_OVERFLOW_CHECK
 #if MEMP_OVERFLOW_CHECK >= 2
   memp_overflow_check_all();
@@ -460,12 +655,45 @@ memp_free(memp_t type, void *mem)
   
   memp->next = memp_tab[type]; 
   memp_tab[type] = memp;
+  memp_tab_num[type]++;
 
 #if MEMP_SANITY_CHECK
   LWIP_ASSERT("memp sanity", memp_sanity());
 #endif /* MEMP_SANITY_CHECK */
 
-  SYS_ARCH_UNPROTECT(old_level);
+  MEMP_SHARED_UNPROTECT(old_level);
+}
+
+/**
+ * Returns the number of free elements of a pool, the elements cached by
+ * the cores included.
+ *
+ * The caches of the other cores are read without their lock, so the
+ * result is a snapshot, e.g. to size the receive window after the free
+ * PBUF_POOL buffers (TCP_RCV_AUTOTUNE).
+ *
+ * @param type the pool
+ * @return number of elements memp_malloc() can return before it fails
+ */
+u16_t
+memp_num_free(memp_t type)
+{
+  u16_t num;
+#if MEMP_NUM_CORE_CACHES
+  u8_t core;
+#endif /* MEMP_NUM_CORE_CACHES */
+
+  LWIP_ERROR("memp_num_free: type < MEMP_MAX", (type < MEMP_MAX), return 0;);
+
+  num = memp_tab_num[type];
+#if MEMP_NUM_CORE_CACHES
+  if (MEMP_CORE_CACHE_POOL(type)) {
+    for (core = 0; core < MEMP_NUM_CORE_CACHES; core++) {
+      num += memp_caches[core][type].count;
+    }
+  }
+#endif /* MEMP_NUM_CORE_CACHES */
+  return num;
 }
 
 #endif /* MEMP_MEM_MALLOC */
@@ -42,6 +42,7 @@
 #include "lwip/ip_addr.h"
 #include "lwip/netif.h"
 #include "lwip/tcp_impl.h"
+#include "lwip/udp.h"
 #include "lwip/snmp.h"
 #include "lwip/igmp.h"
 #include "netif/etharp.h"
@@ -72,6 +73,13 @@
 #define NETIF_LINK_CALLBACK(n)
 #endif /* LWIP_NETIF_LINK_CALLBACK */ 
 
+#if LWIP_UDP && UDP_FLOW_CACHE
+/** Headers cached by connected UDP pcbs depend on the netif addresses and routes */
+#define NETIF_FLOW_INVALIDATE(n) udp_flow_invalidate(n)
+#else
+#define NETIF_FLOW_INVALIDATE(n)
+#endif /* LWIP_UDP && UDP_FLOW_CACHE */
+
 struct netif *netif_list;
 struct netif *netif_default;
 
@@ -147,6 +155,13 @@ netif_add(struct netif *netif, const ip_addr_t *ipaddr, const ip_addr_t *netmask
   ip_addr_set_zero(&netif->netmask);
   ip_addr_set_zero(&netif->gw);
   netif->flags = 0;
+  NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_ENABLE_ALL);
+#if LWIP_TCP_GSO
+  /* the driver offers segmentation from its init function */
+  netif->gso_max_size = 0;
+  netif->gso_max_segs = 0;
+#endif /* LWIP_TCP_GSO */
+  netif->tx_descs = 0;
 #if LWIP_DHCP
   /* netif not under DHCP control by default */
   netif->dhcp = NULL;
@@ -189,6 +204,7 @@ netif_add(struct netif *netif, const ip_addr_t *ipaddr, const ip_addr_t *netmask
   netif->next = netif_list;
   netif_list = netif;
   snmp_inc_iflist();
+  NETIF_FLOW_INVALIDATE(NULL);
 
 #if LWIP_IGMP
   /* start IGMP processing */
@@ -248,6 +264,7 @@ netif_remove(struct netif *netif)
     /* set netif down before removing (call callback function) */
     netif_set_down(netif);
   }
+  NETIF_FLOW_INVALIDATE(netif);
 
   snmp_delete_ipaddridx_tree(netif);
 
@@ -365,6 +382,7 @@ netif_set_ipaddr(struct netif *netif, const ip_addr_t *ipaddr)
   snmp_delete_iprteidx_tree(0,netif);
   /* set new IP address to netif */
   ip_addr_set(&(netif->ip_addr), ipaddr);
+  NETIF_FLOW_INVALIDATE(netif);
   snmp_insert_ipaddridx_tree(netif);
   snmp_insert_iprteidx_tree(0,netif);
 
@@ -388,6 +406,7 @@ void
 netif_set_gw(struct netif *netif, const ip_addr_t *gw)
 {
   ip_addr_set(&(netif->gw), gw);
+  NETIF_FLOW_INVALIDATE(netif);
   LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE, ("netif: GW address of interface %c%c set to %"U16_F".%"U16_F".%"U16_F".%"U16_F"\n",
     netif->name[0], netif->name[1],
     ip4_addr1_16(&netif->gw),
@@ -411,6 +430,7 @@ netif_set_netmask(struct netif *netif, const ip_addr_t *netmask)
   snmp_delete_iprteidx_tree(0, netif);
   /* set new netmask to netif */
   ip_addr_set(&(netif->netmask), netmask);
+  NETIF_FLOW_INVALIDATE(netif);
   snmp_insert_iprteidx_tree(0, netif);
   LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE, ("netif: netmask of interface %c%c set to %"U16_F".%"U16_F".%"U16_F".%"U16_F"\n",
     netif->name[0], netif->name[1],
@@ -437,6 +457,7 @@ netif_set_default(struct netif *netif)
     snmp_insert_iprteidx_tree(1, netif);
   }
   netif_default = netif;
+  NETIF_FLOW_INVALIDATE(NULL);
   LWIP_DEBUGF(NETIF_DEBUG, ("netif: setting default interface %c%c\n",
            netif ? netif->name[0] : '\'', netif ? netif->name[1] : '\''));
 }
@@ -500,6 +521,7 @@ void netif_set_down(struct netif *netif)
       etharp_cleanup_netif(netif);
     }
 #endif /* LWIP_ARP */
+    NETIF_FLOW_INVALIDATE(netif);
     NETIF_STATUS_CALLBACK(netif);
   }
 }
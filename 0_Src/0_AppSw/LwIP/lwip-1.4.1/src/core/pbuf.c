@@ -128,8 +128,7 @@ pbuf_free_ooseq(void)
     if (NULL != pcb->ooseq) {
       /** Free the ooseq pbufs of one PCB only */
       LWIP_DEBUGF(PBUF_DEBUG | LWIP_DBG_TRACE, ("pbuf_free_ooseq: freeing out-of-sequence pbufs\n"));
-      tcp_segs_free(pcb->ooseq);
-      pcb->ooseq = NULL;
+      tcp_free_ooseq(pcb);
       return;
     }
   }
@@ -271,7 +270,7 @@ pbuf_alloc(pbuf_layer layer, u16_t length, pbuf_type type)
     while (rem_len > 0) {
         // ____________________________________________
         // DN: It is best that PBUF_POOL_BUFSIZE is adjusted so that this line is not hit.
-        #ifdef __TASKING__
+        #if defined(__TASKING__) || defined(IFX_HOST_BUILD)
         __debug();
         #elif !defined(_WIN32)
         __asm__ volatile ("debug" : : : "memory");
@@ -118,11 +118,84 @@ struct tcp_pcb *tcp_tmp_pcb;
 
 u8_t tcp_active_pcbs_changed;
 
+#if TCP_PCB_HASH
+/** The pcbs of tcp_active_pcbs and tcp_tw_pcbs by local port, remote port and remote address */
+struct tcp_pcb *tcp_conn_hash[TCP_PCB_HASH_SIZE];
+/** The pcbs of tcp_listen_pcbs by local port */
+struct tcp_pcb *tcp_listen_hash[TCP_PCB_HASH_SIZE];
+
+/**
+ * Bucket of tcp_conn_hash for a connection. The local address is left out:
+ * it is the address of the interface for all pcbs of a netif.
+ */
+u32_t
+tcp_hash_conn(u16_t local_port, u16_t remote_port, ip_addr_t *remote_ip)
+{
+  u32_t h = ip4_addr_get_u32(remote_ip) ^ ((u32_t)local_port << 16) ^ remote_port;
+  h ^= h >> 16;
+  h ^= h >> 8;
+  return h & TCP_PCB_HASH_MASK;
+}
+
+/**
+ * Called by TCP_REG: link a pcb registered with one of the lists searched by
+ * tcp_input() into its hash table, tcp_bound_pcbs are not hashed.
+ *
+ * @param pcbs the list the pcb was registered with
+ * @param pcb the pcb, a struct tcp_pcb_listen for tcp_listen_pcbs
+ */
+void
+tcp_hash_link(struct tcp_pcb **pcbs, struct tcp_pcb *pcb)
+{
+  struct tcp_pcb **head;
+
+  if (pcbs == &tcp_listen_pcbs.pcbs) {
+    head = &tcp_listen_hash[TCP_PCB_HASH_PORT(pcb->local_port)];
+  } else if ((pcbs == &tcp_active_pcbs) || (pcbs == &tcp_tw_pcbs)) {
+    head = &tcp_conn_hash[tcp_hash_conn(pcb->local_port, pcb->remote_port, &pcb->remote_ip)];
+  } else {
+    pcb->hash_pprev = NULL;
+    return;
+  }
+  pcb->hash_next = *head;
+  pcb->hash_pprev = head;
+  if (*head != NULL) {
+    (*head)->hash_pprev = &pcb->hash_next;
+  }
+  *head = pcb;
+}
+
+/**
+ * Called by TCP_RMV: unlink a pcb from its hash table, if any.
+ *
+ * @param pcb the pcb removed from its list
+ */
+void
+tcp_hash_unlink(struct tcp_pcb *pcb)
+{
+  if (pcb->hash_pprev != NULL) {
+    *pcb->hash_pprev = pcb->hash_next;
+    if (pcb->hash_next != NULL) {
+      pcb->hash_next->hash_pprev = pcb->hash_pprev;
+    }
+    pcb->hash_pprev = NULL;
+  }
+}
+#endif /* TCP_PCB_HASH */
+
 /** Timer counter to handle calling slow-timer from tcp_tmr() */ 
 static u8_t tcp_timer;
 static u8_t tcp_timer_ctr;
 static u16_t tcp_new_port(void);
 
+#if TCP_RCV_AUTOTUNE
+/** States in which a pcb takes data from the remote side */
+#define TCP_RCV_STATE(state) (((state) >= SYN_RCVD) && ((state) <= FIN_WAIT_2))
+
+/** Number of active pcbs in a TCP_RCV_STATE, counted by tcp_fasttmr() */
+static u16_t tcp_rcv_pcbs;
+#endif /* TCP_RCV_AUTOTUNE */
+
 /**
  * Initialize this module.
  */
@@ -570,19 +643,61 @@ tcp_listen_with_backlog(struct tcp_pcb *pcb, u8_t backlog)
   return (struct tcp_pcb *)lpcb;
 }
 
+#if TCP_RCV_AUTOTUNE
+/**
+ * Limits the receive window to the PBUF_POOL buffers the pcb may still take:
+ * the buffers free beyond TCP_RCV_POOL_RESERVE and its share of the pool
+ * less the buffers it holds, one segment of pcb->mss per buffer.
+ *
+ * A second RX pool of a driver, such as the small pbufs of the copy-break
+ * of ethernetif_tc2x, is left out on purpose. It only takes frames which
+ * would otherwise use a PBUF_POOL buffer, and the driver falls back to
+ * PBUF_POOL once it is empty, so the buffers counted here bound what the
+ * peer can fill. Data held in small pbufs is counted as PBUF_POOL buffers
+ * in 'held', which can only make the window smaller.
+ *
+ * @param pcb the tcp_pcb to announce a window for
+ * @return the window, at most pcb->rcv_wnd
+ */
+static u16_t
+tcp_rcv_pool_wnd(struct tcp_pcb *pcb)
+{
+  u16_t avail = memp_num_free(MEMP_PBUF_POOL);
+  u16_t share = (PBUF_POOL_SIZE - TCP_RCV_POOL_RESERVE) / LWIP_MAX(tcp_rcv_pcbs, 1);
+  /* data not yet taken with tcp_recved(), refused data included */
+  u32_t held = (TCP_WND - pcb->rcv_wnd + pcb->mss - 1) / pcb->mss;
+  u32_t bufs;
+
+#if TCP_QUEUE_OOSEQ
+  held += (pcb->ooseq_len + pcb->mss - 1) / pcb->mss;
+#endif /* TCP_QUEUE_OOSEQ */
+  bufs = (avail > TCP_RCV_POOL_RESERVE) ? (u32_t)(avail - TCP_RCV_POOL_RESERVE) : 0;
+  bufs = (share > held) ? LWIP_MIN(bufs, share - held) : 0;
+
+  return (u16_t)LWIP_MIN(pcb->rcv_wnd, bufs * pcb->mss);
+}
+#endif /* TCP_RCV_AUTOTUNE */
+
 /** 
  * Update the state that tracks the available window space to advertise.
+ * With TCP_RCV_AUTOTUNE, the window is limited by tcp_rcv_pool_wnd(), the
+ * right edge already announced is kept in any case.
  *
  * Returns how much extra window would be advertised if we sent an
  * update now.
  */
 u32_t tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb)
 {
-  u32_t new_right_edge = pcb->rcv_nxt + pcb->rcv_wnd;
+#if TCP_RCV_AUTOTUNE
+  u16_t wnd = tcp_rcv_pool_wnd(pcb);
+#else /* TCP_RCV_AUTOTUNE */
+  u16_t wnd = pcb->rcv_wnd;
+#endif /* TCP_RCV_AUTOTUNE */
+  u32_t new_right_edge = pcb->rcv_nxt + wnd;
 
   if (TCP_SEQ_GEQ(new_right_edge, pcb->rcv_ann_right_edge + LWIP_MIN((TCP_WND / 2), pcb->mss))) {
     /* we can advertise more window */
-    pcb->rcv_ann_wnd = pcb->rcv_wnd;
+    pcb->rcv_ann_wnd = wnd;
     return new_right_edge - pcb->rcv_ann_right_edge;
   } else {
     if (TCP_SEQ_GT(pcb->rcv_nxt, pcb->rcv_ann_right_edge)) {
@@ -753,6 +868,10 @@ tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port,
 #if TCP_CALCULATE_EFF_SEND_MSS
   pcb->mss = tcp_eff_send_mss(pcb->mss, ipaddr);
 #endif /* TCP_CALCULATE_EFF_SEND_MSS */
+#if TCP_RCV_AUTOTUNE
+  /* the SYN announces the window the PBUF_POOL allows */
+  tcp_update_rcv_ann_wnd(pcb);
+#endif /* TCP_RCV_AUTOTUNE */
   pcb->cwnd = 1;
   pcb->ssthresh = pcb->mss * 10;
 #if LWIP_CALLBACK_API
@@ -777,6 +896,94 @@ tcp_connect(struct tcp_pcb *pcb, ip_addr_t *ipaddr, u16_t port,
   return ret;
 }
 
+/**
+ * The retransmission timer of a pcb with unacknowledged data expired: back
+ * off, reduce the congestion window and retransmit everything unacknowledged.
+ *
+ * @param pcb the tcp_pcb whose retransmission timer expired
+ */
+static void
+tcp_rto_expired(struct tcp_pcb *pcb)
+{
+#if !LWIP_TCP_CC
+  u16_t eff_wnd;
+#endif /* !LWIP_TCP_CC */
+
+#if TCP_RTO_RFC6298
+  /* RFC 6298 (5.5): double the time-out */
+  pcb->rto_ms = LWIP_MIN(pcb->rto_ms * 2, TCP_RTO_MAX);
+#else /* TCP_RTO_RFC6298 */
+  /* Double retransmission time-out unless we are trying to
+   * connect to somebody (i.e., we are in SYN_SENT). */
+  if (pcb->state != SYN_SENT) {
+    pcb->rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx];
+  }
+
+  /* Reset the retransmission timer. */
+  pcb->rtime = 0;
+#endif /* TCP_RTO_RFC6298 */
+
+  /* Reduce congestion window and ssthresh. */
+#if LWIP_TCP_CC
+  pcb->cc->loss(pcb, 1);
+  /* A time-out ends fast recovery, the dupacks of what was sent before
+     must not start another one (RFC 6582, 4.2) */
+  pcb->flags &= ~TF_INFR;
+  pcb->recover = pcb->snd_nxt;
+#else /* LWIP_TCP_CC */
+  eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
+  pcb->ssthresh = eff_wnd >> 1;
+  if (pcb->ssthresh < (pcb->mss << 1)) {
+    pcb->ssthresh = (pcb->mss << 1);
+  }
+#endif /* LWIP_TCP_CC */
+  pcb->cwnd = pcb->mss;
+  LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_rto_expired: cwnd %"U16_F
+                               " ssthresh %"U16_F"\n",
+                               pcb->cwnd, pcb->ssthresh));
+
+  /* The following needs to be called AFTER cwnd is set to one
+     mss - STJ */
+  tcp_rexmit_rto(pcb);
+}
+
+#if TCP_RTO_RFC6298
+/**
+ * Timeout handler of the retransmission timer of a pcb.
+ *
+ * @param arg the tcp_pcb
+ */
+static void
+tcp_rto_timeout(void *arg)
+{
+  struct tcp_pcb *pcb = (struct tcp_pcb *)arg;
+
+  if ((pcb->unacked == NULL) ||
+      (pcb->nrtx >= ((pcb->state == SYN_SENT) ? TCP_SYNMAXRTX : TCP_MAXRTX))) {
+    /* nothing to retransmit, or tcp_slowtmr() removes the pcb */
+    return;
+  }
+  if (pcb->persist_backoff > 0) {
+    /* tcp_slowtmr() sends zero window probes instead */
+    tcp_rto_arm(pcb);
+    return;
+  }
+  LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_rto_timeout: rto %"U32_F" ms\n", pcb->rto_ms));
+  tcp_rto_expired(pcb);
+}
+
+/**
+ * (Re-)arm the retransmission timer of a pcb for pcb->rto_ms.
+ *
+ * @param pcb the tcp_pcb
+ */
+void
+tcp_rto_arm(struct tcp_pcb *pcb)
+{
+  sys_timeout_start(&pcb->rto_timeo, pcb->rto_ms, 0, tcp_rto_timeout, pcb);
+}
+#endif /* TCP_RTO_RFC6298 */
+
 /**
  * Called every 500 ms and implements the retransmission timer and the timer that
  * removes PCBs that have been in TIME-WAIT for enough time. It also increments
@@ -788,7 +995,6 @@ void
 tcp_slowtmr(void)
 {
   struct tcp_pcb *pcb, *prev;
-  u16_t eff_wnd;
   u8_t pcb_remove;      /* flag if a PCB should be removed */
   u8_t pcb_reset;       /* flag if a RST should be sent when removing */
   err_t err;
@@ -820,11 +1026,11 @@ tcp_slowtmr_start:
     pcb_remove = 0;
     pcb_reset = 0;
 
-    if (pcb->state == SYN_SENT && pcb->nrtx == TCP_SYNMAXRTX) {
+    if (pcb->state == SYN_SENT && pcb->nrtx >= TCP_SYNMAXRTX) {
       ++pcb_remove;
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max SYN retries reached\n"));
     }
-    else if (pcb->nrtx == TCP_MAXRTX) {
+    else if (pcb->nrtx >= TCP_MAXRTX) {
       ++pcb_remove;
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_slowtmr: max DATA retries reached\n"));
     } else {
@@ -839,6 +1045,7 @@ tcp_slowtmr_start:
           }
           tcp_zero_window_probe(pcb);
         }
+#if !TCP_RTO_RFC6298
       } else {
         /* Increase the retransmission timer if it is running */
         if(pcb->rtime >= 0) {
@@ -850,31 +1057,9 @@ tcp_slowtmr_start:
           LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_slowtmr: rtime %"S16_F
                                       " pcb->rto %"S16_F"\n",
                                       pcb->rtime, pcb->rto));
-
-          /* Double retransmission time-out unless we are trying to
-           * connect to somebody (i.e., we are in SYN_SENT). */
-          if (pcb->state != SYN_SENT) {
-            pcb->rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx];
-          }
-
-          /* Reset the retransmission timer. */
-          pcb->rtime = 0;
-
-          /* Reduce congestion window and ssthresh. */
-          eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
-          pcb->ssthresh = eff_wnd >> 1;
-          if (pcb->ssthresh < (pcb->mss << 1)) {
-            pcb->ssthresh = (pcb->mss << 1);
-          }
-          pcb->cwnd = pcb->mss;
-          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %"U16_F
-                                       " ssthresh %"U16_F"\n",
-                                       pcb->cwnd, pcb->ssthresh));
- 
-          /* The following needs to be called AFTER cwnd is set to one
-             mss - STJ */
-          tcp_rexmit_rto(pcb);
+          tcp_rto_expired(pcb);
         }
+#endif /* !TCP_RTO_RFC6298 */
       }
     }
     /* Check if this PCB has stayed too long in FIN-WAIT-2 */
@@ -919,9 +1104,8 @@ tcp_slowtmr_start:
        be retransmitted). */
 #if TCP_QUEUE_OOSEQ
     if (pcb->ooseq != NULL &&
-        (u32_t)tcp_ticks - pcb->tmr >= pcb->rto * TCP_OOSEQ_TIMEOUT) {
-      tcp_segs_free(pcb->ooseq);
-      pcb->ooseq = NULL;
+        (u32_t)tcp_ticks - pcb->tmr >= TCP_RTO_TICKS(pcb) * TCP_OOSEQ_TIMEOUT) {
+      tcp_free_ooseq(pcb);
       LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: dropping OOSEQ queued data\n"));
     }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -958,6 +1142,7 @@ tcp_slowtmr_start:
         LWIP_ASSERT("tcp_slowtmr: first pcb == tcp_active_pcbs", tcp_active_pcbs == pcb);
         tcp_active_pcbs = pcb->next;
       }
+      TCP_HASH_RMV(pcb);
 
       if (pcb_reset) {
         tcp_rst(pcb->snd_nxt, pcb->rcv_nxt, &pcb->local_ip, &pcb->remote_ip,
@@ -1026,6 +1211,7 @@ tcp_slowtmr_start:
         LWIP_ASSERT("tcp_slowtmr: first pcb == tcp_tw_pcbs", tcp_tw_pcbs == pcb);
         tcp_tw_pcbs = pcb->next;
       }
+      TCP_HASH_RMV(pcb);
       pcb2 = pcb;
       pcb = pcb->next;
       memp_free(MEMP_TCP_PCB, pcb2);
@@ -1046,6 +1232,9 @@ void
 tcp_fasttmr(void)
 {
   struct tcp_pcb *pcb;
+#if TCP_RCV_AUTOTUNE
+  u16_t rcv_pcbs = 0;
+#endif /* TCP_RCV_AUTOTUNE */
 
   ++tcp_timer_ctr;
 
@@ -1063,6 +1252,25 @@ tcp_fasttmr_start:
         tcp_output(pcb);
         pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
       }
+#if TCP_RCV_AUTOTUNE
+      if (TCP_RCV_STATE(pcb->state)) {
+        rcv_pcbs++;
+        /* announce the window again when PBUF_POOL buffers were freed,
+           the remote side may wait on a window closed by the pool */
+        if (tcp_update_rcv_ann_wnd(pcb) >= pcb->mss) {
+          LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: window update\n"));
+          tcp_ack_now(pcb);
+          tcp_output(pcb);
+        }
+      }
+#endif /* TCP_RCV_AUTOTUNE */
+#if LWIP_TCP_CORK
+      /* push a segment held back by the cork, at most one interval late */
+      if (pcb->flags2 & TF2_CORK_HELD) {
+        LWIP_DEBUGF(TCP_DEBUG, ("tcp_fasttmr: push corked data\n"));
+        tcp_flush(pcb);
+      }
+#endif /* LWIP_TCP_CORK */
 
       next = pcb->next;
 
@@ -1078,6 +1286,9 @@ tcp_fasttmr_start:
       pcb = next;
     }
   }
+#if TCP_RCV_AUTOTUNE
+  tcp_rcv_pcbs = rcv_pcbs;
+#endif /* TCP_RCV_AUTOTUNE */
 }
 
 /** Pass pcb->refused_data to the recv callback */
@@ -1134,6 +1345,22 @@ tcp_segs_free(struct tcp_seg *seg)
   }
 }
 
+#if TCP_QUEUE_OOSEQ
+/**
+ * Deallocates the out-of-sequence segments of a pcb.
+ *
+ * @param pcb the tcp_pcb to empty pcb->ooseq of
+ */
+void
+tcp_free_ooseq(struct tcp_pcb *pcb)
+{
+  tcp_segs_free(pcb->ooseq);
+  pcb->ooseq = NULL;
+  pcb->ooseq_last = NULL;
+  pcb->ooseq_len = 0;
+}
+#endif /* TCP_QUEUE_OOSEQ */
+
 /**
  * Frees a TCP segment (tcp_seg structure).
  *
@@ -1319,12 +1546,21 @@ tcp_alloc(u8_t prio)
     pcb->sa = 0;
     pcb->sv = 3000 / TCP_SLOW_INTERVAL;
     pcb->rtime = -1;
+#if TCP_RTO_RFC6298
+    pcb->rto_ms = TCP_RTO_INITIAL;
+#endif /* TCP_RTO_RFC6298 */
     pcb->cwnd = 1;
+#if LWIP_TCP_CC
+    pcb->cc = &TCP_CC_DEFAULT;
+#endif /* LWIP_TCP_CC */
     iss = tcp_next_iss();
     pcb->snd_wl2 = iss;
     pcb->snd_nxt = iss;
     pcb->lastack = iss;
     pcb->snd_lbb = iss;   
+#if LWIP_TCP_CC
+    pcb->recover = iss;
+#endif /* LWIP_TCP_CC */
     pcb->tmr = tcp_ticks;
     pcb->last_timer = tcp_timer_ctr;
 
@@ -1511,13 +1747,12 @@ tcp_pcb_purge(struct tcp_pcb *pcb)
     if (pcb->ooseq != NULL) {
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_pcb_purge: data left on ->ooseq\n"));
     }
-    tcp_segs_free(pcb->ooseq);
-    pcb->ooseq = NULL;
+    tcp_free_ooseq(pcb);
 #endif /* TCP_QUEUE_OOSEQ */
 
     /* Stop the retransmission timer as it will expect data on unacked
        queue if it fires */
-    pcb->rtime = -1;
+    TCP_RTO_STOP(pcb);
 
     tcp_segs_free(pcb->unsent);
     tcp_segs_free(pcb->unacked);
@@ -0,0 +1,233 @@
+/**
+ * @file
+ * Congestion control modules of the TCP layer: NewReno and CUBIC.
+ *
+ * A module sets pcb->cwnd for the ACKs outside fast recovery and
+ * pcb->ssthresh on a loss, fast recovery itself lives in tcp_in.c.
+ * Select one per pcb with tcp_set_cc(), new pcbs use TCP_CC_DEFAULT.
+ *
+ */
+
+/*
+ * Copyright (c) 2001-2004 Swedish Institute of Computer Science.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the lwIP TCP/IP stack.
+ *
+ */
+
+#include "lwip/opt.h"
+
+#if LWIP_TCP && LWIP_TCP_CC /* don't build if not configured for use in lwipopts.h */
+
+#include "lwip/tcp_impl.h"
+#include "lwip/sys.h"
+#include "lwip/def.h"
+
+#include <string.h>
+
+/** CUBIC: the largest |t - K| in milliseconds the window function is
+ * evaluated for, keeps the cube within 32 bits */
+#define TCP_CUBIC_T_MAX     10000
+/** CUBIC: growth of the window function beyond W_max is capped at this
+ * many segments << 4 */
+#define TCP_CUBIC_DELTA_MAX (64 << 4)
+
+/**
+ * Select the congestion control module of a pcb and reset its state.
+ *
+ * @param pcb the tcp_pcb to configure
+ * @param cc the module, e.g. &tcp_cc_newreno or &tcp_cc_cubic
+ */
+void
+tcp_set_cc(struct tcp_pcb *pcb, const struct tcp_cc *cc)
+{
+  LWIP_ASSERT("cc != NULL", cc != NULL);
+  pcb->cc = cc;
+  memset(&pcb->cc_state, 0, sizeof(pcb->cc_state));
+}
+
+/**
+ * Set pcb->cwnd, saturating at the u16_t limit.
+ */
+static void
+tcp_cc_set_cwnd(struct tcp_pcb *pcb, u32_t cwnd)
+{
+  pcb->cwnd = (u16_t)LWIP_MIN(cwnd, 0xFFFF);
+}
+
+/** Slow start: one mss per ACK (the lwIP Reno behaviour) */
+static void
+tcp_cc_slow_start(struct tcp_pcb *pcb)
+{
+  tcp_cc_set_cwnd(pcb, (u32_t)pcb->cwnd + pcb->mss);
+}
+
+/** ssthresh = max(FlightSize * factor / 10, 2 * mss) (RFC 5681, 3.1) */
+static void
+tcp_cc_set_ssthresh(struct tcp_pcb *pcb, u8_t factor)
+{
+  u32_t flight = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
+
+  pcb->ssthresh = (u16_t)LWIP_MAX(flight * factor / 10, 2 * (u32_t)pcb->mss);
+}
+
+/*-------------------------------------------------------------------------*/
+/* NewReno (RFC 5681, RFC 6582) */
+
+static void
+tcp_newreno_ack(struct tcp_pcb *pcb, u16_t acked)
+{
+  LWIP_UNUSED_ARG(acked);
+  if (pcb->cwnd < pcb->ssthresh) {
+    tcp_cc_slow_start(pcb);
+  } else {
+    /* congestion avoidance: one mss per round trip */
+    tcp_cc_set_cwnd(pcb, pcb->cwnd + LWIP_MAX((u32_t)pcb->mss * pcb->mss / pcb->cwnd, 1));
+  }
+}
+
+static void
+tcp_newreno_loss(struct tcp_pcb *pcb, u8_t timeout)
+{
+  LWIP_UNUSED_ARG(timeout);
+  tcp_cc_set_ssthresh(pcb, 5);
+}
+
+const struct tcp_cc tcp_cc_newreno = {
+  "newreno",
+  tcp_newreno_ack,
+  tcp_newreno_loss
+};
+
+/*-------------------------------------------------------------------------*/
+/* CUBIC (RFC 8312) with beta 0.7 and C 0.4, in integer arithmetic: windows
+   in segments << 4, time in milliseconds of sys_now(). */
+
+/**
+ * Integer cube root, rounded down.
+ */
+static u32_t
+tcp_cubic_cbrt(u32_t x)
+{
+  u32_t lo = 0, hi = 1626, mid; /* 1625^3 is the largest cube below 2^32 */
+
+  while (hi - lo > 1) {
+    mid = (lo + hi) / 2;
+    if (mid * mid * mid <= x) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/**
+ * Start a congestion avoidance epoch: K, the time until the window function
+ * is back at W_max, is cbrt((W_max - cwnd) / C).
+ */
+static void
+tcp_cubic_epoch(struct tcp_pcb *pcb, u32_t now)
+{
+  struct tcp_cc_state *st = &pcb->cc_state;
+  u32_t d16;
+
+  st->epoch = (now != 0) ? now : 1;
+  st->w_est = (u32_t)pcb->cwnd << 4;
+  if (pcb->cwnd < st->w_max) {
+    /* K in units of 10 ms: cbrt(d / 0.4) * 100 = cbrt(d16 * 2.5e6 / 16) */
+    d16 = LWIP_MIN(((u32_t)(st->w_max - pcb->cwnd) << 4) / pcb->mss, 27487);
+    st->k = (u16_t)(tcp_cubic_cbrt(d16 * 156250) * 10);
+  } else {
+    st->w_max = pcb->cwnd;
+    st->k = 0;
+  }
+}
+
+static void
+tcp_cubic_ack(struct tcp_pcb *pcb, u16_t acked)
+{
+  struct tcp_cc_state *st = &pcb->cc_state;
+  u32_t now, target, cwnd, inc;
+  s32_t t, cube;
+
+  if (pcb->cwnd < pcb->ssthresh) {
+    tcp_cc_slow_start(pcb);
+    return;
+  }
+  now = sys_now();
+  if (st->epoch == 0) {
+    tcp_cubic_epoch(pcb, now);
+  }
+
+  /* W_cubic(t) = C * (t - K)^3 + W_max, in segments << 4 */
+  t = (s32_t)(now - st->epoch) - st->k;
+  t = LWIP_MAX(LWIP_MIN(t, TCP_CUBIC_T_MAX), -TCP_CUBIC_T_MAX);
+  cube = t * t / 1000 * t / 1000;          /* (t / 1000 s)^3 * 1000 */
+  cube = cube * 64 / 10000;                /* * C * 16 / 1000 */
+  cube = LWIP_MIN(cube, TCP_CUBIC_DELTA_MAX);
+  target = (u32_t)LWIP_MAX(((s32_t)(((u32_t)st->w_max << 4) / pcb->mss) + cube), 0);
+  target = target * pcb->mss >> 4;         /* bytes */
+
+  /* the Reno-friendly window grows by 3 * (1 - beta) / (1 + beta) mss
+     (0.53, 17/32 << 4) per round trip */
+  st->w_est = LWIP_MIN(st->w_est + ((u32_t)pcb->mss * acked / pcb->cwnd) * 17 / 2,
+                       0xFFFFUL << 4);
+  target = LWIP_MIN(LWIP_MAX(target, st->w_est >> 4), 0xFFFF);
+
+  cwnd = pcb->cwnd;
+  if (target > cwnd) {
+    /* approach the target within a round trip, by at most half of what
+       was acked per ACK */
+    inc = (target - cwnd) * acked / cwnd;
+    cwnd += LWIP_MAX(LWIP_MIN(inc, (u32_t)acked / 2), 1);
+  }
+  tcp_cc_set_cwnd(pcb, cwnd);
+}
+
+static void
+tcp_cubic_loss(struct tcp_pcb *pcb, u8_t timeout)
+{
+  struct tcp_cc_state *st = &pcb->cc_state;
+
+  LWIP_UNUSED_ARG(timeout);
+  st->epoch = 0;
+  if (pcb->cwnd < st->w_max) {
+    /* fast convergence: release bandwidth to new flows */
+    st->w_max = (u16_t)((u32_t)pcb->cwnd * 17 / 20);
+  } else {
+    st->w_max = pcb->cwnd;
+  }
+  tcp_cc_set_ssthresh(pcb, 7);
+}
+
+const struct tcp_cc tcp_cc_cubic = {
+  "cubic",
+  tcp_cubic_ack,
+  tcp_cubic_loss
+};
+
+#endif /* LWIP_TCP && LWIP_TCP_CC */
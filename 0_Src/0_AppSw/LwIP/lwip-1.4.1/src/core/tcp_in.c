@@ -54,6 +54,9 @@
 #include "lwip/inet_chksum.h"
 #include "lwip/stats.h"
 #include "lwip/snmp.h"
+#if TCP_RTO_RFC6298
+#include "lwip/sys.h"
+#endif
 #include "arch/perf.h"
 
 /* These variables are global to all functions involved in the input
@@ -75,6 +78,12 @@ struct tcp_pcb *tcp_input_pcb;
 static err_t tcp_process(struct tcp_pcb *pcb);
 static void tcp_receive(struct tcp_pcb *pcb);
 static void tcp_parseopt(struct tcp_pcb *pcb);
+#if TCP_RTO_RFC6298
+static void tcp_rtt_sample(struct tcp_pcb *pcb);
+#endif /* TCP_RTO_RFC6298 */
+#if LWIP_TCP_SACK
+static u8_t tcp_sack_is_lost(struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_SACK */
 
 static err_t tcp_listen_input(struct tcp_pcb_listen *pcb);
 static err_t tcp_timewait_input(struct tcp_pcb *pcb);
@@ -129,8 +138,9 @@ tcp_input(struct pbuf *p, struct netif *inp)
 
 #if CHECKSUM_CHECK_TCP
   /* Verify TCP checksum. */
-  if (inet_chksum_pseudo(p, ip_current_src_addr(), ip_current_dest_addr(),
-      IP_PROTO_TCP, p->tot_len) != 0) {
+  if (IP_CHECKSUM_CHECK_ENABLED(inp, NETIF_CHECKSUM_CHECK_TCP) &&
+      (inet_chksum_pseudo(p, ip_current_src_addr(), ip_current_dest_addr(),
+      IP_PROTO_TCP, p->tot_len) != 0)) {
       LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packet discarded due to failing checksum 0x%04"X16_F"\n",
         inet_chksum_pseudo(p, ip_current_src_addr(), ip_current_dest_addr(),
       IP_PROTO_TCP, p->tot_len)));
@@ -166,7 +176,75 @@ tcp_input(struct pbuf *p, struct netif *inp)
      for an active connection. */
   prev = NULL;
 
-  
+#if TCP_PCB_HASH
+  LWIP_UNUSED_ARG(prev);
+  {
+    struct tcp_pcb *twpcb = NULL;
+
+    /* Active and TIME-WAIT pcbs share one table, an active pcb is preferred
+       as with the lists. */
+    for (pcb = tcp_conn_hash[tcp_hash_conn(tcphdr->dest, tcphdr->src, &current_iphdr_src)];
+         pcb != NULL; pcb = pcb->hash_next) {
+      LWIP_ASSERT("tcp_input: hashed pcb->state != CLOSED", pcb->state != CLOSED);
+      LWIP_ASSERT("tcp_input: hashed pcb->state != LISTEN", pcb->state != LISTEN);
+      if (pcb->remote_port == tcphdr->src &&
+         pcb->local_port == tcphdr->dest &&
+         ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src) &&
+         ip_addr_cmp(&(pcb->local_ip), &current_iphdr_dest)) {
+        if (pcb->state != TIME_WAIT) {
+          break;
+        }
+        if (twpcb == NULL) {
+          twpcb = pcb;
+        }
+      }
+    }
+    if ((pcb == NULL) && (twpcb != NULL)) {
+      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for TIME_WAITing connection.\n"));
+      tcp_timewait_input(twpcb);
+      pbuf_free(p);
+      return;
+    }
+  }
+
+  if (pcb == NULL) {
+    /* Then the listening pcbs of the destination port */
+    for(lpcb = (struct tcp_pcb_listen *)tcp_listen_hash[TCP_PCB_HASH_PORT(tcphdr->dest)];
+        lpcb != NULL; lpcb = (struct tcp_pcb_listen *)lpcb->hash_next) {
+      if (lpcb->local_port == tcphdr->dest) {
+#if SO_REUSE
+        if (ip_addr_cmp(&(lpcb->local_ip), &current_iphdr_dest)) {
+          /* found an exact match */
+          break;
+        } else if(ip_addr_isany(&(lpcb->local_ip))) {
+          /* found an ANY-match */
+          lpcb_any = lpcb;
+        }
+#else /* SO_REUSE */
+        if (ip_addr_cmp(&(lpcb->local_ip), &current_iphdr_dest) ||
+            ip_addr_isany(&(lpcb->local_ip))) {
+          /* found a match */
+          break;
+        }
+#endif /* SO_REUSE */
+      }
+    }
+#if SO_REUSE
+    /* first try specific local IP */
+    if (lpcb == NULL) {
+      /* only pass to ANY if no specific local IP has been found */
+      lpcb = lpcb_any;
+    }
+    LWIP_UNUSED_ARG(lpcb_prev);
+#endif /* SO_REUSE */
+    if (lpcb != NULL) {
+      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: packed for LISTENing connection.\n"));
+      tcp_listen_input(lpcb);
+      pbuf_free(p);
+      return;
+    }
+  }
+#else /* TCP_PCB_HASH */
   for(pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
     LWIP_ASSERT("tcp_input: active pcb->state != CLOSED", pcb->state != CLOSED);
     LWIP_ASSERT("tcp_input: active pcb->state != TIME-WAIT", pcb->state != TIME_WAIT);
@@ -260,6 +338,7 @@ tcp_input(struct pbuf *p, struct netif *inp)
       return;
     }
   }
+#endif /* TCP_PCB_HASH */
 
 #if TCP_INPUT_DEBUG
   LWIP_DEBUGF(TCP_INPUT_DEBUG, ("+-+-+-+-+-+-+-+-+-+-+-+-+-+- tcp_input: flags "));
@@ -502,6 +581,10 @@ tcp_listen_input(struct tcp_pcb_listen *pcb)
 #if TCP_CALCULATE_EFF_SEND_MSS
     npcb->mss = tcp_eff_send_mss(npcb->mss, &(npcb->remote_ip));
 #endif /* TCP_CALCULATE_EFF_SEND_MSS */
+#if TCP_RCV_AUTOTUNE
+    /* the SYN|ACK announces the window the PBUF_POOL allows */
+    tcp_update_rcv_ann_wnd(npcb);
+#endif /* TCP_RCV_AUTOTUNE */
 
     snmp_inc_tcppassiveopens();
 
@@ -656,12 +739,19 @@ tcp_process(struct tcp_pcb *pcb)
       pcb->unacked = rseg->next;
       tcp_seg_free(rseg);
 
+#if TCP_RTO_RFC6298
+      /* the SYN/ACK ends the measurement started by the SYN */
+      if (pcb->rttest && TCP_SEQ_LT(pcb->rtseq, ackno)) {
+        tcp_rtt_sample(pcb);
+      }
+#endif /* TCP_RTO_RFC6298 */
+
       /* If there's nothing left to acknowledge, stop the retransmit
          timer, otherwise reset it to start again */
       if(pcb->unacked == NULL)
-        pcb->rtime = -1;
+        TCP_RTO_STOP(pcb);
       else {
-        pcb->rtime = 0;
+        TCP_RTO_RESTART(pcb);
         pcb->nrtx = 0;
       }
 
@@ -793,18 +883,23 @@ tcp_process(struct tcp_pcb *pcb)
 #if TCP_QUEUE_OOSEQ
 /**
  * Insert segment into the list (segments covered with new one will be deleted)
+ * and account for it in pcb->ooseq_len and pcb->ooseq_last.
  *
  * Called from tcp_receive()
  */
 static void
-tcp_oos_insert_segment(struct tcp_seg *cseg, struct tcp_seg *next)
+tcp_oos_insert_segment(struct tcp_pcb *pcb, struct tcp_seg *cseg, struct tcp_seg *next)
 {
   struct tcp_seg *old_seg;
 
   if (TCPH_FLAGS(cseg->tcphdr) & TCP_FIN) {
     /* received segment overlaps all following segments */
-    tcp_segs_free(next);
-    next = NULL;
+    while (next != NULL) {
+      old_seg = next;
+      next = next->next;
+      pcb->ooseq_len -= old_seg->len;
+      tcp_seg_free(old_seg);
+    }
   }
   else {
     /* delete some following segments
@@ -818,6 +913,7 @@ tcp_oos_insert_segment(struct tcp_seg *cseg, struct tcp_seg *next)
       }
       old_seg = next;
       next = next->next;
+      pcb->ooseq_len -= old_seg->len;
       tcp_seg_free(old_seg);
     }
     if (next &&
@@ -828,9 +924,91 @@ tcp_oos_insert_segment(struct tcp_seg *cseg, struct tcp_seg *next)
     }
   }
   cseg->next = next;
+  pcb->ooseq_len += cseg->len;
+  if (next == NULL) {
+    pcb->ooseq_last = cseg;
+  }
+}
+
+/**
+ * Decides if the out-of-sequence segment inseg goes on the ooseq queue:
+ * not while the PBUF_POOL is down to TCP_RCV_POOL_RESERVE buffers
+ * (TCP_RCV_AUTOTUNE) and not behind the last segment when the queue would
+ * exceed TCP_OOSEQ_MAX_BYTES. A segment which fills a hole is queued, the
+ * limit then cuts the end of the queue.
+ *
+ * Called from tcp_receive()
+ */
+static u8_t
+tcp_oos_accept(struct tcp_pcb *pcb)
+{
+#if TCP_RCV_AUTOTUNE
+  if (memp_num_free(MEMP_PBUF_POOL) < TCP_RCV_POOL_RESERVE) {
+    return 0;
+  }
+#endif /* TCP_RCV_AUTOTUNE */
+#if TCP_OOSEQ_MAX_BYTES
+  if ((pcb->ooseq_len + inseg.len > TCP_OOSEQ_MAX_BYTES) &&
+      ((pcb->ooseq_last == NULL) || TCP_SEQ_GT(seqno, pcb->ooseq_last->tcphdr->seqno))) {
+    return 0;
+  }
+#endif /* TCP_OOSEQ_MAX_BYTES */
+  LWIP_UNUSED_ARG(pcb);
+  return 1;
 }
 #endif /* TCP_QUEUE_OOSEQ */
 
+#if TCP_RTO_RFC6298
+/**
+ * Computes the retransmission timeout from the RTT estimator:
+ * SRTT + max(G, 4 * RTTVAR) with a clock granularity G of 1 ms, limited to
+ * TCP_RTO_MIN and TCP_RTO_MAX (RFC 6298, 2.3 and 2.4).
+ *
+ * @param pcb the tcp_pcb with at least one RTT sample
+ */
+static void
+tcp_rto_update(struct tcp_pcb *pcb)
+{
+  u32_t rto;
+
+  rto = (pcb->srtt >> 3) + LWIP_MAX(pcb->rttvar, 1);
+  pcb->rto_ms = LWIP_MIN(LWIP_MAX(rto, TCP_RTO_MIN), TCP_RTO_MAX);
+}
+
+/**
+ * Feeds the RTT of the timed segment (pcb->rttest, a sys_now() value) into
+ * the estimator (RFC 6298, 2.2 and 2.3) and ends the measurement.
+ *
+ * @param pcb the tcp_pcb that received the ACK for pcb->rtseq
+ */
+static void
+tcp_rtt_sample(struct tcp_pcb *pcb)
+{
+  u32_t r;
+  s32_t delta;
+
+  r = LWIP_MAX(sys_now() - pcb->rttest, 1);
+  if (pcb->srtt == 0) {
+    /* first measurement: SRTT = R, RTTVAR = R / 2 */
+    pcb->srtt = r << 3;
+    pcb->rttvar = r << 1;
+  } else {
+    /* RTTVAR = 3/4 RTTVAR + 1/4 |SRTT - R|, SRTT = 7/8 SRTT + 1/8 R */
+    delta = (s32_t)(r - (pcb->srtt >> 3));
+    pcb->srtt += delta;
+    if (delta < 0) {
+      delta = -delta;
+    }
+    pcb->rttvar = pcb->rttvar - (pcb->rttvar >> 2) + (u32_t)delta;
+  }
+  tcp_rto_update(pcb);
+
+  LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_rtt_sample: rtt %"U32_F" ms, rto %"U32_F" ms\n",
+                              r, pcb->rto_ms));
+  pcb->rttest = 0;
+}
+#endif /* TCP_RTO_RFC6298 */
+
 /**
  * Called by tcp_process. Checks if the given segment is an ACK for outstanding
  * data, and if so frees the memory of the buffered data. Next, is places the
@@ -852,7 +1030,12 @@ tcp_receive(struct tcp_pcb *pcb)
 #endif /* TCP_QUEUE_OOSEQ */
   struct pbuf *p;
   s32_t off;
+#if !TCP_RTO_RFC6298
   s16_t m;
+#endif /* !TCP_RTO_RFC6298 */
+#if LWIP_TCP_CC
+  u8_t partial_ack;
+#endif /* LWIP_TCP_CC */
   u32_t right_wnd_edge;
   u16_t new_tot_len;
   int found_dupack = 0;
@@ -928,19 +1111,38 @@ tcp_receive(struct tcp_pcb *pcb)
         /* Clause 3 */
         if (pcb->snd_wl2 + pcb->snd_wnd == right_wnd_edge){
           /* Clause 4 */
-          if (pcb->rtime >= 0) {
+          if (TCP_RTO_RUNNING(pcb)) {
             /* Clause 5 */
             if (pcb->lastack == ackno) {
               found_dupack = 1;
               if ((u8_t)(pcb->dupacks + 1) > pcb->dupacks) {
                 ++pcb->dupacks;
               }
+#if LWIP_TCP_SACK
+              /* Three segments SACKed above the first unacked one mark it
+                 lost even if dupacks got lost on the way (RFC 6675, IsLost) */
+              if ((pcb->dupacks < 3) && (pcb->flags2 & TF2_SACK) && tcp_sack_is_lost(pcb)) {
+                pcb->dupacks = 3;
+              }
+#endif /* LWIP_TCP_SACK */
               if (pcb->dupacks > 3) {
                 /* Inflate the congestion window, but not if it means that
                    the value overflows. */
+#if LWIP_TCP_CC
+                /* Only in fast recovery: after a time-out the dupacks for
+                   the retransmitted data must not open the window. */
+                if (((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) && (pcb->flags & TF_INFR)) {
+#else /* LWIP_TCP_CC */
                 if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+#endif /* LWIP_TCP_CC */
                   pcb->cwnd += pcb->mss;
                 }
+#if LWIP_TCP_SACK
+                /* every dupack in recovery repairs the next hole */
+                if ((pcb->flags & TF_INFR) && (pcb->flags2 & TF2_SACK)) {
+                  tcp_rexmit_sack(pcb);
+                }
+#endif /* LWIP_TCP_SACK */
               } else if (pcb->dupacks == 3) {
                 /* Do fast retransmit */
                 tcp_rexmit_fast(pcb);
@@ -957,6 +1159,20 @@ tcp_receive(struct tcp_pcb *pcb)
     } else if (TCP_SEQ_BETWEEN(ackno, pcb->lastack+1, pcb->snd_nxt)){
       /* We come here when the ACK acknowledges new data. */
 
+#if LWIP_TCP_CC
+      partial_ack = 0;
+      if (pcb->flags & TF_INFR) {
+        if (TCP_SEQ_LT(ackno, pcb->recover)) {
+          /* A partial ACK: the next segment was lost as well, stay in
+             fast recovery (RFC 6582, 3.2 step 5). */
+          partial_ack = 1;
+        } else {
+          /* A full ACK ends fast recovery. */
+          pcb->flags &= ~TF_INFR;
+          pcb->cwnd = pcb->ssthresh;
+        }
+      }
+#else /* LWIP_TCP_CC */
       /* Reset the "IN Fast Retransmit" flag, since we are no longer
          in fast retransmit. Also reset the congestion window to the
          slow start threshold. */
@@ -964,12 +1180,19 @@ tcp_receive(struct tcp_pcb *pcb)
         pcb->flags &= ~TF_INFR;
         pcb->cwnd = pcb->ssthresh;
       }
+#endif /* LWIP_TCP_CC */
 
       /* Reset the number of retransmissions. */
       pcb->nrtx = 0;
 
       /* Reset the retransmission time-out. */
+#if TCP_RTO_RFC6298
+      if (pcb->srtt != 0) {
+        tcp_rto_update(pcb);
+      }
+#else /* TCP_RTO_RFC6298 */
       pcb->rto = (pcb->sa >> 3) + pcb->sv;
+#endif /* TCP_RTO_RFC6298 */
 
       /* Update the send buffer space. Diff between the two can never exceed 64K? */
       pcb->acked = (u16_t)(ackno - pcb->lastack);
@@ -983,6 +1206,21 @@ tcp_receive(struct tcp_pcb *pcb)
       /* Update the congestion control variables (cwnd and
          ssthresh). */
       if (pcb->state >= ESTABLISHED) {
+#if LWIP_TCP_CC
+        if (partial_ack) {
+          /* Deflate by the amount acked, then add back one mss for the
+             retransmission (RFC 6582, 3.2 step 5). */
+          pcb->cwnd = (pcb->cwnd > pcb->acked) ? (u16_t)(pcb->cwnd - pcb->acked) : 0;
+          pcb->cwnd = LWIP_MAX(pcb->cwnd, pcb->mss);
+          if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+            pcb->cwnd += pcb->mss;
+          }
+          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: partial ACK cwnd %"U16_F"\n", pcb->cwnd));
+        } else {
+          pcb->cc->ack(pcb, pcb->acked);
+          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: %s cwnd %"U16_F"\n", pcb->cc->name, pcb->cwnd));
+        }
+#else /* LWIP_TCP_CC */
         if (pcb->cwnd < pcb->ssthresh) {
           if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
             pcb->cwnd += pcb->mss;
@@ -995,6 +1233,7 @@ tcp_receive(struct tcp_pcb *pcb)
           }
           LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: congestion avoidance cwnd %"U16_F"\n", pcb->cwnd));
         }
+#endif /* LWIP_TCP_CC */
       }
       LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: ACK for %"U32_F", unacked->seqno %"U32_F":%"U32_F"\n",
                                     ackno,
@@ -1036,9 +1275,26 @@ tcp_receive(struct tcp_pcb *pcb)
       /* If there's nothing left to acknowledge, stop the retransmit
          timer, otherwise reset it to start again */
       if(pcb->unacked == NULL)
-        pcb->rtime = -1;
+        TCP_RTO_STOP(pcb);
       else
-        pcb->rtime = 0;
+        TCP_RTO_RESTART(pcb);
+
+#if LWIP_TCP_CC
+      if (partial_ack && pcb->unacked != NULL) {
+        /* retransmit the first unacknowledged segment */
+#if LWIP_TCP_SACK
+        if (pcb->flags2 & TF2_SACK) {
+          if (!tcp_rexmit_sack(pcb) && !(pcb->unacked->flags & TF_SEG_SACK_REXMIT) &&
+              (tcp_rexmit(pcb) == ERR_OK)) {
+            pcb->unsent->flags |= TF_SEG_SACK_REXMIT;
+          }
+        } else
+#endif /* LWIP_TCP_SACK */
+        {
+          tcp_rexmit(pcb);
+        }
+      }
+#endif /* LWIP_TCP_CC */
 
       pcb->polltmr = 0;
     } else {
@@ -1089,6 +1345,9 @@ tcp_receive(struct tcp_pcb *pcb)
        incoming segment acknowledges the segment we use to take a
        round-trip time measurement. */
     if (pcb->rttest && TCP_SEQ_LT(pcb->rtseq, ackno)) {
+#if TCP_RTO_RFC6298
+      tcp_rtt_sample(pcb);
+#else /* TCP_RTO_RFC6298 */
       /* diff between this shouldn't exceed 32K since this are tcp timer ticks
          and a round-trip shouldn't be that long... */
       m = (s16_t)(tcp_ticks - pcb->rttest);
@@ -1110,6 +1369,7 @@ tcp_receive(struct tcp_pcb *pcb)
                                   pcb->rto, pcb->rto * TCP_SLOW_INTERVAL));
 
       pcb->rttest = 0;
+#endif /* TCP_RTO_RFC6298 */
     }
   }
 
@@ -1250,11 +1510,7 @@ tcp_receive(struct tcp_pcb *pcb)
             /* Received in-order FIN means anything that was received
              * out of order must now have been received in-order, so
              * bin the ooseq queue */
-            while (pcb->ooseq != NULL) {
-              struct tcp_seg *old_ooseq = pcb->ooseq;
-              pcb->ooseq = pcb->ooseq->next;
-              tcp_seg_free(old_ooseq);
-            }
+            tcp_free_ooseq(pcb);
           } else {
             next = pcb->ooseq;
             /* Remove all segments on ooseq that are covered by inseg already.
@@ -1270,6 +1526,7 @@ tcp_receive(struct tcp_pcb *pcb)
               }
               prev = next;
               next = next->next;
+              pcb->ooseq_len -= prev->len;
               tcp_seg_free(prev);
             }
             /* Now trim right side of inseg if it overlaps with the first
@@ -1288,6 +1545,9 @@ tcp_receive(struct tcp_pcb *pcb)
                           (seqno + tcplen) == next->tcphdr->seqno);
             }
             pcb->ooseq = next;
+            if (next == NULL) {
+              pcb->ooseq_last = NULL;
+            }
           }
         }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -1356,6 +1616,10 @@ tcp_receive(struct tcp_pcb *pcb)
           }
 
           pcb->ooseq = cseg->next;
+          pcb->ooseq_len -= cseg->len;
+          if (pcb->ooseq == NULL) {
+            pcb->ooseq_last = NULL;
+          }
           tcp_seg_free(cseg);
         }
 #endif /* TCP_QUEUE_OOSEQ */
@@ -1369,8 +1633,14 @@ tcp_receive(struct tcp_pcb *pcb)
         tcp_send_empty_ack(pcb);
 #if TCP_QUEUE_OOSEQ
         /* We queue the segment on the ->ooseq queue. */
-        if (pcb->ooseq == NULL) {
+        if (!tcp_oos_accept(pcb)) {
+          LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: out-of-sequence segment not queued\n"));
+        } else if (pcb->ooseq == NULL) {
           pcb->ooseq = tcp_seg_copy(&inseg);
+          if (pcb->ooseq != NULL) {
+            pcb->ooseq_last = pcb->ooseq;
+            pcb->ooseq_len = inseg.len;
+          }
         } else {
           /* If the queue is not empty, we walk through the queue and
              try to find a place where the sequence number of the
@@ -1382,10 +1652,17 @@ tcp_receive(struct tcp_pcb *pcb)
 
              If the incoming segment has the same sequence number as a
              segment on the ->ooseq queue, we discard the segment that
-             contains less data. */
+             contains less data.
+
+             Most segments go behind the last one (the sender goes on
+             after a loss), these skip the walk through the queue. */
 
           prev = NULL;
-          for(next = pcb->ooseq; next != NULL; next = next->next) {
+          next = pcb->ooseq;
+          if (TCP_SEQ_GT(seqno, pcb->ooseq_last->tcphdr->seqno)) {
+            next = pcb->ooseq_last;
+          }
+          for(; next != NULL; next = next->next) {
             if (seqno == next->tcphdr->seqno) {
               /* The sequence number of the incoming segment is the
                  same as the sequence number of the segment on
@@ -1402,7 +1679,7 @@ tcp_receive(struct tcp_pcb *pcb)
                   } else {
                     pcb->ooseq = cseg;
                   }
-                  tcp_oos_insert_segment(cseg, next);
+                  tcp_oos_insert_segment(pcb, cseg, next);
                 }
                 break;
               } else {
@@ -1421,7 +1698,7 @@ tcp_receive(struct tcp_pcb *pcb)
                   cseg = tcp_seg_copy(&inseg);
                   if (cseg != NULL) {
                     pcb->ooseq = cseg;
-                    tcp_oos_insert_segment(cseg, next);
+                    tcp_oos_insert_segment(pcb, cseg, next);
                   }
                   break;
                 }
@@ -1438,11 +1715,13 @@ tcp_receive(struct tcp_pcb *pcb)
                   if (cseg != NULL) {
                     if (TCP_SEQ_GT(prev->tcphdr->seqno + prev->len, seqno)) {
                       /* We need to trim the prev segment. */
+                      pcb->ooseq_len -= prev->len;
                       prev->len = (u16_t)(seqno - prev->tcphdr->seqno);
+                      pcb->ooseq_len += prev->len;
                       pbuf_realloc(prev->p, prev->len);
                     }
                     prev->next = cseg;
-                    tcp_oos_insert_segment(cseg, next);
+                    tcp_oos_insert_segment(pcb, cseg, next);
                   }
                   break;
                 }
@@ -1460,7 +1739,9 @@ tcp_receive(struct tcp_pcb *pcb)
                 if (next->next != NULL) {
                   if (TCP_SEQ_GT(next->tcphdr->seqno + next->len, seqno)) {
                     /* We need to trim the last segment. */
+                    pcb->ooseq_len -= next->len;
                     next->len = (u16_t)(seqno - next->tcphdr->seqno);
+                    pcb->ooseq_len += next->len;
                     pbuf_realloc(next->p, next->len);
                   }
                   /* check if the remote side overruns our receive window */
@@ -1481,6 +1762,8 @@ tcp_receive(struct tcp_pcb *pcb)
                     LWIP_ASSERT("tcp_receive: segment not trimmed correctly to rcv_wnd\n",
                                 (seqno + tcplen) == (pcb->rcv_nxt + pcb->rcv_wnd));
                   }
+                  pcb->ooseq_len += next->next->len;
+                  pcb->ooseq_last = next->next;
                 }
                 break;
               }
@@ -1490,26 +1773,36 @@ tcp_receive(struct tcp_pcb *pcb)
         }
 #if TCP_OOSEQ_MAX_BYTES || TCP_OOSEQ_MAX_PBUFS
         /* Check that the data on ooseq doesn't exceed one of the limits
-           and throw away everything above that limit. */
-        ooseq_blen = 0;
-        ooseq_qlen = 0;
-        prev = NULL;
-        for(next = pcb->ooseq; next != NULL; prev = next, next = next->next) {
-          struct pbuf *p = next->p;
-          ooseq_blen += p->tot_len;
-          ooseq_qlen += pbuf_clen(p);
-          if ((ooseq_blen > TCP_OOSEQ_MAX_BYTES) ||
-              (ooseq_qlen > TCP_OOSEQ_MAX_PBUFS)) {
-             /* too much ooseq data, dump this and everything after it */
-             tcp_segs_free(next);
-             if (prev == NULL) {
-               /* first ooseq segment is too much, dump the whole queue */
-               pcb->ooseq = NULL;
-             } else {
-               /* just dump 'next' and everything after it */
-               prev->next = NULL;
-             }
-             break;
+           and throw away everything above that limit. The byte count is
+           kept in pcb->ooseq_len, the queue is only walked to cut it or
+           to count the pbufs. */
+#if TCP_OOSEQ_MAX_PBUFS
+        if (pcb->ooseq != NULL)
+#else /* TCP_OOSEQ_MAX_PBUFS */
+        if (pcb->ooseq_len > TCP_OOSEQ_MAX_BYTES)
+#endif /* TCP_OOSEQ_MAX_PBUFS */
+        {
+          ooseq_blen = 0;
+          ooseq_qlen = 0;
+          prev = NULL;
+          for(next = pcb->ooseq; next != NULL; prev = next, next = next->next) {
+            ooseq_blen += next->len;
+            ooseq_qlen += pbuf_clen(next->p);
+            if ((TCP_OOSEQ_MAX_BYTES && (ooseq_blen > TCP_OOSEQ_MAX_BYTES)) ||
+                (TCP_OOSEQ_MAX_PBUFS && (ooseq_qlen > TCP_OOSEQ_MAX_PBUFS))) {
+               /* too much ooseq data, dump this and everything after it */
+               pcb->ooseq_len = ooseq_blen - next->len;
+               pcb->ooseq_last = prev;
+               tcp_segs_free(next);
+               if (prev == NULL) {
+                 /* first ooseq segment is too much, dump the whole queue */
+                 pcb->ooseq = NULL;
+               } else {
+                 /* just dump 'next' and everything after it */
+                 prev->next = NULL;
+               }
+               break;
+            }
           }
         }
 #endif /* TCP_OOSEQ_MAX_BYTES || TCP_OOSEQ_MAX_PBUFS */
@@ -1530,6 +1823,71 @@ tcp_receive(struct tcp_pcb *pcb)
   }
 }
 
+#if LWIP_TCP_SACK
+/**
+ * Marks the unacked segments covered by the blocks of a received SACK
+ * option and raises pcb->sack_high to the highest right edge.
+ *
+ * @param pcb the tcp_pcb for which a segment arrived
+ * @param blocks the left and right edges of the blocks, in network order
+ * @param n number of blocks
+ */
+static void
+tcp_sack_mark(struct tcp_pcb *pcb, const u8_t *blocks, u8_t n)
+{
+  struct tcp_seg *seg;
+  u32_t left, right, seqno;
+
+  if (!TCP_SEQ_GT(pcb->sack_high, pcb->lastack)) {
+    /* stale from an earlier recovery */
+    pcb->sack_high = pcb->lastack;
+  }
+  for (; n > 0; n--, blocks += 8) {
+    left = ((u32_t)blocks[0] << 24) | ((u32_t)blocks[1] << 16) |
+           ((u32_t)blocks[2] << 8) | blocks[3];
+    right = ((u32_t)blocks[4] << 24) | ((u32_t)blocks[5] << 16) |
+            ((u32_t)blocks[6] << 8) | blocks[7];
+    if (!TCP_SEQ_LT(left, right) || TCP_SEQ_GT(right, pcb->snd_nxt)) {
+      /* invalid block */
+      continue;
+    }
+    for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+      seqno = ntohl(seg->tcphdr->seqno);
+      if (!TCP_SEQ_LT(seqno, right)) {
+        break;
+      }
+      if (TCP_SEQ_GEQ(seqno, left) && TCP_SEQ_LEQ(seqno + TCP_TCPLEN(seg), right)) {
+        seg->flags |= TF_SEG_SACKED;
+      }
+    }
+    if (TCP_SEQ_GT(right, pcb->sack_high)) {
+      pcb->sack_high = right;
+    }
+  }
+}
+
+/**
+ * Checks the scoreboard for three segments SACKed above the first
+ * unacked one (DupThresh, RFC 6675).
+ *
+ * @param pcb the tcp_pcb that received a duplicate ACK
+ * @return 1 if the first unacked segment is considered lost
+ */
+static u8_t
+tcp_sack_is_lost(struct tcp_pcb *pcb)
+{
+  struct tcp_seg *seg;
+  u8_t sacked = 0;
+
+  for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+    if ((seg->flags & TF_SEG_SACKED) && (++sacked >= 3)) {
+      return 1;
+    }
+  }
+  return 0;
+}
+#endif /* LWIP_TCP_SACK */
+
 /**
  * Parses the options contained in the incoming segment. 
  *
@@ -1600,6 +1958,33 @@ tcp_parseopt(struct tcp_pcb *pcb)
         c += 0x0A;
         break;
 #endif
+#if LWIP_TCP_SACK
+      case 0x04:
+        LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK permitted\n"));
+        if (opts[c + 1] != 0x02 || c + 0x02 > max_c) {
+          /* Bad length */
+          LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+          return;
+        }
+        if (flags & TCP_SYN) {
+          pcb->flags2 |= TF2_SACK;
+        }
+        c += 0x02;
+        break;
+      case 0x05:
+        LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: SACK\n"));
+        if (opts[c + 1] < 0x0A || ((opts[c + 1] - 2) & 0x07) != 0 ||
+            c + opts[c + 1] > max_c) {
+          /* Bad length */
+          LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: bad length\n"));
+          return;
+        }
+        if (pcb->flags2 & TF2_SACK) {
+          tcp_sack_mark(pcb, &opts[c + 2], (u8_t)((opts[c + 1] - 2) >> 3));
+        }
+        c += opts[c + 1];
+        break;
+#endif /* LWIP_TCP_SACK */
       default:
         LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_parseopt: other\n"));
         if (opts[c + 1] == 0) {
@@ -51,7 +51,7 @@
 #include "lwip/inet_chksum.h"
 #include "lwip/stats.h"
 #include "lwip/snmp.h"
-#if LWIP_TCP_TIMESTAMPS
+#if LWIP_TCP_TIMESTAMPS || TCP_RTO_RFC6298
 #include "lwip/sys.h"
 #endif
 
@@ -71,14 +71,38 @@
 #define TCP_DATA_COPY2(dst, src, len, chksum, chksum_swapped) MEMCPY(dst, src, len)
 #endif /* TCP_CHECKSUM_ON_COPY*/
 
+/* tcp_write() and tcp_writev() set PSH on their last segment unless more data follows */
+#if LWIP_TCP_CORK
+#define TCP_WRITE_PUSH(pcb, apiflags) ((((apiflags) & TCP_WRITE_FLAG_MORE) == 0) && !tcp_corked(pcb))
+#else /* LWIP_TCP_CORK */
+#define TCP_WRITE_PUSH(pcb, apiflags) (((apiflags) & TCP_WRITE_FLAG_MORE) == 0)
+#endif /* LWIP_TCP_CORK */
+
 /** Define this to 1 for an extra check that the output checksum is valid
  * (usefule when the checksum is generated by the application, not the stack) */
 #ifndef TCP_CHECKSUM_ON_COPY_SANITY_CHECK
 #define TCP_CHECKSUM_ON_COPY_SANITY_CHECK   0
 #endif
 
+#if LWIP_TCP_GSO
+/** Segments tcp_output() collects for a super-segment, queued in this order */
+struct tcp_gso_batch {
+  struct tcp_seg *first;
+  struct netif *netif;
+  u16_t segs;
+  u32_t len;
+  /** TX descriptors the segments take when sent in place (see tcp_gso_descs()) */
+  u16_t descs;
+};
+#endif /* LWIP_TCP_GSO */
+
 /* Forward declarations.*/
+#if LWIP_TCP_GSO
+static void tcp_gso_output_segment(struct tcp_pcb *pcb, struct tcp_gso_batch *gso, struct tcp_seg *seg);
+static void tcp_gso_flush(struct tcp_pcb *pcb, struct tcp_gso_batch *gso);
+#else /* LWIP_TCP_GSO */
 static void tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_GSO */
 
 /** Allocate a pbuf and create a tcphdr at p->payload, used for output
  * functions other than the default tcp_output -> tcp_output_segment
@@ -115,6 +139,47 @@ tcp_output_alloc_header(struct tcp_pcb *pcb, u16_t optlen, u16_t datalen,
   return p;
 }
 
+/** Route a segment built by tcp_output_alloc_header() or tcp_rst(), calculate
+ * its checksum unless the output netif does it and send it to IP.
+ *
+ * @param pcb tcp pcb holding the ARP hint (may be NULL)
+ * @param p pbuf with p->payload being the tcp_hdr
+ * @param src source IP address
+ * @param dst destination IP address
+ * @param ttl the TTL value to be set in the IP header
+ * @param tos the TOS value to be set in the IP header
+ * @return ERR_RTE if no route is found, the result of ip_output_if() otherwise
+ */
+static err_t
+tcp_output_control(struct tcp_pcb *pcb, struct pbuf *p, ip_addr_t *src,
+                   ip_addr_t *dst, u8_t ttl, u8_t tos)
+{
+  struct netif *netif;
+  err_t err;
+
+  netif = ip_route(dst);
+  if (netif == NULL) {
+    IP_STATS_INC(ip.rterr);
+    return ERR_RTE;
+  }
+#if CHECKSUM_GEN_TCP
+  if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_TCP)) {
+    struct tcp_hdr *tcphdr = (struct tcp_hdr *)p->payload;
+    tcphdr->chksum = inet_chksum_pseudo(p, src, dst, IP_PROTO_TCP, p->tot_len);
+  }
+#endif /* CHECKSUM_GEN_TCP */
+#if LWIP_NETIF_HWADDRHINT
+  if (pcb != NULL) {
+    NETIF_SET_HWADDRHINT(netif, &(pcb->addr_hint));
+  }
+#else /* LWIP_NETIF_HWADDRHINT */
+  LWIP_UNUSED_ARG(pcb);
+#endif /* LWIP_NETIF_HWADDRHINT */
+  err = ip_output_if(p, src, dst, ttl, tos, IP_PROTO_TCP, netif);
+  NETIF_SET_HWADDRHINT(netif, NULL);
+  return err;
+}
+
 /**
  * Called by tcp_close() to send a segment including FIN flag but not data.
  *
@@ -241,9 +306,12 @@ tcp_pbuf_prealloc(pbuf_layer layer, u16_t length, u16_t max_length,
      *
      * Did the user set TCP_WRITE_FLAG_MORE?
      *
-     * Will the Nagle algorithm defer transmission of this segment?
+     * Will the Nagle algorithm or the cork defer transmission of this segment?
      */
     if ((apiflags & TCP_WRITE_FLAG_MORE) ||
+#if LWIP_TCP_CORK
+        tcp_corked(pcb) ||
+#endif /* LWIP_TCP_CORK */
         (!(pcb->flags & TF_NODELAY) &&
          (!first_seg ||
           pcb->unsent != NULL ||
@@ -505,6 +573,10 @@ tcp_write(struct tcp_pcb *pcb, const void *arg, u16_t len, u8_t apiflags)
 
       pos += seglen;
       queuelen += pbuf_clen(concat_p);
+      if ((queuelen > TCP_SND_QUEUELEN) || (queuelen > TCP_SNDQUEUELEN_OVERFLOW)) {
+        LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_write: queue too long %"U16_F" (%"U16_F")\n", queuelen, TCP_SND_QUEUELEN));
+        goto memerr;
+      }
     }
   } else {
 #if TCP_OVERSIZE
@@ -685,7 +757,7 @@ tcp_write(struct tcp_pcb *pcb, const void *arg, u16_t len, u8_t apiflags)
   }
 
   /* Set the PSH flag in the last segment that we enqueued. */
-  if (seg != NULL && seg->tcphdr != NULL && ((apiflags & TCP_WRITE_FLAG_MORE)==0)) {
+  if (seg != NULL && seg->tcphdr != NULL && TCP_WRITE_PUSH(pcb, apiflags)) {
     TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
   }
 
@@ -708,6 +780,310 @@ memerr:
   return ERR_MEM;
 }
 
+#if LWIP_TCP_WRITEV
+/** Drops one reference to a tcp_writev() call and calls its callback with the last one. */
+static void
+tcp_writev_release(struct tcp_writev_req *req)
+{
+  LWIP_ASSERT("tcp_writev: reference count", req->refs > 0);
+  if (--req->refs == 0) {
+    tcp_writev_done_fn done = req->done;
+    void *done_arg = req->done_arg;
+
+    memp_free(MEMP_TCP_WRITEV, req);
+    if (done != NULL) {
+      done(done_arg);
+    }
+  }
+}
+
+/** Custom free function of the PBUF_REF pbufs created by tcp_writev(). */
+static void
+tcp_writev_pbuf_free(struct pbuf *p)
+{
+  struct tcp_writev_pbuf *wp = (struct tcp_writev_pbuf *)p;
+  struct tcp_writev_req *req = wp->req;
+
+  memp_free(MEMP_TCP_WRITEV_PBUF, wp);
+  tcp_writev_release(req);
+}
+
+/**
+ * Create the PBUF_REF pbufs for the next bytes of a tcp_writev() call: one
+ * pbuf per buffer covered, each referencing the call.
+ *
+ * @param req the tcp_writev() call
+ * @param iov the buffers of the call
+ * @param idx index of the current buffer, advanced past the bytes taken
+ * @param off offset into the current buffer, advanced past the bytes taken
+ * @param len number of bytes to take, not more than left in the buffers
+ * @return the pbuf chain, or NULL if out of memory
+ */
+static struct pbuf *
+tcp_writev_slices(struct tcp_writev_req *req, const struct tcp_iovec *iov,
+                  u16_t *idx, u16_t *off, u16_t len)
+{
+  struct pbuf *chain = NULL;
+
+  while (len > 0) {
+    struct tcp_writev_pbuf *wp;
+    struct pbuf *p;
+    u16_t n;
+
+    /* skip exhausted and empty buffers */
+    while (*off == iov[*idx].len) {
+      (*idx)++;
+      *off = 0;
+    }
+    n = LWIP_MIN(len, iov[*idx].len - *off);
+
+    wp = (struct tcp_writev_pbuf *)memp_malloc(MEMP_TCP_WRITEV_PBUF);
+    if (wp == NULL) {
+      LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_writev: could not allocate memory for zero-copy pbuf\n"));
+      if (chain != NULL) {
+        pbuf_free(chain);
+      }
+      return NULL;
+    }
+    wp->pc.custom_free_function = tcp_writev_pbuf_free;
+    wp->req = req;
+    req->refs++;
+    p = pbuf_alloced_custom(PBUF_RAW, n, PBUF_REF, &wp->pc, (u8_t*)iov[*idx].base + *off, n);
+    if (chain == NULL) {
+      chain = p;
+    } else {
+      pbuf_cat(chain, p);
+    }
+    *off += n;
+    len -= n;
+  }
+  return chain;
+}
+
+#if TCP_CHECKSUM_ON_COPY
+/** Add the checksum of the data pbufs of tcp_writev() to a segment */
+static void
+tcp_writev_chksum(struct pbuf *p, u16_t *seg_chksum, u8_t *seg_chksum_swapped)
+{
+  for (; p != NULL; p = p->next) {
+    tcp_seg_add_chksum(~inet_chksum(p->payload, p->len), p->len, seg_chksum,
+      seg_chksum_swapped);
+  }
+}
+#endif /* TCP_CHECKSUM_ON_COPY */
+
+/**
+ * Write the data of several buffers for sending without copying it.
+ *
+ * Works like tcp_write() without TCP_WRITE_FLAG_COPY, but the segments are
+ * filled across the buffers and reference them with PBUF_REF pbufs. The
+ * buffers must not change until 'done' is called: after the stack and the
+ * netif driver released the last of these pbufs, i.e. when the data was
+ * ACKed and its frames have left the DMA, or when the connection was closed
+ * or aborted. 'done' is not called if tcp_writev() returns an error.
+ *
+ * @param pcb Protocol control block for the TCP connection to enqueue data for.
+ * @param iov the buffers, 64 KB at most in total; empty buffers are skipped
+ * @param iovcnt number of buffers
+ * @param done function to call when the buffers are released, or NULL
+ * @param done_arg argument passed to 'done'
+ * @param apiflags TCP_WRITE_FLAG_MORE to not set PSH on the last segment,
+ *        TCP_WRITE_FLAG_COPY is ignored
+ * @return ERR_OK if enqueued, another err_t on error
+ */
+err_t
+tcp_writev(struct tcp_pcb *pcb, const struct tcp_iovec *iov, u16_t iovcnt,
+           tcp_writev_done_fn done, void *done_arg, u8_t apiflags)
+{
+  struct tcp_writev_req *req;
+  struct pbuf *concat_p = NULL;
+  struct tcp_seg *last_unsent = NULL, *seg = NULL, *prev_seg = NULL, *queue = NULL;
+  u32_t total = 0;
+  u16_t len;
+  u16_t pos = 0; /* position in the data of all buffers */
+  u16_t idx = 0, off = 0; /* current buffer and offset into it */
+  u16_t queuelen;
+  u16_t i;
+  u8_t optlen = 0;
+  u8_t optflags = 0;
+  err_t err;
+  /* don't allocate segments bigger than half the maximum window we ever received */
+  u16_t mss_local = LWIP_MIN(pcb->mss, pcb->snd_wnd_max/2);
+
+  LWIP_ERROR("tcp_writev: iov == NULL (programmer violates API)",
+             (iov != NULL) || (iovcnt == 0), return ERR_ARG;);
+  for (i = 0; i < iovcnt; i++) {
+    LWIP_ERROR("tcp_writev: base == NULL (programmer violates API)",
+               (iov[i].base != NULL) || (iov[i].len == 0), return ERR_ARG;);
+    total += iov[i].len;
+  }
+  LWIP_ERROR("tcp_writev: more than 64 KB (programmer violates API)",
+             total <= 0xffff, return ERR_ARG;);
+  len = (u16_t)total;
+
+  LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_writev(pcb=%p, iovcnt=%"U16_F", len=%"U16_F", apiflags=%"U16_F")\n",
+    (void *)pcb, iovcnt, len, (u16_t)apiflags));
+
+  err = tcp_write_checks(pcb, len);
+  if (err != ERR_OK) {
+    return err;
+  }
+  if (len == 0) {
+    /* nothing to reference */
+    if (done != NULL) {
+      done(done_arg);
+    }
+    return ERR_OK;
+  }
+
+  req = (struct tcp_writev_req *)memp_malloc(MEMP_TCP_WRITEV);
+  if (req == NULL) {
+    LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_writev: could not allocate memory for the request\n"));
+    pcb->flags |= TF_NAGLEMEMERR;
+    TCP_STATS_INC(tcp.memerr);
+    return ERR_MEM;
+  }
+  req->done = done;
+  req->done_arg = done_arg;
+  /* held until the segments are queued, so that a failure can free them silently */
+  req->refs = 1;
+  queuelen = pcb->snd_queuelen;
+
+#if LWIP_TCP_TIMESTAMPS
+  if ((pcb->flags & TF_TIMESTAMP)) {
+    optflags = TF_SEG_OPTS_TS;
+    optlen = LWIP_TCP_OPT_LENGTH(TF_SEG_OPTS_TS);
+  }
+#endif /* LWIP_TCP_TIMESTAMPS */
+
+  /* Fill the last unsent segment first (phase 2 of tcp_write). The data
+   * follows any bytes tcp_write() copied into its oversized pbuf, which
+   * ends the oversize of that segment. */
+  if (pcb->unsent != NULL) {
+    u16_t space;
+
+    for (last_unsent = pcb->unsent; last_unsent->next != NULL;
+         last_unsent = last_unsent->next);
+
+    space = mss_local - (last_unsent->len + LWIP_TCP_OPT_LENGTH(last_unsent->flags));
+    if ((space > 0) && (last_unsent->len > 0)) {
+      u16_t seglen = LWIP_MIN(space, len);
+
+      if ((concat_p = tcp_writev_slices(req, iov, &idx, &off, seglen)) == NULL) {
+        goto memerr;
+      }
+      seg = last_unsent;
+      pos += seglen;
+      queuelen += pbuf_clen(concat_p);
+      if ((queuelen > TCP_SND_QUEUELEN) || (queuelen > TCP_SNDQUEUELEN_OVERFLOW)) {
+        LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_writev: queue too long %"U16_F" (%"U16_F")\n", queuelen, TCP_SND_QUEUELEN));
+        goto memerr;
+      }
+    }
+  }
+
+  /* Create new segments: a header pbuf followed by the data pbufs (phase 3
+   * of tcp_write). */
+  while (pos < len) {
+    struct pbuf *p, *data;
+    u16_t left = len - pos;
+    u16_t max_len = mss_local - optlen;
+    u16_t seglen = left > max_len ? max_len : left;
+
+    if ((data = tcp_writev_slices(req, iov, &idx, &off, seglen)) == NULL) {
+      goto memerr;
+    }
+    if ((p = pbuf_alloc(PBUF_TRANSPORT, optlen, PBUF_RAM)) == NULL) {
+      pbuf_free(data);
+      LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_writev: could not allocate memory for header pbuf\n"));
+      goto memerr;
+    }
+    pbuf_cat(p/*header*/, data);
+
+    queuelen += pbuf_clen(p);
+    if ((queuelen > TCP_SND_QUEUELEN) || (queuelen > TCP_SNDQUEUELEN_OVERFLOW)) {
+      LWIP_DEBUGF(TCP_OUTPUT_DEBUG | 2, ("tcp_writev: queue too long %"U16_F" (%"U16_F")\n", queuelen, TCP_SND_QUEUELEN));
+      pbuf_free(p);
+      goto memerr;
+    }
+
+    if ((seg = tcp_create_segment(pcb, p, 0, pcb->snd_lbb + pos, optflags)) == NULL) {
+      goto memerr;
+    }
+#if TCP_CHECKSUM_ON_COPY
+    tcp_writev_chksum(data, &seg->chksum, &seg->chksum_swapped);
+    seg->flags |= TF_SEG_DATA_CHECKSUMMED;
+#endif /* TCP_CHECKSUM_ON_COPY */
+
+    if (queue == NULL) {
+      queue = seg;
+    } else {
+      LWIP_ASSERT("prev_seg != NULL", prev_seg != NULL);
+      prev_seg->next = seg;
+    }
+    prev_seg = seg;
+
+    LWIP_DEBUGF(TCP_OUTPUT_DEBUG | LWIP_DBG_TRACE, ("tcp_writev: queueing %"U32_F":%"U32_F"\n",
+      ntohl(seg->tcphdr->seqno),
+      ntohl(seg->tcphdr->seqno) + TCP_TCPLEN(seg)));
+
+    pos += seglen;
+  }
+
+  /* Commit: the tail of pcb->unsent is a data pbuf of this call now. */
+  if (concat_p != NULL) {
+    pbuf_cat(last_unsent->p, concat_p);
+    last_unsent->len += concat_p->tot_len;
+#if TCP_CHECKSUM_ON_COPY
+    tcp_writev_chksum(concat_p, &last_unsent->chksum, &last_unsent->chksum_swapped);
+    last_unsent->flags |= TF_SEG_DATA_CHECKSUMMED;
+#endif /* TCP_CHECKSUM_ON_COPY */
+#if TCP_OVERSIZE_DBGCHECK
+    last_unsent->oversize_left = 0;
+#endif /* TCP_OVERSIZE_DBGCHECK */
+  }
+#if TCP_OVERSIZE
+  pcb->unsent_oversize = 0;
+#endif /* TCP_OVERSIZE */
+  if (last_unsent == NULL) {
+    pcb->unsent = queue;
+  } else {
+    last_unsent->next = queue;
+  }
+
+  pcb->snd_lbb += len;
+  pcb->snd_buf -= len;
+  pcb->snd_queuelen = queuelen;
+
+  LWIP_DEBUGF(TCP_QLEN_DEBUG, ("tcp_writev: %"S16_F" (after enqueued)\n",
+    pcb->snd_queuelen));
+
+  /* Set the PSH flag in the last segment that we enqueued. */
+  if (seg != NULL && seg->tcphdr != NULL && TCP_WRITE_PUSH(pcb, apiflags)) {
+    TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
+  }
+
+  /* the pbufs keep the request now */
+  tcp_writev_release(req);
+  return ERR_OK;
+memerr:
+  pcb->flags |= TF_NAGLEMEMERR;
+  TCP_STATS_INC(tcp.memerr);
+
+  /* nothing was queued: free the pbufs without calling 'done' */
+  req->done = NULL;
+  if (concat_p != NULL) {
+    pbuf_free(concat_p);
+  }
+  if (queue != NULL) {
+    tcp_segs_free(queue);
+  }
+  tcp_writev_release(req);
+  LWIP_DEBUGF(TCP_QLEN_DEBUG | LWIP_DBG_STATE, ("tcp_writev: %"S16_F" (with mem err)\n", pcb->snd_queuelen));
+  return ERR_MEM;
+}
+#endif /* LWIP_TCP_WRITEV */
+
 /**
  * Enqueue TCP options for transmission.
  *
@@ -742,6 +1118,12 @@ tcp_enqueue_flags(struct tcp_pcb *pcb, u8_t flags)
 
   if (flags & TCP_SYN) {
     optflags = TF_SEG_OPTS_MSS;
+#if LWIP_TCP_SACK
+    /* offer SACK on a SYN, confirm it on a SYN/ACK if the SYN offered it */
+    if (!(flags & TCP_ACK) || (pcb->flags2 & TF2_SACK)) {
+      optflags |= TF_SEG_OPTS_SACK_PERM;
+    }
+#endif /* LWIP_TCP_SACK */
   }
 #if LWIP_TCP_TIMESTAMPS
   if ((pcb->flags & TF_TIMESTAMP)) {
@@ -857,6 +1239,7 @@ tcp_send_empty_ack(struct tcp_pcb *pcb)
     return ERR_BUF;
   }
   tcphdr = (struct tcp_hdr *)p->payload;
+  LWIP_UNUSED_ARG(tcphdr); /* only used with LWIP_TCP_TIMESTAMPS */
   LWIP_DEBUGF(TCP_OUTPUT_DEBUG, 
               ("tcp_output: sending ACK for %"U32_F"\n", pcb->rcv_nxt));
   /* remove ACK flags from the PCB, as we send an empty ACK now */
@@ -871,17 +1254,7 @@ tcp_send_empty_ack(struct tcp_pcb *pcb)
   }
 #endif 
 
-#if CHECKSUM_GEN_TCP
-  tcphdr->chksum = inet_chksum_pseudo(p, &(pcb->local_ip), &(pcb->remote_ip),
-        IP_PROTO_TCP, p->tot_len);
-#endif
-#if LWIP_NETIF_HWADDRHINT
-  ip_output_hinted(p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
-      IP_PROTO_TCP, &(pcb->addr_hint));
-#else /* LWIP_NETIF_HWADDRHINT*/
-  ip_output(p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
-      IP_PROTO_TCP);
-#endif /* LWIP_NETIF_HWADDRHINT*/
+  tcp_output_control(pcb, p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos);
   pbuf_free(p);
 
   return ERR_OK;
@@ -902,6 +1275,9 @@ tcp_output(struct tcp_pcb *pcb)
 #if TCP_CWND_DEBUG
   s16_t i = 0;
 #endif /* TCP_CWND_DEBUG */
+#if LWIP_TCP_GSO
+  struct tcp_gso_batch gso = {NULL, NULL, 0, 0, 0};
+#endif /* LWIP_TCP_GSO */
 
   /* pcb->state LISTEN not allowed here */
   LWIP_ASSERT("don't call tcp_output for listen-pcbs",
@@ -914,6 +1290,9 @@ tcp_output(struct tcp_pcb *pcb)
   if (tcp_input_pcb == pcb) {
     return ERR_OK;
   }
+#if LWIP_TCP_CORK
+  pcb->flags2 &= ~TF2_CORK_HELD;
+#endif /* LWIP_TCP_CORK */
 
   wnd = LWIP_MIN(pcb->snd_wnd, pcb->cwnd);
 
@@ -963,6 +1342,13 @@ tcp_output(struct tcp_pcb *pcb)
          ntohl(seg->tcphdr->seqno) - pcb->lastack + seg->len <= wnd) {
     LWIP_ASSERT("RST not expected here!", 
                 (TCPH_FLAGS(seg->tcphdr) & TCP_RST) == 0);
+#if LWIP_TCP_CORK
+    /* Hold back a short last segment of a corked pcb */
+    if (tcp_do_output_cork(pcb, seg) == 0) {
+      pcb->flags2 |= TF2_CORK_HELD;
+      break;
+    }
+#endif /* LWIP_TCP_CORK */
     /* Stop sending if the nagle algorithm would prevent it
      * Don't stop:
      * - if tcp_write had a memory error before (prevent delayed ACK timeout) or
@@ -990,7 +1376,11 @@ tcp_output(struct tcp_pcb *pcb)
       pcb->flags &= ~(TF_ACK_DELAY | TF_ACK_NOW);
     }
 
+#if LWIP_TCP_GSO
+    tcp_gso_output_segment(pcb, &gso, seg);
+#else /* LWIP_TCP_GSO */
     tcp_output_segment(seg, pcb);
+#endif /* LWIP_TCP_GSO */
     snd_nxt = ntohl(seg->tcphdr->seqno) + TCP_TCPLEN(seg);
     if (TCP_SEQ_LT(pcb->snd_nxt, snd_nxt)) {
       pcb->snd_nxt = snd_nxt;
@@ -1028,6 +1418,9 @@ tcp_output(struct tcp_pcb *pcb)
     }
     seg = pcb->unsent;
   }
+#if LWIP_TCP_GSO
+  tcp_gso_flush(pcb, &gso);
+#endif /* LWIP_TCP_GSO */
 #if TCP_OVERSIZE
   if (pcb->unsent == NULL) {
     /* last unsent has been removed, reset unsent_oversize */
@@ -1036,22 +1429,88 @@ tcp_output(struct tcp_pcb *pcb)
 #endif /* TCP_OVERSIZE */
 
   pcb->flags &= ~TF_NAGLEMEMERR;
+#if LWIP_TCP_CORK
+  if ((pcb->flags2 & TF2_CORK_HELD) && (pcb->flags & TF_ACK_NOW)) {
+    /* the held segment must not delay the ACK */
+    return tcp_send_empty_ack(pcb);
+  }
+#endif /* LWIP_TCP_CORK */
   return ERR_OK;
 }
 
+#if LWIP_TCP_CORK
 /**
- * Called by tcp_output() to actually send a TCP segment over IP.
+ * Send the data queued on a pcb, also the segment held back by tcp_cork():
+ * PSH is set on the last unsent segment. The pcb stays corked.
+ *
+ * @param pcb Protocol control block for the TCP connection to send data
+ * @return ERR_OK if data has been sent or nothing to send
+ *         another err_t on error
+ */
+err_t
+tcp_flush(struct tcp_pcb *pcb)
+{
+  struct tcp_seg *seg = pcb->unsent;
+
+  if (seg != NULL) {
+    for (; seg->next != NULL; seg = seg->next);
+    if (seg->len > 0) {
+      TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
+    }
+  }
+  return tcp_output(pcb);
+}
+
+/**
+ * End the corked mode of tcp_cork() and send the data held back.
+ *
+ * @param pcb Protocol control block for the TCP connection
+ * @return ERR_OK if data has been sent or nothing to send
+ *         another err_t on error
+ */
+err_t
+tcp_uncork(struct tcp_pcb *pcb)
+{
+  pcb->flags2 &= ~TF2_CORK;
+  return tcp_flush(pcb);
+}
+#endif /* LWIP_TCP_CORK */
+
+/**
+ * Checks whether the netif still holds the pbuf of a segment, e.g. a frame
+ * the DMA reads in place: its headers must not be rewritten until then.
+ *
+ * @param seg the tcp_seg to check
+ * @return 1 if the segment is busy
+ */
+static u8_t
+tcp_output_segment_busy(struct tcp_seg *seg)
+{
+  /* an idle segment is the only reference to its first pbuf */
+  return (seg->p->ref != 1) ? 1 : 0;
+}
+
+/**
+ * Called by tcp_output() to fill in the TCP header of a segment, route it and
+ * start the timers. p->payload of the segment is its TCP header afterwards.
  *
  * @param seg the tcp_seg to send
  * @param pcb the tcp_pcb for the TCP connection used to send the segment
+ * @return the netif to send the segment on, NULL if there is no route
  */
-static void
-tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
+static struct netif *
+tcp_output_segment_prepare(struct tcp_seg *seg, struct tcp_pcb *pcb)
 {
   u16_t len;
   struct netif *netif;
   u32_t *opts;
 
+  if (tcp_output_segment_busy(seg)) {
+    /* the rexmit functions don't requeue busy segments: it stays unacked */
+    LWIP_DEBUGF(TCP_RTO_DEBUG | LWIP_DBG_LEVEL_SERIOUS, ("tcp_output_segment: segment busy\n"));
+    return NULL;
+  }
+
   /** @bug Exclude retransmitted segments from this count. */
   snmp_inc_tcpoutsegs();
 
@@ -1077,6 +1536,12 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
     *opts = TCP_BUILD_MSS_OPTION(mss);
     opts += 1;
   }
+#if LWIP_TCP_SACK
+  if (seg->flags & TF_SEG_OPTS_SACK_PERM) {
+    *opts = TCP_SACK_PERM_OPTION;
+    opts += 1;
+  }
+#endif /* LWIP_TCP_SACK */
 #if LWIP_TCP_TIMESTAMPS
   pcb->ts_lastacksent = pcb->rcv_nxt;
 
@@ -1088,22 +1553,31 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 
   /* Set retransmission timer running if it is not currently enabled 
      This must be set before checking the route. */
-  if (pcb->rtime == -1) {
-    pcb->rtime = 0;
-  }
+  TCP_RTO_START(pcb);
 
-  /* If we don't have a local IP address, we get one by
-     calling ip_route(). */
+  /* The checksum depends on the output netif: route first. If we don't
+     have a local IP address, we get one from that netif. */
+  netif = ip_route(&(pcb->remote_ip));
+  if (netif == NULL) {
+    IP_STATS_INC(ip.rterr);
+    return NULL;
+  }
   if (ip_addr_isany(&(pcb->local_ip))) {
-    netif = ip_route(&(pcb->remote_ip));
-    if (netif == NULL) {
-      return;
-    }
     ip_addr_copy(pcb->local_ip, netif->ip_addr);
   }
 
+#if TCP_RTO_RFC6298
+  /* Karn: only time new data, a retransmission gives an ambiguous sample */
+  if (pcb->rttest == 0 && TCP_SEQ_GEQ(ntohl(seg->tcphdr->seqno), pcb->snd_nxt)) {
+    pcb->rttest = sys_now();
+    if (pcb->rttest == 0) {
+      /* 0 means "not timing" */
+      pcb->rttest = 1;
+    }
+#else /* TCP_RTO_RFC6298 */
   if (pcb->rttest == 0) {
     pcb->rttest = tcp_ticks;
+#endif /* TCP_RTO_RFC6298 */
     pcb->rtseq = ntohl(seg->tcphdr->seqno);
 
     LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_output_segment: rtseq %"U32_F"\n", pcb->rtseq));
@@ -1119,10 +1593,24 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 
   seg->p->payload = seg->tcphdr;
 
+  return netif;
+}
+
+/**
+ * Calculate the checksum of a segment prepared by tcp_output_segment_prepare()
+ * unless the netif does it, and send the segment over IP.
+ *
+ * @param seg the tcp_seg to send
+ * @param pcb the tcp_pcb for the TCP connection used to send the segment
+ * @param netif the netif returned by tcp_output_segment_prepare()
+ */
+static void
+tcp_output_segment_send(struct tcp_seg *seg, struct tcp_pcb *pcb, struct netif *netif)
+{
   seg->tcphdr->chksum = 0;
 #if CHECKSUM_GEN_TCP
+  if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_TCP)) {
 #if TCP_CHECKSUM_ON_COPY
-  {
     u32_t acc;
 #if TCP_CHECKSUM_ON_COPY_SANITY_CHECK
     u16_t chksum_slow = inet_chksum_pseudo(seg->p, &(pcb->local_ip),
@@ -1153,24 +1641,261 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
       seg->tcphdr->chksum = chksum_slow;
     }
 #endif /* TCP_CHECKSUM_ON_COPY_SANITY_CHECK */
-  }
 #else /* TCP_CHECKSUM_ON_COPY */
-  seg->tcphdr->chksum = inet_chksum_pseudo(seg->p, &(pcb->local_ip),
-         &(pcb->remote_ip),
-         IP_PROTO_TCP, seg->p->tot_len);
+    seg->tcphdr->chksum = inet_chksum_pseudo(seg->p, &(pcb->local_ip),
+           &(pcb->remote_ip),
+           IP_PROTO_TCP, seg->p->tot_len);
 #endif /* TCP_CHECKSUM_ON_COPY */
+  }
 #endif /* CHECKSUM_GEN_TCP */
   TCP_STATS_INC(tcp.xmit);
 
-#if LWIP_NETIF_HWADDRHINT
-  ip_output_hinted(seg->p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
-      IP_PROTO_TCP, &(pcb->addr_hint));
-#else /* LWIP_NETIF_HWADDRHINT*/
-  ip_output(seg->p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
-      IP_PROTO_TCP);
-#endif /* LWIP_NETIF_HWADDRHINT*/
+  NETIF_SET_HWADDRHINT(netif, &(pcb->addr_hint));
+  ip_output_if(seg->p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
+      IP_PROTO_TCP, netif);
+  NETIF_SET_HWADDRHINT(netif, NULL);
+}
+
+#if !LWIP_TCP_GSO
+/**
+ * Called by tcp_output() to actually send a TCP segment over IP.
+ *
+ * @param seg the tcp_seg to send
+ * @param pcb the tcp_pcb for the TCP connection used to send the segment
+ */
+static void
+tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
+{
+  struct netif *netif = tcp_output_segment_prepare(seg, pcb);
+
+  if (netif != NULL) {
+    tcp_output_segment_send(seg, pcb, netif);
+  }
+}
+#else /* !LWIP_TCP_GSO */
+/** Custom free function of the header pbuf of a super-segment */
+static void
+tcp_gso_hdr_free(struct pbuf *p)
+{
+  memp_free(MEMP_TCP_GSO, p);
+}
+
+/** Custom free function of the data pbufs of a super-segment */
+static void
+tcp_gso_pbuf_free(struct pbuf *p)
+{
+  struct tcp_gso_pbuf *gp = (struct tcp_gso_pbuf *)p;
+  struct pbuf *original = gp->original;
+
+  memp_free(MEMP_TCP_GSO_PBUF, gp);
+  pbuf_free(original);
+}
+
+/**
+ * TX descriptors the netif needs for a segment of a super-segment sent in
+ * place: one for the headers and one per pbuf holding data of the segment.
+ *
+ * @param seg a segment prepared by tcp_output_segment_prepare()
+ * @return number of descriptors
+ */
+static u16_t
+tcp_gso_descs(struct tcp_seg *seg)
+{
+  struct pbuf *q;
+  u16_t off = TCPH_HDRLEN(seg->tcphdr) * 4;
+  u16_t n = 1;
+
+  for (q = seg->p; q != NULL; q = q->next) {
+    if (q->len > off) {
+      n++;
+      off = 0;
+    } else {
+      off -= q->len;
+    }
+  }
+  return n;
+}
+
+/**
+ * Checks whether a prepared segment can be sent in the super-segment of the
+ * segments collected so far, or start one if none is collected: same netif,
+ * contiguous, all but the last segment of the size of the first one, no SYN,
+ * FIN or RST, the same options and no more TX descriptors than netif->tx_descs.
+ *
+ * @param gso the segments collected by tcp_output()
+ * @param seg the next segment, prepared by tcp_output_segment_prepare()
+ * @param netif the netif to send seg on
+ * @return 1 if seg can be added to gso
+ */
+static u8_t
+tcp_gso_fits(struct tcp_gso_batch *gso, struct tcp_seg *seg, struct netif *netif)
+{
+  struct tcp_seg *first = gso->first;
+
+  if ((seg->len == 0) || (netif->gso_max_segs < 2) ||
+      ((TCPH_FLAGS(seg->tcphdr) & (TCP_SYN | TCP_FIN | TCP_RST)) != 0)) {
+    return 0;
+  }
+  if (gso->segs == 0) {
+    return 1;
+  }
+  return (netif == gso->netif) && (gso->segs < netif->gso_max_segs) &&
+         ((netif->tx_descs == 0) || (gso->descs + tcp_gso_descs(seg) <= netif->tx_descs)) &&
+         (gso->len == (u32_t)gso->segs * first->len) && (seg->len <= first->len) &&
+         (((seg->flags ^ first->flags) & TF_SEG_OPTS_TS) == 0) &&
+         (ntohl(seg->tcphdr->seqno) == ntohl(first->tcphdr->seqno) + gso->len) &&
+         ((u32_t)IP_HLEN + TCPH_HDRLEN(first->tcphdr) * 4 + gso->len + seg->len <= netif->gso_max_size);
+}
+
+/**
+ * Send the collected segments as one super-segment: a header pbuf copied from
+ * the first segment, followed by PBUF_REF pbufs over the data of all segments.
+ * The netif calculates the checksums of the segments it cuts.
+ *
+ * @param pcb the tcp_pcb for the TCP connection used to send the segments
+ * @param gso at least two segments collected by tcp_output()
+ * @return ERR_OK if sent, ERR_MEM if the pbufs could not be allocated, else the
+ *         error of ip_output_if(): the netif queues the frames of all segments
+ *         or none
+ */
+static err_t
+tcp_output_gso(struct tcp_pcb *pcb, struct tcp_gso_batch *gso)
+{
+  struct tcp_seg *seg = gso->first;
+  u16_t hdrlen = TCPH_HDRLEN(seg->tcphdr) * 4;
+  struct tcp_gso_hdr *gh;
+  struct tcp_gso_pbuf *gp;
+  struct tcp_hdr *tcphdr;
+  struct pbuf *p, *q, *last;
+  u32_t left;
+  u16_t i, off;
+  u8_t flags = 0;
+  err_t err;
+
+  gh = (struct tcp_gso_hdr *)memp_malloc(MEMP_TCP_GSO);
+  if (gh == NULL) {
+    LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_output_gso: no super-segment left\n"));
+    return ERR_MEM;
+  }
+  gh->gso.pc.custom_free_function = tcp_gso_hdr_free;
+  gh->gso.gso_size = seg->len;
+  gh->gso.gso_segs = gso->segs;
+  p = pbuf_alloced_custom(PBUF_IP, hdrlen, PBUF_RAM, &gh->gso.pc, gh->mem, sizeof(gh->mem));
+  LWIP_ASSERT("tcp_output_gso: header fits", p != NULL);
+  p->flags |= PBUF_FLAG_GSO;
+  MEMCPY(p->payload, seg->tcphdr, hdrlen);
+
+  last = p;
+  for (i = 0; i < gso->segs; i++, seg = seg->next) {
+    LWIP_ASSERT("tcp_output_gso: segments are queued in order", seg != NULL);
+    flags |= TCPH_FLAGS(seg->tcphdr);
+    /* the data follows the header in the pbufs of the segment */
+    for (q = seg->p, off = hdrlen; q != NULL; q = q->next) {
+      if (q->len > off) {
+        gp = (struct tcp_gso_pbuf *)memp_malloc(MEMP_TCP_GSO_PBUF);
+        if (gp == NULL) {
+          LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_output_gso: no data pbuf left\n"));
+          pbuf_free(p);
+          return ERR_MEM;
+        }
+        gp->pc.custom_free_function = tcp_gso_pbuf_free;
+        pbuf_ref(q);
+        gp->original = q;
+        last->next = pbuf_alloced_custom(PBUF_RAW, q->len - off, PBUF_REF, &gp->pc,
+                                         (u8_t *)q->payload + off, q->len - off);
+        last = last->next;
+        off = 0;
+      } else {
+        off -= q->len;
+      }
+    }
+  }
+  /* the chain was linked without pbuf_cat(), set the lengths once */
+  for (q = p, left = hdrlen + gso->len; q != NULL; q = q->next) {
+    q->tot_len = (u16_t)left;
+    left -= q->len;
+  }
+
+  /* PSH is sent on the last segment, the netif calculates the checksum */
+  tcphdr = (struct tcp_hdr *)p->payload;
+  TCPH_SET_FLAG(tcphdr, flags & TCP_PSH);
+  tcphdr->chksum = 0;
+
+  NETIF_SET_HWADDRHINT(gso->netif, &(pcb->addr_hint));
+  err = ip_output_if(p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
+      IP_PROTO_TCP, gso->netif);
+  NETIF_SET_HWADDRHINT(gso->netif, NULL);
+  pbuf_free(p);
+  if (err != ERR_OK) {
+    LWIP_DEBUGF(TCP_OUTPUT_DEBUG, ("tcp_output_gso: ip_output_if() failed: %d\n", err));
+    return err;
+  }
+  for (i = 0; i < gso->segs; i++) {
+    TCP_STATS_INC(tcp.xmit);
+  }
+  return ERR_OK;
 }
 
+/**
+ * Send the segments collected by tcp_output(): a super-segment for more
+ * than one, one by one for a single segment or when the super-segment could
+ * not be sent (out of memory, or the TX ring of the netif can't take all of
+ * its frames). The segments of a full ring are then sent as far as it takes
+ * them, the others are retransmitted like any lost segment.
+ *
+ * @param pcb the tcp_pcb for the TCP connection used to send the segments
+ * @param gso the segments collected, empty afterwards
+ */
+static void
+tcp_gso_flush(struct tcp_pcb *pcb, struct tcp_gso_batch *gso)
+{
+  struct tcp_seg *seg = gso->first;
+  u16_t i;
+
+  if ((gso->segs < 2) || (tcp_output_gso(pcb, gso) != ERR_OK)) {
+    for (i = 0; i < gso->segs; i++, seg = seg->next) {
+      tcp_output_segment_send(seg, pcb, gso->netif);
+    }
+  }
+  gso->first = NULL;
+  gso->segs = 0;
+  gso->len = 0;
+  gso->descs = 0;
+}
+
+/**
+ * Called by tcp_output() instead of tcp_output_segment(): the segment is
+ * prepared, and sent later in a super-segment when it may be one.
+ *
+ * @param pcb the tcp_pcb for the TCP connection used to send the segment
+ * @param gso the segments collected so far
+ * @param seg the tcp_seg to send
+ */
+static void
+tcp_gso_output_segment(struct tcp_pcb *pcb, struct tcp_gso_batch *gso, struct tcp_seg *seg)
+{
+  struct netif *netif = tcp_output_segment_prepare(seg, pcb);
+
+  if (netif == NULL) {
+    return;
+  }
+  if ((gso->segs > 0) && !tcp_gso_fits(gso, seg, netif)) {
+    tcp_gso_flush(pcb, gso);
+  }
+  if (tcp_gso_fits(gso, seg, netif)) {
+    if (gso->segs == 0) {
+      gso->first = seg;
+      gso->netif = netif;
+    }
+    gso->segs++;
+    gso->len += seg->len;
+    gso->descs += tcp_gso_descs(seg);
+  } else {
+    tcp_output_segment_send(seg, pcb, netif);
+  }
+}
+#endif /* !LWIP_TCP_GSO */
+
 /**
  * Send a TCP RESET packet (empty segment with RST flag set) either to
  * abort a connection or to show that there is no matching local connection
@@ -1216,14 +1941,10 @@ tcp_rst(u32_t seqno, u32_t ackno,
   tcphdr->chksum = 0;
   tcphdr->urgp = 0;
 
-#if CHECKSUM_GEN_TCP
-  tcphdr->chksum = inet_chksum_pseudo(p, local_ip, remote_ip,
-              IP_PROTO_TCP, p->tot_len);
-#endif
   TCP_STATS_INC(tcp.xmit);
   snmp_inc_tcpoutrsts();
    /* Send output with hardcoded TTL since we have no access to the pcb */
-  ip_output(p, local_ip, remote_ip, TCP_TTL, 0, IP_PROTO_TCP);
+  tcp_output_control(NULL, p, local_ip, remote_ip, TCP_TTL, 0);
   pbuf_free(p);
   LWIP_DEBUGF(TCP_RST_DEBUG, ("tcp_rst: seqno %"U32_F" ackno %"U32_F".\n", seqno, ackno));
 }
@@ -1244,8 +1965,29 @@ tcp_rexmit_rto(struct tcp_pcb *pcb)
     return;
   }
 
+  /* No retransmission while the netif holds one of the segments: the attempt
+     counts for the back-off and TCP_MAXRTX, the timer tries again */
+  for (seg = pcb->unacked; seg != NULL; seg = seg->next) {
+    if (tcp_output_segment_busy(seg)) {
+      LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_rexmit_rto: segment busy\n"));
+      ++pcb->nrtx;
+      TCP_RTO_START(pcb);
+      return;
+    }
+  }
+
   /* Move all unacked segments to the head of the unsent queue */
+#if LWIP_TCP_SACK
+  /* The peer may discard data it SACKed (RFC 2018): forget the scoreboard */
+  for (seg = pcb->unacked; ; seg = seg->next) {
+    seg->flags &= ~(TF_SEG_SACKED | TF_SEG_SACK_REXMIT);
+    if (seg->next == NULL) {
+      break;
+    }
+  }
+#else /* LWIP_TCP_SACK */
   for (seg = pcb->unacked; seg->next != NULL; seg = seg->next);
+#endif /* LWIP_TCP_SACK */
   /* concatenate unsent queue after unacked queue */
   seg->next = pcb->unsent;
   /* unsent queue is the concatenated queue (of unacked, unsent) */
@@ -1270,15 +2012,17 @@ tcp_rexmit_rto(struct tcp_pcb *pcb)
  * Called by tcp_receive() for fast retramsmit.
  *
  * @param pcb the tcp_pcb for which to retransmit the first unacked segment
+ * @return ERR_OK if the segment was requeued, ERR_VAL if there is none or
+ *         the netif still holds it
  */
-void
+err_t
 tcp_rexmit(struct tcp_pcb *pcb)
 {
   struct tcp_seg *seg;
   struct tcp_seg **cur_seg;
 
-  if (pcb->unacked == NULL) {
-    return;
+  if ((pcb->unacked == NULL) || tcp_output_segment_busy(pcb->unacked)) {
+    return ERR_VAL;
   }
 
   /* Move the first unacked segment to the unsent queue */
@@ -1300,7 +2044,8 @@ tcp_rexmit(struct tcp_pcb *pcb)
   }
 #endif /* TCP_OVERSIZE */
 
-  ++pcb->nrtx;
+  /* nrtx counts the time-outs only: it backs off the RTO and ends the
+     connection at TCP_MAXRTX */
 
   /* Don't take any rtt measurements after retransmitting. */
   pcb->rttest = 0;
@@ -1309,6 +2054,7 @@ tcp_rexmit(struct tcp_pcb *pcb)
   snmp_inc_tcpretranssegs();
   /* No need to call tcp_output: we are always called from tcp_input()
      and thus tcp_output directly returns. */
+  return ERR_OK;
 }
 
 
@@ -1320,15 +2066,33 @@ tcp_rexmit(struct tcp_pcb *pcb)
 void 
 tcp_rexmit_fast(struct tcp_pcb *pcb)
 {
+#if LWIP_TCP_CC
+  /* No new recovery for the dupacks of data sent before the last one
+     (RFC 6582, 4.1). */
+  if (pcb->unacked != NULL && !(pcb->flags & TF_INFR) &&
+      TCP_SEQ_GEQ(pcb->lastack, pcb->recover)) {
+#else /* LWIP_TCP_CC */
   if (pcb->unacked != NULL && !(pcb->flags & TF_INFR)) {
+#endif /* LWIP_TCP_CC */
     /* This is fast retransmit. Retransmit the first unacked segment. */
     LWIP_DEBUGF(TCP_FR_DEBUG, 
                 ("tcp_receive: dupacks %"U16_F" (%"U32_F
                  "), fast retransmit %"U32_F"\n",
                  (u16_t)pcb->dupacks, pcb->lastack,
                  ntohl(pcb->unacked->tcphdr->seqno)));
-    tcp_rexmit(pcb);
+    if (tcp_rexmit(pcb) != ERR_OK) {
+      /* the netif still holds the segment, the retransmission timer repairs it */
+      return;
+    }
 
+#if LWIP_TCP_CC
+    /* recovery ends once everything sent so far is ACKed (RFC 6582) */
+    pcb->recover = pcb->snd_nxt;
+#if LWIP_TCP_SACK
+    pcb->unsent->flags |= TF_SEG_SACK_REXMIT;
+#endif /* LWIP_TCP_SACK */
+    pcb->cc->loss(pcb, 0);
+#else /* LWIP_TCP_CC */
     /* Set ssthresh to half of the minimum of the current
      * cwnd and the advertised window */
     if (pcb->cwnd > pcb->snd_wnd) {
@@ -1345,12 +2109,71 @@ tcp_rexmit_fast(struct tcp_pcb *pcb)
                    pcb->ssthresh, 2*pcb->mss));
       pcb->ssthresh = 2*pcb->mss;
     }
+#endif /* LWIP_TCP_CC */
     
     pcb->cwnd = pcb->ssthresh + 3 * pcb->mss;
     pcb->flags |= TF_INFR;
   } 
 }
 
+#if LWIP_TCP_SACK
+/**
+ * Requeue the first hole of the SACK scoreboard for retransmission: the
+ * first unacked segment below the highest SACKed one that is neither SACKed
+ * nor retransmitted in this fast recovery yet.
+ *
+ * Called by tcp_receive() for the dupacks of a fast recovery.
+ *
+ * @param pcb the tcp_pcb in fast recovery
+ * @return 1 if a segment was requeued, 0 if there is no hole left or the netif
+ *         still holds the first one
+ */
+u8_t
+tcp_rexmit_sack(struct tcp_pcb *pcb)
+{
+  struct tcp_seg *seg;
+  struct tcp_seg **prev_seg;
+  struct tcp_seg **cur_seg;
+
+  for (prev_seg = &pcb->unacked; *prev_seg != NULL; prev_seg = &(*prev_seg)->next) {
+    seg = *prev_seg;
+    if (!TCP_SEQ_LT(ntohl(seg->tcphdr->seqno), pcb->sack_high)) {
+      return 0;
+    }
+    if ((seg->flags & (TF_SEG_SACKED | TF_SEG_SACK_REXMIT)) == 0) {
+      break;
+    }
+  }
+  if ((*prev_seg == NULL) || tcp_output_segment_busy(*prev_seg)) {
+    return 0;
+  }
+
+  LWIP_DEBUGF(TCP_FR_DEBUG, ("tcp_rexmit_sack: hole %"U32_F" below %"U32_F"\n",
+                             ntohl(seg->tcphdr->seqno), pcb->sack_high));
+  *prev_seg = seg->next;
+  seg->flags |= TF_SEG_SACK_REXMIT;
+
+  /* Keep the unsent queue sorted. */
+  cur_seg = &(pcb->unsent);
+  while (*cur_seg &&
+    TCP_SEQ_LT(ntohl((*cur_seg)->tcphdr->seqno), ntohl(seg->tcphdr->seqno))) {
+      cur_seg = &((*cur_seg)->next );
+  }
+  seg->next = *cur_seg;
+  *cur_seg = seg;
+#if TCP_OVERSIZE
+  if (seg->next == NULL) {
+    pcb->unsent_oversize = 0;
+  }
+#endif /* TCP_OVERSIZE */
+
+  /* not a time-out: nrtx stays, see tcp_rexmit() */
+  pcb->rttest = 0;
+  snmp_inc_tcpretranssegs();
+  return 1;
+}
+#endif /* LWIP_TCP_SACK */
+
 
 /**
  * Send keepalive packets to keep a connection active although
@@ -1364,7 +2187,6 @@ void
 tcp_keepalive(struct tcp_pcb *pcb)
 {
   struct pbuf *p;
-  struct tcp_hdr *tcphdr;
 
   LWIP_DEBUGF(TCP_DEBUG, ("tcp_keepalive: sending KEEPALIVE probe to %"U16_F".%"U16_F".%"U16_F".%"U16_F"\n",
                           ip4_addr1_16(&pcb->remote_ip), ip4_addr2_16(&pcb->remote_ip),
@@ -1379,21 +2201,10 @@ tcp_keepalive(struct tcp_pcb *pcb)
                 ("tcp_keepalive: could not allocate memory for pbuf\n"));
     return;
   }
-  tcphdr = (struct tcp_hdr *)p->payload;
-
-#if CHECKSUM_GEN_TCP
-  tcphdr->chksum = inet_chksum_pseudo(p, &pcb->local_ip, &pcb->remote_ip,
-                                      IP_PROTO_TCP, p->tot_len);
-#endif
   TCP_STATS_INC(tcp.xmit);
 
   /* Send output to IP */
-#if LWIP_NETIF_HWADDRHINT
-  ip_output_hinted(p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0, IP_PROTO_TCP,
-    &(pcb->addr_hint));
-#else /* LWIP_NETIF_HWADDRHINT*/
-  ip_output(p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0, IP_PROTO_TCP);
-#endif /* LWIP_NETIF_HWADDRHINT*/
+  tcp_output_control(pcb, p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0);
 
   pbuf_free(p);
 
@@ -1462,19 +2273,10 @@ tcp_zero_window_probe(struct tcp_pcb *pcb)
     pbuf_copy_partial(seg->p, d, 1, seg->p->tot_len - seg->len);
   }
 
-#if CHECKSUM_GEN_TCP
-  tcphdr->chksum = inet_chksum_pseudo(p, &pcb->local_ip, &pcb->remote_ip,
-                                      IP_PROTO_TCP, p->tot_len);
-#endif
   TCP_STATS_INC(tcp.xmit);
 
   /* Send output to IP */
-#if LWIP_NETIF_HWADDRHINT
-  ip_output_hinted(p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0, IP_PROTO_TCP,
-    &(pcb->addr_hint));
-#else /* LWIP_NETIF_HWADDRHINT*/
-  ip_output(p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0, IP_PROTO_TCP);
-#endif /* LWIP_NETIF_HWADDRHINT*/
+  tcp_output_control(pcb, p, &pcb->local_ip, &pcb->remote_ip, pcb->ttl, 0);
 
   pbuf_free(p);
 
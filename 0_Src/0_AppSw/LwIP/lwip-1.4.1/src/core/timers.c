@@ -60,11 +60,68 @@
 #include "lwip/pbuf.h"
 
 
+#if LWIP_TIMER_WHEEL
+/* A slot of level L spans 2^(L*SYS_TIMEO_BITS) ms. A timeout is kept on the
+   lowest level where its expiry only differs from timeo_now in the bits of
+   that level, so level 0 holds the timeouts of the next milliseconds. When
+   timeo_now enters a slot of a higher level, its timeouts cascade down. */
+#define SYS_TIMEO_BITS          5
+#define SYS_TIMEO_SLOTS         (1U << SYS_TIMEO_BITS)
+#define SYS_TIMEO_MASK          (SYS_TIMEO_SLOTS - 1)
+#define SYS_TIMEO_LEVELS        5
+/* The top level wraps around, its current slot has to stay empty */
+#define SYS_TIMEO_RANGE         ((1UL << (SYS_TIMEO_BITS * SYS_TIMEO_LEVELS)) - \
+                                 (1UL << (SYS_TIMEO_BITS * (SYS_TIMEO_LEVELS - 1))) - 1)
+#define SYS_TIMEO_INDEX(time, level) (((time) >> (SYS_TIMEO_BITS * (level))) & SYS_TIMEO_MASK)
+
+/** The timeout was allocated from MEMP_SYS_TIMEOUT by sys_timeout() */
+#define SYS_TIMEO_FLAG_POOL     0x01U
+
+/** The slots of all levels, each one a list of timeouts */
+static struct sys_timeo *timeo_wheel[SYS_TIMEO_LEVELS * SYS_TIMEO_SLOTS];
+/** Bitmap of the non-empty slots per level */
+static u32_t timeo_used[SYS_TIMEO_LEVELS];
+/** Time the wheel is positioned at, no pending timeout expires before */
+static u32_t timeo_now;
+#else /* LWIP_TIMER_WHEEL */
 /** The one and only timeout list */
 static struct sys_timeo *next_timeout;
 #if NO_SYS
 static u32_t timeouts_last_time;
 #endif /* NO_SYS */
+#endif /* LWIP_TIMER_WHEEL */
+
+#if LWIP_TIMER_WHEEL
+/* The cyclic timers are periodic entries, sys_check_timeouts() re-arms them */
+#if LWIP_TCP
+static struct sys_timeo tcp_timeo;
+#endif /* LWIP_TCP */
+#if IP_REASSEMBLY
+static struct sys_timeo ip_reass_timeo;
+#endif /* IP_REASSEMBLY */
+#if LWIP_ARP
+static struct sys_timeo arp_timeo;
+#endif /* LWIP_ARP */
+#if LWIP_DHCP
+static struct sys_timeo dhcp_coarse_timeo;
+static struct sys_timeo dhcp_fine_timeo;
+#endif /* LWIP_DHCP */
+#if LWIP_AUTOIP
+static struct sys_timeo autoip_timeo;
+#endif /* LWIP_AUTOIP */
+#if LWIP_IGMP
+static struct sys_timeo igmp_timeo;
+#endif /* LWIP_IGMP */
+#if LWIP_DNS
+static struct sys_timeo dns_timeo;
+#endif /* LWIP_DNS */
+
+#define LWIP_CYCLIC_TIMER_START(timeo, msecs, handler) sys_timeout_start(&(timeo), msecs, msecs, handler, NULL)
+#define LWIP_CYCLIC_TIMER_RESTART(msecs, handler)
+#else /* LWIP_TIMER_WHEEL */
+#define LWIP_CYCLIC_TIMER_START(timeo, msecs, handler) sys_timeout(msecs, handler, NULL)
+#define LWIP_CYCLIC_TIMER_RESTART(msecs, handler)      sys_timeout(msecs, handler, NULL)
+#endif /* LWIP_TIMER_WHEEL */
 
 #if LWIP_TCP
 /** global variable that shows if the tcp timer is currently scheduled or not */
@@ -85,10 +142,13 @@ tcpip_tcp_timer(void *arg)
   /* timer still needed? */
   if (tcp_active_pcbs || tcp_tw_pcbs) {
     /* restart timer */
-    sys_timeout(TCP_TMR_INTERVAL, tcpip_tcp_timer, NULL);
+    LWIP_CYCLIC_TIMER_RESTART(TCP_TMR_INTERVAL, tcpip_tcp_timer);
   } else {
     /* disable timer */
     tcpip_tcp_timer_active = 0;
+#if LWIP_TIMER_WHEEL
+    sys_timeout_stop(&tcp_timeo);
+#endif /* LWIP_TIMER_WHEEL */
   }
 }
 
@@ -104,7 +164,7 @@ tcp_timer_needed(void)
   if (!tcpip_tcp_timer_active && (tcp_active_pcbs || tcp_tw_pcbs)) {
     /* enable and start timer */
     tcpip_tcp_timer_active = 1;
-    sys_timeout(TCP_TMR_INTERVAL, tcpip_tcp_timer, NULL);
+    LWIP_CYCLIC_TIMER_START(tcp_timeo, TCP_TMR_INTERVAL, tcpip_tcp_timer);
   }
 }
 #endif /* LWIP_TCP */
@@ -121,7 +181,7 @@ ip_reass_timer(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: ip_reass_tmr()\n"));
   ip_reass_tmr();
-  sys_timeout(IP_TMR_INTERVAL, ip_reass_timer, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(IP_TMR_INTERVAL, ip_reass_timer);
 }
 #endif /* IP_REASSEMBLY */
 
@@ -137,7 +197,7 @@ arp_timer(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: etharp_tmr()\n"));
   etharp_tmr();
-  sys_timeout(ARP_TMR_INTERVAL, arp_timer, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(ARP_TMR_INTERVAL, arp_timer);
 }
 #endif /* LWIP_ARP */
 
@@ -153,7 +213,7 @@ dhcp_timer_coarse(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: dhcp_coarse_tmr()\n"));
   dhcp_coarse_tmr();
-  sys_timeout(DHCP_COARSE_TIMER_MSECS, dhcp_timer_coarse, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(DHCP_COARSE_TIMER_MSECS, dhcp_timer_coarse);
 }
 
 /**
@@ -167,7 +227,7 @@ dhcp_timer_fine(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: dhcp_fine_tmr()\n"));
   dhcp_fine_tmr();
-  sys_timeout(DHCP_FINE_TIMER_MSECS, dhcp_timer_fine, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(DHCP_FINE_TIMER_MSECS, dhcp_timer_fine);
 }
 #endif /* LWIP_DHCP */
 
@@ -183,7 +243,7 @@ autoip_timer(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: autoip_tmr()\n"));
   autoip_tmr();
-  sys_timeout(AUTOIP_TMR_INTERVAL, autoip_timer, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(AUTOIP_TMR_INTERVAL, autoip_timer);
 }
 #endif /* LWIP_AUTOIP */
 
@@ -199,7 +259,7 @@ igmp_timer(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: igmp_tmr()\n"));
   igmp_tmr();
-  sys_timeout(IGMP_TMR_INTERVAL, igmp_timer, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(IGMP_TMR_INTERVAL, igmp_timer);
 }
 #endif /* LWIP_IGMP */
 
@@ -215,39 +275,266 @@ dns_timer(void *arg)
   LWIP_UNUSED_ARG(arg);
   LWIP_DEBUGF(TIMERS_DEBUG, ("tcpip: dns_tmr()\n"));
   dns_tmr();
-  sys_timeout(DNS_TMR_INTERVAL, dns_timer, NULL);
+  LWIP_CYCLIC_TIMER_RESTART(DNS_TMR_INTERVAL, dns_timer);
 }
 #endif /* LWIP_DNS */
 
 /** Initialize this module */
 void sys_timeouts_init(void)
 {
+#if LWIP_TIMER_WHEEL
+  u16_t slot;
+
+  /* forget the timeouts of a previous lwip_init(), memp_init() has already
+     reclaimed the ones allocated by sys_timeout() */
+  for (slot = 0; slot < SYS_TIMEO_LEVELS * SYS_TIMEO_SLOTS; slot++) {
+    while (timeo_wheel[slot] != NULL) {
+      timeo_wheel[slot]->pprev = NULL;
+      timeo_wheel[slot] = timeo_wheel[slot]->next;
+    }
+    timeo_used[slot / SYS_TIMEO_SLOTS] = 0;
+  }
+  timeo_now = sys_now();
+#if LWIP_TCP
+  tcpip_tcp_timer_active = 0;
+#endif /* LWIP_TCP */
+#endif /* LWIP_TIMER_WHEEL */
 #if IP_REASSEMBLY
-  sys_timeout(IP_TMR_INTERVAL, ip_reass_timer, NULL);
+  LWIP_CYCLIC_TIMER_START(ip_reass_timeo, IP_TMR_INTERVAL, ip_reass_timer);
 #endif /* IP_REASSEMBLY */
 #if LWIP_ARP
-  sys_timeout(ARP_TMR_INTERVAL, arp_timer, NULL);
+  LWIP_CYCLIC_TIMER_START(arp_timeo, ARP_TMR_INTERVAL, arp_timer);
 #endif /* LWIP_ARP */
 #if LWIP_DHCP
-  sys_timeout(DHCP_COARSE_TIMER_MSECS, dhcp_timer_coarse, NULL);
-  sys_timeout(DHCP_FINE_TIMER_MSECS, dhcp_timer_fine, NULL);
+  LWIP_CYCLIC_TIMER_START(dhcp_coarse_timeo, DHCP_COARSE_TIMER_MSECS, dhcp_timer_coarse);
+  LWIP_CYCLIC_TIMER_START(dhcp_fine_timeo, DHCP_FINE_TIMER_MSECS, dhcp_timer_fine);
 #endif /* LWIP_DHCP */
 #if LWIP_AUTOIP
-  sys_timeout(AUTOIP_TMR_INTERVAL, autoip_timer, NULL);
+  LWIP_CYCLIC_TIMER_START(autoip_timeo, AUTOIP_TMR_INTERVAL, autoip_timer);
 #endif /* LWIP_AUTOIP */
 #if LWIP_IGMP
-  sys_timeout(IGMP_TMR_INTERVAL, igmp_timer, NULL);
+  LWIP_CYCLIC_TIMER_START(igmp_timeo, IGMP_TMR_INTERVAL, igmp_timer);
 #endif /* LWIP_IGMP */
 #if LWIP_DNS
-  sys_timeout(DNS_TMR_INTERVAL, dns_timer, NULL);
+  LWIP_CYCLIC_TIMER_START(dns_timeo, DNS_TMR_INTERVAL, dns_timer);
 #endif /* LWIP_DNS */
 
-#if NO_SYS
+#if NO_SYS && !LWIP_TIMER_WHEEL
   /* Initialise timestamp for sys_check_timeouts */
   timeouts_last_time = sys_now();
 #endif
 }
 
+#if LWIP_TIMER_WHEEL
+/** Index of the least significant bit set in a non-zero bitmap */
+static u8_t
+sys_timeo_ctz(u32_t bits)
+{
+  static const u8_t debruijn[32] = {
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+  };
+  return debruijn[(u32_t)((bits & (0U - bits)) * 0x077CB531U) >> 27];
+}
+
+/** Put a timeout into the slot of its expiry (timeout->time) */
+static void
+sys_timeo_insert(struct sys_timeo *timeout)
+{
+  u32_t delay = timeout->time - timeo_now;
+  u32_t diff;
+  u8_t level, slot;
+
+  if ((s32_t)delay < 0) {
+    timeout->time = timeo_now;
+  } else if (delay > SYS_TIMEO_RANGE) {
+    timeout->time = timeo_now + SYS_TIMEO_RANGE;
+  }
+  diff = timeout->time ^ timeo_now;
+  for (level = 0; level < SYS_TIMEO_LEVELS - 1; level++) {
+    if ((diff >> (SYS_TIMEO_BITS * (level + 1))) == 0) {
+      break;
+    }
+  }
+  slot = (u8_t)(level * SYS_TIMEO_SLOTS + SYS_TIMEO_INDEX(timeout->time, level));
+  timeout->slot = slot;
+  timeout->next = timeo_wheel[slot];
+  if (timeout->next != NULL) {
+    timeout->next->pprev = &timeout->next;
+  }
+  timeout->pprev = &timeo_wheel[slot];
+  timeo_wheel[slot] = timeout;
+  timeo_used[level] |= (u32_t)1 << (slot & SYS_TIMEO_MASK);
+}
+
+/** Take a pending timeout out of its slot */
+static void
+sys_timeo_remove(struct sys_timeo *timeout)
+{
+  *timeout->pprev = timeout->next;
+  if (timeout->next != NULL) {
+    timeout->next->pprev = timeout->pprev;
+  }
+  if (timeo_wheel[timeout->slot] == NULL) {
+    timeo_used[timeout->slot / SYS_TIMEO_SLOTS] &= ~((u32_t)1 << (timeout->slot & SYS_TIMEO_MASK));
+  }
+  timeout->pprev = NULL;
+}
+
+/**
+ * Find the earliest expiry. A lower level only holds timeouts expiring before
+ * the ones of the higher levels, so only the first non-empty slot is scanned.
+ *
+ * @param next set to the expiry time
+ * @return 0 if no timeout is pending
+ */
+static u8_t
+sys_timeo_next(u32_t *next)
+{
+  struct sys_timeo *t;
+  u32_t bits;
+  u8_t level, first;
+
+  /* level 0 slots before the current one are empty */
+  if (timeo_used[0] != 0) {
+    *next = (timeo_now & ~(u32_t)SYS_TIMEO_MASK) | sys_timeo_ctz(timeo_used[0]);
+    return 1;
+  }
+  for (level = 1; level < SYS_TIMEO_LEVELS; level++) {
+    bits = timeo_used[level];
+    if (bits != 0) {
+      /* the timeouts are in the slots after the current one, the top level
+         wraps around: rotate the slot after the current one to bit 0 */
+      first = (u8_t)((SYS_TIMEO_INDEX(timeo_now, level) + 1) & SYS_TIMEO_MASK);
+      if (first != 0) {
+        bits = (u32_t)((bits >> first) | (bits << (SYS_TIMEO_SLOTS - first)));
+      }
+      t = timeo_wheel[level * SYS_TIMEO_SLOTS + ((sys_timeo_ctz(bits) + first) & SYS_TIMEO_MASK)];
+      *next = t->time;
+      for (t = t->next; t != NULL; t = t->next) {
+        if ((s32_t)(t->time - *next) < 0) {
+          *next = t->time;
+        }
+      }
+      return 1;
+    }
+  }
+  return 0;
+}
+
+/**
+ * Move the wheel to a later time. No timeout may expire before that time:
+ * only the timeouts in the slots entered on the higher levels need to
+ * cascade to the lower levels.
+ */
+static void
+sys_timeo_advance(u32_t time)
+{
+  struct sys_timeo *t, *next;
+  u32_t changed = timeo_now ^ time;
+  u8_t level, slot;
+
+  timeo_now = time;
+  for (level = SYS_TIMEO_LEVELS - 1; level > 0; level--) {
+    if ((changed >> (SYS_TIMEO_BITS * level)) != 0) {
+      slot = (u8_t)(level * SYS_TIMEO_SLOTS + SYS_TIMEO_INDEX(time, level));
+      t = timeo_wheel[slot];
+      timeo_wheel[slot] = NULL;
+      timeo_used[level] &= ~((u32_t)1 << (slot & SYS_TIMEO_MASK));
+      while (t != NULL) {
+        next = t->next;
+        sys_timeo_insert(t);
+        t = next;
+      }
+    }
+  }
+}
+
+/**
+ * Call the handlers of the timeouts expiring at timeo_now. Periodic timeouts
+ * are re-armed before their handler is called, the handler may stop them.
+ *
+ * @param now current time, a periodic timeout which fell behind is re-armed
+ *        one period after it
+ */
+static void
+sys_timeo_expire(u32_t now)
+{
+  struct sys_timeo *t;
+  sys_timeout_handler handler;
+  void *arg;
+  u8_t slot = (u8_t)SYS_TIMEO_INDEX(timeo_now, 0);
+
+  /* handlers may add timeouts expiring right now */
+  while ((t = timeo_wheel[slot]) != NULL) {
+    sys_timeo_remove(t);
+    handler = t->h;
+    arg = t->arg;
+#if LWIP_DEBUG_TIMERNAMES
+    if ((handler != NULL) && (t->handler_name != NULL)) {
+      LWIP_DEBUGF(TIMERS_DEBUG, ("sct calling h=%s arg=%p\n",
+        t->handler_name, arg));
+    }
+#endif /* LWIP_DEBUG_TIMERNAMES */
+    if (t->period != 0) {
+      t->time += t->period;
+      if ((s32_t)(t->time - now) <= 0) {
+        t->time = now + t->period;
+      }
+      sys_timeo_insert(t);
+    } else if (t->flags & SYS_TIMEO_FLAG_POOL) {
+      memp_free(MEMP_SYS_TIMEOUT, t);
+    }
+    if (handler != NULL) {
+      handler(arg);
+    }
+  }
+}
+
+/**
+ * Arm a caller-owned timeout, no memory is allocated. An entry which is
+ * already pending is re-armed. The entry has to be zero-initialised before
+ * its first use.
+ *
+ * @param timeout entry to arm, owned by the caller until it is stopped or expired
+ * @param msecs time in milliseconds after that the timer should expire
+ * @param period re-arm interval in milliseconds, 0 for a one-shot timeout
+ * @param handler callback function to call when msecs have elapsed
+ * @param arg argument to pass to the callback function
+ */
+void
+sys_timeout_start(struct sys_timeo *timeout, u32_t msecs, u32_t period,
+                  sys_timeout_handler handler, void *arg)
+{
+  if (timeout->pprev != NULL) {
+    sys_timeo_remove(timeout);
+  }
+  timeout->h = handler;
+  timeout->arg = arg;
+  timeout->period = period;
+  timeout->flags = 0;
+  timeout->time = sys_now() + msecs;
+#if LWIP_DEBUG_TIMERNAMES
+  timeout->handler_name = NULL;
+#endif /* LWIP_DEBUG_TIMERNAMES */
+  sys_timeo_insert(timeout);
+}
+
+/**
+ * Stop a timeout armed by sys_timeout_start(), nothing happens if it is not
+ * pending.
+ *
+ * @param timeout entry to stop
+ */
+void
+sys_timeout_stop(struct sys_timeo *timeout)
+{
+  if (timeout->pprev != NULL) {
+    sys_timeo_remove(timeout);
+  }
+}
+#endif /* LWIP_TIMER_WHEEL */
+
 /**
  * Create a one-shot timer (aka timeout). Timeouts are processed in the
  * following cases:
@@ -266,7 +553,10 @@ void
 sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
 #endif /* LWIP_DEBUG_TIMERNAMES */
 {
-  struct sys_timeo *timeout, *t;
+  struct sys_timeo *timeout;
+#if !LWIP_TIMER_WHEEL
+  struct sys_timeo *t;
+#endif /* !LWIP_TIMER_WHEEL */
 
   timeout = (struct sys_timeo *)memp_malloc(MEMP_SYS_TIMEOUT);
   if (timeout == NULL) {
@@ -283,6 +573,12 @@ sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
     (void *)timeout, msecs, handler_name, (void *)arg));
 #endif /* LWIP_DEBUG_TIMERNAMES */
 
+#if LWIP_TIMER_WHEEL
+  timeout->period = 0;
+  timeout->flags = SYS_TIMEO_FLAG_POOL;
+  timeout->time = sys_now() + msecs;
+  sys_timeo_insert(timeout);
+#else /* LWIP_TIMER_WHEEL */
   if (next_timeout == NULL) {
     next_timeout = timeout;
     return;
@@ -305,6 +601,7 @@ sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
       }
     }
   }
+#endif /* LWIP_TIMER_WHEEL */
 }
 
 /**
@@ -320,6 +617,22 @@ sys_timeout(u32_t msecs, sys_timeout_handler handler, void *arg)
 void
 sys_untimeout(sys_timeout_handler handler, void *arg)
 {
+#if LWIP_TIMER_WHEEL
+  struct sys_timeo *t;
+  u16_t slot;
+
+  for (slot = 0; slot < SYS_TIMEO_LEVELS * SYS_TIMEO_SLOTS; slot++) {
+    for (t = timeo_wheel[slot]; t != NULL; t = t->next) {
+      if ((t->h == handler) && (t->arg == arg)) {
+        sys_timeo_remove(t);
+        if (t->flags & SYS_TIMEO_FLAG_POOL) {
+          memp_free(MEMP_SYS_TIMEOUT, t);
+        }
+        return;
+      }
+    }
+  }
+#else /* LWIP_TIMER_WHEEL */
   struct sys_timeo *prev_t, *t;
 
   if (next_timeout == NULL) {
@@ -343,7 +656,7 @@ sys_untimeout(sys_timeout_handler handler, void *arg)
       return;
     }
   }
-  return;
+#endif /* LWIP_TIMER_WHEEL */
 }
 
 #if NO_SYS
@@ -357,6 +670,22 @@ sys_untimeout(sys_timeout_handler handler, void *arg)
 void
 sys_check_timeouts(void)
 {
+#if LWIP_TIMER_WHEEL
+  u32_t now = sys_now();
+  u32_t next;
+
+  for (;;) {
+#if PBUF_POOL_FREE_OOSEQ
+    PBUF_CHECK_FREE_OOSEQ();
+#endif /* PBUF_POOL_FREE_OOSEQ */
+    sys_timeo_expire(now);
+    if (!sys_timeo_next(&next) || ((s32_t)(next - now) > 0)) {
+      break;
+    }
+    sys_timeo_advance(next);
+  }
+  sys_timeo_advance(now);
+#else /* LWIP_TIMER_WHEEL */
   if (next_timeout) {
     struct sys_timeo *tmptimeout;
     u32_t diff;
@@ -397,6 +726,7 @@ sys_check_timeouts(void)
     /* repeat until all expired timers have been called */
     }while(had_one);
   }
+#endif /* LWIP_TIMER_WHEEL */
 }
 
 /** Set back the timestamp of the last call to sys_check_timeouts()
@@ -407,7 +737,65 @@ sys_check_timeouts(void)
 void
 sys_restart_timeouts(void)
 {
+#if LWIP_TIMER_WHEEL
+  struct sys_timeo *list = NULL, *t;
+  u32_t now = sys_now();
+  u32_t shift = now - timeo_now;
+  u16_t slot;
+
+  /* keep the remaining time of every timeout */
+  for (slot = 0; slot < SYS_TIMEO_LEVELS * SYS_TIMEO_SLOTS; slot++) {
+    while ((t = timeo_wheel[slot]) != NULL) {
+      sys_timeo_remove(t);
+      t->time += shift;
+      t->next = list;
+      list = t;
+    }
+  }
+  timeo_now = now;
+  while (list != NULL) {
+    t = list;
+    list = t->next;
+    sys_timeo_insert(t);
+  }
+#else /* LWIP_TIMER_WHEEL */
   timeouts_last_time = sys_now();
+#endif /* LWIP_TIMER_WHEEL */
+}
+
+/** Time to the next expiry for a caller which sleeps between the calls of
+ * sys_check_timeouts().
+ *
+ * @return milliseconds until the next timeout expires, 0 if one is due or
+ *         SYS_TIMEOUTS_SLEEPTIME_INFINITE if no timeout is pending
+ */
+u32_t
+sys_timeouts_sleeptime(void)
+{
+#if LWIP_TIMER_WHEEL
+  u32_t next;
+  u32_t now;
+
+  if (!sys_timeo_next(&next)) {
+    return SYS_TIMEOUTS_SLEEPTIME_INFINITE;
+  }
+  now = sys_now();
+  if ((s32_t)(next - now) <= 0) {
+    return 0;
+  }
+  return next - now;
+#else /* LWIP_TIMER_WHEEL */
+  u32_t diff;
+
+  if (next_timeout == NULL) {
+    return SYS_TIMEOUTS_SLEEPTIME_INFINITE;
+  }
+  diff = sys_now() - timeouts_last_time;
+  if (diff >= next_timeout->time) {
+    return 0;
+  }
+  return next_timeout->time - diff;
+#endif /* LWIP_TIMER_WHEEL */
 }
 
 #else /* NO_SYS */
@@ -61,6 +61,7 @@
 #include "lwip/snmp.h"
 #include "arch/perf.h"
 #include "lwip/dhcp.h"
+#include "netif/etharp.h"
 
 #include <string.h>
 
@@ -79,6 +80,83 @@ static u16_t udp_port = UDP_LOCAL_PORT_RANGE_START;
 /* exported in udp.h (was static) */
 struct udp_pcb *udp_pcbs;
 
+#if UDP_PCB_HASH
+#define UDP_PCB_HASH_MASK        (UDP_PCB_HASH_SIZE - 1)
+#define UDP_PCB_HASH_PORT(port)  (((port) ^ ((port) >> 8)) & UDP_PCB_HASH_MASK)
+
+/* The pcbs of udp_pcbs by local port */
+static struct udp_pcb *udp_port_hash[UDP_PCB_HASH_SIZE];
+/* The connected pcbs with a remote address by local port, remote port and remote address */
+static struct udp_pcb *udp_conn_hash[UDP_PCB_HASH_SIZE];
+
+/**
+ * Bucket of udp_conn_hash for a 4-tuple, the local address is left out as
+ * most pcbs are bound to IP_ADDR_ANY.
+ */
+static u32_t
+udp_conn_hash_index(u16_t local_port, u16_t remote_port, ip_addr_t *remote_ip)
+{
+  u32_t h = ip4_addr_get_u32(remote_ip) ^ ((u32_t)local_port << 16) ^ remote_port;
+  h ^= h >> 16;
+  h ^= h >> 8;
+  return h & UDP_PCB_HASH_MASK;
+}
+
+/**
+ * Remove a pcb from both hash tables.
+ */
+static void
+udp_hash_unlink(struct udp_pcb *pcb)
+{
+  if (pcb->port_pprev != NULL) {
+    *pcb->port_pprev = pcb->port_next;
+    if (pcb->port_next != NULL) {
+      pcb->port_next->port_pprev = pcb->port_pprev;
+    }
+    pcb->port_pprev = NULL;
+  }
+  if (pcb->conn_pprev != NULL) {
+    *pcb->conn_pprev = pcb->conn_next;
+    if (pcb->conn_next != NULL) {
+      pcb->conn_next->conn_pprev = pcb->conn_pprev;
+    }
+    pcb->conn_pprev = NULL;
+  }
+}
+
+/**
+ * (Re-)insert a pcb of udp_pcbs into the hash tables after its local port
+ * or its remote address changed.
+ */
+static void
+udp_hash_link(struct udp_pcb *pcb)
+{
+  struct udp_pcb **head;
+
+  udp_hash_unlink(pcb);
+  head = &udp_port_hash[UDP_PCB_HASH_PORT(pcb->local_port)];
+  pcb->port_next = *head;
+  pcb->port_pprev = head;
+  if (*head != NULL) {
+    (*head)->port_pprev = &pcb->port_next;
+  }
+  *head = pcb;
+
+  if ((pcb->flags & UDP_FLAGS_CONNECTED) && !ip_addr_isany(&pcb->remote_ip)) {
+    head = &udp_conn_hash[udp_conn_hash_index(pcb->local_port, pcb->remote_port, &pcb->remote_ip)];
+    pcb->conn_next = *head;
+    pcb->conn_pprev = head;
+    if (*head != NULL) {
+      (*head)->conn_pprev = &pcb->conn_next;
+    }
+    *head = pcb;
+  }
+}
+#else /* UDP_PCB_HASH */
+#define udp_hash_link(pcb)
+#define udp_hash_unlink(pcb)
+#endif /* UDP_PCB_HASH */
+
 /**
  * Initialize this module.
  */
@@ -106,7 +184,11 @@ again:
     udp_port = UDP_LOCAL_PORT_RANGE_START;
   }
   /* Check all PCBs. */
+#if UDP_PCB_HASH
+  for(pcb = udp_port_hash[UDP_PCB_HASH_PORT(udp_port)]; pcb != NULL; pcb = pcb->port_next) {
+#else /* UDP_PCB_HASH */
   for(pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
+#endif /* UDP_PCB_HASH */
     if (pcb->local_port == udp_port) {
       if (++n > (UDP_LOCAL_PORT_RANGE_END - UDP_LOCAL_PORT_RANGE_START)) {
         return 0;
@@ -135,6 +217,35 @@ again:
 #endif
 }
 
+/**
+ * Check whether the local address of a pcb accepts the current datagram.
+ *
+ * @param pcb pcb bound to the destination port of the datagram.
+ * @param inp network interface on which the datagram was received.
+ * @param broadcast the datagram was sent to a broadcast address.
+ * @return 1 if the pcb may receive the datagram, 0 otherwise.
+ */
+static u8_t
+udp_input_local_match(struct udp_pcb *pcb, struct netif *inp, u8_t broadcast)
+{
+  LWIP_UNUSED_ARG(inp);
+  return (
+     (!broadcast && ip_addr_isany(&pcb->local_ip)) ||
+     ip_addr_cmp(&(pcb->local_ip), &current_iphdr_dest) ||
+#if LWIP_IGMP
+     ip_addr_ismulticast(&current_iphdr_dest) ||
+#endif /* LWIP_IGMP */
+#if IP_SOF_BROADCAST_RECV
+      (broadcast && ip_get_option(pcb, SOF_BROADCAST) &&
+       (ip_addr_isany(&pcb->local_ip) ||
+        ip_addr_netcmp(&pcb->local_ip, ip_current_dest_addr(), &inp->netmask))));
+#else /* IP_SOF_BROADCAST_RECV */
+      (broadcast &&
+       (ip_addr_isany(&pcb->local_ip) ||
+        ip_addr_netcmp(&pcb->local_ip, ip_current_dest_addr(), &inp->netmask))));
+#endif /* IP_SOF_BROADCAST_RECV */
+}
+
 /**
  * Process an incoming UDP datagram.
  *
@@ -155,7 +266,9 @@ udp_input(struct pbuf *p, struct netif *inp)
   struct udp_pcb *uncon_pcb;
   struct ip_hdr *iphdr;
   u16_t src, dest;
+#if !UDP_PCB_HASH
   u8_t local_match;
+#endif /* !UDP_PCB_HASH */
   u8_t broadcast;
 
   PERF_START;
@@ -220,12 +333,43 @@ udp_input(struct pbuf *p, struct netif *inp)
 #endif /* LWIP_DHCP */
   {
     prev = NULL;
-    local_match = 0;
     uncon_pcb = NULL;
+#if UDP_PCB_HASH
+    LWIP_UNUSED_ARG(prev);
+    /* Connected pcbs are looked up by their 4-tuple first */
+    for (pcb = udp_conn_hash[udp_conn_hash_index(dest, src, &current_iphdr_src)];
+         pcb != NULL; pcb = pcb->conn_next) {
+      if ((pcb->local_port == dest) && (pcb->remote_port == src) &&
+          ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src) &&
+          udp_input_local_match(pcb, inp, broadcast)) {
+        UDP_STATS_INC(udp.cachehit);
+        break;
+      }
+    }
+    if (pcb == NULL) {
+      /* Then the pcbs bound to the destination port, with the same preference
+       * as the list below: a perfect match (connected to remote IP_ADDR_ANY)
+       * before the first unconnected pcb. */
+      for (pcb = udp_port_hash[UDP_PCB_HASH_PORT(dest)]; pcb != NULL; pcb = pcb->port_next) {
+        if ((pcb->local_port == dest) && udp_input_local_match(pcb, inp, broadcast)) {
+          if ((pcb->remote_port == src) &&
+              (ip_addr_isany(&pcb->remote_ip) ||
+               ip_addr_cmp(&(pcb->remote_ip), &current_iphdr_src))) {
+            break;
+          }
+          if ((uncon_pcb == NULL) &&
+              ((pcb->flags & UDP_FLAGS_CONNECTED) == 0)) {
+            uncon_pcb = pcb;
+          }
+        }
+      }
+    }
+#else /* UDP_PCB_HASH */
     /* Iterate through the UDP pcb list for a matching pcb.
      * 'Perfect match' pcbs (connected to the remote port & ip address) are
      * preferred. If no perfect match is found, the first unconnected pcb that
      * matches the local port and ip address gets the datagram. */
+    local_match = 0;
     for (pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
       local_match = 0;
       /* print the PCB local and remote address */
@@ -239,21 +383,7 @@ udp_input(struct pbuf *p, struct netif *inp)
 
       /* compare PCB local addr+port to UDP destination addr+port */
       if (pcb->local_port == dest) {
-        if (
-           (!broadcast && ip_addr_isany(&pcb->local_ip)) ||
-           ip_addr_cmp(&(pcb->local_ip), &current_iphdr_dest) ||
-#if LWIP_IGMP
-           ip_addr_ismulticast(&current_iphdr_dest) ||
-#endif /* LWIP_IGMP */
-#if IP_SOF_BROADCAST_RECV
-            (broadcast && ip_get_option(pcb, SOF_BROADCAST) &&
-             (ip_addr_isany(&pcb->local_ip) ||
-              ip_addr_netcmp(&pcb->local_ip, ip_current_dest_addr(), &inp->netmask)))) {
-#else /* IP_SOF_BROADCAST_RECV */
-            (broadcast &&
-             (ip_addr_isany(&pcb->local_ip) ||
-              ip_addr_netcmp(&pcb->local_ip, ip_current_dest_addr(), &inp->netmask)))) {
-#endif /* IP_SOF_BROADCAST_RECV */ 
+        if (udp_input_local_match(pcb, inp, broadcast)) {
           local_match = 1;
           if ((uncon_pcb == NULL) && 
               ((pcb->flags & UDP_FLAGS_CONNECTED) == 0)) {
@@ -281,6 +411,7 @@ udp_input(struct pbuf *p, struct netif *inp)
       }
       prev = pcb;
     }
+#endif /* UDP_PCB_HASH */
     /* no fully matching pcb found? then look for an unconnected pcb */
     if (pcb == NULL) {
       pcb = uncon_pcb;
@@ -325,7 +456,7 @@ udp_input(struct pbuf *p, struct netif *inp)
 #endif /* LWIP_UDPLITE */
     {
 #if CHECKSUM_CHECK_UDP
-      if (udphdr->chksum != 0) {
+      if ((udphdr->chksum != 0) && IP_CHECKSUM_CHECK_ENABLED(inp, NETIF_CHECKSUM_CHECK_UDP)) {
         if (inet_chksum_pseudo(p, ip_current_src_addr(), ip_current_dest_addr(),
                                IP_PROTO_UDP, p->tot_len) != 0) {
           LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_LEVEL_SERIOUS,
@@ -432,6 +563,199 @@ end:
   PERF_STOP("udp_input");
 }
 
+#if UDP_FLOW_CACHE
+/**
+ * Builds the cached headers of a connected pcb, after a datagram to its
+ * remote address went through ip_output_if(). Nothing is cached for
+ * non-Ethernet interfaces, broadcast and multicast destinations and as
+ * long as the next hop is not in the ARP cache.
+ *
+ * @param pcb the connected pcb
+ * @param netif the interface the datagram was sent on
+ * @param src_ip the source address used for the datagram
+ */
+static void
+udp_flow_build(struct udp_pcb *pcb, struct netif *netif, ip_addr_t *src_ip)
+{
+  struct udp_flow *flow = &pcb->flow;
+  struct ip_hdr *iphdr;
+  struct udp_hdr *udphdr;
+  struct eth_addr *eth_ret;
+  ip_addr_t *ip_ret;
+  ip_addr_t *nexthop;
+  s8_t i;
+
+  flow->netif = NULL;
+  if (((netif->flags & NETIF_FLAG_ETHARP) == 0) || (pcb->flags & UDP_FLAGS_UDPLITE) ||
+      ip_addr_isbroadcast(&pcb->remote_ip, netif) || ip_addr_ismulticast(&pcb->remote_ip)) {
+    return;
+  }
+  /* same next hop selection as etharp_output() */
+  if (ip_addr_netcmp(&pcb->remote_ip, &netif->ip_addr, &netif->netmask)) {
+    nexthop = &pcb->remote_ip;
+  } else {
+    nexthop = &netif->gw;
+  }
+  i = etharp_find_addr(netif, nexthop, &eth_ret, &ip_ret);
+  if (i < 0) {
+    return;
+  }
+
+  MEMCPY(&flow->hdr[0], eth_ret->addr, ETHARP_HWADDR_LEN);
+  MEMCPY(&flow->hdr[ETHARP_HWADDR_LEN], netif->hwaddr, ETHARP_HWADDR_LEN);
+  flow->hdr[2 * ETHARP_HWADDR_LEN] = (u8_t)(ETHTYPE_IP >> 8);
+  flow->hdr[2 * ETHARP_HWADDR_LEN + 1] = (u8_t)ETHTYPE_IP;
+
+  iphdr = (struct ip_hdr *)&flow->hdr[SIZEOF_ETH_HDR - ETH_PAD_SIZE];
+  IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+  IPH_TOS_SET(iphdr, pcb->tos);
+  IPH_LEN_SET(iphdr, 0);
+  IPH_ID_SET(iphdr, 0);
+  IPH_OFFSET_SET(iphdr, 0);
+  IPH_TTL_SET(iphdr, pcb->ttl);
+  IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+  IPH_CHKSUM_SET(iphdr, 0);
+  ip_addr_copy(iphdr->src, *src_ip);
+  ip_addr_copy(iphdr->dest, pcb->remote_ip);
+#if CHECKSUM_GEN_IP
+  flow->ip_chksum = inet_chksum(iphdr, IP_HLEN);
+#else
+  flow->ip_chksum = 0;
+#endif /* CHECKSUM_GEN_IP */
+
+  udphdr = (struct udp_hdr *)((u8_t *)iphdr + IP_HLEN);
+  udphdr->src = htons(pcb->local_port);
+  udphdr->dest = htons(pcb->remote_port);
+  udphdr->len = 0;
+  udphdr->chksum = 0;
+
+  flow->arp_idx = i;
+  flow->arp_version = etharp_cache_version;
+  flow->netif = netif;
+  LWIP_DEBUGF(UDP_DEBUG, ("udp_flow_build: headers cached for pcb %p\n", (void *)pcb));
+}
+
+/**
+ * Checks whether the cached headers of a pcb can be used to send p: the
+ * ARP entry and the interface are unchanged, TTL and TOS still match and
+ * the datagram needs no fragmentation.
+ */
+static u8_t
+udp_flow_usable(struct udp_pcb *pcb, struct pbuf *p)
+{
+  struct udp_flow *flow = &pcb->flow;
+  struct ip_hdr *iphdr = (struct ip_hdr *)&flow->hdr[SIZEOF_ETH_HDR - ETH_PAD_SIZE];
+
+  return (flow->netif != NULL) &&
+         (flow->arp_version == etharp_cache_version) &&
+         netif_is_up(flow->netif) &&
+         ((pcb->flags & (UDP_FLAGS_CONNECTED | UDP_FLAGS_UDPLITE)) == UDP_FLAGS_CONNECTED) &&
+         (IPH_TTL(iphdr) == pcb->ttl) && (IPH_TOS(iphdr) == pcb->tos) &&
+         (((u32_t)p->tot_len + UDP_HLEN + IP_HLEN) <= flow->netif->mtu);
+}
+
+/**
+ * Sends a datagram with the cached headers of a connected pcb, directly
+ * to netif->linkoutput(). Only the lengths, the IP ID and the checksums
+ * are written; the IP checksum is updated incrementally from the cached
+ * one (RFC 1624).
+ *
+ * @param pcb the connected pcb, udp_flow_usable() must be true
+ * @param p the UDP payload
+ * @return lwIP error code
+ */
+static err_t
+udp_flow_output(struct udp_pcb *pcb, struct pbuf *p)
+{
+  struct udp_flow *flow = &pcb->flow;
+  struct netif *netif = flow->netif;
+  struct pbuf *q;
+  struct ip_hdr *iphdr;
+  struct udp_hdr *udphdr;
+  u16_t len;
+  err_t err;
+
+  /* not enough space for all headers in the first pbuf? */
+  if (pbuf_header(p, SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN)) {
+    q = pbuf_alloc(PBUF_RAW, SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN, PBUF_RAM);
+    if (q == NULL) {
+      LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_LEVEL_SERIOUS, ("udp_flow_output: could not allocate header\n"));
+      return ERR_MEM;
+    }
+    if (p->tot_len != 0) {
+      pbuf_chain(q, p);
+    }
+  } else {
+    q = p;
+  }
+
+  MEMCPY((u8_t *)q->payload + ETH_PAD_SIZE, flow->hdr, UDP_FLOW_HLEN);
+  iphdr = (struct ip_hdr *)((u8_t *)q->payload + SIZEOF_ETH_HDR);
+  udphdr = (struct udp_hdr *)((u8_t *)iphdr + IP_HLEN);
+  len = q->tot_len - SIZEOF_ETH_HDR;
+
+  IPH_LEN_SET(iphdr, htons(len));
+  IPH_ID_SET(iphdr, htons(ip_next_id()));
+#if CHECKSUM_GEN_IP
+  if (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_IP)) {
+    IPH_CHKSUM_SET(iphdr, inet_chksum_adjust(inet_chksum_adjust(flow->ip_chksum, 0, IPH_LEN(iphdr)), 0, IPH_ID(iphdr)));
+  }
+#endif /* CHECKSUM_GEN_IP */
+  udphdr->len = htons(len - IP_HLEN);
+#if CHECKSUM_GEN_UDP
+  if (((pcb->flags & UDP_FLAGS_NOCHKSUM) == 0) &&
+      NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP)) {
+    ip_addr_t src_ip, dst_ip;
+    u16_t udpchksum;
+
+    ip_addr_copy(src_ip, iphdr->src);
+    ip_addr_copy(dst_ip, iphdr->dest);
+    pbuf_header(q, -(s16_t)(SIZEOF_ETH_HDR + IP_HLEN));
+    udpchksum = inet_chksum_pseudo(q, &src_ip, &dst_ip, IP_PROTO_UDP, len - IP_HLEN);
+    pbuf_header(q, SIZEOF_ETH_HDR + IP_HLEN);
+    /* chksum zero must become 0xffff, as zero means 'no checksum' */
+    if (udpchksum == 0x0000) {
+      udpchksum = 0xffff;
+    }
+    udphdr->chksum = udpchksum;
+  }
+#endif /* CHECKSUM_GEN_UDP */
+
+  /* keeps the ARP entry refreshed as etharp_output() would */
+  etharp_use_entry(netif, flow->arp_idx);
+  IP_STATS_INC(ip.xmit);
+  snmp_inc_ipoutrequests();
+  err = netif->linkoutput(netif, q);
+  snmp_inc_udpoutdatagrams();
+
+  /* did we chain a separate header pbuf earlier? */
+  if (q != p) {
+    pbuf_free(q);
+  }
+
+  UDP_STATS_INC(udp.xmit);
+  return err;
+}
+
+/**
+ * Drops the cached headers of the connected pcbs using an interface, after
+ * its addresses or its state changed.
+ *
+ * @param netif the interface, NULL for all pcbs (routes changed)
+ */
+void
+udp_flow_invalidate(struct netif *netif)
+{
+  struct udp_pcb *pcb;
+
+  for (pcb = udp_pcbs; pcb != NULL; pcb = pcb->next) {
+    if ((netif == NULL) || (pcb->flow.netif == netif)) {
+      pcb->flow.netif = NULL;
+    }
+  }
+}
+#endif /* UDP_FLOW_CACHE */
+
 /**
  * Send data using UDP.
  *
@@ -453,6 +777,11 @@ end:
 err_t
 udp_send(struct udp_pcb *pcb, struct pbuf *p)
 {
+#if UDP_FLOW_CACHE
+  if (udp_flow_usable(pcb, p)) {
+    return udp_flow_output(pcb, p);
+  }
+#endif /* UDP_FLOW_CACHE */
   /* send to the packet using remote ip and port stored in the pcb */
   return udp_sendto(pcb, p, &pcb->remote_ip, pcb->remote_port);
 }
@@ -555,7 +884,7 @@ udp_sendto_if(struct udp_pcb *pcb, struct pbuf *p,
 
 /** Same as udp_sendto_if(), but with checksum */
 err_t
-udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *dst_ip,
+udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *dst_ip,
                      u16_t dst_port, struct netif *netif, u8_t have_chksum,
                      u16_t chksum)
 {
@@ -584,6 +913,14 @@ udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *dst_ip,
     }
   }
 
+#if UDP_FLOW_CACHE
+  /* sending to the connected remote address with cached headers? */
+  if ((netif == pcb->flow.netif) && (dst_port == pcb->remote_port) &&
+      ip_addr_cmp(dst_ip, &pcb->remote_ip) && udp_flow_usable(pcb, p)) {
+    return udp_flow_output(pcb, p);
+  }
+#endif /* UDP_FLOW_CACHE */
+
   /* not enough space to add an UDP header to first pbuf in given p chain? */
   if (pbuf_header(p, UDP_HLEN)) {
     /* allocate header in a separate new pbuf */
@@ -699,7 +1036,10 @@ udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *dst_ip,
     udphdr->len = htons(q->tot_len);
     /* calculate checksum */
 #if CHECKSUM_GEN_UDP
-    if ((pcb->flags & UDP_FLAGS_NOCHKSUM) == 0) {
+    /* an offloading netif does not see the UDP header of fragmented datagrams */
+    if (((pcb->flags & UDP_FLAGS_NOCHKSUM) == 0) &&
+        (NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_UDP) ||
+         ((netif->mtu != 0) && (((u32_t)q->tot_len + IP_HLEN) > netif->mtu)))) {
       u16_t udpchksum;
 #if LWIP_CHECKSUM_ON_COPY
       if (have_chksum) {
@@ -727,6 +1067,13 @@ udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p, ip_addr_t *dst_ip,
     NETIF_SET_HWADDRHINT(netif, &pcb->addr_hint);
     err = ip_output_if(q, src_ip, dst_ip, pcb->ttl, pcb->tos, IP_PROTO_UDP, netif);
     NETIF_SET_HWADDRHINT(netif, NULL);
+#if UDP_FLOW_CACHE
+    /* cache the headers once the next hop of the connected address is resolved */
+    if ((err == ERR_OK) && (pcb->flags & UDP_FLAGS_CONNECTED) &&
+        (dst_port == pcb->remote_port) && ip_addr_cmp(dst_ip, &pcb->remote_ip)) {
+      udp_flow_build(pcb, netif, src_ip);
+    }
+#endif /* UDP_FLOW_CACHE */
   }
   /* TODO: must this be increased even if error occured? */
   snmp_inc_udpoutdatagrams();
@@ -818,6 +1165,9 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
     }
   }
   pcb->local_port = port;
+#if UDP_FLOW_CACHE
+  pcb->flow.netif = NULL;
+#endif /* UDP_FLOW_CACHE */
   snmp_insert_udpidx_tree(pcb);
   /* pcb not active yet? */
   if (rebind == 0) {
@@ -825,6 +1175,7 @@ udp_bind(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
     pcb->next = udp_pcbs;
     udp_pcbs = pcb;
   }
+  udp_hash_link(pcb);
   LWIP_DEBUGF(UDP_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE,
               ("udp_bind: bound to %"U16_F".%"U16_F".%"U16_F".%"U16_F", port %"U16_F"\n",
                ip4_addr1_16(&pcb->local_ip), ip4_addr2_16(&pcb->local_ip),
@@ -864,6 +1215,9 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
   ip_addr_set(&pcb->remote_ip, ipaddr);
   pcb->remote_port = port;
   pcb->flags |= UDP_FLAGS_CONNECTED;
+#if UDP_FLOW_CACHE
+  pcb->flow.netif = NULL;
+#endif /* UDP_FLOW_CACHE */
 /** TODO: this functionality belongs in upper layers */
 #ifdef LWIP_UDP_TODO
   /* Nail down local IP for netconn_addr()/getsockname() */
@@ -892,13 +1246,15 @@ udp_connect(struct udp_pcb *pcb, ip_addr_t *ipaddr, u16_t port)
   /* Insert UDP PCB into the list of active UDP PCBs. */
   for (ipcb = udp_pcbs; ipcb != NULL; ipcb = ipcb->next) {
     if (pcb == ipcb) {
-      /* already on the list, just return */
+      /* already on the list, just move it to the 4-tuple hash */
+      udp_hash_link(pcb);
       return ERR_OK;
     }
   }
   /* PCB not yet on the list, add PCB now */
   pcb->next = udp_pcbs;
   udp_pcbs = pcb;
+  udp_hash_link(pcb);
   return ERR_OK;
 }
 
@@ -915,6 +1271,15 @@ udp_disconnect(struct udp_pcb *pcb)
   pcb->remote_port = 0;
   /* mark PCB as unconnected */
   pcb->flags &= ~UDP_FLAGS_CONNECTED;
+#if UDP_FLOW_CACHE
+  pcb->flow.netif = NULL;
+#endif /* UDP_FLOW_CACHE */
+#if UDP_PCB_HASH
+  /* a pcb on udp_pcbs leaves the 4-tuple hash */
+  if (pcb->port_pprev != NULL) {
+    udp_hash_link(pcb);
+  }
+#endif /* UDP_PCB_HASH */
 }
 
 /**
@@ -962,6 +1327,7 @@ udp_remove(struct udp_pcb *pcb)
       }
     }
   }
+  udp_hash_unlink(pcb);
   memp_free(MEMP_UDP_PCB, pcb);
 }
 
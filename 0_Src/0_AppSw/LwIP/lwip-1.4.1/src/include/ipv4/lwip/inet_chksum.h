@@ -73,14 +73,29 @@ extern "C" {
 u16_t inet_chksum(void *dataptr, u16_t len);
 u16_t inet_chksum_pbuf(struct pbuf *p);
 u16_t inet_chksum_pseudo(struct pbuf *p,
-       ip_addr_t *src, ip_addr_t *dest,
+       const ip_addr_t *src, const ip_addr_t *dest,
        u8_t proto, u16_t proto_len);
 u16_t inet_chksum_pseudo_partial(struct pbuf *p,
-       ip_addr_t *src, ip_addr_t *dest,
+       const ip_addr_t *src, const ip_addr_t *dest,
        u8_t proto, u16_t proto_len, u16_t chksum_len);
-#if LWIP_CHKSUM_COPY_ALGORITHM
-u16_t lwip_chksum_copy(void *dst, const void *src, u16_t len);
+u16_t inet_chksum_adjust(u16_t chksum, u16_t old_word, u16_t new_word);
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 2)
+#define lwip_chksum_copy lwip_chksum_copy_alg2
+#elif LWIP_CHKSUM_COPY_ALGORITHM
+#define lwip_chksum_copy lwip_chksum_copy_alg1
 #endif /* LWIP_CHKSUM_COPY_ALGORITHM */
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 1) || LWIP_CHKSUM_ALGORITHM_ALL
+u16_t lwip_chksum_copy_alg1(void *dst, const void *src, u16_t len);
+#endif
+#if (LWIP_CHKSUM_COPY_ALGORITHM == 2) || LWIP_CHKSUM_ALGORITHM_ALL
+u16_t lwip_chksum_copy_alg2(void *dst, const void *src, u16_t len);
+#endif
+#if LWIP_CHKSUM_ALGORITHM_ALL
+u16_t lwip_chksum_alg1(void *dataptr, u16_t len);
+u16_t lwip_chksum_alg2(void *dataptr, int len);
+u16_t lwip_chksum_alg3(void *dataptr, int len);
+u16_t lwip_chksum_alg4(void *dataptr, int len);
+#endif /* LWIP_CHKSUM_ALGORITHM_ALL */
 
 #ifdef __cplusplus
 }
@@ -64,7 +64,7 @@ extern "C" {
 #define IP_HDRINCL  NULL
 
 #if LWIP_NETIF_HWADDRHINT
-#define IP_PCB_ADDRHINT ;u8_t addr_hint
+#define IP_PCB_ADDRHINT ;netif_addr_idx_t addr_hint
 #else
 #define IP_PCB_ADDRHINT
 #endif /* LWIP_NETIF_HWADDRHINT */
@@ -171,6 +171,19 @@ extern ip_addr_t current_iphdr_src;
 /** Destination IP address of current_header */
 extern ip_addr_t current_iphdr_dest;
 
+/** Reassembled datagrams are checked in software even if the input netif offloads the
+ * transport checksums: the hardware does not see the transport header of fragments. */
+#define IP_CHECKSUM_CHECK_REASSEMBLED (LWIP_CHECKSUM_CTRL_PER_NETIF && IP_REASSEMBLY)
+#if IP_CHECKSUM_CHECK_REASSEMBLED
+/** current_header belongs to a datagram reassembled from fragments */
+extern u8_t current_iphdr_reassembled;
+/** Ask if the transport checksum of the current input packet must be checked in software */
+#define IP_CHECKSUM_CHECK_ENABLED(netif, chksumflag) \
+  (current_iphdr_reassembled || NETIF_CHECKSUM_ENABLED(netif, chksumflag))
+#else /* IP_CHECKSUM_CHECK_REASSEMBLED */
+#define IP_CHECKSUM_CHECK_ENABLED(netif, chksumflag) NETIF_CHECKSUM_ENABLED(netif, chksumflag)
+#endif /* IP_CHECKSUM_CHECK_REASSEMBLED */
+
 #define ip_init() /* Compatibility define, not init needed. */
 struct netif *ip_route(ip_addr_t *dest);
 err_t ip_input(struct pbuf *p, struct netif *inp);
@@ -181,8 +194,11 @@ err_t ip_output_if(struct pbuf *p, ip_addr_t *src, const ip_addr_t *dest,
        struct netif *netif);
 #if LWIP_NETIF_HWADDRHINT
 err_t ip_output_hinted(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
-       u8_t ttl, u8_t tos, u8_t proto, u8_t *addr_hint);
+       u8_t ttl, u8_t tos, u8_t proto, netif_addr_idx_t *addr_hint);
 #endif /* LWIP_NETIF_HWADDRHINT */
+#if UDP_FLOW_CACHE
+u16_t ip_next_id(void);
+#endif /* UDP_FLOW_CACHE */
 #if IP_OPTIONS_SEND
 err_t ip_output_if_opt(struct pbuf *p, ip_addr_t *src, ip_addr_t *dest,
        u8_t ttl, u8_t tos, u8_t proto, struct netif *netif, void *ip_options,
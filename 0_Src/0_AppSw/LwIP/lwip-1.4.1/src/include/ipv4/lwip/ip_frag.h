@@ -48,6 +48,18 @@ extern "C" {
 /* The IP reassembly timer interval in milliseconds. */
 #define IP_TMR_INTERVAL 1000
 
+#if IP_REASS_HOLES
+/** A range of a datagram not received yet (RFC 815) */
+struct ip_reass_hole {
+  /** Fragment ending at 'first', NULL for the hole at offset 0: the fragments
+   *  filling the hole are chained in behind it */
+  struct pbuf *prev;
+  u16_t first;
+  /** Offset behind the hole, 0xffff until the last fragment was received */
+  u16_t last;
+};
+#endif /* IP_REASS_HOLES */
+
 /* IP reassembly helper struct.
  * This is exported because memp needs to know the size.
  */
@@ -58,7 +70,30 @@ struct ip_reassdata {
   u16_t datagram_len;
   u8_t flags;
   u8_t timer;
+#if IP_REASS_HOLES
+  /** pbufs queued for this datagram */
+  u16_t pbufs;
+  /** Number of the last fragment queued for this datagram, see ip_reass_evict() */
+  u16_t input;
+  u8_t hole_count;
+  /** Hole the last fragment fell into, the next one most likely does too */
+  u8_t hole_hint;
+  struct ip_reass_hole holes[IP_REASS_MAX_HOLES];
+#endif /* IP_REASS_HOLES */
+};
+
+/** Datagrams and fragments freed by the reassembly before completion */
+struct ip_reass_stats {
+  /** Datagrams freed before their timeout to make room for others */
+  u32_t evicted;
+  /** Datagrams freed by ip_reass_tmr() */
+  u32_t timeouts;
+  /** Fragments freed without queueing them: received already or overlapping */
+  u32_t duplicates;
+  /** Highest number of pbufs queued at a time */
+  u16_t pbufs_max;
 };
+extern struct ip_reass_stats ip_reass_stats;
 
 void ip_reass_init(void);
 void ip_reass_tmr(void);
@@ -91,6 +91,55 @@ void *mem_trim(void *mem, mem_size_t size);
 void *mem_malloc(mem_size_t size);
 void *mem_calloc(mem_size_t count, mem_size_t size);
 void  mem_free(void *mem);
+
+#if MEM_TELEMETRY
+/** Telemetry of one mem_malloc() size class (one LWIP_MALLOC_MEMPOOL), updated by
+ * mem_malloc() and mem_free() under a lock of its own, on any core */
+struct mem_class {
+  /** element size of the pool, the struct memp_malloc_helper in front of the
+   *  caller's bytes included */
+  u16_t size;
+  /** elements in the pool */
+  u16_t num;
+  /** elements in use */
+  u16_t used;
+  /** high-water mark of used */
+  u16_t max;
+  /** elements taken from this pool */
+  u32_t allocs;
+  /** requests for this class that failed */
+  u32_t err;
+  /** requests for this class served by a bigger class (MEM_USE_POOLS_TRY_BIGGER_POOL) */
+  u32_t spills;
+  /** bytes requested by the elements in use, used * size - requested is lost to the
+   *  helper and to rounding up */
+  u32_t requested;
+};
+
+/** Usage and fragmentation of the heap */
+struct mem_heap_report {
+  /** bytes of the heap, including the struct mem of every block */
+  mem_size_t size;
+  /** bytes allocated, including the struct mem */
+  mem_size_t used;
+  /** high-water mark of used */
+  mem_size_t max;
+  /** free bytes, including the struct mem of every free block */
+  mem_size_t free;
+  /** biggest request that would succeed now */
+  mem_size_t largest;
+  /** number of free blocks */
+  u16_t blocks;
+  /** failed requests */
+  u32_t err;
+};
+
+#if MEM_USE_POOLS
+const struct mem_class *mem_class_get(u8_t idx);
+#else /* MEM_USE_POOLS */
+void  mem_heap_get(struct mem_heap_report *report);
+#endif /* MEM_USE_POOLS */
+#endif /* MEM_TELEMETRY */
 #endif /* MEM_LIBC_MALLOC */
 
 /** Calculate memory size for an aligned buffer - returns the next highest
@@ -93,7 +93,12 @@ extern const u16_t memp_sizes[MEMP_MAX];
 /** This structure is used to save the pool one element came from. */
 struct memp_malloc_helper
 {
-   memp_t poolnr;
+   /** memp_t of the pool, stored in 16 bits to keep the helper at 4 bytes */
+   u16_t poolnr;
+#if MEM_TELEMETRY
+   /** size passed to mem_malloc() */
+   u16_t size;
+#endif /* MEM_TELEMETRY */
 };
 #endif /* MEM_USE_POOLS */
 
@@ -106,6 +111,24 @@ void *memp_malloc_fn(memp_t type, const char* file, const int line);
 void *memp_malloc(memp_t type);
 #endif
 void  memp_free(memp_t type, void *mem);
+u16_t memp_num_free(memp_t type);
+
+#if MEMP_NUM_CORE_CACHES
+/** Private cache of free elements of one pool on one core */
+struct memp_cache {
+  /** free elements, linked through struct memp */
+  struct memp *tab;
+  /** number of elements in tab */
+  u16_t count;
+  /** batches taken from the shared pool */
+  u32_t refills;
+  /** batches returned to the shared pool */
+  u32_t drains;
+};
+
+const struct memp_cache *memp_cache_get(u8_t core, memp_t type);
+void  memp_cache_flush(void);
+#endif /* MEMP_NUM_CORE_CACHES */
 
 #endif /* MEMP_MEM_MALLOC */
 
@@ -42,6 +42,14 @@ LWIP_MEMPOOL(UDP_PCB,        MEMP_NUM_UDP_PCB,         sizeof(struct udp_pcb),
 LWIP_MEMPOOL(TCP_PCB,        MEMP_NUM_TCP_PCB,         sizeof(struct tcp_pcb),        "TCP_PCB")
 LWIP_MEMPOOL(TCP_PCB_LISTEN, MEMP_NUM_TCP_PCB_LISTEN,  sizeof(struct tcp_pcb_listen), "TCP_PCB_LISTEN")
 LWIP_MEMPOOL(TCP_SEG,        MEMP_NUM_TCP_SEG,         sizeof(struct tcp_seg),        "TCP_SEG")
+#if LWIP_TCP_WRITEV
+LWIP_MEMPOOL(TCP_WRITEV,     MEMP_NUM_TCP_WRITEV,      sizeof(struct tcp_writev_req), "TCP_WRITEV")
+LWIP_MEMPOOL(TCP_WRITEV_PBUF,MEMP_NUM_TCP_WRITEV_PBUF, sizeof(struct tcp_writev_pbuf),"TCP_WRITEV_PBUF")
+#endif /* LWIP_TCP_WRITEV */
+#if LWIP_TCP_GSO
+LWIP_MEMPOOL(TCP_GSO,        MEMP_NUM_TCP_GSO,         sizeof(struct tcp_gso_hdr),    "TCP_GSO")
+LWIP_MEMPOOL(TCP_GSO_PBUF,   MEMP_NUM_TCP_GSO_PBUF,    sizeof(struct tcp_gso_pbuf),   "TCP_GSO_PBUF")
+#endif /* LWIP_TCP_GSO */
 #endif /* LWIP_TCP */
 
 #if IP_REASSEMBLY
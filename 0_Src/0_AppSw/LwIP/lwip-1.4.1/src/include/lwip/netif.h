@@ -94,6 +94,20 @@ extern "C" {
  * Set by the netif driver in its init function. */
 #define NETIF_FLAG_IGMP         0x80U
 
+/** Checksum generation/check flags of a netif (see NETIF_SET_CHECKSUM_CTRL()).
+ * A cleared flag means that the netif (i.e. its hardware) takes care of that
+ * checksum, so the stack skips it. Only used if LWIP_CHECKSUM_CTRL_PER_NETIF==1. */
+#define NETIF_CHECKSUM_GEN_IP       0x0001
+#define NETIF_CHECKSUM_GEN_UDP      0x0002
+#define NETIF_CHECKSUM_GEN_TCP      0x0004
+#define NETIF_CHECKSUM_GEN_ICMP     0x0008
+#define NETIF_CHECKSUM_CHECK_IP     0x0100
+#define NETIF_CHECKSUM_CHECK_UDP    0x0200
+#define NETIF_CHECKSUM_CHECK_TCP    0x0400
+#define NETIF_CHECKSUM_CHECK_ICMP   0x0800
+#define NETIF_CHECKSUM_ENABLE_ALL   0xFFFF
+#define NETIF_CHECKSUM_DISABLE_ALL  0x0000
+
 /** Function prototype for netif init functions. Set up flags and output/linkoutput
  * callback functions in this function.
  *
@@ -130,6 +144,13 @@ typedef void (*netif_status_callback_fn)(struct netif *netif);
 typedef err_t (*netif_igmp_mac_filter_fn)(struct netif *netif,
        ip_addr_t *group, u8_t action);
 
+/** Index of the ARP table entry a pcb sent to last (LWIP_NETIF_HWADDRHINT) */
+#if ARP_TABLE_SIZE > 0xff
+typedef u16_t netif_addr_idx_t;
+#else /* ARP_TABLE_SIZE > 0xff */
+typedef u8_t netif_addr_idx_t;
+#endif /* ARP_TABLE_SIZE > 0xff */
+
 /** Generic data structure used for all lwIP network interfaces.
  *  The following fields should be filled in by the initialization
  *  function for the device driver: hwaddr_len, hwaddr[], mtu, flags */
@@ -190,6 +211,19 @@ struct netif {
   u8_t hwaddr[NETIF_MAX_HWADDR_LEN];
   /** flags (see NETIF_FLAG_ above) */
   u8_t flags;
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+  /** checksums done in software for this netif (see NETIF_CHECKSUM_ above) */
+  u16_t chksum_flags;
+#endif /* LWIP_CHECKSUM_CTRL_PER_NETIF */
+#if LWIP_TCP_GSO
+  /** largest TCP super-segment the driver splits itself, IP header included */
+  u16_t gso_max_size;
+  /** segments per super-segment, 0 or 1 if the driver does not split them */
+  u8_t gso_max_segs;
+#endif /* LWIP_TCP_GSO */
+  /** TX descriptors of a driver which sends pbufs in place, one per pbuf of a frame;
+   *  0 if the driver has no such limit */
+  u16_t tx_descs;
   /** descriptive abbreviation */
   char name[2];
   /** number of this interface */
@@ -217,7 +251,7 @@ struct netif {
   netif_igmp_mac_filter_fn igmp_mac_filter;
 #endif /* LWIP_IGMP */
 #if LWIP_NETIF_HWADDRHINT
-  u8_t *addr_hint;
+  netif_addr_idx_t *addr_hint;
 #endif /* LWIP_NETIF_HWADDRHINT */
 #if ENABLE_LOOPBACK
   /* List of packets to be queued for ourselves. */
@@ -321,6 +355,16 @@ void netif_poll_all(void);
 #define NETIF_SET_HWADDRHINT(netif, hint)
 #endif /* LWIP_NETIF_HWADDRHINT */
 
+#if LWIP_CHECKSUM_CTRL_PER_NETIF
+#define NETIF_SET_CHECKSUM_CTRL(netif, chksumflags) ((netif)->chksum_flags = (u16_t)(chksumflags))
+/** Ask if the stack has to compute a checksum for this netif (always for netif == NULL) */
+#define NETIF_CHECKSUM_ENABLED(netif, chksumflag) \
+  (((netif) == NULL) || (((netif)->chksum_flags & (chksumflag)) != 0))
+#else /* LWIP_CHECKSUM_CTRL_PER_NETIF */
+#define NETIF_SET_CHECKSUM_CTRL(netif, chksumflags)
+#define NETIF_CHECKSUM_ENABLED(netif, chksumflag) 1
+#endif /* LWIP_CHECKSUM_CTRL_PER_NETIF */
+
 #ifdef __cplusplus
 }
 #endif
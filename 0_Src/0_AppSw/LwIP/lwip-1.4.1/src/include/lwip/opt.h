@@ -76,6 +76,18 @@
 #define NO_SYS_NO_TIMERS                0
 #endif
 
+/**
+ * LWIP_TIMER_WHEEL==1: keep the timeouts in a hierarchical timing wheel
+ * instead of the sorted list (requires NO_SYS==1). Starting and stopping a
+ * timeout is O(1), sys_timeouts_sleeptime() returns the time to the next
+ * expiry. The cyclic stack timers are periodic entries which do not use
+ * MEMP_SYS_TIMEOUT, sys_timeout_start() arms caller-owned entries.
+ * Timeouts are limited to 2^25 - 2^20 - 1 ms (about 9 hours).
+ */
+#ifndef LWIP_TIMER_WHEEL
+#define LWIP_TIMER_WHEEL                0
+#endif
+
 /**
  * MEMCPY: override this if you have a faster implementation at hand than the
  * one included in your C library
@@ -162,6 +174,37 @@
 #define MEMP_SANITY_CHECK               0
 #endif
 
+/**
+ * MEMP_NUM_CORE_CACHES > 0: number of cores with a private cache of free
+ * elements in front of the pools selected by MEMP_CORE_CACHE_POOL(). A core
+ * allocates from and frees into its own cache; the cache is refilled from and
+ * drained into the shared pool MEMP_CORE_CACHE_SIZE elements at a time. Only
+ * these batches and the pools without cache take the spin lock shared by all
+ * cores. The port provides in arch/cc.h: sys_spinlock_t, sys_spin_prot_t,
+ * SYS_ARCH_CORE_ID() (0 .. MEMP_NUM_CORE_CACHES-1), SYS_ARCH_SPIN_PROTECT(lock, lev)
+ * and SYS_ARCH_SPIN_UNPROTECT(lock, lev).
+ * Elements cached by one core are not available to the other cores, a cache
+ * holds up to 2 * MEMP_CORE_CACHE_SIZE of them.
+ */
+#ifndef MEMP_NUM_CORE_CACHES
+#define MEMP_NUM_CORE_CACHES            0
+#endif
+
+/**
+ * MEMP_CORE_CACHE_SIZE: number of elements moved by one refill or drain of a
+ * per-core cache.
+ */
+#ifndef MEMP_CORE_CACHE_SIZE
+#define MEMP_CORE_CACHE_SIZE            2
+#endif
+
+/**
+ * MEMP_CORE_CACHE_POOL(type): non-zero for the pools with per-core caches.
+ */
+#ifndef MEMP_CORE_CACHE_POOL
+#define MEMP_CORE_CACHE_POOL(type)      (((type) == MEMP_PBUF) || ((type) == MEMP_PBUF_POOL))
+#endif
+
 /**
  * MEM_USE_POOLS==1: Use an alternative to malloc() by allocating from a set
  * of memory pools of various sizes. When mem_malloc is called, an element of
@@ -180,6 +223,17 @@
 #define MEM_USE_POOLS_TRY_BIGGER_POOL   0
 #endif
 
+/**
+ * MEM_TELEMETRY==1: count the mem_malloc() requests. With MEM_USE_POOLS, every
+ * size class (LWIP_MALLOC_MEMPOOL) keeps its high-water mark, failures, spills
+ * into a bigger class and the bytes requested by the elements in use, see
+ * mem_class_get(). The heap keeps its high-water mark and failures, and
+ * mem_heap_get() walks it for the free blocks, see struct mem_heap_report.
+ */
+#ifndef MEM_TELEMETRY
+#define MEM_TELEMETRY                   0
+#endif
+
 /**
  * MEMP_USE_CUSTOM_POOLS==1: whether to include a user file lwippools.h
  * that defines additional pools beyond the "standard" ones required
@@ -433,6 +487,34 @@
 #define ARP_TABLE_SIZE                  10
 #endif
 
+/**
+ * ETHARP_TABLE_HASH==1: Find ARP entries by IP address in a hash table instead
+ * of scanning the ARP table, and keep the empty entries in a free list. The
+ * table is only scanned to recycle an entry when it is full.
+ */
+#ifndef ETHARP_TABLE_HASH
+#define ETHARP_TABLE_HASH               0
+#endif
+
+/**
+ * ETHARP_TABLE_HASH_SIZE: Number of buckets of the ETHARP_TABLE_HASH table,
+ * a power of 2.
+ */
+#ifndef ETHARP_TABLE_HASH_SIZE
+#define ETHARP_TABLE_HASH_SIZE          64
+#endif
+
+/**
+ * ETHARP_REFRESH_USED==1: etharp_tmr() re-requests the stable entries which
+ * were used since their last update in the last 2 minutes before they expire,
+ * unicast first. Without, only the next packet sent in the last minute
+ * re-requests the entry, and an entry which expired in between delays (or
+ * drops) that packet until it is resolved again.
+ */
+#ifndef ETHARP_REFRESH_USED
+#define ETHARP_REFRESH_USED             0
+#endif
+
 /**
  * ARP_QUEUEING==1: Multiple outgoing packets are queued during hardware address
  * resolution. By default, only the most recent packet is queued per IP address.
@@ -554,6 +636,46 @@
 #define IP_REASS_MAX_PBUFS              10
 #endif
 
+/**
+ * IP_REASS_HOLES==1: Keep the ranges still missing of every datagram in a
+ * list of hole descriptors (RFC 815). A fragment is chained into its datagram
+ * without walking the fragments received before, duplicates are dropped
+ * before they count against IP_REASS_MAX_PBUFS. When pbufs or datagrams run
+ * short, the datagram which waited longest for a fragment is freed first; a
+ * datagram which needs more than IP_REASS_MAX_PBUFS_SRC pbufs is freed at once.
+ */
+#ifndef IP_REASS_HOLES
+#define IP_REASS_HOLES                  0
+#endif
+
+/**
+ * IP_REASS_MAX_HOLES: Holes per datagram with IP_REASS_HOLES. A fragment
+ * which would open one more is dropped.
+ */
+#ifndef IP_REASS_MAX_HOLES
+#define IP_REASS_MAX_HOLES              8
+#endif
+
+/**
+ * IP_REASS_MAX_PBUFS_SRC: Maximum amount of pbufs waiting to be reassembled
+ * for one source address, so a single host cannot take all of
+ * IP_REASS_MAX_PBUFS (requires IP_REASS_HOLES).
+ */
+#ifndef IP_REASS_MAX_PBUFS_SRC
+#define IP_REASS_MAX_PBUFS_SRC          IP_REASS_MAX_PBUFS
+#endif
+
+/**
+ * IP_REASS_EVICT_IDLE: With IP_REASS_HOLES, the first fragment of a new
+ * datagram frees the datagrams from the same source which did not get any of
+ * the last IP_REASS_EVICT_IDLE fragments queued: one of their fragments was
+ * most likely lost, they would only hold their pbufs until IP_REASS_MAXAGE.
+ * 0 keeps them until their timeout or until memory runs short.
+ */
+#ifndef IP_REASS_EVICT_IDLE
+#define IP_REASS_EVICT_IDLE             0
+#endif
+
 /**
  * IP_FRAG_USES_STATIC_BUF==1: Use a static MTU-sized buffer for IP
  * fragmentation. Otherwise pbufs are allocated and reference the original
@@ -889,6 +1011,34 @@
 #define UDP_TTL                         (IP_DEFAULT_TTL)
 #endif
 
+/**
+ * UDP_FLOW_CACHE==1: Connected UDP pcbs on Ethernet interfaces cache the
+ * destination MAC address and the prebuilt Ethernet, IP and UDP headers.
+ * Datagrams are then sent without route, ARP lookup and header construction,
+ * only the lengths, the IP ID and the checksums are updated.
+ * (Requires LWIP_UDP and LWIP_ARP)
+ */
+#ifndef UDP_FLOW_CACHE
+#define UDP_FLOW_CACHE                  0
+#endif
+
+/**
+ * UDP_PCB_HASH==1: udp_input() finds the receiving pcb in hash tables instead
+ * of scanning udp_pcbs: connected pcbs by local port, remote port and remote
+ * address, then all bound pcbs by local port. udp_pcbs stays complete for the
+ * SNMP agent. (Requires LWIP_UDP)
+ */
+#ifndef UDP_PCB_HASH
+#define UDP_PCB_HASH                    0
+#endif
+
+/**
+ * UDP_PCB_HASH_SIZE: Number of buckets of each UDP_PCB_HASH table, a power of 2.
+ */
+#ifndef UDP_PCB_HASH_SIZE
+#define UDP_PCB_HASH_SIZE               32
+#endif
+
 /**
  * LWIP_NETBUF_RECVINFO==1: append destination addr and port to every netbuf.
  */
@@ -1005,7 +1155,10 @@
 
 /**
  * TCP_OOSEQ_MAX_BYTES: The maximum number of bytes queued on ooseq per pcb.
- * Default is 0 (no limit). Only valid for TCP_QUEUE_OOSEQ==0.
+ * Default is 0 (no limit). Only valid for TCP_QUEUE_OOSEQ==1.
+ * The count is kept with the queue: a segment behind the last queued one
+ * is not queued when it would exceed the limit, a segment which fills a
+ * hole is and the end of the queue is dropped instead.
  */
 #ifndef TCP_OOSEQ_MAX_BYTES
 #define TCP_OOSEQ_MAX_BYTES             0
@@ -1068,6 +1221,180 @@
 #define TCP_WND_UPDATE_THRESHOLD   (TCP_WND / 4)
 #endif
 
+/**
+ * TCP_RCV_AUTOTUNE==1: announce a receive window after the free PBUF_POOL
+ * buffers instead of TCP_WND to every connection, one segment of the MSS
+ * per buffer. A pcb announces at most the buffers free beyond
+ * TCP_RCV_POOL_RESERVE and at most its share of the pool (the buffers
+ * above the reserve divided by the connections able to receive) less the
+ * buffers it holds: data not yet passed to tcp_recved() and out-of-sequence
+ * segments. No out-of-sequence segment is queued while the pool is down to
+ * the reserve. tcp_fasttmr() sends a window update when buffers were freed.
+ * TCP_WND stays the upper limit and may then exceed PBUF_POOL_SIZE segments.
+ * Requires MEMP_MEM_MALLOC==0.
+ */
+#ifndef TCP_RCV_AUTOTUNE
+#define TCP_RCV_AUTOTUNE                0
+#endif
+
+/**
+ * TCP_RCV_POOL_RESERVE: PBUF_POOL buffers TCP_RCV_AUTOTUNE leaves to the
+ * receive path of the driver and of the other protocols (ARP, ICMP, UDP).
+ */
+#ifndef TCP_RCV_POOL_RESERVE
+#define TCP_RCV_POOL_RESERVE            (PBUF_POOL_SIZE / 4)
+#endif
+
+/**
+ * TCP_PCB_HASH==1: tcp_input() finds the pcb of a segment in hash tables
+ * instead of scanning tcp_active_pcbs, tcp_tw_pcbs and tcp_listen_pcbs:
+ * active and TIME-WAIT pcbs by local port, remote port and remote address,
+ * listening pcbs by local port. The lists stay complete for the timers and
+ * the SNMP agent.
+ */
+#ifndef TCP_PCB_HASH
+#define TCP_PCB_HASH                    0
+#endif
+
+/**
+ * TCP_PCB_HASH_SIZE: Number of buckets of each TCP_PCB_HASH table, a power of 2.
+ */
+#ifndef TCP_PCB_HASH_SIZE
+#define TCP_PCB_HASH_SIZE               32
+#endif
+
+/**
+ * LWIP_TCP_WRITEV==1: enable tcp_writev(), which queues the data of several
+ * application buffers without copying: every buffer is referenced by custom
+ * PBUF_REF pbufs, and a callback reports when the stack and the netif driver
+ * released the last of them (the data was ACKed or the connection dropped).
+ */
+#ifndef LWIP_TCP_WRITEV
+#define LWIP_TCP_WRITEV                 0
+#endif
+
+/**
+ * MEMP_NUM_TCP_WRITEV: the number of tcp_writev() calls whose buffers are
+ * still referenced by queued segments, over all connections.
+ * (requires the LWIP_TCP_WRITEV option)
+ */
+#ifndef MEMP_NUM_TCP_WRITEV
+#define MEMP_NUM_TCP_WRITEV             4
+#endif
+
+/**
+ * MEMP_NUM_TCP_WRITEV_PBUF: the number of PBUF_REF pbufs of tcp_writev(). A
+ * segment takes one per buffer it covers, next to its header pbuf.
+ * (requires the LWIP_TCP_WRITEV option)
+ */
+#ifndef MEMP_NUM_TCP_WRITEV_PBUF
+#define MEMP_NUM_TCP_WRITEV_PBUF        TCP_SND_QUEUELEN
+#endif
+
+/**
+ * LWIP_TCP_CORK==1: enable tcp_cork(). While a pcb is corked, tcp_output()
+ * holds back a last unsent segment shorter than the MSS until it is full,
+ * tcp_flush() or tcp_uncork() is called, or at most one TCP_TMR_INTERVAL.
+ */
+#ifndef LWIP_TCP_CORK
+#define LWIP_TCP_CORK                   0
+#endif
+
+/**
+ * LWIP_TCP_CC==1: the congestion window follows a module (struct tcp_cc,
+ * tcp_set_cc()) instead of the built-in Reno: tcp_cc_newreno or tcp_cc_cubic.
+ * Fast recovery follows NewReno (RFC 6582) for both: a partial ACK
+ * retransmits the next unacknowledged segment, and recovery only ends once
+ * everything sent before it was ACKed.
+ */
+#ifndef LWIP_TCP_CC
+#define LWIP_TCP_CC                     0
+#endif
+
+/**
+ * TCP_CC_DEFAULT: the congestion control module of a new pcb.
+ * (requires the LWIP_TCP_CC option)
+ */
+#ifndef TCP_CC_DEFAULT
+#define TCP_CC_DEFAULT                  tcp_cc_newreno
+#endif
+
+/**
+ * LWIP_TCP_SACK==1: offer and accept the SACK-permitted option (RFC 2018)
+ * and mark the unacknowledged segments the peer reports in SACK blocks.
+ * Fast recovery then retransmits every hole below the highest SACKed
+ * segment once, instead of one segment per round trip, and skips the SACKed
+ * segments. Only received SACK blocks are used, the stack sends none.
+ * Requires LWIP_TCP_CC==1.
+ */
+#ifndef LWIP_TCP_SACK
+#define LWIP_TCP_SACK                   0
+#endif
+
+/**
+ * TCP_RTO_RFC6298==1: measure the round trip time in milliseconds of
+ * sys_now() and compute the retransmission timeout after RFC 6298: SRTT +
+ * 4 * RTTVAR within TCP_RTO_MIN and TCP_RTO_MAX, doubled per retransmission,
+ * no samples from retransmitted segments. Every pcb arms its own timeout in
+ * the timing wheel, so a retransmission does not wait for tcp_slowtmr().
+ * Requires LWIP_TIMER_WHEEL==1.
+ */
+#ifndef TCP_RTO_RFC6298
+#define TCP_RTO_RFC6298                 0
+#endif
+
+/**
+ * TCP_RTO_INITIAL: retransmission timeout in milliseconds before the first
+ * RTT sample. (requires the TCP_RTO_RFC6298 option)
+ */
+#ifndef TCP_RTO_INITIAL
+#define TCP_RTO_INITIAL                 1000
+#endif
+
+/**
+ * TCP_RTO_MIN: lower limit of the retransmission timeout in milliseconds.
+ * (requires the TCP_RTO_RFC6298 option)
+ */
+#ifndef TCP_RTO_MIN
+#define TCP_RTO_MIN                     1000
+#endif
+
+/**
+ * TCP_RTO_MAX: upper limit of the retransmission timeout in milliseconds,
+ * also of its back-off. (requires the TCP_RTO_RFC6298 option)
+ */
+#ifndef TCP_RTO_MAX
+#define TCP_RTO_MAX                     60000
+#endif
+
+/**
+ * LWIP_TCP_GSO==1: tcp_output() passes a run of consecutive segments of the
+ * same size to a netif with gso_max_segs > 1 as one super-segment, which the
+ * netif splits into the segments itself (struct pbuf_gso). The headers are
+ * built and routed once per super-segment, the data is referenced in place.
+ */
+#ifndef LWIP_TCP_GSO
+#define LWIP_TCP_GSO                    0
+#endif
+
+/**
+ * MEMP_NUM_TCP_GSO: the number of super-segments queued at the netifs at the
+ * same time. tcp_output() sends the segments one by one when none is left.
+ * (requires the LWIP_TCP_GSO option)
+ */
+#ifndef MEMP_NUM_TCP_GSO
+#define MEMP_NUM_TCP_GSO                2
+#endif
+
+/**
+ * MEMP_NUM_TCP_GSO_PBUF: the number of PBUF_REF pbufs referencing the data
+ * of the segments in the queued super-segments, one per pbuf of a segment.
+ * (requires the LWIP_TCP_GSO option)
+ */
+#ifndef MEMP_NUM_TCP_GSO_PBUF
+#define MEMP_NUM_TCP_GSO_PBUF           TCP_SND_QUEUELEN
+#endif
+
 /**
  * LWIP_EVENT_API and LWIP_CALLBACK_API: Only one of these should be set to 1.
  *     LWIP_EVENT_API==1: The user defines lwip_tcp_event() to receive all
@@ -1833,6 +2160,33 @@
 #define CHECKSUM_CHECK_TCP              1
 #endif
 
+/**
+ * CHECKSUM_CHECK_ICMP==1: Check checksums in software for incoming ICMP packets.
+ */
+#ifndef CHECKSUM_CHECK_ICMP
+#define CHECKSUM_CHECK_ICMP             1
+#endif
+
+/**
+ * LWIP_CHECKSUM_CTRL_PER_NETIF==1: Checksum generation/check can be enabled/disabled
+ * per netif (see NETIF_SET_CHECKSUM_CTRL()). The CHECKSUM_GEN_* and CHECKSUM_CHECK_*
+ * options must be left at 1 for the protocols that are offloaded on some netifs only;
+ * the stack then computes those checksums in software for all other netifs.
+ */
+#ifndef LWIP_CHECKSUM_CTRL_PER_NETIF
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    0
+#endif
+
+/**
+ * LWIP_CHKSUM_ALGORITHM_ALL==1: Compile all software checksum algorithms of
+ * inet_chksum.c as lwip_chksum_alg1() .. lwip_chksum_alg4() and
+ * lwip_chksum_copy_alg1(), lwip_chksum_copy_alg2(), e.g. for benchmarks.
+ * The stack still uses LWIP_CHKSUM_ALGORITHM and LWIP_CHKSUM_COPY_ALGORITHM.
+ */
+#ifndef LWIP_CHKSUM_ALGORITHM_ALL
+#define LWIP_CHKSUM_ALGORITHM_ALL       0
+#endif
+
 /**
  * LWIP_CHECKSUM_ON_COPY==1: Calculate checksum when copying data from
  * application buffers to pbufs.
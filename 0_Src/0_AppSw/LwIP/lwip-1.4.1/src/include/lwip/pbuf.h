@@ -41,8 +41,11 @@ extern "C" {
 #endif
 
 /** Currently, the pbuf_custom code is only needed for one specific configuration
- * of IP_FRAG */
-#define LWIP_SUPPORT_CUSTOM_PBUF (IP_FRAG && !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF)
+ * of IP_FRAG, unless the port needs custom pbufs (set it in lwipopts.h) */
+#ifndef LWIP_SUPPORT_CUSTOM_PBUF
+#define LWIP_SUPPORT_CUSTOM_PBUF ((IP_FRAG && !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF) || \
+                                  (LWIP_TCP && (LWIP_TCP_WRITEV || LWIP_TCP_GSO)))
+#endif
 
 #define PBUF_TRANSPORT_HLEN 20
 #define PBUF_IP_HLEN        20
@@ -75,6 +78,11 @@ typedef enum {
 #define PBUF_FLAG_LLMCAST   0x10U
 /** indicates this pbuf includes a TCP FIN flag */
 #define PBUF_FLAG_TCP_FIN   0x20U
+/** indicates this pbuf is the header of a TCP super-segment (struct pbuf_gso) */
+#define PBUF_FLAG_GSO       0x40U
+/** indicates the driver should copy this packet into a buffer of its own, so that it
+    takes a single TX descriptor (see netif->tx_descs) */
+#define PBUF_FLAG_TX_COPY   0x80U
 
 struct pbuf {
   /** next pbuf in singly linked pbuf chain */
@@ -122,6 +130,19 @@ struct pbuf_custom {
 };
 #endif /* LWIP_SUPPORT_CUSTOM_PBUF */
 
+#if LWIP_TCP_GSO
+/** The first pbuf of a TCP super-segment (PBUF_FLAG_GSO): the headers of its
+ * first segment, followed by the data of all segments. The netif sends it as
+ * gso_segs segments of gso_size data bytes, only the last one may be shorter.
+ * Segment i carries the sequence number and IP ID of the headers plus
+ * i * gso_size and i, PSH and FIN only on the last segment. */
+struct pbuf_gso {
+  struct pbuf_custom pc;
+  u16_t gso_size;
+  u16_t gso_segs;
+};
+#endif /* LWIP_TCP_GSO */
+
 #if LWIP_TCP && TCP_QUEUE_OOSEQ
 /** Define this to 0 to prevent freeing ooseq pbufs when the PBUF_POOL is empty */
 #ifndef PBUF_POOL_FREE_OOSEQ
@@ -41,12 +41,14 @@
 #include "lwip/ip.h"
 #include "lwip/icmp.h"
 #include "lwip/err.h"
+#include "lwip/timers.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct tcp_pcb;
+struct tcp_cc;
 
 /** Function prototype for tcp accept callback functions. Called when a new
  * connection can be accepted on a listening pcb.
@@ -153,8 +155,18 @@ enum tcp_state {
 /**
  * members common to struct tcp_pcb and struct tcp_listen_pcb
  */
+#if TCP_PCB_HASH
+/* hash chain of tcp_input(), hash_pprev is NULL if not linked */
+#define TCP_PCB_COMMON_HASH \
+  struct tcp_pcb *hash_next; \
+  struct tcp_pcb **hash_pprev;
+#else /* TCP_PCB_HASH */
+#define TCP_PCB_COMMON_HASH
+#endif /* TCP_PCB_HASH */
+
 #define TCP_PCB_COMMON(type) \
   type *next; /* for the linked list */ \
+  TCP_PCB_COMMON_HASH \
   void *callback_arg; \
   /* the accept callback for listen- and normal pcbs, if LWIP_CALLBACK_API */ \
   DEF_ACCEPT_CALLBACK \
@@ -164,6 +176,16 @@ enum tcp_state {
   u16_t local_port
 
 
+#if LWIP_TCP_CC
+/** State of the congestion control modules in a pcb */
+struct tcp_cc_state {
+  u32_t epoch;   /* CUBIC: sys_now() when the current epoch began, 0 before */
+  u32_t w_est;   /* CUBIC: window of the Reno-friendly region, bytes << 4 */
+  u16_t w_max;   /* CUBIC: cwnd before the last reduction */
+  u16_t k;       /* CUBIC: milliseconds from the epoch until w_max is reached */
+};
+#endif /* LWIP_TCP_CC */
+
 /* the TCP protocol control block */
 struct tcp_pcb {
 /** common PCB members */
@@ -183,6 +205,12 @@ struct tcp_pcb {
 #define TF_FIN         ((u8_t)0x20U)   /* Connection was closed locally (FIN segment enqueued). */
 #define TF_NODELAY     ((u8_t)0x40U)   /* Disable Nagle algorithm */
 #define TF_NAGLEMEMERR ((u8_t)0x80U)   /* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
+#if LWIP_TCP_CORK || LWIP_TCP_SACK
+  u8_t flags2;
+#define TF2_CORK       ((u8_t)0x01U)   /* Hold back the last unsent segment until it is full (tcp_cork). */
+#define TF2_CORK_HELD  ((u8_t)0x02U)   /* tcp_output held a segment back, tcp_fasttmr pushes it. */
+#define TF2_SACK       ((u8_t)0x04U)   /* Both ends sent SACK-permitted. */
+#endif /* LWIP_TCP_CORK || LWIP_TCP_SACK */
 
   /* the rest of the fields are in host byte order
      as we have to do some math with them */
@@ -210,6 +238,13 @@ struct tcp_pcb {
 
   s16_t rto;    /* retransmission time-out */
   u8_t nrtx;    /* number of retransmissions */
+#if TCP_RTO_RFC6298
+  /* RFC 6298 estimator, in milliseconds of sys_now() */
+  u32_t srtt;   /* smoothed RTT << 3, 0 before the first sample */
+  u32_t rttvar; /* RTT variation << 2 */
+  u32_t rto_ms; /* retransmission time-out, backed off */
+  struct sys_timeo rto_timeo; /* retransmission timer */
+#endif /* TCP_RTO_RFC6298 */
 
   /* fast retransmit/recovery */
   u8_t dupacks;
@@ -218,6 +253,14 @@ struct tcp_pcb {
   /* congestion avoidance/control variables */
   u16_t cwnd;
   u16_t ssthresh;
+#if LWIP_TCP_CC
+  const struct tcp_cc *cc; /* congestion control module */
+  struct tcp_cc_state cc_state;
+  u32_t recover;   /* snd_nxt when fast recovery began (NewReno) */
+#endif /* LWIP_TCP_CC */
+#if LWIP_TCP_SACK
+  u32_t sack_high; /* right edge of the highest SACK block, valid in fast recovery */
+#endif /* LWIP_TCP_SACK */
 
   /* sender variables */
   u32_t snd_nxt;   /* next new seqno to be sent */
@@ -243,6 +286,8 @@ struct tcp_pcb {
   struct tcp_seg *unacked;  /* Sent but unacknowledged segments. */
 #if TCP_QUEUE_OOSEQ  
   struct tcp_seg *ooseq;    /* Received out of sequence segments. */
+  struct tcp_seg *ooseq_last; /* Last segment on ooseq, most segments are appended after it. */
+  u32_t ooseq_len;          /* Data bytes on ooseq (TCP_OOSEQ_MAX_BYTES, TCP_RCV_AUTOTUNE). */
 #endif /* TCP_QUEUE_OOSEQ */
 
   struct pbuf *refused_data; /* Data previously received but not yet taken by upper layer */
@@ -359,6 +404,53 @@ err_t            tcp_shutdown(struct tcp_pcb *pcb, int shut_rx, int shut_tx);
 err_t            tcp_write   (struct tcp_pcb *pcb, const void *dataptr, u16_t len,
                               u8_t apiflags);
 
+#if LWIP_TCP_WRITEV
+/** One application buffer of tcp_writev() */
+struct tcp_iovec {
+  const void *base;
+  u16_t len;
+};
+
+/** Function prototype for the completion callback of tcp_writev().
+ * Called once the stack and the netif driver released the last reference to
+ * the buffers: the data was ACKed, or the connection was closed or aborted.
+ * It may run inside tcp_input() or the TX reclaim of the driver, so it must
+ * not call tcp functions for the pcb; use the sent callback for that.
+ *
+ * @param arg Argument passed to tcp_writev()
+ */
+typedef void (*tcp_writev_done_fn)(void *arg);
+
+err_t            tcp_writev  (struct tcp_pcb *pcb, const struct tcp_iovec *iov, u16_t iovcnt,
+                              tcp_writev_done_fn done, void *done_arg, u8_t apiflags);
+#endif /* LWIP_TCP_WRITEV */
+
+#if LWIP_TCP_CORK
+#define          tcp_cork(pcb)            ((pcb)->flags2 |= TF2_CORK)
+#define          tcp_corked(pcb)          (((pcb)->flags2 & TF2_CORK) != 0)
+err_t            tcp_uncork  (struct tcp_pcb *pcb);
+err_t            tcp_flush   (struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_CORK */
+
+#if LWIP_TCP_CC
+/** A congestion control module, see tcp_set_cc(). Fast recovery and the
+ * retransmission timeout set cwnd after loss(): ssthresh + 3 * mss on a fast
+ * retransmit, one mss after a timeout, ssthresh when recovery ends. */
+struct tcp_cc {
+  const char *name;
+  /** An ACK for "acked" new bytes outside fast recovery: open cwnd */
+  void (*ack)(struct tcp_pcb *pcb, u16_t acked);
+  /** A loss, detected by dupacks (timeout == 0) or the retransmission timer:
+   * set ssthresh */
+  void (*loss)(struct tcp_pcb *pcb, u8_t timeout);
+};
+
+extern const struct tcp_cc tcp_cc_newreno;
+extern const struct tcp_cc tcp_cc_cubic;
+
+void             tcp_set_cc  (struct tcp_pcb *pcb, const struct tcp_cc *cc);
+#endif /* LWIP_TCP_CC */
+
 void             tcp_setprio (struct tcp_pcb *pcb, u8_t prio);
 
 #define TCP_PRIO_MIN    1
@@ -66,9 +66,12 @@ void             tcp_input   (struct pbuf *p, struct netif *inp);
 struct tcp_pcb * tcp_alloc   (u8_t prio);
 void             tcp_abandon (struct tcp_pcb *pcb, int reset);
 err_t            tcp_send_empty_ack(struct tcp_pcb *pcb);
-void             tcp_rexmit  (struct tcp_pcb *pcb);
+err_t            tcp_rexmit  (struct tcp_pcb *pcb);
 void             tcp_rexmit_rto  (struct tcp_pcb *pcb);
 void             tcp_rexmit_fast (struct tcp_pcb *pcb);
+#if LWIP_TCP_SACK
+u8_t             tcp_rexmit_sack (struct tcp_pcb *pcb);
+#endif /* LWIP_TCP_SACK */
 u32_t            tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
 err_t            tcp_process_refused_data(struct tcp_pcb *pcb);
 
@@ -89,6 +92,25 @@ err_t            tcp_process_refused_data(struct tcp_pcb *pcb);
                             ) ? 1 : 0)
 #define tcp_output_nagle(tpcb) (tcp_do_output_nagle(tpcb) ? tcp_output(tpcb) : ERR_OK)
 
+#if LWIP_TCP_CORK
+/**
+ * Corked pcbs (tcp_cork) hold back the last unsent segment. Send it if
+ * - the pcb is not corked or
+ * - it is not the last one, or it has no data (SYN) or
+ * - it is as long as tcp_write makes them (min(mss, snd_wnd_max/2)) or
+ * - it carries PSH (tcp_flush) or FIN, or FIN or a memory error is pending or
+ * - the application cannot add to it (no send buffer or queue left)
+ */
+#define tcp_do_output_cork(tpcb, seg) ((((tpcb)->flags2 & TF2_CORK) == 0) || \
+                            ((seg)->next != NULL) || ((seg)->len == 0) || \
+                            (((seg)->len + (LWIP_TCP_OPT_LENGTH((seg)->flags))) >= \
+                              LWIP_MIN((tpcb)->mss, (tpcb)->snd_wnd_max / 2)) || \
+                            (TCPH_FLAGS((seg)->tcphdr) & (TCP_PSH | TCP_FIN)) || \
+                            ((tpcb)->flags & (TF_NAGLEMEMERR | TF_FIN)) || \
+                            ((tcp_sndbuf(tpcb) == 0) || (tcp_sndqueuelen(tpcb) >= TCP_SND_QUEUELEN)) \
+                            ? 1 : 0)
+#endif /* LWIP_TCP_CORK */
+
 
 #define TCP_SEQ_LT(a,b)     ((s32_t)((u32_t)(a) - (u32_t)(b)) < 0)
 #define TCP_SEQ_LEQ(a,b)    ((s32_t)((u32_t)(a) - (u32_t)(b)) <= 0)
@@ -292,16 +314,77 @@ struct tcp_seg {
 #define TF_SEG_OPTS_TS          (u8_t)0x02U /* Include timestamp option. */
 #define TF_SEG_DATA_CHECKSUMMED (u8_t)0x04U /* ALL data (not the header) is
                                                checksummed into 'chksum' */
+#define TF_SEG_OPTS_SACK_PERM   (u8_t)0x08U /* Include SACK-permitted option. */
+#define TF_SEG_SACKED           (u8_t)0x10U /* The peer reported the segment in a SACK block. */
+#define TF_SEG_SACK_REXMIT      (u8_t)0x20U /* Retransmitted for a hole in this fast recovery. */
   struct tcp_hdr *tcphdr;  /* the TCP header */
 };
 
 #define LWIP_TCP_OPT_LENGTH(flags)              \
   (flags & TF_SEG_OPTS_MSS ? 4  : 0) +          \
+  (flags & TF_SEG_OPTS_SACK_PERM ? 4 : 0) +    \
   (flags & TF_SEG_OPTS_TS  ? 12 : 0)
 
+#if LWIP_TCP_WRITEV
+/** A tcp_writev() call with buffers still referenced by queued segments */
+struct tcp_writev_req {
+  tcp_writev_done_fn done;
+  void *done_arg;
+  /** References: every tcp_writev_pbuf, and tcp_writev() itself while it runs */
+  u16_t refs;
+};
+
+/** A PBUF_REF pbuf over (a part of) one buffer of a tcp_writev() call */
+struct tcp_writev_pbuf {
+  struct pbuf_custom pc;
+  struct tcp_writev_req *req;
+};
+#endif /* LWIP_TCP_WRITEV */
+
+#if LWIP_TCP_GSO
+/** Room for the link, IP and TCP headers of a super-segment, options included */
+#define TCP_GSO_HDR_MEM (LWIP_MEM_ALIGN_SIZE(PBUF_LINK_HLEN + PBUF_IP_HLEN) + TCP_HLEN + 40)
+
+/** The header pbuf of a super-segment sent by tcp_output() */
+struct tcp_gso_hdr {
+  struct pbuf_gso gso;
+  u32_t mem[(TCP_GSO_HDR_MEM + 3) / 4];
+};
+
+/** A PBUF_REF pbuf over the data of one pbuf of a segment in a super-segment */
+struct tcp_gso_pbuf {
+  struct pbuf_custom pc;
+  struct pbuf *original;
+};
+#endif /* LWIP_TCP_GSO */
+
 /** This returns a TCP header option for MSS in an u32_t */
 #define TCP_BUILD_MSS_OPTION(mss) htonl(0x02040000 | ((mss) & 0xFFFF))
 
+#if LWIP_TCP_SACK
+/** NOP, NOP and the SACK-permitted option in an u32_t */
+#define TCP_SACK_PERM_OPTION      PP_HTONL(0x01010402)
+#endif /* LWIP_TCP_SACK */
+
+/* The retransmission timer: the timeout of the pcb in the timing wheel
+   (TCP_RTO_RFC6298), or pcb->rtime counted by tcp_slowtmr() */
+#if TCP_RTO_RFC6298
+void tcp_rto_arm(struct tcp_pcb *pcb);
+#define TCP_RTO_START(pcb)   do { if (!sys_timeout_pending(&(pcb)->rto_timeo)) { \
+                                    tcp_rto_arm(pcb); } } while (0)
+#define TCP_RTO_RESTART(pcb) tcp_rto_arm(pcb)
+#define TCP_RTO_STOP(pcb)    sys_timeout_stop(&(pcb)->rto_timeo)
+#define TCP_RTO_RUNNING(pcb) sys_timeout_pending(&(pcb)->rto_timeo)
+/** Retransmission timeout in tcp_slowtmr() ticks, for the ooseq timeout */
+#define TCP_RTO_TICKS(pcb)   (((pcb)->rto_ms + TCP_SLOW_INTERVAL - 1) / TCP_SLOW_INTERVAL)
+#else /* TCP_RTO_RFC6298 */
+#define TCP_RTO_START(pcb)   do { if ((pcb)->rtime == -1) { (pcb)->rtime = 0; } } while (0)
+#define TCP_RTO_RESTART(pcb) ((pcb)->rtime = 0)
+#define TCP_RTO_STOP(pcb)    ((pcb)->rtime = -1)
+#define TCP_RTO_RUNNING(pcb) ((pcb)->rtime >= 0)
+#define TCP_RTO_TICKS(pcb)   ((pcb)->rto)
+#endif /* TCP_RTO_RFC6298 */
+
 /* Global variables: */
 extern struct tcp_pcb *tcp_input_pcb;
 extern u32_t tcp_ticks;
@@ -321,6 +404,25 @@ extern struct tcp_pcb *tcp_tw_pcbs;      /* List of all TCP PCBs in TIME-WAIT. *
 
 extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
 
+#if TCP_PCB_HASH
+#define TCP_PCB_HASH_MASK        (TCP_PCB_HASH_SIZE - 1)
+/** Bucket of tcp_listen_hash for a local port */
+#define TCP_PCB_HASH_PORT(port)  ((((port) >> 8) ^ (port)) & TCP_PCB_HASH_MASK)
+
+/* Active and TIME-WAIT pcbs by tcp_hash_conn(), listening pcbs by TCP_PCB_HASH_PORT() */
+extern struct tcp_pcb *tcp_conn_hash[TCP_PCB_HASH_SIZE];
+extern struct tcp_pcb *tcp_listen_hash[TCP_PCB_HASH_SIZE];
+
+u32_t tcp_hash_conn(u16_t local_port, u16_t remote_port, ip_addr_t *remote_ip);
+void  tcp_hash_link(struct tcp_pcb **pcbs, struct tcp_pcb *pcb);
+void  tcp_hash_unlink(struct tcp_pcb *pcb);
+#define TCP_HASH_REG(pcbs, npcb) tcp_hash_link(pcbs, npcb)
+#define TCP_HASH_RMV(npcb)       tcp_hash_unlink(npcb)
+#else /* TCP_PCB_HASH */
+#define TCP_HASH_REG(pcbs, npcb)
+#define TCP_HASH_RMV(npcb)
+#endif /* TCP_PCB_HASH */
+
 /* Axioms about the above lists:   
    1) Every TCP PCB that is not CLOSED is in one of the lists.
    2) A PCB is only in one of the lists.
@@ -344,6 +446,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
                             (npcb)->next = *(pcbs); \
                             LWIP_ASSERT("TCP_REG: npcb->next != npcb", (npcb)->next != (npcb)); \
                             *(pcbs) = (npcb); \
+                            TCP_HASH_REG(pcbs, npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
               tcp_timer_needed(); \
                             } while(0)
@@ -359,6 +462,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
                                } \
                             } \
                             (npcb)->next = NULL; \
+                            TCP_HASH_RMV(npcb); \
                             LWIP_ASSERT("TCP_RMV: tcp_pcbs sane", tcp_pcbs_sane()); \
                             LWIP_DEBUGF(TCP_DEBUG, ("TCP_RMV: removed %p from %p\n", (npcb), *(pcbs))); \
                             } while(0)
@@ -369,6 +473,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
   do {                                             \
     (npcb)->next = *pcbs;                          \
     *(pcbs) = (npcb);                              \
+    TCP_HASH_REG(pcbs, npcb);                      \
     tcp_timer_needed();                            \
   } while (0)
 
@@ -388,6 +493,7 @@ extern struct tcp_pcb *tcp_tmp_pcb;      /* Only used for temporary storage. */
       }                                            \
     }                                              \
     (npcb)->next = NULL;                           \
+    TCP_HASH_RMV(npcb);                            \
   } while(0)
 
 #endif /* LWIP_DEBUG */
@@ -417,6 +523,9 @@ void tcp_pcb_purge(struct tcp_pcb *pcb);
 void tcp_pcb_remove(struct tcp_pcb **pcblist, struct tcp_pcb *pcb);
 
 void tcp_segs_free(struct tcp_seg *seg);
+#if TCP_QUEUE_OOSEQ
+void tcp_free_ooseq(struct tcp_pcb *pcb);
+#endif /* TCP_QUEUE_OOSEQ */
 void tcp_seg_free(struct tcp_seg *seg);
 struct tcp_seg *tcp_seg_copy(struct tcp_seg *seg);
 
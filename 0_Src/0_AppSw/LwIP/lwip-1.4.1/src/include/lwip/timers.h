@@ -72,8 +72,21 @@ struct sys_timeo {
 #if LWIP_DEBUG_TIMERNAMES
   const char* handler_name;
 #endif /* LWIP_DEBUG_TIMERNAMES */
+#if LWIP_TIMER_WHEEL
+  /** link pointing to this entry, NULL while not pending */
+  struct sys_timeo **pprev;
+  /** re-arm interval in milliseconds, 0 for a one-shot timeout */
+  u32_t period;
+  /** wheel slot holding the entry */
+  u8_t slot;
+  /** SYS_TIMEO_FLAG_* */
+  u8_t flags;
+#endif /* LWIP_TIMER_WHEEL */
 };
 
+/** Returned by sys_timeouts_sleeptime() if no timeout is pending */
+#define SYS_TIMEOUTS_SLEEPTIME_INFINITE 0xFFFFFFFFUL
+
 void sys_timeouts_init(void);
 
 #if LWIP_DEBUG_TIMERNAMES
@@ -87,6 +100,13 @@ void sys_untimeout(sys_timeout_handler handler, void *arg);
 #if NO_SYS
 void sys_check_timeouts(void);
 void sys_restart_timeouts(void);
+u32_t sys_timeouts_sleeptime(void);
+#if LWIP_TIMER_WHEEL
+void sys_timeout_start(struct sys_timeo *timeout, u32_t msecs, u32_t period, sys_timeout_handler handler, void *arg);
+void sys_timeout_stop(struct sys_timeo *timeout);
+/** Returns non-zero if the entry armed by sys_timeout_start() has not expired or been stopped */
+#define sys_timeout_pending(timeout) ((timeout)->pprev != NULL)
+#endif /* LWIP_TIMER_WHEEL */
 #else /* NO_SYS */
 void sys_timeouts_mbox_fetch(sys_mbox_t *mbox, void **msg);
 #endif /* NO_SYS */
@@ -40,6 +40,9 @@
 #include "lwip/netif.h"
 #include "lwip/ip_addr.h"
 #include "lwip/ip.h"
+#if UDP_FLOW_CACHE
+#include "netif/etharp.h"
+#endif /* UDP_FLOW_CACHE */
 
 #ifdef __cplusplus
 extern "C" {
@@ -68,6 +71,26 @@ PACK_STRUCT_END
 #define UDP_FLAGS_CONNECTED      0x04U
 #define UDP_FLAGS_MULTICAST_LOOP 0x08U
 
+#if UDP_FLOW_CACHE
+/** Size of the cached Ethernet + IP + UDP header of a connected pcb */
+#define UDP_FLOW_HLEN (14 + IP_HLEN + UDP_HLEN)
+
+/** Cached headers of a connected pcb, see udp_flow_output() */
+struct udp_flow {
+  /** IP header checksum with tot_len and id set to 0 */
+  u16_t ip_chksum;
+  /** Ethernet, IP and UDP headers, lengths, id and checksums set to 0.
+      Follows a u16_t so that the IP header is 32 bit aligned. */
+  u8_t hdr[UDP_FLOW_HLEN];
+  /** ARP table entry of the next hop */
+  etharp_idx_t arp_idx;
+  /** etharp_cache_version when the destination MAC address was looked up */
+  u32_t arp_version;
+  /** interface the headers were built for, NULL if not valid */
+  struct netif *netif;
+};
+#endif /* UDP_FLOW_CACHE */
+
 struct udp_pcb;
 
 /** Function prototype for udp pcb receive callback functions
@@ -110,6 +133,18 @@ struct udp_pcb {
   u16_t chksum_len_rx, chksum_len_tx;
 #endif /* LWIP_UDPLITE */
 
+#if UDP_FLOW_CACHE
+  /** cached headers for udp_send() on a connected pcb */
+  struct udp_flow flow;
+#endif /* UDP_FLOW_CACHE */
+
+#if UDP_PCB_HASH
+  /** local port hash chain of udp_input(), port_pprev is NULL if not linked */
+  struct udp_pcb *port_next, **port_pprev;
+  /** 4-tuple hash chain of the connected pcbs, conn_pprev is NULL if not linked */
+  struct udp_pcb *conn_next, **conn_pprev;
+#endif /* UDP_PCB_HASH */
+
   /** receive callback function */
   udp_recv_fn recv;
   /** user-supplied argument for the recv callback */
@@ -138,7 +173,7 @@ err_t            udp_send       (struct udp_pcb *pcb, struct pbuf *p);
 
 #if LWIP_CHECKSUM_ON_COPY
 err_t            udp_sendto_if_chksum(struct udp_pcb *pcb, struct pbuf *p,
-                                 ip_addr_t *dst_ip, u16_t dst_port,
+                                 const ip_addr_t *dst_ip, u16_t dst_port,
                                  struct netif *netif, u8_t have_chksum,
                                  u16_t chksum);
 err_t            udp_sendto_chksum(struct udp_pcb *pcb, struct pbuf *p,
@@ -156,6 +191,10 @@ void             udp_input      (struct pbuf *p, struct netif *inp);
 
 void             udp_init       (void);
 
+#if UDP_FLOW_CACHE
+void             udp_flow_invalidate(struct netif *netif);
+#endif /* UDP_FLOW_CACHE */
+
 #if UDP_DEBUG
 void udp_debug_print(struct udp_hdr *udphdr);
 #else
@@ -178,9 +178,16 @@ struct etharp_q_entry {
 };
 #endif /* ARP_QUEUEING */
 
+/** Index of an ARP table entry, negative values are errors (err_t) */
+#if ARP_TABLE_SIZE > 0x7f
+typedef s16_t etharp_idx_t;
+#else /* ARP_TABLE_SIZE > 0x7f */
+typedef s8_t etharp_idx_t;
+#endif /* ARP_TABLE_SIZE > 0x7f */
+
 #define etharp_init() /* Compatibility define, not init needed. */
 void etharp_tmr(void);
-s8_t etharp_find_addr(struct netif *netif, const ip_addr_t *ipaddr,
+etharp_idx_t etharp_find_addr(struct netif *netif, const ip_addr_t *ipaddr,
          struct eth_addr **eth_ret, ip_addr_t **ip_ret);
 err_t etharp_output(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr);
 err_t etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q);
@@ -191,6 +198,24 @@ err_t etharp_request(struct netif *netif, const ip_addr_t *ipaddr);
  *  From RFC 3220 "IP Mobility Support for IPv4" section 4.6. */
 #define etharp_gratuitous(netif) etharp_request((netif), &(netif)->ip_addr)
 void etharp_cleanup_netif(struct netif *netif);
+void etharp_use_entry(struct netif *netif, etharp_idx_t arp_idx);
+
+/** Incremented whenever a resolved ARP entry is removed or changes its
+ *  Ethernet address: cached copies of an entry are valid as long as this
+ *  value does not change. */
+extern u32_t etharp_cache_version;
+
+/** Packets held back or lost by address resolution */
+struct etharp_resolve_stats {
+  /** Packets queued on a pending entry until the reply arrives */
+  u32_t delayed;
+  /** Packets freed unsent: replaced in the queue (!ARP_QUEUEING), no entry or
+   *  memory left, or queued on an entry which expired or was recycled */
+  u32_t dropped;
+  /** Requests sent by etharp_tmr() for used entries (ETHARP_REFRESH_USED) */
+  u32_t refreshes;
+};
+extern struct etharp_resolve_stats etharp_resolve_stats;
 
 #if ETHARP_SUPPORT_STATIC_ENTRIES
 err_t etharp_add_static_entry(ip_addr_t *ipaddr, struct eth_addr *ethaddr);
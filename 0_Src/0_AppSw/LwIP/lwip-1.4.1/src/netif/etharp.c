@@ -80,6 +80,10 @@ const struct eth_addr ethzero = {{0,0,0,0,0,0}};
 /** Re-request a used ARP entry 1 minute before it would expire to prevent
  *  breaking a steadily used connection because the ARP entry timed out. */
 #define ARP_AGE_REREQUEST_USED  (ARP_MAXAGE - 12)
+/** With ETHARP_REFRESH_USED, etharp_tmr() starts re-requesting used entries
+ *  2 minutes before they expire, unicast to the known Ethernet address until
+ *  ARP_AGE_REREQUEST_USED and broadcast after that. */
+#define ARP_AGE_REREQUEST_USED_UNICAST  (ARP_MAXAGE - 24)
 
 /** the time an ARP entry stays pending after first request,
  *  for ARP_TMR_INTERVAL = 5000, this is
@@ -115,12 +119,35 @@ struct etharp_entry {
   struct eth_addr ethaddr;
   u8_t state;
   u8_t ctime;
+#if ETHARP_REFRESH_USED
+  /** A packet was sent to the entry since it was last updated */
+  u8_t used;
+#endif /* ETHARP_REFRESH_USED */
+#if ETHARP_TABLE_HASH
+  /** Next entry in the hash chain or in the free list, as index + 1 */
+  netif_addr_idx_t next;
+#endif /* ETHARP_TABLE_HASH */
 };
 
 static struct etharp_entry arp_table[ARP_TABLE_SIZE];
 
+#if ETHARP_TABLE_HASH
+/** Hash chains of the entries with an IP address, as index + 1 so that
+ *  0 ends a chain and the zeroed tables need no initialisation */
+static netif_addr_idx_t arp_hash[ETHARP_TABLE_HASH_SIZE];
+/** Empty entries below arp_unused, as index + 1 */
+static netif_addr_idx_t arp_free;
+/** The entries from this index on have never been used */
+static u16_t arp_unused;
+#endif /* ETHARP_TABLE_HASH */
+
+/** @see etharp.h */
+u32_t etharp_cache_version;
+/** @see etharp.h */
+struct etharp_resolve_stats etharp_resolve_stats;
+
 #if !LWIP_NETIF_HWADDRHINT
-static u8_t etharp_cached_entry;
+static netif_addr_idx_t etharp_cached_entry;
 #endif /* !LWIP_NETIF_HWADDRHINT */
 
 /** Try hard to create a new entry - we want the IP address to appear in
@@ -133,17 +160,80 @@ static u8_t etharp_cached_entry;
 
 #if LWIP_NETIF_HWADDRHINT
 #define ETHARP_SET_HINT(netif, hint)  if (((netif) != NULL) && ((netif)->addr_hint != NULL))  \
-                                      *((netif)->addr_hint) = (hint);
+                                      *((netif)->addr_hint) = (netif_addr_idx_t)(hint);
 #else /* LWIP_NETIF_HWADDRHINT */
-#define ETHARP_SET_HINT(netif, hint)  (etharp_cached_entry = (hint))
+#define ETHARP_SET_HINT(netif, hint)  (etharp_cached_entry = (netif_addr_idx_t)(hint))
 #endif /* LWIP_NETIF_HWADDRHINT */
 
 
 /* Some checks, instead of etharp_init(): */
-#if (LWIP_ARP && (ARP_TABLE_SIZE > 0x7f))
-  #error "ARP_TABLE_SIZE must fit in an s8_t, you have to reduce it in your lwipopts.h"
+#if (LWIP_ARP && (ARP_TABLE_SIZE > 0x7fff))
+  #error "ARP_TABLE_SIZE must fit in an s16_t, you have to reduce it in your lwipopts.h"
 #endif
 
+#if ETHARP_TABLE_HASH
+/**
+ * Hash bucket of an IP address. The octets are folded together so that the
+ * hosts of a subnet spread over the buckets in any byte order.
+ */
+static u16_t
+etharp_hash_index(const ip_addr_t *ipaddr)
+{
+  u32_t h = ip4_addr_get_u32(ipaddr);
+  h ^= h >> 16;
+  h ^= h >> 8;
+  return (u16_t)(h & (ETHARP_TABLE_HASH_SIZE - 1));
+}
+
+/**
+ * Search the hash chain of an IP address for a pending or stable entry.
+ *
+ * @return the index of the entry, -1 if there is none
+ */
+static etharp_idx_t
+etharp_hash_find(const ip_addr_t *ipaddr)
+{
+  netif_addr_idx_t n = arp_hash[etharp_hash_index(ipaddr)];
+
+  while (n != 0) {
+    if (ip_addr_cmp(ipaddr, &arp_table[n - 1].ipaddr)) {
+      return (etharp_idx_t)(n - 1);
+    }
+    n = arp_table[n - 1].next;
+  }
+  return -1;
+}
+
+/** Insert an entry into the hash chain of its IP address */
+static void
+etharp_hash_link(etharp_idx_t i)
+{
+  netif_addr_idx_t *bucket = &arp_hash[etharp_hash_index(&arp_table[i].ipaddr)];
+
+  arp_table[i].next = *bucket;
+  *bucket = (netif_addr_idx_t)(i + 1);
+}
+
+/** Remove an entry from the hash chain of its IP address */
+static void
+etharp_hash_unlink(etharp_idx_t i)
+{
+  netif_addr_idx_t *link = &arp_hash[etharp_hash_index(&arp_table[i].ipaddr)];
+
+  while (*link != 0) {
+    if (*link == (netif_addr_idx_t)(i + 1)) {
+      *link = arp_table[i].next;
+      return;
+    }
+    link = &arp_table[*link - 1].next;
+  }
+}
+#endif /* ETHARP_TABLE_HASH */
+
+#if ETHARP_REFRESH_USED
+static void etharp_refresh_entry(etharp_idx_t i);
+#endif /* ETHARP_REFRESH_USED */
+
 
 #if ARP_QUEUEING
 /**
@@ -176,15 +266,32 @@ free_etharp_q(struct etharp_q_entry *q)
 static void
 etharp_free_entry(int i)
 {
+  if (arp_table[i].state >= ETHARP_STATE_STABLE) {
+    /* invalidate cached copies of the entry */
+    etharp_cache_version++;
+  }
   /* remove from SNMP ARP index tree */
   snmp_delete_arpidx_tree(arp_table[i].netif, &arp_table[i].ipaddr);
   /* and empty packet queue */
   if (arp_table[i].q != NULL) {
+#if ARP_QUEUEING
+    struct etharp_q_entry *r;
+    for (r = arp_table[i].q; r != NULL; r = r->next) {
+      etharp_resolve_stats.dropped++;
+    }
+#else /* ARP_QUEUEING */
+    etharp_resolve_stats.dropped++;
+#endif /* ARP_QUEUEING */
     /* remove all queued packets */
     LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_free_entry: freeing entry %"U16_F", packet queue %p.\n", (u16_t)i, (void *)(arp_table[i].q)));
     free_etharp_q(arp_table[i].q);
     arp_table[i].q = NULL;
   }
+#if ETHARP_TABLE_HASH
+  etharp_hash_unlink((etharp_idx_t)i);
+  arp_table[i].next = arp_free;
+  arp_free = (netif_addr_idx_t)(i + 1);
+#endif /* ETHARP_TABLE_HASH */
   /* recycle entry for re-use */
   arp_table[i].state = ETHARP_STATE_EMPTY;
 #ifdef LWIP_DEBUG
@@ -205,7 +312,7 @@ etharp_free_entry(int i)
 void
 etharp_tmr(void)
 {
-  u8_t i;
+  etharp_idx_t i;
 
   LWIP_DEBUGF(ETHARP_DEBUG, ("etharp_timer\n"));
   /* remove expired entries from the ARP table */
@@ -231,6 +338,14 @@ etharp_tmr(void)
            re-send an ARP request. */
         arp_table[i].state = ETHARP_STATE_STABLE;
       }
+#if ETHARP_REFRESH_USED
+      /* used entry about to expire? re-request it now instead of waiting
+         for the next packet, which could find it expired */
+      if ((arp_table[i].state == ETHARP_STATE_STABLE) && arp_table[i].used &&
+          (arp_table[i].ctime >= ARP_AGE_REREQUEST_USED_UNICAST)) {
+        etharp_refresh_entry(i);
+      }
+#endif /* ETHARP_REFRESH_USED */
 #if ARP_QUEUEING
       /* still pending entry? (not expired) */
       if (arp_table[i].state == ETHARP_STATE_PENDING) {
@@ -242,34 +357,25 @@ etharp_tmr(void)
 }
 
 /**
- * Search the ARP table for a matching or new entry.
- * 
- * If an IP address is given, return a pending or stable ARP entry that matches
- * the address. If no match is found, create a new entry with this address set,
- * but in state ETHARP_EMPTY. The caller must check and possibly change the
- * state of the returned entry.
- * 
- * If ipaddr is NULL, return a initialized new entry in state ETHARP_EMPTY.
- * 
- * In all cases, attempt to create new entries from an empty entry. If no
- * empty entries are available and ETHARP_FLAG_TRY_HARD flag is set, recycle
- * old entries. Heuristic choose the least important entry for recycling.
+ * Sweep the ARP table for a matching or new entry, see etharp_find_entry().
+ * With ETHARP_TABLE_HASH, this is only called without IP address to recycle
+ * an entry when the table is full.
  *
  * @param ipaddr IP address to find in ARP cache, or to add if not found.
  * @param flags @see definition of ETHARP_FLAG_*
- * @param netif netif related to this address (used for NETIF_HWADDRHINT)
  *  
  * @return The ARP entry index that matched or is created, ERR_MEM if no
  * entry is found or could be recycled.
  */
-static s8_t
-etharp_find_entry(const ip_addr_t *ipaddr, u8_t flags)
+static etharp_idx_t
+etharp_sweep_entry(const ip_addr_t *ipaddr, u8_t flags)
 {
-  s8_t old_pending = ARP_TABLE_SIZE, old_stable = ARP_TABLE_SIZE;
-  s8_t empty = ARP_TABLE_SIZE;
-  u8_t i = 0, age_pending = 0, age_stable = 0;
+  etharp_idx_t old_pending = ARP_TABLE_SIZE, old_stable = ARP_TABLE_SIZE;
+  etharp_idx_t empty = ARP_TABLE_SIZE;
+  etharp_idx_t i = 0;
+  u8_t age_pending = 0, age_stable = 0;
   /* oldest entry with packets on queue */
-  s8_t old_queue = ARP_TABLE_SIZE;
+  etharp_idx_t old_queue = ARP_TABLE_SIZE;
   /* its age */
   u8_t age_queue = 0;
 
@@ -343,7 +449,7 @@ etharp_find_entry(const ip_addr_t *ipaddr, u8_t flags)
       /* or no empty entry found and not allowed to recycle? */
       ((empty == ARP_TABLE_SIZE) && ((flags & ETHARP_FLAG_TRY_HARD) == 0))) {
     LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no empty entry found and not allowed to recycle\n"));
-    return (s8_t)ERR_MEM;
+    return (etharp_idx_t)ERR_MEM;
   }
   
   /* b) choose the least destructive entry to recycle:
@@ -380,7 +486,7 @@ etharp_find_entry(const ip_addr_t *ipaddr, u8_t flags)
       /* no empty or recyclable entries found */
     } else {
       LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: no empty or recyclable entries found\n"));
-      return (s8_t)ERR_MEM;
+      return (etharp_idx_t)ERR_MEM;
     }
 
     /* { empty or recyclable entry found } */
@@ -398,7 +504,71 @@ etharp_find_entry(const ip_addr_t *ipaddr, u8_t flags)
     ip_addr_copy(arp_table[i].ipaddr, *ipaddr);
   }
   arp_table[i].ctime = 0;
-  return (err_t)i;
+  return i;
+}
+
+/**
+ * Search the ARP table for a matching or new entry.
+ * 
+ * If an IP address is given, return a pending or stable ARP entry that matches
+ * the address. If no match is found, create a new entry with this address set,
+ * but in state ETHARP_EMPTY. The caller must check and possibly change the
+ * state of the returned entry.
+ * 
+ * If ipaddr is NULL, return a initialized new entry in state ETHARP_EMPTY.
+ * 
+ * In all cases, attempt to create new entries from an empty entry. If no
+ * empty entries are available and ETHARP_FLAG_TRY_HARD flag is set, recycle
+ * old entries. Heuristic choose the least important entry for recycling.
+ *
+ * @param ipaddr IP address to find in ARP cache, or to add if not found.
+ * @param flags @see definition of ETHARP_FLAG_*
+ *  
+ * @return The ARP entry index that matched or is created, ERR_MEM if no
+ * entry is found or could be recycled.
+ */
+static etharp_idx_t
+etharp_find_entry(const ip_addr_t *ipaddr, u8_t flags)
+{
+#if ETHARP_TABLE_HASH
+  etharp_idx_t i;
+
+  if (ipaddr != NULL) {
+    i = etharp_hash_find(ipaddr);
+    if (i >= 0) {
+      LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_find_entry: found matching entry %"U16_F"\n", (u16_t)i));
+      return i;
+    }
+  }
+  if ((flags & ETHARP_FLAG_FIND_ONLY) != 0) {
+    return (etharp_idx_t)ERR_MEM;
+  }
+
+  if ((arp_free == 0) && (arp_unused == ARP_TABLE_SIZE)) {
+    /* table full: the recycled entry goes to the free list */
+    i = etharp_sweep_entry(NULL, flags);
+    if (i < 0) {
+      return i;
+    }
+  }
+  if (arp_free != 0) {
+    i = (etharp_idx_t)(arp_free - 1);
+    arp_free = arp_table[i].next;
+  } else {
+    i = (etharp_idx_t)arp_unused++;
+  }
+  LWIP_ASSERT("arp_table[i].state == ETHARP_STATE_EMPTY",
+    arp_table[i].state == ETHARP_STATE_EMPTY);
+
+  if (ipaddr != NULL) {
+    ip_addr_copy(arp_table[i].ipaddr, *ipaddr);
+    etharp_hash_link(i);
+  }
+  arp_table[i].ctime = 0;
+  return i;
+#else /* ETHARP_TABLE_HASH */
+  return etharp_sweep_entry(ipaddr, flags);
+#endif /* ETHARP_TABLE_HASH */
 }
 
 /**
@@ -447,7 +617,7 @@ etharp_send_ip(struct netif *netif, struct pbuf *p, struct eth_addr *src, struct
 static err_t
 etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr *ethaddr, u8_t flags)
 {
-  s8_t i;
+  etharp_idx_t i;
   LWIP_ASSERT("netif->hwaddr_len == ETHARP_HWADDR_LEN", netif->hwaddr_len == ETHARP_HWADDR_LEN);
   LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_update_arp_entry: %"U16_F".%"U16_F".%"U16_F".%"U16_F" - %02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F":%02"X16_F"\n",
     ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr),
@@ -467,6 +637,12 @@ etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr
     return (err_t)i;
   }
 
+  if ((arp_table[i].state >= ETHARP_STATE_STABLE) &&
+      ((arp_table[i].netif != netif) || !eth_addr_cmp(&arp_table[i].ethaddr, ethaddr))) {
+    /* invalidate cached copies of the entry */
+    etharp_cache_version++;
+  }
+
 #if ETHARP_SUPPORT_STATIC_ENTRIES
   if (flags & ETHARP_FLAG_STATIC_ENTRY) {
     /* record static type */
@@ -488,6 +664,9 @@ etharp_update_arp_entry(struct netif *netif, ip_addr_t *ipaddr, struct eth_addr
   ETHADDR32_COPY(&arp_table[i].ethaddr, ethaddr);
   /* reset time stamp */
   arp_table[i].ctime = 0;
+#if ETHARP_REFRESH_USED
+  arp_table[i].used = 0;
+#endif /* ETHARP_REFRESH_USED */
   /* this is where we will send out queued packets! */
 #if ARP_QUEUEING
   while (arp_table[i].q != NULL) {
@@ -550,7 +729,7 @@ etharp_add_static_entry(ip_addr_t *ipaddr, struct eth_addr *ethaddr)
 err_t
 etharp_remove_static_entry(ip_addr_t *ipaddr)
 {
-  s8_t i;
+  etharp_idx_t i;
   LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_remove_static_entry: %"U16_F".%"U16_F".%"U16_F".%"U16_F"\n",
     ip4_addr1_16(ipaddr), ip4_addr2_16(ipaddr), ip4_addr3_16(ipaddr), ip4_addr4_16(ipaddr)));
 
@@ -578,7 +757,7 @@ etharp_remove_static_entry(ip_addr_t *ipaddr)
  */
 void etharp_cleanup_netif(struct netif *netif)
 {
-  u8_t i;
+  etharp_idx_t i;
 
   for (i = 0; i < ARP_TABLE_SIZE; ++i) {
     u8_t state = arp_table[i].state;
@@ -599,11 +778,11 @@ void etharp_cleanup_netif(struct netif *netif)
  * @param ip_ret points to return pointer
  * @return table index if found, -1 otherwise
  */
-s8_t
+etharp_idx_t
 etharp_find_addr(struct netif *netif, const ip_addr_t *ipaddr,
          struct eth_addr **eth_ret, ip_addr_t **ip_ret)
 {
-  s8_t i;
+  etharp_idx_t i;
 
   LWIP_ASSERT("eth_ret != NULL && ip_ret != NULL",
     eth_ret != NULL && ip_ret != NULL);
@@ -835,14 +1014,22 @@ etharp_arp_input(struct netif *netif, struct eth_addr *ethaddr, struct pbuf *p)
   pbuf_free(p);
 }
 
-/** Just a small helper function that sends a pbuf to an ethernet address
- * in the arp_table specified by the index 'arp_idx'.
+/**
+ * Marks a resolved ARP entry as used by an outgoing packet. Callers which
+ * cache the Ethernet address (etharp_find_addr) call this for every packet
+ * they send, so that the entry is refreshed like for etharp_output().
+ *
+ * @param netif The lwIP network interface the packet is sent on.
+ * @param arp_idx Index of the entry, as returned by etharp_find_addr().
  */
-static err_t
-etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, u8_t arp_idx)
+void
+etharp_use_entry(struct netif *netif, etharp_idx_t arp_idx)
 {
   LWIP_ASSERT("arp_table[arp_idx].state >= ETHARP_STATE_STABLE",
               arp_table[arp_idx].state >= ETHARP_STATE_STABLE);
+#if ETHARP_REFRESH_USED
+  arp_table[arp_idx].used = 1;
+#endif /* ETHARP_REFRESH_USED */
   /* if arp table entry is about to expire: re-request it,
      but only if its state is ETHARP_STATE_STABLE to prevent flooding the
      network with ARP requests if this address is used frequently. */
@@ -852,6 +1039,15 @@ etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, u8_t arp_idx)
       arp_table[arp_idx].state = ETHARP_STATE_STABLE_REREQUESTING;
     }
   }
+}
+
+/** Just a small helper function that sends a pbuf to an ethernet address
+ * in the arp_table specified by the index 'arp_idx'.
+ */
+static err_t
+etharp_output_to_arp_index(struct netif *netif, struct pbuf *q, etharp_idx_t arp_idx)
+{
+  etharp_use_entry(netif, arp_idx);
   
   return etharp_send_ip(netif, q, (struct eth_addr*)(netif->hwaddr),
     &arp_table[arp_idx].ethaddr);
@@ -915,7 +1111,7 @@ etharp_output(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr)
     dest = &mcastaddr;
   /* unicast destination IP address? */
   } else {
-    s8_t i;
+    etharp_idx_t i;
     /* outside local network? if so, this can neither be a global broadcast nor
        a subnet broadcast. */
     if (!ip_addr_netcmp(ipaddr, &(netif->ip_addr), &(netif->netmask)) &&
@@ -944,20 +1140,27 @@ etharp_output(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr)
 #if LWIP_NETIF_HWADDRHINT
     if (netif->addr_hint != NULL) {
       /* per-pcb cached entry was given */
-      u8_t etharp_cached_entry = *(netif->addr_hint);
+      netif_addr_idx_t etharp_cached_entry = *(netif->addr_hint);
       if (etharp_cached_entry < ARP_TABLE_SIZE) {
 #endif /* LWIP_NETIF_HWADDRHINT */
         if ((arp_table[etharp_cached_entry].state >= ETHARP_STATE_STABLE) &&
             (ip_addr_cmp(dst_addr, &arp_table[etharp_cached_entry].ipaddr))) {
           /* the per-pcb-cached entry is stable and the right one! */
           ETHARP_STATS_INC(etharp.cachehit);
-          return etharp_output_to_arp_index(netif, q, etharp_cached_entry);
+          return etharp_output_to_arp_index(netif, q, (etharp_idx_t)etharp_cached_entry);
         }
 #if LWIP_NETIF_HWADDRHINT
       }
     }
 #endif /* LWIP_NETIF_HWADDRHINT */
 
+#if ETHARP_TABLE_HASH
+    i = etharp_hash_find(dst_addr);
+    if ((i >= 0) && (arp_table[i].state >= ETHARP_STATE_STABLE)) {
+      ETHARP_SET_HINT(netif, i);
+      return etharp_output_to_arp_index(netif, q, i);
+    }
+#else /* ETHARP_TABLE_HASH */
     /* find stable entry: do this here since this is a critical path for
        throughput and etharp_find_entry() is kind of slow */
     for (i = 0; i < ARP_TABLE_SIZE; i++) {
@@ -968,6 +1171,7 @@ etharp_output(struct netif *netif, struct pbuf *q, const ip_addr_t *ipaddr)
         return etharp_output_to_arp_index(netif, q, i);
       }
     }
+#endif /* ETHARP_TABLE_HASH */
     /* no stable entry found, use the (slower) query function:
        queue on destination Ethernet address belonging to ipaddr */
     return etharp_query(netif, dst_addr, q);
@@ -1017,7 +1221,7 @@ etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q)
 {
   struct eth_addr * srcaddr = (struct eth_addr *)netif->hwaddr;
   err_t result = ERR_MEM;
-  s8_t i; /* ARP entry index */
+  etharp_idx_t i; /* ARP entry index */
 
   /* non-unicast address? */
   if (ip_addr_isbroadcast(ipaddr, netif) ||
@@ -1036,6 +1240,7 @@ etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q)
     if (q) {
       LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: packet dropped\n"));
       ETHARP_STATS_INC(etharp.memerr);
+      etharp_resolve_stats.dropped++;
     }
     return (err_t)i;
   }
@@ -1080,8 +1285,10 @@ etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q)
     int copy_needed = 0;
     /* IF q includes a PBUF_REF, PBUF_POOL or PBUF_RAM, we have no choice but
      * to copy the whole queue into a new PBUF_RAM (see bug #11400) 
-     * PBUF_ROMs can be left as they are, since ROM must not get changed. */
-    p = q;
+     * PBUF_ROMs can be left as they are, since ROM must not get changed.
+     * A TCP super-segment owns its headers and holds its data, it is not
+     * copied either: a copy would lose its segmentation. */
+    p = ((q->flags & PBUF_FLAG_GSO) != 0) ? NULL : q;
     while (p) {
       LWIP_ASSERT("no packet queues allowed!", (p->len != p->tot_len) || (p->next == 0));
       if(p->type != PBUF_ROM) {
@@ -1127,10 +1334,12 @@ etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q)
           arp_table[i].q = new_entry;
         }
         LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: queued packet %p on ARP entry %"S16_F"\n", (void *)q, (s16_t)i));
+        etharp_resolve_stats.delayed++;
         result = ERR_OK;
       } else {
         /* the pool MEMP_ARP_QUEUE is empty */
         pbuf_free(p);
+        etharp_resolve_stats.dropped++;
         LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: could not queue a copy of PBUF_REF packet %p (out of memory)\n", (void *)q));
         result = ERR_MEM;
       }
@@ -1139,13 +1348,16 @@ etharp_query(struct netif *netif, const ip_addr_t *ipaddr, struct pbuf *q)
       if (arp_table[i].q != NULL) {
         LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: dropped previously queued packet %p for ARP entry %"S16_F"\n", (void *)q, (s16_t)i));
         pbuf_free(arp_table[i].q);
+        etharp_resolve_stats.dropped++;
       }
       arp_table[i].q = p;
+      etharp_resolve_stats.delayed++;
       result = ERR_OK;
       LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: queued packet %p on ARP entry %"S16_F"\n", (void *)q, (s16_t)i));
 #endif /* ARP_QUEUEING */
     } else {
       ETHARP_STATS_INC(etharp.memerr);
+      etharp_resolve_stats.dropped++;
       LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_query: could not queue a copy of PBUF_REF packet %p (out of memory)\n", (void *)q));
       result = ERR_MEM;
     }
@@ -1263,6 +1475,37 @@ etharp_request(struct netif *netif, const ip_addr_t *ipaddr)
                     (struct eth_addr *)netif->hwaddr, &netif->ip_addr, &ethzero,
                     ipaddr, ARP_REQUEST);
 }
+
+#if ETHARP_REFRESH_USED
+/**
+ * Re-request a used entry before it expires, called by etharp_tmr(). The
+ * request goes to the known Ethernet address first, so that the other hosts
+ * are not bothered, and is broadcast in the last minute. The entry stays
+ * usable until it expires; the reply resets its age.
+ *
+ * @param i index of a stable entry
+ */
+static void
+etharp_refresh_entry(etharp_idx_t i)
+{
+  struct netif *netif = arp_table[i].netif;
+  const struct eth_addr *ethdst_addr = &ethbroadcast;
+  err_t result;
+
+  if (arp_table[i].ctime < ARP_AGE_REREQUEST_USED) {
+    ethdst_addr = &arp_table[i].ethaddr;
+  }
+  LWIP_DEBUGF(ETHARP_DEBUG | LWIP_DBG_TRACE, ("etharp_refresh_entry: re-requesting entry %"U16_F" (%s).\n",
+    (u16_t)i, (ethdst_addr == &ethbroadcast) ? "broadcast" : "unicast"));
+  result = etharp_raw(netif, (struct eth_addr *)netif->hwaddr, ethdst_addr,
+                      (struct eth_addr *)netif->hwaddr, &netif->ip_addr, &ethzero,
+                      &arp_table[i].ipaddr, ARP_REQUEST);
+  if (result == ERR_OK) {
+    etharp_resolve_stats.refreshes++;
+    arp_table[i].state = ETHARP_STATE_STABLE_REREQUESTING;
+  }
+}
+#endif /* ETHARP_REFRESH_USED */
 #endif /* LWIP_ARP */
 
 /**
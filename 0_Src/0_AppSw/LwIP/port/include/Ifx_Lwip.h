@@ -33,10 +33,23 @@
  * \defgroup lib_lwIP LWIP: Light-weight TCP/IP Stack Ported for AURIX
  * \ingroup library
  * - During system initialization, Ifx_Lwip_init() shall be called with proper configuration.
- * - Every 1ms, Ifx_Lwip_onTimerTick() shall be called.
+ * - The compare interrupt of \ref IFX_LWIP_TIMER_COMPARATOR shall call Ifx_Lwip_onTimerTick().
+ *   Ifx_Lwip_pollTimerFlags() programs the compare to the next lwIP timeout (tickless), the
+ *   timeouts are kept in a timing wheel (\ref LWIP_TIMER_WHEEL). sys_now() counts the
+ *   milliseconds of the free-running STM (Ifx_Lwip_now()).
  * - In the main loop or a dedicated task, Ifx_Lwip_pollTimerFlags() and 
  *   Ifx_Lwip_pollReceiveFlags() shall be called.
  *   The priority of Ifx_Lwip_onTimerTick() shall be higher than Ifx_Lwip_poll* functions.
+ * - Ifx_Lwip_pollReceiveFlags() drains up to \ref IFX_LWIP_RX_BUDGET frames per call and
+ *   returns TRUE if the RX ring still holds received frames, in which case it should be
+ *   called again before other background work.
+ * - ISR_Eth shall pass the TI, RI and ERI status to Ifx_Lwip_onEthInterrupt(). The polls
+ *   only touch the descriptor rings when an interrupt published work, so a main loop may
+ *   idle while Ifx_Lwip_isIdle() returns TRUE.
+ * - With RX interrupt moderation (Ifx_Lwip_setRxCoalescing()), the STM compare interrupt
+ *   selected by \ref IFX_LWIP_COALESCE_COMPARATOR shall call Ifx_Lwip_onRxCoalesceTimeout().
+ * - All of the above runs on one core. Applications on other cores exchange UDP datagrams
+ *   with it through the channels of \ref lib_lwIP_mc, polled by Ifx_LwipMc_poll().
  *
  * Initialisation example:
  * \code
@@ -49,6 +62,10 @@
  *      IP4_ADDR(&config.gateway, 192, 168, 178, 1);
  *      MAC_ADDR(&config.ethAddr, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60);
  *
+ *      // - no neighbours known in advance, see Ifx_Lwip_ArpEntry
+ *      config.arpEntries    = NULL_PTR;
+ *      config.arpEntryCount = 0;
+ *
  *      // - setting up LWIP TCP/IP stack. See Ifx_Lwip_init()
  *      Ifx_Lwip_init(&config);
  *  }
@@ -73,11 +90,56 @@
 #include "lwip/tcp_impl.h"
 #include "lwip/dhcp.h"
 #include "lwip/init.h"
+#include "lwip/timers.h"
 #include "netif/etharp.h"
 #include "netif/ppp_oe.h"
 
 #include "ethernetif_tc2x.h"
 
+//________________________________________________________________________________________
+// CONFIGURATION
+
+#ifndef IFX_LWIP_RX_BUDGET
+/** \brief Maximum number of frames passed to the stack per Ifx_Lwip_pollReceiveFlags() call,
+ * one RX ring by default */
+#define IFX_LWIP_RX_BUDGET (IfxEth_getRxDescriptorCount(Ifx_Lwip_getEth()))
+#endif
+
+#ifndef IFX_LWIP_RX_COALESCE_FRAMES
+/** \brief Received frames per RX interrupt after Ifx_Lwip_init(), 0 or 1 disables the moderation */
+#define IFX_LWIP_RX_COALESCE_FRAMES (0)
+#endif
+
+#ifndef IFX_LWIP_RX_COALESCE_US
+/** \brief Maximum delay in microseconds between the first frame of a batch and its RX event */
+#define IFX_LWIP_RX_COALESCE_US (100)
+#endif
+
+#ifndef IFX_LWIP_COALESCE_STM
+/** \brief STM module and comparator timing the RX coalescing timeout */
+#define IFX_LWIP_COALESCE_STM        (&MODULE_STM0)
+#define IFX_LWIP_COALESCE_COMPARATOR (IfxStm_Comparator_1)
+#endif
+
+#ifndef IFX_LWIP_TIMER_STM
+/** \brief STM module and comparator timing the lwIP timeouts, the STM also provides sys_now() */
+#define IFX_LWIP_TIMER_STM        (&MODULE_STM0)
+#define IFX_LWIP_TIMER_COMPARATOR (IfxStm_Comparator_0)
+#endif
+
+#ifndef IFX_LWIP_TIMER_MAX_SLEEP_MS
+/** \brief Longest interval between two timer interrupts, well below the wrap around of the STM lower word */
+#define IFX_LWIP_TIMER_MAX_SLEEP_MS (10000U)
+#endif
+
+/** \brief Buckets of the timer interrupt lateness histogram: below 1 us, then [2^(n-1), 2^n) us */
+#define IFX_LWIP_TIMER_JITTER_BUCKETS (12U)
+
+/** \brief Work pending bits passed to Ifx_Lwip_onEthInterrupt() */
+#define IFX_LWIP_EVENT_RX           (1U << 0)   /**< \brief RI: frames completed in the RX ring */
+#define IFX_LWIP_EVENT_TX           (1U << 1)   /**< \brief TI: frames completed in the TX ring */
+#define IFX_LWIP_EVENT_RX_EARLY     (1U << 2)   /**< \brief ERI: frame stored without RI (DIC set) */
+
 //________________________________________________________________________________________
 // HELPER MACROS
 
@@ -109,32 +171,79 @@ typedef struct tcp_pcb_listen tcp_pcb_listen_t;
 /** \brief Runtime structure of the AURIX LWIP stack */
 typedef struct
 {
-    uint32     timerFlags;
+    uint32     timerFlags;      /**< \brief Timer work pending, raised by Ifx_Lwip_onTimerTick() */
+    volatile uint32 events;     /**< \brief Work pending bitmap published by the interrupts, see IFX_LWIP_EVENT_* */
     netif_t    netif;
 #if LWIP_DHCP
     dhcp_t     dhcp;
 #endif
     eth_addr_t eth_addr;
+    uint32     arpFailed;       /**< \brief Entries of Ifx_Lwip_Config.arpEntries refused by the ARP table */
     struct
     {
-        uint16 arp;
-#if LWIP_DHCP
-        uint16 dhcp_coarse;
-        uint16 dhcp_fine;
-#endif
-        uint16 tcp_fast;
-        uint16 tcp_slow;
-        uint16 link;
+        uint32 ms;              /**< \brief sys_now(), milliseconds since Ifx_Lwip_init() */
+        uint32 lower;           /**< \brief STM lower word at the start of millisecond "ms" */
+        uint32 ticksPerMs;      /**< \brief STM ticks per millisecond, 0 before Ifx_Lwip_init() */
+    }      clock;
+    struct
+    {
+        uint32  due;            /**< \brief sys_now() of the next lwIP timeout, published by Ifx_Lwip_pollTimerFlags() */
+        uint32  compare;        /**< \brief STM lower word programmed into the comparator for "due" */
+        boolean armed;          /**< \brief Compare programmed and its interrupt not yet taken */
+        uint32  ticks;          /**< \brief Calls of Ifx_Lwip_onTimerTick() (compare interrupts) */
+        uint32  wakeups;        /**< \brief Interrupts which found a timeout due and raised the timer flag */
+        uint32  immediate;      /**< \brief Timeouts found due while programming the compare, no interrupt needed */
+        uint32  spurious;       /**< \brief Interrupts of a compare value which was already replaced */
+        uint32  maxLate;        /**< \brief Largest delay in STM ticks from the compare value to Ifx_Lwip_onTimerTick() */
+        uint32  jitter[IFX_LWIP_TIMER_JITTER_BUCKETS]; /**< \brief Histogram of that delay, see IFX_LWIP_TIMER_JITTER_BUCKETS */
     }      timer;
+    struct
+    {
+        uint32 frames;          /**< \brief Frames passed to the stack */
+        uint32 dropped;         /**< \brief Frames dropped by the driver: checksum error or no pbuf */
+        uint32 polls;           /**< \brief Receive polls which found at least one frame */
+        uint32 budgetExhausted; /**< \brief Receive polls which returned with frames left in the ring */
+        uint32 maxBurst;        /**< \brief Largest number of frames drained by one poll */
+        uint32 missed;          /**< \brief Frames lost because no RX descriptor was free (ring overrun) */
+        uint32 fifoOverflow;    /**< \brief Frames lost because of an RX FIFO overflow */
+        uint32 idlePolls;       /**< \brief Receive polls skipped because no work was published */
+        uint32 maxReady;        /**< \brief Largest number of frames ahead of the CPU in the head snapshot */
+        uint32 maxLatency;      /**< \brief Largest delay in STM ticks from the first RX interrupt to the poll */
+        boolean backlog;        /**< \brief Frames were left in the RX ring by the previous poll */
+    }      rx;
+    struct
+    {
+        uint32  rxHead;         /**< \brief RX descriptor index the DMA writes next, snapshot taken with the RX event */
+        uint32  rxStamp;        /**< \brief STM lower word when the oldest unconsumed RX work was signalled */
+        uint32  rxEvents;       /**< \brief RX events published by ISR_Eth */
+        uint32  txEvents;       /**< \brief TX events published by ISR_Eth */
+        uint32  timeouts;       /**< \brief RX events published by the coalescing timeout */
+        boolean armed;          /**< \brief Coalescing timeout running */
+    }      isr;
+    struct
+    {
+        uint32 frames;          /**< \brief Received frames per RX interrupt, 0 or 1 when off */
+        uint32 ticks;           /**< \brief STM ticks from the first frame of a batch to its RX event */
+    }      coalesce;
 } Ifx_Lwip;
 
+/** \brief Neighbour entered into the ARP table by Ifx_Lwip_init() */
+typedef struct
+{
+    ip_addr_t  ipAddr;      /**< \brief IP address of the neighbour */
+    eth_addr_t ethAddr;     /**< \brief Static entry, all zero to send an ARP request instead. Without
+                             * ETHARP_SUPPORT_STATIC_ENTRIES an ARP request is sent for every entry */
+} Ifx_Lwip_ArpEntry;
+
 /** \brief Configuration structure for the AURIX LWIP stack */
 typedef struct
 {
-    ip_addr_t  ipAddr;      /**< \brief IP address, e.g. : {192,168,220,123} */
-    ip_addr_t  netMask;     /**< \brief Network mask, e.g. : {255,255,255,0} */
-    ip_addr_t  gateway;     /**< \brief Gateway address, e.g. : {192,168,220,1} */
-    eth_addr_t ethAddr;     /**< \brief Ethernet (MAC) address, e.g. : {0x10, 0x20, 0x30, 0x40, 0x50, 0x60} */
+    ip_addr_t                ipAddr;        /**< \brief IP address, e.g. : {192,168,220,123} */
+    ip_addr_t                netMask;       /**< \brief Network mask, e.g. : {255,255,255,0} */
+    ip_addr_t                gateway;       /**< \brief Gateway address, e.g. : {192,168,220,1} */
+    eth_addr_t               ethAddr;       /**< \brief Ethernet (MAC) address, e.g. : {0x10, 0x20, 0x30, 0x40, 0x50, 0x60} */
+    const Ifx_Lwip_ArpEntry *arpEntries;    /**< \brief Neighbours known in advance, NULL_PTR if none */
+    uint32                   arpEntryCount; /**< \brief Number of arpEntries */
 } Ifx_Lwip_Config;
 
 //________________________________________________________________________________________
@@ -150,7 +259,13 @@ IFX_EXTERN Ifx_Lwip Ifx_g_Lwip;
 IFX_EXTERN void      Ifx_Lwip_init(const Ifx_Lwip_Config *config);
 IFX_EXTERN void      Ifx_Lwip_onTimerTick(void);
 IFX_EXTERN void      Ifx_Lwip_pollTimerFlags(void);
-IFX_EXTERN void      Ifx_Lwip_pollReceiveFlags(void);
+IFX_EXTERN uint32    Ifx_Lwip_now(void);
+IFX_EXTERN boolean   Ifx_Lwip_pollReceiveFlags(void);
+IFX_EXTERN uint32    Ifx_Lwip_pollReceive(uint32 budget, boolean *pending);
+IFX_EXTERN void      Ifx_Lwip_onEthInterrupt(uint32 events);
+IFX_EXTERN void      Ifx_Lwip_onRxCoalesceTimeout(void);
+IFX_EXTERN void      Ifx_Lwip_setRxCoalescing(uint32 frames, uint32 microseconds);
+IFX_INLINE boolean   Ifx_Lwip_isIdle(void);
 IFX_EXTERN IfxEth   *Ifx_Lwip_getEth(void);
 IFX_INLINE Ifx_Lwip *Ifx_Lwip_get(void);
 IFX_INLINE netif_t  *Ifx_Lwip_getNetIf(void);
@@ -179,6 +294,13 @@ IFX_INLINE netif_t *Ifx_Lwip_getNetIf(void)
 }
 
 
+/** \brief Returns TRUE if no interrupt published work, no frames are left in the RX ring and no lwIP timeout is due */
+IFX_INLINE boolean Ifx_Lwip_isIdle(void)
+{
+    return (Ifx_g_Lwip.events == 0) && (Ifx_g_Lwip.rx.backlog == FALSE) && (Ifx_g_Lwip.timerFlags == 0);
+}
+
+
 /** \brief Returns pointer to the actual IP address */
 IFX_INLINE uint8 *Ifx_Lwip_getIpAddrPtr(void)
 {
@@ -0,0 +1,203 @@
+/**
+ * \file Ifx_LwipMc.h
+ * \brief Multi-core access to the lwIP stack through single-producer/single-consumer rings
+ * \ingroup lib_lwIP
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the AURIX lwIP TCP/IP stack.
+ *
+ * \defgroup lib_lwIP_mc Multi-core channels
+ * \ingroup lib_lwIP
+ * One core owns lwIP (CPU1 with IFX_LWIP_MULTICORE in Ifx_Cfg.h): it calls Ifx_Lwip_init(),
+ * the polls of Ifx_Lwip.h and Ifx_LwipMc_poll(), and takes the ETH and STM interrupts. An
+ * application on another core opens a channel, a UDP pcb bound to a local port, and
+ * exchanges pbufs with the stack core through the two rings of the channel:
+ * - TX ring: Ifx_LwipMc_send() on the application core, udp_sendto() in Ifx_LwipMc_poll()
+ * - RX ring: the receive callback of the pcb on the stack core, Ifx_LwipMc_receive() on
+ *   the application core
+ *
+ * A ring has one producer and one consumer core and takes no lock: only the producer
+ * writes its head, only the consumer its tail, and a __dsync() orders the message before
+ * the index which publishes it. A full ring never blocks either side, Ifx_LwipMc_send()
+ * returns ERR_MEM and the caller keeps the pbuf, a datagram received while the RX ring is
+ * full is dropped and counted. Only Ifx_LwipMc_open() and Ifx_LwipMc_close() take the
+ * spin lock of the channel table; the stack core takes it when one of them raised a request.
+ *
+ * The pbufs of the application cores are allocated and freed through the memp pools, which
+ * take a spin lock or go through the per-core caches (MEMP_NUM_CORE_CACHES); received pbufs
+ * are freed with pbuf_free() on the application core. PBUF_RAM needs MEM_USE_POOLS: its size
+ * classes are memp pools as well, while the heap of mem.c only locks out the interrupts of
+ * one core. Without MEM_USE_POOLS, Ifx_LwipMc_send() refuses PBUF_RAM.
+ * The channel table lives in the LMU and is accessed through its non-cached address.
+ *
+ * Example, an echo service on CPU2:
+ * \code
+ *  Ifx_LwipMc_Channel *echo = Ifx_LwipMc_open(7);
+ *
+ *  while (TRUE)
+ *  {
+ *      ip_addr_t addr;
+ *      uint16    port;
+ *      pbuf_t   *p = Ifx_LwipMc_receive(echo, &addr, &port);
+ *
+ *      if ((p != NULL_PTR) && (Ifx_LwipMc_send(echo, p, &addr, port) != ERR_OK))
+ *      {
+ *          pbuf_free(p);
+ *      }
+ *  }
+ * \endcode
+ */
+
+#ifndef IFX_LWIPMC_H
+#define IFX_LWIPMC_H
+
+//________________________________________________________________________________________
+// INCLUDES
+
+#include "Ifx_Lwip.h"
+
+//________________________________________________________________________________________
+// CONFIGURATION
+
+#ifndef IFX_LWIPMC_CHANNELS
+/** \brief Entries of the channel table, shared by all application cores */
+#define IFX_LWIPMC_CHANNELS   (4)
+#endif
+
+#ifndef IFX_LWIPMC_QUEUE_SIZE
+/** \brief Messages per ring, a power of two. The pbufs waiting in the RX rings hold their
+ * PBUF_POOL buffers, which the receive window of TCP is then short of */
+#define IFX_LWIPMC_QUEUE_SIZE (8)
+#endif
+
+#ifndef IFX_LWIPMC_TX_BUDGET
+/** \brief Datagrams sent per channel and Ifx_LwipMc_poll() call */
+#define IFX_LWIPMC_TX_BUDGET  (IFX_LWIPMC_QUEUE_SIZE)
+#endif
+
+#ifdef IFX_HOST_BUILD
+#define IFX_LWIPMC_NC(address) (address)
+#else
+/** \brief Non-cached alias of an LMU address: segment 0x9 is read through segment 0xB */
+#define IFX_LWIPMC_NC(address) ((void *)((uint32)(address) | 0x20000000U))
+#endif
+
+//________________________________________________________________________________________
+// DATA STRUCTURES
+
+/** \brief State of a channel, written by the application core under the lock while
+ * opening / closing and by the stack core when it served the request */
+typedef enum
+{
+    Ifx_LwipMc_State_closed = 0,    /**< \brief Free table entry */
+    Ifx_LwipMc_State_opening,       /**< \brief Ifx_LwipMc_open() called, the stack core creates the pcb */
+    Ifx_LwipMc_State_open,          /**< \brief Datagrams are exchanged */
+    Ifx_LwipMc_State_closing,       /**< \brief Ifx_LwipMc_close() called, the stack core removes the pcb */
+    Ifx_LwipMc_State_error          /**< \brief The port could not be bound, Ifx_LwipMc_close() frees the entry */
+} Ifx_LwipMc_State;
+
+/** \brief Datagram in a ring */
+typedef struct
+{
+    pbuf_t   *p;
+    ip_addr_t addr;                 /**< \brief Remote IP address */
+    uint16    port;                 /**< \brief Remote UDP port */
+} Ifx_LwipMc_Message;
+
+/** \brief Single-producer/single-consumer ring */
+typedef struct
+{
+    volatile uint32    head;        /**< \brief Messages written, by the producer only */
+    volatile uint32    tail;        /**< \brief Messages read, by the consumer only */
+    Ifx_LwipMc_Message slot[IFX_LWIPMC_QUEUE_SIZE];
+} Ifx_LwipMc_Queue;
+
+/** \brief UDP channel between an application core and the stack core */
+typedef struct
+{
+    volatile Ifx_LwipMc_State state;
+    uint16                    localPort;
+    IfxCpu_Id                 core;         /**< \brief Application core, the one which opened the channel */
+    udp_pcb_t                *pcb;          /**< \brief Used by the stack core only */
+    Ifx_LwipMc_Queue          tx;           /**< \brief Application core to stack core */
+    Ifx_LwipMc_Queue          rx;           /**< \brief Stack core to application core */
+    struct
+    {
+        uint32 sent;                        /**< \brief Datagrams passed to udp_sendto(), by the stack core */
+        uint32 sendErrors;                  /**< \brief Datagrams udp_sendto() failed on, by the stack core */
+        uint32 txFull;                      /**< \brief Ifx_LwipMc_send() calls refused on a full ring, by the application core */
+        uint32 received;                    /**< \brief Datagrams queued into the RX ring, by the stack core */
+        uint32 rxDropped;                   /**< \brief Datagrams dropped on a full RX ring, by the stack core */
+    }                         stats;
+} Ifx_LwipMc_Channel;
+
+/** \brief Channel table */
+typedef struct
+{
+    IfxCpu_spinLock    lock;                /**< \brief Taken to change the state of a channel */
+    volatile uint32    requests;            /**< \brief Open and close requests raised under the lock */
+    uint32             served;              /**< \brief Requests served by the stack core */
+    Ifx_LwipMc_Channel channel[IFX_LWIPMC_CHANNELS];
+} Ifx_LwipMc;
+
+//________________________________________________________________________________________
+// GLOBAL VARIABLES
+
+IFX_EXTERN Ifx_LwipMc Ifx_g_LwipMc;
+
+//________________________________________________________________________________________
+// FUNCTION PROTOTYPES
+
+/** \addtogroup lib_lwIP_mc
+ * \{ */
+IFX_EXTERN Ifx_LwipMc_Channel *Ifx_LwipMc_open(uint16 localPort);
+IFX_EXTERN void                Ifx_LwipMc_close(Ifx_LwipMc_Channel *channel);
+IFX_EXTERN err_t               Ifx_LwipMc_send(Ifx_LwipMc_Channel *channel, pbuf_t *p, const ip_addr_t *addr, uint16 port);
+IFX_EXTERN pbuf_t             *Ifx_LwipMc_receive(Ifx_LwipMc_Channel *channel, ip_addr_t *addr, uint16 *port);
+IFX_EXTERN uint32              Ifx_LwipMc_poll(void);
+IFX_INLINE Ifx_LwipMc_State    Ifx_LwipMc_getState(const Ifx_LwipMc_Channel *channel);
+IFX_INLINE Ifx_LwipMc         *Ifx_LwipMc_get(void);
+/** \} */
+
+//________________________________________________________________________________________
+// INLINE FUNCTION IMPLEMENTATIONS
+
+/** \brief Returns the state of a channel, Ifx_LwipMc_State_open once the stack core bound its port */
+IFX_INLINE Ifx_LwipMc_State Ifx_LwipMc_getState(const Ifx_LwipMc_Channel *channel)
+{
+    return channel->state;
+}
+
+
+/** \brief Returns the channel table through its non-cached address */
+IFX_INLINE Ifx_LwipMc *Ifx_LwipMc_get(void)
+{
+    return (Ifx_LwipMc *)IFX_LWIPMC_NC(&Ifx_g_LwipMc);
+}
+
+
+#endif /* IFX_LWIPMC_H */
@@ -0,0 +1,150 @@
+/**
+ * \file Ifx_UdpStream.h
+ * \brief Burst UDP sender writing datagrams directly into the ETH TX buffers
+ * \ingroup lib_lwIP
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the AURIX lwIP TCP/IP stack.
+ *
+ * \defgroup lib_lwIP_udpStream UDP streaming sender
+ * \ingroup lib_lwIP
+ * The Ethernet, IP and UDP headers of a stream are built once into a template. Each
+ * datagram is written in place into the buffer of a free TX descriptor: the template is
+ * copied, the fill function writes the payload and only the IP length, IP identification
+ * and checksum fields are updated. Ifx_UdpStream_send() submits up to N datagrams per
+ * call, limited by the free TX descriptors and by the optional rate pacing.
+ *
+ * As long as the destination MAC address is not in the ARP cache, one datagram per call
+ * is sent through udp_sendto_if(), which starts the address resolution. The template is
+ * rebuilt when the ARP entry expires or changes and when the interface address changes.
+ *
+ * Example:
+ * \code
+ *  Ifx_UdpStream        stream;
+ *  Ifx_UdpStream_Config config;
+ *
+ *  Ifx_UdpStream_initConfig(&config, Ifx_Lwip_getNetIf());
+ *  IP4_ADDR(&config.remoteIp, 192, 168, 7, 6);
+ *  config.remotePort         = 5001;
+ *  config.payloadSize        = 100;
+ *  config.datagramsPerSecond = 10000;
+ *  Ifx_UdpStream_init(&stream, &config);
+ *
+ *  while (TRUE)
+ *  {
+ *      Ifx_UdpStream_send(&stream, 8);
+ *  }
+ * \endcode
+ */
+
+#ifndef IFX_UDPSTREAM_H
+#define IFX_UDPSTREAM_H
+
+//________________________________________________________________________________________
+// INCLUDES
+
+#include "Ifx_Lwip.h"
+
+//________________________________________________________________________________________
+// CONFIGURATION
+
+/** \brief Size of the Ethernet + IPv4 + UDP header template */
+#define IFX_UDPSTREAM_HEADER_SIZE  (SIZEOF_ETH_HDR - ETH_PAD_SIZE + IP_HLEN + UDP_HLEN)
+
+/** \brief Largest payload which fits into one TX buffer without IP fragmentation */
+#define IFX_UDPSTREAM_MAX_PAYLOAD  (1500 - IP_HLEN - UDP_HLEN)
+
+//________________________________________________________________________________________
+// TYPEDEFS
+
+/** \brief Writes the payload of one datagram
+ * \param arg Argument given in \ref Ifx_UdpStream_Config
+ * \param payload Payload area, inside the TX DMA buffer
+ * \param length Payload length in bytes
+ * \param sequence Number of the datagram since the stream was initialised
+ */
+typedef void (*Ifx_UdpStream_Fill)(void *arg, uint8 *payload, uint16 length, uint32 sequence);
+
+//________________________________________________________________________________________
+// DATA STRUCTURES
+
+/** \brief Configuration of a UDP stream */
+typedef struct
+{
+    netif_t           *netif;              /**< \brief Interface, must use ethernetif_tc2x */
+    ip_addr_t          remoteIp;           /**< \brief Destination IP address */
+    uint16             remotePort;         /**< \brief Destination UDP port */
+    uint16             localPort;          /**< \brief Source UDP port, 0 to use remotePort */
+    uint16             payloadSize;        /**< \brief Payload bytes per datagram */
+    uint8              tos;                /**< \brief IP type of service */
+    uint8              ttl;                /**< \brief IP time to live */
+    uint32             datagramsPerSecond; /**< \brief Pacing rate, 0 sends as fast as the TX ring allows */
+    uint16             burstMax;           /**< \brief Datagrams which may be sent back to back when paced */
+    Ifx_UdpStream_Fill fill;               /**< \brief Payload writer, NULL leaves the payload area untouched */
+    void              *fillArg;            /**< \brief Argument passed to fill */
+} Ifx_UdpStream_Config;
+
+/** \brief Runtime structure of a UDP stream */
+typedef struct
+{
+    Ifx_UdpStream_Config config;
+    udp_pcb_t           *pcb;                                /**< \brief Reserves the local port, used before ARP resolution */
+    boolean              resolved;                           /**< \brief The template holds the destination MAC address */
+    sint16               arpIndex;                           /**< \brief ARP entry of the next hop, -1 for broadcast/multicast */
+    uint32               arpVersion;                         /**< \brief etharp_cache_version when the MAC address was copied */
+    uint8                header[IFX_UDPSTREAM_HEADER_SIZE];  /**< \brief Ethernet/IP/UDP header template */
+    uint32               headerSum;                          /**< \brief Ones complement sum of the constant IP header words */
+    uint16               ipId;                               /**< \brief Next IP identification */
+    uint32               sequence;                           /**< \brief Datagrams sent since init */
+    struct
+    {
+        uint64 period;                                       /**< \brief STM ticks per datagram, 0 if not paced */
+        uint64 next;                                         /**< \brief STM time at which the next datagram is due */
+    }                    pacing;
+    struct
+    {
+        uint32 datagrams;                                    /**< \brief Datagrams sent */
+        uint64 bytes;                                        /**< \brief Payload bytes sent */
+        uint32 ringFull;                                     /**< \brief Calls which stopped on a full TX ring */
+        uint32 paced;                                        /**< \brief Calls which stopped on the pacing rate */
+        uint32 unresolved;                                   /**< \brief Datagrams sent through udp_sendto_if() */
+    }                    stats;
+} Ifx_UdpStream;
+
+//________________________________________________________________________________________
+// FUNCTION PROTOTYPES
+
+/** \addtogroup lib_lwIP_udpStream
+ * \{ */
+IFX_EXTERN void   Ifx_UdpStream_initConfig(Ifx_UdpStream_Config *config, netif_t *netif);
+IFX_EXTERN err_t  Ifx_UdpStream_init(Ifx_UdpStream *stream, const Ifx_UdpStream_Config *config);
+IFX_EXTERN void   Ifx_UdpStream_deinit(Ifx_UdpStream *stream);
+IFX_EXTERN uint32 Ifx_UdpStream_send(Ifx_UdpStream *stream, uint32 count);
+IFX_EXTERN void   Ifx_UdpStream_invalidate(Ifx_UdpStream *stream);
+/** \} */
+
+#endif /* IFX_UDPSTREAM_H */
@@ -21,8 +21,13 @@ typedef uint32 u32_t;
 typedef sint8  s8_t;
 typedef sint16 s16_t;
 typedef sint32 s32_t;
+typedef uint64 u64_t;          /* accumulator of LWIP_CHKSUM_ALGORITHM 4 */
 
+#ifdef IFX_HOST_BUILD
+typedef uintptr_t mem_ptr_t;   /* pointers are 64 bit on the host */
+#else
 typedef u32_t  mem_ptr_t;
+#endif
 
 /* printf formatters for data types */
 #define U16_F              "u"
@@ -49,7 +54,36 @@ typedef u32_t  mem_ptr_t;
 
 #define LWIP_PROVIDE_ERRNO
 
+/* multi-core primitives of the per-core memp caches (MEMP_NUM_CORE_CACHES) */
+#include "Cpu/Std/IfxCpu.h"
+
+typedef IfxCpu_spinLock sys_spinlock_t;
+typedef boolean         sys_spin_prot_t;
+
+#define SYS_ARCH_CORE_ID()  ((u8_t)IfxCpu_getCoreId())
+
+/* local interrupts are disabled while the lock is held, so an ISR on the same core can't spin on it */
+#define SYS_ARCH_SPIN_PROTECT(lock, lev)                     \
+    do                                                       \
+    {                                                        \
+        lev = IfxCpu_disableInterrupts();                    \
+        while (IfxCpu_setSpinLock((lock), 0xFFFFU) == FALSE) \
+        {}                                                   \
+    } while (0)
+
+#define SYS_ARCH_SPIN_UNPROTECT(lock, lev) \
+    do                                     \
+    {                                      \
+        __dsync();                         \
+        IfxCpu_resetSpinLock(lock);        \
+        IfxCpu_restoreInterrupts(lev);     \
+    } while (0)
+
+#ifdef IFX_HOST_BUILD
+#include <stdlib.h>
+#else
 #define abort()
+#endif
 
 #ifdef LWIP_DEBUG
 s8_t Ifx_Lwip_printf(const char *s, ...);
@@ -36,7 +36,33 @@
 #include "arch/cc.h"
 #include "Eth/Std/IfxEth.h"
 
+/** Number of frame length classes: up to 64, 128, 256, 512, 1024 bytes and above */
+#define ETHERNETIF_TC2X_RX_SIZE_CLASSES 6
+
+/** Receive statistics, used to tune IFX_LWIP_RX_COPYBREAK */
+struct ethernetif_tc2x_rxstats {
+  u32_t sizes[ETHERNETIF_TC2X_RX_SIZE_CLASSES]; /* received frames per length class */
+  u32_t copybreak;                              /* frames copied into a small pbuf */
+  u32_t small_empty;                            /* copy-break frames which fell back to PBUF_POOL */
+  u32_t pool_empty;                             /* frames dropped, no pbuf available */
+};
+
+/** Transmit statistics, e.g. to check that IP fragments are sent in place */
+struct ethernetif_tc2x_txstats {
+  u32_t copied;                                 /* frames copied into the buffer of their descriptor */
+  u32_t zero_copy;                              /* frames sent from the pbuf memory */
+  u32_t ring_full;                              /* frames rejected with ERR_WOULDBLOCK */
+  u32_t gso;                                    /* frames cut from TCP super-segments */
+};
+
 err_t ethernetif_tc2x_init(struct netif *netif);
 err_t ethernetif_tc2x_input(struct netif *netif);
+u16_t ethernetif_tc2x_reclaim(struct netif *netif);
+u8_t *ethernetif_tc2x_getTxBuffer(struct netif *netif);
+err_t ethernetif_tc2x_sendTxBuffer(struct netif *netif, u16_t length, u8_t more);
+void  ethernetif_tc2x_setConfig(const IfxEth_Config *config);
+struct ethernetif_tc2x_rxstats *ethernetif_tc2x_getRxStats(void);
+struct ethernetif_tc2x_txstats *ethernetif_tc2x_getTxStats(void);
+u16_t ethernetif_tc2x_getTxFree(void);
 
 #endif
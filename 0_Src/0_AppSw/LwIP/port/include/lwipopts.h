@@ -20,6 +20,10 @@
 // ARCHITECTURE options
 //
 #define NO_SYS            1        /**< \brief single thread, no operating system */
+/* Bench_Timers builds timers.c once more with LWIP_TIMER_WHEEL 0 */
+#ifndef LWIP_TIMER_WHEEL
+#define LWIP_TIMER_WHEEL  1        /**< \brief timeouts in a timing wheel, see Ifx_Lwip_pollTimerFlags() */
+#endif
 
 //#define LWIP_SYS LWIP_SYS_EE
 //#define LWIP_SYS LWIP_SYS_FREERTOS
@@ -31,15 +35,26 @@
 // MEMORY options
 //
 
-/* for HEAP */
+/* for HEAP: mem_malloc() takes the elements of the size classes in lwippools.h instead of
+ * searching a first-fit heap of MEM_SIZE bytes; Bench_MemTrace builds mem.c once more with
+ * MEM_USE_POOLS 0 to replay the same traces against the heap */
+#ifndef MEM_USE_POOLS
+#define MEM_USE_POOLS                 1        /**< \brief default is 0 */
+#endif
+#define MEM_USE_POOLS_TRY_BIGGER_POOL 1        /**< \brief default is 0 */
+#define MEM_TELEMETRY                 1        /**< \brief default is 0, see mem_class_get() / mem_heap_get() */
 #define MEM_ALIGNMENT              4           /**< \brief default for 32-bit machine */
-#define MEM_SIZE                   (6 * 1024)  /**< \brief default is only 1600 */
+#define MEM_SIZE                   (6 * 1024)  /**< \brief default is only 1600, heap size with MEM_USE_POOLS 0 */
 
 /* for MEMPOOL */
 #define MEMP_NUM_PBUF              16          /**< \brief default is 16 */
 
 #define MEMP_OVERFLOW_CHECK 0
 
+/* CPU0..CPU2 allocate MEMP_PBUF / MEMP_PBUF_POOL elements from per-core caches */
+#define MEMP_NUM_CORE_CACHES       3           /**< \brief default is 0 */
+#define MEMP_CORE_CACHE_SIZE       2           /**< \brief elements per refill/drain, a cache holds up to twice as many */
+
 #if MEMP_OVERFLOW_CHECK == 0
 #define MEMP_SEPARATE_POOLS        1           /**< \brief default is 0 */
 #endif
@@ -48,7 +63,7 @@
 //#define MEMP_NUM_UDP_PCB         4           /**< \brief default is 4 */
 //#define MEMP_NUM_TCP_PCB         10          /**< \brief default is 5 */
 //#define MEMP_NUM_TCP_PCB_LISTEN  8           /**< \brief default is 8 */
-//#define MEMP_NUM_TCP_SEG         16          /**< \brief default is 16 */
+#define MEMP_NUM_TCP_SEG           32          /**< \brief default is 16, at least TCP_SND_QUEUELEN */
 //#define MEMP_NUM_REASSDATA       5           /**< \brief default is 5 */
 //#define MEMP_NUM_ARP_QUEUE       30          /**< \brief default is 30 */
 //#define MEMP_NUM_IGMP_GROUP      8           /**< \brief default is 8 */
@@ -74,12 +89,37 @@
 #define PBUF_POOL_BUFSIZE   1536            /**< \brief this value is to accommodate ethernet frame. */
 //#define PBUF_LINK_HLEN      16              /**< \brief default is (14 + ETH_PAD_SIZE) */
 
+/* RX copy-break: received frames up to IFX_LWIP_RX_COPYBREAK bytes are copied into a
+ * small pbuf (MEMP_PBUF_SMALL, see lwippools.h) instead of a PBUF_POOL buffer */
+#define IFX_LWIP_RX_COPYBREAK       128     /**< \brief frame length without ETH_PAD_SIZE, 0 disables the copy-break */
+#define IFX_LWIP_RX_SMALL_POOL_SIZE 32      /**< \brief number of small pbufs */
+
+/** \brief Small pbuf element: the struct pbuf_custom followed by the frame */
+#define IFX_LWIP_RX_SMALL_BUFSIZE \
+    (LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf_custom)) + LWIP_MEM_ALIGN_SIZE(IFX_LWIP_RX_COPYBREAK + ETH_PAD_SIZE))
+
+#if IFX_LWIP_RX_COPYBREAK || MEM_USE_POOLS
+#define MEMP_USE_CUSTOM_POOLS    1
+#endif
+
+#if IFX_LWIP_RX_COPYBREAK
+#define LWIP_SUPPORT_CUSTOM_PBUF 1
+#endif
+
 //________________________________________________________________________________________
 // ARP options
 //
 #define LWIP_ARP            1               /**< \brief default is 1 */
 //#define ETHARP_ALWAYS_INSERT    0
-//#define ARP_TABLE_SIZE          10          /**< \brief default is 10 */
+#define ARP_TABLE_SIZE      256             /**< \brief default is 10 */
+/* Bench_Arp builds etharp.c once more with ETHARP_TABLE_HASH 0 */
+#ifndef ETHARP_TABLE_HASH
+#define ETHARP_TABLE_HASH   1               /**< \brief default is 0, ARP entries are looked up in a hash table */
+#endif
+//#define ETHARP_TABLE_HASH_SIZE  64          /**< \brief default is 64 */
+#define LWIP_NETIF_HWADDRHINT 1             /**< \brief default is 0, every pcb remembers its ARP entry */
+#define ETHARP_REFRESH_USED 1               /**< \brief default is 0, used entries are re-requested before they expire */
+#define ETHARP_SUPPORT_STATIC_ENTRIES 1     /**< \brief default is 0, Ifx_Lwip_Config.arpEntries */
 //#define ARP_QUEUEING            1           /**< \brief default is 0 */
 #define ETHARP_TRUST_IP_MAC 1               /**< \brief default is 0 */
 
@@ -92,7 +132,19 @@
 //#define IP_FRAG                 0           /**< \brief default is 1 */
 //#define IP_REASS_MAXAGE         3           /**< \brief default is 3 */
 //#define IP_REASS_MAX_PBUFS      10          /**< \brief default is 10 */
-//#define IP_FRAG_USES_STATIC_BUF 1           /**< \brief default is 1 */
+/* Bench_Reass builds ip_frag.c once more with IP_REASS_HOLES 0 */
+#ifndef IP_REASS_HOLES
+#define IP_REASS_HOLES          1           /**< \brief default is 0, hole descriptors and eviction of stalled datagrams */
+#endif
+#define IP_REASS_MAX_HOLES      12          /**< \brief default is 8, every other fragment of 32 KB missing */
+//#define IP_REASS_MAX_PBUFS_SRC  10          /**< \brief default is IP_REASS_MAX_PBUFS */
+#define IP_REASS_EVICT_IDLE     32          /**< \brief default is 0, about three datagrams of IP_REASS_MAX_PBUFS fragments */
+/* Fragments reference the datagram and go out through the chained TX descriptors, two per
+ * fragment: the TX ring limits how many fragments of a datagram can be queued at once.
+ * Bench_Frag builds ip_frag.c once more with IP_FRAG_USES_STATIC_BUF 1 */
+#ifndef IP_FRAG_USES_STATIC_BUF
+#define IP_FRAG_USES_STATIC_BUF 0           /**< \brief default is 0 */
+#endif
 //#define IP_FRAG_MAX_MTU         1500        /**< \brief default is 1500 */
 //#define IP_DEFAULT_TTL          255         /**< \brief default is 255 */
 
@@ -119,35 +171,84 @@
 //
 #define LWIP_UDP           1                /**< \brief default is 1 */
 //#define UDP_TTL                 255         /**< \brief default is (IP_DEFAULT_TTL) */
-#define CHECKSUM_CHECK_UDP 0                /**< \brief default is 1 */
-#define CHECKSUM_GEN_UDP   0                /**< \brief default is 1 */
+#define UDP_FLOW_CACHE     1                /**< \brief default is 0, cached headers for connected pcbs */
+/* Bench_UdpDemux builds udp.c once more with UDP_PCB_HASH 0 */
+#ifndef UDP_PCB_HASH
+#define UDP_PCB_HASH       1                /**< \brief default is 0, udp_input() looks the pcbs up in hash tables */
+#endif
+//#define UDP_PCB_HASH_SIZE       32          /**< \brief default is 32 */
 
 //________________________________________________________________________________________
 // TCP options
 //
 #define LWIP_TCP           1                /**< \brief default is 1 */
 //#define TCP_TTL                 255         /**< \brief default is (IP_DEFAULT_TTL) */
-//#define TCP_MSS                 (1500 - 40)	  /* TCP_MSS = (Ethernet MTU - IP header size - TCP header size) */
-//#define TCP_SND_BUF             (4*TCP_MSS)
-//#define TCP_SND_QUEUELEN        (6 * TCP_SND_BUF)/TCP_MSS
+#define TCP_MSS            (1500 - 40)      /**< \brief default is 536, Ethernet MTU - IP header size - TCP header size */
+/* Bench_TcpStream reports the goodput against the window of the peer: with 100 Mbit/s
+ * and an RTT of 1 ms, 12.5 KB must be in flight to fill the link. TCP_SND_QUEUELEN
+ * follows from TCP_SND_BUF, 32 pbufs */
+#ifndef TCP_SND_BUF
+#define TCP_SND_BUF        (8 * TCP_MSS)    /**< \brief default is 2 * TCP_MSS */
+#endif
 //#define TCP_QUEUE_OOSEQ         0
-//#define TCP_WND                 (2*TCP_MSS)
+/* The receive window follows the free PBUF_POOL buffers, TCP_WND is the window of a single
+ * connection. Bench_TcpRecv compares against static windows when built with
+ * HOST_EXTRA_CFLAGS=-DTCP_RCV_AUTOTUNE=0, optionally with -DTCP_WND=5840 (4 * TCP_MSS) */
+#ifndef TCP_RCV_AUTOTUNE
+#define TCP_RCV_AUTOTUNE   1                /**< \brief default is 0 */
+#endif
+#define TCP_RCV_POOL_RESERVE 4              /**< \brief default is PBUF_POOL_SIZE / 4, left to the RX path of UDP, ARP and ICMP */
+#ifndef TCP_WND
+#define TCP_WND            (12 * TCP_MSS)   /**< \brief default is 4 * TCP_MSS, the PBUF_POOL buffers above TCP_RCV_POOL_RESERVE */
+#endif
+#define TCP_OOSEQ_MAX_BYTES (4 * TCP_MSS)   /**< \brief default is 0 (no limit), per pcb */
+/* tcp_writev() references the application buffers, tcp_cork() coalesces small writes */
+#define LWIP_TCP_WRITEV    1                /**< \brief default is 0 */
+#define MEMP_NUM_TCP_WRITEV 8               /**< \brief default is 4, about one call per segment in flight */
+#define LWIP_TCP_CORK      1                /**< \brief default is 0 */
+/* Bench_TcpLoss compares against the built-in Reno and slow-timer RTO when built with
+ * HOST_EXTRA_CFLAGS="-DLWIP_TCP_CC=0 -DLWIP_TCP_SACK=0 -DTCP_RTO_RFC6298=0" */
+#ifndef LWIP_TCP_CC
+#define LWIP_TCP_CC        1                /**< \brief default is 0, NewReno or CUBIC per pcb */
+#endif
+#ifndef LWIP_TCP_SACK
+#define LWIP_TCP_SACK      1                /**< \brief default is 0 */
+#endif
+#ifndef TCP_RTO_RFC6298
+#define TCP_RTO_RFC6298    1                /**< \brief default is 0, RTO in the timing wheel */
+#endif
+#define TCP_RTO_MIN        200              /**< \brief default is 1000 ms, the bench links are LANs */
+/* With LWIP_TCP_GSO, tcp_output() hands runs of full segments to ethernetif_tc2x as one
+ * super-segment. Off: the bench peer ACKs every segment, so few runs form and Bench_TcpStream shows
+ * no gain over segment by segment; build with HOST_EXTRA_CFLAGS=-DLWIP_TCP_GSO=1 to compare */
+#ifndef LWIP_TCP_GSO
+#define LWIP_TCP_GSO       0                /**< \brief default is 0 */
+#endif
+/* Bench_TcpConn compares against the lists when built with HOST_EXTRA_CFLAGS=-DTCP_PCB_HASH=0 */
+#ifndef TCP_PCB_HASH
+#define TCP_PCB_HASH       1                /**< \brief default is 0, tcp_input() looks the pcbs up in hash tables */
+#endif
+//#define TCP_PCB_HASH_SIZE       32          /**< \brief default is 32 */
 
 //________________________________________________________________________________________
 // Checksum generation
 //
 #define LWIP_USE_HW_CHECKSUM_ENGINE (1)
 
-#if LWIP_USE_HW_CHECKSUM_ENGINE
-#define CHECKSUM_GEN_IP    0                /**< \brief default is 1 */
-#define CHECKSUM_GEN_ICMP  0                /**< \brief default is 1 */
-#define CHECKSUM_GEN_TCP   0                /**< \brief default is 1 */
+/* CHECKSUM_GEN_x / CHECKSUM_CHECK_x keep their default 1: the ETH driver turns the software
+ * checksums off for its own netif when the engine is used, all other netifs keep them */
+#define LWIP_CHECKSUM_CTRL_PER_NETIF 1      /**< \brief default is 0 */
 
-#define CHECKSUM_CHECK_IP   0
-#define CHECKSUM_CHECK_ICMP 0
-#define CHECKSUM_CHECK_TCP  0
+#if LWIP_USE_HW_CHECKSUM_ENGINE
+#define LWIP_INLINE_IP_CHKSUM      0        /**< \brief default is 1, no IP header sum for offloading netifs */
+#else
+#define LWIP_CHECKSUM_ON_COPY      1        /**< \brief default is 0 */
+#define LWIP_CHKSUM_COPY_ALGORITHM 2        /**< \brief checksum while copying, default is 1 */
 #endif
 
+/* software checksums: reassembly, copied TX frames and the host build */
+#define LWIP_CHKSUM_ALGORITHM      4        /**< \brief 32 bit words, 64 bit accumulator, default is 2 */
+
 //________________________________________________________________________________________
 // LWIP callback options
 //
@@ -0,0 +1,28 @@
+/**
+ * \file lwippools.h
+ * \brief Custom memory pools of the AURIX LWIP port.
+ * \ingroup lib_lwIP_opts
+ *
+ * Included by lwip/memp_std.h when MEMP_USE_CUSTOM_POOLS is set in lwipopts.h. The file
+ * is read several times with different definitions of LWIP_MEMPOOL, it has no include
+ * guard on purpose.
+ */
+
+#if MEM_USE_POOLS
+/* size classes of mem_malloc(), smallest first. A PBUF_RAM takes the struct pbuf, the
+ * headers reserved for its layer and the data; with MEM_USE_POOLS_TRY_BIGGER_POOL a
+ * request spills into the next class when its own is empty. The numbers follow the
+ * high-water marks reported by Bench_MemTrace for the traces of the main loop. */
+LWIP_MALLOC_MEMPOOL_START
+LWIP_MALLOC_MEMPOOL(16, 128)    /* ARP, TCP headers of tcp_writev(), short UDP, descriptor tables */
+LWIP_MALLOC_MEMPOOL(16, 256)    /* UDP up to ~190 bytes, one per TX descriptor */
+LWIP_MALLOC_MEMPOOL(4, 640)     /* UDP and TCP up to ~570 bytes */
+LWIP_MALLOC_MEMPOOL(8, 1600)    /* full-size frames, TCP segments copied by tcp_write() */
+LWIP_MALLOC_MEMPOOL_END
+#endif
+
+
+#if IFX_LWIP_RX_COPYBREAK
+/* small RX pbufs of the copy-break, see low_level_input() in ethernetif_tc2x.c */
+LWIP_MEMPOOL(PBUF_SMALL, IFX_LWIP_RX_SMALL_POOL_SIZE, IFX_LWIP_RX_SMALL_BUFSIZE, "PBUF_SMALL")
+#endif
@@ -33,6 +33,7 @@
 #include "Ifx_Lwip.h"
 #include "Stm/Std/IfxStm.h"
 #include "Scu/Std/IfxScuCcu.h"
+#include "Cpu/Std/IfxCpu.h"
 #include "Cpu/Std/IfxCpu_Intrinsics.h"
 
 #include <string.h>
@@ -41,104 +42,403 @@
 //________________________________________________________________________________________
 // BASIC FUNCTIONS
 
-#define IFX_LWIP_TIMER_TICK_MS      (1U)    // number of timer ticks per millisecond
-
-#define IFX_LWIP_ARP_PERIOD         (ARP_TMR_INTERVAL / IFX_LWIP_TIMER_TICK_MS)
-#define IFX_LWIP_TCP_FAST_PERIOD    (TCP_FAST_INTERVAL / IFX_LWIP_TIMER_TICK_MS)
-#define IFX_LWIP_TCP_SLOW_PERIOD    (TCP_SLOW_INTERVAL / IFX_LWIP_TIMER_TICK_MS)
-#define IFX_LWIP_DHCP_COARSE_PERIOD (DHCP_COARSE_TIMER_MSECS / IFX_LWIP_TIMER_TICK_MS)
-#define IFX_LWIP_DHCP_FINE_PERIOD   (DHCP_FINE_TIMER_MSECS / IFX_LWIP_TIMER_TICK_MS)
-#define IFX_LWIP_LINK_PERIOD        (100U / IFX_LWIP_TIMER_TICK_MS) /* 100 ms */
-
-#define IFX_LWIP_FLAG_ARP           (1U << 1)
-#define IFX_LWIP_FLAG_TCP_FAST      (1U << 2)
-#define IFX_LWIP_FLAG_TCP_SLOW      (1U << 3)
-#define IFX_LWIP_FLAG_LINK          (1U << 4)
-#define IFX_LWIP_FLAG_DHCP_COARSE   (1U << 5)
-#define IFX_LWIP_FLAG_DHCP_FINE     (1U << 6)
+#define IFX_LWIP_FLAG_TIMEOUT       (1U << 0)   // an lwIP timeout is due
 
 #ifdef __DCC__
 __attribute__ ((section(".g_Lwip")))
 #endif
 Ifx_Lwip Ifx_g_Lwip;  /**< \brief LWIP-related global variable */
 
-#define Ifx_Lwip_timerIncr(var, PERIOD, FLAG) \
-    {                                         \
-        var += 1;                             \
-        if (var >= PERIOD)                    \
-        {                                     \
-            var         = 0;                  \
-            timerFlags |= FLAG;               \
-        }                                     \
+/** \brief Returns the milliseconds since Ifx_Lwip_init(), the time base of sys_now()
+ *
+ * The STM lower word is extended to a millisecond counter which wraps around at 2^32 ms,
+ * it has to be read at least once per wrap around of the lower word. The timer interrupt
+ * takes care of that, see IFX_LWIP_TIMER_MAX_SLEEP_MS.
+ */
+uint32 Ifx_Lwip_now(void)
+{
+    Ifx_Lwip *lwip           = &Ifx_g_Lwip;
+    boolean   interruptState = IfxCpu_disableInterrupts();
+    uint32    ms;
+
+    if (lwip->clock.ticksPerMs != 0)
+    {
+        ms                 = (IfxStm_getLower(IFX_LWIP_TIMER_STM) - lwip->clock.lower) / lwip->clock.ticksPerMs;
+        lwip->clock.lower += ms * lwip->clock.ticksPerMs;
+        lwip->clock.ms    += ms;
+    }
+
+    ms = lwip->clock.ms;
+    IfxCpu_restoreInterrupts(interruptState);
+
+    return ms;
+}
+
+
+/** \brief Programs the comparator to the start of millisecond "due", interrupts must be disabled
+ *
+ * A compare value the STM has already passed would only match after a wrap around of the
+ * lower word, in that case the timer flag is raised at once.
+ */
+static void Ifx_Lwip_armTimer(Ifx_Lwip *lwip, uint32 due)
+{
+    uint32 now = Ifx_Lwip_now();
+
+    lwip->timer.due     = due;
+    lwip->timer.compare = lwip->clock.lower + ((due - now) * lwip->clock.ticksPerMs);
+    lwip->timer.armed   = TRUE;
+    IfxStm_updateCompare(IFX_LWIP_TIMER_STM, IFX_LWIP_TIMER_COMPARATOR, lwip->timer.compare);
+
+    if ((sint32)(IfxStm_getLower(IFX_LWIP_TIMER_STM) - lwip->timer.compare) >= 0)
+    {
+        lwip->timer.armed = FALSE;
+        lwip->timer.immediate++;
+        lwip->timerFlags  = IFX_LWIP_FLAG_TIMEOUT;
     }
+}
 
-/** \brief Timer interrupt callback */
+
+/** \brief Timer interrupt callback
+ *
+ * Called by the compare interrupt programmed by Ifx_Lwip_pollTimerFlags(). Records the delay
+ * from the compare value and raises the timer flag once sys_now() reached the next lwIP
+ * timeout.
+ */
 void Ifx_Lwip_onTimerTick(void)
 {
-    Ifx_Lwip *lwip       = &Ifx_g_Lwip;
-    uint32    timerFlags = lwip->timerFlags;
+    Ifx_Lwip *lwip = &Ifx_g_Lwip;
+    uint32    late;
+    uint32    bucket;
 
-    Ifx_Lwip_timerIncr(lwip->timer.arp, IFX_LWIP_ARP_PERIOD, IFX_LWIP_FLAG_ARP);
+    lwip->timer.ticks++;
 
-    Ifx_Lwip_timerIncr(lwip->timer.tcp_fast, IFX_LWIP_TCP_FAST_PERIOD, IFX_LWIP_FLAG_TCP_FAST);
-    Ifx_Lwip_timerIncr(lwip->timer.tcp_slow, IFX_LWIP_TCP_SLOW_PERIOD, IFX_LWIP_FLAG_TCP_SLOW);
+    if (lwip->clock.ticksPerMs == 0)
+    {
+        return;
+    }
+
+    late = IfxStm_getLower(IFX_LWIP_TIMER_STM) - lwip->timer.compare;
+
+    if ((lwip->timer.armed == FALSE) || ((sint32)late < 0))
+    {
+        /* the compare was replaced after it matched, or the interrupt of initStm0() */
+        lwip->timer.spurious++;
+    }
+    else
+    {
+        lwip->timer.armed   = FALSE;
+        lwip->timer.maxLate = __max(lwip->timer.maxLate, late);
+        late                = (uint32)(((uint64)late * 1000U) / lwip->clock.ticksPerMs);
 
-    Ifx_Lwip_timerIncr(lwip->timer.dhcp_coarse, IFX_LWIP_DHCP_COARSE_PERIOD, IFX_LWIP_FLAG_DHCP_COARSE);
-    Ifx_Lwip_timerIncr(lwip->timer.dhcp_fine, IFX_LWIP_DHCP_FINE_PERIOD, IFX_LWIP_FLAG_DHCP_FINE);
+        for (bucket = 0; (late != 0) && (bucket < (IFX_LWIP_TIMER_JITTER_BUCKETS - 1)); bucket++)
+        {
+            late >>= 1;
+        }
 
-    Ifx_Lwip_timerIncr(lwip->timer.link, IFX_LWIP_LINK_PERIOD, IFX_LWIP_FLAG_LINK);
+        lwip->timer.jitter[bucket]++;
+    }
 
-    lwip->timerFlags = timerFlags;
+    if ((lwip->timerFlags == 0) && ((sint32)(Ifx_Lwip_now() - lwip->timer.due) >= 0))
+    {
+        lwip->timer.wakeups++;
+        lwip->timerFlags = IFX_LWIP_FLAG_TIMEOUT;
+    }
 }
 
 
-/** \brief Polling the timer event flags */
+/** \brief Polling the timer event flags
+ *
+ * Calls the handlers of the expired lwIP timeouts (ARP, TCP, DHCP, IP reassembly and the
+ * sys_timeout() users) and programs the compare interrupt to the next one. Timeouts started
+ * by other lwIP calls are covered from the next call on. The comparator is only reprogrammed
+ * after a wakeup or for an earlier deadline, a stopped timeout costs one wakeup at most.
+ */
 void Ifx_Lwip_pollTimerFlags(void)
 {
     Ifx_Lwip *lwip       = &Ifx_g_Lwip;
     uint32    timerFlags = __swap(&lwip->timerFlags, 0);
+    uint32    now, sleep;
+    boolean   interruptState;
 
-    if (timerFlags & IFX_LWIP_FLAG_DHCP_COARSE)
+    if (timerFlags & IFX_LWIP_FLAG_TIMEOUT)
     {
-        dhcp_coarse_tmr();
+        sys_check_timeouts();
     }
 
-    if (timerFlags & IFX_LWIP_FLAG_DHCP_FINE)
+    /* the deadline counts from the millisecond of the query */
+    do
     {
-        dhcp_fine_tmr();
+        now   = Ifx_Lwip_now();
+        sleep = sys_timeouts_sleeptime();
+    } while (Ifx_Lwip_now() != now);
+
+    if (sleep > IFX_LWIP_TIMER_MAX_SLEEP_MS)
+    {
+        sleep = IFX_LWIP_TIMER_MAX_SLEEP_MS;
     }
 
-    if (timerFlags & IFX_LWIP_FLAG_TCP_FAST)
+    interruptState = IfxCpu_disableInterrupts();
+
+    if ((timerFlags != 0) || (lwip->timer.armed == FALSE) || ((sint32)(now + sleep - lwip->timer.due) < 0))
     {
-        tcp_fasttmr();
+        Ifx_Lwip_armTimer(lwip, now + sleep);
     }
 
-    if (timerFlags & IFX_LWIP_FLAG_TCP_SLOW)
+    IfxCpu_restoreInterrupts(interruptState);
+}
+
+
+/** \brief Drains the RX ring and reclaims the completed TX descriptors
+ * \param budget Maximum number of frames read from the ring, dropped ones included
+ * \param pending Set to TRUE if the ring still holds received frames on return, can be NULL
+ * \return Number of frames passed to the stack
+ */
+uint32 Ifx_Lwip_pollReceive(uint32 budget, boolean *pending)
+{
+    Ifx_Lwip *lwip    = &Ifx_g_Lwip;
+    IfxEth   *eth     = lwip->netif.state;
+    uint32    count   = 0;
+    uint32    dropped = 0;
+    uint32    missed, overflow;
+    err_t     err     = ERR_OK;
+    boolean   more;
+
+    /* release the pbufs of completed transmissions */
+    ethernetif_tc2x_reclaim(&lwip->netif);
+
+    /* a dropped frame does not end the batch, only the empty ring does */
+    while (((count + dropped) < budget) && (err != ERR_TIMEOUT))
     {
-        tcp_slowtmr();
+        err = ethernetif_tc2x_input(&lwip->netif);
+
+        if (err == ERR_OK)
+        {
+            count++;
+        }
+        else if (err != ERR_TIMEOUT)
+        {
+            dropped++;
+        }
     }
 
-    if (timerFlags & IFX_LWIP_FLAG_ARP)
+    lwip->rx.dropped += dropped;
+    more              = IfxEth_isRxDataAvailable(eth);
+
+    if (count > 0)
     {
-        etharp_tmr();
+        lwip->rx.frames += count;
+        lwip->rx.polls++;
+
+        if (count > lwip->rx.maxBurst)
+        {
+            lwip->rx.maxBurst = count;
+        }
+
+        if (more)
+        {
+            lwip->rx.budgetExhausted++;
+        }
     }
 
-    if (timerFlags & IFX_LWIP_FLAG_LINK)
-    {}
+    IfxEth_readMissedFrameCounter(eth, &missed, &overflow);
+    lwip->rx.missed       += missed;
+    lwip->rx.fifoOverflow += overflow;
+
+    if (pending != NULL_PTR)
+    {
+        *pending = more;
+    }
+
+    return count;
 }
 
 
-/** \brief Polling the ETH receive event flags */
-void Ifx_Lwip_pollReceiveFlags(void)
+/** \brief Publishes RX work with a snapshot of the DMA ring head, interrupts must be disabled */
+static void Ifx_Lwip_publishRx(Ifx_Lwip *lwip, IfxEth *eth)
 {
-    err_t err = ERR_OK;
-    /**
-     * We are assuming that the only interrupt source is an incoming packet
-     */
-    //while (err == ERR_OK)
+    if (((lwip->events & IFX_LWIP_EVENT_RX) == 0) && (lwip->isr.armed == FALSE))
     {
-        err = ethernetif_tc2x_input(&Ifx_g_Lwip.netif);
-    };// while (err == ERR_OK);
+        lwip->isr.rxStamp = IfxStm_getLower(IFX_LWIP_COALESCE_STM);
+    }
+
+    lwip->isr.armed  = FALSE;
+    lwip->isr.rxHead = IfxEth_getDmaRxIndex(eth);
+    lwip->events    |= IFX_LWIP_EVENT_RX;
+}
+
+
+/** \brief ETH interrupt callback
+ * \param events IFX_LWIP_EVENT_* bits of the status flags cleared by ISR_Eth
+ *
+ * RX and TX work is published in Ifx_Lwip::events. With moderation on, the first ERI of a
+ * batch starts the coalescing timeout and masks ERI until the poll has drained the ring.
+ */
+void Ifx_Lwip_onEthInterrupt(uint32 events)
+{
+    Ifx_Lwip *lwip           = &Ifx_g_Lwip;
+    IfxEth   *eth            = lwip->netif.state;
+    boolean   interruptState = IfxCpu_disableInterrupts();
+
+    if (events & IFX_LWIP_EVENT_RX)
+    {
+        lwip->isr.rxEvents++;
+        Ifx_Lwip_publishRx(lwip, eth);
+    }
+    else if ((events & IFX_LWIP_EVENT_RX_EARLY) && (lwip->coalesce.frames > 1)
+             && (lwip->isr.armed == FALSE) && ((lwip->events & IFX_LWIP_EVENT_RX) == 0))
+    {
+        IfxEth_setEarlyRxInterrupt(eth, FALSE);
+        lwip->isr.rxStamp = IfxStm_getLower(IFX_LWIP_COALESCE_STM);
+        lwip->isr.armed   = TRUE;
+        IfxStm_updateCompare(IFX_LWIP_COALESCE_STM, IFX_LWIP_COALESCE_COMPARATOR, lwip->isr.rxStamp + lwip->coalesce.ticks);
+    }
+
+    if (events & IFX_LWIP_EVENT_TX)
+    {
+        lwip->isr.txEvents++;
+        lwip->events |= IFX_LWIP_EVENT_TX;
+    }
+
+    IfxCpu_restoreInterrupts(interruptState);
+}
+
+
+/** \brief Coalescing timeout callback, publishes the frames stored without RI */
+void Ifx_Lwip_onRxCoalesceTimeout(void)
+{
+    Ifx_Lwip *lwip           = &Ifx_g_Lwip;
+    boolean   interruptState = IfxCpu_disableInterrupts();
+
+    /* the compare match of a timeout overtaken by RI is ignored */
+    if (lwip->isr.armed != FALSE)
+    {
+        lwip->isr.timeouts++;
+        Ifx_Lwip_publishRx(lwip, lwip->netif.state);
+    }
+
+    IfxCpu_restoreInterrupts(interruptState);
+}
+
+
+/** \brief Configures the RX interrupt moderation
+ * \param frames Received frames per RX interrupt, 0 or 1 raises RI for every frame.
+ * Every frames-th descriptor and the last one of the ring keep RI, so frames should divide
+ * the RX descriptor count.
+ * \param microseconds Maximum delay between the first frame of a batch and its RX event
+ */
+void Ifx_Lwip_setRxCoalescing(uint32 frames, uint32 microseconds)
+{
+    Ifx_Lwip       *lwip           = &Ifx_g_Lwip;
+    IfxEth         *eth            = lwip->netif.state;
+    IfxEth_RxDescr *descr          = IfxEth_getBaseRxDescriptor(eth);
+    boolean         moderated      = (frames > 1);
+    uint32          count          = IfxEth_getRxDescriptorCount(eth);
+    boolean         interruptState = IfxCpu_disableInterrupts();
+    uint32          i;
+
+    lwip->coalesce.frames = frames;
+    lwip->coalesce.ticks  = (uint32)(IfxStm_getFrequency(IFX_LWIP_COALESCE_STM) / 1000000.0f * (float32)microseconds);
+
+    for (i = 0; i < count; i++)
+    {
+        IfxEth_RxDescr_setInterrupt(&descr[i], (moderated == FALSE) || ((i % frames) == (frames - 1))
+            || (i == (count - 1)));
+    }
+
+    lwip->isr.armed = FALSE;
+    IfxEth_clearEarlyRxInterrupt(eth);
+    IfxEth_setEarlyRxInterrupt(eth, moderated);
+
+    IfxCpu_restoreInterrupts(interruptState);
+}
+
+
+/** \brief Re-enables ERI after the ring was drained
+ * \return TRUE if a frame was stored meanwhile, its ERI may have been cleared
+ */
+static boolean Ifx_Lwip_enableEarlyRx(IfxEth *eth)
+{
+    boolean interruptState = IfxCpu_disableInterrupts();
+
+    IfxEth_clearEarlyRxInterrupt(eth);
+    IfxEth_setEarlyRxInterrupt(eth, TRUE);
+
+    IfxCpu_restoreInterrupts(interruptState);
+
+    return IfxEth_isRxDataAvailable(eth);
+}
+
+
+/** \brief Polling the ETH receive event flags
+ *
+ * Consumes the work published by Ifx_Lwip_onEthInterrupt(): the RX ring is drained on an
+ * RX event or when the previous poll left frames behind, the TX ring is reclaimed on a TX
+ * event. Without an ETH interrupt (isrPriority 0) both rings are polled on every call.
+ * \return TRUE if received frames are left in the RX ring after \ref IFX_LWIP_RX_BUDGET frames
+ */
+boolean Ifx_Lwip_pollReceiveFlags(void)
+{
+    Ifx_Lwip *lwip    = &Ifx_g_Lwip;
+    IfxEth   *eth     = lwip->netif.state;
+    uint32    stamp   = lwip->isr.rxStamp;
+    uint32    events  = __swap((void *)&lwip->events, 0);
+    boolean   pending = FALSE;
+
+    if (eth->config.isrPriority == 0)
+    {
+        events = IFX_LWIP_EVENT_RX | IFX_LWIP_EVENT_TX;
+    }
+    else if ((events & IFX_LWIP_EVENT_RX) && (lwip->rx.backlog == FALSE))
+    {
+        /* the stamp is only written while no RX work is outstanding, so it belongs to this event */
+        uint32 latency = IfxStm_getLower(IFX_LWIP_COALESCE_STM) - stamp;
+        uint32 count   = IfxEth_getRxDescriptorCount(eth);
+        uint32 ready   = (lwip->isr.rxHead + count - IfxEth_getActualRxIndex(eth)) % count;
+
+        if ((ready == 0) && IfxEth_isRxDataAvailable(eth))
+        {
+            ready = count;                      /* head caught up with the CPU: ring full */
+        }
+
+        if (latency > lwip->rx.maxLatency)
+        {
+            lwip->rx.maxLatency = latency;
+        }
+
+        if (ready > lwip->rx.maxReady)
+        {
+            lwip->rx.maxReady = ready;
+        }
+    }
+
+    if ((events & IFX_LWIP_EVENT_RX) || lwip->rx.backlog)
+    {
+        Ifx_Lwip_pollReceive(IFX_LWIP_RX_BUDGET, &pending);
+
+        if ((pending == FALSE) && (lwip->coalesce.frames > 1))
+        {
+            pending = Ifx_Lwip_enableEarlyRx(eth);
+        }
+
+        lwip->rx.backlog = pending;
+    }
+    else if (events & IFX_LWIP_EVENT_TX)
+    {
+        ethernetif_tc2x_reclaim(&lwip->netif);
+    }
+    else
+    {
+        lwip->rx.idlePolls++;
+    }
+
+    return pending;
+}
+
+
+/** \brief Returns pointer to the AURIX ethernet driver */
+IfxEth *Ifx_Lwip_getEth(void)
+{
+    return Ifx_g_Lwip.netif.state;
 }
 
 
@@ -151,11 +451,20 @@ void Ifx_Lwip_pollReceiveFlags(void)
 void Ifx_Lwip_init(const Ifx_Lwip_Config *config)
 {
     Ifx_Lwip *lwip = &Ifx_g_Lwip;
+    uint32    i;
 
     LWIP_DEBUGF(IFX_LWIP_DEBUG, ("Ifx_Lwip_init start!\n"));
 
+    /** - start the millisecond clock of sys_now() on the STM (Ifx_Lwip_now()) */
+    memset(&lwip->timer, 0, sizeof(lwip->timer));
+    lwip->timerFlags       = 0;
+    lwip->clock.ms         = 0;
+    lwip->clock.lower      = IfxStm_getLower(IFX_LWIP_TIMER_STM);
+    lwip->clock.ticksPerMs = (uint32)(IfxStm_getFrequency(IFX_LWIP_TIMER_STM) / 1000.0f);
+
     /** - initialise LWIP (lwip_init()) */
     lwip_init();
+    Ifx_Lwip_pollTimerFlags();
 
     /** - initialise and add a \ref netif */
     lwip->eth_addr = config->ethAddr;
@@ -164,6 +473,39 @@ void Ifx_Lwip_init(const Ifx_Lwip_Config *config)
     netif_set_default(&lwip->netif);
     netif_set_up(&lwip->netif);
 
+    /** - enter the neighbours of the configuration into the ARP table, so that the first
+     *    packet to them does not wait for (or get dropped by) the address resolution:
+     *    static entries, or an ARP request for the entries without Ethernet address. The
+     *    entries the table refuses are counted in Ifx_Lwip.arpFailed */
+    lwip->arpFailed = 0;
+
+    for (i = 0; i < config->arpEntryCount; i++)
+    {
+        ip_addr_t  ipAddr  = config->arpEntries[i].ipAddr;
+        err_t      err;
+#if ETHARP_SUPPORT_STATIC_ENTRIES
+        eth_addr_t ethAddr = config->arpEntries[i].ethAddr;
+
+        if (eth_addr_cmp(&ethAddr, &ethzero) == 0)
+        {
+            err = etharp_add_static_entry(&ipAddr, &ethAddr);
+        }
+        else
+#endif
+        {
+            err = etharp_query(&lwip->netif, &ipAddr, NULL);
+        }
+
+        if (err != ERR_OK)
+        {
+            LWIP_DEBUGF(IFX_LWIP_DEBUG, ("Ifx_Lwip_init: ARP entry %"U32_F" refused (%d)\n", i, err));
+            lwip->arpFailed++;
+        }
+    }
+
+    /** - configure the RX interrupt moderation (Ifx_Lwip_setRxCoalescing()) */
+    Ifx_Lwip_setRxCoalescing(IFX_LWIP_RX_COALESCE_FRAMES, IFX_LWIP_RX_COALESCE_US);
+
 #if 0
     /** - assign \ref dhcp to \ref netif */
     dhcp_set_struct(&lwip->netif, &lwip->dhcp);
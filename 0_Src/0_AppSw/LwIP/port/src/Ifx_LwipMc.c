@@ -0,0 +1,393 @@
+/**
+ * \file Ifx_LwipMc.c
+ * \brief Multi-core access to the lwIP stack through single-producer/single-consumer rings
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the AURIX lwIP TCP/IP stack.
+ */
+
+#include "Ifx_LwipMc.h"
+#include "Cpu/Std/IfxCpu.h"
+#include "Cpu/Std/IfxCpu_Intrinsics.h"
+
+#include <string.h>
+
+//________________________________________________________________________________________
+// PRIVATE DEFINITIONS
+
+#if (IFX_LWIPMC_QUEUE_SIZE & (IFX_LWIPMC_QUEUE_SIZE - 1)) != 0
+#error "IFX_LWIPMC_QUEUE_SIZE must be a power of two"
+#endif
+
+#define IFX_LWIPMC_QUEUE_MASK (IFX_LWIPMC_QUEUE_SIZE - 1U)
+
+//________________________________________________________________________________________
+// GLOBAL VARIABLES
+
+#ifndef IFX_HOST_BUILD
+#pragma section ".lmubss" awc0
+#endif
+Ifx_LwipMc Ifx_g_LwipMc;  /**< \brief Channel table, shared by all cores */
+#ifndef IFX_HOST_BUILD
+#pragma section
+#endif
+
+//________________________________________________________________________________________
+// PRIVATE FUNCTIONS
+
+/** \brief Writes a message into the ring, by the producer core only
+ * \return FALSE if the ring is full
+ */
+static boolean Ifx_LwipMc_push(Ifx_LwipMc_Queue *queue, pbuf_t *p, const ip_addr_t *addr, uint16 port)
+{
+    uint32              head = queue->head;
+    Ifx_LwipMc_Message *slot;
+
+    if ((head - queue->tail) >= IFX_LWIPMC_QUEUE_SIZE)
+    {
+        return FALSE;
+    }
+
+    slot       = &queue->slot[head & IFX_LWIPMC_QUEUE_MASK];
+    slot->p    = p;
+    slot->port = port;
+    ip_addr_copy(slot->addr, *addr);
+
+    /* the message is visible to the consumer before the index which publishes it */
+    __dsync();
+    queue->head = head + 1;
+
+    return TRUE;
+}
+
+
+/** \brief Reads a message from the ring, by the consumer core only
+ * \return The pbuf of the message, NULL if the ring is empty
+ */
+static pbuf_t *Ifx_LwipMc_pop(Ifx_LwipMc_Queue *queue, ip_addr_t *addr, uint16 *port)
+{
+    uint32              tail = queue->tail;
+    Ifx_LwipMc_Message *slot;
+    pbuf_t             *p;
+
+    if (queue->head == tail)
+    {
+        return NULL;
+    }
+
+    /* the message is read after the index which published it */
+    __dsync();
+    slot = &queue->slot[tail & IFX_LWIPMC_QUEUE_MASK];
+    p    = slot->p;
+
+    if (addr != NULL_PTR)
+    {
+        ip_addr_copy(*addr, slot->addr);
+    }
+
+    if (port != NULL_PTR)
+    {
+        *port = slot->port;
+    }
+
+    /* the slot is read before the producer may overwrite it */
+    __dsync();
+    queue->tail = tail + 1;
+
+    return p;
+}
+
+
+/** \brief Frees the pbufs left in a ring, when both of its cores are done with it */
+static void Ifx_LwipMc_drain(Ifx_LwipMc_Queue *queue)
+{
+    pbuf_t *p;
+
+    while ((p = Ifx_LwipMc_pop(queue, NULL_PTR, NULL_PTR)) != NULL)
+    {
+        pbuf_free(p);
+    }
+
+    queue->head = 0;
+    queue->tail = 0;
+}
+
+
+/** \brief Receive callback of the channel pcbs, queues the datagram for the application core */
+static void Ifx_LwipMc_onReceive(void *arg, udp_pcb_t *pcb, pbuf_t *p, ip_addr_t *addr, u16_t port)
+{
+    Ifx_LwipMc_Channel *channel = (Ifx_LwipMc_Channel *)arg;
+
+    (void)pcb;
+
+    if ((channel->state == Ifx_LwipMc_State_open) && Ifx_LwipMc_push(&channel->rx, p, addr, port))
+    {
+        channel->stats.received++;
+    }
+    else
+    {
+        channel->stats.rxDropped++;
+        pbuf_free(p);
+    }
+}
+
+
+/** \brief Creates the pcb of a channel being opened, the lock must be held */
+static void Ifx_LwipMc_serveOpen(Ifx_LwipMc_Channel *channel)
+{
+    udp_pcb_t *pcb = udp_new();
+
+    if ((pcb != NULL) && (udp_bind(pcb, IP_ADDR_ANY, channel->localPort) == ERR_OK))
+    {
+        udp_recv(pcb, Ifx_LwipMc_onReceive, channel);
+        channel->pcb   = pcb;
+        channel->state = Ifx_LwipMc_State_open;
+    }
+    else
+    {
+        if (pcb != NULL)
+        {
+            udp_remove(pcb);
+        }
+
+        channel->state = Ifx_LwipMc_State_error;
+    }
+}
+
+
+/** \brief Removes the pcb of a channel being closed and frees its pending pbufs, the lock must be held */
+static void Ifx_LwipMc_serveClose(Ifx_LwipMc_Channel *channel)
+{
+    if (channel->pcb != NULL_PTR)
+    {
+        udp_remove(channel->pcb);
+        channel->pcb = NULL_PTR;
+    }
+
+    Ifx_LwipMc_drain(&channel->tx);
+    Ifx_LwipMc_drain(&channel->rx);
+    channel->state = Ifx_LwipMc_State_closed;
+}
+
+
+/** \brief Serves the open and close requests raised since the last call */
+static void Ifx_LwipMc_serveRequests(Ifx_LwipMc *mc)
+{
+    sys_spin_prot_t lev;
+    uint32          i;
+
+    SYS_ARCH_SPIN_PROTECT(&mc->lock, lev);
+
+    for (i = 0; i < IFX_LWIPMC_CHANNELS; i++)
+    {
+        Ifx_LwipMc_Channel *channel = &mc->channel[i];
+
+        if (channel->state == Ifx_LwipMc_State_opening)
+        {
+            Ifx_LwipMc_serveOpen(channel);
+        }
+        else if (channel->state == Ifx_LwipMc_State_closing)
+        {
+            Ifx_LwipMc_serveClose(channel);
+        }
+    }
+
+    mc->served = mc->requests;
+
+    SYS_ARCH_SPIN_UNPROTECT(&mc->lock, lev);
+}
+
+
+//________________________________________________________________________________________
+// FUNCTION IMPLEMENTATIONS
+
+/** \brief Opens a UDP channel to the stack core, called on an application core
+ * \param localPort UDP port the stack core binds the channel to
+ * \return The channel, NULL_PTR if the table is full. The channel is usable when
+ * Ifx_LwipMc_getState() returns Ifx_LwipMc_State_open, after the next Ifx_LwipMc_poll()
+ */
+Ifx_LwipMc_Channel *Ifx_LwipMc_open(uint16 localPort)
+{
+    Ifx_LwipMc         *mc      = Ifx_LwipMc_get();
+    Ifx_LwipMc_Channel *channel = NULL_PTR;
+    sys_spin_prot_t     lev;
+    uint32              i;
+
+    SYS_ARCH_SPIN_PROTECT(&mc->lock, lev);
+
+    for (i = 0; i < IFX_LWIPMC_CHANNELS; i++)
+    {
+        if (mc->channel[i].state == Ifx_LwipMc_State_closed)
+        {
+            channel            = &mc->channel[i];
+            channel->localPort = localPort;
+            channel->core      = IfxCpu_getCoreId();
+            channel->pcb       = NULL_PTR;
+            channel->tx.head   = 0;
+            channel->tx.tail   = 0;
+            channel->rx.head   = 0;
+            channel->rx.tail   = 0;
+            memset(&channel->stats, 0, sizeof(channel->stats));
+            channel->state     = Ifx_LwipMc_State_opening;
+            mc->requests++;
+            break;
+        }
+    }
+
+    SYS_ARCH_SPIN_UNPROTECT(&mc->lock, lev);
+
+    return channel;
+}
+
+
+/** \brief Closes a channel, called on the application core which opened it
+ *
+ * The stack core removes the pcb and frees the pbufs left in both rings. The application
+ * must not use the channel after this call.
+ */
+void Ifx_LwipMc_close(Ifx_LwipMc_Channel *channel)
+{
+    Ifx_LwipMc     *mc = Ifx_LwipMc_get();
+    sys_spin_prot_t lev;
+
+    SYS_ARCH_SPIN_PROTECT(&mc->lock, lev);
+
+    if (channel->state == Ifx_LwipMc_State_error)
+    {
+        channel->state = Ifx_LwipMc_State_closed;
+    }
+    else if (channel->state != Ifx_LwipMc_State_closed)
+    {
+        channel->state = Ifx_LwipMc_State_closing;
+        mc->requests++;
+    }
+
+    SYS_ARCH_SPIN_UNPROTECT(&mc->lock, lev);
+}
+
+
+/** \brief Queues a datagram for the stack core, called on the application core
+ * \param p Datagram, owned by the channel if ERR_OK is returned
+ * \param addr Remote IP address
+ * \param port Remote UDP port
+ * \return ERR_OK, ERR_ARG for a PBUF_RAM pbuf without MEM_USE_POOLS, ERR_CONN if the channel
+ * is not open, ERR_MEM if the TX ring is full; the caller keeps the pbuf on an error
+ */
+err_t Ifx_LwipMc_send(Ifx_LwipMc_Channel *channel, pbuf_t *p, const ip_addr_t *addr, uint16 port)
+{
+#if !MEM_USE_POOLS
+    pbuf_t *q;
+
+    for (q = p; q != NULL; q = q->next)
+    {
+        if (q->type == PBUF_RAM)
+        {
+            return ERR_ARG;
+        }
+    }
+
+#endif
+    if (channel->state != Ifx_LwipMc_State_open)
+    {
+        return ERR_CONN;
+    }
+
+    if (!Ifx_LwipMc_push(&channel->tx, p, addr, port))
+    {
+        channel->stats.txFull++;
+        return ERR_MEM;
+    }
+
+    return ERR_OK;
+}
+
+
+/** \brief Returns the next received datagram, called on the application core
+ * \param addr Remote IP address, or NULL_PTR
+ * \param port Remote UDP port, or NULL_PTR
+ * \return The datagram, owned by the caller, NULL_PTR if none is pending
+ */
+pbuf_t *Ifx_LwipMc_receive(Ifx_LwipMc_Channel *channel, ip_addr_t *addr, uint16 *port)
+{
+    if (channel->state != Ifx_LwipMc_State_open)
+    {
+        return NULL_PTR;
+    }
+
+    return Ifx_LwipMc_pop(&channel->rx, addr, port);
+}
+
+
+/** \brief Polling the channels, called on the stack core with the polls of Ifx_Lwip.h
+ *
+ * Serves the pending open and close requests and sends up to IFX_LWIPMC_TX_BUDGET
+ * datagrams of each open channel.
+ * \return The number of datagrams passed to udp_sendto()
+ */
+uint32 Ifx_LwipMc_poll(void)
+{
+    Ifx_LwipMc *mc    = Ifx_LwipMc_get();
+    uint32      count = 0;
+    uint32      i;
+
+    if (mc->requests != mc->served)
+    {
+        Ifx_LwipMc_serveRequests(mc);
+    }
+
+    for (i = 0; i < IFX_LWIPMC_CHANNELS; i++)
+    {
+        Ifx_LwipMc_Channel *channel = &mc->channel[i];
+        uint32              budget  = IFX_LWIPMC_TX_BUDGET;
+        ip_addr_t           addr;
+        uint16              port;
+        pbuf_t             *p;
+
+        if (channel->state != Ifx_LwipMc_State_open)
+        {
+            continue;
+        }
+
+        while ((budget > 0) && ((p = Ifx_LwipMc_pop(&channel->tx, &addr, &port)) != NULL))
+        {
+            if (udp_sendto(channel->pcb, p, &addr, port) == ERR_OK)
+            {
+                channel->stats.sent++;
+            }
+            else
+            {
+                channel->stats.sendErrors++;
+            }
+
+            pbuf_free(p);
+            budget--;
+            count++;
+        }
+    }
+
+    return count;
+}
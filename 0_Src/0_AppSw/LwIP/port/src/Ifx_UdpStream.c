@@ -0,0 +1,427 @@
+/**
+ * \file Ifx_UdpStream.c
+ * \brief Burst UDP sender writing datagrams directly into the ETH TX buffers
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ * 3. The name of the author may not be used to endorse or promote products
+ *    derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ''AS IS'' AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+ * SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT
+ * OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+ * IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY
+ * OF SUCH DAMAGE.
+ *
+ * This file is part of the AURIX lwIP TCP/IP stack.
+ */
+
+#include "Ifx_UdpStream.h"
+#include "lwip/inet_chksum.h"
+#include "Stm/Std/IfxStm.h"
+
+#include <string.h>
+
+//________________________________________________________________________________________
+// PRIVATE DEFINITIONS
+
+#define IFX_UDPSTREAM_ETH_HLEN (SIZEOF_ETH_HDR - ETH_PAD_SIZE)
+
+#define Ifx_UdpStream_fold(sum)                      \
+    {                                                \
+        sum = (sum >> 16) + (sum & 0xFFFFU);         \
+        sum = (sum >> 16) + (sum & 0xFFFFU);         \
+    }
+
+//________________________________________________________________________________________
+// PRIVATE FUNCTIONS
+
+/** \brief Writes the destination MAC address into the template
+ * \return TRUE if the address is known
+ */
+static boolean Ifx_UdpStream_resolve(Ifx_UdpStream *stream)
+{
+    netif_t         *netif  = stream->config.netif;
+    ip_addr_t       *remote = &stream->config.remoteIp;
+    uint8           *dest   = &stream->header[0];
+    struct eth_addr *ethRet;
+    ip_addr_t       *ipRet;
+    ip_addr_t       *nextHop;
+
+    stream->arpIndex = -1;
+
+    if (ip_addr_isbroadcast(remote, netif))
+    {
+        memset(dest, 0xFF, ETHARP_HWADDR_LEN);
+        stream->resolved = TRUE;
+    }
+    else if (ip_addr_ismulticast(remote))
+    {
+        dest[0]          = 0x01;
+        dest[1]          = 0x00;
+        dest[2]          = 0x5E;
+        dest[3]          = ip4_addr2(remote) & 0x7F;
+        dest[4]          = ip4_addr3(remote);
+        dest[5]          = ip4_addr4(remote);
+        stream->resolved = TRUE;
+    }
+    else
+    {
+        nextHop          = ip_addr_netcmp(remote, &netif->ip_addr, &netif->netmask) ? remote : &netif->gw;
+        stream->arpIndex = etharp_find_addr(netif, nextHop, &ethRet, &ipRet);
+
+        if (stream->arpIndex >= 0)
+        {
+            memcpy(dest, ethRet->addr, ETHARP_HWADDR_LEN);
+            stream->arpVersion = etharp_cache_version;
+            stream->resolved   = TRUE;
+        }
+    }
+
+    return stream->resolved;
+}
+
+
+/** \brief Builds the header template, except the destination MAC address */
+static void Ifx_UdpStream_build(Ifx_UdpStream *stream)
+{
+    netif_t        *netif = stream->config.netif;
+    uint8          *frame = stream->header;
+    struct ip_hdr  *iphdr = (struct ip_hdr *)&frame[IFX_UDPSTREAM_ETH_HLEN];
+    struct udp_hdr *udphdr;
+
+    memcpy(&frame[ETHARP_HWADDR_LEN], netif->hwaddr, ETHARP_HWADDR_LEN);
+    frame[12] = (uint8)(ETHTYPE_IP >> 8);
+    frame[13] = (uint8)ETHTYPE_IP;
+
+    IPH_VHL_SET(iphdr, 4, IP_HLEN / 4);
+    IPH_TOS_SET(iphdr, stream->config.tos);
+    IPH_LEN_SET(iphdr, 0);
+    IPH_ID_SET(iphdr, 0);
+    IPH_OFFSET_SET(iphdr, 0);
+    IPH_TTL_SET(iphdr, stream->config.ttl);
+    IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+    IPH_CHKSUM_SET(iphdr, 0);
+    ip_addr_copy(iphdr->src, netif->ip_addr);
+    ip_addr_copy(iphdr->dest, stream->config.remoteIp);
+
+    /* length and identification are added per datagram */
+    stream->headerSum = (u16_t)~inet_chksum(iphdr, IP_HLEN);
+
+    udphdr         = (struct udp_hdr *)&frame[IFX_UDPSTREAM_ETH_HLEN + IP_HLEN];
+    udphdr->src    = htons(stream->config.localPort);
+    udphdr->dest   = htons(stream->config.remotePort);
+    udphdr->len    = 0;
+    udphdr->chksum = 0;
+}
+
+
+/** \brief Completes the datagram in the TX buffer: template, payload, length, ID and checksums */
+static uint16 Ifx_UdpStream_write(Ifx_UdpStream *stream, uint8 *frame)
+{
+    uint16          payloadSize = stream->config.payloadSize;
+    uint16          ipLength    = (uint16)(IP_HLEN + UDP_HLEN + payloadSize);
+    struct ip_hdr  *iphdr       = (struct ip_hdr *)&frame[IFX_UDPSTREAM_ETH_HLEN];
+    struct udp_hdr *udphdr      = (struct udp_hdr *)&frame[IFX_UDPSTREAM_ETH_HLEN + IP_HLEN];
+
+    memcpy(frame, stream->header, IFX_UDPSTREAM_HEADER_SIZE);
+
+    if (stream->config.fill != NULL_PTR)
+    {
+        stream->config.fill(stream->config.fillArg, &frame[IFX_UDPSTREAM_HEADER_SIZE], payloadSize, stream->sequence);
+    }
+
+    IPH_LEN_SET(iphdr, htons(ipLength));
+    IPH_ID_SET(iphdr, htons(stream->ipId));
+    udphdr->len = htons((u16_t)(UDP_HLEN + payloadSize));
+
+    /* the checksums are left to the engine if the netif offloads them */
+#if CHECKSUM_GEN_IP
+    if (NETIF_CHECKSUM_ENABLED(stream->config.netif, NETIF_CHECKSUM_GEN_IP))
+    {
+        uint32 sum = stream->headerSum + IPH_LEN(iphdr) + IPH_ID(iphdr);
+        Ifx_UdpStream_fold(sum);
+        IPH_CHKSUM_SET(iphdr, (u16_t)~sum);
+    }
+#endif
+#if CHECKSUM_GEN_UDP
+    if (NETIF_CHECKSUM_ENABLED(stream->config.netif, NETIF_CHECKSUM_GEN_UDP))
+    {
+        u16_t  chksum;
+        uint32 sum     = (ip4_addr_get_u32(&iphdr->src) & 0xFFFFU) + (ip4_addr_get_u32(&iphdr->src) >> 16);
+        sum   += (ip4_addr_get_u32(&iphdr->dest) & 0xFFFFU) + (ip4_addr_get_u32(&iphdr->dest) >> 16);
+        sum   += htons(IP_PROTO_UDP) + udphdr->len;
+        sum   += (u16_t)~inet_chksum(udphdr, (u16_t)(UDP_HLEN + payloadSize));
+        Ifx_UdpStream_fold(sum);
+        chksum = (u16_t)~sum;
+        udphdr->chksum = (chksum == 0x0000) ? 0xFFFF : chksum;
+    }
+#endif
+
+    stream->ipId++;
+    stream->sequence++;
+
+    return (uint16)(IFX_UDPSTREAM_HEADER_SIZE + payloadSize);
+}
+
+
+/** \brief Checks that the template still matches the ARP cache and the interface address */
+static void Ifx_UdpStream_check(Ifx_UdpStream *stream)
+{
+    struct ip_hdr *iphdr = (struct ip_hdr *)&stream->header[IFX_UDPSTREAM_ETH_HLEN];
+
+    if (!ip_addr_cmp(&iphdr->src, &stream->config.netif->ip_addr))
+    {
+        Ifx_UdpStream_invalidate(stream);
+    }
+    else if ((stream->arpIndex >= 0) && (stream->arpVersion != etharp_cache_version))
+    {
+        stream->resolved = FALSE;
+    }
+}
+
+
+/** \brief Sends one datagram through the stack, which resolves the destination */
+static uint32 Ifx_UdpStream_sendThroughStack(Ifx_UdpStream *stream)
+{
+    uint32  sent = 0;
+    pbuf_t *p    = pbuf_alloc(PBUF_TRANSPORT, stream->config.payloadSize, PBUF_RAM);
+
+    if (p != NULL)
+    {
+        if (stream->config.fill != NULL_PTR)
+        {
+            stream->config.fill(stream->config.fillArg, p->payload, p->len, stream->sequence);
+        }
+
+        if (udp_sendto_if(stream->pcb, p, &stream->config.remoteIp, stream->config.remotePort,
+                stream->config.netif) == ERR_OK)
+        {
+            stream->sequence++;
+            stream->stats.datagrams++;
+            stream->stats.bytes += stream->config.payloadSize;
+            stream->stats.unresolved++;
+            sent = 1;
+        }
+
+        pbuf_free(p);
+    }
+
+    return sent;
+}
+
+
+/** \brief Returns how many datagrams may be sent now */
+static uint32 Ifx_UdpStream_getCredit(Ifx_UdpStream *stream, uint32 count)
+{
+    uint64 period = stream->pacing.period;
+
+    if (period != 0)
+    {
+        uint64 now    = IfxStm_get(&MODULE_STM0);
+        uint64 window = (uint64)(stream->config.burstMax - 1) * period;
+        uint32 credit = 0;
+
+        /* credit accumulated while idle is limited to one burst */
+        if ((now > window) && (stream->pacing.next < (now - window)))
+        {
+            stream->pacing.next = now - window;
+        }
+
+        if (now >= stream->pacing.next)
+        {
+            uint64 due = ((now - stream->pacing.next) / period) + 1;
+            credit = (due < stream->config.burstMax) ? (uint32)due : stream->config.burstMax;
+        }
+
+        if (credit < count)
+        {
+            stream->stats.paced++;
+            count = credit;
+        }
+    }
+
+    return count;
+}
+
+
+//________________________________________________________________________________________
+// PUBLIC FUNCTIONS
+
+/** \brief Initialises a stream configuration with default values
+ * \param config Configuration to initialise
+ * \param netif Interface used by the stream
+ */
+void Ifx_UdpStream_initConfig(Ifx_UdpStream_Config *config, netif_t *netif)
+{
+    memset(config, 0, sizeof(*config));
+    config->netif       = netif;
+    config->payloadSize = 100;
+    config->ttl         = UDP_TTL;
+    config->burstMax    = IfxEth_getTxDescriptorCount(netif->state);
+}
+
+
+/** \brief Initialises a stream: header template, local port and pacing
+ * \param stream Stream to initialise
+ * \param config Configuration
+ * \return ERR_OK, ERR_VAL if the payload does not fit into one frame, ERR_MEM or ERR_USE if the local port can't be bound
+ */
+err_t Ifx_UdpStream_init(Ifx_UdpStream *stream, const Ifx_UdpStream_Config *config)
+{
+    err_t err = ERR_OK;
+
+    memset(stream, 0, sizeof(*stream));
+    stream->config = *config;
+
+    if (stream->config.localPort == 0)
+    {
+        stream->config.localPort = stream->config.remotePort;
+    }
+
+    if (stream->config.burstMax == 0)
+    {
+        stream->config.burstMax = 1;
+    }
+
+    if (stream->config.payloadSize > IFX_UDPSTREAM_MAX_PAYLOAD)
+    {
+        err = ERR_VAL;
+    }
+    else
+    {
+        stream->pcb = udp_new();
+
+        if (stream->pcb == NULL)
+        {
+            err = ERR_MEM;
+        }
+        else
+        {
+            stream->pcb->tos = stream->config.tos;
+            stream->pcb->ttl = stream->config.ttl;
+            err              = udp_bind(stream->pcb, IP_ADDR_ANY, stream->config.localPort);
+        }
+    }
+
+    if (err == ERR_OK)
+    {
+        Ifx_UdpStream_build(stream);
+
+        if (stream->config.datagramsPerSecond != 0)
+        {
+            stream->pacing.period = (uint64)IfxStm_getFrequency(&MODULE_STM0) / stream->config.datagramsPerSecond;
+
+            if (stream->pacing.period == 0)
+            {
+                stream->pacing.period = 1;
+            }
+
+            stream->pacing.next = IfxStm_get(&MODULE_STM0);
+        }
+    }
+    else if (stream->pcb != NULL)
+    {
+        udp_remove(stream->pcb);
+        stream->pcb = NULL;
+    }
+
+    return err;
+}
+
+
+/** \brief Releases the local port of a stream */
+void Ifx_UdpStream_deinit(Ifx_UdpStream *stream)
+{
+    if (stream->pcb != NULL)
+    {
+        udp_remove(stream->pcb);
+        stream->pcb = NULL;
+    }
+}
+
+
+/** \brief Forces the header template to be rebuilt, e.g. after an IP address or ARP change */
+void Ifx_UdpStream_invalidate(Ifx_UdpStream *stream)
+{
+    stream->resolved = FALSE;
+    Ifx_UdpStream_build(stream);
+}
+
+
+/** \brief Sends up to count datagrams
+ * \param stream Stream
+ * \param count Maximum number of datagrams
+ * \return Number of datagrams sent. Less than count if the TX ring is full, the pacing rate is
+ * reached or the destination is not resolved yet.
+ */
+uint32 Ifx_UdpStream_send(Ifx_UdpStream *stream, uint32 count)
+{
+    netif_t *netif = stream->config.netif;
+    uint32   sent  = 0;
+    uint8   *frame;
+
+    count = Ifx_UdpStream_getCredit(stream, count);
+
+    if ((count == 0) || !netif_is_up(netif))
+    {
+        return 0;
+    }
+
+    Ifx_UdpStream_check(stream);
+
+    if ((stream->resolved == FALSE) && (Ifx_UdpStream_resolve(stream) == FALSE))
+    {
+        sent = Ifx_UdpStream_sendThroughStack(stream);
+    }
+    else
+    {
+        if (stream->arpIndex >= 0)
+        {
+            /* keeps the ARP entry refreshed as etharp_output() would */
+            etharp_use_entry(netif, stream->arpIndex);
+        }
+
+        while (sent < count)
+        {
+            frame = ethernetif_tc2x_getTxBuffer(netif);
+
+            if (frame == NULL)
+            {
+                /* the last frames may have been queued without poll demand */
+                IfxEth_wakeupTransmitter(netif->state);
+                frame = ethernetif_tc2x_getTxBuffer(netif);
+
+                if (frame == NULL)
+                {
+                    stream->stats.ringFull++;
+                    break;
+                }
+            }
+
+            ethernetif_tc2x_sendTxBuffer(netif, Ifx_UdpStream_write(stream, frame), (u8_t)((sent + 1) < count));
+            sent++;
+        }
+
+        stream->stats.datagrams += sent;
+        stream->stats.bytes     += (uint64)sent * stream->config.payloadSize;
+    }
+
+    stream->pacing.next += sent * stream->pacing.period;
+
+    return sent;
+}
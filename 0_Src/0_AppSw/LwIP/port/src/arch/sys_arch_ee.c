@@ -291,6 +291,7 @@ void sys_arch_unprotect(sys_prot_t pval)
  */
 
 #include "Comm/Ifx_Console.h"
+#include "Ifx_Lwip.h"
 
 void xsys_assert(const char *msg)
 {
@@ -323,12 +324,10 @@ void sys_debug(const char *const fmt, ...)
 }
 
 
-extern u32_t Core0_Stm_1ms;
-
-/** Returns the current time in milliseconds */
+/** Returns the current time in milliseconds, counted on the STM by Ifx_Lwip_now() */
 u32_t sys_now(void)
 {
-    return Core0_Stm_1ms;
+    return Ifx_Lwip_now();
 }
 
 
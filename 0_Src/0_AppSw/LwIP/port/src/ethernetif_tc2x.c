@@ -51,12 +51,18 @@
 
 #include "lwip/def.h"
 #include "lwip/mem.h"
+#include "lwip/memp.h"
 #include "lwip/pbuf.h"
 #include "lwip/sys.h"
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
 #include "netif/ppp_oe.h"
+#if LWIP_TCP_GSO
+#include "lwip/ip.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/tcp_impl.h"
+#endif
 
 #include "Ifx_Lwip.h"
 #include "ethernetif_tc2x.h"
@@ -74,8 +80,12 @@
 #define PBUF_CLAIM_PAD(p)
 #endif
 
-#define IFX_LWIP_ZERO_COPY_BUFFERS (4)
-#define IFX_LWIP_ZERO_COPY_TX      (IFXETH_TX_BUFFER_BY_USER)
+/* TX is zero-copy unless the buffer configuration is changed here: DMA-readable pbufs are
+ * chained into the descriptors and released once the DMA is done. Frames which the DMA
+ * can't read are copied into the buffer of their descriptor (IfxEth_Config::txBuffer). */
+#ifndef IFX_LWIP_ZERO_COPY_TX
+#define IFX_LWIP_ZERO_COPY_TX      (1)
+#endif
 #define IFX_LWIP_ZERO_COPY_RX      (IFXETH_RX_BUFFER_BY_USER)
 
 /* This function is used to get the low-level driver */
@@ -84,18 +94,21 @@ IfxEth *IfxEth_get(void);
 /* Reference to a global low-level driver configuration */
 extern const IfxEth_Config cfg_Eth;
 
+/* Driver configuration used by the next ethernetif_tc2x_init(), cfg_Eth unless overridden */
+static const IfxEth_Config *ethernetif_tc2x_config = &cfg_Eth;
+
 struct
 {
-#if IFX_LWIP_ZERO_COPY_TX
-    u32_t   tbuf[IFX_LWIP_ZERO_COPY_BUFFERS][IFXETH_RTX_BUFFER_SIZE / 4];
-    u32_t   tidx;
-    u32_t   chainedCount;
-    u32_t   zeroCopyCount;
-    pbuf_t *pbuf;
-#endif
+    pbuf_t **tpbuf;                       /* per TX descriptor: pbuf referenced by the last descriptor of a frame */
+    u16_t   tcount;                       /* number of TX descriptors */
+    u16_t   tidx;                         /* next descriptor to fill, follows eth->pTxDescr */
+    u16_t   treclaim;                     /* oldest descriptor given to the DMA */
+    u16_t   tbusy;                        /* descriptors given to the DMA and not reclaimed yet */
+    struct ethernetif_tc2x_txstats txstats;
 #if IFX_LWIP_ZERO_COPY_RX
-    pbuf_t *rpbuf[IFXETH_MAX_RX_BUFFERS];
+    pbuf_t **rpbuf;                       /* per RX descriptor: pbuf holding its buffer */
 #endif
+    struct ethernetif_tc2x_rxstats rxstats;
     IfxEth *eth;
 } ethernetif_tc2x;
 
@@ -129,13 +142,33 @@ static void low_level_init(netif_t *netif)
 
     /* Do whatever else is needed to initialize interface. */
     {
-        IfxEth_Config config = cfg_Eth;
+        IfxEth_Config config = *ethernetif_tc2x_config;
         memcpy(config.macAddress, netif->hwaddr, 6);
         IfxEth_init(eth, &config);
 
+        /* the rings are sized at run time, so are the tables of the pbufs held by the descriptors */
+        ethernetif_tc2x.tcount = IfxEth_getTxDescriptorCount(eth);
+        ethernetif_tc2x.tpbuf  = (pbuf_t **)mem_malloc((mem_size_t)(ethernetif_tc2x.tcount * sizeof(pbuf_t *)));
+
+        if (ethernetif_tc2x.tpbuf == NULL)
+        {
+            __debug();
+            ethernetif_tc2x.tcount = 0;
+        }
+        else
+        {
+            memset(ethernetif_tc2x.tpbuf, 0, ethernetif_tc2x.tcount * sizeof(pbuf_t *));
+        }
+
 #if IFX_LWIP_ZERO_COPY_RX
+        ethernetif_tc2x.rpbuf = (pbuf_t **)mem_malloc((mem_size_t)(IfxEth_getRxDescriptorCount(eth) * sizeof(pbuf_t *)));
 
-        for (i = 0; i < IFXETH_MAX_RX_BUFFERS; i++)
+        if (ethernetif_tc2x.rpbuf == NULL)
+        {
+            __debug();
+        }
+
+        for (i = 0; (ethernetif_tc2x.rpbuf != NULL) && (i < IfxEth_getRxDescriptorCount(eth)); i++)
         {
             /* Pre-allocate a pbuf from the pool in order to support zero-copy receive.
              * We need to allocate at the maximum size as we don't know the size of the
@@ -168,11 +201,23 @@ static void low_level_init(netif_t *netif)
             __debug();
         }
 #endif
+        ethernetif_tc2x.tidx     = 0;
+        ethernetif_tc2x.treclaim = 0;
+        ethernetif_tc2x.tbusy    = 0;
 #if IFX_LWIP_ZERO_COPY_TX
-        ethernetif_tc2x.tidx = 0;
+        /* a frame sent in place takes a descriptor per pbuf */
+        netif->tx_descs = ethernetif_tc2x.tcount;
+#endif
+#if LWIP_TCP_GSO
+        /* a frame cut from a TCP super-segment takes one descriptor when copied, tcp_output()
+         * bounds the descriptors of a super-segment sent in place by netif->tx_descs */
+        netif->gso_max_size = 0xFFFF;
+        netif->gso_max_segs = (u8_t)LWIP_MIN(ethernetif_tc2x.tcount, 0xFF);
 #endif
 #if LWIP_USE_HW_CHECKSUM_ENGINE
+        /* the engine inserts and checks all IP, ICMP, TCP and UDP checksums of this netif */
         IfxEth_setupChecksumEngine(eth, IfxEth_ChecksumMode_tcpUdpIcmpFull);
+        NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_DISABLE_ALL);
 #endif
         IfxEth_startTransmitter(eth);
         IfxEth_startReceiver(eth);
@@ -181,137 +226,660 @@ static void low_level_init(netif_t *netif)
 
 
 /**
- * This function should do the actual transmission of the packet. The packet is
- * contained in the pbuf that is passed to the function. This pbuf
- * might be chained.
+ * Checks whether the DMA may read the pbuf chain in place until it is released.
  *
- * @param netif the lwip network interface structure for this ethernetif
- * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
- * @return ERR_OK if the packet could be sent
- *         an err_t value if the packet couldn't be sent
+ * Plain PBUF_REF payloads may change once the caller returns (see etharp_query()),
+ * only custom PBUF_REF pbufs (e.g. IP fragments) keep their data alive. Empty
+ * segments are not given to the DMA.
  *
- * @note Returning ERR_MEM here if a DMA queue of your MAC is full can lead to
- *       strange results. You might consider waiting for space in the DMA queue
- *       to become availale since the stack doesn't retry to send a packet
- *       dropped because of memory failure (except for the TCP timers).
+ * @param p the MAC packet to send
+ * @param n number of pbufs in the chain
+ * @return TRUE if the frame can be sent without copying
  */
-static err_t low_level_output(netif_t *netif, pbuf_t *p)
+static boolean ethernetif_tc2x_isZeroCopy(pbuf_t *p, u16_t n)
 {
-    IfxEth *eth = netif->state;
+    boolean zeroCopy = IFX_LWIP_ZERO_COPY_TX && (n <= ethernetif_tc2x.tcount);
     pbuf_t *q;
 
-    u16_t   length = p->tot_len;
-    LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output (p=%#x)\n", p));
+    for (q = p; (q != NULL) && zeroCopy; q = q->next)
+    {
+        zeroCopy = IfxEth_isDmaAddress(q->payload) && (q->len != 0)
+                   && ((q->type != PBUF_REF) || ((q->flags & PBUF_FLAG_IS_CUSTOM) != 0));
+    }
+
+    return zeroCopy;
+}
 
-    PBUF_DROP_PAD(p);
 
-    //initiate transfer();
+/**
+ * Returns the TX descriptor index n descriptors after idx, n not above the ring size.
+ */
+static u16_t ethernetif_tc2x_advance(u16_t idx, u16_t n)
+{
+    idx = (u16_t)(idx + n);
 
-#if !IFX_LWIP_ZERO_COPY_TX
-    //if ((p->type == PBUF_REF) || (p->type == PBUF_ROM))
+    return (idx >= ethernetif_tc2x.tcount) ? (u16_t)(idx - ethernetif_tc2x.tcount) : idx;
+}
+
+
+/**
+ * Releases the pbufs of the frames the DMA has finished with.
+ *
+ * Called before each transmission and from the receive poll, the ETH TX interrupt
+ * only counts completions. Must not be called from an interrupt.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @return number of descriptors reclaimed
+ */
+u16_t ethernetif_tc2x_reclaim(struct netif *netif)
+{
+    IfxEth         *eth   = netif->state;
+    IfxEth_TxDescr *base  = IfxEth_getBaseTxDescriptor(eth);
+    u16_t           count = 0;
+
+    while (ethernetif_tc2x.tbusy > 0)
     {
-        u8_t *tbuf = (u8_t *)IfxEth_waitTransmitBuffer(eth);
-        u16_t l    = 0;
+        u16_t idx = ethernetif_tc2x.treclaim;
+
+        if (IfxEth_TxDescr_isAvailable(&base[idx]) == FALSE)
+        {
+            break;
+        }
 
-        for (q = p; q != NULL; q = q->next)
+        if (ethernetif_tc2x.tpbuf[idx] != NULL)
         {
-            /* Send the data from the pbuf to the interface, one pbuf at a
-             * time. The size of the data in each pbuf is kept in the ->len
-             * variable. */
-            memcpy(&tbuf[l], q->payload, q->len);
-            l = l + q->len;
-            LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output: data=%#x, %d\n", q->payload, q->len));
-            LWIP_ASSERT("low_level_output: length overflow the buffer\n", (l < IFXETH_RTX_BUFFER_SIZE));
+            pbuf_free(ethernetif_tc2x.tpbuf[idx]);
+            ethernetif_tc2x.tpbuf[idx] = NULL;
         }
 
-        IfxEth_sendTransmitBuffer(eth, l);
+        ethernetif_tc2x.treclaim = ethernetif_tc2x_advance(idx, 1);
+        ethernetif_tc2x.tbusy--;
+        count++;
     }
 
-#else
+    return count;
+}
 
-    LWIP_ASSERT("low_level_output: total length overflow the buffer\n", (p->tot_len < IFXETH_RTX_BUFFER_SIZE));
 
-    boolean dmaSafe = TRUE;
+/**
+ * Advances the TX ring over the descriptors of one frame, which have already
+ * been released to the DMA.
+ *
+ * @param eth the low-level driver
+ * @param n number of descriptors used by the frame
+ * @param wakeup FALSE to defer the transmit poll demand to a later frame of a burst
+ */
+static void ethernetif_tc2x_commit(IfxEth *eth, u16_t n, boolean wakeup)
+{
+    u16_t i;
+
+    ethernetif_tc2x.tidx   = ethernetif_tc2x_advance(ethernetif_tc2x.tidx, n);
+    ethernetif_tc2x.tbusy += n;
 
-    for (q = p; q != NULL; q = q->next)
+    for (i = 0; i < n; i++)
     {
-        //uint32 segment = (0xF0000000U & (uint32)q->payload);
-        //dmaSafe = dmaSafe && ((segment != 0xA0000000U) && (segment != 0x80000000U));
-        dmaSafe = dmaSafe && ((0x80000000U & (uint32)q->payload) == 0);
+        IfxEth_shuffleTxDescriptor(eth);
+    }
+
+    eth->txCount++;
 
-        if (!dmaSafe)
+    if (wakeup)
+    {
+        IfxEth_wakeupTransmitter(eth);
+    }
+
+    LINK_STATS_INC(link.xmit);
+}
+
+
+/**
+ * Returns the buffer of the next free TX descriptor, so that a frame can be
+ * written in place (see Ifx_UdpStream). The buffer holds IFXETH_RTX_BUFFER_SIZE
+ * bytes and starts with the Ethernet header.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @return the buffer, or NULL if the TX ring is full
+ */
+u8_t *ethernetif_tc2x_getTxBuffer(struct netif *netif)
+{
+    u8_t *buffer = NULL;
+
+    if ((ethernetif_tc2x.tbusy < ethernetif_tc2x.tcount) || (ethernetif_tc2x_reclaim(netif) > 0))
+    {
+        buffer = IfxEth_getTxBufferByIndex(netif->state, ethernetif_tc2x.tidx);
+    }
+
+    return buffer;
+}
+
+
+/**
+ * Sends the frame written into the buffer returned by ethernetif_tc2x_getTxBuffer().
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param length frame length, starting with the Ethernet header
+ * @param more non zero if further frames follow immediately: the transmit poll
+ *        demand is then left to the last frame of the burst
+ * @return ERR_OK, or ERR_WOULDBLOCK if no buffer was reserved
+ */
+err_t ethernetif_tc2x_sendTxBuffer(struct netif *netif, u16_t length, u8_t more)
+{
+    IfxEth         *eth = netif->state;
+    u16_t           idx = ethernetif_tc2x.tidx;
+    IfxEth_TxDescr *descr;
+    err_t           err = ERR_OK;
+
+    if (ethernetif_tc2x.tbusy >= ethernetif_tc2x.tcount)
+    {
+        ethernetif_tc2x.txstats.ring_full++;
+        err = ERR_WOULDBLOCK;
+    }
+    else
+    {
+        descr = &IfxEth_getBaseTxDescriptor(eth)[idx];
+        IfxEth_TxDescr_setBuffer(descr, IfxEth_getTxBufferByIndex(eth, idx));
+        IfxEth_TxDescr_setup(descr, length, TRUE, TRUE);
+        IfxEth_TxDescr_release(descr);
+        ethernetif_tc2x.txstats.copied++;
+        ethernetif_tc2x_commit(eth, 1, (more == 0));
+    }
+
+    return err;
+}
+
+
+#if LWIP_TCP_GSO
+/**
+ * Counts the pbufs holding the next len bytes of a chain and checks that the DMA may read
+ * all of them in place.
+ *
+ * @param q pbuf holding the first byte
+ * @param off offset of the first byte in q
+ * @param len number of bytes, not more than left in the chain
+ * @param zeroCopy set to FALSE if one of the pbufs can't be sent in place
+ * @return number of pbufs
+ */
+static u16_t ethernetif_tc2x_countSlices(pbuf_t *q, u16_t off, u16_t len, boolean *zeroCopy)
+{
+    u16_t n = 0;
+
+    *zeroCopy = IFX_LWIP_ZERO_COPY_TX;
+
+    while (len > 0)
+    {
+        u16_t take = (u16_t)LWIP_MIN(len, q->len - off);
+
+        if (take > 0)
         {
-            break;
+            *zeroCopy = *zeroCopy && IfxEth_isDmaAddress((u8_t *)q->payload + off)
+                        && ((q->type != PBUF_REF) || ((q->flags & PBUF_FLAG_IS_CUSTOM) != 0));
+            len -= take;
+            n++;
+        }
+
+        q   = q->next;
+        off = 0;
+    }
+
+    return n;
+}
+
+
+/**
+ * Sends a TCP super-segment (PBUF_FLAG_GSO) as the frames of its segments.
+ *
+ * The headers of a frame are copied from those of the super-segment into the buffer of its
+ * first descriptor, then the IP length and ID, the sequence number and the PSH and FIN
+ * flags are patched. The data follows in place through one descriptor per pbuf, or copied
+ * behind the headers when the DMA can't read it or when the free descriptors would not
+ * leave one for each of the following frames: all frames are queued or none. Checksums
+ * which the engine does not insert are updated from the ones of the headers, only the
+ * data is summed per frame.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param p the super-segment, p->payload points to its Ethernet header
+ * @return ERR_OK if all frames are queued
+ *         ERR_WOULDBLOCK if the TX ring has fewer free descriptors than frames, none is queued
+ *         ERR_BUF if a frame does not fit into a TX buffer, none is queued
+ */
+static err_t ethernetif_tc2x_outputGso(netif_t *netif, pbuf_t *p)
+{
+    IfxEth          *eth       = netif->state;
+    IfxEth_TxDescr  *base      = IfxEth_getBaseTxDescriptor(eth);
+    struct pbuf_gso *gso       = (struct pbuf_gso *)p;
+    u8_t            *tmpl      = p->payload;
+    struct ip_hdr   *iphdr     = (struct ip_hdr *)&tmpl[SIZEOF_ETH_HDR - ETH_PAD_SIZE];
+    struct tcp_hdr  *tcphdr    = (struct tcp_hdr *)((u8_t *)iphdr + IPH_HL(iphdr) * 4);
+    u16_t            tcphlen   = (u16_t)(TCPH_HDRLEN(tcphdr) * 4);
+    u16_t            hlen      = (u16_t)((u8_t *)tcphdr - tmpl + tcphlen);
+    u32_t            left      = (u32_t)(p->tot_len - hlen);
+    u16_t            frames    = (u16_t)LWIP_MIN(gso->gso_segs, (left + gso->gso_size - 1) / gso->gso_size);
+    u32_t            seqno     = ntohl(tcphdr->seqno);
+    u16_t            id        = ntohs(IPH_ID(iphdr));
+    boolean          ipChksum  = NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_IP);
+    boolean          tcpChksum = NETIF_CHECKSUM_ENABLED(netif, NETIF_CHECKSUM_GEN_TCP);
+    u16_t            tcpsum    = 0;
+    sint32           hold      = -1;
+    pbuf_t          *q         = p->next;
+    u16_t            qoff      = 0;
+    u16_t            i;
+
+    if ((p->len != hlen) || ((hlen + gso->gso_size) > IFXETH_RTX_BUFFER_SIZE))
+    {
+        LINK_STATS_INC(link.lenerr);
+        return ERR_BUF;
+    }
+
+    if (frames > (ethernetif_tc2x.tcount - ethernetif_tc2x.tbusy))
+    {
+        ethernetif_tc2x.txstats.ring_full++;
+        LINK_STATS_INC(link.drop);
+        return ERR_WOULDBLOCK;
+    }
+
+    if (tcpChksum)
+    {
+        /* checksum of the TCP header of the super-segment and the pseudo header without length */
+        u32_t acc = (u16_t)~inet_chksum(tcphdr, tcphlen);
+        u32_t src = ip4_addr_get_u32(&iphdr->src);
+        u32_t dst = ip4_addr_get_u32(&iphdr->dest);
+
+        acc   += (src & 0xFFFFUL) + (src >> 16) + (dst & 0xFFFFUL) + (dst >> 16) + PP_HTONS(IP_PROTO_TCP);
+        acc    = FOLD_U32T(acc);
+        acc    = FOLD_U32T(acc);
+        tcpsum = (u16_t)~acc;
+    }
+
+    for (i = 0; (i < gso->gso_segs) && (left > 0); i++)
+    {
+        u16_t           len     = (u16_t)LWIP_MIN(left, gso->gso_size);
+        u16_t           idx     = ethernetif_tc2x.tidx;
+        u8_t           *frame   = IfxEth_getTxBufferByIndex(eth, idx);
+        struct ip_hdr  *fip     = (struct ip_hdr *)&frame[SIZEOF_ETH_HDR - ETH_PAD_SIZE];
+        struct tcp_hdr *ftcp    = (struct tcp_hdr *)((u8_t *)fip + ((u8_t *)tcphdr - (u8_t *)iphdr));
+        u16_t           pos     = hlen;
+        u16_t           n       = 1;
+        u16_t           d       = 1;
+        u32_t           acc     = 0;
+        boolean         swapped = FALSE;
+        boolean         zeroCopy;
+
+        n += ethernetif_tc2x_countSlices(q, qoff, len, &zeroCopy);
+
+        /* in place if one descriptor is left for each following frame, else copied */
+        if ((zeroCopy == FALSE) || (n > (ethernetif_tc2x.tcount - ethernetif_tc2x.tbusy - (frames - 1 - i))))
+        {
+            zeroCopy = FALSE;
+            n        = 1;
+        }
+
+        /* headers of the segment */
+        MEMCPY(frame, tmpl, hlen);
+        IPH_LEN_SET(fip, htons((u16_t)(hlen - (SIZEOF_ETH_HDR - ETH_PAD_SIZE) + len)));
+        IPH_ID_SET(fip, htons((u16_t)(id + i)));
+        ftcp->seqno = htonl(seqno);
+
+        if (left > len)
+        {
+            ftcp->_hdrlen_rsvd_flags &= PP_HTONS(~(TCP_PSH | TCP_FIN) & 0xFFFFU);
+        }
+
+        /* data: one descriptor per pbuf, or copied behind the headers */
+        while (pos < (hlen + len))
+        {
+            u8_t *data = (u8_t *)q->payload + qoff;
+            u16_t take = (u16_t)LWIP_MIN(hlen + len - pos, q->len - qoff);
+
+            if (take > 0)
+            {
+                if (zeroCopy)
+                {
+                    IfxEth_TxDescr *descr = &base[ethernetif_tc2x_advance(idx, d)];
+
+                    IfxEth_TxDescr_setBuffer(descr, data);
+                    IfxEth_TxDescr_setup(descr, take, FALSE, (pos + take) == (hlen + len));
+                    d++;
+                }
+                else
+                {
+                    MEMCPY(&frame[pos], data, take);
+                }
+
+                if (tcpChksum)
+                {
+                    acc += (u16_t)~inet_chksum(data, take);
+                    acc  = FOLD_U32T(acc);
+
+                    if ((take & 1) != 0)
+                    {
+                        swapped = !swapped;
+                        acc     = SWAP_BYTES_IN_WORD(acc);
+                    }
+                }
+
+                pos  += take;
+                qoff += take;
+            }
+
+            if (qoff == q->len)
+            {
+                q    = q->next;
+                qoff = 0;
+            }
+        }
+
+        if (ipChksum)
+        {
+            u16_t chksum = IPH_CHKSUM(iphdr);
+
+            chksum = inet_chksum_adjust(chksum, IPH_LEN(iphdr), IPH_LEN(fip));
+            chksum = inet_chksum_adjust(chksum, IPH_ID(iphdr), IPH_ID(fip));
+            IPH_CHKSUM_SET(fip, chksum);
+        }
+
+        if (tcpChksum)
+        {
+            u16_t chksum = tcpsum;
+
+            if (swapped)
+            {
+                acc = SWAP_BYTES_IN_WORD(acc);
+            }
+
+            chksum       = inet_chksum_adjust(chksum, (u16_t)tcphdr->seqno, (u16_t)ftcp->seqno);
+            chksum       = inet_chksum_adjust(chksum, (u16_t)(tcphdr->seqno >> 16), (u16_t)(ftcp->seqno >> 16));
+            chksum       = inet_chksum_adjust(chksum, tcphdr->_hdrlen_rsvd_flags, ftcp->_hdrlen_rsvd_flags);
+            chksum       = inet_chksum_adjust(chksum, 0, htons((u16_t)(tcphlen + len)));
+            chksum       = inet_chksum_adjust(chksum, 0, (u16_t)acc);
+            ftcp->chksum = chksum;
+        }
+
+        /* hand the descriptors to the DMA, the first one last */
+        IfxEth_TxDescr_setBuffer(&base[idx], frame);
+
+        if (zeroCopy)
+        {
+            IfxEth_TxDescr_setup(&base[idx], hlen, TRUE, FALSE);
+
+            for (d = 1; d < n; d++)
+            {
+                IfxEth_TxDescr_release(&base[ethernetif_tc2x_advance(idx, d)]);
+            }
+
+            hold = ethernetif_tc2x_advance(idx, (u16_t)(n - 1));
+            ethernetif_tc2x.txstats.zero_copy++;
         }
+        else
+        {
+            IfxEth_TxDescr_setup(&base[idx], (u16_t)(hlen + len), TRUE, TRUE);
+            ethernetif_tc2x.txstats.copied++;
+        }
+
+        __dsync();
+        IfxEth_TxDescr_release(&base[idx]);
+        ethernetif_tc2x.txstats.gso++;
+        ethernetif_tc2x_commit(eth, n, FALSE);
+
+        seqno += len;
+        left  -= len;
     }
 
-    if (!dmaSafe)
+    if (hold >= 0)
     {
-        u16_t l = 0;
+        /* keep the super-segment until the last frame sent from its pbufs is done */
+        pbuf_ref(p);
+        ethernetif_tc2x.tpbuf[hold] = p;
+    }
+
+    if (i > 0)
+    {
+        IfxEth_wakeupTransmitter(eth);
+    }
 
-        ethernetif_tc2x.pbuf = p;
-        ethernetif_tc2x.chainedCount++;
+    return ERR_OK;
+}
 
-        IfxEth_TxDescr *descr = IfxEth_getActualTxDescriptor(eth);
-        while (IfxEth_TxDescr_isAvailable(descr) == FALSE)
-        {}
 
-        /* Since DMA can't access the payload address, we have to copy
-         * into a special TX buffer */
-        u32_t tidx = ethernetif_tc2x.tidx;
-        u8_t *tbuf = (u8_t *)&(ethernetif_tc2x.tbuf[tidx][0]);
-        ethernetif_tc2x.tidx = (tidx + 1) % IFX_LWIP_ZERO_COPY_BUFFERS;
+#endif
+/**
+ * This function should do the actual transmission of the packet. The packet is
+ * contained in the pbuf that is passed to the function. This pbuf
+ * might be chained.
+ *
+ * The frame is queued on the TX ring and the function returns without waiting
+ * for the DMA. A pbuf sent in place is referenced (pbuf_ref()) and released by
+ * ethernetif_tc2x_reclaim() once the DMA has cleared the OWN bits. A frame marked
+ * PBUF_FLAG_TX_COPY, or whose chain needs more descriptors than are free, is copied
+ * into the buffer of a single descriptor.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
+ * @return ERR_OK if the packet is queued for transmission
+ *         ERR_WOULDBLOCK if the TX ring has not enough free descriptors
+ *         ERR_BUF if the packet does not fit into a TX buffer
+ */
+static err_t low_level_output(netif_t *netif, pbuf_t *p)
+{
+    IfxEth         *eth  = netif->state;
+    IfxEth_TxDescr *base = IfxEth_getBaseTxDescriptor(eth);
+    err_t           err  = ERR_OK;
+    pbuf_t         *q;
+    u16_t           n, idx, i;
+    boolean         zeroCopy;
 
-        for (q = p; q != NULL; q = q->next)
+    LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output (p=%#x)\n", p));
+
+    ethernetif_tc2x_reclaim(netif);
+
+    PBUF_DROP_PAD(p);
+
+#if LWIP_TCP_GSO
+
+    if ((p->flags & PBUF_FLAG_GSO) != 0)
+    {
+        err = ethernetif_tc2x_outputGso(netif, p);
+        PBUF_CLAIM_PAD(p);
+
+        return err;
+    }
+
+#endif
+    n        = pbuf_clen(p);
+    zeroCopy = ((p->flags & PBUF_FLAG_TX_COPY) == 0) && ethernetif_tc2x_isZeroCopy(p, n);
+    idx      = ethernetif_tc2x.tidx;
+
+    if ((zeroCopy != FALSE) && (n > (ethernetif_tc2x.tcount - ethernetif_tc2x.tbusy))
+        && (p->tot_len <= IFXETH_RTX_BUFFER_SIZE))
+    {   /* too few descriptors to send the chain in place, one is enough for a copy */
+        zeroCopy = FALSE;
+    }
+
+    if (zeroCopy == FALSE)
+    {
+        n = 1;
+    }
+
+    if (n > (ethernetif_tc2x.tcount - ethernetif_tc2x.tbusy))
+    {
+        ethernetif_tc2x.txstats.ring_full++;
+        LINK_STATS_INC(link.drop);
+        err = ERR_WOULDBLOCK;
+    }
+    else if (zeroCopy == FALSE)
+    {
+        IfxEth_TxDescr *descr = &base[idx];
+        u8_t           *tbuf  = IfxEth_getTxBufferByIndex(eth, idx);
+
+        if (p->tot_len > IFXETH_RTX_BUFFER_SIZE)
         {
-            memcpy(&tbuf[l], q->payload, q->len);
-            l = l + q->len;
-            LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output: data=%#x, %d\n", q->payload, q->len));
+            LINK_STATS_INC(link.lenerr);
+            err = ERR_BUF;
         }
+        else
+        {
+            /* Since DMA can't access the payload in place, we have to copy
+             * into the buffer of the descriptor */
+            pbuf_copy_partial(p, tbuf, p->tot_len, 0);
 
-        IfxEth_TxDescr_setBuffer(IfxEth_getActualTxDescriptor(eth), tbuf);
-        IfxEth_sendTransmitBuffer(eth, l);
+            IfxEth_TxDescr_setBuffer(descr, tbuf);
+            IfxEth_TxDescr_setup(descr, p->tot_len, TRUE, TRUE);
+            IfxEth_TxDescr_release(descr);
+            ethernetif_tc2x.txstats.copied++;
+        }
     }
     else
     {
-        u8_t            n     = 0;
-        ethernetif_tc2x.zeroCopyCount++;
-
-        IfxEth_TxDescr *descr = IfxEth_getActualTxDescriptor(eth);
+        IfxEth_TxDescr *first = &base[idx];
 
-        for (q = p; q != NULL; q = q->next)
+        for (q = p, i = idx; q != NULL; q = q->next)
         {
-            while (IfxEth_TxDescr_isAvailable(descr) == FALSE)
-            {}
+            IfxEth_TxDescr *descr = &base[i];
 
             IfxEth_TxDescr_setBuffer(descr, q->payload);
-            IfxEth_TxDescr_setup(descr, q->len, (n == 0), (q->next == NULL));
-            descr = &descr[1];
-            n++;
+            IfxEth_TxDescr_setup(descr, q->len, (descr == first), (q->next == NULL));
+
+            if (q->next == NULL)
+            {
+                /* keep the whole chain until the last segment is sent */
+                pbuf_ref(p);
+                ethernetif_tc2x.tpbuf[i] = p;
+            }
+
+            i = ethernetif_tc2x_advance(i, 1);
+        }
+
+        /* hand the segments to the DMA, the first one last so the frame is never seen partially */
+        for (i = ethernetif_tc2x_advance(idx, 1); i != ethernetif_tc2x_advance(idx, n); i = ethernetif_tc2x_advance(i, 1))
+        {
+            IfxEth_TxDescr_release(&base[i]);
         }
 
-        descr = IfxEth_getActualTxDescriptor(eth);
+        __dsync();
+        IfxEth_TxDescr_release(first);
+        ethernetif_tc2x.txstats.zero_copy++;
+    }
+
+    if (err == ERR_OK)
+    {
+        ethernetif_tc2x_commit(eth, n, TRUE);
+    }
 
-        for ( ; n > 0; n--)
+    PBUF_CLAIM_PAD(p);
+
+    LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output: return %d\n", err));
+
+    return err;
+}
+
+
+#if IFX_LWIP_RX_COPYBREAK
+/**
+ * Returns a small pbuf to MEMP_PBUF_SMALL, called by pbuf_free().
+ */
+static void ethernetif_tc2x_freeSmall(pbuf_t *p)
+{
+    memp_free(MEMP_PBUF_SMALL, p);
+}
+
+
+#endif
+/**
+ * Records the length class of a received frame and copies frames up to
+ * IFX_LWIP_RX_COPYBREAK bytes into a small pbuf. The DMA buffer is released to its
+ * descriptor right away, so small frames never hold a PBUF_POOL buffer. A small frame
+ * with a checksum error is dropped without being copied.
+ *
+ * @param frame set to the pbuf of a copied frame, NULL for a dropped frame
+ * @return 1 if the frame was copied or dropped, 0 to receive it into a PBUF_POOL pbuf
+ */
+static u8_t ethernetif_tc2x_copyBreak(IfxEth *eth, u16_t len, pbuf_t **frame)
+{
+    pbuf_t *p    = NULL;
+    u8_t    done = 0;
+    u16_t   size = 0;
+
+    while ((size < (ETHERNETIF_TC2X_RX_SIZE_CLASSES - 1)) && (len > (64U << size)))
+    {
+        size++;
+    }
+
+    ethernetif_tc2x.rxstats.sizes[size]++;
+
+#if IFX_LWIP_RX_COPYBREAK
+
+    if (len <= IFX_LWIP_RX_COPYBREAK)
+    {
+        struct pbuf_custom *pc = (struct pbuf_custom *)memp_malloc(MEMP_PBUF_SMALL);
+
+        if ((pc != NULL) && (IfxEth_isRxChecksumError(eth) != FALSE))
         {
-            IfxEth_TxDescr_release(descr);
-            IfxEth_shuffleTxDescriptor(eth);
+            memp_free(MEMP_PBUF_SMALL, pc);
+
+            //acknowledge that packet has been read();
+            IfxEth_freeReceiveBuffer(eth);
+            done = 1;
         }
+        else if (pc != NULL)
+        {
+            pc->custom_free_function = ethernetif_tc2x_freeSmall;
 
-        IfxEth_wakeupTransmitter(eth);
+            /* PBUF_POOL: the stack may move the header, pbuf_realloc() must not mem_trim() it */
+            p = pbuf_alloced_custom(PBUF_RAW, (u16_t)(len + ETH_PAD_SIZE), PBUF_POOL, pc,
+                (u8_t *)pc + LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf_custom)),
+                LWIP_MEM_ALIGN_SIZE(IFX_LWIP_RX_COPYBREAK + ETH_PAD_SIZE));
+
+            PBUF_DROP_PAD(p);
+            memcpy(p->payload, IfxEth_getReceiveBuffer(eth), len);
+            PBUF_CLAIM_PAD(p);
+
+            //acknowledge that packet has been read();
+            IfxEth_freeReceiveBuffer(eth);
+
+            ethernetif_tc2x.rxstats.copybreak++;
+            LINK_STATS_INC(link.recv);
+            done = 1;
+        }
+        else
+        {
+            ethernetif_tc2x.rxstats.small_empty++;
+        }
     }
 
+#else
+    (void)eth;
 #endif
 
-    LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output: signal length: %d\n", length));
+    *frame = p;
 
-    PBUF_CLAIM_PAD(p);
+    return done;
+}
 
-    LINK_STATS_INC(link.xmit);
 
-    LWIP_DEBUGF(NETIF_DEBUG | LWIP_DBG_TRACE, ("low_level_output: return OK\n"));
+/**
+ * Returns the receive statistics of the interface.
+ */
+struct ethernetif_tc2x_rxstats *ethernetif_tc2x_getRxStats(void)
+{
+    return &ethernetif_tc2x.rxstats;
+}
 
-    return ERR_OK;
+
+/**
+ * Returns the transmit statistics of the interface.
+ */
+struct ethernetif_tc2x_txstats *ethernetif_tc2x_getTxStats(void)
+{
+    return &ethernetif_tc2x.txstats;
+}
+
+
+/**
+ * Returns the TX descriptors which are neither queued nor waiting to be reclaimed, by the
+ * index of this driver (IfxEth_getTransmitBuffer() reads the index of the iLLD driver).
+ */
+u16_t ethernetif_tc2x_getTxFree(void)
+{
+    return (u16_t)(ethernetif_tc2x.tcount - ethernetif_tc2x.tbusy);
 }
 
 
@@ -321,7 +889,7 @@ static err_t low_level_output(netif_t *netif, pbuf_t *p)
  *
  * @param netif the lwip network interface structure for this ethernetif
  * @return a pbuf filled with the received packet (including MAC header)
- *         NULL on memory error
+ *         NULL if the ring is empty or the frame was dropped
  */
 static pbuf_t *low_level_input(netif_t *netif)
 {
@@ -335,6 +903,9 @@ static pbuf_t *low_level_input(netif_t *netif)
     {   /* no reception */
         p = (pbuf_t *)0;
     }
+    else if (ethernetif_tc2x_copyBreak(eth, len, &p) != 0)
+    {   /* small frame copied or dropped, the DMA buffer stays in its descriptor */
+    }
     else
     {
 #if !IFX_LWIP_ZERO_COPY_RX
@@ -419,8 +990,9 @@ static pbuf_t *low_level_input(netif_t *netif)
 #endif
         else
         {
-            //TODO: drop packet();
-            __debug();
+            /* drop the frame, the frames behind it are still read */
+            IfxEth_freeReceiveBuffer(eth);
+            ethernetif_tc2x.rxstats.pool_empty++;
             LINK_STATS_INC(link.memerr);
             LINK_STATS_INC(link.drop);
         }
@@ -438,23 +1010,26 @@ static pbuf_t *low_level_input(netif_t *netif)
  * the appropriate input function is called.
  *
  * @param netif the lwip network interface structure for this ethernetif
+ * @return ERR_OK if a frame was passed to the stack, ERR_TIMEOUT if the ring is
+ *         empty, ERR_BUF if a frame was dropped (checksum error or no pbuf)
  */
 err_t ethernetif_tc2x_input(netif_t *netif)
 {
-    //IfxEth *eth = netif->state;
+    IfxEth    *eth = netif->state;
     err_t      err = ERR_OK;
     eth_hdr_t *ethhdr;
-    pbuf_t    *p;
-
-    /* move received packet into a new pbuf */
-    p = low_level_input(netif);
+    pbuf_t    *p   = NULL;
 
-    /* no packet could be read, silently ignore this */
-    if (p == NULL)
+    if (IfxEth_isRxDataAvailable(eth) == FALSE)
     {
-        //LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: p == NULL!\n"));
         err = ERR_TIMEOUT;
     }
+    /* move received packet into a new pbuf */
+    else if ((p = low_level_input(netif)) == NULL)
+    {
+        LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: frame dropped\n"));
+        err = ERR_BUF;
+    }
     else
     {
         /* points to packet payload, which starts with an Ethernet header */
@@ -491,6 +1066,19 @@ err_t ethernetif_tc2x_input(netif_t *netif)
 }
 
 
+/**
+ * Selects the driver configuration used by the next ethernetif_tc2x_init(), for example
+ * to provide descriptor rings of another depth or in another memory region. The
+ * configuration must stay valid until then; the MAC address is taken from the netif.
+ *
+ * @param config the driver configuration, NULL to restore cfg_Eth
+ */
+void ethernetif_tc2x_setConfig(const IfxEth_Config *config)
+{
+    ethernetif_tc2x_config = (config != NULL) ? config : &cfg_Eth;
+}
+
+
 /**
  * Should be called at the beginning of the program to set up the
  * network interface. It calls the function low_level_init() to do the
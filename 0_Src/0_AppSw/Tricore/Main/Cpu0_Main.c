@@ -28,6 +28,7 @@
 #include "Cpu0_Main.h"
 #include "SysSe/Bsp/Bsp.h"
 #include "Ifx_Lwip.h"
+#include "Ifx_UdpStream.h"
 #include "IfxPort_PinMap.h"
 #include "IfxPort_Io.h"
 #include "IfxPort_cfg.h"
@@ -38,9 +39,6 @@ void gIfxEth_initTransmitDescriptors(void);
 void gIfxEth_startTransmitter(void);
 void gIfxEth_init(void);
 
-
-#define TRANSPORT_HEADERS_SIZE (PBUF_LINK_HLEN + PBUF_IP_HLEN + PBUF_TRANSPORT_HLEN)
-
 const IfxPort_Io_ConfigPin	 configPin[] = {
 		{&IfxPort_P33_6,  IfxPort_Mode_outputPushPullGeneral, IfxPort_PadDriver_cmosAutomotiveSpeed1},              // P00.0
 		{&IfxPort_P33_7,  IfxPort_Mode_outputPushPullGeneral, IfxPort_PadDriver_cmosAutomotiveSpeed1},              // P00.0
@@ -73,26 +71,114 @@ const IfxPort_Io_Config conf = {
 /*------------------------------Global variables------------------------------*/
 /******************************************************************************/
 App_Cpu0 g_AppCpu0; /**< \brief CPU 0 global data */
+Ifx_UdpStream g_UdpStream; /**< \brief Test stream to 192.168.7.6:5001 */
 
 /******************************************************************************/
 /*-------------------------Function Implementations---------------------------*/
 /******************************************************************************/
 
+/** \brief Writes the datagram sequence number at the start of the payload */
+static void core0_fillPayload(void *arg, uint8 *payload, uint16 length, uint32 sequence)
+{
+    (void)arg;
+
+    if (length >= sizeof(sequence))
+    {
+        payload[0] = (uint8)(sequence >> 24);
+        payload[1] = (uint8)(sequence >> 16);
+        payload[2] = (uint8)(sequence >> 8);
+        payload[3] = (uint8)sequence;
+    }
+}
+
+
+/** \brief Initialises lwIP and the test stream, on the core which runs lwIP */
+void App_initNetwork(void)
+{
+    Ifx_UdpStream_Config streamConfig;
+    Ifx_Lwip_Config      config;
+    Ifx_Lwip_ArpEntry    streamPeer;
+
+    IP4_ADDR(&config.ipAddr, 192, 168, 7, 123);
+    IP4_ADDR(&config.netMask, 255, 255, 255, 0);
+    IP4_ADDR(&config.gateway, 192, 168, 7, 6);
+    MAC_ADDR(&config.ethAddr, 0x00, 0x20, 0x30, 0x40, 0x50, 0x60);
+    /* resolve the receiver of the stream at init, not with its first datagram */
+    IP4_ADDR(&streamPeer.ipAddr, 192, 168, 7, 6);
+    MAC_ADDR(&streamPeer.ethAddr, 0, 0, 0, 0, 0, 0);
+    config.arpEntries    = &streamPeer;
+    config.arpEntryCount = 1;
+
+    Ifx_Lwip_init(&config);
+
+    Ifx_UdpStream_initConfig(&streamConfig, &Ifx_g_Lwip.netif);
+    IP4_ADDR(&streamConfig.remoteIp, 192, 168, 7, 6);
+    streamConfig.remotePort  = 5001;
+    streamConfig.payloadSize = 100;
+    streamConfig.fill        = &core0_fillPayload;
+    Ifx_UdpStream_init(&g_UdpStream, &streamConfig);
+
+    IfxPort_setPinHigh(&MODULE_P33, 6); // P33.0 = 0
+    g_AppCpu0.network.phyLink = Ifx_g_Eth.config.phyLink();
+    g_AppCpu0.network.ethRam  = FALSE;
+}
+
+
+/** \brief Polls lwIP, the PHY link and the test stream, on the core which runs lwIP
+ *
+ * The PHY is accessed by this core only, the other cores read the status from g_AppCpu0.network.
+ */
+void App_pollNetwork(void)
+{
+    AppNetwork *network = &g_AppCpu0.network;
+    uint32      link;
+
+    Ifx_Lwip_pollTimerFlags();
+    Ifx_Lwip_pollReceiveFlags();
+
+    link = Ifx_g_Eth.config.phyLink();
+
+    if (link != network->phyLink)
+    {
+        if (link == 1)
+        {
+            IfxPort_setPinLow(&MODULE_P33, 6);
+            netif_set_up(&Ifx_g_Lwip.netif);
+            IfxEth_startTransmitter(Ifx_g_Lwip.netif.state);
+        }
+        else
+        {
+            netif_set_down(&Ifx_g_Lwip.netif);
+            IfxPort_setPinHigh(&MODULE_P33, 6);
+        }
+
+        network->phyLink = link;
+    }
+
+    network->mdioState = IfxEth_Phy_Pef7071_MIIState();
+    network->ethRam    = (ethernetif_tc2x_getTxFree() != 0) ? TRUE : FALSE;
+
+    if ((link == 1) && (Ifx_UdpStream_send(&g_UdpStream, IfxEth_getTxDescriptorCount(&Ifx_g_Eth)) != 0))
+    {
+        IfxPort_setPinLow(&MODULE_P33, 8); // P33.0 = 0
+    }
+    else
+    {
+        IfxPort_setPinHigh(&MODULE_P33, 8); // P33.0 = 0
+    }
+}
+
+
 /** \brief Main entry point after CPU boot-up.
  *
  *  It initialise the system and enter the endless loop that handles the demo
  */
 volatile uint32 stat;
-volatile void *ethRam;
 volatile struct stat_report report;
 
 int core0_main(void)
 {
-    udp_pcb_t * udp;
-    ip_addr_t addr;
-    pbuf_t *p = (void*)0;//(pbuf_t *)pbuf_alloc_special(MEMP_PBUF);
     uint16 idx;
-    uint16 total;
 
     /*
      * !!WATCHDOG0 AND SAFETY WATCHDOG ARE DISABLED HERE!!
@@ -117,6 +203,7 @@ int core0_main(void)
     	IfxPort_setPinHigh(tbl->pin->port, tbl->pin->pinIndex); // P33.0 = 0
     }
 
+    /* the STM0 interrupts are routed to ISR_PROVIDER_STM_0 */
     initStm0();
 
     /* Enable the global interrupts of this CPU */
@@ -125,51 +212,23 @@ int core0_main(void)
     /* Demo init */
     wMultican_init();
 
-    Ifx_Lwip_Config config;
-
-    IP4_ADDR(&config.ipAddr, 192, 168, 7, 123);
-    IP4_ADDR(&config.netMask, 255, 255, 255, 0);
-    IP4_ADDR(&config.gateway, 192, 168, 7, 6);
-    MAC_ADDR(&config.ethAddr, 0x00, 0x20, 0x30, 0x40, 0x50, 0x60);
-
-    Ifx_Lwip_init(&config);
-
-    addr.addr8[3] = 6;
-    addr.addr8[2] = 7;
-    addr.addr8[1] = 168;
-    addr.addr8[0] = 192;
+#if IFX_LWIP_MULTICORE
+    /* lwIP is initialised and polled by CPU1 */
+    g_AppCpu0.network.start = TRUE;
+#else
+    App_initNetwork();
+#endif
 
     /* background endless loop */
-    IfxPort_setPinHigh(&MODULE_P33, 6); // P33.0 = 0
-    total = Ifx_g_Eth.config.phyLink();
-    if (total == 1) {
-    	report.phy_link = 1;
-    } else {
-    	report.phy_link = 0;
-    }
-    ethRam = NULL_PTR;
-
-    udp = udp_new();
     while (TRUE)
     {
-        Ifx_Lwip_pollTimerFlags();
-        Ifx_Lwip_pollReceiveFlags();
-
-        if (total != Ifx_g_Eth.config.phyLink()) {
-        	total = Ifx_g_Eth.config.phyLink();
-        	if (total == 1) {
-    			IfxPort_setPinLow(&MODULE_P33, 6);
-    			netif_set_up(&Ifx_g_Lwip.netif);
-    			IfxEth_startTransmitter(Ifx_g_Lwip.netif.state);
-    		} else {
-    			netif_set_down(&Ifx_g_Lwip.netif);
-    			IfxPort_setPinHigh(&MODULE_P33, 6);
-    		}
-        }
+#if !IFX_LWIP_MULTICORE
+        App_pollNetwork();
+#endif
 
-        report.phy_link = total;
-        report.mdio_stat = IfxEth_Phy_Pef7071_MIIState();
-        report.ethRam = ethRam!=NULL?1:0;
+        report.phy_link = g_AppCpu0.network.phyLink;
+        report.mdio_stat = g_AppCpu0.network.mdioState;
+        report.ethRam = g_AppCpu0.network.ethRam;
 
         wMultiCanNode0Demo_run(report, 0);
 
@@ -178,25 +237,9 @@ int core0_main(void)
         } else {
             IfxPort_setPinHigh(&MODULE_P33, 7);
         }
-       	if (Ifx_g_Eth.config.phyLink() && (ethRam = IfxEth_getTransmitBuffer(&Ifx_g_Eth))) {
-			p = (pbuf_t *)memp_malloc(MEMP_PBUF);
-			if (p != NULL) {
-				p->payload = LWIP_MEM_ALIGN((void *)((u8_t *)ethRam));
-				p->len = 100;
-				p->tot_len = p->len;
-				p->next = NULL;
-				p->ref = 1;
-				p->type = PBUF_REF;
-				udp_sendto_if(udp, p, &addr, 5001, &Ifx_g_Lwip.netif);
-				pbuf_free(p);
-				IfxPort_setPinLow(&MODULE_P33, 8); // P33.0 = 0
-			}
-        } else {
-			IfxPort_setPinHigh(&MODULE_P33, 8); // P33.0 = 0
-        }
         REGRESSION_RUN_STOP_PASS;
     }
-	udp_remove(udp);
+    Ifx_UdpStream_deinit(&g_UdpStream);
 
     return 0;
 }
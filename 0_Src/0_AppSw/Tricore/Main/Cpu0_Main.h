@@ -51,10 +51,20 @@ typedef struct
     float32 stmFreq;                /**< \brief Actual STM frequency */
 } AppInfo;
 
+/** \brief Network status, written by the core which runs lwIP (CPU1 with IFX_LWIP_MULTICORE) */
+typedef struct
+{
+    volatile boolean start;                     /**< \brief Set by CPU0 after the board initialisation, CPU1 then initialises lwIP */
+    volatile uint32  phyLink;                   /**< \brief Link state of the PHY */
+    volatile uint16  mdioState;                 /**< \brief MII state of the PHY */
+    volatile boolean ethRam;                    /**< \brief A TX buffer was free at the last poll */
+} AppNetwork;
+
 /** \brief Application information */
 typedef struct
 {
-    AppInfo info;                               /**< \brief Info object */
+    AppInfo    info;                            /**< \brief Info object */
+    AppNetwork network;                         /**< \brief Network status */
 } App_Cpu0;
 
 /******************************************************************************/
@@ -63,4 +73,11 @@ typedef struct
 
 IFX_EXTERN App_Cpu0 g_AppCpu0;
 
+/******************************************************************************/
+/*-------------------------Global Function Prototypes-------------------------*/
+/******************************************************************************/
+
+IFX_EXTERN void App_initNetwork(void);
+IFX_EXTERN void App_pollNetwork(void);
+
 #endif
@@ -26,6 +26,7 @@
 /******************************************************************************/
 
 #include "Cpu0_Main.h"
+#include "Ifx_LwipMc.h"
 
 /** \brief Main entry point for CPU1  */
 void core1_main(void)
@@ -36,7 +37,21 @@ void core1_main(void)
      * */
     IfxScuWdt_disableCpuWatchdog(IfxScuWdt_getCpuWatchdogPassword());
 
+#if IFX_LWIP_MULTICORE
+    /** - lwIP runs on this core once CPU0 initialised the board, it takes the ETH and STM0 interrupts */
+    while (g_AppCpu0.network.start == FALSE)
+    {}
+
+    IfxCpu_enableInterrupts();
+    App_initNetwork();
+#endif
+
     /** - Background loop */
     while (TRUE)
-    {}
+    {
+#if IFX_LWIP_MULTICORE
+        App_pollNetwork();
+        Ifx_LwipMc_poll();
+#endif
+    }
 }
@@ -26,6 +26,10 @@
 /******************************************************************************/
 
 #include "Cpu0_Main.h"
+#include "Ifx_LwipMc.h"
+
+/** \brief UDP port of the echo service of CPU2 */
+#define CPU2_ECHO_PORT (7)
 
 /** \brief Main entry point for CPU1 */
 void core2_main(void)
@@ -36,7 +40,28 @@ void core2_main(void)
      * */
     IfxScuWdt_disableCpuWatchdog(IfxScuWdt_getCpuWatchdogPassword());
 
+#if IFX_LWIP_MULTICORE
+    /** - Echo service, the datagrams are exchanged with lwIP on CPU1 */
+    Ifx_LwipMc_Channel *echo;
+
+    while (g_AppCpu0.network.start == FALSE)
+    {}
+
+    echo = Ifx_LwipMc_open(CPU2_ECHO_PORT);
+#endif
+
     /** - Background loop */
     while (TRUE)
-    {}
+    {
+#if IFX_LWIP_MULTICORE
+        ip_addr_t addr;
+        uint16    port;
+        pbuf_t   *p = (echo != NULL_PTR) ? Ifx_LwipMc_receive(echo, &addr, &port) : NULL_PTR;
+
+        if ((p != NULL_PTR) && (Ifx_LwipMc_send(echo, p, &addr, port) != ERR_OK))
+        {
+            pbuf_free(p);
+        }
+#endif
+    }
 }
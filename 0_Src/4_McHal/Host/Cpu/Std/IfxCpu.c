@@ -0,0 +1,88 @@
+/**
+ * \file IfxCpu.c
+ * \brief Host (Linux) model of the CPU driver
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ */
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "IfxCpu.h"
+
+/******************************************************************************/
+/*------------------------Private Variables/Constants-------------------------*/
+/******************************************************************************/
+
+static uint32 IfxCpu_Host_debugCount = 0;
+
+/******************************************************************************/
+/*------------------------------Global variables------------------------------*/
+/******************************************************************************/
+
+__thread IfxCpu_Id IfxCpu_Host_coreId = IfxCpu_Id_0;
+
+/******************************************************************************/
+/*-------------------------Function Implementations---------------------------*/
+/******************************************************************************/
+
+void IfxCpu_Host_debug(void)
+{
+    IfxCpu_Host_debugCount++;
+}
+
+
+uint32 IfxCpu_Host_getDebugCount(void)
+{
+    return IfxCpu_Host_debugCount;
+}
+
+
+boolean IfxCpu_setSpinLock(IfxCpu_spinLock *lock, uint32 timeoutCount)
+{
+    boolean retVal = FALSE;
+
+    do
+    {
+        uint32 expected = 0;
+
+        if (__atomic_compare_exchange_n(lock, &expected, 1U, FALSE, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+        {
+            retVal = TRUE;
+        }
+        else
+        {
+            timeoutCount--;
+        }
+    } while ((retVal == FALSE) && (timeoutCount > 0));
+
+    return retVal;
+}
+
+
+void IfxCpu_resetSpinLock(IfxCpu_spinLock *lock)
+{
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+
+void IfxCpu_Host_setCoreId(IfxCpu_Id id)
+{
+    IfxCpu_Host_coreId = id;
+}
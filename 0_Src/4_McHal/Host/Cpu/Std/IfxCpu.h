@@ -0,0 +1,112 @@
+/**
+ * \file IfxCpu.h
+ * \brief Host (Linux) model of the CPU driver
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ */
+
+#ifndef IFXCPU_H
+#define IFXCPU_H 1
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "Cpu/Std/Ifx_Types.h"
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+/** \brief Convert a local DSPR address to a global one. The host has a flat address space. */
+#define IFXCPU_GLB_ADDR_DSPR(cpu, address) (address)
+
+/******************************************************************************/
+/*--------------------------------Enumerations--------------------------------*/
+/******************************************************************************/
+
+typedef enum
+{
+    IfxCpu_Id_0 = 0,
+    IfxCpu_Id_1 = 1,
+    IfxCpu_Id_2 = 2,
+    IfxCpu_Id_none
+} IfxCpu_Id;
+
+/******************************************************************************/
+/*-----------------------------Data Structures--------------------------------*/
+/******************************************************************************/
+
+/** \brief Spin lock shared between cores, 0 when free */
+typedef uint32 IfxCpu_spinLock;
+
+/******************************************************************************/
+/*------------------------------Global variables------------------------------*/
+/******************************************************************************/
+
+/** \brief Core the calling thread stands for, see IfxCpu_Host_setCoreId() */
+IFX_EXTERN __thread IfxCpu_Id IfxCpu_Host_coreId;
+
+/******************************************************************************/
+/*-------------------------Global Function Prototypes-------------------------*/
+/******************************************************************************/
+
+/** \brief Acquires the spin lock, trying up to timeoutCount times
+ * \return TRUE if the lock was acquired
+ */
+IFX_EXTERN boolean IfxCpu_setSpinLock(IfxCpu_spinLock *lock, uint32 timeoutCount);
+
+/** \brief Releases the spin lock */
+IFX_EXTERN void IfxCpu_resetSpinLock(IfxCpu_spinLock *lock);
+
+/** \brief Lets the calling thread stand for another core, e.g. CPU1 in a threaded model
+ * \param id core returned by IfxCpu_getCoreId() in this thread
+ */
+IFX_EXTERN void IfxCpu_Host_setCoreId(IfxCpu_Id id);
+
+/******************************************************************************/
+/*---------------------Inline Function Implementations------------------------*/
+/******************************************************************************/
+
+/** \brief Returns the core ID of the caller, CPU0 unless the thread changed it */
+IFX_INLINE IfxCpu_Id IfxCpu_getCoreId(void)
+{
+    return IfxCpu_Host_coreId;
+}
+
+
+IFX_INLINE void IfxCpu_enableInterrupts(void)
+{
+    __enable();
+}
+
+
+IFX_INLINE boolean IfxCpu_disableInterrupts(void)
+{
+    __disable();
+    return TRUE;
+}
+
+
+IFX_INLINE void IfxCpu_restoreInterrupts(boolean enabled)
+{
+    (void)enabled;
+}
+
+
+#endif /* IFXCPU_H */
@@ -0,0 +1,76 @@
+/**
+ * \file IfxCpu_Intrinsics.h
+ * \brief Host (Linux) replacements of the TriCore compiler intrinsics
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * Only the intrinsics used by the lwIP port are provided. Interrupt service
+ * routines of the host model are called synchronously by the simulation, so
+ * locking interrupts is a no-op.
+ */
+
+#ifndef IFXCPU_INTRINSICS_H
+#define IFXCPU_INTRINSICS_H
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+/** \brief Debug instruction. A breakpoint can be placed on IfxCpu_Host_debug() */
+#define __debug()   IfxCpu_Host_debug()
+
+#define __disable() ((void)0)
+
+#define __enable()  ((void)0)
+
+#define __nop()     ((void)0)
+
+#define __dsync()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define __isync()   __atomic_thread_fence(__ATOMIC_SEQ_CST)
+
+#define __min(a, b) (((a) < (b)) ? (a) : (b))
+
+#define __max(a, b) (((a) > (b)) ? (a) : (b))
+
+/******************************************************************************/
+/*---------------------Inline Function Implementations------------------------*/
+/******************************************************************************/
+
+/** \brief Atomically exchange the 32 bit value at place with value
+ * \param place address of the value
+ * \param value new value
+ * \return previous value
+ */
+IFX_INLINE uint32 __swap(void *place, uint32 value)
+{
+    return __atomic_exchange_n((uint32 *)place, value, __ATOMIC_SEQ_CST);
+}
+
+
+/******************************************************************************/
+/*-------------------------Global Function Prototypes-------------------------*/
+/******************************************************************************/
+
+/** \brief Counts the calls of the debug intrinsic */
+IFX_EXTERN void IfxCpu_Host_debug(void);
+
+/** \brief Returns how often the debug intrinsic was hit since start-up */
+IFX_EXTERN uint32 IfxCpu_Host_getDebugCount(void);
+
+#endif /* IFXCPU_INTRINSICS_H */
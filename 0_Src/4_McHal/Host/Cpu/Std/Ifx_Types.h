@@ -0,0 +1,88 @@
+/**
+ * \file Ifx_Types.h
+ * \brief Base type definitions for the host (Linux) build
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * The TriCore Platform_Types.h maps uint32 on "unsigned long", which is 64 bit
+ * on an LP64 host. This file provides the same type names with their TriCore
+ * widths so that lwIP and the port layer compile unchanged.
+ */
+
+#ifndef IFX_TYPES_H
+#define IFX_TYPES_H 1
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+#define IFX_INLINE                          static inline
+#define IFX_EXTERN                          extern
+#define IFX_INTERRUPT(isr, vectabNum, prio) void isr(void)
+
+#ifndef NULL_PTR
+#define NULL_PTR                            ((void *)0)
+#endif
+
+#ifndef TRUE
+#define TRUE                                1
+#endif
+
+#ifndef FALSE
+#define FALSE                               0
+#endif
+
+#define TIME_INFINITE                       ((Ifx_TickTime)0x7FFFFFFFFFFFFFFFLL)
+#define TIME_NULL                           ((Ifx_TickTime)0x0000000000000000LL)
+
+#define IFX_SIZET_MAX                       (0x7FFF)
+
+/******************************************************************************/
+/*------------------------------Type Definitions------------------------------*/
+/******************************************************************************/
+
+typedef int8_t    sint8;                /**< \brief        -128 .. +127            */
+typedef uint8_t   uint8;                /**< \brief           0 .. 255             */
+typedef int16_t   sint16;               /**< \brief      -32768 .. +32767          */
+typedef uint16_t  uint16;               /**< \brief           0 .. 65535           */
+typedef int32_t   sint32;               /**< \brief -2147483648 .. +2147483647     */
+typedef uint32_t  uint32;               /**< \brief           0 .. 4294967295      */
+typedef int64_t   sint64;
+typedef uint64_t  uint64;
+typedef float     float32;
+typedef double    float64;
+typedef uint8     boolean;              /**< \brief for use with TRUE/FALSE */
+
+typedef const char *pchar;              /**< \brief const char pointer */
+typedef void       *pvoid;              /**< \brief void pointer */
+typedef sint64      Ifx_TickTime;       /**< \brief Time in ticks */
+typedef sint16      Ifx_SizeT;          /**< \brief Type used for data stream size */
+typedef uint16      Ifx_Priority;       /**< \brief Used in interrupt service priorities */
+typedef uint32      Ifx_TimerValue;     /**< \brief Used in timer values */
+typedef pvoid       Ifx_AddressValue;   /**< \brief Used in address values */
+
+#include "IfxCpu_Intrinsics.h"
+
+#endif /* IFX_TYPES_H */
@@ -0,0 +1,706 @@
+/**
+ * \file IfxEth.c
+ * \brief Host (Linux) model of the ETH basic functionality
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ */
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "IfxEth.h"
+
+#include <string.h>
+
+/******************************************************************************/
+/*-----------------------Exported Variables/Constants-------------------------*/
+/******************************************************************************/
+
+Ifx_ETH            MODULE_ETH;
+
+#if IFXETH_DEFAULT_RINGS
+uint8              IfxEth_rxBuffer[IFXETH_MAX_RX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
+
+IfxEth_RxDescrList IfxEth_rxDescr;
+
+uint8              IfxEth_txBuffer[IFXETH_MAX_TX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
+
+IfxEth_TxDescrList IfxEth_txDescr;
+#endif
+
+/******************************************************************************/
+/*-------------------------Private Function Prototypes------------------------*/
+/******************************************************************************/
+
+/** \brief Calls the interrupt service routine if the status has an enabled request pending */
+static void IfxEth_Host_raiseInterrupt(IfxEth *eth);
+
+/** \brief Delivers one frame to the wire hook or to the TX queue */
+static void IfxEth_Host_putOnWire(IfxEth *eth, const uint8 *frame, uint16 length);
+
+/** \brief Inserts the checksums selected by the CIC field of the first TX descriptor */
+static void IfxEth_Host_insertChecksum(uint8 *frame, uint16 length, IfxEth_ChecksumMode mode);
+
+/** \brief Adds data as big endian 16 bit words to a ones complement sum */
+static uint32 IfxEth_Host_sum(const uint8 *data, uint32 length, uint32 sum);
+
+/******************************************************************************/
+/*-------------------------Function Implementations---------------------------*/
+/******************************************************************************/
+
+void IfxEth_enableModule(void)
+{}
+
+
+void IfxEth_freeReceiveBuffer(IfxEth *eth)
+{
+    IfxEth_RxDescr *descr = IfxEth_getActualRxDescriptor(eth);
+    IfxEth_RxDescr_release(descr);
+    IfxEth_shuffleRxDescriptor(eth);
+}
+
+
+void *IfxEth_getReceiveBuffer(IfxEth *eth)
+{
+    void           *result = 0;
+    IfxEth_RxDescr *descr;
+
+    if (IfxEth_isRxDataAvailable(eth))
+    {
+        eth->rxCount++;
+        descr  = IfxEth_getActualRxDescriptor(eth);
+        result = (void *)(descr->RDES2.U);
+    }
+
+    IfxEth_wakeupReceiver(eth);
+
+    return result;
+}
+
+
+void *IfxEth_getTransmitBuffer(IfxEth *eth)
+{
+    void           *buffer = NULL_PTR;
+    IfxEth_TxDescr *descr  = IfxEth_getActualTxDescriptor(eth);
+
+    // check descriptor / buffer is free.
+    if (IfxEth_TxDescr_isAvailable(descr))
+    {
+        buffer = ((void *)descr->TDES2.U);
+    }
+
+    return buffer;
+}
+
+
+void IfxEth_init(IfxEth *eth, const IfxEth_Config *config)
+{
+    Ifx_ETH *ethSfr = (config->ethSfr != NULL_PTR) ? config->ethSfr : &MODULE_ETH;
+
+    memset(ethSfr, 0, sizeof(*ethSfr));
+    ethSfr->txAutoProcess = TRUE;
+
+    eth->ethSfr           = ethSfr;
+    eth->config           = *config;
+    eth->error            = 0;
+    eth->status           = 0;
+    eth->rxCount          = 0;
+    eth->txCount          = 0;
+    eth->isrRxCount       = 0;
+    eth->isrTxCount       = 0;
+    eth->isrCount         = 0;
+
+    IfxEth_setMacAddress(eth, config->macAddress);
+
+    /* enable tx & rx interrupts */
+    ethSfr->INTERRUPT_ENABLE = (config->isrPriority != 0) ? (IFXETH_HOST_STATUS_TI | IFXETH_HOST_STATUS_RI) : 0;
+
+    if (config->phyInit != NULL_PTR)
+    {
+        config->phyInit();
+    }
+
+    IfxEth_stopTransmitter(eth);
+
+    eth->rxDescr      = IfxEth_getDmaAlias(config->rxDescr);
+    eth->txDescr      = IfxEth_getDmaAlias(config->txDescr);
+    eth->rxBuffer     = IfxEth_getDmaAlias(config->rxBuffer);
+    eth->txBuffer     = IfxEth_getDmaAlias(config->txBuffer);
+    eth->rxDescrCount = config->rxDescrCount;
+    eth->txDescrCount = config->txDescrCount;
+
+    if ((eth->rxDescrCount < 2) || (eth->txDescrCount < 2))
+    {
+        __debug();
+    }
+
+    IfxEth_initReceiveDescriptors(eth);
+    IfxEth_initTransmitDescriptors(eth);
+}
+
+
+void IfxEth_initConfig(IfxEth_Config *config, Ifx_ETH *ethSfr)
+{
+    memset(config, 0, sizeof(*config));
+    config->macAddress[1]    = 0x11;
+    config->macAddress[2]    = 0x22;
+    config->macAddress[3]    = 0x33;
+    config->macAddress[4]    = 0x44;
+    config->macAddress[5]    = 0x55;
+    config->phyInterfaceMode = IfxEth_PhyInterfaceMode_rmii;
+    config->ethSfr           = ethSfr;
+#if IFXETH_DEFAULT_RINGS
+    config->rxDescr          = IfxEth_rxDescr.items;
+    config->txDescr          = IfxEth_txDescr.items;
+    config->rxBuffer         = &IfxEth_rxBuffer[0][0];
+    config->txBuffer         = &IfxEth_txBuffer[0][0];
+    config->rxDescrCount     = IFXETH_MAX_RX_BUFFERS;
+    config->txDescrCount     = IFXETH_MAX_TX_BUFFERS;
+#endif
+}
+
+
+void IfxEth_initReceiveDescriptors(IfxEth *eth)
+{
+    int             i;
+    IfxEth_RxDescr *descr = IfxEth_getBaseRxDescriptor(eth);
+
+    eth->pRxDescr = descr;
+
+    /* init descriptor chained mode */
+    for (i = 0; i < eth->rxDescrCount; i++)
+    {
+        descr->RDES0.U      = 0;
+        descr->RDES0.A.OWN  = 1U;
+
+        descr->RDES1.U      = 0;
+        descr->RDES1.A.RCH  = 1U;
+        descr->RDES1.A.RBS1 = (IFXETH_RTX_BUFFER_SIZE);
+
+#if !IFXETH_RX_BUFFER_BY_USER
+        IfxEth_RxDescr_setBuffer(descr, &eth->rxBuffer[i * IFXETH_RTX_BUFFER_SIZE]);
+#endif
+
+        /* with RCH set, link to next descriptor address */
+        descr->RDES3.U = (uintptr_t)&(descr[1]);
+        descr          = &descr[1];
+    }
+
+    /* correction for last descriptor */
+    {
+        descr = &descr[-1];
+
+        /* indicate end of ring */
+        descr->RDES1.A.RER = 1U;
+
+        /* with RCH set, link to first descriptor address */
+        eth->pRxDescr  = IfxEth_getBaseRxDescriptor(eth);
+        descr->RDES3.U = (uintptr_t)eth->pRxDescr;
+    }
+
+    eth->rxCount = 0;
+
+    /* write descriptor list base address */
+    eth->ethSfr->rxDmaDescr = IfxEth_getBaseRxDescriptor(eth);
+}
+
+
+void IfxEth_initTransmitDescriptors(IfxEth *eth)
+{
+    int             i;
+    IfxEth_TxDescr *descr = IfxEth_getBaseTxDescriptor(eth);
+
+    eth->pTxDescr = descr;
+
+    /* Initialize chained descriptor mode */
+    for (i = 0; i < eth->txDescrCount; i++)
+    {
+        descr->TDES0.U     = 0;
+        descr->TDES0.A.IC  = 1U;
+        descr->TDES0.A.FS  = 1U;
+        descr->TDES0.A.LS  = 1U;
+        descr->TDES0.A.TCH = 1U;
+
+#if !IFXETH_TX_BUFFER_BY_USER
+        IfxEth_TxDescr_setBuffer(descr, IfxEth_getTxBufferByIndex(eth, i));
+#endif
+
+        /* with TCH set, TDES3 points to next descriptor */
+        descr->TDES3.U = (uintptr_t)&descr[1];
+        descr          = &descr[1];
+    }
+
+    /* correction for last descriptor */
+    {
+        descr = &descr[-1];
+
+        /* indicate end of ring */
+        descr->TDES0.A.TER = 1U;
+
+        /* with TCH set, TDES3 points to the first descriptor */
+        eth->pTxDescr  = IfxEth_getBaseTxDescriptor(eth);
+        descr->TDES3.U = (uintptr_t)eth->pTxDescr;
+    }
+
+    eth->txCount = 0;
+
+    /* write descriptor list base address */
+    eth->ethSfr->txDmaDescr = IfxEth_getBaseTxDescriptor(eth);
+}
+
+
+void IfxEth_readMacAddress(IfxEth *eth, uint8 *macAddress)
+{
+    memcpy(macAddress, eth->ethSfr->macAddress, 6);
+}
+
+
+void IfxEth_sendTransmitBuffer(IfxEth *eth, uint16 len)
+{
+    IfxEth_TxDescr *descr = IfxEth_getActualTxDescriptor(eth);
+
+    descr->TDES1.U = len;          /* with TCH set, TBS1 is used for buffer size */
+    IfxEth_TxDescr_release(descr); /* release to DMA */
+
+    IfxEth_shuffleTxDescriptor(eth);
+    IfxEth_wakeupTransmitter(eth);
+
+    eth->txCount++;
+}
+
+
+void IfxEth_setAndSendTransmitBuffer(IfxEth *eth, void *buffer, uint16 len)
+{
+    IfxEth_TxDescr_setBuffer(IfxEth_getActualTxDescriptor(eth), buffer);
+    IfxEth_sendTransmitBuffer(eth, len);
+}
+
+
+void IfxEth_setMacAddress(IfxEth *eth, const uint8 *macAddress)
+{
+    memcpy(eth->ethSfr->macAddress, macAddress, 6);
+}
+
+
+void IfxEth_setupChecksumEngine(IfxEth *eth, IfxEth_ChecksumMode mode)
+{
+    int i;
+
+    eth->ethSfr->checksumMode = mode;
+
+    if (mode != IfxEth_ChecksumMode_bypass)
+    {
+        IfxEth_TxDescr *descr = IfxEth_getBaseTxDescriptor(eth);
+
+        for (i = 0; i < eth->txDescrCount; i++)
+        {
+            descr->TDES0.A.CIC = mode;
+            descr              = IfxEth_TxDescr_getNext(descr);
+        }
+    }
+}
+
+
+void IfxEth_startReceiver(IfxEth *eth)
+{
+    eth->ethSfr->rxRunning = TRUE;
+}
+
+
+void IfxEth_startTransmitter(IfxEth *eth)
+{
+    eth->ethSfr->txRunning = TRUE;
+
+    if (eth->ethSfr->txAutoProcess != FALSE)
+    {
+        IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+    }
+}
+
+
+void IfxEth_stopTransmitter(IfxEth *eth)
+{
+    eth->ethSfr->txRunning = FALSE;
+}
+
+
+void IfxEth_wakeupReceiver(IfxEth *eth)
+{
+    eth->status = eth->ethSfr->STATUS;
+
+    // check if receiver suspended
+    if (eth->status & IFXETH_HOST_STATUS_RU)
+    {
+        eth->ethSfr->STATUS &= ~IFXETH_HOST_STATUS_RU;
+        IfxEth_startReceiver(eth);
+    }
+}
+
+
+void IfxEth_wakeupTransmitter(IfxEth *eth)
+{
+    eth->status = eth->ethSfr->STATUS;
+
+    // check if suspended
+    if (eth->status & IFXETH_HOST_STATUS_TU)
+    {
+        eth->ethSfr->STATUS &= ~IFXETH_HOST_STATUS_TU;
+    }
+
+    if (eth->ethSfr->txRunning && (eth->ethSfr->txAutoProcess != FALSE))
+    {
+        IfxEth_Host_processTransmit(eth, 0xFFFFFFFFU);
+    }
+}
+
+
+void IfxEth_writeHeader(IfxEth *eth, uint8 *txBuffer, uint8 *destinationAddress, uint8 *sourceAddress, uint32 packetSize)
+{
+    (void)eth;
+    uint32 i;
+
+    /* Destination Address */
+    for (i = 0; i < 6; i++)
+    {
+        *txBuffer++ = *destinationAddress++;
+    }
+
+    /* Source Address */
+    for (i = 0; i < 6; i++)
+    {
+        *txBuffer++ = *sourceAddress++;
+    }
+
+    /* packet size */
+    *txBuffer++ = packetSize / 256;
+    *txBuffer++ = packetSize % 256;
+}
+
+
+boolean IfxEth_Host_receiveFrame(IfxEth *eth, const void *frame, uint16 length)
+{
+    Ifx_ETH        *ethSfr = eth->ethSfr;
+    IfxEth_RxDescr *descr  = ethSfr->rxDmaDescr;
+    boolean         stored = FALSE;
+
+    if ((ethSfr->rxRunning == FALSE) || (descr == NULL_PTR))
+    {
+        ethSfr->rxMissed++;
+    }
+    else if ((__atomic_load_n(&descr->RDES0.U, __ATOMIC_ACQUIRE) & 0x80000000U) == 0)
+    {
+        /* descriptor still owned by the CPU: receive buffer unavailable */
+        ethSfr->STATUS |= IFXETH_HOST_STATUS_RU;
+        ethSfr->rxMissed++;
+    }
+    else
+    {
+        IfxEth_RxDescr0 rdes0;
+        uint16          size = (uint16)descr->RDES1.A.RBS1;
+
+        if (length > size)
+        {
+            /* frame does not fit into one buffer: flag a giant frame */
+            length = size;
+        }
+
+        memcpy((void *)descr->RDES2.U, frame, length);
+
+        rdes0.U     = 0;
+        rdes0.A.FS  = 1U;
+        rdes0.A.LS  = 1U;
+        rdes0.A.FL  = length;
+        rdes0.A.OWN = 0U;
+        __atomic_store_n(&descr->RDES0.U, rdes0.U, __ATOMIC_RELEASE);
+
+        ethSfr->rxDmaDescr = IfxEth_RxDescr_getNext(descr);
+        ethSfr->rxFrames++;
+        stored             = TRUE;
+
+        if (descr->RDES1.A.DIC == 0)
+        {
+            /* RI clears a pending early receive interrupt */
+            ethSfr->STATUS = (ethSfr->STATUS & ~IFXETH_HOST_STATUS_ERI) | IFXETH_HOST_STATUS_RI;
+        }
+        else
+        {
+            /* the whole frame fits into the first buffer, so ERI is raised for every frame */
+            ethSfr->STATUS |= IFXETH_HOST_STATUS_ERI;
+        }
+    }
+
+    IfxEth_Host_raiseInterrupt(eth);
+
+    return stored;
+}
+
+
+uint32 IfxEth_Host_processTransmit(IfxEth *eth, uint32 budget)
+{
+    Ifx_ETH *ethSfr = eth->ethSfr;
+    uint32   count  = 0;
+    uint8    frame[IFXETH_RTX_BUFFER_SIZE];
+
+    while ((count < budget) && ethSfr->txRunning)
+    {
+        IfxEth_TxDescr *first  = ethSfr->txDmaDescr;
+        IfxEth_TxDescr *descr  = first;
+        uint16          length = 0;
+        boolean         ready  = FALSE;
+
+        /* check that the whole frame (FS .. LS) has been released to the DMA */
+        while (IfxEth_TxDescr_isAvailable(descr) == FALSE)
+        {
+            if (descr->TDES0.A.LS)
+            {
+                ready = TRUE;
+                break;
+            }
+
+            descr = IfxEth_TxDescr_getNext(descr);
+
+            if (descr == first)
+            {
+                break;
+            }
+        }
+
+        if (ready == FALSE)
+        {
+            ethSfr->STATUS |= IFXETH_HOST_STATUS_TU;
+            break;
+        }
+
+        /* gather the segments and hand the descriptors back to the CPU */
+        descr = first;
+
+        while (TRUE)
+        {
+            uint16  size = (uint16)descr->TDES1.A.TBS1;
+            boolean last = descr->TDES0.A.LS;
+
+            if ((uint32)length + size <= sizeof(frame))
+            {
+                memcpy(&frame[length], (const void *)descr->TDES2.U, size);
+                length = (uint16)(length + size);
+            }
+
+            __atomic_and_fetch(&descr->TDES0.U, ~0x80000000U, __ATOMIC_RELEASE);
+
+            descr = IfxEth_TxDescr_getNext(descr);
+
+            if (last)
+            {
+                break;
+            }
+        }
+
+        IfxEth_Host_insertChecksum(frame, length, (IfxEth_ChecksumMode)first->TDES0.A.CIC);
+
+        ethSfr->txDmaDescr = descr;
+        ethSfr->txFrames++;
+        ethSfr->txBytes   += length;
+        ethSfr->STATUS    |= IFXETH_HOST_STATUS_TI;
+        count++;
+
+        IfxEth_Host_putOnWire(eth, frame, length);
+    }
+
+    if (count > 0)
+    {
+        IfxEth_Host_raiseInterrupt(eth);
+    }
+
+    return count;
+}
+
+
+void IfxEth_Host_setTxAutoProcess(IfxEth *eth, boolean enabled)
+{
+    eth->ethSfr->txAutoProcess = enabled;
+}
+
+
+void IfxEth_Host_setTxHook(IfxEth *eth, IfxEth_Host_TxHook hook, void *context)
+{
+    eth->ethSfr->txHook        = hook;
+    eth->ethSfr->txHookContext = context;
+}
+
+
+uint16 IfxEth_Host_readTransmittedFrame(IfxEth *eth, uint8 *frame)
+{
+    Ifx_ETH *ethSfr = eth->ethSfr;
+    uint16   length = 0;
+
+    if (ethSfr->txQueueHead != ethSfr->txQueueTail)
+    {
+        IfxEth_Host_Frame *entry = &ethSfr->txQueue[ethSfr->txQueueHead % IFXETH_HOST_TX_QUEUE_SIZE];
+        length = entry->length;
+        memcpy(frame, entry->data, length);
+        ethSfr->txQueueHead++;
+    }
+
+    return length;
+}
+
+
+static void IfxEth_Host_putOnWire(IfxEth *eth, const uint8 *frame, uint16 length)
+{
+    Ifx_ETH *ethSfr = eth->ethSfr;
+
+    if (ethSfr->loopback)
+    {
+        IfxEth_Host_receiveFrame(eth, frame, length);
+    }
+    else if (ethSfr->txHook != NULL_PTR)
+    {
+        ethSfr->txHook(ethSfr->txHookContext, frame, length);
+    }
+    else if ((ethSfr->txQueueTail - ethSfr->txQueueHead) < IFXETH_HOST_TX_QUEUE_SIZE)
+    {
+        IfxEth_Host_Frame *entry = &ethSfr->txQueue[ethSfr->txQueueTail % IFXETH_HOST_TX_QUEUE_SIZE];
+        entry->length = length;
+        memcpy(entry->data, frame, length);
+        ethSfr->txQueueTail++;
+    }
+    else
+    {
+        ethSfr->txQueueDropped++;
+    }
+}
+
+
+static uint32 IfxEth_Host_sum(const uint8 *data, uint32 length, uint32 sum)
+{
+    uint32 i;
+
+    for (i = 0; (i + 1) < length; i += 2)
+    {
+        sum += ((uint32)data[i] << 8) | data[i + 1];
+    }
+
+    if (length & 1U)
+    {
+        sum += (uint32)data[length - 1] << 8;
+    }
+
+    return sum;
+}
+
+
+static uint16 IfxEth_Host_fold(uint32 sum)
+{
+    sum = (sum >> 16) + (sum & 0xFFFFU);
+    sum = (sum >> 16) + (sum & 0xFFFFU);
+
+    return (uint16)sum;
+}
+
+
+static void IfxEth_Host_insertChecksum(uint8 *frame, uint16 length, IfxEth_ChecksumMode mode)
+{
+    uint8  *ip = &frame[14];
+    uint16  ihl, total, l4Length, sum;
+    uint8  *l4;
+    uint32  offset;
+
+    if ((mode == IfxEth_ChecksumMode_bypass) || (length < 34) || (frame[12] != 0x08) || (frame[13] != 0x00)
+        || ((ip[0] >> 4) != 4))
+    {
+        return;
+    }
+
+    ihl   = (uint16)((ip[0] & 0x0FU) * 4U);
+    total = (uint16)((ip[2] << 8) | ip[3]);
+
+    if ((total < ihl) || ((uint32)total + 14 > length))
+    {
+        return;
+    }
+
+    ip[10] = 0;
+    ip[11] = 0;
+    sum    = (uint16)~IfxEth_Host_fold(IfxEth_Host_sum(ip, ihl, 0));
+    ip[10] = (uint8)(sum >> 8);
+    ip[11] = (uint8)sum;
+
+    /* the engine does not touch the payload of fragments */
+    if ((mode == IfxEth_ChecksumMode_ipv4) || (((ip[6] & 0x3FU) | ip[7]) != 0))
+    {
+        return;
+    }
+
+    l4       = &ip[ihl];
+    l4Length = (uint16)(total - ihl);
+
+    switch (ip[9])
+    {
+    case 1:  /* ICMP */
+        offset = 2;
+        break;
+    case 6:  /* TCP */
+        offset = 16;
+        break;
+    case 17: /* UDP */
+        offset = 6;
+        break;
+    default:
+        return;
+    }
+
+    if (l4Length < offset + 2)
+    {
+        return;
+    }
+
+    uint32 acc = 0;
+
+    if (mode == IfxEth_ChecksumMode_tcpUdpIcmpFull)
+    {
+        l4[offset]     = 0;
+        l4[offset + 1] = 0;
+
+        if (ip[9] != 1)
+        {
+            acc = IfxEth_Host_sum(&ip[12], 8, 0) + ip[9] + l4Length;
+        }
+    }
+
+    sum = (uint16)~IfxEth_Host_fold(IfxEth_Host_sum(l4, l4Length, acc));
+
+    if ((sum == 0) && (ip[9] == 17))
+    {
+        sum = 0xFFFFU;
+    }
+
+    l4[offset]     = (uint8)(sum >> 8);
+    l4[offset + 1] = (uint8)sum;
+}
+
+
+static void IfxEth_Host_raiseInterrupt(IfxEth *eth)
+{
+    Ifx_ETH *ethSfr = eth->ethSfr;
+
+    if (((ethSfr->STATUS & ethSfr->INTERRUPT_ENABLE) != 0) && (eth->config.isrHandler != NULL_PTR))
+    {
+        eth->config.isrHandler();
+    }
+}
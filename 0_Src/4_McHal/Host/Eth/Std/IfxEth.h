@@ -0,0 +1,745 @@
+/**
+ * \file IfxEth.h
+ * \brief Host (Linux) model of the ETH basic functionality
+ * \ingroup IfxLld_Eth
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * This file provides the same API as Tricore/Eth/Std/IfxEth.h. The descriptor
+ * rings, the OWN bit hand-over and the status flags behave like the GMAC DMA;
+ * the "wire" is replaced by IfxEth_Host_receiveFrame() on the receive side and
+ * by a frame hook / frame queue on the transmit side.
+ *
+ * Differences to the target:
+ * - descriptor address words (DWORD2, DWORD3) are pointer sized
+ * - the TX DMA runs synchronously from IfxEth_wakeupTransmitter() unless
+ *   IfxEth_Host_setTxAutoProcess() disabled it, in which case the simulation
+ *   calls IfxEth_Host_processTransmit()
+ * - the interrupt "vector" is the isrHandler member of IfxEth_Config
+ */
+
+#ifndef IFXET_H
+#define IFXET_H 1
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "Cpu/Std/Ifx_Types.h"
+#include "Cpu/Std/IfxCpu.h"
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+/** \brief Size of one ethernet frame buffer
+ */
+#ifndef IFXETH_RTX_BUFFER_SIZE
+#define IFXETH_RTX_BUFFER_SIZE   1536
+#endif
+
+#ifndef IFXETH_TX_BUFFER_BY_USER
+#define IFXETH_TX_BUFFER_BY_USER 0
+#endif
+
+#ifndef IFXETH_RX_BUFFER_BY_USER
+#define IFXETH_RX_BUFFER_BY_USER 0
+#endif
+
+/** \brief 1 defines the default rings IfxEth_rxDescr / IfxEth_rxBuffer and IfxEth_txDescr /
+ * IfxEth_txBuffer used by IfxEth_initConfig(), 0 if the application provides all rings
+ */
+#ifndef IFXETH_DEFAULT_RINGS
+#define IFXETH_DEFAULT_RINGS     1
+#endif
+
+/** \brief Rx buffers (ring mode) of the default ring IfxEth_rxDescr / IfxEth_rxBuffer
+ * Other ring sizes are set at run time with IfxEth_Config::rxDescrCount.
+ */
+#ifndef IFXETH_MAX_RX_BUFFERS
+#define IFXETH_MAX_RX_BUFFERS    8
+#endif
+
+/** \brief Tx buffers (ring mode) of the default ring IfxEth_txDescr / IfxEth_txBuffer
+ * Other ring sizes are set at run time with IfxEth_Config::txDescrCount.
+ */
+#ifndef IFXETH_MAX_TX_BUFFERS
+#define IFXETH_MAX_TX_BUFFERS    16
+#endif
+
+/** \brief Number of transmitted frames buffered by the model when no TX hook is installed
+ */
+#ifndef IFXETH_HOST_TX_QUEUE_SIZE
+#define IFXETH_HOST_TX_QUEUE_SIZE 64
+#endif
+
+/** \brief DMA status register bits used by the model */
+#define IFXETH_HOST_STATUS_TI    (1U << 0)
+#define IFXETH_HOST_STATUS_TU    (1U << 2)
+#define IFXETH_HOST_STATUS_OVF   (1U << 4)
+#define IFXETH_HOST_STATUS_RI    (1U << 6)
+#define IFXETH_HOST_STATUS_RU    (1U << 7)
+#define IFXETH_HOST_STATUS_ERI   (1U << 14)
+
+/******************************************************************************/
+/*--------------------------------Enumerations--------------------------------*/
+/******************************************************************************/
+
+typedef enum
+{
+    IfxEth_ChecksumMode_bypass            = 0,
+    IfxEth_ChecksumMode_ipv4              = 1,
+    IfxEth_ChecksumMode_tcpUdpIcmpSegment = 2,
+    IfxEth_ChecksumMode_tcpUdpIcmpFull    = 3
+} IfxEth_ChecksumMode;
+
+/** \brief External Phy Interface RMII Mode
+ */
+typedef enum
+{
+    IfxEth_PhyInterfaceMode_mii,  /**< \brief MII mode */
+    IfxEth_PhyInterfaceMode_rmii  /**< \brief RMII mode */
+} IfxEth_PhyInterfaceMode;
+
+/******************************************************************************/
+/*-----------------------------Data Structures--------------------------------*/
+/******************************************************************************/
+
+/** \brief Structure for Alternate/Enhanced RX descriptor DWORD 0 Bit field access
+ */
+typedef struct
+{
+    uint32 ext : 1;    /**< \brief Extended Status Available/Rx MAC Address */
+    uint32 CE : 1;     /**< \brief CRC Error */
+    uint32 DBE : 1;    /**< \brief Dribble Bit Error */
+    uint32 RE : 1;     /**< \brief Receive Error */
+    uint32 RWT : 1;    /**< \brief Receive Watchdog Timeout */
+    uint32 FT : 1;     /**< \brief Frame Type */
+    uint32 LC : 1;     /**< \brief Late Collision */
+    uint32 IPC : 1;    /**< \brief IPC Checksum Error/Giant Frame */
+    uint32 LS : 1;     /**< \brief Last Descriptor */
+    uint32 FS : 1;     /**< \brief First Descriptor */
+    uint32 VLAN : 1;   /**< \brief VLAN Tag */
+    uint32 OE : 1;     /**< \brief Overflow Error */
+    uint32 LE : 1;     /**< \brief Length Error */
+    uint32 SAF : 1;    /**< \brief Source Address Filter Fail */
+    uint32 DE : 1;     /**< \brief Descriptor Error */
+    uint32 ES : 1;     /**< \brief Error Summary */
+    uint32 FL : 14;    /**< \brief Frame Length */
+    uint32 AFM : 1;    /**< \brief Destination Address Filter Fail */
+    uint32 OWN : 1;    /**< \brief Own Bit, 1 = own by DMA */
+} IfxEth_AltRxDescr0_Bits;
+
+/** \brief Structure for Alternate/Enhanced RX descriptor DWORD 1 Bit field access
+ */
+typedef struct
+{
+    uint32 RBS1 : 13;   /**< \brief Receive Buffer 1 Size */
+    uint32 resv1 : 1;   /**< \brief reserved */
+    uint32 RCH : 1;     /**< \brief Second Address Chained */
+    uint32 RER : 1;     /**< \brief Receive End of Ring */
+    uint32 RBS2 : 13;   /**< \brief Receive Buffer 2 Size */
+    uint32 resv : 2;    /**< \brief reserved) */
+    uint32 DIC : 1;     /**< \brief Disable Interrupt on Completion */
+} IfxEth_AltRxDescr1_Bits;
+
+/** \brief Structure for Alternate/Enhanced TX descriptor DWORD 0 Bit field access
+ */
+typedef struct
+{
+    uint32 DB : 1;      /**< \brief Deferred bit */
+    uint32 UF : 1;      /**< \brief Underflow error */
+    uint32 ED : 1;      /**< \brief Excessive deferral */
+    uint32 CC : 4;      /**< \brief Collision count */
+    uint32 VLAN : 1;    /**< \brief VLAN TAG */
+    uint32 EC : 1;      /**< \brief Excessive Collision */
+    uint32 LC : 1;      /**< \brief Late Collision */
+    uint32 NC : 1;      /**< \brief No Carrier */
+    uint32 LOC : 1;     /**< \brief Loss of Carrier */
+    uint32 PCE : 1;     /**< \brief Payload Checksum Error */
+    uint32 FF : 1;      /**< \brief Frame Flushed */
+    uint32 JT : 1;      /**< \brief Jabber Timeout */
+    uint32 ES : 1;      /**< \brief Error Summary */
+    uint32 IHE : 1;     /**< \brief IP Header Error */
+    uint32 TTSS : 1;    /**< \brief Transmit Time Stamp Status */
+    uint32 resv : 2;    /**< \brief (reserved) */
+    uint32 TCH : 1;     /**< \brief Second Address Chained */
+    uint32 TER : 1;     /**< \brief Transmit End of Ring */
+    uint32 CIC : 2;     /**< \brief Checksum Insertion Control */
+    uint32 resv1 : 1;   /**< \brief (Reserved) */
+    uint32 TTSE : 1;    /**< \brief Transmit Time Stamp Enable */
+    uint32 DP : 1;      /**< \brief Disable Padding */
+    uint32 DC : 1;      /**< \brief Disable CRC */
+    uint32 FS : 1;      /**< \brief First Segment */
+    uint32 LS : 1;      /**< \brief Last Segment */
+    uint32 IC : 1;      /**< \brief Interrupt on Completion */
+    uint32 OWN : 1;     /**< \brief Own Bit, 1 = own by DMA */
+} IfxEth_AltTxDescr0_Bits;
+
+/** \brief Structure for Alternate/Enhanced TX descriptor DWORD 1 Bit field access
+ */
+typedef struct
+{
+    uint32 TBS1 : 13;   /**< \brief Transmit Buffer 1 Size */
+    uint32 resv1 : 3;   /**< \brief (reserved) */
+    uint32 TBS2 : 13;   /**< \brief Transmit Buffer 2 Size */
+    uint32 resv2 : 3;   /**< \brief (reserved) */
+} IfxEth_AltTxDescr1_Bits;
+
+/** \brief Union for RX descriptor DWORD 0
+ */
+typedef union
+{
+    IfxEth_AltRxDescr0_Bits A;     /**< \brief Structure for RX descriptor DWORD 0 Bit field access */
+    uint32                  U;     /**< \brief Unsigned long access */
+} IfxEth_RxDescr0;
+
+/** \brief Union for RX descriptor DWORD 1
+ */
+typedef union
+{
+    IfxEth_AltRxDescr1_Bits A;     /**< \brief Structure for RX descriptor DWORD 1 Bit field access */
+    uint32                  U;     /**< \brief unsigned long access */
+} IfxEth_RxDescr1;
+
+/** \brief Union for RX descriptor DWORD 2 (buffer address)
+ */
+typedef union
+{
+    uintptr_t U;     /**< \brief pointer sized access */
+} IfxEth_RxDescr2;
+
+/** \brief Union for RX descriptor DWORD 3 (next descriptor address)
+ */
+typedef union
+{
+    uintptr_t U;     /**< \brief pointer sized access */
+} IfxEth_RxDescr3;
+
+/** \brief Union for TX descriptor DWORD 0
+ */
+typedef union
+{
+    IfxEth_AltTxDescr0_Bits A;     /**< \brief Structure for TX descriptor DWORD 0 Bit field access */
+    uint32                  U;     /**< \brief Unsigned long access */
+} IfxEth_TxDescr0;
+
+/** \brief Union for TX descriptor DWORD 1
+ */
+typedef union
+{
+    IfxEth_AltTxDescr1_Bits A;     /**< \brief Structure for RX descriptor DWORD 1 Bit field access */
+    uint32                  U;     /**< \brief unsigned long access */
+} IfxEth_TxDescr1;
+
+/** \brief Union for TX descriptor DWORD 2 (buffer address)
+ */
+typedef union
+{
+    uintptr_t U;     /**< \brief pointer sized access */
+} IfxEth_TxDescr2;
+
+/** \brief Union for TX descriptor DWORD 3 (next descriptor address)
+ */
+typedef union
+{
+    uintptr_t U;     /**< \brief pointer sized access */
+} IfxEth_TxDescr3;
+
+/** \brief Normal RX descriptor
+ */
+typedef struct
+{
+    IfxEth_RxDescr0 RDES0;     /**< \brief RX descriptor DWORD 0 */
+    IfxEth_RxDescr1 RDES1;     /**< \brief RX descriptor DWORD 1 */
+    IfxEth_RxDescr2 RDES2;     /**< \brief RX descriptor DWORD 2 */
+    IfxEth_RxDescr3 RDES3;     /**< \brief RX descriptor DWORD 3 */
+} IfxEth_RxDescr;
+
+/** \brief Normal TX descriptor
+ */
+typedef struct
+{
+    IfxEth_TxDescr0 TDES0;     /**< \brief TX descriptor DWORD 0 */
+    IfxEth_TxDescr1 TDES1;     /**< \brief TX descriptor DWORD 1 */
+    IfxEth_TxDescr2 TDES2;     /**< \brief TX descriptor DWORD 2 */
+    IfxEth_TxDescr3 TDES3;     /**< \brief TX descriptor DWORD 3 */
+} IfxEth_TxDescr;
+
+typedef struct
+{
+    IfxEth_RxDescr items[IFXETH_MAX_RX_BUFFERS];
+} IfxEth_RxDescrList;
+
+typedef struct
+{
+    IfxEth_TxDescr items[IFXETH_MAX_TX_BUFFERS];
+} IfxEth_TxDescrList;
+
+/** \brief Hook called by the model for each frame put on the wire
+ * \param context context pointer given to IfxEth_Host_setTxHook()
+ * \param frame frame data, starting with the ethernet header
+ * \param length frame length in bytes
+ */
+typedef void (*IfxEth_Host_TxHook)(void *context, const uint8 *frame, uint16 length);
+
+/** \brief One frame of the model's transmit queue */
+typedef struct
+{
+    uint16 length;
+    uint8  data[IFXETH_RTX_BUFFER_SIZE];
+} IfxEth_Host_Frame;
+
+/** \brief Software model of the ETH registers and of the DMA engine state
+ */
+typedef struct
+{
+    uint32              STATUS;             /**< \brief DMA status register, see IFXETH_HOST_STATUS_* */
+    uint32              INTERRUPT_ENABLE;   /**< \brief DMA interrupt enable register */
+    boolean             rxRunning;          /**< \brief RX DMA started (OPERATION_MODE.SR) */
+    boolean             txRunning;          /**< \brief TX DMA started (OPERATION_MODE.ST) */
+    boolean             txAutoProcess;      /**< \brief TX DMA runs on every poll demand */
+    boolean             loopback;           /**< \brief MAC loopback mode */
+    IfxEth_ChecksumMode checksumMode;       /**< \brief Checksum offload engine mode */
+    uint8               macAddress[6];      /**< \brief MAC address register G00 */
+    IfxEth_RxDescr     *rxDmaDescr;         /**< \brief Descriptor the RX DMA writes next */
+    IfxEth_TxDescr     *txDmaDescr;         /**< \brief Descriptor the TX DMA reads next */
+    uint32              rxFrames;           /**< \brief Frames written into the RX ring */
+    uint32              rxMissed;           /**< \brief Frames dropped because the RX ring was full (MFC) */
+    uint32              txFrames;           /**< \brief Frames taken from the TX ring */
+    uint32              txBytes;            /**< \brief Bytes taken from the TX ring */
+    IfxEth_Host_TxHook  txHook;             /**< \brief Wire hook, NULL to use the TX queue */
+    void               *txHookContext;      /**< \brief Context for txHook */
+    uint32              txQueueHead;        /**< \brief TX queue read index */
+    uint32              txQueueTail;        /**< \brief TX queue write index */
+    uint32              txQueueDropped;     /**< \brief Frames lost because the TX queue was full */
+    IfxEth_Host_Frame   txQueue[IFXETH_HOST_TX_QUEUE_SIZE];
+} Ifx_ETH;
+
+/** \brief ETH configuration structure
+ */
+typedef struct
+{
+    uint8 macAddress[6];                          /**< \brief MAC address for the ethernet, should be unique in the network */
+    uint32 (*phyInit)(void);                      /**< \brief Pointer to the transceiver init function */
+    boolean (*phyLink)(void);                     /**< \brief Pointer to the transceiver link function */
+    IfxEth_PhyInterfaceMode phyInterfaceMode;     /**< \brief Phy Interface mode */
+    const void             *rmiiPins;             /**< \brief Unused by the model */
+    const void             *miiPins;              /**< \brief Unused by the model */
+    Ifx_Priority            isrPriority;          /**< \brief Interrupt service priority, 0 = no interrupt */
+    uint32                  isrProvider;          /**< \brief Interrupt service provider */
+    Ifx_ETH                *ethSfr;               /**< \brief Pointer to register base */
+    IfxEth_RxDescr         *rxDescr;              /**< \brief pointer to RX descriptor RAM, rxDescrCount descriptors */
+    IfxEth_TxDescr         *txDescr;              /**< \brief pointer to TX descriptor RAM, txDescrCount descriptors */
+    uint8                  *rxBuffer;             /**< \brief RX buffers, rxDescrCount * IFXETH_RTX_BUFFER_SIZE bytes. Unused with IFXETH_RX_BUFFER_BY_USER */
+    uint8                  *txBuffer;             /**< \brief TX buffers, txDescrCount * IFXETH_RTX_BUFFER_SIZE bytes. Unused with IFXETH_TX_BUFFER_BY_USER */
+    uint16                  rxDescrCount;         /**< \brief Number of RX descriptors, at least 2 */
+    uint16                  txDescrCount;         /**< \brief Number of TX descriptors, at least 2 */
+    void (*isrHandler)(void);                     /**< \brief Interrupt service routine called by the model */
+} IfxEth_Config;
+
+/** \brief ETH driver structure
+ */
+typedef struct
+{
+    uint32              status;         /**< \brief Intermediate variable to use register content in control structure */
+    uint32              rxCount;        /**< \brief Number of frames received */
+    uint32              txCount;        /**< \brief Number of frames transmitted */
+    uint32              error;          /**< \brief Indicate an error has occurred during execution */
+    sint32              isrRxCount;     /**< \brief Count of RX ISR */
+    sint32              isrTxCount;     /**< \brief Count of TX ISR */
+    sint32              txDiff;         /**< \brief Difference between isrTxCount and txCount */
+    sint32              rxDiff;         /**< \brief Difference between isrRxCount and rxCount */
+    sint32              isrCount;       /**< \brief count of all ISR */
+    IfxEth_Config       config;         /**< \brief Copy of the configuration passed through IfxEth_init() */
+    IfxEth_RxDescr     *rxDescr;        /**< \brief pointer to RX descriptor RAM */
+    IfxEth_TxDescr     *txDescr;        /**< \brief pointer to TX descriptor RAM */
+    uint8              *rxBuffer;       /**< \brief RX buffers, IFXETH_RTX_BUFFER_SIZE bytes per descriptor */
+    uint8              *txBuffer;       /**< \brief TX buffers, IFXETH_RTX_BUFFER_SIZE bytes per descriptor */
+    uint16              rxDescrCount;   /**< \brief Number of RX descriptors */
+    uint16              txDescrCount;   /**< \brief Number of TX descriptors */
+    IfxEth_RxDescr     *pRxDescr;
+    IfxEth_TxDescr     *pTxDescr;
+    Ifx_ETH            *ethSfr;         /**< \brief Pointer to register base */
+} IfxEth;
+
+/******************************************************************************/
+/*-------------------Global Exported Variables/Constants----------------------*/
+/******************************************************************************/
+
+/** \brief Register model of the ETH module */
+IFX_EXTERN Ifx_ETH            MODULE_ETH;
+
+#if IFXETH_DEFAULT_RINGS
+/** \brief receive buffers
+ */
+IFX_EXTERN uint8              IfxEth_rxBuffer[IFXETH_MAX_RX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
+
+IFX_EXTERN IfxEth_RxDescrList IfxEth_rxDescr;
+
+/** \brief Transmit buffers
+ */
+IFX_EXTERN uint8              IfxEth_txBuffer[IFXETH_MAX_TX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
+
+IFX_EXTERN IfxEth_TxDescrList IfxEth_txDescr;
+#endif
+
+/******************************************************************************/
+/*-------------------------Global Function Prototypes-------------------------*/
+/******************************************************************************/
+
+IFX_EXTERN void  IfxEth_freeReceiveBuffer(IfxEth *eth);
+IFX_EXTERN void  IfxEth_sendTransmitBuffer(IfxEth *eth, uint16 len);
+IFX_EXTERN void  IfxEth_setMacAddress(IfxEth *eth, const uint8 *macAddress);
+IFX_EXTERN void  IfxEth_startReceiver(IfxEth *eth);
+IFX_EXTERN void  IfxEth_writeHeader(IfxEth *eth, uint8 *txBuffer, uint8 *destinationAddress, uint8 *sourceAddress, uint32 packetSize);
+IFX_EXTERN void  IfxEth_enableModule(void);
+IFX_EXTERN void *IfxEth_getReceiveBuffer(IfxEth *eth);
+IFX_EXTERN void *IfxEth_getTransmitBuffer(IfxEth *eth);
+IFX_EXTERN void  IfxEth_readMacAddress(IfxEth *eth, uint8 *macAddress);
+IFX_EXTERN void  IfxEth_setAndSendTransmitBuffer(IfxEth *eth, void *buffer, uint16 len);
+IFX_EXTERN void  IfxEth_setupChecksumEngine(IfxEth *eth, IfxEth_ChecksumMode mode);
+IFX_EXTERN void  IfxEth_startTransmitter(IfxEth *eth);
+IFX_EXTERN void  IfxEth_stopTransmitter(IfxEth *eth);
+IFX_EXTERN void  IfxEth_wakeupReceiver(IfxEth *eth);
+IFX_EXTERN void  IfxEth_wakeupTransmitter(IfxEth *eth);
+IFX_EXTERN void  IfxEth_init(IfxEth *eth, const IfxEth_Config *config);
+IFX_EXTERN void  IfxEth_initConfig(IfxEth_Config *config, Ifx_ETH *ethSfr);
+IFX_EXTERN void  IfxEth_initReceiveDescriptors(IfxEth *eth);
+IFX_EXTERN void  IfxEth_initTransmitDescriptors(IfxEth *eth);
+
+/** \addtogroup IfxLld_Eth_Host
+ * \{ */
+
+/** \brief Puts a frame on the wire towards the ETH receiver
+ *
+ * The frame is written into the RX descriptor owned by the DMA, the OWN bit is
+ * cleared and RI is raised. When the ring has no descriptor owned by the DMA
+ * the frame is counted in rxMissed and RU is raised, as on the target.
+ * \param eth ETH driver structure
+ * \param frame frame data, starting with the ethernet header
+ * \param length frame length in bytes
+ * \return TRUE if the frame was stored in the RX ring
+ */
+IFX_EXTERN boolean IfxEth_Host_receiveFrame(IfxEth *eth, const void *frame, uint16 length);
+
+/** \brief Runs the TX DMA over the descriptors released to it
+ * \param eth ETH driver structure
+ * \param budget maximum number of frames to put on the wire
+ * \return number of frames put on the wire
+ */
+IFX_EXTERN uint32 IfxEth_Host_processTransmit(IfxEth *eth, uint32 budget);
+
+/** \brief Selects whether the TX DMA runs synchronously on every transmit poll demand
+ * \param eth ETH driver structure
+ * \param enabled TRUE (default): IfxEth_wakeupTransmitter() drains the ring,
+ * FALSE: descriptors stay owned by the DMA until IfxEth_Host_processTransmit() is called
+ */
+IFX_EXTERN void IfxEth_Host_setTxAutoProcess(IfxEth *eth, boolean enabled);
+
+/** \brief Installs the wire hook for transmitted frames
+ * \param eth ETH driver structure
+ * \param hook function called for each frame, NULL to store frames in the TX queue
+ * \param context context pointer passed to the hook
+ */
+IFX_EXTERN void IfxEth_Host_setTxHook(IfxEth *eth, IfxEth_Host_TxHook hook, void *context);
+
+/** \brief Takes the oldest frame out of the TX queue
+ * \param eth ETH driver structure
+ * \param frame buffer of at least IFXETH_RTX_BUFFER_SIZE bytes
+ * \return frame length, 0 if the queue is empty
+ */
+IFX_EXTERN uint16 IfxEth_Host_readTransmittedFrame(IfxEth *eth, uint8 *frame);
+
+/** \} */
+
+/******************************************************************************/
+/*---------------------Inline Function Implementations------------------------*/
+/******************************************************************************/
+
+IFX_INLINE void IfxEth_RxDescr_setBuffer(IfxEth_RxDescr *descr, void *buffer)
+{
+    descr->RDES2.U = (uintptr_t)IFXCPU_GLB_ADDR_DSPR(IfxCpu_getCoreId(), buffer);
+}
+
+
+IFX_INLINE IfxEth_TxDescr *IfxEth_TxDescr_getNext(IfxEth_TxDescr *descr)
+{
+    return (IfxEth_TxDescr *)(descr->TDES3.U);
+}
+
+
+IFX_INLINE boolean IfxEth_TxDescr_isAvailable(IfxEth_TxDescr *descr)
+{
+    return (__atomic_load_n(&descr->TDES0.U, __ATOMIC_ACQUIRE) & 0x80000000U) == 0 ? TRUE : FALSE;
+}
+
+
+IFX_INLINE void IfxEth_TxDescr_setBuffer(IfxEth_TxDescr *descr, void *buffer)
+{
+    descr->TDES2.U = (uintptr_t)IFXCPU_GLB_ADDR_DSPR(IfxCpu_getCoreId(), buffer);
+}
+
+
+IFX_INLINE boolean IfxEth_isDmaAddress(const void *buffer)
+{
+    /* the model reads any host address */
+    (void)buffer;
+    return TRUE;
+}
+
+
+IFX_INLINE void IfxEth_RxDescr_setInterrupt(IfxEth_RxDescr *descr, boolean enabled)
+{
+    descr->RDES1.A.DIC = enabled ? 0 : 1;
+}
+
+
+IFX_INLINE void IfxEth_clearEarlyRxInterrupt(IfxEth *eth)
+{
+    eth->ethSfr->STATUS &= ~IFXETH_HOST_STATUS_ERI;
+}
+
+
+IFX_INLINE void IfxEth_setEarlyRxInterrupt(IfxEth *eth, boolean enabled)
+{
+    if (enabled)
+    {
+        eth->ethSfr->INTERRUPT_ENABLE |= IFXETH_HOST_STATUS_ERI;
+    }
+    else
+    {
+        eth->ethSfr->INTERRUPT_ENABLE &= ~IFXETH_HOST_STATUS_ERI;
+    }
+}
+
+
+IFX_INLINE void IfxEth_clearRxInterrupt(IfxEth *eth)
+{
+    eth->ethSfr->STATUS &= ~IFXETH_HOST_STATUS_RI;
+}
+
+
+IFX_INLINE void IfxEth_clearTxInterrupt(IfxEth *eth)
+{
+    eth->ethSfr->STATUS &= ~IFXETH_HOST_STATUS_TI;
+}
+
+
+IFX_INLINE void IfxEth_setLoopbackMode(IfxEth *eth, boolean loopbackMode)
+{
+    eth->ethSfr->loopback = loopbackMode;
+}
+
+
+IFX_INLINE boolean IfxEth_getLoopbackMode(IfxEth *eth)
+{
+    return eth->ethSfr->loopback;
+}
+
+
+IFX_INLINE IfxEth_RxDescr *IfxEth_RxDescr_getNext(IfxEth_RxDescr *descr)
+{
+    return (IfxEth_RxDescr *)(descr->RDES3.U);
+}
+
+
+IFX_INLINE void IfxEth_RxDescr_release(IfxEth_RxDescr *descr)
+{
+    __atomic_or_fetch(&descr->RDES0.U, 0x80000000U, __ATOMIC_RELEASE);
+}
+
+
+IFX_INLINE void IfxEth_TxDescr_release(IfxEth_TxDescr *descr)
+{
+    __atomic_or_fetch(&descr->TDES0.U, 0x80000000U, __ATOMIC_RELEASE);
+}
+
+
+IFX_INLINE IfxEth_RxDescr *IfxEth_getActualRxDescriptor(IfxEth *eth)
+{
+    return eth->pRxDescr;
+}
+
+
+IFX_INLINE IfxEth_RxDescr *IfxEth_getBaseRxDescriptor(IfxEth *eth)
+{
+    return eth->rxDescr;
+}
+
+
+IFX_INLINE IfxEth_TxDescr *IfxEth_getBaseTxDescriptor(IfxEth *eth)
+{
+    return eth->txDescr;
+}
+
+
+IFX_INLINE void *IfxEth_getDmaAlias(void *address)
+{
+    /* the model reads any host address */
+    return address;
+}
+
+
+IFX_INLINE uint16 IfxEth_getRxDescriptorCount(IfxEth *eth)
+{
+    return eth->rxDescrCount;
+}
+
+
+IFX_INLINE uint16 IfxEth_getTxDescriptorCount(IfxEth *eth)
+{
+    return eth->txDescrCount;
+}
+
+
+IFX_INLINE uint8 *IfxEth_getTxBufferByIndex(IfxEth *eth, uint32 index)
+{
+    return &eth->txBuffer[index * IFXETH_RTX_BUFFER_SIZE];
+}
+
+
+IFX_INLINE uint32 IfxEth_getActualRxIndex(IfxEth *eth)
+{
+    return (uint32)(eth->pRxDescr - IfxEth_getBaseRxDescriptor(eth));
+}
+
+
+IFX_INLINE uint32 IfxEth_getDmaRxIndex(IfxEth *eth)
+{
+    return (uint32)(eth->ethSfr->rxDmaDescr - IfxEth_getBaseRxDescriptor(eth));
+}
+
+
+IFX_INLINE IfxEth_TxDescr *IfxEth_getActualTxDescriptor(IfxEth *eth)
+{
+    return eth->pTxDescr;
+}
+
+
+IFX_INLINE void *IfxEth_getMacAddressPointer(IfxEth *eth)
+{
+    return (void *)eth->config.macAddress;
+}
+
+
+IFX_INLINE boolean IfxEth_isRxDataAvailable(IfxEth *eth)
+{
+    return (__atomic_load_n(&IfxEth_getActualRxDescriptor(eth)->RDES0.U, __ATOMIC_ACQUIRE) & 0x80000000U) == 0;
+}
+
+
+IFX_INLINE uint16 IfxEth_getRxDataLength(IfxEth *eth)
+{
+    uint16 length = 0;
+
+    if (IfxEth_isRxDataAvailable(eth) != FALSE)
+    {
+        length = (uint16)IfxEth_getActualRxDescriptor(eth)->RDES0.A.FL;
+    }
+
+    return length;
+}
+
+
+IFX_INLINE boolean IfxEth_isLinkActive(IfxEth *eth)
+{
+    return eth->config.phyLink() != 0;
+}
+
+
+IFX_INLINE boolean IfxEth_isRxChecksumError(IfxEth *eth)
+{
+    IfxEth_RxDescr *descr = IfxEth_getActualRxDescriptor(eth);
+    boolean         error = (descr->RDES0.A.IPC != 0);
+    descr->RDES0.A.IPC = 0;
+
+    return error;
+}
+
+
+IFX_INLINE boolean IfxEth_isEarlyRxInterrupt(IfxEth *eth)
+{
+    return (eth->ethSfr->STATUS & IFXETH_HOST_STATUS_ERI) != 0;
+}
+
+
+IFX_INLINE boolean IfxEth_isRxInterrupt(IfxEth *eth)
+{
+    return (eth->ethSfr->STATUS & IFXETH_HOST_STATUS_RI) != 0;
+}
+
+
+IFX_INLINE boolean IfxEth_isTxInterrupt(IfxEth *eth)
+{
+    return (eth->ethSfr->STATUS & IFXETH_HOST_STATUS_TI) != 0;
+}
+
+
+IFX_INLINE void IfxEth_readAllFlags(IfxEth *eth)
+{
+    eth->status = eth->ethSfr->STATUS;
+}
+
+
+IFX_INLINE void IfxEth_readMissedFrameCounter(IfxEth *eth, uint32 *missed, uint32 *overflow)
+{
+    /* the counters are cleared on read */
+    *missed   = __swap(&eth->ethSfr->rxMissed, 0);
+    *overflow = 0;
+}
+
+
+IFX_INLINE void IfxEth_shuffleRxDescriptor(IfxEth *eth)
+{
+    eth->pRxDescr = IfxEth_RxDescr_getNext(eth->pRxDescr);
+}
+
+
+IFX_INLINE void IfxEth_shuffleTxDescriptor(IfxEth *eth)
+{
+    eth->pTxDescr = IfxEth_TxDescr_getNext(eth->pTxDescr);
+}
+
+
+IFX_INLINE void IfxEth_TxDescr_setup(IfxEth_TxDescr *descr, uint16 length, boolean firstSegment, boolean lastSegment)
+{
+    IfxEth_TxDescr0 tdes0;
+
+    tdes0.U        = descr->TDES0.U;
+    tdes0.A.FS     = firstSegment;
+    tdes0.A.LS     = lastSegment;
+    descr->TDES0.U = tdes0.U;
+    descr->TDES1.U = length;
+}
+
+
+IFX_INLINE void *IfxEth_waitTransmitBuffer(IfxEth *eth)
+{
+    void *tx;
+
+    do
+    {
+        tx = IfxEth_getTransmitBuffer(eth);
+    } while (tx == NULL_PTR);
+
+    return tx;
+}
+
+
+#endif /* IFXET_H */
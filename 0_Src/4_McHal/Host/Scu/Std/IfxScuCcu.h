@@ -0,0 +1,63 @@
+/**
+ * \file IfxScuCcu.h
+ * \brief Host (Linux) model of the clock control unit
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ */
+
+#ifndef IFXSCUCCU_H
+#define IFXSCUCCU_H 1
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "Cpu/Std/IfxCpu.h"
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+/** \brief Frequencies of the TC297 default clock tree */
+#define IFXSCUCCU_HOST_PLL_FREQUENCY (200000000.0f)
+#define IFXSCUCCU_HOST_SPB_FREQUENCY (100000000.0f)
+
+/******************************************************************************/
+/*---------------------Inline Function Implementations------------------------*/
+/******************************************************************************/
+
+IFX_INLINE float32 IfxScuCcu_getPllFrequency(void)
+{
+    return IFXSCUCCU_HOST_PLL_FREQUENCY;
+}
+
+
+IFX_INLINE float32 IfxScuCcu_getCpuFrequency(IfxCpu_Id cpu)
+{
+    (void)cpu;
+    return IFXSCUCCU_HOST_PLL_FREQUENCY;
+}
+
+
+IFX_INLINE float32 IfxScuCcu_getSpbFrequency(void)
+{
+    return IFXSCUCCU_HOST_SPB_FREQUENCY;
+}
+
+
+#endif /* IFXSCUCCU_H */
@@ -0,0 +1,95 @@
+/**
+ * \file IfxStm.c
+ * \brief Host (Linux) model of the system timer
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ */
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "IfxStm.h"
+
+#include <time.h>
+
+/******************************************************************************/
+/*-----------------------Exported Variables/Constants-------------------------*/
+/******************************************************************************/
+
+Ifx_STM MODULE_STM0 = {.index = 0};
+Ifx_STM MODULE_STM1 = {.index = 1};
+Ifx_STM MODULE_STM2 = {.index = 2};
+
+/******************************************************************************/
+/*------------------------Private Variables/Constants-------------------------*/
+/******************************************************************************/
+
+static uint64 IfxStm_Host_startNs = 0;
+
+/******************************************************************************/
+/*-------------------------Function Implementations---------------------------*/
+/******************************************************************************/
+
+uint64 IfxStm_get(Ifx_STM *stm)
+{
+    struct timespec now;
+    uint64          ns;
+
+    (void)stm;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    ns = ((uint64)now.tv_sec * 1000000000ULL) + (uint64)now.tv_nsec;
+
+    if (IfxStm_Host_startNs == 0)
+    {
+        IfxStm_Host_startNs = ns;
+    }
+
+    return (ns - IfxStm_Host_startNs) / (1000000000ULL / IFXSTM_HOST_FREQUENCY);
+}
+
+
+void IfxStm_enableOcdsSuspend(Ifx_STM *stm)
+{
+    (void)stm;
+}
+
+
+void IfxStm_clearCompareFlag(Ifx_STM *stm, IfxStm_Comparator comparator)
+{
+    (void)stm;
+    (void)comparator;
+}
+
+
+boolean IfxStm_Host_pollCompare(Ifx_STM *stm, IfxStm_Comparator comparator)
+{
+    boolean match = FALSE;
+
+    if ((stm->armed & (1U << comparator)) != 0)
+    {
+        /* the comparator matches once, when the lower timer word passes the compare value */
+        if ((sint32)(IfxStm_getLower(stm) - stm->CMP[comparator]) >= 0)
+        {
+            stm->armed &= ~(1U << comparator);
+            match       = TRUE;
+        }
+    }
+
+    return match;
+}
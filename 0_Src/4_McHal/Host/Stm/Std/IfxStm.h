@@ -0,0 +1,132 @@
+/**
+ * \file IfxStm.h
+ * \brief Host (Linux) model of the system timer
+ *
+ * \copyright Copyright (c) 2014 Infineon Technologies AG. All rights reserved.
+ *
+ *
+ *                                 IMPORTANT NOTICE
+ *
+ *
+ * Infineon Technologies AG (Infineon) is supplying this file for use
+ * exclusively with Infineon's microcontroller products. This file can be freely
+ * distributed within development tools that are supporting such microcontroller
+ * products.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED
+ * OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.
+ * INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,
+ * OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ *
+ * The timer runs at the TC297 default STM frequency of 100 MHz and is derived
+ * from CLOCK_MONOTONIC, so tick values measured on the host are directly
+ * comparable with the ones taken on the target.
+ */
+
+#ifndef IFXSTM_H
+#define IFXSTM_H 1
+
+/******************************************************************************/
+/*----------------------------------Includes----------------------------------*/
+/******************************************************************************/
+
+#include "Cpu/Std/Ifx_Types.h"
+
+/******************************************************************************/
+/*-----------------------------------Macros-----------------------------------*/
+/******************************************************************************/
+
+/** \brief STM frequency of the model */
+#define IFXSTM_HOST_FREQUENCY (100000000U)
+
+/******************************************************************************/
+/*--------------------------------Enumerations--------------------------------*/
+/******************************************************************************/
+
+/** \brief Comparator Id
+ */
+typedef enum
+{
+    IfxStm_Comparator_0 = 0,      /**< \brief Comparator Id 0  */
+    IfxStm_Comparator_1,          /**< \brief Comparator Id 1  */
+} IfxStm_Comparator;
+
+/******************************************************************************/
+/*-----------------------------Data Structures--------------------------------*/
+/******************************************************************************/
+
+/** \brief Software model of one STM module */
+typedef struct
+{
+    uint32 index;     /**< \brief Module index */
+    uint32 CMP[2];    /**< \brief Compare values, matched against the lower 32 timer bits */
+    uint32 armed;     /**< \brief Bit n set while a match of comparator n is outstanding */
+} Ifx_STM;
+
+/******************************************************************************/
+/*-------------------Global Exported Variables/Constants----------------------*/
+/******************************************************************************/
+
+IFX_EXTERN Ifx_STM MODULE_STM0;
+IFX_EXTERN Ifx_STM MODULE_STM1;
+IFX_EXTERN Ifx_STM MODULE_STM2;
+
+/******************************************************************************/
+/*-------------------------Global Function Prototypes-------------------------*/
+/******************************************************************************/
+
+/** \brief Returns the 64 bit timer value
+ * \param stm pointer to STM registers
+ * \return timer value in ticks since start-up
+ */
+IFX_EXTERN uint64 IfxStm_get(Ifx_STM *stm);
+
+/** \brief Enable suspend by debugger. No effect on the host. */
+IFX_EXTERN void IfxStm_enableOcdsSuspend(Ifx_STM *stm);
+
+/** \brief Clears the compare interrupt flag. No effect on the host. */
+IFX_EXTERN void IfxStm_clearCompareFlag(Ifx_STM *stm, IfxStm_Comparator comparator);
+
+/** \brief Returns TRUE once when the timer has reached the compare value set with IfxStm_updateCompare()
+ * The host has no compare interrupt: the caller runs the interrupt handler when this returns TRUE.
+ * \param stm pointer to STM registers
+ * \param comparator comparator to check
+ * \return TRUE if the compare match happened since the last update
+ */
+IFX_EXTERN boolean IfxStm_Host_pollCompare(Ifx_STM *stm, IfxStm_Comparator comparator);
+
+/******************************************************************************/
+/*---------------------Inline Function Implementations------------------------*/
+/******************************************************************************/
+
+IFX_INLINE float32 IfxStm_getFrequency(Ifx_STM *stm)
+{
+    (void)stm;
+    return (float32)IFXSTM_HOST_FREQUENCY;
+}
+
+
+IFX_INLINE uint32 IfxStm_getLower(Ifx_STM *stm)
+{
+    return (uint32)IfxStm_get(stm);
+}
+
+
+IFX_INLINE void IfxStm_updateCompare(Ifx_STM *stm, IfxStm_Comparator comparator, uint32 ticks)
+{
+    stm->CMP[comparator] = ticks;
+    stm->armed          |= 1U << comparator;
+}
+
+
+IFX_INLINE void IfxStm_waitTicks(Ifx_STM *stm, uint32 ticks)
+{
+    uint32 start = IfxStm_getLower(stm);
+
+    while ((uint32)(IfxStm_getLower(stm) - start) < ticks)
+    {}
+}
+
+
+#endif /* IFXSTM_H */
@@ -33,6 +33,7 @@
 /*-----------------------Exported Variables/Constants-------------------------*/
 /******************************************************************************/
 
+#if IFXETH_DEFAULT_RINGS
 uint8              IfxEth_rxBuffer[IFXETH_MAX_RX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
 
 IfxEth_RxDescrList IfxEth_rxDescr;
@@ -40,6 +41,7 @@ IfxEth_RxDescrList IfxEth_rxDescr;
 uint8              IfxEth_txBuffer[IFXETH_MAX_TX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
 
 IfxEth_TxDescrList IfxEth_txDescr;
+#endif
 
 extern IfxEth              Ifx_g_Eth;
 
@@ -212,8 +214,15 @@ void IfxEth_init(IfxEth *eth, const IfxEth_Config *config)
     IFX_ASSERT(IFX_VERBOSE_LEVEL_ERROR, sizeof(IfxEth_TxDescr) == (IFXETH_DESCR_SIZE * sizeof(uint32)));
     IFX_ASSERT(IFX_VERBOSE_LEVEL_ERROR, sizeof(IfxEth_RxDescr) == (IFXETH_DESCR_SIZE * sizeof(uint32)));
 
-    eth->rxDescr = config->rxDescr;
-    eth->txDescr = config->txDescr;
+    IFX_ASSERT(IFX_VERBOSE_LEVEL_ERROR, (config->rxDescrCount >= 2) && (config->txDescrCount >= 2));
+
+    /* CPU and DMA access the rings through the same (global, non-cached) addresses */
+    eth->rxDescr      = IfxEth_getDmaAlias(config->rxDescr);
+    eth->txDescr      = IfxEth_getDmaAlias(config->txDescr);
+    eth->rxBuffer     = IfxEth_getDmaAlias(config->rxBuffer);
+    eth->txBuffer     = IfxEth_getDmaAlias(config->txBuffer);
+    eth->rxDescrCount = config->rxDescrCount;
+    eth->txDescrCount = config->txDescrCount;
 
     IfxEth_initReceiveDescriptors(eth);
     IfxEth_initTransmitDescriptors(eth);
@@ -232,8 +241,21 @@ void IfxEth_initConfig(IfxEth_Config *config, Ifx_ETH *ethSfr)
         (Ifx_Priority)0,                             /* Interrupt serivce priority */
         IfxSrc_Tos_cpu0,                             /* Interrupt serivce provider */
         NULL_PTR,                                    /* Pointer to register base */
-        &IfxEth_rxDescr,                             /* pointer to RX descriptor RAM */
-        &IfxEth_txDescr,                             /* pointer to TX descriptor RAM */
+#if IFXETH_DEFAULT_RINGS
+        IfxEth_rxDescr.items,                        /* pointer to RX descriptor RAM */
+        IfxEth_txDescr.items,                        /* pointer to TX descriptor RAM */
+        &IfxEth_rxBuffer[0][0],                      /* pointer to RX buffers */
+        &IfxEth_txBuffer[0][0],                      /* pointer to TX buffers */
+        IFXETH_MAX_RX_BUFFERS,                       /* number of RX descriptors */
+        IFXETH_MAX_TX_BUFFERS,                       /* number of TX descriptors */
+#else
+        NULL_PTR,                                    /* the application provides all rings */
+        NULL_PTR,
+        NULL_PTR,
+        NULL_PTR,
+        0,
+        0,
+#endif
     };
 
     *config        = defaultConfig;
@@ -250,7 +272,7 @@ void IfxEth_initReceiveDescriptors(IfxEth *eth)
     eth->pRxDescr = descr;
 
     /* init descriptor chained mode */
-    for (i = 0; i < IFXETH_MAX_RX_BUFFERS; i++)
+    for (i = 0; i < eth->rxDescrCount; i++)
     {
         descr->RDES0.U      = 0;
         descr->RDES0.A.OWN  = 1U;
@@ -260,7 +282,7 @@ void IfxEth_initReceiveDescriptors(IfxEth *eth)
         descr->RDES1.A.RBS1 = (IFXETH_RTX_BUFFER_SIZE);
 
 #if !IFXETH_RX_BUFFER_BY_USER
-        IfxEth_RxDescr_setBuffer(descr, &(IfxEth_rxBuffer[i][0]));
+        IfxEth_RxDescr_setBuffer(descr, &eth->rxBuffer[i * IFXETH_RTX_BUFFER_SIZE]);
 #endif
 
         /* with RCH set, link to next descriptor address */
@@ -298,7 +320,7 @@ void IfxEth_initTransmitDescriptors(IfxEth *eth)
     eth->pTxDescr = descr;
 
     /* Initialize chained descriptor mode */
-    for (i = 0; i < IFXETH_MAX_TX_BUFFERS; i++)
+    for (i = 0; i < eth->txDescrCount; i++)
     {
         descr->TDES0.U     = 0;
         descr->TDES0.A.IC  = 1U;
@@ -307,7 +329,7 @@ void IfxEth_initTransmitDescriptors(IfxEth *eth)
         descr->TDES0.A.TCH = 1U;
 
 #if !IFXETH_TX_BUFFER_BY_USER
-        IfxEth_TxDescr_setBuffer(descr, &(IfxEth_txBuffer[i][0]));
+        IfxEth_TxDescr_setBuffer(descr, IfxEth_getTxBufferByIndex(eth, i));
 #endif
 
         /* with TCH set, TDES3 points to next descriptor */
@@ -392,7 +414,7 @@ void IfxEth_setupChecksumEngine(IfxEth *eth, IfxEth_ChecksumMode mode)
 
         IfxEth_TxDescr *descr = IfxEth_getBaseTxDescriptor(eth);
 
-        for (i = 0; i < IFXETH_MAX_TX_BUFFERS; i++)
+        for (i = 0; i < eth->txDescrCount; i++)
         {
             descr->TDES0.A.CIC = mode;
             descr              = IfxEth_TxDescr_getNext(descr);
@@ -74,13 +74,22 @@
 #define IFXETH_RX_BUFFER_BY_USER 0
 #endif
 
-/** \brief Rx buffers (ring mode)
+/** \brief 1 defines the default rings IfxEth_rxDescr / IfxEth_rxBuffer and IfxEth_txDescr /
+ * IfxEth_txBuffer used by IfxEth_initConfig(), 0 if the application provides all rings
+ */
+#ifndef IFXETH_DEFAULT_RINGS
+#define IFXETH_DEFAULT_RINGS     1
+#endif
+
+/** \brief Rx buffers (ring mode) of the default ring IfxEth_rxDescr / IfxEth_rxBuffer
+ * Other ring sizes are set at run time with IfxEth_Config::rxDescrCount.
  */
 #ifndef IFXETH_MAX_RX_BUFFERS
 #define IFXETH_MAX_RX_BUFFERS    8
 #endif
 
-/** \brief Tx buffers (ring mode)
+/** \brief Tx buffers (ring mode) of the default ring IfxEth_txDescr / IfxEth_txBuffer
+ * Other ring sizes are set at run time with IfxEth_Config::txDescrCount.
  */
 #ifndef IFXETH_MAX_TX_BUFFERS
 #define IFXETH_MAX_TX_BUFFERS    16
@@ -391,8 +400,12 @@ typedef struct
     Ifx_Priority            isrPriority;          /**< \brief Interrupt service priority */
     IfxSrc_Tos              isrProvider;          /**< \brief Interrupt service provider */
     Ifx_ETH                *ethSfr;               /**< \brief Pointer to register base */
-    IfxEth_RxDescrList     *rxDescr;              /**< \brief pointer to RX descriptor RAM */
-    IfxEth_TxDescrList     *txDescr;              /**< \brief pointer to TX descriptor RAM */
+    IfxEth_RxDescr         *rxDescr;              /**< \brief pointer to RX descriptor RAM, rxDescrCount descriptors */
+    IfxEth_TxDescr         *txDescr;              /**< \brief pointer to TX descriptor RAM, txDescrCount descriptors */
+    uint8                  *rxBuffer;             /**< \brief RX buffers, rxDescrCount * IFXETH_RTX_BUFFER_SIZE bytes. Unused with IFXETH_RX_BUFFER_BY_USER */
+    uint8                  *txBuffer;             /**< \brief TX buffers, txDescrCount * IFXETH_RTX_BUFFER_SIZE bytes. Unused with IFXETH_TX_BUFFER_BY_USER */
+    uint16                  rxDescrCount;         /**< \brief Number of RX descriptors, at least 2 */
+    uint16                  txDescrCount;         /**< \brief Number of TX descriptors, at least 2 */
 } IfxEth_Config;
 
 /** \} */
@@ -413,8 +426,12 @@ typedef struct
     sint32              rxDiff;         /**< \brief Difference between isrRxCount and rxCount */
     sint32              isrCount;       /**< \brief count of all ISR */
     IfxEth_Config       config;         /**< \brief Copy of the configuration passed through IfxEth_init() */
-    IfxEth_RxDescrList *rxDescr;        /**< \brief pointer to RX descriptor RAM */
-    IfxEth_TxDescrList *txDescr;        /**< \brief pointer to TX descriptor RAM */
+    IfxEth_RxDescr     *rxDescr;        /**< \brief pointer to RX descriptor RAM */
+    IfxEth_TxDescr     *txDescr;        /**< \brief pointer to TX descriptor RAM */
+    uint8              *rxBuffer;       /**< \brief RX buffers, IFXETH_RTX_BUFFER_SIZE bytes per descriptor */
+    uint8              *txBuffer;       /**< \brief TX buffers, IFXETH_RTX_BUFFER_SIZE bytes per descriptor */
+    uint16              rxDescrCount;   /**< \brief Number of RX descriptors */
+    uint16              txDescrCount;   /**< \brief Number of TX descriptors */
     IfxEth_RxDescr     *pRxDescr;
     IfxEth_TxDescr     *pTxDescr;
     Ifx_ETH            *ethSfr;         /**< \brief Pointer to register base */
@@ -513,6 +530,14 @@ typedef struct
  */
 IFX_INLINE void IfxEth_RxDescr_setBuffer(IfxEth_RxDescr *descr, void *buffer);
 
+/** \brief Enables or disables the receive interrupt (RI) on completion of an RX descriptor
+ * The setting is kept in RDES1 and survives IfxEth_freeReceiveBuffer().
+ * \param descr Pointer to an RX descriptor
+ * \param enabled TRUE to raise RI when the frame is stored, FALSE to set DIC
+ * \return None
+ */
+IFX_INLINE void IfxEth_RxDescr_setInterrupt(IfxEth_RxDescr *descr, boolean enabled);
+
 /** \brief Get pointer to next TX descriptor
  * \param descr descr Pointer to a TX descriptor
  */
@@ -528,6 +553,14 @@ IFX_INLINE boolean IfxEth_TxDescr_isAvailable(IfxEth_TxDescr *descr);
  */
 IFX_INLINE void IfxEth_TxDescr_setBuffer(IfxEth_TxDescr *descr, void *buffer);
 
+/** \brief Checks whether a buffer can be handed to the ETH DMA without copying
+ * Local DSPR addresses are accepted, they are translated by IfxEth_TxDescr_setBuffer().
+ * Addresses in the segments 8 to F (flash, LMU, peripherals) are rejected.
+ * \param buffer Buffer address as seen by the current CPU
+ * \return TRUE if the DMA can read the buffer
+ */
+IFX_INLINE boolean IfxEth_isDmaAddress(const void *buffer);
+
 /** \brief Applies the Software Reset
  * \param eth ETH driver structure
  * \return None
@@ -546,6 +579,20 @@ IFX_INLINE void IfxEth_clearRxInterrupt(IfxEth *eth);
  */
 IFX_INLINE void IfxEth_clearTxInterrupt(IfxEth *eth);
 
+/** \brief Clear early receive interrupt request
+ * \param eth ETH driver structure
+ * \return None
+ */
+IFX_INLINE void IfxEth_clearEarlyRxInterrupt(IfxEth *eth);
+
+/** \brief Enables or disables the early receive interrupt (ERI)
+ * ERI is raised when the DMA has filled the first buffer of a frame, independent of DIC.
+ * \param eth ETH driver structure
+ * \param enabled TRUE to enable the interrupt
+ * \return None
+ */
+IFX_INLINE void IfxEth_setEarlyRxInterrupt(IfxEth *eth, boolean enabled);
+
 /** \brief Returns the status of Software Reset
  * \param eth ETH driver structure
  * \return Status
@@ -663,6 +710,11 @@ IFX_INLINE IfxEth_RxDescr *IfxEth_getActualRxDescriptor(IfxEth *eth);
  */
 IFX_INLINE uint32 IfxEth_getActualRxIndex(IfxEth *eth);
 
+/** \brief Get index of the RX descriptor the DMA writes next
+ * \param eth eth ETH driver structure
+ */
+IFX_INLINE uint32 IfxEth_getDmaRxIndex(IfxEth *eth);
+
 /** \brief Get pointer to actual TX descriptor
  * \param eth eth ETH driver structure
  */
@@ -678,6 +730,30 @@ IFX_INLINE IfxEth_RxDescr *IfxEth_getBaseRxDescriptor(IfxEth *eth);
  */
 IFX_INLINE IfxEth_TxDescr *IfxEth_getBaseTxDescriptor(IfxEth *eth);
 
+/** \brief Returns the address under which CPU and DMA see the same memory
+ * Local DSPR addresses are translated to the global ones, cached LMU addresses (segment 9)
+ * to the non-cached segment B, so that descriptors and buffers placed in the LMU stay
+ * coherent with the DMA.
+ * \param address Address as seen by the current CPU
+ */
+IFX_INLINE void *IfxEth_getDmaAlias(void *address);
+
+/** \brief Get number of RX descriptors
+ * \param eth eth ETH driver structure
+ */
+IFX_INLINE uint16 IfxEth_getRxDescriptorCount(IfxEth *eth);
+
+/** \brief Get number of TX descriptors
+ * \param eth eth ETH driver structure
+ */
+IFX_INLINE uint16 IfxEth_getTxDescriptorCount(IfxEth *eth);
+
+/** \brief Get the buffer of a TX descriptor
+ * \param eth eth ETH driver structure
+ * \param index descriptor index, below IfxEth_getTxDescriptorCount()
+ */
+IFX_INLINE uint8 *IfxEth_getTxBufferByIndex(IfxEth *eth, uint32 index);
+
 /** \brief returns the status of th eloopback mode
  * \param eth ETH driver structure
  * \return Loop back mode status (TRUE / FALSE)
@@ -726,6 +802,12 @@ IFX_INLINE boolean IfxEth_isRxChecksumError(IfxEth *eth);
  */
 IFX_INLINE boolean IfxEth_isRxDataAvailable(IfxEth *eth);
 
+/** \brief Checks whether early receive interrupt is requested
+ * \param eth ETH driver structure
+ * \return TRUE/FALSE
+ */
+IFX_INLINE boolean IfxEth_isEarlyRxInterrupt(IfxEth *eth);
+
 /** \brief Checks whether receive interrupt is requested
  * \param eth ETH driver structure
  * \return TRUE/FALSE
@@ -744,6 +826,14 @@ IFX_INLINE boolean IfxEth_isTxInterrupt(IfxEth *eth);
  */
 IFX_INLINE void IfxEth_readAllFlags(IfxEth *eth);
 
+/** \brief Reads and clears the missed frame and buffer overflow counters
+ * \param eth ETH driver structure
+ * \param missed Frames missed by the RX DMA because no descriptor was owned by the DMA
+ * \param overflow Frames missed because of an RX FIFO overflow
+ * \return None
+ */
+IFX_INLINE void IfxEth_readMissedFrameCounter(IfxEth *eth, uint32 *missed, uint32 *overflow);
+
 /** \brief Shuffle to next RX descriptor
  * \param eth eth ETH driver structure
  * \return None
@@ -903,6 +993,7 @@ IFX_EXTERN void IfxEth_setupRmiiOutputPins(IfxEth *eth, const IfxEth_RmiiPins *r
 /*-------------------Global Exported Variables/Constants----------------------*/
 /******************************************************************************/
 
+#if IFXETH_DEFAULT_RINGS
 /** \brief receive buffers
  */
 IFX_EXTERN uint8              IfxEth_rxBuffer[IFXETH_MAX_RX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
@@ -914,6 +1005,7 @@ IFX_EXTERN IfxEth_RxDescrList IfxEth_rxDescr;
 IFX_EXTERN uint8              IfxEth_txBuffer[IFXETH_MAX_TX_BUFFERS][IFXETH_RTX_BUFFER_SIZE];
 
 IFX_EXTERN IfxEth_TxDescrList IfxEth_txDescr;
+#endif
 
 /******************************************************************************/
 /*---------------------Inline Function Implementations------------------------*/
@@ -925,6 +1017,12 @@ IFX_INLINE void IfxEth_RxDescr_setBuffer(IfxEth_RxDescr *descr, void *buffer)
 }
 
 
+IFX_INLINE void IfxEth_RxDescr_setInterrupt(IfxEth_RxDescr *descr, boolean enabled)
+{
+    descr->RDES1.A.DIC = enabled ? 0 : 1;
+}
+
+
 IFX_INLINE IfxEth_TxDescr *IfxEth_TxDescr_getNext(IfxEth_TxDescr *descr)
 {
     return (IfxEth_TxDescr *)(descr->TDES3.U);
@@ -943,6 +1041,12 @@ IFX_INLINE void IfxEth_TxDescr_setBuffer(IfxEth_TxDescr *descr, void *buffer)
 }
 
 
+IFX_INLINE boolean IfxEth_isDmaAddress(const void *buffer)
+{
+    return ((uint32)IFXCPU_GLB_ADDR_DSPR(IfxCpu_getCoreId(), buffer) & 0x80000000U) == 0;
+}
+
+
 IFX_INLINE void IfxEth_applySoftwareReset(IfxEth *eth)
 {
     (void)eth;
@@ -950,6 +1054,13 @@ IFX_INLINE void IfxEth_applySoftwareReset(IfxEth *eth)
 }
 
 
+IFX_INLINE void IfxEth_clearEarlyRxInterrupt(IfxEth *eth)
+{
+    (void)eth;
+    MODULE_ETH.STATUS.U = (uint32)(1 << 14);
+}
+
+
 IFX_INLINE void IfxEth_clearRxInterrupt(IfxEth *eth)
 {
     (void)eth;
@@ -971,6 +1082,13 @@ IFX_INLINE boolean IfxEth_isSoftwareResetDone(IfxEth *eth)
 }
 
 
+IFX_INLINE void IfxEth_setEarlyRxInterrupt(IfxEth *eth, boolean enabled)
+{
+    (void)eth;
+    ETH_INTERRUPT_ENABLE.B.ERE = enabled ? 1 : 0;
+}
+
+
 IFX_INLINE void IfxEth_setLoopbackMode(IfxEth *eth, boolean loopbackMode)
 {
     (void)eth;
@@ -1041,6 +1159,14 @@ IFX_INLINE uint32 IfxEth_getActualRxIndex(IfxEth *eth)
 }
 
 
+IFX_INLINE uint32 IfxEth_getDmaRxIndex(IfxEth *eth)
+{
+    /* the list address was written untranslated, so the DMA pointer is in the same address space */
+    uint32 offset = ETH_CURRENT_HOST_RECEIVE_DESCRIPTOR.U - (uint32)IfxEth_getBaseRxDescriptor(eth);
+    return offset / sizeof(IfxEth_RxDescr);
+}
+
+
 IFX_INLINE IfxEth_TxDescr *IfxEth_getActualTxDescriptor(IfxEth *eth)
 {
     return eth->pTxDescr;
@@ -1049,13 +1175,44 @@ IFX_INLINE IfxEth_TxDescr *IfxEth_getActualTxDescriptor(IfxEth *eth)
 
 IFX_INLINE IfxEth_RxDescr *IfxEth_getBaseRxDescriptor(IfxEth *eth)
 {
-    return eth->rxDescr->items;
+    return eth->rxDescr;
 }
 
 
 IFX_INLINE IfxEth_TxDescr *IfxEth_getBaseTxDescriptor(IfxEth *eth)
 {
-    return eth->txDescr->items;
+    return eth->txDescr;
+}
+
+
+IFX_INLINE void *IfxEth_getDmaAlias(void *address)
+{
+    uint32 alias = (uint32)IFXCPU_GLB_ADDR_DSPR(IfxCpu_getCoreId(), address);
+
+    if ((alias & 0xF0000000U) == 0x90000000U)
+    {
+        alias = alias | 0x20000000U;
+    }
+
+    return (void *)alias;
+}
+
+
+IFX_INLINE uint16 IfxEth_getRxDescriptorCount(IfxEth *eth)
+{
+    return eth->rxDescrCount;
+}
+
+
+IFX_INLINE uint16 IfxEth_getTxDescriptorCount(IfxEth *eth)
+{
+    return eth->txDescrCount;
+}
+
+
+IFX_INLINE uint8 *IfxEth_getTxBufferByIndex(IfxEth *eth, uint32 index)
+{
+    return &eth->txBuffer[index * IFXETH_RTX_BUFFER_SIZE];
 }
 
 
@@ -1122,6 +1279,14 @@ IFX_INLINE boolean IfxEth_isRxDataAvailable(IfxEth *eth)
 }
 
 
+IFX_INLINE boolean IfxEth_isEarlyRxInterrupt(IfxEth *eth)
+{
+    (void)eth;
+
+    return MODULE_ETH.STATUS.B.ERI != 0;
+}
+
+
 IFX_INLINE boolean IfxEth_isRxInterrupt(IfxEth *eth)
 {
     (void)eth;
@@ -1144,6 +1309,18 @@ IFX_INLINE void IfxEth_readAllFlags(IfxEth *eth)
 }
 
 
+IFX_INLINE void IfxEth_readMissedFrameCounter(IfxEth *eth, uint32 *missed, uint32 *overflow)
+{
+    Ifx_ETH_MISSED_FRAME_AND_BUFFER_OVERFLOW_COUNTER counter;
+    (void)eth;
+
+    /* the counters are cleared on read */
+    counter.U = ETH_MISSED_FRAME_AND_BUFFER_OVERFLOW_COUNTER.U;
+    *missed   = counter.B.MISCNTOVF ? 0xFFFFU : counter.B.MISFRMCNT;
+    *overflow = counter.B.OVFCNTOVF ? 0x7FFU : counter.B.OVFFRMCNT;
+}
+
+
 IFX_INLINE void IfxEth_shuffleRxDescriptor(IfxEth *eth)
 {
     eth->pRxDescr = IfxEth_RxDescr_getNext(eth->pRxDescr);
@@ -0,0 +1,210 @@
+###############################################################################
+#                                                                             #
+#        Copyright (c) 2014 Infineon Technologies AG. All rights reserved.    #
+#                                                                             #
+#                                                                             #
+#                              IMPORTANT NOTICE                               #
+#                                                                             #
+#                                                                             #
+# Infineon Technologies AG (Infineon) is supplying this file for use          #
+# exclusively with Infineon's microcontroller products. This file can be      #
+# freely distributed within development tools that are supporting such        #
+# microcontroller products.                                                   #
+#                                                                             #
+# THIS SOFTWARE IS PROVIDED "AS IS".  NO WARRANTIES, WHETHER EXPRESS, IMPLIED #
+# OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF          #
+# MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE.#
+# INFINEON SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL,#
+# OR CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.                        #
+#                                                                             #
+###############################################################################
+# Host (Linux) build of the lwIP stack, the Ifx_Lwip port and ethernetif_tc2x
+# against the IfxEth model in 0_Src/4_McHal/Host.
+# Every file in 0_Src/0_AppSw/Host/Main and 0_Src/0_AppSw/Host/Bench is linked
+# into its own executable in $(HOST_OUT_DIR)/bin.
+
+PROJ_DIR?=$(CURDIR)
+
+HOST_CC?=gcc
+HOST_OUT_DIR?=$(PROJ_DIR)/2_Out/Host
+HOST_OPT?=-O2
+
+SRC_DIR:=0_Src
+HOST_LWIP_DIR:=$(SRC_DIR)/0_AppSw/LwIP/lwip-1.4.1/src
+HOST_PORT_DIR:=$(SRC_DIR)/0_AppSw/LwIP/port
+HOST_APP_DIR:=$(SRC_DIR)/0_AppSw/Host
+
+HOST_INCLUDES:= \
+	$(HOST_APP_DIR)/Sim \
+	$(SRC_DIR)/0_AppSw/Config/Host \
+	$(HOST_PORT_DIR)/include \
+	$(HOST_LWIP_DIR)/include \
+	$(HOST_LWIP_DIR)/include/ipv4 \
+	$(SRC_DIR)/4_McHal/Host \
+	$(SRC_DIR)/4_McHal/Host/Cpu/Std \
+	$(SRC_DIR)/0_AppSw/Config/Common \
+	$(SRC_DIR)/1_SrvSw \
+	$(SRC_DIR)/1_SrvSw/SysSe \
+	$(SRC_DIR)/1_SrvSw/StdIf
+
+# LWIP_CHKSUM_ALGORITHM_ALL exports every inet_chksum.c algorithm for Bench_Chksum
+HOST_CFLAGS:=$(HOST_OPT) -g -std=gnu99 -Wall \
+	-DIFX_HOST_BUILD=1 -DLWIP_CHKSUM_ALGORITHM_ALL=1 $(addprefix -I,$(HOST_INCLUDES)) $(HOST_EXTRA_CFLAGS)
+HOST_LDFLAGS:=$(HOST_EXTRA_LDFLAGS)
+
+HOST_LIB_SRCS:= \
+	$(wildcard $(HOST_LWIP_DIR)/core/*.c) \
+	$(wildcard $(HOST_LWIP_DIR)/core/ipv4/*.c) \
+	$(HOST_LWIP_DIR)/netif/etharp.c \
+	$(wildcard $(HOST_PORT_DIR)/src/*.c) \
+	$(HOST_PORT_DIR)/src/arch/sys_arch_ee.c \
+	$(SRC_DIR)/1_SrvSw/SysSe/Comm/Ifx_Console.c \
+	$(shell find $(SRC_DIR)/4_McHal/Host -name "*.c") \
+	$(wildcard $(SRC_DIR)/0_AppSw/Config/Host/*.c) \
+	$(wildcard $(HOST_APP_DIR)/Sim/*.c)
+
+HOST_PRG_SRCS:=$(wildcard $(HOST_APP_DIR)/Main/*.c) $(wildcard $(HOST_APP_DIR)/Bench/*.c)
+
+HOST_LIB_OBJS:=$(patsubst %.c,$(HOST_OUT_DIR)/obj/%.o,$(HOST_LIB_SRCS))
+HOST_PRG_OBJS:=$(patsubst %.c,$(HOST_OUT_DIR)/obj/%.o,$(HOST_PRG_SRCS))
+HOST_LIB:=$(HOST_OUT_DIR)/libhostlwip.a
+HOST_PRGS:=$(patsubst %.c,$(HOST_OUT_DIR)/bin/%,$(notdir $(HOST_PRG_SRCS)))
+HOST_RUN_PRGS:=$(patsubst %.c,$(HOST_OUT_DIR)/bin/%,$(notdir $(wildcard $(HOST_APP_DIR)/Main/*.c)))
+
+vpath %.c $(HOST_APP_DIR)/Main $(HOST_APP_DIR)/Bench
+
+.PHONY: all run clean
+
+all: $(HOST_PRGS)
+
+$(HOST_OUT_DIR)/obj/%.o: %.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_LIB): $(HOST_LIB_OBJS)
+	@rm -f $@
+	ar rcs $@ $^
+
+$(HOST_OUT_DIR)/bin/%: $(HOST_OUT_DIR)/obj/$(HOST_APP_DIR)/Main/%.o $(HOST_LIB)
+	@mkdir -p $(dir $@)
+	$(HOST_CC) -o $@ $^ $(HOST_LDFLAGS) -lpthread -lm
+
+$(HOST_OUT_DIR)/bin/%: $(HOST_OUT_DIR)/obj/$(HOST_APP_DIR)/Bench/%.o $(HOST_LIB)
+	@mkdir -p $(dir $@)
+	$(HOST_CC) -o $@ $^ $(HOST_LDFLAGS) -lpthread -lm
+
+# Bench_MemTrace records the mem_malloc()/mem_free() calls of the stack through --wrap and
+# replays them against the size classes of the library and against the first-fit heap:
+# mem.c built once more with MEM_USE_POOLS 0 and its functions renamed to mem_heap_*
+HOST_MEM_HEAP_OBJ:=$(HOST_OUT_DIR)/obj/mem_heap.o
+HOST_MEM_HEAP_FLAGS:=-DMEM_USE_POOLS=0 -Dmem_init=mem_heap_init -Dmem_malloc=mem_heap_malloc \
+	-Dmem_free=mem_heap_free -Dmem_trim=mem_heap_trim -Dmem_calloc=mem_heap_calloc -Dram_heap=mem_heap_ram
+
+$(HOST_MEM_HEAP_OBJ): $(HOST_LWIP_DIR)/core/mem.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_MEM_HEAP_FLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_MemTrace: $(HOST_MEM_HEAP_OBJ)
+$(HOST_OUT_DIR)/bin/Bench_MemTrace: HOST_LDFLAGS+=-Wl,--wrap=mem_malloc -Wl,--wrap=mem_free
+
+# Bench_Timers runs the timing wheel of the library on a virtual clock (sys_now() through
+# --wrap) against the sorted list: timers.c built once more with LWIP_TIMER_WHEEL 0 and its
+# functions renamed to sys_list_*
+HOST_TIMERS_LIST_OBJ:=$(HOST_OUT_DIR)/obj/timers_list.o
+HOST_TIMERS_LIST_FLAGS:=-DLWIP_TIMER_WHEEL=0 -Dsys_timeouts_init=sys_list_timeouts_init \
+	-Dsys_timeout=sys_list_timeout -Dsys_untimeout=sys_list_untimeout \
+	-Dsys_check_timeouts=sys_list_check_timeouts -Dsys_restart_timeouts=sys_list_restart_timeouts \
+	-Dsys_timeouts_sleeptime=sys_list_timeouts_sleeptime -Dtcp_timer_needed=sys_list_tcp_timer_needed
+
+$(HOST_TIMERS_LIST_OBJ): $(HOST_LWIP_DIR)/core/timers.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_TIMERS_LIST_FLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_Timers: $(HOST_TIMERS_LIST_OBJ)
+$(HOST_OUT_DIR)/bin/Bench_Timers: HOST_LDFLAGS+=-Wl,--wrap=sys_now -Wl,--wrap=memp_malloc -Wl,--wrap=memp_free
+
+# Bench_UdpDemux delivers datagrams through udp_input() of the library (UDP_PCB_HASH 1) and of
+# udp.c built once more with UDP_PCB_HASH 0 and its functions renamed to udp_list_*
+HOST_UDP_LIST_OBJ:=$(HOST_OUT_DIR)/obj/udp_list.o
+HOST_UDP_LIST_FLAGS:=-DUDP_PCB_HASH=0 -Dudp_pcbs=udp_list_pcbs -Dudp_init=udp_list_init \
+	-Dudp_input=udp_list_input -Dudp_bind=udp_list_bind -Dudp_connect=udp_list_connect \
+	-Dudp_disconnect=udp_list_disconnect -Dudp_recv=udp_list_recv -Dudp_remove=udp_list_remove \
+	-Dudp_new=udp_list_new -Dudp_send=udp_list_send -Dudp_sendto=udp_list_sendto \
+	-Dudp_sendto_if=udp_list_sendto_if -Dudp_send_chksum=udp_list_send_chksum \
+	-Dudp_sendto_chksum=udp_list_sendto_chksum -Dudp_sendto_if_chksum=udp_list_sendto_if_chksum \
+	-Dudp_flow_invalidate=udp_list_flow_invalidate
+
+$(HOST_UDP_LIST_OBJ): $(HOST_LWIP_DIR)/core/udp.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_UDP_LIST_FLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_UdpDemux: $(HOST_UDP_LIST_OBJ)
+$(HOST_OUT_DIR)/bin/Bench_UdpDemux: HOST_LDFLAGS+=-Wl,--wrap=memp_malloc -Wl,--wrap=memp_free
+
+# Bench_TcpConn serves the TCP pcbs from malloc(), the lists are measured with a second build
+# (HOST_EXTRA_CFLAGS=-DTCP_PCB_HASH=0)
+$(HOST_OUT_DIR)/bin/Bench_TcpConn: HOST_LDFLAGS+=-Wl,--wrap=memp_malloc -Wl,--wrap=memp_free
+
+# Bench_TcpLoss runs the stack on a virtual clock (sys_now() through --wrap), the built-in Reno
+# is measured with a second build (HOST_EXTRA_CFLAGS="-DLWIP_TCP_CC=0 -DLWIP_TCP_SACK=0
+# -DTCP_RTO_RFC6298=0")
+$(HOST_OUT_DIR)/bin/Bench_TcpLoss: HOST_LDFLAGS+=-Wl,--wrap=sys_now
+
+# Bench_Arp resolves through etharp.c of the library (ETHARP_TABLE_HASH 1) and etharp.c built
+# once more with ETHARP_TABLE_HASH 0 and its functions renamed to etharp_list_*
+HOST_ETHARP_LIST_OBJ:=$(HOST_OUT_DIR)/obj/etharp_list.o
+HOST_ETHARP_LIST_FLAGS:=-DETHARP_TABLE_HASH=0 -Dethbroadcast=etharp_list_ethbroadcast \
+	-Dethzero=etharp_list_ethzero -Detharp_cache_version=etharp_list_cache_version \
+	-Detharp_resolve_stats=etharp_list_resolve_stats \
+	-Detharp_tmr=etharp_list_tmr -Detharp_find_addr=etharp_list_find_addr \
+	-Detharp_output=etharp_list_output -Detharp_query=etharp_list_query \
+	-Detharp_request=etharp_list_request -Detharp_cleanup_netif=etharp_list_cleanup_netif \
+	-Detharp_use_entry=etharp_list_use_entry -Dethernet_input=etharp_list_ethernet_input \
+	-Detharp_add_static_entry=etharp_list_add_static_entry \
+	-Detharp_remove_static_entry=etharp_list_remove_static_entry
+
+$(HOST_ETHARP_LIST_OBJ): $(HOST_LWIP_DIR)/netif/etharp.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_ETHARP_LIST_FLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_Arp: $(HOST_ETHARP_LIST_OBJ)
+
+# Bench_Reass reassembles through ip_frag.c built twice more with room for 32 KB datagrams:
+# with IP_REASS_HOLES 1 renamed to ip_reass_holes_* and with IP_REASS_HOLES 0 renamed to
+# ip_reass_list_*
+HOST_REASS_FLAGS:=-DIP_FRAG=0 -DIP_REASS_MAX_PBUFS=96
+HOST_REASS_HOLES_OBJ:=$(HOST_OUT_DIR)/obj/ip_frag_holes.o
+HOST_REASS_LIST_OBJ:=$(HOST_OUT_DIR)/obj/ip_frag_list.o
+
+$(HOST_REASS_HOLES_OBJ): $(HOST_LWIP_DIR)/core/ipv4/ip_frag.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_REASS_FLAGS) -DIP_REASS_HOLES=1 -Dip_reass=ip_reass_holes \
+		-Dip_reass_tmr=ip_reass_holes_tmr -Dip_reass_stats=ip_reass_holes_stats -MMD -MP -c $< -o $@
+
+$(HOST_REASS_LIST_OBJ): $(HOST_LWIP_DIR)/core/ipv4/ip_frag.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) $(HOST_REASS_FLAGS) -DIP_REASS_HOLES=0 -Dip_reass=ip_reass_list \
+		-Dip_reass_tmr=ip_reass_list_tmr -Dip_reass_stats=ip_reass_list_stats -MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_Reass: $(HOST_REASS_HOLES_OBJ) $(HOST_REASS_LIST_OBJ)
+
+# Bench_Frag fragments through ip_frag() of the library (IP_FRAG_USES_STATIC_BUF 0) and of
+# ip_frag.c built once more with IP_FRAG_USES_STATIC_BUF 1 and ip_frag renamed to ip_frag_static
+HOST_FRAG_STATIC_OBJ:=$(HOST_OUT_DIR)/obj/ip_frag_static.o
+
+$(HOST_FRAG_STATIC_OBJ): $(HOST_LWIP_DIR)/core/ipv4/ip_frag.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) -DIP_REASSEMBLY=0 -DIP_FRAG_USES_STATIC_BUF=1 -Dip_frag=ip_frag_static \
+		-MMD -MP -c $< -o $@
+
+$(HOST_OUT_DIR)/bin/Bench_Frag: $(HOST_FRAG_STATIC_OBJ)
+
+run: all
+	@for prg in $(HOST_RUN_PRGS); do echo "== $$prg"; $$prg || exit 1; done
+
+clean:
+	@-rm -rf $(HOST_OUT_DIR)
+
+-include $(HOST_LIB_OBJS:.o=.d) $(HOST_PRG_OBJS:.o=.d) $(HOST_MEM_HEAP_OBJ:.o=.d) $(HOST_TIMERS_LIST_OBJ:.o=.d) \
+	$(HOST_UDP_LIST_OBJ:.o=.d) $(HOST_ETHARP_LIST_OBJ:.o=.d) $(HOST_REASS_HOLES_OBJ:.o=.d) $(HOST_REASS_LIST_OBJ:.o=.d) \
+	$(HOST_FRAG_STATIC_OBJ:.o=.d)
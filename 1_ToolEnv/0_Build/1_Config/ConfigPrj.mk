@@ -41,7 +41,7 @@ TOOL_CHAIN_MAIN:=Gnuc
 # Note: When both USE_FILE_PATTERN and DISCARD_FILE_PATTERN are used DISCARD_FILE_PATTERN has priority
 # Note: If multiple patterns are to be defined in USE_FILE_PATTERN and DISCARD_FILE_PATTERN separate them with comma (,)
 USE_FILE_PATTERN=
-DISCARD_FILE_PATTERN=*makefsdata/*
+DISCARD_FILE_PATTERN=*makefsdata/*,*/Host/*
 
 #Name of the TOOL_CHAIN_SECOND is NOT FLEXIBLE, is always fixed to ToolChain_SecCore
 #The file names CfgToolChain_SecCore.mk and Lcf_ToolChain_SecCore.lsl can not be changed